@@ -0,0 +1,166 @@
+/**
+ * @file Benchmark.h
+ *
+ * @brief Declares a minimal harness for registering, running, and reporting
+ *        benchmarks.
+ */
+
+#ifndef BENCHMARK_H
+# define BENCHMARK_H
+
+# include <cstdint>
+# include <chrono>
+# include <filesystem>
+# include <functional>
+# include <map>
+# include <string>
+# include <vector>
+
+# include "Logger.h"
+
+# include "Maybe.h"
+# include "StatusCodes.h"
+# include "PreprocessorUtils.h"
+
+# include "SyntheticMapGenerator.h"
+
+namespace HMDT::Benchmarks {
+    /**
+     * @brief Configuration shared by every benchmark in a single run
+     */
+    struct BenchmarkConfig {
+        //! The options used to generate the synthetic map
+        SyntheticMapOptions map_options;
+
+        //! The number of timed iterations to run for each benchmark
+        uint32_t iterations = 5;
+
+        //! The number of untimed iterations to run before measuring
+        uint32_t warmup = 1;
+
+        //! A directory that benchmarks may write temporary files into
+        std::filesystem::path work_dir;
+
+        //! Only benchmarks whose "Suite.Name" contains this string will run
+        std::string filter;
+    };
+
+    /**
+     * @brief The measured result of a single benchmark
+     */
+    struct BenchmarkResult {
+        //! The suite the benchmark belongs to
+        std::string suite;
+
+        //! The name of the benchmark
+        std::string name;
+
+        //! The status the benchmark finished with
+        std::error_code status;
+
+        //! Every timed sample, in nanoseconds
+        std::vector<uint64_t> samples_ns;
+
+        //! The number of items processed by a single iteration (0 if unset)
+        uint64_t items_per_iteration = 0;
+
+        //! Any extra counters that the benchmark wishes to report
+        std::map<std::string, double> counters;
+    };
+
+    /**
+     * @brief Passed to every benchmark, and used to time the code under test
+     */
+    class BenchmarkState {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            BenchmarkState(const BenchmarkConfig&, BenchmarkResult&);
+
+            const BenchmarkConfig& getConfig() const;
+            const SyntheticMap& getSyntheticMap();
+
+            std::filesystem::path getWorkDir() const;
+
+            void setItemsPerIteration(uint64_t);
+            void setCounter(const std::string&, double);
+
+            /**
+             * @brief Runs 'body' warmup + iterations times, timing only the
+             *        iterations.
+             *
+             * @param setup Run before every call to body, and is not timed
+             * @param body The code under test
+             *
+             * @return STATUS_SUCCESS, or the first failure returned by either
+             *         setup or body.
+             */
+            template<typename S, typename F>
+            MaybeVoid measure(S&& setup, F&& body) {
+                auto total = m_config.warmup + m_config.iterations;
+
+                for(uint32_t i = 0; i < total; ++i) {
+                    auto res = setup();
+                    RETURN_IF_ERROR(res);
+
+                    auto start = Clock::now();
+                    res = body();
+                    auto end = Clock::now();
+                    RETURN_IF_ERROR(res);
+
+                    if(i >= m_config.warmup) {
+                        m_result.samples_ns.push_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                    }
+                }
+
+                return STATUS_SUCCESS;
+            }
+
+            /**
+             * @brief Runs 'body' warmup + iterations times, timing only the
+             *        iterations.
+             *
+             * @param body The code under test
+             *
+             * @return STATUS_SUCCESS, or the first failure returned by body.
+             */
+            template<typename F>
+            MaybeVoid measure(F&& body) {
+                return measure([]() -> MaybeVoid { return STATUS_SUCCESS; },
+                               std::forward<F>(body));
+            }
+
+        private:
+            //! The configuration of this run
+            const BenchmarkConfig& m_config;
+
+            //! Where results get written to
+            BenchmarkResult& m_result;
+    };
+
+    using BenchmarkFunction = std::function<MaybeVoid(BenchmarkState&)>;
+
+    bool registerBenchmark(const std::string&, const std::string&,
+                           BenchmarkFunction);
+
+    std::vector<BenchmarkResult> runBenchmarks(const BenchmarkConfig&);
+
+    void writeResultsAsJSON(std::ostream&, const BenchmarkConfig&,
+                            const std::vector<BenchmarkResult>&);
+}
+
+/**
+ * @brief Defines and registers a new benchmark
+ * @details Usage mirrors gtest's TEST() macro:
+ *          HMDT_BENCHMARK(Suite, Name) { ...; return state.measure(...); }
+ */
+# define HMDT_BENCHMARK(SUITE, NAME) \
+    static HMDT::MaybeVoid CONCAT(CONCAT(SUITE, _), NAME)(HMDT::Benchmarks::BenchmarkState&); \
+    static const bool CONCAT(CONCAT(CONCAT(SUITE, _), NAME), _registered) = \
+        HMDT::Benchmarks::registerBenchmark(STR(SUITE), STR(NAME), \
+                                            CONCAT(CONCAT(SUITE, _), NAME)); \
+    static HMDT::MaybeVoid CONCAT(CONCAT(SUITE, _), NAME)(HMDT::Benchmarks::BenchmarkState& state)
+
+#endif
+
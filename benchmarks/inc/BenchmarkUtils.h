@@ -0,0 +1,39 @@
+/**
+ * @file BenchmarkUtils.h
+ *
+ * @brief Declares helpers shared between multiple benchmark files.
+ */
+
+#ifndef BENCHMARK_UTILS_H
+# define BENCHMARK_UTILS_H
+
+# include <memory>
+
+# include "BitMap.h"
+# include "HoI4Project.h"
+# include "IGraphicsWorker.h"
+
+# include "SyntheticMapGenerator.h"
+
+namespace HMDT::Benchmarks {
+    /**
+     * @brief A graphics worker which does nothing, so that the benchmarks only
+     *        measure the algorithms themselves.
+     */
+    class NullGraphicsWorker: public IGraphicsWorker {
+        public:
+            virtual ~NullGraphicsWorker() = default;
+
+            virtual void writeDebugColor(uint32_t, uint32_t, const Color&) override { }
+            virtual void updateCallback(const Rectangle&) override { }
+
+            static NullGraphicsWorker& getInstance();
+    };
+
+    std::shared_ptr<BitMap> makeBitMap(const SyntheticMap&);
+
+    MaybeVoid importSyntheticMap(Project::HoI4Project&, const SyntheticMap&);
+}
+
+#endif
+
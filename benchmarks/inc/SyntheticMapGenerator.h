@@ -0,0 +1,75 @@
+/**
+ * @file SyntheticMapGenerator.h
+ *
+ * @brief Declares a deterministic generator for synthetic province maps, used
+ *        to feed the benchmarks with inputs of realistic sizes.
+ */
+
+#ifndef SYNTHETIC_MAP_GENERATOR_H
+# define SYNTHETIC_MAP_GENERATOR_H
+
+# include <cstdint>
+# include <memory>
+# include <filesystem>
+
+# include "Maybe.h"
+
+namespace HMDT::Benchmarks {
+    /**
+     * @brief All parameters used to generate a synthetic map
+     */
+    struct SyntheticMapOptions {
+        //! The width of the generated map
+        uint32_t width = 1024;
+
+        //! The height of the generated map
+        uint32_t height = 1024;
+
+        //! The number of Voronoi sites (and therefore provinces) to place
+        uint32_t province_count = 1000;
+
+        //! The fraction of provinces which should be land, in [0, 1]
+        double land_ratio = 0.6;
+
+        //! The fraction of land provinces which should be turned into lakes
+        double lake_ratio = 0.02;
+
+        //! The seed for the generator. The same seed always produces the same map
+        uint64_t seed = 0;
+    };
+
+    /**
+     * @brief A generated map
+     */
+    struct SyntheticMap {
+        //! The width of the map
+        uint32_t width;
+
+        //! The height of the map
+        uint32_t height;
+
+        //! The number of Voronoi sites that were placed
+        uint32_t province_count;
+
+        /**
+         * @brief The input province map (BGR, 3 bytes per pixel)
+         * @details Laid out the same way the ShapeFinder expects its input:
+         *          every province is filled in with RED for land, BLUE for sea
+         *          or GREEN for lakes, and is separated from its neighbors by
+         *          BORDER_COLOR pixels.
+         */
+        std::unique_ptr<unsigned char[]> provinces;
+
+        //! An 8-bit heightmap matching the province map
+        std::unique_ptr<unsigned char[]> heightmap;
+    };
+
+    SyntheticMap generateSyntheticMap(const SyntheticMapOptions&);
+
+    MaybeVoid writeSyntheticMap(const SyntheticMap&,
+                                const std::filesystem::path&,
+                                const std::filesystem::path&);
+}
+
+#endif
+
@@ -0,0 +1,249 @@
+/**
+ * @file Benchmark.cpp
+ *
+ * @brief Defines the benchmark registry, runner, and JSON reporter.
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <ostream>
+
+#include "nlohmann/json.hpp"
+
+#include "Constants.h"
+
+namespace {
+    /**
+     * @brief A single registered benchmark
+     */
+    struct RegisteredBenchmark {
+        std::string suite;
+        std::string name;
+        HMDT::Benchmarks::BenchmarkFunction func;
+    };
+
+    /**
+     * @brief Gets every registered benchmark, in registration order
+     * @details This is a function-local static so that it is guaranteed to be
+     *          constructed before any HMDT_BENCHMARK registers itself.
+     */
+    std::vector<RegisteredBenchmark>& getRegistry() {
+        static std::vector<RegisteredBenchmark> registry;
+
+        return registry;
+    }
+
+    /**
+     * @brief Gets the synthetic map shared by all benchmarks in this process
+     * @details Generating a large map takes a while, so it is only generated
+     *          once, and regenerated only if the requested options change.
+     */
+    const HMDT::Benchmarks::SyntheticMap&
+        getSharedSyntheticMap(const HMDT::Benchmarks::SyntheticMapOptions& opts)
+    {
+        static std::unique_ptr<HMDT::Benchmarks::SyntheticMap> map;
+        static HMDT::Benchmarks::SyntheticMapOptions map_opts;
+
+        if(map == nullptr || map_opts.width != opts.width ||
+           map_opts.height != opts.height ||
+           map_opts.province_count != opts.province_count ||
+           map_opts.land_ratio != opts.land_ratio ||
+           map_opts.lake_ratio != opts.lake_ratio ||
+           map_opts.seed != opts.seed)
+        {
+            WRITE_INFO("Generating synthetic map (", opts.width, "x",
+                       opts.height, ", ", opts.province_count,
+                       " provinces, seed=", opts.seed, ")");
+
+            map.reset(new HMDT::Benchmarks::SyntheticMap(
+                        HMDT::Benchmarks::generateSyntheticMap(opts)));
+            map_opts = opts;
+        }
+
+        return *map;
+    }
+}
+
+HMDT::Benchmarks::BenchmarkState::BenchmarkState(const BenchmarkConfig& config,
+                                                 BenchmarkResult& result):
+    m_config(config),
+    m_result(result)
+{ }
+
+auto HMDT::Benchmarks::BenchmarkState::getConfig() const
+    -> const BenchmarkConfig&
+{
+    return m_config;
+}
+
+auto HMDT::Benchmarks::BenchmarkState::getSyntheticMap()
+    -> const SyntheticMap&
+{
+    return getSharedSyntheticMap(m_config.map_options);
+}
+
+/**
+ * @brief Gets a per-benchmark scratch directory, creating it if necessary
+ */
+auto HMDT::Benchmarks::BenchmarkState::getWorkDir() const
+    -> std::filesystem::path
+{
+    auto path = m_config.work_dir / (m_result.suite + "." + m_result.name);
+
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+
+    return path;
+}
+
+void HMDT::Benchmarks::BenchmarkState::setItemsPerIteration(uint64_t items) {
+    m_result.items_per_iteration = items;
+}
+
+void HMDT::Benchmarks::BenchmarkState::setCounter(const std::string& name,
+                                                  double value)
+{
+    m_result.counters[name] = value;
+}
+
+/**
+ * @brief Registers a benchmark. Should only be called via HMDT_BENCHMARK
+ *
+ * @param suite The suite the benchmark belongs to
+ * @param name The name of the benchmark
+ * @param func The benchmark itself
+ *
+ * @return true
+ */
+bool HMDT::Benchmarks::registerBenchmark(const std::string& suite,
+                                         const std::string& name,
+                                         BenchmarkFunction func)
+{
+    getRegistry().push_back(RegisteredBenchmark{ suite, name, func });
+
+    return true;
+}
+
+/**
+ * @brief Runs every registered benchmark matching the configured filter
+ *
+ * @param config The configuration to run the benchmarks with
+ *
+ * @return The results of every benchmark that was run
+ */
+auto HMDT::Benchmarks::runBenchmarks(const BenchmarkConfig& config)
+    -> std::vector<BenchmarkResult>
+{
+    std::vector<BenchmarkResult> results;
+
+    for(auto&& [suite, name, func] : getRegistry()) {
+        auto full_name = suite + "." + name;
+
+        if(!config.filter.empty() &&
+           full_name.find(config.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        WRITE_INFO("Running ", full_name);
+
+        BenchmarkResult result;
+        result.suite = suite;
+        result.name = name;
+
+        BenchmarkState state(config, result);
+        auto res = func(state);
+        result.status = res.error();
+
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR(full_name, " failed: ", res.error().message());
+        }
+
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+/**
+ * @brief Writes the given results out as JSON
+ * @details Each benchmark reports min/median/mean/max/stddev in nanoseconds,
+ *          plus the raw samples, so that two runs can be compared by script.
+ *
+ * @param stream The stream to write to
+ * @param config The configuration the results were produced with
+ * @param results The results to write
+ */
+void HMDT::Benchmarks::writeResultsAsJSON(std::ostream& stream,
+                                          const BenchmarkConfig& config,
+                                          const std::vector<BenchmarkResult>& results)
+{
+    using json = nlohmann::json;
+
+    json root;
+
+    root["tool_version"] = TOOL_VERSION.str();
+    root["config"] = {
+        { "width", config.map_options.width },
+        { "height", config.map_options.height },
+        { "province_count", config.map_options.province_count },
+        { "land_ratio", config.map_options.land_ratio },
+        { "lake_ratio", config.map_options.lake_ratio },
+        { "seed", config.map_options.seed },
+        { "iterations", config.iterations },
+        { "warmup", config.warmup }
+    };
+
+    json benchmarks = json::array();
+
+    for(auto&& result : results) {
+        json jresult = {
+            { "suite", result.suite },
+            { "name", result.name },
+            { "status", result.status.value() },
+            { "status_message", result.status.message() },
+            { "iterations", result.samples_ns.size() },
+            { "samples_ns", result.samples_ns },
+            { "counters", result.counters }
+        };
+
+        if(!result.samples_ns.empty()) {
+            auto sorted = result.samples_ns;
+            std::sort(sorted.begin(), sorted.end());
+
+            auto count = static_cast<double>(sorted.size());
+            auto mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / count;
+
+            double variance = 0.0;
+            for(auto&& sample : sorted) {
+                variance += (sample - mean) * (sample - mean);
+            }
+            variance /= count;
+
+            auto median = (sorted.size() % 2 == 0) ?
+                (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0 :
+                static_cast<double>(sorted[sorted.size() / 2]);
+
+            jresult["min_ns"] = sorted.front();
+            jresult["max_ns"] = sorted.back();
+            jresult["mean_ns"] = mean;
+            jresult["median_ns"] = median;
+            jresult["stddev_ns"] = std::sqrt(variance);
+
+            if(result.items_per_iteration != 0 && median > 0) {
+                jresult["items_per_iteration"] = result.items_per_iteration;
+                jresult["items_per_second"] = result.items_per_iteration / (median / 1e9);
+            }
+        }
+
+        benchmarks.push_back(jresult);
+    }
+
+    root["benchmarks"] = benchmarks;
+
+    stream << root.dump(4) << std::endl;
+}
+
@@ -0,0 +1,90 @@
+/**
+ * @file BenchmarkUtils.cpp
+ *
+ * @brief Defines helpers shared between multiple benchmark files.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <cstring>
+
+#include "Logger.h"
+
+#include "MapData.h"
+#include "ShapeFinder2.h"
+#include "StatusCodes.h"
+
+auto HMDT::Benchmarks::NullGraphicsWorker::getInstance() -> NullGraphicsWorker&
+{
+    static NullGraphicsWorker instance;
+
+    return instance;
+}
+
+/**
+ * @brief Builds an in-memory BitMap out of a synthetic map, laid out the same
+ *        way as readBMP() would produce it (RGB, top-down).
+ *
+ * @param map The synthetic map
+ *
+ * @return A BitMap which owns a copy of the synthetic map's province data
+ */
+auto HMDT::Benchmarks::makeBitMap(const SyntheticMap& map)
+    -> std::shared_ptr<BitMap>
+{
+    auto num_bytes = static_cast<uint64_t>(map.width) * map.height * 3;
+
+    std::shared_ptr<BitMap> bitmap(new BitMap, [](BitMap* bitmap) {
+        delete[] bitmap->data;
+        delete bitmap;
+    });
+    std::memset(bitmap.get(), 0, sizeof(BitMap));
+
+    bitmap->info_header.width = map.width;
+    bitmap->info_header.height = map.height;
+    bitmap->info_header.bitsPerPixel = 24;
+    bitmap->info_header.sizeOfBitmap = num_bytes;
+
+    bitmap->data = new unsigned char[num_bytes];
+
+    // The generator writes BGR so it can be passed directly to writeBMP2,
+    //   while the old BitMap stores RGB
+    for(uint64_t i = 0; i < num_bytes; i += 3) {
+        bitmap->data[i] = map.provinces[i + 2];
+        bitmap->data[i + 1] = map.provinces[i + 1];
+        bitmap->data[i + 2] = map.provinces[i];
+    }
+
+    return bitmap;
+}
+
+/**
+ * @brief Runs the ShapeFinder over a synthetic map and imports the result into
+ *        the given project, the same way the GUI does for a new input map.
+ *
+ * @param project The project to import into
+ * @param map The synthetic map
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_SHAPEFINDER_ESTOP if the
+ *         ShapeFinder did not complete.
+ */
+auto HMDT::Benchmarks::importSyntheticMap(Project::HoI4Project& project,
+                                          const SyntheticMap& map)
+    -> MaybeVoid
+{
+    auto bitmap = makeBitMap(map);
+
+    std::shared_ptr<MapData> map_data(new MapData(map.width, map.height));
+
+    ShapeFinder finder(bitmap.get(), NullGraphicsWorker::getInstance(),
+                       map_data);
+    finder.findAllShapes();
+
+    RETURN_ERROR_IF(finder.getStage() != ShapeFinder::Stage::DONE,
+                    STATUS_SHAPEFINDER_ESTOP);
+
+    project.getMapProject().import(finder, map_data);
+
+    return STATUS_SUCCESS;
+}
+
@@ -0,0 +1,74 @@
+/**
+ * @file BitMapBenchmarks.cpp
+ *
+ * @brief Benchmarks for reading and writing .BMP files.
+ */
+
+#include "Benchmark.h"
+
+#include "BitMap.h"
+
+HMDT_BENCHMARK(BitMap, WriteProvinceMap) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir() / "provinces.bmp";
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return HMDT::writeBMP2(path, map.provinces.get(), map.width,
+                               map.height, 3);
+    });
+}
+
+HMDT_BENCHMARK(BitMap, ReadProvinceMap) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir() / "provinces.bmp";
+
+    auto res = HMDT::writeBMP2(path, map.provinces.get(), map.width,
+                               map.height, 3);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        HMDT::BitMap2 bmp;
+
+        auto res = HMDT::readBMP(path, bmp);
+        RETURN_IF_ERROR(res);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(BitMap, WriteHeightMap) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir() / "heightmap.bmp";
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return HMDT::writeBMP2(path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    });
+}
+
+HMDT_BENCHMARK(BitMap, ReadHeightMap) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir() / "heightmap.bmp";
+
+    auto res = HMDT::writeBMP2(path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        HMDT::BitMap2 bmp;
+
+        auto res = HMDT::readBMP(path, bmp);
+        RETURN_IF_ERROR(res);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
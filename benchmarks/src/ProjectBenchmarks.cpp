@@ -0,0 +1,1083 @@
+/**
+ * @file ProjectBenchmarks.cpp
+ *
+ * @brief Benchmarks for the hot paths of the project hierarchy: importing,
+ *        outline building, state matrix updates, moving provinces between
+ *        states, painting, splitting and
+ *        absorbing provinces, sculpting the heightmap, finding straits,
+ *        building the supply network, generating strategic regions and states, finding
+ *        label points, generating and validating rivers, assigning terrain from a
+ *        terrain map, rendering map modes, diffing two versions of a project,
+ *        computing province statistics, tracing vector borders,
+ *        importing a mod's map folder,
+ *        generating provinces from a land/sea mask, and saving/loading/exporting
+ *        of province data.
+ */
+
+#include "Benchmark.h"
+#include "BenchmarkUtils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+
+#include "BitMap.h"
+#include "Constants.h"
+#include "HoI4Project.h"
+#include "HeightMapProject.h"
+#include "MapData.h"
+#include "ProvinceGenerator.h"
+#include "ProvinceProject.h"
+#include "ShapeFinder2.h"
+#include "Util.h"
+
+namespace {
+    //! How many provinces to put into each state for the state benchmarks
+    constexpr size_t PROVINCES_PER_STATE = 8;
+}
+
+HMDT_BENCHMARK(Project, ImportShapes) {
+    auto& map = state.getSyntheticMap();
+    auto bitmap = HMDT::Benchmarks::makeBitMap(map);
+
+    // ShapeFinder is measured on its own, so only time the import itself
+    std::shared_ptr<HMDT::MapData> map_data(new HMDT::MapData(map.width, map.height));
+    HMDT::ShapeFinder finder(bitmap.get(),
+                             HMDT::Benchmarks::NullGraphicsWorker::getInstance(),
+                             map_data);
+    finder.findAllShapes();
+
+    HMDT::Project::HoI4Project project;
+
+    state.setItemsPerIteration(finder.getShapes().size());
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        project.getMapProject().import(finder, map_data);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, BuildProvinceOutlines) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // buildProvinceOutlines is not part of the IProvinceProject interface
+    auto& prov_project = dynamic_cast<HMDT::Project::ProvinceProject&>(
+            project.getMapProject().getProvinceProject());
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        prov_project.buildProvinceOutlines();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, UpdateStateIDMatrix) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // Group the land provinces into states. Sort the IDs first so that the
+    //   states are the same from run to run.
+    {
+        std::vector<HMDT::ProvinceID> land_provinces;
+        for(auto&& [id, province] : project.getMapProject().getProvinceProject().getProvinces())
+        {
+            if(province.type == HMDT::ProvinceType::LAND) {
+                land_provinces.push_back(id);
+            }
+        }
+        std::sort(land_provinces.begin(), land_provinces.end());
+
+        auto& state_project = project.getHistoryProject().getStateProject();
+        for(size_t i = 0; i < land_provinces.size(); i += PROVINCES_PER_STATE) {
+            auto end = std::min(land_provinces.size(), i + PROVINCES_PER_STATE);
+
+            state_project.addNewState({ land_provinces.begin() + i,
+                                        land_provinces.begin() + end });
+        }
+
+        state.setCounter("states", state_project.getStates().size());
+    }
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        project.getHistoryProject().getStateProject().updateStateIDMatrix();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, MoveProvinceToState) {
+    //! How many provinces to move each iteration
+    constexpr size_t MOVED_PROVINCES = 256;
+
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& map_project = project.getMapProject();
+    auto& state_project = project.getHistoryProject().getStateProject();
+
+    res = state_project.generateStates(HMDT::DEFAULT_PROVINCES_PER_STATE, 1);
+    RETURN_IF_ERROR(res);
+
+    // Sort the IDs so that the same provinces are moved from run to run
+    std::vector<std::pair<HMDT::ProvinceID, HMDT::StateID>> moved;
+    for(auto&& [id, province] : map_project.getProvinceProject().getProvinces()) {
+        if(province.type == HMDT::ProvinceType::LAND) {
+            moved.emplace_back(id, province.state);
+        }
+    }
+    std::sort(moved.begin(), moved.end());
+    moved.resize(std::min(moved.size(), MOVED_PROVINCES));
+
+    RETURN_ERROR_IF(moved.empty(), HMDT::STATUS_NO_DATA_LOADED);
+
+    auto target_state = state_project.getStates().begin()->first;
+
+    state.setItemsPerIteration(moved.size() * 2);
+
+    // Move every province into one state and then back again, so that every
+    //   iteration starts from the same states
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        for(auto&& [id, _] : moved) {
+            map_project.moveProvinceToState(id, target_state);
+        }
+
+        for(auto&& [id, original_state] : moved) {
+            map_project.moveProvinceToState(id, original_state);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, PaintProvince) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& prov_project = project.getMapProject().getProvinceProject();
+
+    // Drag a brush across the middle of the map, painting everything into
+    //   whichever province the stroke started in. Each run is undone again
+    //   afterwards, so every iteration does the same amount of work.
+    HMDT::Dimensions dimensions{ map.width, map.height };
+    std::vector<HMDT::Point2D> path{ { map.width / 4, map.height / 2 },
+                                     { (map.width * 3) / 4, map.height / 2 } };
+    auto pixels = HMDT::getPixelsAlongStroke(dimensions, path, 4);
+
+    auto province_id = project.getMapProject().getMapData()->getProvinces().lock()[
+        HMDT::xyToIndex(map.width, path.front().x, path.front().y)];
+
+    std::optional<HMDT::Project::IProvinceProject::ProvinceEdit> edit;
+
+    state.setItemsPerIteration(pixels.size());
+
+    res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            if(edit) {
+                auto result = prov_project.revertProvinceEdit(*edit);
+                RETURN_IF_ERROR(result);
+
+                edit = std::nullopt;
+            }
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            auto maybe_edit = prov_project.paintProvince(province_id, pixels);
+            RETURN_IF_ERROR(maybe_edit);
+
+            edit = std::move(*maybe_edit);
+
+            return HMDT::STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("new_provinces", edit->new_provinces.size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, SplitOversizedProvinces) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& prov_project = project.getMapProject().getProvinceProject();
+
+    // Paint the left and right quarters of the map into one province each,
+    //   which is far too large for the map
+    auto prov_matrix = project.getMapProject().getMapData()->getProvinces().lock();
+    for(auto [left, right] : { std::pair{ 0U, map.width / 4 },
+                               std::pair{ (map.width * 3) / 4, map.width } })
+    {
+        std::vector<HMDT::Point2D> pixels;
+        for(uint32_t y = 0; y < map.height; ++y) {
+            for(uint32_t x = left; x < right; ++x) {
+                pixels.push_back({ x, y });
+            }
+        }
+
+        auto province_id = prov_matrix[HMDT::xyToIndex(map.width, left, 0)];
+
+        auto edit = prov_project.paintProvince(province_id, pixels);
+        RETURN_IF_ERROR(edit);
+    }
+
+    std::optional<HMDT::Project::IProvinceProject::ProvinceEdit> edit;
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height / 2);
+
+    res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            if(edit) {
+                auto result = prov_project.revertProvinceEdit(*edit);
+                RETURN_IF_ERROR(result);
+
+                edit = std::nullopt;
+            }
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            auto maybe_edit = prov_project.splitOversizedProvinces();
+            RETURN_IF_ERROR(maybe_edit);
+
+            edit = std::move(*maybe_edit);
+
+            return HMDT::STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("new_provinces", edit->new_provinces.size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, AbsorbTinyProvinces) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& prov_project = project.getMapProject().getProvinceProject();
+    auto prov_matrix = project.getMapProject().getMapData()->getProvinces().lock();
+
+    // Scatter a tiny province every SPACING pixels, like the specks left
+    //   behind by anti-aliasing
+    constexpr uint32_t SPACING = 32;
+    constexpr uint32_t SPECK_SIZE = 2;
+
+    uint64_t speck_count = 0;
+    uint64_t absorbed_count = 0;
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width / SPACING) * (map.height / SPACING));
+
+    res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            speck_count = 0;
+
+            for(uint32_t y = SPACING / 2; y + SPECK_SIZE < map.height; y += SPACING) {
+                for(uint32_t x = SPACING / 2; x + SPECK_SIZE < map.width; x += SPACING) {
+                    auto host_id = prov_matrix[HMDT::xyToIndex(map.width, x, y)];
+                    auto& host = prov_project.getProvinceForID(host_id);
+
+                    HMDT::Province speck = host;
+                    speck.id = HMDT::ProvinceID();
+                    speck.bounding_box = { { x, y + SPECK_SIZE - 1 }, { x + SPECK_SIZE - 1, y } };
+                    speck.adjacent_provinces = { host_id };
+
+                    for(uint32_t sy = y; sy < y + SPECK_SIZE; ++sy) {
+                        for(uint32_t sx = x; sx < x + SPECK_SIZE; ++sx) {
+                            prov_matrix[HMDT::xyToIndex(map.width, sx, sy)] = speck.id;
+                        }
+                    }
+
+                    host.adjacent_provinces.insert(speck.id);
+                    prov_project.getProvinces().emplace(speck.id, std::move(speck));
+                    ++speck_count;
+                }
+            }
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            auto absorbed = prov_project.absorbTinyProvinces();
+            RETURN_IF_ERROR(absorbed);
+
+            absorbed_count = absorbed->size();
+
+            return HMDT::STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("absorbed", absorbed_count);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, FindStraits) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    size_t straits = 0;
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        auto result = project.getMapProject().findStraits();
+        RETURN_IF_ERROR(result);
+
+        straits = result->size();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("straits", straits);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, BuildSupplyNetwork) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // Group the land provinces into states, same as UpdateStateIDMatrix
+    {
+        std::vector<HMDT::ProvinceID> land_provinces;
+        for(auto&& [id, province] : project.getMapProject().getProvinceProject().getProvinces())
+        {
+            if(province.type == HMDT::ProvinceType::LAND) {
+                land_provinces.push_back(id);
+            }
+        }
+        std::sort(land_provinces.begin(), land_provinces.end());
+
+        auto& state_project = project.getHistoryProject().getStateProject();
+        for(size_t i = 0; i < land_provinces.size(); i += PROVINCES_PER_STATE) {
+            auto end = std::min(land_provinces.size(), i + PROVINCES_PER_STATE);
+
+            state_project.addNewState({ land_provinces.begin() + i,
+                                        land_provinces.begin() + end });
+        }
+    }
+
+    size_t railways = 0;
+
+    state.setItemsPerIteration(project.getMapProject().getProvinceProject().getProvinces().size());
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        auto network = project.getMapProject().buildSupplyNetwork();
+        RETURN_IF_ERROR(network);
+
+        railways = network->railways.size();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("railways", railways);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, GenerateStrategicRegions) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& region_project = project.getMapProject().getStrategicRegionProject();
+
+    state.setItemsPerIteration(project.getMapProject().getProvinceProject().getProvinces().size());
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        return region_project.generateStrategicRegions(HMDT::DEFAULT_STRATEGIC_REGION_COUNT);
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("regions", region_project.getStrategicRegions().size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, GenerateStates) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    const auto& provinces = project.getMapProject().getProvinceProject().getProvinces();
+    auto& state_project = project.getHistoryProject().getStateProject();
+
+    state.setItemsPerIteration(std::count_if(provinces.begin(), provinces.end(),
+        [](auto&& pair) {
+            return pair.second.type == HMDT::ProvinceType::LAND;
+        }));
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        return state_project.generateStates(HMDT::DEFAULT_PROVINCES_PER_STATE, 1);
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("states", state_project.getStates().size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, FindLabelPoints) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& map_project = project.getMapProject();
+
+    state.setItemsPerIteration(map_project.getProvinceProject().getProvinces().size());
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        auto label_points = map_project.findLabelPoints();
+        RETURN_IF_ERROR(label_points);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, GenerateRivers) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& rivers_project = project.getMapProject().getRiversProject();
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return rivers_project.generateRivers(HMDT::DEFAULT_RIVER_MIN_CATCHMENT);
+    });
+}
+
+HMDT_BENCHMARK(Project, ValidateRivers) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // Validate a realistic set of rivers rather than an empty map
+    auto& rivers_project = project.getMapProject().getRiversProject();
+    res = rivers_project.generateRivers(HMDT::DEFAULT_RIVER_MIN_CATCHMENT);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        auto issues = rivers_project.validateRivers();
+        RETURN_IF_ERROR(issues);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, AssignTerrain) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // Band the heightmap into plains, forest, hills and mountains, so that
+    //   most provinces are split between a few terrains
+    auto pixel_count = static_cast<uint64_t>(map.width) * map.height;
+    std::unique_ptr<unsigned char[]> terrain(new unsigned char[pixel_count]);
+    std::transform(map.heightmap.get(), map.heightmap.get() + pixel_count,
+                   terrain.get(),
+                   [](unsigned char height) -> unsigned char {
+                       constexpr unsigned char BANDS[] = { 6, 3, 4, 5 };
+                       return BANDS[height / 64];
+                   });
+
+    res = HMDT::writeBMP2(path / HMDT::TERRAIN_FILENAME, terrain.get(),
+                          map.width, map.height, 1 /* depth */,
+                          true /* is_greyscale */);
+    RETURN_IF_ERROR(res);
+
+    auto& terrain_project = project.getMapProject().getTerrainProject();
+    res = terrain_project.loadFile(path / HMDT::TERRAIN_FILENAME);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(pixel_count);
+
+    size_t change_count = 0;
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        auto changes = terrain_project.calculateProvinceTerrains({});
+        RETURN_IF_ERROR(changes);
+
+        change_count = changes->size();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("changes", change_count);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, RenderMap) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& state_project = project.getHistoryProject().getStateProject();
+    res = state_project.generateStates(HMDT::DEFAULT_PROVINCES_PER_STATE, 1);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height * 2);
+
+    // Render the province and state views, as those are the two with borders
+    //   drawn from different layers
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        for(auto mode : { HMDT::MapMode::PROVINCES, HMDT::MapMode::STATES }) {
+            auto image = project.renderMap(mode, {});
+            RETURN_IF_ERROR(image);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, DiffProjects) {
+    auto& map = state.getSyntheticMap();
+
+    auto bitmap = HMDT::Benchmarks::makeBitMap(map);
+
+    // Both versions are imported from the same shapes, so that their
+    //   provinces share IDs the same way two revisions of a project would
+    std::shared_ptr<HMDT::MapData> map_data(new HMDT::MapData(map.width, map.height));
+    HMDT::ShapeFinder finder(bitmap.get(),
+                             HMDT::Benchmarks::NullGraphicsWorker::getInstance(),
+                             map_data);
+    finder.findAllShapes();
+
+    HMDT::Project::HoI4Project old_project;
+    HMDT::Project::HoI4Project new_project;
+
+    for(auto* project : { &old_project, &new_project }) {
+        project->getMapProject().import(finder, map_data);
+
+        auto project_map_data = project->getMapProject().getMapData();
+        std::copy_n(map.heightmap.get(), project_map_data->getHeightMapSize(),
+                    project_map_data->getHeightMap().lock().get());
+    }
+
+    // Shift a band of provinces over by a few pixels and raise the terrain
+    //   under it, about what a round of hand edits between two commits would
+    //   touch
+    {
+        auto map_data = new_project.getMapProject().getMapData();
+        auto provinces = map_data->getProvinces().lock();
+        auto heightmap = map_data->getHeightMap().lock();
+
+        for(uint32_t y = map.height / 4; y < map.height / 2; ++y) {
+            for(uint32_t x = map.width - 1; x >= 8; --x) {
+                auto index = HMDT::xyToIndex(map.width, x, y);
+
+                provinces[index] = provinces[HMDT::xyToIndex(map.width, x - 8, y)];
+                heightmap[index] = std::min(heightmap[index] + 8, 255);
+            }
+        }
+    }
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        auto diff = new_project.diff(old_project);
+        RETURN_IF_ERROR(diff);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, ProvinceStatistics) {
+    auto& map = state.getSyntheticMap();
+    auto input_path = state.getWorkDir() / "input_heightmap.bmp";
+
+    auto res = HMDT::writeBMP2(input_path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    HMDT::Project::HoI4Project project;
+
+    res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& map_project = project.getMapProject();
+
+    res = map_project.getHeightMapProject().loadFile(input_path);
+    RETURN_IF_ERROR(res);
+
+    // Compute statistics from a realistic set of rivers rather than none
+    res = map_project.getRiversProject().generateRivers(HMDT::DEFAULT_RIVER_MIN_CATCHMENT);
+    RETURN_IF_ERROR(res);
+
+    auto id = map_project.getProvinceProject().getProvinces().begin()->first;
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        // Every layer changed, so everything is computed again
+        map_project.invalidateProvinceStatistics(HMDT::ZONAL_LAYER_ALL);
+
+        auto statistics = map_project.getProvinceStatistics(id);
+        RETURN_IF_ERROR(statistics);
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(Project, ExtractBorders) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    // Trace a realistic set of state borders rather than a single state
+    res = project.getHistoryProject().getStateProject().generateStates(HMDT::DEFAULT_PROVINCES_PER_STATE, 1);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    size_t arc_count = 0;
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        auto layers = project.extractBorders(0);
+        RETURN_IF_ERROR(layers);
+
+        arc_count = layers->front().arcs.size();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("province_arcs", arc_count);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, SaveShapeData) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& prov_project = project.getMapProject().getProvinceProject();
+
+    state.setItemsPerIteration(prov_project.getProvinces().size());
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return prov_project.save(path);
+    });
+}
+
+HMDT_BENCHMARK(Project, LoadShapeData) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir();
+
+    // Save out the data with one project, and load it with another
+    {
+        HMDT::Project::HoI4Project project;
+
+        auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+        RETURN_IF_ERROR(res);
+
+        res = project.getMapProject().getProvinceProject().save(path);
+        RETURN_IF_ERROR(res);
+    }
+
+    std::unique_ptr<HMDT::Project::HoI4Project> project;
+
+    auto res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            project.reset(new HMDT::Project::HoI4Project);
+
+            auto map_data = project->getMapProject().getMapData();
+            map_data->~MapData();
+            new (map_data.get()) HMDT::MapData(map.width, map.height);
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            return project->getMapProject().getProvinceProject().load(path);
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(project->getMapProject().getProvinceProject().getProvinces().size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, ExportProvinces) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir();
+
+    HMDT::Project::HoI4Project project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& prov_project = project.getMapProject().getProvinceProject();
+
+    // Generated provinces have no continent, which export will ask about.
+    //   Always answer "Continue".
+    prov_project.setPromptCallback(
+        [](const std::string&, const std::vector<std::string>&,
+           const HMDT::Project::IProject::PromptType&)
+            -> uint32_t
+        {
+            return 0;
+        });
+
+    state.setItemsPerIteration(prov_project.getProvinces().size());
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return prov_project.export_(path);
+    });
+}
+
+HMDT_BENCHMARK(Project, ExportHeightMap) {
+    auto& map = state.getSyntheticMap();
+    auto path = state.getWorkDir();
+    auto input_path = path / "input_heightmap.bmp";
+
+    auto res = HMDT::writeBMP2(input_path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    HMDT::Project::HoI4Project project;
+
+    {
+        auto map_data = project.getMapProject().getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(map.width, map.height);
+    }
+
+    auto& heightmap_project = project.getMapProject().getHeightMapProject();
+
+    res = heightmap_project.loadFile(input_path);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return heightmap_project.export_(path);
+    });
+}
+
+
+HMDT_BENCHMARK(Project, RegenerateNormalMap) {
+    auto& map = state.getSyntheticMap();
+    auto input_path = state.getWorkDir() / "input_heightmap.bmp";
+
+    auto res = HMDT::writeBMP2(input_path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    HMDT::Project::HoI4Project project;
+
+    {
+        auto map_data = project.getMapProject().getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(map.width, map.height);
+    }
+
+    // regenerateNormalMap is not part of the IHeightMapProject interface
+    auto& heightmap_project = dynamic_cast<HMDT::Project::HeightMapProject&>(
+            project.getMapProject().getHeightMapProject());
+
+    res = heightmap_project.loadFile(input_path);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return heightmap_project.regenerateNormalMap();
+    });
+}
+
+HMDT_BENCHMARK(Project, SculptHeightMap) {
+    auto& map = state.getSyntheticMap();
+    auto input_path = state.getWorkDir() / "input_heightmap.bmp";
+
+    auto res = HMDT::writeBMP2(input_path, map.heightmap.get(), map.width,
+                               map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    HMDT::Project::HoI4Project project;
+
+    {
+        auto map_data = project.getMapProject().getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(map.width, map.height);
+    }
+
+    auto& heightmap_project = project.getMapProject().getHeightMapProject();
+
+    res = heightmap_project.loadFile(input_path);
+    RETURN_IF_ERROR(res);
+
+    // A short drag of a brush, about what a single mouse-move event would
+    //   produce, and then bringing the normal map up to date again. Each run is
+    //   undone again afterwards, so every iteration does the same amount of
+    //   work.
+    HMDT::Dimensions dimensions{ map.width, map.height };
+    std::vector<HMDT::Point2D> path{ { map.width / 2, map.height / 2 },
+                                     { map.width / 2 + 16, map.height / 2 + 8 } };
+    auto pixels = HMDT::getPixelsAlongStroke(dimensions, path, 12);
+
+    std::optional<HMDT::Project::IHeightMapProject::HeightMapEdit> edit;
+    size_t regions = 0;
+
+    state.setItemsPerIteration(pixels.size());
+
+    res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            if(edit) {
+                auto result = heightmap_project.revertHeightMapEdit(*edit);
+                RETURN_IF_ERROR(result);
+
+                edit = std::nullopt;
+            }
+
+            auto updated = heightmap_project.updateNormalMap();
+            RETURN_IF_ERROR(updated);
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            auto maybe_edit = heightmap_project.sculpt(
+                    HMDT::Project::IHeightMapProject::SculptMode::RAISE,
+                    pixels, 8);
+            RETURN_IF_ERROR(maybe_edit);
+
+            edit = std::move(*maybe_edit);
+
+            auto updated = heightmap_project.updateNormalMap();
+            RETURN_IF_ERROR(updated);
+
+            regions = updated->size();
+
+            return HMDT::STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("regions", regions);
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, ImportMod) {
+    auto& map = state.getSyntheticMap();
+
+    // Build a mod folder out of the synthetic map, in the same layout as the
+    //   base game's: every province gets its own color
+    HMDT::Project::HoI4Project source_project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(source_project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& source_prov_project = source_project.getMapProject().getProvinceProject();
+
+    auto mod_root = state.getWorkDir() / "mod";
+    auto map_root = mod_root / "map";
+    auto states_root = mod_root / "history" / "states";
+
+    std::error_code ec;
+    std::filesystem::create_directories(map_root, ec);
+    RETURN_ERROR_IF(ec.value() != 0, ec);
+    std::filesystem::create_directories(states_root, ec);
+    RETURN_ERROR_IF(ec.value() != 0, ec);
+
+    uint64_t size = static_cast<uint64_t>(map.width) * map.height;
+    {
+        std::unique_ptr<unsigned char[]> pixels(new unsigned char[size * 3]);
+        auto prov_matrix = source_project.getMapProject().getMapData()->getProvinces().lock();
+
+        for(uint64_t i = 0; i < size; ++i) {
+            const auto& color = source_prov_project.getProvinceForID(prov_matrix[i]).unique_color;
+            pixels[i * 3] = color.r;
+            pixels[i * 3 + 1] = color.g;
+            pixels[i * 3 + 2] = color.b;
+        }
+
+        res = HMDT::writeBMP2(map_root / HMDT::PROVINCES_FILENAME, pixels.get(),
+                              map.width, map.height, 3);
+        RETURN_IF_ERROR(res);
+
+        res = HMDT::writeBMP2(map_root / HMDT::HEIGHTMAP_FILENAME,
+                              map.heightmap.get(), map.width, map.height, 1,
+                              true);
+        RETURN_IF_ERROR(res);
+    }
+
+    uint32_t province_count = source_prov_project.getProvinces().size();
+    {
+        std::ofstream out(map_root / HMDT::PROVINCEDATA_FILENAME);
+        out << "0;0;0;0;land;false;unknown;0\n";
+
+        for(auto&& [id, province] : source_prov_project.getProvinces()) {
+            out << source_prov_project.getIDForProvinceID(id) << ';'
+                << +province.unique_color.r << ';'
+                << +province.unique_color.g << ';'
+                << +province.unique_color.b << ';'
+                << province.type << ';' << std::boolalpha << province.coastal
+                << ';' << province.terrain << ';' << 1 << '\n';
+        }
+    }
+    {
+        std::ofstream out(map_root / HMDT::CONTINENT_FILENAME);
+        out << "continents = {\n\teurope\n}\n";
+    }
+
+    // One state file for every PROVINCES_PER_STATE provinces
+    for(uint32_t first = 1; first <= province_count; first += PROVINCES_PER_STATE)
+    {
+        auto state_id = (first - 1) / PROVINCES_PER_STATE + 1;
+
+        std::ofstream out(states_root / (std::to_string(state_id) + "-State.txt"));
+        out << "state={\n\tid=" << state_id << "\n\tname=\"STATE_" << state_id
+            << "\"\n\tmanpower=1000\n\tstate_category = rural\n"
+               "\thistory={\n\t\towner = GER\n\t\tbuildings = { infrastructure = 2 }\n\t}\n"
+               "\tprovinces={\n\t\t";
+        for(auto id = first; id < first + PROVINCES_PER_STATE && id <= province_count; ++id) {
+            out << id << ' ';
+        }
+        out << "\n\t}\n}\n";
+    }
+
+    HMDT::Project::HoI4Project project;
+    project.setPath(state.getWorkDir() / "project" / "benchmark.hoi4proj");
+
+    state.setItemsPerIteration(size);
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        return project.importMod(mod_root);
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("provinces", project.getMapProject().getProvinceProject().getProvinces().size());
+    state.setCounter("states", project.getHistoryProject().getStateProject().getStates().size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
+HMDT_BENCHMARK(Project, GenerateProvinces) {
+    auto& map = state.getSyntheticMap();
+
+    HMDT::Project::HoI4Project source_project;
+
+    auto res = HMDT::Benchmarks::importSyntheticMap(source_project, map);
+    RETURN_IF_ERROR(res);
+
+    auto& source_prov_project = source_project.getMapProject().getProvinceProject();
+
+    // Turn the synthetic map back into the kind of mask a modder would paint,
+    //   with the heightmap deciding where provinces are densest
+    uint64_t size = static_cast<uint64_t>(map.width) * map.height;
+    std::vector<uint8_t> mask(size * 3, 0);
+    {
+        auto prov_matrix = source_project.getMapProject().getMapData()->getProvinces().lock();
+
+        for(uint64_t i = 0; i < size; ++i) {
+            switch(source_prov_project.getProvinceForID(prov_matrix[i]).type) {
+                case HMDT::ProvinceType::SEA:
+                    mask[i * 3 + 2] = 0xFF;
+                    break;
+                case HMDT::ProvinceType::LAKE:
+                    mask[i * 3 + 1] = 0xFF;
+                    break;
+                default:
+                    mask[i * 3] = 0xFF;
+                    break;
+            }
+        }
+    }
+
+    HMDT::ProvinceGeneratorOptions options;
+    options.province_count = map.province_count;
+    options.seed = 1;
+
+    size_t generated_count = 0;
+
+    state.setItemsPerIteration(size);
+
+    res = state.measure([&]() -> HMDT::MaybeVoid {
+        auto generated = HMDT::generateProvinceMap(HMDT::Dimensions{ map.width, map.height },
+                                                   mask.data(),
+                                                   map.heightmap.get(),
+                                                   options);
+        RETURN_IF_ERROR(generated);
+
+        generated_count = generated->definitions.size();
+
+        return HMDT::STATUS_SUCCESS;
+    });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("provinces", generated_count);
+
+    return HMDT::STATUS_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file RecordParserBenchmarks.cpp
+ *
+ * @brief Benchmarks for parsing the .csv files of a project, compared against
+ *        the older stream-based parser.
+ */
+
+#include "Benchmark.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "RecordParser.h"
+#include "Util.h"
+
+namespace {
+    //! How many lines to put into each generated file
+    constexpr size_t RECORD_COUNT = 100000;
+
+    //! How many provinces to list in each line of the state data
+    constexpr size_t PROVINCES_PER_STATE = 8;
+
+    /**
+     * @brief Creates a province to parse into, without generating any UUIDs
+     */
+    HMDT::Province makeEmptyProvince() {
+        return HMDT::Province{
+            HMDT::EMPTY_UUID, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::UNKNOWN,
+            false, "", "", 0, { { 0, 0 }, { 0, 0 } }, { },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    /**
+     * @brief Writes a province data file in the same format as
+     *        ProvinceProject saves it.
+     */
+    HMDT::MaybeVoid writeProvinceData(const std::filesystem::path& path) {
+        std::ofstream out(path);
+        RETURN_ERROR_IF(!out, std::make_error_code(std::errc::io_error));
+
+        for(size_t i = 0; i < RECORD_COUNT; ++i) {
+            out << HMDT::UUID() << ';'
+                << (i % 256) << ';' << ((i / 256) % 256) << ';' << (i % 7) << ';'
+                << ((i % 3 == 0) ? "sea" : "land") << ';'
+                << ((i % 5 == 0) ? "true" : "false") << ';'
+                << "plains" << ';' << "europe" << ';'
+                << (i % 5632) << ';' << (i % 2048) << ';'
+                << (i % 5632 + 12) << ';' << (i % 2048 + 9) << ';'
+                << (i % 1000) << ';' << HMDT::INVALID_PROVINCE << '\n';
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Writes a state data file in the same format as StateProject
+     *        saves it.
+     */
+    HMDT::MaybeVoid writeStateData(const std::filesystem::path& path) {
+        std::ofstream out(path);
+        RETURN_ERROR_IF(!out, std::make_error_code(std::errc::io_error));
+
+        for(size_t i = 0; i < RECORD_COUNT; ++i) {
+            out << (i + 1) << ";State " << (i + 1) << ';' << (i * 1000) << ';'
+                << "rural" << ';' << 1.5 << ';' << (i % 2) << ';';
+
+            for(size_t p = 0; p < PROVINCES_PER_STATE; ++p) {
+                out << HMDT::UUID() << ',';
+            }
+
+            out << ';' << (i % 256) << ';' << ((i / 256) % 256) << ';' << 7
+                << '\n';
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+}
+
+HMDT_BENCHMARK(RecordParser, ParseProvinceData) {
+    auto path = state.getWorkDir() / "province_data.csv";
+
+    auto res = writeProvinceData(path);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(RECORD_COUNT);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        auto contents = HMDT::readFileToString(path);
+        RETURN_IF_ERROR(contents);
+
+        HMDT::RecordParser parser(*contents, ';');
+        while(parser.nextRecord()) {
+            auto prov = makeEmptyProvince();
+
+            auto res = parser.parseFields(prov.id,
+                                          prov.unique_color.r,
+                                          prov.unique_color.g,
+                                          prov.unique_color.b,
+                                          prov.type,
+                                          prov.coastal,
+                                          prov.terrain,
+                                          prov.continent,
+                                          prov.bounding_box.bottom_left.x,
+                                          prov.bounding_box.bottom_left.y,
+                                          prov.bounding_box.top_right.x,
+                                          prov.bounding_box.top_right.y);
+            RETURN_IF_ERROR(res);
+
+            res = parser.parseOptionalFields(prov.state, prov.parent_id);
+            RETURN_IF_ERROR(res);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(RecordParser, ParseProvinceDataStream) {
+    auto path = state.getWorkDir() / "province_data.csv";
+
+    auto res = writeProvinceData(path);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(RECORD_COUNT);
+
+    // The parser which was used before RecordParser, kept to compare against
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        std::ifstream in(path);
+
+        std::string line;
+        while(std::getline(in, line)) {
+            if(line.empty()) continue;
+
+            std::stringstream ss(line);
+
+            auto prov = makeEmptyProvince();
+            if(!HMDT::parseValuesSkipMissing<';'>(ss, &prov.id,
+                                                      &prov.unique_color.r,
+                                                      &prov.unique_color.g,
+                                                      &prov.unique_color.b,
+                                                      &prov.type,
+                                                      &prov.coastal,
+                                                      &prov.terrain,
+                                                      &prov.continent,
+                                                      &prov.bounding_box.bottom_left.x,
+                                                      &prov.bounding_box.bottom_left.y,
+                                                      &prov.bounding_box.top_right.x,
+                                                      &prov.bounding_box.top_right.y,
+                                                      &prov.state, true,
+                                                      &prov.parent_id, true))
+            {
+                RETURN_ERROR(HMDT::STATUS_INVALID_FIELD);
+            }
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
+HMDT_BENCHMARK(RecordParser, ParseStateData) {
+    auto path = state.getWorkDir() / "state_data.csv";
+
+    auto res = writeStateData(path);
+    RETURN_IF_ERROR(res);
+
+    state.setItemsPerIteration(RECORD_COUNT);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        auto contents = HMDT::readFileToString(path);
+        RETURN_IF_ERROR(contents);
+
+        HMDT::RecordParser parser(*contents, ';');
+        while(parser.nextRecord()) {
+            HMDT::State s;
+
+            auto res = parser.parseFields(s.id,
+                                          s.name,
+                                          s.manpower,
+                                          s.category,
+                                          s.buildings_max_level_factor,
+                                          s.impassable);
+            RETURN_IF_ERROR(res);
+
+            res = parser.parseListField<HMDT::ProvinceID>(',',
+                    [&s](const HMDT::ProvinceID& id) -> HMDT::MaybeVoid {
+                        s.provinces.push_back(id);
+                        return HMDT::STATUS_SUCCESS;
+                    });
+            RETURN_IF_ERROR(res);
+
+            res = parser.parseOptionalFields(s.color.r, s.color.g, s.color.b);
+            RETURN_IF_ERROR(res);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
+
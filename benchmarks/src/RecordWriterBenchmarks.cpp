@@ -0,0 +1,109 @@
+/**
+ * @file RecordWriterBenchmarks.cpp
+ *
+ * @brief Benchmarks for writing the .csv files of a project, compared against
+ *        the older stream-based writer.
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "RecordWriter.h"
+
+namespace {
+    //! How many provinces to write into each file
+    constexpr size_t RECORD_COUNT = 100000;
+
+    /**
+     * @brief Creates provinces to write, sorted by their IDs
+     */
+    std::vector<HMDT::Province> makeProvinces() {
+        std::vector<HMDT::Province> provinces;
+        provinces.reserve(RECORD_COUNT);
+
+        for(size_t i = 0; i < RECORD_COUNT; ++i) {
+            provinces.push_back(HMDT::Province{
+                HMDT::UUID(),
+                HMDT::Color{ static_cast<uint8_t>(i % 256),
+                             static_cast<uint8_t>((i / 256) % 256),
+                             static_cast<uint8_t>(i % 7) },
+                (i % 3 == 0) ? HMDT::ProvinceType::SEA : HMDT::ProvinceType::LAND,
+                (i % 5 == 0), "plains", "europe",
+                static_cast<HMDT::StateID>(i % 1000),
+                { { static_cast<uint32_t>(i % 5632), static_cast<uint32_t>(i % 2048) },
+                  { static_cast<uint32_t>(i % 5632 + 12), static_cast<uint32_t>(i % 2048 + 9) } },
+                { }, HMDT::INVALID_PROVINCE, { }
+            });
+        }
+
+        std::sort(provinces.begin(), provinces.end(),
+                  [](const HMDT::Province& p1, const HMDT::Province& p2) {
+                      return p1.id < p2.id;
+                  });
+
+        return provinces;
+    }
+}
+
+HMDT_BENCHMARK(RecordWriter, WriteProvinceData) {
+    auto path = state.getWorkDir() / "province_data.csv";
+    auto provinces = makeProvinces();
+
+    state.setItemsPerIteration(RECORD_COUNT);
+
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        return HMDT::writeRecordsToFile(path, provinces.size(), ';',
+            [&provinces](size_t i, HMDT::RecordWriter& writer) {
+                const auto& province = provinces[i];
+
+                writer.writeRecord(province.id,
+                                   province.unique_color.r,
+                                   province.unique_color.g,
+                                   province.unique_color.b,
+                                   province.type,
+                                   province.coastal,
+                                   province.terrain,
+                                   province.continent,
+                                   province.bounding_box.bottom_left.x,
+                                   province.bounding_box.bottom_left.y,
+                                   province.bounding_box.top_right.x,
+                                   province.bounding_box.top_right.y,
+                                   province.state,
+                                   province.parent_id);
+            });
+    });
+}
+
+HMDT_BENCHMARK(RecordWriter, WriteProvinceDataStream) {
+    auto path = state.getWorkDir() / "province_data.csv";
+    auto provinces = makeProvinces();
+
+    state.setItemsPerIteration(RECORD_COUNT);
+
+    // The writer which was used before RecordWriter, kept to compare against
+    return state.measure([&]() -> HMDT::MaybeVoid {
+        std::ofstream out(path);
+        RETURN_ERROR_IF(!out, std::make_error_code(std::errc::io_error));
+
+        for(auto&& province : provinces) {
+            out << province.id << ';'
+                << static_cast<int>(province.unique_color.r) << ';'
+                << static_cast<int>(province.unique_color.g) << ';'
+                << static_cast<int>(province.unique_color.b) << ';'
+                << province.type << ';'
+                << (province.coastal ? "true" : "false")
+                << ';' << province.terrain << ';'
+                << province.continent << ';'
+                << province.bounding_box.bottom_left.x << ';'
+                << province.bounding_box.bottom_left.y << ';'
+                << province.bounding_box.top_right.x << ';'
+                << province.bounding_box.top_right.y << ';'
+                << province.state << ';'
+                << province.parent_id << std::endl;
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    });
+}
@@ -0,0 +1,45 @@
+/**
+ * @file ShapeFinderBenchmarks.cpp
+ *
+ * @brief Benchmarks for the shape detection algorithm.
+ */
+
+#include "Benchmark.h"
+#include "BenchmarkUtils.h"
+
+#include "MapData.h"
+#include "ShapeFinder2.h"
+
+HMDT_BENCHMARK(ShapeFinder, FindAllShapes) {
+    auto& map = state.getSyntheticMap();
+    auto bitmap = HMDT::Benchmarks::makeBitMap(map);
+
+    std::shared_ptr<HMDT::MapData> map_data;
+    std::unique_ptr<HMDT::ShapeFinder> finder;
+
+    state.setItemsPerIteration(static_cast<uint64_t>(map.width) * map.height);
+
+    auto res = state.measure(
+        [&]() -> HMDT::MaybeVoid {
+            // Every run must start from a clean MapData, as the ShapeFinder
+            //   writes its labels into it
+            map_data.reset(new HMDT::MapData(map.width, map.height));
+            finder.reset(new HMDT::ShapeFinder(bitmap.get(),
+                         HMDT::Benchmarks::NullGraphicsWorker::getInstance(),
+                         map_data));
+
+            return HMDT::STATUS_SUCCESS;
+        },
+        [&]() -> HMDT::MaybeVoid {
+            finder->findAllShapes();
+
+            return HMDT::STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(res);
+
+    state.setCounter("shapes", finder->getShapes().size());
+    state.setCounter("border_pixels", finder->getBorderPixels().size());
+
+    return HMDT::STATUS_SUCCESS;
+}
+
@@ -0,0 +1,358 @@
+/**
+ * @file SyntheticMapGenerator.cpp
+ *
+ * @brief Defines the deterministic synthetic map generator.
+ *
+ * @details Every random value is derived from a SplitMix64 stream (or a hash
+ *          of the pixel coordinates), rather than from std::*_distribution,
+ *          since the distributions are not guaranteed to produce the same
+ *          sequence across standard library implementations.
+ */
+
+#include "SyntheticMapGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+
+#include "BitMap.h"
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    /**
+     * @brief A tiny, portable PRNG
+     */
+    struct SplitMix64 {
+        uint64_t state;
+
+        uint64_t next() noexcept {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        //! Returns a value in [0, 1)
+        double nextDouble() noexcept {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    /**
+     * @brief Hashes a lattice point into a value in [0, 1)
+     */
+    double latticeValue(int64_t x, int64_t y, uint64_t seed) noexcept {
+        SplitMix64 rng{ seed ^ (static_cast<uint64_t>(x) * 0x8DA6B343ULL)
+                             ^ (static_cast<uint64_t>(y) * 0xD8163841ULL) };
+        return rng.nextDouble();
+    }
+
+    /**
+     * @brief Samples smoothed value noise at the given position
+     */
+    double valueNoise(double x, double y, uint64_t seed) noexcept {
+        auto x0 = static_cast<int64_t>(std::floor(x));
+        auto y0 = static_cast<int64_t>(std::floor(y));
+
+        double tx = x - x0;
+        double ty = y - y0;
+
+        // Smoothstep the interpolation weights so the lattice is not visible
+        tx = tx * tx * (3.0 - 2.0 * tx);
+        ty = ty * ty * (3.0 - 2.0 * ty);
+
+        double v00 = latticeValue(x0,     y0,     seed);
+        double v10 = latticeValue(x0 + 1, y0,     seed);
+        double v01 = latticeValue(x0,     y0 + 1, seed);
+        double v11 = latticeValue(x0 + 1, y0 + 1, seed);
+
+        double top = v00 + (v10 - v00) * tx;
+        double bot = v01 + (v11 - v01) * tx;
+
+        return top + (bot - top) * ty;
+    }
+
+    /**
+     * @brief Samples several octaves of value noise, normalized to [0, 1)
+     *
+     * @param x The X coordinate, in units of the lowest octave's lattice
+     * @param y The Y coordinate, in units of the lowest octave's lattice
+     * @param octaves How many octaves to sum
+     * @param seed The noise seed
+     */
+    double fractalNoise(double x, double y, uint32_t octaves, uint64_t seed)
+        noexcept
+    {
+        double total = 0.0;
+        double amplitude = 1.0;
+        double max_total = 0.0;
+
+        for(uint32_t o = 0; o < octaves; ++o) {
+            total += valueNoise(x, y, seed + o) * amplitude;
+            max_total += amplitude;
+
+            x *= 2.0;
+            y *= 2.0;
+            amplitude *= 0.5;
+        }
+
+        return total / max_total;
+    }
+
+    /**
+     * @brief Runs func(start_row, end_row) over the rows of the image, split
+     *        evenly between all available hardware threads.
+     */
+    template<typename F>
+    void forEachRowBand(uint32_t height, F&& func) {
+        uint32_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+        uint32_t rows_per_thread = (height + num_threads - 1) / num_threads;
+
+        std::vector<std::future<void>> futures;
+        for(uint32_t start = 0; start < height; start += rows_per_thread) {
+            uint32_t end = std::min(height, start + rows_per_thread);
+
+            futures.push_back(std::async(std::launch::async, func, start, end));
+        }
+
+        for(auto& future : futures) {
+            future.get();
+        }
+    }
+
+    //! Number of lattice cells across the map used for the land/sea noise
+    constexpr double CONTINENT_FREQUENCY = 3.0;
+
+    //! Number of lattice cells across the map used for the heightmap noise
+    constexpr double TERRAIN_FREQUENCY = 16.0;
+
+    //! The lowest height value which HoI4 will consider to be above sea-level
+    constexpr uint8_t SEA_LEVEL = 95;
+}
+
+/**
+ * @brief Generates a synthetic Voronoi province map and matching heightmap.
+ *
+ * @param opts The options to generate the map with
+ *
+ * @return The generated map
+ */
+auto HMDT::Benchmarks::generateSyntheticMap(const SyntheticMapOptions& opts)
+    -> SyntheticMap
+{
+    const uint32_t width = opts.width;
+    const uint32_t height = opts.height;
+    const uint32_t num_sites = std::max(1U, opts.province_count);
+    const uint64_t num_pixels = static_cast<uint64_t>(width) * height;
+
+    SplitMix64 rng{ opts.seed };
+
+    // Place every site
+    std::vector<Point2D> sites(num_sites);
+    for(auto& site : sites) {
+        site.x = static_cast<uint32_t>(rng.next() % width);
+        site.y = static_cast<uint32_t>(rng.next() % height);
+    }
+
+    // Decide which sites are land by ranking them on low-frequency noise, so
+    //   that land gathers into continents rather than being scattered
+    std::vector<ProvinceType> site_types(num_sites, ProvinceType::SEA);
+    {
+        auto scale = CONTINENT_FREQUENCY / std::max(width, height);
+
+        std::vector<double> elevation(num_sites);
+        for(uint32_t i = 0; i < num_sites; ++i) {
+            elevation[i] = fractalNoise(sites[i].x * scale, sites[i].y * scale,
+                                        4, opts.seed);
+        }
+
+        std::vector<uint32_t> ranking(num_sites);
+        std::iota(ranking.begin(), ranking.end(), 0);
+        std::stable_sort(ranking.begin(), ranking.end(),
+                         [&elevation](uint32_t a, uint32_t b) {
+                             return elevation[a] > elevation[b];
+                         });
+
+        auto land_ratio = std::clamp(opts.land_ratio, 0.0, 1.0);
+        auto num_land = static_cast<uint32_t>(std::lround(land_ratio * num_sites));
+
+        for(uint32_t r = 0; r < num_land; ++r) {
+            site_types[ranking[r]] = ProvinceType::LAND;
+        }
+
+        // Turn some land into lakes. Walk in index order so that the result
+        //   only depends on the seed.
+        for(uint32_t i = 0; i < num_sites; ++i) {
+            if(site_types[i] == ProvinceType::LAND &&
+               rng.nextDouble() < opts.lake_ratio)
+            {
+                site_types[i] = ProvinceType::LAKE;
+            }
+        }
+    }
+
+    // Bucket the sites into a uniform grid, so that the nearest site to each
+    //   pixel can be found by only looking at nearby cells
+    const uint32_t cell_size = std::max(1U, static_cast<uint32_t>(
+                std::sqrt(static_cast<double>(num_pixels) / num_sites)));
+    const uint32_t grid_w = (width + cell_size - 1) / cell_size;
+    const uint32_t grid_h = (height + cell_size - 1) / cell_size;
+
+    std::vector<uint32_t> cell_starts(grid_w * grid_h + 1, 0);
+    std::vector<uint32_t> cell_sites(num_sites);
+    {
+        for(auto&& site : sites) {
+            ++cell_starts[(site.y / cell_size) * grid_w + site.x / cell_size + 1];
+        }
+        std::partial_sum(cell_starts.begin(), cell_starts.end(),
+                         cell_starts.begin());
+
+        std::vector<uint32_t> cursor(cell_starts.begin(), cell_starts.end() - 1);
+        for(uint32_t i = 0; i < num_sites; ++i) {
+            auto cell = (sites[i].y / cell_size) * grid_w + sites[i].x / cell_size;
+            cell_sites[cursor[cell]++] = i;
+        }
+    }
+
+    // Find the owning site of every pixel
+    std::vector<uint32_t> owners(num_pixels);
+    forEachRowBand(height, [&](uint32_t start, uint32_t end) {
+        const int64_t max_ring = std::max(grid_w, grid_h);
+
+        for(uint32_t y = start; y < end; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                const int64_t cx = x / cell_size;
+                const int64_t cy = y / cell_size;
+
+                uint64_t best_dist = std::numeric_limits<uint64_t>::max();
+                uint32_t best_site = 0;
+
+                for(int64_t ring = 0; ring <= max_ring; ++ring) {
+                    for(int64_t gy = cy - ring; gy <= cy + ring; ++gy) {
+                        if(gy < 0 || gy >= grid_h) continue;
+
+                        // Only the outer edge of the ring is new
+                        int64_t step = (gy == cy - ring || gy == cy + ring) ? 1 : ring * 2;
+                        for(int64_t gx = cx - ring; gx <= cx + ring; gx += step) {
+                            if(gx < 0 || gx >= grid_w) continue;
+
+                            auto cell = gy * grid_w + gx;
+                            for(auto i = cell_starts[cell]; i < cell_starts[cell + 1]; ++i)
+                            {
+                                auto site_idx = cell_sites[i];
+                                int64_t dx = static_cast<int64_t>(sites[site_idx].x) - x;
+                                int64_t dy = static_cast<int64_t>(sites[site_idx].y) - y;
+                                uint64_t dist = dx * dx + dy * dy;
+
+                                // Break ties on the index so the result does
+                                //   not depend on the visiting order
+                                if(dist < best_dist ||
+                                   (dist == best_dist && site_idx < best_site))
+                                {
+                                    best_dist = dist;
+                                    best_site = site_idx;
+                                }
+                            }
+                        }
+                    }
+
+                    // Every site in the next ring is at least ring*cell_size
+                    //   pixels away, so we can stop once we beat that
+                    uint64_t ring_dist = static_cast<uint64_t>(ring) * cell_size;
+                    if(best_dist <= ring_dist * ring_dist) {
+                        break;
+                    }
+                }
+
+                owners[xyToIndex(width, x, y)] = best_site;
+            }
+        }
+    });
+
+    SyntheticMap map{
+        width, height, num_sites,
+        std::unique_ptr<unsigned char[]>(new unsigned char[num_pixels * 3]),
+        std::unique_ptr<unsigned char[]>(new unsigned char[num_pixels])
+    };
+
+    // Paint the province map and the heightmap
+    forEachRowBand(height, [&](uint32_t start, uint32_t end) {
+        auto scale = TERRAIN_FREQUENCY / std::max(width, height);
+
+        for(uint32_t y = start; y < end; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = xyToIndex(width, x, y);
+                auto owner = owners[index];
+                auto type = site_types[owner];
+
+                // Borders are placed on the right/bottom side of every edge,
+                //   which keeps them exactly one pixel wide
+                bool is_border = (x + 1 < width && owners[index + 1] != owner) ||
+                                 (y + 1 < height && owners[index + width] != owner);
+
+                Color color = BORDER_COLOR;
+                if(!is_border) {
+                    switch(type) {
+                        case ProvinceType::LAND:
+                            color = Color{ 0xFF, 0, 0 };
+                            break;
+                        case ProvinceType::LAKE:
+                            color = Color{ 0, 0xFF, 0 };
+                            break;
+                        case ProvinceType::SEA:
+                        case ProvinceType::UNKNOWN:
+                            color = Color{ 0, 0, 0xFF };
+                            break;
+                    }
+                }
+
+                writeColorTo(map.provinces.get(), width, x, y, color);
+
+                auto noise = fractalNoise(x * scale, y * scale, 5,
+                                          opts.seed ^ 0xA5A5A5A5ULL);
+                if(type == ProvinceType::SEA) {
+                    map.heightmap[index] = static_cast<uint8_t>(20 + noise * (SEA_LEVEL - 25));
+                } else {
+                    map.heightmap[index] = static_cast<uint8_t>(SEA_LEVEL + 1 + noise * 150);
+                }
+            }
+        }
+    });
+
+    return map;
+}
+
+/**
+ * @brief Writes a generated map out to disk as .BMP files.
+ *
+ * @param map The map to write
+ * @param provinces_path Where to write the province map
+ * @param heightmap_path Where to write the heightmap
+ *
+ * @return STATUS_SUCCESS on success, or a failure code if either image could
+ *         not be written.
+ */
+auto HMDT::Benchmarks::writeSyntheticMap(const SyntheticMap& map,
+                                         const std::filesystem::path& provinces_path,
+                                         const std::filesystem::path& heightmap_path)
+    -> MaybeVoid
+{
+    auto res = writeBMP2(provinces_path, map.provinces.get(),
+                         map.width, map.height, 3);
+    RETURN_IF_ERROR(res);
+
+    res = writeBMP2(heightmap_path, map.heightmap.get(),
+                    map.width, map.height, 1, true);
+    RETURN_IF_ERROR(res);
+
+    return STATUS_SUCCESS;
+}
+
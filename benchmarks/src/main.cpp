@@ -0,0 +1,215 @@
+/**
+ * @file main.cpp
+ *
+ * @brief The starting point of the benchmark program
+ */
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <getopt.h>
+
+#include "Logger.h"
+#include "Message.h"
+#include "ConsoleOutputFunctions.h"
+
+#include "Options.h"
+
+#include "Benchmark.h"
+
+/**
+ * @brief The program options, normally defined in the exe. The benchmarks
+ *        always run quietly so that logging doesn't skew the results.
+ */
+HMDT::ProgramOptions HMDT::prog_opts = {
+    0, "", "", false, true, "", "", false, "", false, true, false, true, false, false, false, "", 1.0, "", "", "text", "", "", "", 0.0
+};
+
+namespace {
+    //! The name of the program executable
+    std::string program_name = "benchmarks";
+
+    /**
+     * @brief Null output buffer
+     */
+    class NullBuffer: public std::streambuf {
+        public:
+            int overflow(int c) { return c; }
+    };
+
+    /**
+     * @brief A stream which discards everything written to it
+     */
+    class NullStream: public std::ostream {
+        public:
+            NullStream(): std::ostream(&m_sb) { }
+        private:
+            NullBuffer m_sb;
+    } cnul;
+
+    /**
+     * @brief Prints help information to the console.
+     */
+    void printHelp() {
+        std::cout << program_name << " [OPTIONS...]" << std::endl;
+        std::cout << "\t   --width                 The width of the synthetic map (default 1024)." << std::endl;
+        std::cout << "\t   --height                The height of the synthetic map (default 1024)." << std::endl;
+        std::cout << "\t   --provinces             The number of provinces to generate (default 1000)." << std::endl;
+        std::cout << "\t   --land-ratio            The fraction of provinces which are land (default 0.6)." << std::endl;
+        std::cout << "\t   --lake-ratio            The fraction of land provinces which are lakes (default 0.02)." << std::endl;
+        std::cout << "\t   --seed                  The seed for the synthetic map (default 0)." << std::endl;
+        std::cout << "\t   --iterations            The number of timed iterations per benchmark (default 5)." << std::endl;
+        std::cout << "\t   --warmup                The number of untimed iterations per benchmark (default 1)." << std::endl;
+        std::cout << "\t   --filter                Only run benchmarks whose Suite.Name contains this string." << std::endl;
+        std::cout << "\t   --output                Write JSON results to this file instead of stdout." << std::endl;
+        std::cout << "\t   --work-dir              Where temporary files are written to." << std::endl;
+        std::cout << "\t   --write-map             Write the synthetic map and heightmap into the work directory, then exit." << std::endl;
+        std::cout << "\t-v,--verbose               Display log output on stderr." << std::endl;
+        std::cout << "\t-h,--help                  Display this message and exit." << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    program_name = argv[0];
+    program_name = program_name.substr(program_name.find_last_of('/') + 1);
+
+    static const char* const short_options = "vh";
+    static option long_options[] = {
+        { "verbose", no_argument, NULL, 'v' },
+        { "help", no_argument, NULL, 'h' },
+        { "width", required_argument, NULL, 1 },
+        { "height", required_argument, NULL, 2 },
+        { "provinces", required_argument, NULL, 3 },
+        { "land-ratio", required_argument, NULL, 4 },
+        { "lake-ratio", required_argument, NULL, 5 },
+        { "seed", required_argument, NULL, 6 },
+        { "iterations", required_argument, NULL, 7 },
+        { "warmup", required_argument, NULL, 8 },
+        { "filter", required_argument, NULL, 9 },
+        { "output", required_argument, NULL, 10 },
+        { "work-dir", required_argument, NULL, 11 },
+        { "write-map", no_argument, NULL, 12 },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    HMDT::Benchmarks::BenchmarkConfig config;
+    config.work_dir = std::filesystem::temp_directory_path() / "hmdt_benchmarks";
+
+    std::filesystem::path output_path;
+    bool verbose = false;
+    bool write_map = false;
+
+    int optindex = 0;
+    int c = 0;
+
+    opterr = 0;
+
+    try {
+        while((c = getopt_long(argc, argv, short_options, long_options, &optindex)) != -1) {
+            switch(c) {
+                case 'v':
+                    verbose = true;
+                    break;
+                case 'h':
+                    printHelp();
+                    return 0;
+                case 1:
+                    config.map_options.width = std::stoul(optarg);
+                    break;
+                case 2:
+                    config.map_options.height = std::stoul(optarg);
+                    break;
+                case 3:
+                    config.map_options.province_count = std::stoul(optarg);
+                    break;
+                case 4:
+                    config.map_options.land_ratio = std::stod(optarg);
+                    break;
+                case 5:
+                    config.map_options.lake_ratio = std::stod(optarg);
+                    break;
+                case 6:
+                    config.map_options.seed = std::stoull(optarg);
+                    break;
+                case 7:
+                    config.iterations = std::stoul(optarg);
+                    break;
+                case 8:
+                    config.warmup = std::stoul(optarg);
+                    break;
+                case 9:
+                    config.filter = optarg;
+                    break;
+                case 10:
+                    output_path = optarg;
+                    break;
+                case 11:
+                    config.work_dir = optarg;
+                    break;
+                case 12:
+                    write_map = true;
+                    break;
+                case '?':
+                default:
+                    std::cerr << "Unrecognized option '" << argv[optind - 1]
+                              << "'." << std::endl;
+                    printHelp();
+                    return 1;
+            }
+        }
+    } catch(const std::exception& e) {
+        std::cerr << "Invalid value for '" << argv[optind - 1] << "': "
+                  << e.what() << std::endl;
+        return 1;
+    }
+
+    // Logs go to stderr so they never get mixed in with the JSON output
+    Log::Logger::registerOutputFunction([verbose](const Log::Message& m) {
+        return Log::outputToStream(m, false, true,
+            [verbose](uint8_t) -> std::ostream& {
+                return verbose ? std::cerr : cnul;
+            }, false, false);
+    });
+
+    std::filesystem::create_directories(config.work_dir);
+
+    if(write_map) {
+        auto map = HMDT::Benchmarks::generateSyntheticMap(config.map_options);
+
+        auto res = HMDT::Benchmarks::writeSyntheticMap(map,
+                config.work_dir / "provinces.bmp",
+                config.work_dir / "heightmap.bmp");
+        if(IS_FAILURE(res)) {
+            std::cerr << "Failed to write synthetic map: "
+                      << res.error().message() << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    auto results = HMDT::Benchmarks::runBenchmarks(config);
+
+    if(output_path.empty()) {
+        HMDT::Benchmarks::writeResultsAsJSON(std::cout, config, results);
+    } else {
+        std::ofstream out(output_path);
+        if(!out) {
+            std::cerr << "Failed to open " << output_path << std::endl;
+            return 1;
+        }
+
+        HMDT::Benchmarks::writeResultsAsJSON(out, config, results);
+    }
+
+    // Return non-zero if anything failed, so that CI notices
+    for(auto&& result : results) {
+        if(result.status) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
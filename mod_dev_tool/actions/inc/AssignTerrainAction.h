@@ -0,0 +1,38 @@
+#ifndef ASSIGNTERRAINACTION_H
+# define ASSIGNTERRAINACTION_H
+
+# include <vector>
+
+# include "IProject.h"
+
+# include "IAction.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief Sets the terrain of many provinces at once.
+     */
+    class AssignTerrainAction: public Action::IAction {
+        public:
+            AssignTerrainAction(Project::IRootMapProject&,
+                                const std::vector<Project::ITerrainProject::TerrainChange>&);
+
+            virtual bool doAction(const Callback& = _) override;
+            virtual bool undoAction(const Callback& = _) override;
+
+            const std::vector<Project::ITerrainProject::TerrainChange>& getChanges() const;
+
+        private:
+            // Only valid while the project is loaded, the Driver clears the
+            //   action history before the project is replaced or unloaded
+            Project::IRootMapProject& m_map_project;
+
+            //! Every province whose terrain is changed
+            std::vector<Project::ITerrainProject::TerrainChange> m_changes;
+
+            //! Whether the action has been done
+            bool m_done;
+    };
+}
+
+#endif
+
@@ -0,0 +1,44 @@
+#ifndef PAINTPROVINCEACTION_H
+# define PAINTPROVINCEACTION_H
+
+# include <vector>
+# include <optional>
+
+# include "IProject.h"
+
+# include "IAction.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief Paints a set of pixels (from a brush stroke, fill, or lasso) into
+     *        a single province, re-labelling every province that was touched.
+     */
+    class PaintProvinceAction: public Action::IAction {
+        public:
+            PaintProvinceAction(Project::IRootMapProject&,
+                                const ProvinceID&,
+                                const std::vector<Point2D>&);
+
+            virtual bool doAction(const Callback& = _) override;
+            virtual bool undoAction(const Callback& = _) override;
+
+            const std::optional<Project::IProvinceProject::ProvinceEdit>& getEdit() const;
+
+        private:
+            // Only valid while the project is loaded, the Driver clears the
+            //   action history before the project is replaced or unloaded
+            Project::IRootMapProject& m_map_project;
+
+            //! The province to paint into
+            ProvinceID m_province_id;
+
+            //! Every pixel to paint
+            std::vector<Point2D> m_pixels;
+
+            //! The last edit that was made, if the action has been done
+            std::optional<Project::IProvinceProject::ProvinceEdit> m_edit;
+    };
+}
+
+#endif
+
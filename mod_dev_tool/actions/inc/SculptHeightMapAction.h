@@ -0,0 +1,47 @@
+#ifndef SCULPTHEIGHTMAPACTION_H
+# define SCULPTHEIGHTMAPACTION_H
+
+# include <vector>
+# include <optional>
+
+# include "IProject.h"
+
+# include "IAction.h"
+
+namespace HMDT::Action {
+    /**
+     * @brief Sculpts a set of pixels (from a brush stroke) of the heightmap.
+     */
+    class SculptHeightMapAction: public Action::IAction {
+        public:
+            SculptHeightMapAction(Project::IRootMapProject&,
+                                  Project::IHeightMapProject::SculptMode,
+                                  const std::vector<Point2D>&,
+                                  uint8_t);
+
+            virtual bool doAction(const Callback& = _) override;
+            virtual bool undoAction(const Callback& = _) override;
+
+            const std::optional<Project::IHeightMapProject::HeightMapEdit>& getEdit() const;
+
+        private:
+            // Only valid while the project is loaded, the Driver clears the
+            //   action history before the project is replaced or unloaded
+            Project::IRootMapProject& m_map_project;
+
+            //! How the brush modifies the heightmap
+            Project::IHeightMapProject::SculptMode m_mode;
+
+            //! Every pixel under the brush
+            std::vector<Point2D> m_pixels;
+
+            //! How strong the brush is
+            uint8_t m_strength;
+
+            //! The last edit that was made, if the action has been done
+            std::optional<Project::IHeightMapProject::HeightMapEdit> m_edit;
+    };
+}
+
+#endif
+
@@ -0,0 +1,63 @@
+
+#include "AssignTerrainAction.h"
+
+#include "Logger.h"
+
+HMDT::Action::AssignTerrainAction::AssignTerrainAction(
+        Project::IRootMapProject& map_project,
+        const std::vector<Project::ITerrainProject::TerrainChange>& changes):
+    m_map_project(map_project),
+    m_changes(changes),
+    m_done(false)
+{ }
+
+bool HMDT::Action::AssignTerrainAction::doAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(m_done) {
+        WRITE_ERROR("Cannot assign terrain, action has already been done.");
+        return false;
+    }
+
+    if(auto result = m_map_project.getTerrainProject().applyTerrainChanges(m_changes);
+            IS_FAILURE(result))
+    {
+        WRITE_ERROR("Failed to assign the terrain of ", m_changes.size(), " provinces.");
+        return false;
+    }
+
+    m_done = true;
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+bool HMDT::Action::AssignTerrainAction::undoAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(!m_done) {
+        WRITE_ERROR("Cannot undo assigning terrain, action has not been done.");
+        return false;
+    }
+
+    if(auto result = m_map_project.getTerrainProject().applyTerrainChanges(m_changes, true /* undo */);
+            IS_FAILURE(result))
+    {
+        WRITE_ERROR("Failed to revert assigning the terrain of ", m_changes.size(), " provinces.");
+        return false;
+    }
+
+    m_done = false;
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+auto HMDT::Action::AssignTerrainAction::getChanges() const
+    -> const std::vector<Project::ITerrainProject::TerrainChange>&
+{
+    return m_changes;
+}
+
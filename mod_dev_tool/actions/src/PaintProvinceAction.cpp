@@ -0,0 +1,64 @@
+
+#include "PaintProvinceAction.h"
+
+#include "Logger.h"
+
+HMDT::Action::PaintProvinceAction::PaintProvinceAction(
+        Project::IRootMapProject& map_project,
+        const ProvinceID& province_id,
+        const std::vector<Point2D>& pixels):
+    m_map_project(map_project),
+    m_province_id(province_id),
+    m_pixels(pixels),
+    m_edit(std::nullopt)
+{ }
+
+bool HMDT::Action::PaintProvinceAction::doAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(m_edit) {
+        WRITE_ERROR("Cannot paint province ", m_province_id, ", action has already been done.");
+        return false;
+    }
+
+    auto maybe_edit = m_map_project.getProvinceProject().paintProvince(m_province_id, m_pixels);
+    if(IS_FAILURE(maybe_edit)) {
+        WRITE_ERROR("Failed to paint ", m_pixels.size(), " pixels into province ", m_province_id);
+        return false;
+    }
+
+    m_edit = std::move(*maybe_edit);
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+bool HMDT::Action::PaintProvinceAction::undoAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(!m_edit) {
+        WRITE_ERROR("Cannot undo painting province ", m_province_id, ", action has not been done.");
+        return false;
+    }
+
+    if(auto result = m_map_project.getProvinceProject().revertProvinceEdit(*m_edit);
+            IS_FAILURE(result))
+    {
+        WRITE_ERROR("Failed to revert painting province ", m_province_id);
+        return false;
+    }
+
+    m_edit = std::nullopt;
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+auto HMDT::Action::PaintProvinceAction::getEdit() const
+    -> const std::optional<Project::IProvinceProject::ProvinceEdit>&
+{
+    return m_edit;
+}
+
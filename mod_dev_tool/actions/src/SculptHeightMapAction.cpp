@@ -0,0 +1,66 @@
+
+#include "SculptHeightMapAction.h"
+
+#include "Logger.h"
+
+HMDT::Action::SculptHeightMapAction::SculptHeightMapAction(
+        Project::IRootMapProject& map_project,
+        Project::IHeightMapProject::SculptMode mode,
+        const std::vector<Point2D>& pixels,
+        uint8_t strength):
+    m_map_project(map_project),
+    m_mode(mode),
+    m_pixels(pixels),
+    m_strength(strength),
+    m_edit(std::nullopt)
+{ }
+
+bool HMDT::Action::SculptHeightMapAction::doAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(m_edit) {
+        WRITE_ERROR("Cannot sculpt heightmap, action has already been done.");
+        return false;
+    }
+
+    auto maybe_edit = m_map_project.getHeightMapProject().sculpt(m_mode, m_pixels, m_strength);
+    if(IS_FAILURE(maybe_edit)) {
+        WRITE_ERROR("Failed to sculpt ", m_pixels.size(), " pixels of the heightmap.");
+        return false;
+    }
+
+    m_edit = std::move(*maybe_edit);
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+bool HMDT::Action::SculptHeightMapAction::undoAction(const Callback& callback) {
+    if(!callback(0)) return false;
+
+    if(!m_edit) {
+        WRITE_ERROR("Cannot undo sculpting heightmap, action has not been done.");
+        return false;
+    }
+
+    if(auto result = m_map_project.getHeightMapProject().revertHeightMapEdit(*m_edit);
+            IS_FAILURE(result))
+    {
+        WRITE_ERROR("Failed to revert sculpting heightmap.");
+        return false;
+    }
+
+    m_edit = std::nullopt;
+
+    if(!callback(1)) return false;
+
+    return true;
+}
+
+auto HMDT::Action::SculptHeightMapAction::getEdit() const
+    -> const std::optional<Project::IHeightMapProject::HeightMapEdit>&
+{
+    return m_edit;
+}
+
@@ -182,9 +182,17 @@ namespace HMDT {
     MaybeRef<BitMap2> readBMP(std::istream&, BitMap2&) noexcept;
     Maybe<BitMap2> readBMP2(std::filesystem::path&) noexcept;
 
+    MaybeRef<BitMap2> readBMPHeader(const std::filesystem::path&, BitMap2&) noexcept;
+    MaybeRef<BitMap2> readBMPHeader(std::istream&, BitMap2&) noexcept;
+    MaybeVoid readBMPRows(std::istream&, const BitMap2&, uint32_t, uint32_t,
+                          unsigned char*) noexcept;
+
     MaybeVoid writeBMP(const std::filesystem::path&,
                        std::shared_ptr<const BitMap2>) noexcept;
     MaybeVoid writeBMP(const std::filesystem::path&, const BitMap2&) noexcept;
+    MaybeVoid createBMP2(BitMap2&, uint32_t, uint32_t, uint16_t = 3,
+                         bool = false, BMPHeaderToUse = BMPHeaderToUse::V4,
+                         MonadOptional<ColorTable> = std::nullopt) noexcept;
     MaybeVoid writeBMP2(const std::filesystem::path&, unsigned char*,
                         uint32_t, uint32_t, uint16_t = 3, bool = false,
                         BMPHeaderToUse = BMPHeaderToUse::V4,
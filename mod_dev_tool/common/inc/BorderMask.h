@@ -0,0 +1,32 @@
+/**
+ * @file BorderMask.h
+ *
+ * @brief Declares functions for building the per-pixel province and state
+ *        border flags which the renderers draw borders from.
+ */
+
+#ifndef BORDER_MASK_H
+# define BORDER_MASK_H
+
+# include <cstdint>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    Rectangle growBorderArea(const Dimensions&, const Rectangle&) noexcept;
+
+    MaybeVoid buildBorderMask(const Dimensions&, const ProvinceID*,
+                              const uint32_t*, uint8_t*,
+                              const Rectangle&) noexcept;
+    MaybeVoid buildBorderMask(const Dimensions&, const ProvinceID*,
+                              const uint32_t*, uint8_t*) noexcept;
+
+    MaybeVoid updateStateBorderMask(const Dimensions&, const uint32_t*,
+                                    uint8_t*, const Rectangle&) noexcept;
+    MaybeVoid updateStateBorderMask(const Dimensions&, const uint32_t*,
+                                    uint8_t*) noexcept;
+}
+
+#endif
+
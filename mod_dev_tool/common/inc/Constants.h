@@ -87,6 +87,9 @@ namespace HMDT {
     //! The filename for storing the rivers
     const std::string RIVERS_FILENAME = "rivers.bmp";
 
+    //! The filename for storing the terrain map
+    const std::string TERRAIN_FILENAME = "terrain.bmp";
+
     //! The filename for storing the normalmap
     const std::string NORMALMAP_FILENAME = "world_normal.bmp";
 
@@ -96,6 +99,12 @@ namespace HMDT {
     //! The filename for storing data about states
     const std::string STATEDATA_FILENAME = "states.csv";
 
+    //! The filename for storing data about strategic regions
+    const std::string STRATEGICREGIONDATA_FILENAME = "strategicregions.csv";
+
+    //! The folder name for storing the exported strategic regions
+    const std::string STRATEGICREGIONS_FOLDER = "strategicregions";
+
     //! The filename for the imported province maps
     const std::string INPUT_PROVINCEMAP_FILENAME = "import_provincemap.bmp";
 
@@ -117,6 +126,12 @@ namespace HMDT {
     //! The default zoom level
     const double DEFAULT_ZOOM = 1.0;
 
+    //! The default radius of the map brush, in pixels
+    const uint32_t DEFAULT_BRUSH_RADIUS = 4;
+
+    //! How strongly each stroke of the map brush sculpts the heightmap
+    const uint8_t DEFAULT_SCULPT_STRENGTH = 32;
+
     const uint32_t PROVINCE_HIGHLIGHT_COLOR = 0xFFFFFFFF;
 
     const std::string SOURCE_LOCATION = "https://github.com/AFlyingCar/HoI4-Mod-Development-Tool";
@@ -135,6 +150,147 @@ namespace HMDT {
 
     //! A completely impossible province ID that we will never support
     const ProvinceID INVALID_PROVINCE = EMPTY_UUID;
+
+    //! Outline flag for a pixel whose northern neighbor is in another region
+    const std::uint8_t OUTLINE_NORTH = 0x1;
+
+    //! Outline flag for a pixel whose eastern neighbor is in another region
+    const std::uint8_t OUTLINE_EAST = 0x2;
+
+    //! Outline flag for a pixel whose southern neighbor is in another region
+    const std::uint8_t OUTLINE_SOUTH = 0x4;
+
+    //! Outline flag for a pixel whose western neighbor is in another region
+    const std::uint8_t OUTLINE_WEST = 0x8;
+
+    //! How far the edge flags get shifted to mark state borders instead
+    const std::uint8_t OUTLINE_STATE_SHIFT = 4;
+
+    //! Mask for the province border bits of an outline pixel
+    const std::uint8_t OUTLINE_PROVINCE_MASK = 0x0F;
+
+    //! Mask for the state border bits of an outline pixel
+    const std::uint8_t OUTLINE_STATE_MASK = OUTLINE_PROVINCE_MASK << OUTLINE_STATE_SHIFT;
+
+    //! The default color province outlines are rendered with
+    const Color PROVINCE_OUTLINE_COLOR = Color{ 0, 0, 0 };
+
+    //! The default color selected provinces are tinted with
+    const Color SELECTION_COLOR = Color{ 255, 0, 0 };
+
+    //! The color sea and lake provinces are rendered with in map modes which
+    //!   only color land
+    const Color RENDER_WATER_COLOR = Color{ 0x3C, 0x5A, 0x8C };
+
+    //! The color coastal land provinces are rendered with
+    const Color RENDER_COASTAL_COLOR = Color{ 0xE6, 0xB4, 0x50 };
+
+    //! The color inland provinces are rendered with
+    const Color RENDER_INLAND_COLOR = Color{ 0x5A, 0x96, 0x50 };
+
+    //! The width and height of each tile the normal map is regenerated in
+    const std::uint32_t HEIGHTMAP_TILE_SIZE = 64;
+
+    //! The width and height of each tile compared when reloading a map layer.
+    //!   Matches HEIGHTMAP_TILE_SIZE so that changed heightmap tiles are also
+    //!   exactly the normal map tiles which need regenerating
+    const std::uint32_t LAYER_RELOAD_TILE_SIZE = HEIGHTMAP_TILE_SIZE;
+
+    //! The width and height of each tile compared when diffing two projects
+    const std::uint32_t PROJECT_DIFF_TILE_SIZE = 256;
+
+    //! The color pixels belonging to a different province are drawn with in
+    //!   a rendered project diff
+    const Color DIFF_PROVINCE_COLOR = Color{ 0xFF, 0, 0 };
+
+    //! The color pixels with a different height are drawn with in a rendered
+    //!   project diff
+    const Color DIFF_HEIGHTMAP_COLOR = Color{ 0, 0xFF, 0 };
+
+    //! The color pixels with a different river are drawn with in a rendered
+    //!   project diff
+    const Color DIFF_RIVERS_COLOR = Color{ 0, 0, 0xFF };
+
+    //! Zonal statistics computed from the provinces layer: pixel counts,
+    //!   perimeters and border lengths
+    const std::uint8_t ZONAL_LAYER_PROVINCES = 0x1;
+
+    //! Zonal statistics computed from the heightmap: heights and slopes
+    const std::uint8_t ZONAL_LAYER_HEIGHTMAP = 0x2;
+
+    //! Zonal statistics computed from the rivers layer: river pixel counts
+    const std::uint8_t ZONAL_LAYER_RIVERS = 0x4;
+
+    //! Every layer zonal statistics are computed from
+    const std::uint8_t ZONAL_LAYER_ALL = ZONAL_LAYER_PROVINCES |
+                                         ZONAL_LAYER_HEIGHTMAP |
+                                         ZONAL_LAYER_RIVERS;
+
+    //! The default widest sea crossing (in pixels) that counts as a strait
+    const std::uint32_t DEFAULT_MAX_STRAIT_WIDTH = 16;
+
+    //! The filename for storing the exported adjacencies
+    const std::string ADJACENCIES_FILENAME = "adjacencies.csv";
+
+    //! The filename for storing the exported supply hubs
+    const std::string SUPPLY_NODES_FILENAME = "supply_nodes.txt";
+
+    //! The filename for storing the exported railways
+    const std::string RAILWAYS_FILENAME = "railways.txt";
+
+    //! Rivers color index marking the source of a river
+    const std::uint8_t RIVER_SOURCE_INDEX = 0;
+
+    //! Rivers color index marking where a tributary flows into a river
+    const std::uint8_t RIVER_FLOW_IN_INDEX = 1;
+
+    //! Rivers color index marking where a river branches out
+    const std::uint8_t RIVER_FLOW_OUT_INDEX = 2;
+
+    //! Rivers color index of the narrowest river
+    const std::uint8_t RIVER_NARROWEST_INDEX = 3;
+
+    //! Rivers color index of the widest river. Anything above this is not river
+    const std::uint8_t RIVER_WIDEST_INDEX = 11;
+
+    //! Rivers color index used to mark land which has no river on it
+    const std::uint8_t RIVER_LAND_INDEX = 12;
+
+    //! Rivers color index used to mark seas and lakes
+    const std::uint8_t RIVER_WATER_INDEX = 13;
+
+    //! Rivers color index used to mark pixels of an unknown province type
+    const std::uint8_t RIVER_UNKNOWN_INDEX = 14;
+
+    //! The default number of pixels which must drain through a pixel for a
+    //!   river to be generated there
+    const std::uint32_t DEFAULT_RIVER_MIN_CATCHMENT = 2000;
+
+    //! The most river issues which will be listed at once in the GUI
+    const std::uint32_t MAX_DISPLAYED_RIVER_ISSUES = 1000;
+
+    //! The filename for storing the exported unit positions
+    const std::string UNITSTACKS_FILENAME = "unitstacks.txt";
+
+    //! How high in the world each step of the heightmap is
+    const double HEIGHTMAP_WORLD_SCALE = 0.1;
+
+    //! How many strategic regions to aim for when generating them
+    const std::uint32_t DEFAULT_STRATEGIC_REGION_COUNT = 150;
+
+    //! How many land provinces to aim for in each state when generating them
+    const std::uint32_t DEFAULT_PROVINCES_PER_STATE = 8;
+
+    //! How many pixels each generated province covers on average when no
+    //!   province count is given, which is about the same as the base game
+    const std::uint32_t DEFAULT_PIXELS_PER_GENERATED_PROVINCE = 900;
+
+    //! How many times generated provinces are relaxed towards the middle of
+    //!   their cells
+    const std::uint32_t DEFAULT_PROVINCE_RELAXATION_ITERATIONS = 4;
+
+    //! How many times more area a generated sea province covers than a land one
+    const double DEFAULT_SEA_PROVINCE_SCALE = 4.0;
 }
 
 #endif
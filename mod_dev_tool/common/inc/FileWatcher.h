@@ -0,0 +1,92 @@
+/**
+ * @file FileWatcher.h
+ *
+ * @brief Defines a class which watches files on disk for changes.
+ */
+
+#ifndef FILE_WATCHER_H
+# define FILE_WATCHER_H
+
+# include <atomic>
+# include <chrono>
+# include <filesystem>
+# include <functional>
+# include <map>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+# include "Maybe.h"
+
+namespace HMDT {
+    /**
+     * @brief Watches files for changes, and reports each change only once the
+     *        file has stopped changing for a while.
+     * @details Changes can either be polled for directly, or reported to a
+     *          callback from a background thread with start(). Neither needs a
+     *          GUI, so this works headless too.
+     *
+     *          On Linux this uses inotify on the directory of every watched
+     *          file, so that editors which save by replacing the file are
+     *          still noticed. Everywhere else the last write time of every
+     *          watched file is checked instead.
+     */
+    class FileWatcher {
+        public:
+            //! Called with every file which changed
+            using Callback = std::function<void(const std::filesystem::path&)>;
+
+            FileWatcher(std::chrono::milliseconds = std::chrono::milliseconds(500));
+            ~FileWatcher();
+
+            FileWatcher(const FileWatcher&) = delete;
+            FileWatcher& operator=(const FileWatcher&) = delete;
+
+            MaybeVoid watch(const std::filesystem::path&) noexcept;
+            MaybeVoid unwatch(const std::filesystem::path&) noexcept;
+            bool isWatching(const std::filesystem::path&) const noexcept;
+
+            std::vector<std::filesystem::path> poll(std::chrono::milliseconds) noexcept;
+
+            MaybeVoid start(const Callback&) noexcept;
+            void stop() noexcept;
+            bool isRunning() const noexcept;
+
+        private:
+            static std::filesystem::path normalize(const std::filesystem::path&);
+
+            void waitForEvents(std::chrono::milliseconds) noexcept;
+
+            //! How long a file must stay unchanged before it gets reported
+            std::chrono::milliseconds m_debounce;
+
+            //! Guards everything below
+            mutable std::mutex m_mutex;
+
+            //! Every file being watched, mapped to the watch on its directory
+            std::map<std::filesystem::path, int> m_watched;
+
+            //! The last time each changed file was seen changing
+            std::map<std::filesystem::path, std::chrono::steady_clock::time_point> m_pending;
+
+#ifdef _WIN32
+            //! The last write time of every watched file
+            std::map<std::filesystem::path, std::filesystem::file_time_type> m_write_times;
+#else
+            //! The inotify instance
+            int m_fd;
+
+            //! Every watched directory, keyed by its watch descriptor
+            std::map<int, std::filesystem::path> m_directories;
+#endif
+
+            //! Whether the background thread should keep running
+            std::atomic<bool> m_running;
+
+            //! The background thread started by start()
+            std::thread m_thread;
+    };
+}
+
+#endif
+
@@ -0,0 +1,41 @@
+/**
+ * @file LabelPointFinder.h
+ *
+ * @brief Declares functions for finding a good point inside of every province
+ *        to place labels, buildings and units at.
+ */
+
+#ifndef LABEL_POINT_FINDER_H
+# define LABEL_POINT_FINDER_H
+
+# include <cstdint>
+# include <unordered_map>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief The point inside of a province which is furthest from its edges
+     */
+    struct LabelPoint {
+        Point2D position; //!< The pixel furthest from the edges of the province
+
+        //! The distance in pixels from position to the closest pixel which is
+        //!   not a part of the province
+        double radius;
+
+        uint8_t height; //!< The value of the heightmap at position
+    };
+
+    //! The label point of every province
+    using LabelPointMap = std::unordered_map<ProvinceID, LabelPoint>;
+
+    Maybe<LabelPointMap> findLabelPoints(const Dimensions&,
+                                         const ProvinceID*,
+                                         const uint8_t*,
+                                         const ProvinceList&);
+}
+
+#endif
+
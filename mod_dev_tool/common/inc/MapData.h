@@ -44,7 +44,9 @@ namespace HMDT {
             uint32_t getCitiesSize() const;
             uint32_t getMatrixSize() const;
             uint32_t getHeightMapSize() const;
+            uint32_t getNormalMapSize() const;
             uint32_t getRiversSize() const;
+            uint32_t getTerrainSize() const;
 
             bool isClosed() const;
 
@@ -75,13 +77,20 @@ namespace HMDT {
             ConstMapType32 getStateIDMatrix() const;
 
             uint32_t getStateIDMatrixUpdatedTag() const;
+            void markStateIDMatrixUpdated();
 
             MapType getHeightMap();
             ConstMapType getHeightMap() const;
 
+            MapType getNormalMap();
+            ConstMapType getNormalMap() const;
+
             MapType getRivers();
             ConstMapType getRivers() const;
 
+            MapType getTerrain();
+            ConstMapType getTerrain() const;
+
         private:
             using InternalMapType = std::shared_ptr<uint8_t[]>;
             using InternalMapType32 = std::shared_ptr<uint32_t[]>;
@@ -98,7 +107,9 @@ namespace HMDT {
             InternalMapType32 m_label_matrix;
             InternalMapType32 m_state_id_matrix;
             InternalMapType m_heightmap;
+            InternalMapType m_normal_map;
             InternalMapType m_rivers;
+            InternalMapType m_terrain;
             // More map representations as necessary
 
             bool m_closed;
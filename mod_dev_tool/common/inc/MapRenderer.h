@@ -0,0 +1,100 @@
+/**
+ * @file MapRenderer.h
+ *
+ * @brief Declares functions for rendering the map into an image without a GUI.
+ */
+
+#ifndef MAP_RENDERER_H
+# define MAP_RENDERER_H
+
+# include <cstdint>
+# include <optional>
+# include <ostream>
+# include <set>
+# include <string>
+# include <unordered_map>
+# include <vector>
+
+# include "Constants.h"
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief Every way the map can be rendered
+     */
+    enum class MapMode {
+        PROVINCES, //!< Every province in its unique color
+        STATES, //!< Every state in its color
+        CONTINENTS, //!< Every land province in the color of its continent
+        TERRAIN, //!< Every province in the color of its terrain
+        COASTAL, //!< Whether every land province is coastal
+        HEIGHTMAP //!< The heightmap in greyscale
+    };
+
+    /**
+     * @brief All parameters used to render the map
+     */
+    struct MapRenderOptions {
+        //! How many pixels of the image every pixel of the map becomes
+        double scale = 1.0;
+
+        //! Whether to draw province borders, or std::nullopt to do whatever the
+        //!   map mode's view in the GUI does
+        std::optional<bool> draw_province_borders;
+
+        //! Whether to draw state borders, or std::nullopt to do whatever the
+        //!   map mode's view in the GUI does
+        std::optional<bool> draw_state_borders;
+
+        //! The color borders are drawn in
+        Color border_color = PROVINCE_OUTLINE_COLOR;
+
+        //! Every province to draw as selected
+        std::set<ProvinceID> selection;
+
+        //! The color selected provinces are tinted with
+        Color selection_color = SELECTION_COLOR;
+    };
+
+    /**
+     * @brief Every per-pixel layer of the map which can be rendered
+     */
+    struct MapRenderLayers {
+        //! The dimensions of every layer
+        Dimensions dimensions;
+
+        //! The province of every pixel. Required.
+        const ProvinceID* provinces = nullptr;
+
+        //! The state of every pixel. Required to draw state borders.
+        const uint32_t* state_ids = nullptr;
+
+        //! The height of every pixel. If set, this is drawn instead of the
+        //!   color of every province.
+        const uint8_t* heightmap = nullptr;
+    };
+
+    /**
+     * @brief A rendered image of the map
+     */
+    struct RenderedMap {
+        uint32_t width; //!< The width of the image
+        uint32_t height; //!< The height of the image
+
+        //! 3 bytes (RGB) per pixel, laid out the same way as a loaded
+        //!   provinces.bmp
+        std::vector<uint8_t> pixels;
+    };
+
+    Maybe<RenderedMap> renderMap(const MapRenderLayers&,
+                                 const std::unordered_map<ProvinceID, Color>&,
+                                 const MapRenderOptions&) noexcept;
+
+    std::optional<MapMode> mapModeFromString(const std::string&) noexcept;
+
+    std::ostream& operator<<(std::ostream&, const MapMode&);
+}
+
+#endif
+
@@ -0,0 +1,94 @@
+/**
+ * @file ModReader.h
+ *
+ * @brief Declares readers for the map and state files of an existing mod (or
+ *        of the base game), so that they can be imported into a project.
+ */
+
+#ifndef MOD_READER_H
+# define MOD_READER_H
+
+# include <cstdint>
+# include <filesystem>
+# include <string>
+# include <string_view>
+# include <utility>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief A single province, as it is defined in a definition.csv file
+     */
+    struct ProvinceDefinition {
+        //! The numeric ID of the province
+        uint32_t id;
+
+        //! The color of the province in provinces.bmp
+        Color color;
+
+        ProvinceType type;
+        bool coastal;
+        TerrainID terrain;
+
+        //! The 1-based index of the province's continent in continent.txt, or
+        //!   0 if it is not on a continent
+        uint32_t continent;
+    };
+
+    /**
+     * @brief A single state, as it is defined in a history/states file
+     */
+    struct StateDefinition {
+        StateID id;
+        std::string name;
+        std::size_t manpower;
+        std::string category;
+        float buildings_max_level_factor;
+        bool impassable;
+
+        //! The numeric ID of every province in this state
+        std::vector<uint32_t> provinces;
+    };
+
+    /**
+     * @brief Which province every pixel of a province map belongs to, along
+     *        with the data which can only be found by looking at every pixel.
+     * @details Provinces are referred to by index. Indices below the number of
+     *          known colors refer to those colors, in the order they were
+     *          given. Every index after that refers to a color which was in the
+     *          map but not in the known colors, in unknown_colors order.
+     */
+    struct ProvinceMapIndex {
+        //! The province index of every pixel
+        std::vector<uint32_t> pixel_provinces;
+
+        //! Every color found in the map which was not known, sorted
+        std::vector<Color> unknown_colors;
+
+        //! The bounding box of every province
+        std::vector<BoundingBox> bounding_boxes;
+
+        //! How many pixels every province has
+        std::vector<uint64_t> pixel_counts;
+
+        //! Every pair of adjacent provinces, with the lower index first. Sorted,
+        //!   and without duplicates.
+        std::vector<std::pair<uint32_t, uint32_t>> adjacencies;
+    };
+
+    Maybe<std::vector<ProvinceDefinition>> parseProvinceDefinitions(std::string_view) noexcept;
+    Maybe<std::vector<std::string>> parseContinents(std::string_view) noexcept;
+    Maybe<StateDefinition> parseStateDefinition(std::string_view) noexcept;
+
+    Maybe<std::vector<StateDefinition>> readStateDefinitions(const std::filesystem::path&) noexcept;
+
+    Maybe<ProvinceMapIndex> indexProvinceMap(const unsigned char*,
+                                             const Dimensions&,
+                                             const std::vector<Color>&) noexcept;
+}
+
+#endif
+
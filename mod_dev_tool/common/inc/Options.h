@@ -55,6 +55,39 @@ namespace HMDT {
 
         //! --fix-warnings-on-load
         bool fix_warnings_on_load;
+
+        //! --split-oversized-provinces
+        bool split_oversized_provinces;
+
+        //! --absorb-tiny-provinces
+        bool absorb_tiny_provinces;
+
+        //! --render-map=
+        std::string render_map_mode;
+
+        //! --render-scale=
+        double render_scale;
+
+        //! --render-selection=
+        std::string render_selection;
+
+        //! --diff=
+        std::string diff_against;
+
+        //! --diff-format=
+        std::string diff_format;
+
+        //! --diff-image=
+        std::string diff_image;
+
+        //! --province-stats=
+        std::string province_stats_format;
+
+        //! --export-borders=
+        std::string export_borders_format;
+
+        //! --borders-simplify=
+        double borders_simplify;
     };
 
     //! Global variable for storing program options.
@@ -0,0 +1,207 @@
+/**
+ * @file ProjectDiff.h
+ *
+ * @brief Declares functions for finding what changed between two versions of
+ *        a project.
+ */
+
+#ifndef PROJECT_DIFF_H
+# define PROJECT_DIFF_H
+
+# include <cstdint>
+# include <filesystem>
+# include <functional>
+# include <ostream>
+# include <string>
+# include <vector>
+
+# include "Constants.h"
+# include "Maybe.h"
+# include "MapRenderer.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief How something changed between two versions of a project
+     */
+    enum class ChangeType {
+        ADDED, //!< Only exists in the new version
+        REMOVED, //!< Only exists in the old version
+        MODIFIED //!< Exists in both versions, but is different
+    };
+
+    /**
+     * @brief A single property which has a different value in each version
+     */
+    struct PropertyChange {
+        std::string name; //!< The name of the property
+        std::string old_value; //!< The value in the old version
+        std::string new_value; //!< The value in the new version
+    };
+
+    /**
+     * @brief Everything that changed about a single province
+     */
+    struct ProvinceChange {
+        ProvinceID id;
+        ChangeType type;
+
+        //! How many pixels the province has in the old version
+        uint64_t old_pixel_count = 0;
+
+        //! How many pixels the province has in the new version
+        uint64_t new_pixel_count = 0;
+
+        //! How many pixels the province gained or lost
+        uint64_t changed_pixel_count = 0;
+
+        //! Every property of the province which changed
+        std::vector<PropertyChange> properties;
+    };
+
+    /**
+     * @brief Everything that changed about a single state
+     */
+    struct StateChange {
+        StateID id;
+        ChangeType type;
+
+        //! Every province which is only in the new version of the state
+        std::vector<ProvinceID> added_provinces;
+
+        //! Every province which is only in the old version of the state
+        std::vector<ProvinceID> removed_provinces;
+
+        //! Every property of the state which changed
+        std::vector<PropertyChange> properties;
+    };
+
+    /**
+     * @brief Everything that changed about a single per-pixel layer
+     */
+    struct LayerDiff {
+        //! Whether the layer changed size, in which case no tiles are compared
+        bool dimensions_changed = false;
+
+        //! Every tile with at least one changed pixel, clamped to the map
+        std::vector<Rectangle> changed_tiles;
+
+        //! How many pixels changed in total
+        uint64_t changed_pixel_count = 0;
+
+        bool empty() const noexcept;
+    };
+
+    /**
+     * @brief Reads a band of whole rows out of a per-pixel layer.
+     * @details Called as read(first_row, row_count, buffer), and returns a
+     *          pointer to the first pixel of the band. Layers which are
+     *          already in memory return a pointer into themselves, while
+     *          layers which are read from a file fill buffer and return its
+     *          data. The pointer is only valid until the next call.
+     */
+    template<typename T>
+    using LayerBandReader = std::function<Maybe<const T*>(uint32_t, uint32_t,
+                                                          std::vector<T>&)>;
+
+    /**
+     * @brief Reads the bands of a layer which is already in memory, without
+     *        copying any of it.
+     *
+     * @param data The layer, or nullptr if it doesn't exist
+     * @param dimensions The dimensions of the layer
+     *
+     * @return The reader, or an empty reader if data is nullptr
+     */
+    template<typename T>
+    LayerBandReader<T> readBandsFromMemory(const T* data,
+                                           const Dimensions& dimensions)
+    {
+        if(data == nullptr) {
+            return nullptr;
+        }
+
+        return [data, width = dimensions.w](uint32_t first_row, uint32_t,
+                                            std::vector<T>&)
+            -> Maybe<const T*>
+        {
+            return data + static_cast<uint64_t>(first_row) * width;
+        };
+    }
+
+    Maybe<LayerBandReader<ProvinceID>> readBandsFromShapeData(const std::filesystem::path&,
+                                                              Dimensions&) noexcept;
+    Maybe<LayerBandReader<uint8_t>> readBandsFromBitMap(const std::filesystem::path&,
+                                                        const Dimensions&) noexcept;
+
+    /**
+     * @brief Every per-pixel layer and list which gets compared for one
+     *        version of a project
+     * @details The per-pixel layers are only ever read one band of rows at a
+     *          time, so they can be streamed from disk instead of having to
+     *          be loaded in full.
+     */
+    struct ProjectDiffLayers {
+        //! The dimensions of every layer
+        Dimensions dimensions;
+
+        //! The province of every pixel. Required.
+        LayerBandReader<ProvinceID> provinces;
+
+        //! The height of every pixel, or empty to not compare heightmaps
+        LayerBandReader<uint8_t> heightmap;
+
+        //! The river palette index of every pixel, or empty to not compare
+        //!   rivers
+        LayerBandReader<uint8_t> rivers;
+
+        //! Every province. Required.
+        const ProvinceList* province_list = nullptr;
+
+        //! Every state. Required.
+        const StateList* state_list = nullptr;
+    };
+
+    /**
+     * @brief Everything that changed between two versions of a project
+     */
+    struct ProjectDiff {
+        //! The dimensions of the old version
+        Dimensions old_dimensions;
+
+        //! The dimensions of the new version
+        Dimensions new_dimensions;
+
+        //! Every changed property of the project itself
+        std::vector<PropertyChange> metadata;
+
+        //! Every province which was added, removed, reshaped or edited
+        std::vector<ProvinceChange> provinces;
+
+        //! Every state which was added, removed or edited
+        std::vector<StateChange> states;
+
+        //! The pixels which belong to a different province
+        LayerDiff province_pixels;
+
+        LayerDiff heightmap;
+        LayerDiff rivers;
+
+        bool empty() const noexcept;
+    };
+
+    Maybe<ProjectDiff> diffProjectLayers(const ProjectDiffLayers&,
+                                         const ProjectDiffLayers&,
+                                         uint32_t = PROJECT_DIFF_TILE_SIZE) noexcept;
+
+    Maybe<RenderedMap> renderProjectDiff(const ProjectDiffLayers&,
+                                         const ProjectDiffLayers&,
+                                         const ProjectDiff&) noexcept;
+
+    void writeProjectDiffText(std::ostream&, const ProjectDiff&);
+    void writeProjectDiffJSON(std::ostream&, const ProjectDiff&);
+
+    std::ostream& operator<<(std::ostream&, const ChangeType&);
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file ProvinceClusterer.h
+ *
+ * @brief Declares functions for grouping provinces into contiguous clusters,
+ *        such as states and strategic regions.
+ */
+
+#ifndef PROVINCE_CLUSTERER_H
+# define PROVINCE_CLUSTERER_H
+
+# include <cstdint>
+# include <functional>
+# include <limits>
+# include <optional>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief All parameters used to cluster provinces together
+     */
+    struct ProvinceClusterOptions {
+        //! Marks a province which should not be put into any cluster
+        static constexpr uint32_t NO_GROUP = std::numeric_limits<uint32_t>::max();
+
+        /**
+         * @brief How the size of a cluster is measured
+         */
+        enum class Measure {
+            AREA, //!< The number of pixels in every province of the cluster
+            PROVINCE_COUNT //!< The number of provinces in the cluster
+        };
+
+        //! How the size of a cluster is measured
+        Measure measure = Measure::AREA;
+
+        //! The size every cluster should aim for
+        uint64_t target_size = 1;
+
+        //! Which group every province is in, or NO_GROUP to leave it out.
+        //!   Provinces of different groups are never clustered together
+        std::function<uint32_t(const Province&)> group_of;
+
+        //! Whether groups which are too small to be a cluster on their own
+        //!   are added to the closest cluster of the same group, rather than
+        //!   being a cluster of their own
+        bool merge_small_components = true;
+
+        //! If set, the first cluster of every connected component starts from
+        //!   whichever province is furthest from a province picked at random
+        //!   with this seed, rather than furthest from its middle
+        std::optional<uint64_t> seed;
+    };
+
+    Maybe<std::vector<std::vector<ProvinceID>>> clusterProvinces(const Dimensions&,
+                                                                 const ProvinceID*,
+                                                                 const ProvinceList&,
+                                                                 const ProvinceClusterOptions&);
+}
+
+#endif
+
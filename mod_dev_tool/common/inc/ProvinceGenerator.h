@@ -0,0 +1,59 @@
+/**
+ * @file ProvinceGenerator.h
+ *
+ * @brief Declares functions for generating a province map from a land, sea and
+ *        lake mask.
+ */
+
+#ifndef PROVINCE_GENERATOR_H
+# define PROVINCE_GENERATOR_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Constants.h"
+# include "Maybe.h"
+# include "ModReader.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief All parameters used to generate a province map
+     */
+    struct ProvinceGeneratorOptions {
+        //! Roughly how many provinces to generate, or 0 to pick a count from
+        //!   the size of the map
+        uint32_t province_count = 0;
+
+        //! How many times every province is moved towards the middle of its
+        //!   cell
+        uint32_t relaxation_iterations = DEFAULT_PROVINCE_RELAXATION_ITERATIONS;
+
+        //! How many times more area a sea province covers than a land one
+        double sea_province_scale = DEFAULT_SEA_PROVINCE_SCALE;
+
+        //! The seed for the generator. The same seed and inputs always produce
+        //!   the same map
+        uint64_t seed = 0;
+    };
+
+    /**
+     * @brief A generated province map
+     */
+    struct GeneratedProvinceMap {
+        //! The province map, 3 bytes (RGB) per pixel, laid out the same way as
+        //!   a loaded provinces.bmp
+        std::vector<uint8_t> image;
+
+        //! Every generated province, numbered from 1
+        std::vector<ProvinceDefinition> definitions;
+    };
+
+    Maybe<GeneratedProvinceMap> generateProvinceMap(const Dimensions&,
+                                                    const uint8_t*,
+                                                    const uint8_t*,
+                                                    const ProvinceGeneratorOptions&) noexcept;
+}
+
+#endif
+
@@ -0,0 +1,25 @@
+/**
+ * @file ProvinceSplitter.h
+ *
+ * @brief Declares functions for splitting a province into several smaller,
+ *        compact pieces.
+ */
+
+#ifndef PROVINCE_SPLITTER_H
+# define PROVINCE_SPLITTER_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Types.h"
+
+namespace HMDT {
+    std::vector<uint32_t> partitionShape(const std::vector<Point2D>&,
+                                         uint32_t) noexcept;
+
+    std::vector<uint32_t> partitionOversizedShape(const std::vector<Point2D>&,
+                                                  const Dimensions&) noexcept;
+}
+
+#endif
+
@@ -0,0 +1,371 @@
+/**
+ * @file RecordParser.h
+ *
+ * @brief Declares a parser for delimited text files, such as the .csv files
+ *        used by both HoI4 and the project files.
+ */
+
+#ifndef RECORD_PARSER_H
+# define RECORD_PARSER_H
+
+# include <charconv>
+# include <cstddef>
+# include <filesystem>
+# include <string>
+# include <string_view>
+# include <type_traits>
+
+# include "Logger.h"
+
+# include "Maybe.h"
+# include "StatusCodes.h"
+# include "Types.h"
+# include "Uuid.h"
+
+namespace HMDT {
+    Maybe<std::string> readFileToString(const std::filesystem::path&) noexcept;
+
+    bool decodeField(std::string_view, std::string&) noexcept;
+    bool decodeField(std::string_view, std::string_view&) noexcept;
+    bool decodeField(std::string_view, bool&) noexcept;
+    bool decodeField(std::string_view, float&) noexcept;
+    bool decodeField(std::string_view, double&) noexcept;
+    bool decodeField(std::string_view, ProvinceType&) noexcept;
+    bool decodeField(std::string_view, UUID&) noexcept;
+
+    std::string_view trimField(std::string_view) noexcept;
+
+    /**
+     * @brief Decodes an integer out of a single field
+     *
+     * @tparam T The type of integer to decode
+     * @param field The field to decode
+     * @param result Where to place the decoded value. Left untouched on failure.
+     *
+     * @return True if the whole field is a valid T, false otherwise
+     */
+    template<typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, bool>
+        decodeField(std::string_view field, T& result) noexcept
+    {
+        field = trimField(field);
+
+        T value;
+        auto [end, ec] = std::from_chars(field.data(),
+                                         field.data() + field.size(),
+                                         value);
+        if(ec != std::errc() || end != field.data() + field.size()) {
+            return false;
+        }
+
+        result = value;
+        return true;
+    }
+
+    /**
+     * @brief Decodes a number from the start of a single field, ignoring
+     *        anything which comes after it
+     *
+     * @tparam T The type of number to decode
+     * @param field The field to decode. Must already be trimmed.
+     * @param result Where to place the decoded value. Left untouched on failure.
+     *
+     * @return How many characters of field were decoded, or 0 if field does not
+     *         start with a valid T
+     */
+    template<typename T>
+    std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, std::size_t>
+        decodeFieldPrefix(std::string_view field, T& result) noexcept
+    {
+        T value;
+        auto [end, ec] = std::from_chars(field.data(),
+                                         field.data() + field.size(),
+                                         value);
+        if(ec != std::errc()) {
+            return 0;
+        }
+
+        result = value;
+        return end - field.data();
+    }
+
+    /**
+     * @brief Creates a value to decode a field into. UUIDs are created empty,
+     *        as generating a new UUID takes longer than parsing one.
+     *
+     * @tparam T The type of the field
+     *
+     * @return An empty T
+     */
+    template<typename T>
+    T makeFieldValue() noexcept {
+        if constexpr(std::is_same_v<T, UUID>) {
+            return UUID(UUID::CreationParams::EMPTY);
+        } else {
+            return T{};
+        }
+    }
+
+    /**
+     * @brief Describes a type of field, for use in error messages
+     *
+     * @tparam T The type of the field
+     *
+     * @return A description of T
+     */
+    template<typename T>
+    constexpr const char* describeFieldType() noexcept {
+        if constexpr(std::is_same_v<T, bool>) {
+            return "a boolean";
+        } else if constexpr(std::is_integral_v<T>) {
+            return "an integer";
+        } else if constexpr(std::is_floating_point_v<T>) {
+            return "a number";
+        } else if constexpr(std::is_same_v<T, ProvinceType>) {
+            return "a province type";
+        } else if constexpr(std::is_same_v<T, UUID>) {
+            return "a UUID";
+        } else {
+            return "text";
+        }
+    }
+
+    /**
+     * @brief Parses records out of delimited text, one record per line.
+     * @details The parser works entirely on views into the given buffer, so
+     *          splitting lines and fields never allocates. Fields are decoded
+     *          straight out of the buffer with std::from_chars, and every error
+     *          is reported with the line and column it was found at.
+     *
+     *          Empty lines are skipped, and a trailing '\r' is removed from
+     *          every line so that files saved on Windows parse the same way.
+     *          Numbers followed by anything else are errors, unless
+     *          setAllowTrailingCharacters is used, in which case the rest of
+     *          the field is ignored with a warning.
+     *          Usage is as follows:
+     * @code{.cpp}
+     * RecordParser parser(buffer, ';');
+     * while(parser.nextRecord()) {
+     *     auto res = parser.parseFields(id, name);
+     *     RETURN_IF_ERROR(res);
+     *
+     *     res = parser.parseOptionalFields(color.r, color.g, color.b);
+     *     RETURN_IF_ERROR(res);
+     * }
+     * @endcode
+     */
+    class RecordParser {
+        public:
+            RecordParser(std::string_view, char) noexcept;
+
+            bool nextRecord() noexcept;
+            bool hasMoreFields() const noexcept;
+
+            std::string_view getRecord() const noexcept;
+            std::size_t getLineNumber() const noexcept;
+            std::size_t getColumnNumber() const noexcept;
+
+            void setAllowTrailingCharacters(bool = true) noexcept;
+
+            /**
+             * @brief Parses the next field of the current record
+             *
+             * @tparam T The type of the field
+             * @param result Where to place the parsed value
+             *
+             * @return STATUS_SUCCESS on success, STATUS_MISSING_FIELD if the
+             *         record has no more fields, or STATUS_INVALID_FIELD if the
+             *         field is not a valid T.
+             */
+            template<typename T>
+            MaybeVoid parseField(T& result) noexcept {
+                auto column = getColumnNumber();
+
+                if(!hasMoreFields()) {
+                    WRITE_ERROR("Line ", m_line_number, ", column ", column,
+                                ": expected ", describeFieldType<T>(),
+                                ", but the record ended.");
+                    RETURN_ERROR(STATUS_MISSING_FIELD);
+                }
+
+                return decodeNextField(nextField(), column, result);
+            }
+
+            /**
+             * @brief Parses the next field of the current record, if there is
+             *        one. A missing or empty field leaves result untouched.
+             *
+             * @tparam T The type of the field
+             * @param result Where to place the parsed value
+             *
+             * @return STATUS_SUCCESS on success, or STATUS_INVALID_FIELD if the
+             *         field is present but is not a valid T.
+             */
+            template<typename T>
+            MaybeVoid parseOptionalField(T& result) noexcept {
+                if(!hasMoreFields()) {
+                    return STATUS_SUCCESS;
+                }
+
+                auto column = getColumnNumber();
+                auto field = nextField();
+                if(trimField(field).empty()) {
+                    return STATUS_SUCCESS;
+                }
+
+                return decodeNextField(field, column, result);
+            }
+
+            /**
+             * @brief Parses every one of the next fields, in order, stopping at
+             *        the first one which fails.
+             *
+             * @param results Where to place each parsed value
+             *
+             * @return STATUS_SUCCESS on success, or the error of the first
+             *         field which failed to parse.
+             */
+            template<typename... Ts>
+            MaybeVoid parseFields(Ts&... results) noexcept {
+                MaybeVoid res = STATUS_SUCCESS;
+                ((res = parseField(results), IS_SUCCESS(res)) && ...);
+                return res;
+            }
+
+            /**
+             * @brief Parses every one of the next fields with
+             *        parseOptionalField, stopping at the first one which fails.
+             *
+             * @param results Where to place each parsed value
+             *
+             * @return STATUS_SUCCESS on success, or the error of the first
+             *         field which failed to parse.
+             */
+            template<typename... Ts>
+            MaybeVoid parseOptionalFields(Ts&... results) noexcept {
+                MaybeVoid res = STATUS_SUCCESS;
+                ((res = parseOptionalField(results), IS_SUCCESS(res)) && ...);
+                return res;
+            }
+
+            /**
+             * @brief Parses the next field as a list of values, split on
+             *        another delimiter. Empty values are skipped, and a missing
+             *        field is treated as an empty list.
+             *
+             * @tparam T The type of each value in the list
+             * @tparam F The type of the callback
+             *
+             * @param delim The delimiter between each value in the list
+             * @param callback Called with every parsed value, in order. Must
+             *                 return a MaybeVoid, and parsing stops at the first
+             *                 failure.
+             *
+             * @return STATUS_SUCCESS on success, STATUS_INVALID_FIELD if any
+             *         value is not a valid T, or the first error returned by
+             *         callback.
+             */
+            template<typename T, typename F>
+            MaybeVoid parseListField(char delim, F&& callback) noexcept {
+                if(!hasMoreFields()) {
+                    return STATUS_SUCCESS;
+                }
+
+                auto column = getColumnNumber();
+                auto field = nextField();
+
+                for(std::size_t offset = 0; offset <= field.size(); ) {
+                    auto end = field.find(delim, offset);
+                    if(end == std::string_view::npos) {
+                        end = field.size();
+                    }
+
+                    auto value_field = field.substr(offset, end - offset);
+                    if(!trimField(value_field).empty()) {
+                        auto value = makeFieldValue<T>();
+                        auto res = decodeNextField(value_field, column + offset,
+                                                   value);
+                        RETURN_IF_ERROR(res);
+
+                        res = callback(value);
+                        RETURN_IF_ERROR(res);
+                    }
+
+                    offset = end + 1;
+                }
+
+                return STATUS_SUCCESS;
+            }
+
+        private:
+            std::string_view nextField() noexcept;
+
+            /**
+             * @brief Decodes a single field which was split off of the current
+             *        record
+             *
+             * @tparam T The type of the field
+             * @param field The field to decode
+             * @param column The 1-based column that field starts at
+             * @param result Where to place the decoded value
+             *
+             * @return STATUS_SUCCESS on success, or STATUS_INVALID_FIELD if the
+             *         field is not a valid T.
+             */
+            template<typename T>
+            MaybeVoid decodeNextField(std::string_view field,
+                                      std::size_t column, T& result) noexcept
+            {
+                if(decodeField(field, result)) {
+                    return STATUS_SUCCESS;
+                }
+
+                if constexpr(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+                {
+                    if(m_allow_trailing_characters) {
+                        auto trimmed = trimField(field);
+                        if(auto length = decodeFieldPrefix(trimmed, result);
+                                length != 0)
+                        {
+                            WRITE_WARN("Line ", m_line_number, ", column ",
+                                       column, ": ignoring '",
+                                       trimmed.substr(length), "' after ",
+                                       describeFieldType<T>(), ".");
+                            return STATUS_SUCCESS;
+                        }
+                    }
+                }
+
+                WRITE_ERROR("Line ", m_line_number, ", column ", column,
+                            ": expected ", describeFieldType<T>(),
+                            ", but found '", field, "'.");
+                RETURN_ERROR(STATUS_INVALID_FIELD);
+            }
+
+            //! The whole buffer being parsed
+            std::string_view m_buffer;
+
+            //! The delimiter between each field of a record
+            char m_delim;
+
+            //! Where in m_buffer the next record starts
+            std::size_t m_next_record_offset;
+
+            //! The record currently being parsed, without its line ending
+            std::string_view m_record;
+
+            //! Where in m_record the next field starts, or npos if there are
+            //!   no more fields
+            std::size_t m_field_offset;
+
+            //! The 1-based line number of m_record
+            std::size_t m_line_number;
+
+            //! Whether numbers may be followed by other characters, which
+            //!   are then ignored
+            bool m_allow_trailing_characters;
+    };
+}
+
+#endif
+
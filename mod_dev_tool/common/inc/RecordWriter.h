@@ -0,0 +1,182 @@
+/**
+ * @file RecordWriter.h
+ *
+ * @brief Declares a writer for delimited text files, such as the .csv files
+ *        used by both HoI4 and the project files.
+ */
+
+#ifndef RECORD_WRITER_H
+# define RECORD_WRITER_H
+
+# include <algorithm>
+# include <charconv>
+# include <cstddef>
+# include <filesystem>
+# include <mutex>
+# include <string>
+# include <string_view>
+# include <type_traits>
+# include <utility>
+# include <vector>
+
+# include "Logger.h"
+
+# include "Maybe.h"
+# include "StatusCodes.h"
+# include "Types.h"
+# include "Util.h"
+# include "Uuid.h"
+
+namespace HMDT {
+    void encodeField(std::string&, std::string_view);
+    void encodeField(std::string&, const char*);
+    void encodeField(std::string&, bool);
+    void encodeField(std::string&, ProvinceType);
+    void encodeField(std::string&, const UUID&);
+
+    /**
+     * @brief Encodes an integer as a field
+     *
+     * @tparam T The type of integer to encode
+     * @param buffer The buffer to append the field to
+     * @param value The value to encode
+     */
+    template<typename T>
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>
+        encodeField(std::string& buffer, T value)
+    {
+        // Large enough for any 64-bit integer, including the sign
+        char str[24];
+
+        // Make sure 8-bit values are written as numbers rather than characters
+        auto [end, _] = std::to_chars(str, str + sizeof(str), +value);
+        buffer.append(str, end);
+    }
+
+    /**
+     * @brief Writes records of delimited text into a buffer, one record per
+     *        line.
+     * @details Usage is as follows:
+     * @code{.cpp}
+     * std::string buffer;
+     * RecordWriter writer(buffer, ';');
+     * writer.writeRecord(id, name, color.r, color.g, color.b);
+     * @endcode
+     */
+    class RecordWriter {
+        public:
+            RecordWriter(std::string&, char) noexcept;
+
+            /**
+             * @brief Writes a single field into the current record
+             *
+             * @param value The value of the field
+             */
+            template<typename T>
+            void writeField(const T& value) {
+                if(!m_at_record_start) {
+                    m_buffer.push_back(m_delim);
+                }
+                m_at_record_start = false;
+
+                encodeField(m_buffer, value);
+            }
+
+            /**
+             * @brief Writes every field into the current record, in order
+             *
+             * @param values The value of each field
+             */
+            template<typename... Ts>
+            void writeFields(const Ts&... values) {
+                (writeField(values), ...);
+            }
+
+            /**
+             * @brief Writes every field as a whole record, and then ends it
+             *
+             * @param values The value of each field
+             */
+            template<typename... Ts>
+            void writeRecord(const Ts&... values) {
+                writeFields(values...);
+                endRecord();
+            }
+
+            void endRecord();
+
+        private:
+            //! The buffer to write into
+            std::string& m_buffer;
+
+            //! The delimiter between each field of a record
+            char m_delim;
+
+            //! Whether nothing has been written into the current record yet
+            bool m_at_record_start;
+    };
+
+    MaybeVoid writeBuffersToFile(const std::filesystem::path&,
+                                 const std::vector<std::string>&) noexcept;
+
+    /**
+     * @brief Writes records into a file, formatting them in parallel.
+     * @details The records are split into one contiguous chunk per core, and
+     *          each chunk is formatted into its own buffer. The buffers are then
+     *          written out in order, with one write each, so the file is always
+     *          the same no matter how the work was split up. Records should be
+     *          in a stable order (for example, sorted by ID) for the output to
+     *          be the same between runs.
+     *
+     * @param path The file to write to
+     * @param count How many records to write
+     * @param delim The delimiter between each field of a record
+     * @param write_record Called as write_record(index, writer) for every index
+     *                     in [0, count). May be called from multiple threads
+     *                     at once.
+     *
+     * @return STATUS_SUCCESS on success, STATUS_BADALLOC if any buffer could
+     *         not be allocated, or an error code if the file could not be
+     *         written.
+     */
+    template<typename F>
+    MaybeVoid writeRecordsToFile(const std::filesystem::path& path,
+                                 std::size_t count, char delim,
+                                 F&& write_record) noexcept
+    {
+        std::vector<std::pair<uint64_t, std::string>> chunks;
+        std::mutex chunks_mutex;
+
+        auto result = tryParallelForEachRange(count, [&](uint64_t begin, uint64_t end) {
+            std::string buffer;
+
+            RecordWriter writer(buffer, delim);
+            for(auto i = begin; i < end; ++i) {
+                write_record(static_cast<std::size_t>(i), writer);
+            }
+
+            std::lock_guard lock(chunks_mutex);
+            chunks.emplace_back(begin, std::move(buffer));
+        });
+        if(IS_FAILURE(result)) {
+            WRITE_ERROR("Failed to build the records to write to ", path);
+            RETURN_ERROR(result.error());
+        }
+
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const auto& c1, const auto& c2) {
+                      return c1.first < c2.first;
+                  });
+
+        std::vector<std::string> buffers;
+        buffers.reserve(chunks.size());
+        for(auto&& [_, buffer] : chunks) {
+            buffers.push_back(std::move(buffer));
+        }
+
+        return writeBuffersToFile(path, buffers);
+    }
+}
+
+#endif
+
@@ -0,0 +1,22 @@
+/**
+ * @file RiverGenerator.h
+ *
+ * @brief Declares functions for generating rivers from a heightmap.
+ */
+
+#ifndef RIVER_GENERATOR_H
+# define RIVER_GENERATOR_H
+
+# include <cstdint>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    MaybeVoid generateRivers(const Dimensions&, const uint8_t*,
+                             const ProvinceID*, const ProvinceList&,
+                             uint32_t, uint8_t*);
+}
+
+#endif
+
@@ -0,0 +1,57 @@
+/**
+ * @file RiverValidator.h
+ *
+ * @brief Declares functions for finding mistakes in a rivers map which HoI4
+ *        would either crash on or silently not draw.
+ */
+
+#ifndef RIVER_VALIDATOR_H
+# define RIVER_VALIDATOR_H
+
+# include <array>
+# include <cstdint>
+# include <ostream>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief Every kind of mistake which can be found in a rivers map
+     */
+    enum class RiverIssueType {
+        INVALID_COLOR, //!< A color which is not in the rivers palette
+        MISSING_SOURCE, //!< A river with fewer source pixels than it needs
+        EXTRA_SOURCE, //!< A river with more source pixels than it needs
+        BLOB, //!< 2x2 river pixels, so the river is more than 1 pixel wide
+        DIAGONAL_CONNECTION, //!< Two river pixels which only touch diagonally
+        INLAND_END //!< A river which stops without a marker or reaching water
+    };
+
+    /**
+     * @brief A single mistake found in a rivers map
+     */
+    struct RiverIssue {
+        RiverIssueType type; //!< What kind of mistake this is
+        Point2D position; //!< The pixel where the mistake was found
+    };
+
+    //! Maps every possible pixel value of a rivers map to the color index it
+    //!   stands for, or to INVALID_RIVER_COLOR if it is not a valid color
+    using RiverPalette = std::array<uint8_t, 256>;
+
+    //! Marks that a pixel value is not a valid rivers color
+    constexpr uint8_t INVALID_RIVER_COLOR = 0xFF;
+
+    Maybe<std::vector<RiverIssue>> validateRivers(const Dimensions&,
+                                                  const uint8_t*,
+                                                  const RiverPalette&,
+                                                  const ProvinceID*,
+                                                  const ProvinceList&);
+
+    std::ostream& operator<<(std::ostream&, const RiverIssueType&);
+}
+
+#endif
+
@@ -0,0 +1,111 @@
+/**
+ * @file ScriptTokenizer.h
+ *
+ * @brief Declares a tokenizer for the script files used by HoI4, such as the
+ *        state history files.
+ */
+
+#ifndef SCRIPT_TOKENIZER_H
+# define SCRIPT_TOKENIZER_H
+
+# include <cstddef>
+# include <optional>
+# include <ostream>
+# include <string_view>
+
+# include "Maybe.h"
+
+namespace HMDT {
+    /**
+     * @brief Every kind of token which can be found in a script file
+     */
+    enum class ScriptTokenType {
+        //! A bare word, such as a key, a number, or an unquoted value
+        WORD,
+
+        //! A quoted string. The token's text does not include the quotes.
+        STRING,
+
+        //! One of =, <, >, <=, >=, !=, == or ?=
+        OPERATOR,
+
+        //! {
+        OPEN_BRACE,
+
+        //! }
+        CLOSE_BRACE,
+
+        //! A quoted string which is never closed
+        INVALID,
+
+        //! The end of the file
+        END_OF_FILE
+    };
+
+    /**
+     * @brief A single token from a script file
+     */
+    struct ScriptToken {
+        //! What kind of token this is
+        ScriptTokenType type;
+
+        //! The text of this token, as a view into the file being tokenized
+        std::string_view text;
+
+        //! The 1-based line this token starts on
+        std::size_t line;
+
+        //! The 1-based column this token starts at
+        std::size_t column;
+    };
+
+    /**
+     * @brief Splits a script file into tokens.
+     * @details Like RecordParser, this works entirely on views into the given
+     *          buffer, so it never allocates. Comments (from a '#' to the end
+     *          of the line) and a leading UTF-8 byte order mark are skipped.
+     *          Usage is as follows:
+     * @code{.cpp}
+     * ScriptTokenizer tokenizer(buffer);
+     * for(auto token = tokenizer.next();
+     *     token.type != ScriptTokenType::END_OF_FILE;
+     *     token = tokenizer.next())
+     * {
+     *     // ...
+     * }
+     * @endcode
+     */
+    class ScriptTokenizer {
+        public:
+            ScriptTokenizer(std::string_view) noexcept;
+
+            ScriptToken next() noexcept;
+            const ScriptToken& peek() noexcept;
+
+            MaybeVoid skipValue() noexcept;
+
+        private:
+            ScriptToken lex() noexcept;
+
+            //! The whole buffer being tokenized
+            std::string_view m_buffer;
+
+            //! Where in m_buffer the next token is looked for
+            std::size_t m_offset;
+
+            //! The 1-based line number at m_offset
+            std::size_t m_line;
+
+            //! Where in m_buffer the line at m_offset starts
+            std::size_t m_line_start;
+
+            //! The token returned by the last call to peek(), if it has not
+            //!   been consumed by next() yet
+            std::optional<ScriptToken> m_peeked;
+    };
+
+    std::ostream& operator<<(std::ostream&, const ScriptTokenType&);
+}
+
+#endif
+
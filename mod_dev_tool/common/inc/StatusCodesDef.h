@@ -35,6 +35,7 @@
     X(NO_DATA_LOADED, gettext("No data is currently loaded.")) \
     X(DIMENSION_MISMATCH, gettext("The loaded map image has dimensions which do not match previously loaded maps.")) \
     X(CALLBACK_NOT_REGISTERED, gettext("No prompt callback was registered with this project.")) \
+    X(LOAD_CANCELLED, gettext("Loading was cancelled before it could finish.")) \
     /* Province Project Error Codes */ \
     Y(PROVINCE_PROJECT, 0x200) \
     X(PROVINCE_INVALID_STATE_ID, gettext("The Province's StateID is invalid.")) \
@@ -42,6 +43,9 @@
     /* State Project Error Codes */ \
     Y(STATE_PROJECT, 0x300) \
     X(STATE_DOES_NOT_EXIST, gettext("The state does not exist.")) \
+    /* Strategic Region Project Error Codes */ \
+    Y(STRATEGIC_REGION_PROJECT, 0x400) \
+    X(STRATEGIC_REGION_DOES_NOT_EXIST, gettext("The strategic region does not exist.")) \
     /* Gui Error Codes */ \
     Y(GUI, 0x2000) \
     X(DISPATCHER_DOES_NOT_EXIST, gettext("The provided dispatcher id does not exist.")) \
@@ -67,6 +71,15 @@
     X(INVALID_BITS_PER_PIXEL, gettext("Invalid Bits Per Pixel.")) \
     X(COLOR_TABLE_REQUIRED, gettext("A color table is required to be provided.")) \
     X(INVALID_BIT_DEPTH, gettext("The bit-depth of the image is invalid.")) \
+    /* Record Parser Error Codes */ \
+    Y(RECORD_PARSER, 0x16400) \
+    X(MISSING_FIELD, gettext("A required field is missing from the record.")) \
+    X(INVALID_FIELD, gettext("A field could not be converted to the expected type.")) \
+    /* Script Parser Error Codes */ \
+    Y(SCRIPT_PARSER, 0x16600) \
+    X(UNEXPECTED_TOKEN, gettext("An unexpected token was found in the script.")) \
+    X(UNTERMINATED_STRING, gettext("A quoted string in the script is never closed.")) \
+    X(UNEXPECTED_END_OF_SCRIPT, gettext("The script ended before a block was closed.")) \
     /* Unexpected/Miscellaneous Error Codes */ \
     Y(MISCELLANEOUS, 0x7fffff9c) /* give us at least 100 before the end of the value space */ \
     X(UNEXPECTED, gettext("An unexpected error has occurred.")) \
@@ -0,0 +1,39 @@
+/**
+ * @file StraitFinder.h
+ *
+ * @brief Declares functions for finding narrow sea crossings between separate
+ *        landmasses.
+ */
+
+#ifndef STRAIT_FINDER_H
+# define STRAIT_FINDER_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief A candidate sea crossing between two land provinces
+     */
+    struct Strait {
+        ProvinceID from; //!< The land province on one side of the crossing
+        ProvinceID to; //!< The land province on the other side of the crossing
+        ProvinceID through; //!< The sea province being crossed
+
+        Point2D start; //!< The shore pixel of 'from' the crossing starts at
+        Point2D stop; //!< The shore pixel of 'to' the crossing stops at
+
+        double width; //!< The distance between start and stop, in pixels
+    };
+
+    Maybe<std::vector<Strait>> findStraits(const Dimensions&,
+                                           const ProvinceID*,
+                                           const ProvinceList&,
+                                           uint32_t);
+}
+
+#endif
+
@@ -0,0 +1,24 @@
+/**
+ * @file StrategicRegionBuilder.h
+ *
+ * @brief Declares functions for partitioning provinces into strategic regions.
+ */
+
+#ifndef STRATEGIC_REGION_BUILDER_H
+# define STRATEGIC_REGION_BUILDER_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    Maybe<std::vector<std::vector<ProvinceID>>> clusterStrategicRegions(const Dimensions&,
+                                                                        const ProvinceID*,
+                                                                        const ProvinceList&,
+                                                                        uint64_t);
+}
+
+#endif
+
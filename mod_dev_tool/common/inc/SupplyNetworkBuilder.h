@@ -0,0 +1,38 @@
+/**
+ * @file SupplyNetworkBuilder.h
+ *
+ * @brief Declares functions for generating supply hubs and the railways which
+ *        connect them.
+ */
+
+#ifndef SUPPLY_NETWORK_BUILDER_H
+# define SUPPLY_NETWORK_BUILDER_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief A network of supply hubs, and the railways between them
+     */
+    struct SupplyNetwork {
+        //! Every province which has a supply hub in it
+        std::vector<ProvinceID> supply_nodes;
+
+        //! Every railway, as the list of provinces it runs through in order
+        std::vector<std::vector<ProvinceID>> railways;
+    };
+
+    Maybe<SupplyNetwork> buildSupplyNetwork(const Dimensions&,
+                                            const ProvinceID*,
+                                            const uint8_t*,
+                                            const uint8_t*,
+                                            const ProvinceList&,
+                                            const StateList&);
+}
+
+#endif
+
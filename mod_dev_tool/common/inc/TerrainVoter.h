@@ -0,0 +1,56 @@
+/**
+ * @file TerrainVoter.h
+ *
+ * @brief Declares functions for picking the terrain of every province from a
+ *        terrain map.
+ */
+
+#ifndef TERRAIN_VOTER_H
+# define TERRAIN_VOTER_H
+
+# include <cstdint>
+# include <set>
+# include <unordered_map>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief How to pick between terrains which cover the same number of
+     *        pixels of a province
+     */
+    enum class TerrainTieBreak {
+        FIRST_LISTED, //!< The terrain with the lowest palette index wins
+        LAST_LISTED, //!< The terrain with the highest palette index wins
+        KEEP_CURRENT //!< The province's current terrain wins if it is tied, otherwise FIRST_LISTED
+    };
+
+    /**
+     * @brief All parameters used to vote on the terrain of every province
+     */
+    struct TerrainVoteOptions {
+        //! How to pick between terrains with the same number of pixels
+        TerrainTieBreak tie_break = TerrainTieBreak::FIRST_LISTED;
+
+        //! Palette indices whose pixels do not vote
+        std::set<uint8_t> ignored_indices;
+
+        //! Terrains whose pixels do not vote
+        std::set<TerrainID> ignored_terrains = { "unknown" };
+
+        //! Whether sea and lake provinces are voted on as well
+        bool include_water = false;
+    };
+
+    Maybe<std::unordered_map<ProvinceID, TerrainID>> voteProvinceTerrains(const Dimensions&,
+                                                                          const ProvinceID*,
+                                                                          const uint8_t*,
+                                                                          const ProvinceList&,
+                                                                          const std::vector<TerrainID>&,
+                                                                          const TerrainVoteOptions&);
+}
+
+#endif
+
@@ -0,0 +1,28 @@
+/**
+ * @file TileHash.h
+ *
+ * @brief Declares functions for finding which tiles of a map layer changed
+ *        between two versions of it.
+ */
+
+#ifndef TILE_HASH_H
+# define TILE_HASH_H
+
+# include <cstdint>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    Maybe<std::vector<uint64_t>> hashTiles(const Dimensions&, const uint8_t*,
+                                           uint32_t, uint32_t) noexcept;
+
+    Maybe<std::vector<Rectangle>> findChangedTiles(const Dimensions&,
+                                                   const uint8_t*,
+                                                   const uint8_t*, uint32_t,
+                                                   uint32_t) noexcept;
+}
+
+#endif
+
@@ -168,6 +168,18 @@ namespace HMDT {
      */
     using StateList = std::map<StateID, State>;
 
+    using StrategicRegionID = std::uint32_t;
+
+    /**
+     * @brief A strategic region as HOI4 will recognize it.
+     */
+    struct StrategicRegion {
+        StrategicRegionID id;
+        std::string name;
+
+        std::vector<ProvinceID> provinces;
+    };
+
     std::ostream& operator<<(std::ostream&, const Point2D&);
     std::ostream& operator<<(std::ostream&, const Color&);
 
@@ -9,6 +9,7 @@
 
 # include <cstdint>
 # include <algorithm>
+# include <exception>
 # include <istream>
 # include <memory>
 # include <filesystem>
@@ -16,8 +17,14 @@
 # include <optional>
 # include <thread>
 # include <future>
+# include <limits>
+# include <type_traits>
+# include <unordered_map>
+# include <unordered_set>
+# include <vector>
 
 # include "Types.h"
+# include "Constants.h"
 # include "Logger.h"
 # include "PreprocessorUtils.h"
 # include "TypeTraits.h"
@@ -33,6 +40,7 @@ namespace HMDT {
     std::uint32_t swapBytes(std::uint32_t);
     std::uint32_t colorToRGB(const Color&);
     Color RGBToColor(std::uint32_t);
+    Color colorFromString(const std::string&);
     bool doColorsMatch(const Color&, const Color&);
 
     uint64_t xyToIndex(const BitMap*, uint32_t, uint32_t);
@@ -50,6 +58,7 @@ namespace HMDT {
     bool isInImage(const Dimensions&, uint32_t, uint32_t);
 
     bool isShapeTooLarge(uint32_t, uint32_t, const BitMap*);
+    bool isShapeTooLarge(uint32_t, uint32_t, const Dimensions&);
     std::pair<uint32_t, uint32_t> calcDims(const BoundingBox&);
     std::pair<uint32_t, uint32_t> calcShapeDims(const Polygon&);
 
@@ -74,6 +83,14 @@ namespace HMDT {
 
     void writeColorTo(unsigned char*, uint32_t, uint32_t, uint32_t, Color);
 
+    std::vector<Point2D> getPixelsInCircle(const Dimensions&, const Point2D&,
+                                           uint32_t);
+    std::vector<Point2D> getPixelsAlongStroke(const Dimensions&,
+                                              const std::vector<Point2D>&,
+                                              uint32_t);
+    std::vector<Point2D> getPixelsInPolygon(const Dimensions&,
+                                            const std::vector<Point2D>&);
+
     // Taken from https://en.cppreference.com/w/cpp/utility/variant/visit
     template<typename... Ts>
     struct overloaded: Ts... {
@@ -517,6 +534,103 @@ namespace HMDT {
         return result;
     }
 
+    /**
+     * @brief Calculates which edges of a single pixel border a different value
+     *        in the given matrix.
+     *
+     * @details Pixels on the edge of the map are not considered to border
+     *          anything past the edge of the map.
+     *
+     * @tparam T The type of each value in the matrix
+     *
+     * @param dimensions The dimensions of the matrix
+     * @param matrix The matrix to check
+     * @param x The x coordinate of the pixel
+     * @param y The y coordinate of the pixel
+     *
+     * @return A combination of OUTLINE_NORTH, OUTLINE_EAST, OUTLINE_SOUTH, and
+     *         OUTLINE_WEST
+     */
+    template<typename T>
+    uint8_t calculateEdgeFlags(const Dimensions& dimensions, const T* matrix,
+                               uint32_t x, uint32_t y)
+    {
+        const auto& value = matrix[xyToIndex(dimensions.w, x, y)];
+
+        uint8_t flags = 0;
+
+        if(y > 0 && matrix[xyToIndex(dimensions.w, x, y - 1)] != value) {
+            flags |= OUTLINE_NORTH;
+        }
+
+        if(x + 1 < dimensions.w && matrix[xyToIndex(dimensions.w, x + 1, y)] != value) {
+            flags |= OUTLINE_EAST;
+        }
+
+        if(y + 1 < dimensions.h && matrix[xyToIndex(dimensions.w, x, y + 1)] != value) {
+            flags |= OUTLINE_SOUTH;
+        }
+
+        if(x > 0 && matrix[xyToIndex(dimensions.w, x - 1, y)] != value) {
+            flags |= OUTLINE_WEST;
+        }
+
+        return flags;
+    }
+
+    /**
+     * @brief Finds every pixel 4-connected to the given point which has the
+     *        same value in the matrix. The cost of this is bounded by the size
+     *        of the region found rather than by the size of the matrix.
+     *
+     * @tparam T The type of each value in the matrix
+     *
+     * @param dimensions The dimensions of the matrix
+     * @param matrix The matrix to search
+     * @param start The point to start searching from
+     *
+     * @return Every pixel in the connected region, or an empty list if start
+     *         is outside of the matrix
+     */
+    template<typename T>
+    std::vector<Point2D> getConnectedPixels(const Dimensions& dimensions,
+                                            const T* matrix,
+                                            const Point2D& start)
+    {
+        std::vector<Point2D> pixels;
+
+        if(!isInImage(dimensions, start.x, start.y)) {
+            return pixels;
+        }
+
+        const auto value = matrix[xyToIndex(dimensions.w, start.x, start.y)];
+
+        std::unordered_set<uint64_t> visited;
+        std::vector<Point2D> to_visit{ start };
+        visited.insert(xyToIndex(dimensions.w, start.x, start.y));
+
+        auto visit = [&](uint32_t x, uint32_t y) {
+            auto index = xyToIndex(dimensions.w, x, y);
+            if(matrix[index] == value && visited.insert(index).second) {
+                to_visit.push_back({ x, y });
+            }
+        };
+
+        while(!to_visit.empty()) {
+            auto point = to_visit.back();
+            to_visit.pop_back();
+
+            pixels.push_back(point);
+
+            if(point.y > 0) visit(point.x, point.y - 1);
+            if(point.x + 1 < dimensions.w) visit(point.x + 1, point.y);
+            if(point.y + 1 < dimensions.h) visit(point.x, point.y + 1);
+            if(point.x > 0) visit(point.x - 1, point.y);
+        }
+
+        return pixels;
+    }
+
     template<typename InputIt, typename OutputIt, typename UnaryOperation>
     void parallelTransform(InputIt first, InputIt last, OutputIt d_first,
                            UnaryOperation unary_op)
@@ -593,6 +707,184 @@ namespace HMDT {
         }
     }
 
+    /**
+     * @brief Splits [0, count) into one contiguous range per core, and calls
+     *        func(begin, end) on each range in parallel.
+     * @details Blocks until every range has been processed. Each range is only
+     *          ever seen by a single thread, so func may keep per-range state.
+     *          If func throws on any range, the first exception is rethrown
+     *          once every range has finished.
+     *
+     * @param count The number of elements to process
+     * @param func The function to call on each range
+     */
+    template<typename F>
+    void parallelForEachRange(uint64_t count, F&& func) {
+        uint64_t thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+
+        if(thread_count <= 1 || count <= thread_count) {
+            func(uint64_t{0}, count);
+            return;
+        }
+
+        auto step = count / thread_count;
+
+        std::vector<std::future<void>> futures;
+        for(uint64_t i = 0; i < thread_count; ++i) {
+            auto begin = i * step;
+            auto end = (i + 1 == thread_count) ? count : begin + step;
+
+            futures.push_back(std::async(std::launch::async,
+                                         [&func, begin, end]() {
+                                             func(begin, end);
+                                         }));
+        }
+
+        // Every range has to finish before anything gets rethrown, as func
+        //   may refer to the caller's stack
+        std::exception_ptr error;
+        for(auto&& future : futures) {
+            try {
+                future.get();
+            } catch(...) {
+                if(!error) error = std::current_exception();
+            }
+        }
+
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * @brief Calls parallelForEachRange, turning anything thrown by func into
+     *        a status code, for use in functions which cannot throw.
+     *
+     * @param count The number of elements to process
+     * @param func The function to call on each range
+     *
+     * @return STATUS_SUCCESS on success, STATUS_BADALLOC if memory could not
+     *         be allocated, or STATUS_UNEXPECTED if anything else was thrown
+     *         (including a failure to start a thread).
+     */
+    template<typename F>
+    MaybeVoid tryParallelForEachRange(uint64_t count, F&& func) noexcept {
+        try {
+            parallelForEachRange(count, std::forward<F>(func));
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(STATUS_BADALLOC);
+        } catch(const std::exception& e) {
+            WRITE_ERROR("Failed to process ", count, " elements in parallel: ",
+                        e.what());
+            RETURN_ERROR(STATUS_UNEXPECTED);
+        } catch(...) {
+            WRITE_ERROR("Failed to process ", count, " elements in parallel.");
+            RETURN_ERROR(STATUS_UNEXPECTED);
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    //! Marks a province which has no index in a ProvinceIndexMap
+    constexpr uint32_t NO_PROVINCE_INDEX = std::numeric_limits<uint32_t>::max();
+
+    //! Gives every province being worked on a dense index, from 0 up
+    using ProvinceIndexMap = std::unordered_map<ProvinceID, uint32_t>;
+
+    ProvinceIndexMap indexProvinceIDs(const std::vector<ProvinceID>&);
+    uint32_t findProvinceIndex(const ProvinceIndexMap&, const ProvinceID&) noexcept;
+
+    /**
+     * @brief Looks up something about the province of each pixel, only doing
+     *        the lookup again when the province changes.
+     * @details Provinces are contiguous, so remembering the last one saves
+     *          most of the lookups when walking over a map. Only the address of
+     *          the last ID is kept, so every ID must come from the same map.
+     *
+     * @tparam F The lookup, called as lookup(id)
+     */
+    template<typename F>
+    class CachedProvinceLookup {
+        public:
+            using Value = std::decay_t<std::invoke_result_t<F&, const ProvinceID&>>;
+
+            CachedProvinceLookup(F& lookup): m_lookup(lookup) { }
+
+            const Value& operator()(const ProvinceID& id) {
+                if(m_last_id == nullptr || *m_last_id != id) {
+                    m_last_id = &id;
+                    m_last_value = m_lookup(id);
+                }
+
+                return m_last_value;
+            }
+
+        private:
+            //! The lookup to cache
+            F& m_lookup;
+
+            //! The last province looked up, or nullptr if there wasn't one
+            const ProvinceID* m_last_id = nullptr;
+
+            //! The result of looking up m_last_id
+            Value m_last_value{ };
+    };
+
+    /**
+     * @brief Fills in one value for every pixel by looking up its province,
+     *        in parallel.
+     *
+     * @param province_matrix The province of every pixel
+     * @param size The number of pixels
+     * @param output Filled with lookup(id) for every pixel
+     * @param lookup The lookup. May be called from multiple threads at once.
+     */
+    template<typename T, typename F>
+    void mapProvinceMatrix(const ProvinceID* province_matrix, uint64_t size,
+                           T* output, F&& lookup)
+    {
+        parallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+            CachedProvinceLookup cached(lookup);
+
+            for(auto i = begin; i < end; ++i) {
+                output[i] = cached(province_matrix[i]);
+            }
+        });
+    }
+
+    void buildProvinceIndexMatrix(const ProvinceID*, uint64_t,
+                                  const ProvinceIndexMap&, uint32_t*);
+
+    /**
+     * @brief Running totals over every pixel of a single province
+     */
+    struct ProvincePixelStats {
+        uint64_t count = 0; //!< Number of pixels
+
+        uint64_t sum_x = 0; //!< Sum of every X coordinate
+        uint64_t sum_y = 0; //!< Sum of every Y coordinate
+
+        uint32_t min_x = std::numeric_limits<uint32_t>::max(); //!< Left-most X
+        uint32_t min_y = std::numeric_limits<uint32_t>::max(); //!< Top-most Y
+        uint32_t max_x = 0; //!< Right-most X
+        uint32_t max_y = 0; //!< Bottom-most Y
+
+        //! Index of the first pixel, in reading order
+        uint64_t first = std::numeric_limits<uint64_t>::max();
+
+        uint64_t height_sum = 0; //!< Sum of every height, if any were added
+        uint8_t min_height = 255; //!< Lowest height
+        uint8_t max_height = 0; //!< Highest height
+
+        void addPixel(uint32_t, uint32_t, uint64_t) noexcept;
+        void addHeight(uint8_t) noexcept;
+        void merge(const ProvincePixelStats&) noexcept;
+    };
+
+    std::vector<ProvincePixelStats> gatherProvincePixelStats(const Dimensions&,
+                                                             const ProvinceID*,
+                                                             const ProvinceIndexMap&);
+
     /**
      * @brief Joins a range of values together into a string.
      *
@@ -92,7 +92,10 @@ namespace HMDT {
 
             std::size_t hash() const noexcept;
 
+            void toChars(char*) const noexcept;
+
             static Maybe<UUID> parse(const std::string&) noexcept;
+            static Maybe<UUID> parse(const char*) noexcept;
 
         private:
             SystemUUIDType m_internal_uuid;
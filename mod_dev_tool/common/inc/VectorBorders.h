@@ -0,0 +1,79 @@
+/**
+ * @file VectorBorders.h
+ *
+ * @brief Declares functions for tracing the borders between regions of a
+ *        per-pixel layer into vector lines, and for writing them out.
+ */
+
+#ifndef VECTOR_BORDERS_H
+# define VECTOR_BORDERS_H
+
+# include <cstdint>
+# include <limits>
+# include <ostream>
+# include <string>
+# include <utility>
+# include <vector>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    //! Used in place of a pixel index for the side of a border which is
+    //!   outside of the map
+    constexpr uint64_t BORDER_OUTSIDE_MAP = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * @brief A single border between exactly two regions.
+     * @details Points are corners of pixels, so a map of width W and height H
+     *          has corners from (0, 0) to (W, H), with y pointing down. Every
+     *          arc either runs between two junctions where three or more
+     *          borders meet, or is a closed ring whose first and last points
+     *          are the same. Each border between two regions is only ever
+     *          part of one arc, so neighboring regions share their arcs.
+     */
+    struct BorderArc {
+        //! Every point along the arc, in order
+        std::vector<Point2D> points;
+
+        //! A pixel of the region on the left of the arc, walking it in order,
+        //!   or BORDER_OUTSIDE_MAP
+        uint64_t left_pixel = BORDER_OUTSIDE_MAP;
+
+        //! A pixel of the region on the right of the arc, walking it in
+        //!   order, or BORDER_OUTSIDE_MAP
+        uint64_t right_pixel = BORDER_OUTSIDE_MAP;
+
+        bool isRing() const noexcept;
+    };
+
+    /**
+     * @brief Every border of one layer, along with what is on either side of
+     *        each of them
+     */
+    struct BorderLayer {
+        //! The name of the layer, such as "provinces"
+        std::string name;
+
+        //! Every border in the layer
+        std::vector<BorderArc> arcs;
+
+        //! The name of the region on the left and right of each arc, in the
+        //!   same order as arcs. Empty for no region.
+        std::vector<std::pair<std::string, std::string>> arc_labels;
+    };
+
+    Maybe<std::vector<BorderArc>> extractBorders(const Dimensions&,
+                                                 const ProvinceID*) noexcept;
+    Maybe<std::vector<BorderArc>> extractBorders(const Dimensions&,
+                                                 const StateID*) noexcept;
+
+    MaybeVoid simplifyBorders(std::vector<BorderArc>&, double) noexcept;
+
+    void writeBordersSVG(std::ostream&, const Dimensions&,
+                         const std::vector<BorderLayer>&);
+    void writeBordersGeoJSON(std::ostream&, const Dimensions&,
+                             const std::vector<BorderLayer>&);
+}
+
+#endif
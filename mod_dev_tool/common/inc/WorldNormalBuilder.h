@@ -10,6 +10,7 @@
 # include <cstdint>
 
 # include "Maybe.h"
+# include "Types.h"
 
 namespace HMDT {
     struct BitMap;
@@ -18,6 +19,11 @@ namespace HMDT {
     [[deprecated]] void generateWorldNormalMap(BitMap*, unsigned char*);
 
     MaybeVoid generateWorldNormalMap(const BitMap2&, unsigned char*);
+
+    MaybeVoid generateWorldNormalMap(const uint8_t*, const Dimensions&,
+                                     unsigned char*);
+    MaybeVoid generateWorldNormalMap(const uint8_t*, const Dimensions&,
+                                     unsigned char*, const Rectangle&);
 }
 
 #endif
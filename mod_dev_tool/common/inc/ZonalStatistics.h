@@ -0,0 +1,80 @@
+/**
+ * @file ZonalStatistics.h
+ *
+ * @brief Declares functions for computing statistics of every province from
+ *        the per-pixel map layers.
+ */
+
+#ifndef ZONAL_STATISTICS_H
+# define ZONAL_STATISTICS_H
+
+# include <cstdint>
+# include <unordered_map>
+
+# include "Maybe.h"
+# include "Types.h"
+
+namespace HMDT {
+    /**
+     * @brief Statistics of a single province, gathered from the map layers
+     */
+    struct ProvinceStatistics {
+        //! How many pixels the province has
+        uint64_t pixel_count = 0;
+
+        ////////////////////////////////////////////////////////////////////////
+        // ZONAL_LAYER_PROVINCES
+
+        //! How many pixel edges are on the border of the province, including
+        //!   those along the edge of the map
+        uint64_t perimeter = 0;
+
+        //! How many pixel edges the province shares with each of its neighbors
+        std::unordered_map<ProvinceID, uint64_t> border_lengths;
+
+        ////////////////////////////////////////////////////////////////////////
+        // ZONAL_LAYER_HEIGHTMAP
+
+        uint8_t min_height = 0; //!< The lowest height of any pixel
+        uint8_t max_height = 0; //!< The highest height of any pixel
+        double mean_height = 0; //!< The average height of every pixel
+
+        //! The average steepness of every pixel, in heightmap units per pixel
+        double mean_slope = 0;
+
+        ////////////////////////////////////////////////////////////////////////
+        // ZONAL_LAYER_RIVERS
+
+        //! How many pixels of the province have a river on them
+        uint64_t river_pixel_count = 0;
+    };
+
+    //! The statistics of every province
+    using ProvinceStatisticsMap = std::unordered_map<ProvinceID, ProvinceStatistics>;
+
+    /**
+     * @brief Every per-pixel layer statistics are computed from
+     */
+    struct ZonalStatisticsLayers {
+        //! The dimensions of every layer
+        Dimensions dimensions;
+
+        //! The province of every pixel. Required.
+        const ProvinceID* provinces = nullptr;
+
+        //! The height of every pixel. Required for ZONAL_LAYER_HEIGHTMAP.
+        const uint8_t* heightmap = nullptr;
+
+        //! The river palette index of every pixel. Required for
+        //!   ZONAL_LAYER_RIVERS.
+        const uint8_t* rivers = nullptr;
+    };
+
+    MaybeVoid computeZonalStatistics(const ZonalStatisticsLayers&, uint8_t,
+                                     ProvinceStatisticsMap&) noexcept;
+
+    uint64_t getCoastlineLength(const ProvinceStatistics&, const Province&,
+                                const ProvinceList&) noexcept;
+}
+
+#endif
@@ -353,49 +353,12 @@ auto HMDT::readBMP(std::istream& stream, BitMap2& bm) noexcept
         RETURN_IF_ERROR(res);                         \
     } while(0)
 
-    // Safely read the entire header into the struct.
-    READ_FROM_BMP(&(bm.file_header.filetype));
-    READ_FROM_BMP(&(bm.file_header.fileSize));
-    READ_FROM_BMP(&(bm.file_header.reserved1));
-    READ_FROM_BMP(&(bm.file_header.reserved2));
-    READ_FROM_BMP(&(bm.file_header.bitmapOffset));
-    READ_FROM_BMP(&(bm.info_header.v1.headerSize));
-    READ_FROM_BMP(&(bm.info_header.v1.width));
-    READ_FROM_BMP(&(bm.info_header.v1.height));
-    READ_FROM_BMP(&(bm.info_header.v1.bitPlanes));
-    READ_FROM_BMP(&(bm.info_header.v1.bitsPerPixel));
-    READ_FROM_BMP(&(bm.info_header.v1.compression));
-    READ_FROM_BMP(&(bm.info_header.v1.sizeOfBitmap));
-    READ_FROM_BMP(&(bm.info_header.v1.horzResolution));
-    READ_FROM_BMP(&(bm.info_header.v1.vertResolution));
-    READ_FROM_BMP(&(bm.info_header.v1.colorsUsed));
-    READ_FROM_BMP(&(bm.info_header.v1.colorImportant));
-
-    // Read the V4 part of the header
-    if(bm.info_header.v1.headerSize >= 108) {
-        READ_FROM_BMP(&(bm.info_header.v4.redMask));
-        READ_FROM_BMP(&(bm.info_header.v4.greenMask));
-        READ_FROM_BMP(&(bm.info_header.v4.blueMask));
-        READ_FROM_BMP(&(bm.info_header.v4.alphaMask));
-        READ_FROM_BMP(&(bm.info_header.v4.CSType));
-
-        READ_FROM_BMP(&(bm.info_header.v4.redX));
-        READ_FROM_BMP(&(bm.info_header.v4.redY));
-        READ_FROM_BMP(&(bm.info_header.v4.redZ));
-        READ_FROM_BMP(&(bm.info_header.v4.greenX));
-        READ_FROM_BMP(&(bm.info_header.v4.greenY));
-        READ_FROM_BMP(&(bm.info_header.v4.greenZ));
-        READ_FROM_BMP(&(bm.info_header.v4.blueX));
-        READ_FROM_BMP(&(bm.info_header.v4.blueY));
-        READ_FROM_BMP(&(bm.info_header.v4.blueZ));
-
-        READ_FROM_BMP(&(bm.info_header.v4.gammaRed));
-        READ_FROM_BMP(&(bm.info_header.v4.gammaGreen));
-        READ_FROM_BMP(&(bm.info_header.v4.gammaBlue));
+    // Read every header first
+    {
+        auto res = readBMPHeader(stream, bm);
+        RETURN_IF_ERROR(res);
     }
 
-    // TODO: Do we need to worry about the V5 header?
-
 
     // Read the color table, if one exists
 
@@ -482,6 +445,160 @@ auto HMDT::readBMP(std::istream& stream, BitMap2& bm) noexcept
 #undef READ_FROM_BMP2
 }
 
+/**
+ * @brief Reads only the headers of a BitMap, without reading any of the color
+ *        table or image data.
+ * @details This is cheap regardless of how large the image is, so it can be
+ *          used to check an image before committing to loading all of it.
+ *
+ * @param path The path to the BitMap
+ * @param bm The BitMap to read the headers into
+ *
+ * @return The BitMap on success, or an error code on failure.
+ */
+auto HMDT::readBMPHeader(const std::filesystem::path& path, BitMap2& bm) noexcept
+    -> MaybeRef<BitMap2>
+{
+    // Make sure we clear errno first
+    errno = 0;
+
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    if(!file.is_open()) {
+        WRITE_ERROR("Failed to open bitmap file ", path);
+        RETURN_ERROR(std::error_code(errno, std::generic_category()));
+    }
+
+    auto res = readBMPHeader(file, bm);
+    RETURN_IF_ERROR(res);
+
+    return res;
+}
+
+/**
+ * @brief Reads only the headers of a BitMap from a stream.
+ * @details The stream is left positioned right after the headers, so that the
+ *          color table can be read next.
+ *
+ * @param stream The stream to read from
+ * @param bm The BitMap to read the headers into
+ *
+ * @return The BitMap on success, or an error code on failure.
+ */
+auto HMDT::readBMPHeader(std::istream& stream, BitMap2& bm) noexcept
+    -> MaybeRef<BitMap2>
+{
+#define READ_FROM_BMP(FIELD)                    \
+    do {                                        \
+        auto res = safeRead2(FIELD, stream); \
+        RETURN_IF_ERROR(res);                   \
+    } while(0)
+
+    // Safely read the entire header into the struct.
+    READ_FROM_BMP(&(bm.file_header.filetype));
+    READ_FROM_BMP(&(bm.file_header.fileSize));
+    READ_FROM_BMP(&(bm.file_header.reserved1));
+    READ_FROM_BMP(&(bm.file_header.reserved2));
+    READ_FROM_BMP(&(bm.file_header.bitmapOffset));
+    READ_FROM_BMP(&(bm.info_header.v1.headerSize));
+    READ_FROM_BMP(&(bm.info_header.v1.width));
+    READ_FROM_BMP(&(bm.info_header.v1.height));
+    READ_FROM_BMP(&(bm.info_header.v1.bitPlanes));
+    READ_FROM_BMP(&(bm.info_header.v1.bitsPerPixel));
+    READ_FROM_BMP(&(bm.info_header.v1.compression));
+    READ_FROM_BMP(&(bm.info_header.v1.sizeOfBitmap));
+    READ_FROM_BMP(&(bm.info_header.v1.horzResolution));
+    READ_FROM_BMP(&(bm.info_header.v1.vertResolution));
+    READ_FROM_BMP(&(bm.info_header.v1.colorsUsed));
+    READ_FROM_BMP(&(bm.info_header.v1.colorImportant));
+
+    // Read the V4 part of the header
+    if(bm.info_header.v1.headerSize >= 108) {
+        READ_FROM_BMP(&(bm.info_header.v4.redMask));
+        READ_FROM_BMP(&(bm.info_header.v4.greenMask));
+        READ_FROM_BMP(&(bm.info_header.v4.blueMask));
+        READ_FROM_BMP(&(bm.info_header.v4.alphaMask));
+        READ_FROM_BMP(&(bm.info_header.v4.CSType));
+
+        READ_FROM_BMP(&(bm.info_header.v4.redX));
+        READ_FROM_BMP(&(bm.info_header.v4.redY));
+        READ_FROM_BMP(&(bm.info_header.v4.redZ));
+        READ_FROM_BMP(&(bm.info_header.v4.greenX));
+        READ_FROM_BMP(&(bm.info_header.v4.greenY));
+        READ_FROM_BMP(&(bm.info_header.v4.greenZ));
+        READ_FROM_BMP(&(bm.info_header.v4.blueX));
+        READ_FROM_BMP(&(bm.info_header.v4.blueY));
+        READ_FROM_BMP(&(bm.info_header.v4.blueZ));
+
+        READ_FROM_BMP(&(bm.info_header.v4.gammaRed));
+        READ_FROM_BMP(&(bm.info_header.v4.gammaGreen));
+        READ_FROM_BMP(&(bm.info_header.v4.gammaBlue));
+    }
+
+    // TODO: Do we need to worry about the V5 header?
+
+    return std::ref(bm);
+
+#undef READ_FROM_BMP
+}
+
+/**
+ * @brief Reads some rows of a BitMap's image data, without reading the rest
+ *        of the image.
+ * @details Rows are counted from the top of the image, and are returned in the
+ *          same layout as readBMP would, just without the rows around them.
+ *
+ * @param stream The stream to read from
+ * @param bm The BitMap whose headers have already been read from stream
+ * @param first_row The first row to read
+ * @param row_count How many rows to read
+ * @param out Where to read the rows into. Must have space for row_count rows.
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
+auto HMDT::readBMPRows(std::istream& stream, const BitMap2& bm,
+                       uint32_t first_row, uint32_t row_count,
+                       unsigned char* out) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(out == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    uint32_t width = bm.info_header.v1.width;
+    uint32_t height = bm.info_header.v1.height;
+    uint32_t depth = bm.info_header.v1.bitsPerPixel / 8;
+
+    RETURN_ERROR_IF(first_row + row_count > height, STATUS_OUT_OF_RANGE);
+
+    uint64_t pitch = static_cast<uint64_t>(width) * depth;
+
+    // Rows may be padded out in the file, which the size of the image data
+    //   will account for
+    uint64_t stride = pitch;
+    if(height != 0 && bm.info_header.v1.sizeOfBitmap / height > pitch) {
+        stride = bm.info_header.v1.sizeOfBitmap / height;
+    }
+
+    for(uint32_t y = first_row; y < first_row + row_count; ++y) {
+        auto* row = out + (y - first_row) * pitch;
+
+        // BitMap rows are stored bottom to top
+        stream.clear();
+        stream.seekg(bm.file_header.bitmapOffset + (height - 1 - y) * stride,
+                     stream.beg);
+
+        auto res = safeRead2(row, pitch, stream);
+        RETURN_IF_ERROR(res);
+
+        if(depth == 3) {
+            for(uint64_t i = 2; i < pitch; i += depth) {
+                std::swap(row[i], row[i - 2]);
+            }
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
 auto HMDT::readBMP2(std::filesystem::path& path) noexcept -> Maybe<BitMap2> {
     BitMap2 bm;
 
@@ -641,20 +758,26 @@ auto HMDT::writeBMP(const std::filesystem::path& path, const BitMap2& bmp) noexc
 #undef WRITE_BMP_VALUE
 }
 
-auto HMDT::writeBMP2(const std::filesystem::path& path, unsigned char* data,
-                     uint32_t width, uint32_t height, uint16_t depth,
-                     bool is_greyscale, BMPHeaderToUse hdr_version_to_use,
-                     MonadOptional<ColorTable> color_table) noexcept
+/**
+ * @brief Fills out the headers and color table of a bitmap, without touching
+ *        its data.
+ *
+ * @param bmp The bitmap to fill out
+ * @param width The width of the bitmap
+ * @param height The height of the bitmap
+ * @param depth The number of bytes per pixel
+ * @param is_greyscale Whether the generated color table should be greyscale
+ * @param hdr_version_to_use Which version of the info header to fill out
+ * @param color_table A custom color table to use
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::createBMP2(BitMap2& bmp, uint32_t width, uint32_t height,
+                      uint16_t depth, bool is_greyscale,
+                      BMPHeaderToUse hdr_version_to_use,
+                      MonadOptional<ColorTable> color_table) noexcept
     -> MaybeVoid
 {
-    BitMap2 bmp{};
-
-    // Make sure we release the grabbed 'data' pointer when we exit, as it is
-    //   not ours to delete
-    RUN_AT_SCOPE_END([&bmp]() {
-        bmp.data.release();
-    });
-
     auto num_pixels = width * height;
 
     bmp.file_header.filetype = BM_TYPE;
@@ -767,6 +890,27 @@ auto HMDT::writeBMP2(const std::filesystem::path& path, unsigned char* data,
     });
     RETURN_IF_ERROR(res);
 
+    return STATUS_SUCCESS;
+}
+
+auto HMDT::writeBMP2(const std::filesystem::path& path, unsigned char* data,
+                     uint32_t width, uint32_t height, uint16_t depth,
+                     bool is_greyscale, BMPHeaderToUse hdr_version_to_use,
+                     MonadOptional<ColorTable> color_table) noexcept
+    -> MaybeVoid
+{
+    BitMap2 bmp{};
+
+    // Make sure we release the grabbed 'data' pointer when we exit, as it is
+    //   not ours to delete
+    RUN_AT_SCOPE_END([&bmp]() {
+        bmp.data.release();
+    });
+
+    auto res = createBMP2(bmp, width, height, depth, is_greyscale,
+                          hdr_version_to_use, std::move(color_table));
+    RETURN_IF_ERROR(res);
+
     bmp.data.reset(data);
 
     res = writeBMP(path, bmp);
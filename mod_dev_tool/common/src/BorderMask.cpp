@@ -0,0 +1,152 @@
+/**
+ * @file BorderMask.cpp
+ *
+ * @brief Defines functions for building the per-pixel province and state
+ *        border flags which the renderers draw borders from.
+ */
+
+#include "BorderMask.h"
+
+#include <algorithm>
+
+#include "Constants.h"
+#include "Util.h"
+
+/**
+ * @brief Grows an area by one pixel on every side, clamped to the map.
+ * @details Changing a pixel also changes the border flags of its neighbors, so
+ *          this is the area whose flags have to be rebuilt after the pixels in
+ *          the given area were changed.
+ *
+ * @param dimensions The dimensions of the map
+ * @param area The area which was changed
+ *
+ * @return The grown area.
+ */
+auto HMDT::growBorderArea(const Dimensions& dimensions,
+                          const Rectangle& area) noexcept
+    -> Rectangle
+{
+    if(area.w == 0 || area.h == 0) {
+        return Rectangle{ 0, 0, 0, 0 };
+    }
+
+    uint32_t min_x = (area.x > 0) ? area.x - 1 : 0;
+    uint32_t min_y = (area.y > 0) ? area.y - 1 : 0;
+    uint32_t max_x = std::min<uint64_t>(static_cast<uint64_t>(area.x) + area.w, dimensions.w - 1);
+    uint32_t max_y = std::min<uint64_t>(static_cast<uint64_t>(area.y) + area.h, dimensions.h - 1);
+
+    return Rectangle{ min_x, min_y, max_x - min_x + 1, max_y - min_y + 1 };
+}
+
+/**
+ * @brief Rebuilds the border flags of every pixel in an area.
+ * @details The province borders go in the low bits and the state borders in
+ *          the high bits (see OUTLINE_STATE_SHIFT). State borders are always
+ *          also province borders, so state borders are only looked for on
+ *          pixels which have a province border. Rows are built in parallel.
+ *
+ * @param dimensions The dimensions of the map
+ * @param provinces The province of every pixel
+ * @param state_ids The state of every pixel
+ * @param outlines The border flags of every pixel, which get written to
+ * @param area The area to rebuild. Must be within the map.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the rows could not be
+ *         built in parallel.
+ */
+auto HMDT::buildBorderMask(const Dimensions& dimensions,
+                           const ProvinceID* provinces,
+                           const uint32_t* state_ids,
+                           uint8_t* outlines,
+                           const Rectangle& area) noexcept
+    -> MaybeVoid
+{
+    return tryParallelForEachRange(area.h, [&](uint64_t begin, uint64_t end) {
+        for(uint32_t y = area.y + begin; y < area.y + end; ++y) {
+            for(uint32_t x = area.x; x < area.x + area.w; ++x) {
+                auto flags = calculateEdgeFlags(dimensions, provinces, x, y);
+                if(flags != 0) {
+                    flags |= calculateEdgeFlags(dimensions, state_ids, x, y) << OUTLINE_STATE_SHIFT;
+                }
+
+                outlines[xyToIndex(dimensions.w, x, y)] = flags;
+            }
+        }
+    });
+}
+
+/**
+ * @brief Rebuilds the border flags of every pixel on the map.
+ *
+ * @param dimensions The dimensions of the map
+ * @param provinces The province of every pixel
+ * @param state_ids The state of every pixel
+ * @param outlines The border flags of every pixel, which get written to
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the rows could not be
+ *         built in parallel.
+ */
+auto HMDT::buildBorderMask(const Dimensions& dimensions,
+                           const ProvinceID* provinces,
+                           const uint32_t* state_ids,
+                           uint8_t* outlines) noexcept
+    -> MaybeVoid
+{
+    return buildBorderMask(dimensions, provinces, state_ids, outlines,
+                           Rectangle{ 0, 0, dimensions.w, dimensions.h });
+}
+
+/**
+ * @brief Rebuilds only the state border flags of every pixel in an area,
+ *        leaving the province border flags as they are.
+ * @details This is all that has to be done when provinces move between states,
+ *          as the province borders do not change.
+ *
+ * @param dimensions The dimensions of the map
+ * @param state_ids The state of every pixel
+ * @param outlines The border flags of every pixel, which get written to
+ * @param area The area to rebuild. Must be within the map.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the rows could not be
+ *         rebuilt in parallel.
+ */
+auto HMDT::updateStateBorderMask(const Dimensions& dimensions,
+                                 const uint32_t* state_ids,
+                                 uint8_t* outlines,
+                                 const Rectangle& area) noexcept
+    -> MaybeVoid
+{
+    return tryParallelForEachRange(area.h, [&](uint64_t begin, uint64_t end) {
+        for(uint32_t y = area.y + begin; y < area.y + end; ++y) {
+            for(uint32_t x = area.x; x < area.x + area.w; ++x) {
+                auto& flags = outlines[xyToIndex(dimensions.w, x, y)];
+
+                flags &= OUTLINE_PROVINCE_MASK;
+                if(flags != 0) {
+                    flags |= calculateEdgeFlags(dimensions, state_ids, x, y) << OUTLINE_STATE_SHIFT;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief Rebuilds only the state border flags of every pixel on the map.
+ *
+ * @param dimensions The dimensions of the map
+ * @param state_ids The state of every pixel
+ * @param outlines The border flags of every pixel, which get written to
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the rows could not be
+ *         rebuilt in parallel.
+ */
+auto HMDT::updateStateBorderMask(const Dimensions& dimensions,
+                                 const uint32_t* state_ids,
+                                 uint8_t* outlines) noexcept
+    -> MaybeVoid
+{
+    return updateStateBorderMask(dimensions, state_ids, outlines,
+                                 Rectangle{ 0, 0, dimensions.w, dimensions.h });
+}
+
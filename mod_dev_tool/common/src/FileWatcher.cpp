@@ -0,0 +1,325 @@
+/**
+ * @file FileWatcher.cpp
+ *
+ * @brief Defines a class which watches files on disk for changes.
+ */
+
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifndef _WIN32
+# include <poll.h>
+# include <sys/inotify.h>
+# include <unistd.h>
+#endif
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+
+#ifndef _WIN32
+namespace {
+    //! Every inotify event which may mean that a file's contents changed.
+    //!   Files which get replaced instead of written to show up as MOVED_TO
+    constexpr uint32_t WATCH_EVENTS = IN_MODIFY | IN_CLOSE_WRITE |
+                                      IN_MOVED_TO | IN_CREATE;
+}
+#endif
+
+/**
+ * @brief Creates a new FileWatcher
+ *
+ * @param debounce How long a file must stay unchanged before it gets reported
+ */
+HMDT::FileWatcher::FileWatcher(std::chrono::milliseconds debounce):
+    m_debounce(debounce),
+    m_mutex(),
+    m_watched(),
+    m_pending(),
+#ifdef _WIN32
+    m_write_times(),
+#else
+    m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+    m_directories(),
+#endif
+    m_running(false),
+    m_thread()
+{
+#ifndef _WIN32
+    if(m_fd < 0) {
+        WRITE_ERROR("Failed to initialize inotify: ", std::strerror(errno));
+    }
+#endif
+}
+
+HMDT::FileWatcher::~FileWatcher() {
+    stop();
+
+#ifndef _WIN32
+    if(m_fd >= 0) {
+        close(m_fd);
+    }
+#endif
+}
+
+/**
+ * @brief Starts watching a file for changes.
+ *
+ * @param path The file to watch. Its directory must exist, but the file itself
+ *             does not have to yet.
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
+auto HMDT::FileWatcher::watch(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
+{
+    std::filesystem::path file;
+    try {
+        file = normalize(path);
+    } catch(const std::filesystem::filesystem_error& e) {
+        WRITE_ERROR("Failed to resolve ", path, ": ", e.what());
+        RETURN_ERROR(e.code());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_watched.count(file) != 0) {
+        return STATUS_SUCCESS;
+    }
+
+#ifdef _WIN32
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(file, ec);
+    m_write_times[file] = ec ? std::filesystem::file_time_type::min() : write_time;
+    m_watched[file] = 0;
+#else
+    RETURN_ERROR_IF(m_fd < 0, STATUS_UNINITIALIZED);
+
+    // Watching the same directory twice gives back the same descriptor
+    errno = 0;
+    int wd = inotify_add_watch(m_fd, file.parent_path().c_str(), WATCH_EVENTS);
+    if(wd < 0) {
+        WRITE_ERROR("Failed to watch ", file.parent_path(), ": ", std::strerror(errno));
+        RETURN_ERROR(std::error_code(errno, std::generic_category()));
+    }
+
+    m_directories[wd] = file.parent_path();
+    m_watched[file] = wd;
+#endif
+
+    WRITE_DEBUG("Watching ", file, " for changes.");
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Stops watching a file for changes.
+ *
+ * @param path The file to stop watching
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_VALUE_NOT_FOUND if the file was
+ *         not being watched.
+ */
+auto HMDT::FileWatcher::unwatch(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
+{
+    std::filesystem::path file;
+    try {
+        file = normalize(path);
+    } catch(const std::filesystem::filesystem_error& e) {
+        RETURN_ERROR(e.code());
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_watched.find(file);
+    RETURN_ERROR_IF(it == m_watched.end(), STATUS_VALUE_NOT_FOUND);
+
+    [[maybe_unused]] int wd = it->second;
+    m_watched.erase(it);
+    m_pending.erase(file);
+
+#ifdef _WIN32
+    m_write_times.erase(file);
+#else
+    // Only stop watching the directory once nothing else in it is watched
+    bool directory_in_use = false;
+    for(auto&& [other, other_wd] : m_watched) {
+        if(other_wd == wd) {
+            directory_in_use = true;
+            break;
+        }
+    }
+
+    if(!directory_in_use) {
+        inotify_rm_watch(m_fd, wd);
+        m_directories.erase(wd);
+    }
+#endif
+
+    return STATUS_SUCCESS;
+}
+
+bool HMDT::FileWatcher::isWatching(const std::filesystem::path& path) const noexcept
+{
+    try {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_watched.count(normalize(path)) != 0;
+    } catch(const std::filesystem::filesystem_error&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Waits for changes, and gets every file which has stopped changing.
+ * @details A file is only reported once it has gone unchanged for the whole
+ *          debounce time, so that a single save which writes the file in
+ *          several steps is only reported once.
+ *
+ * @param timeout How long to wait for new changes
+ *
+ * @return Every file which changed and has since settled
+ */
+auto HMDT::FileWatcher::poll(std::chrono::milliseconds timeout) noexcept
+    -> std::vector<std::filesystem::path>
+{
+    waitForEvents(timeout);
+
+    std::vector<std::filesystem::path> changed;
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto it = m_pending.begin(); it != m_pending.end();) {
+        if(now - it->second >= m_debounce) {
+            changed.push_back(it->first);
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return changed;
+}
+
+/**
+ * @brief Starts reporting every change to a callback from a background thread.
+ *
+ * @param callback The callback. Gets called from the background thread.
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_KEY_EXISTS if the background
+ *         thread is already running.
+ */
+auto HMDT::FileWatcher::start(const Callback& callback) noexcept -> MaybeVoid {
+    RETURN_ERROR_IF(m_running.exchange(true), STATUS_KEY_EXISTS);
+
+    // Don't wait too long between checks, so that stop() returns quickly
+    auto interval = std::min(m_debounce, std::chrono::milliseconds(100));
+
+    m_thread = std::thread([this, callback, interval]() {
+        while(m_running) {
+            for(auto&& path : poll(interval)) {
+                WRITE_DEBUG("Detected a change to ", path);
+                callback(path);
+            }
+        }
+    });
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Stops the background thread, if it is running.
+ */
+void HMDT::FileWatcher::stop() noexcept {
+    m_running = false;
+
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool HMDT::FileWatcher::isRunning() const noexcept {
+    return m_running;
+}
+
+/**
+ * @brief Normalizes a path, so that the same file is always keyed the same.
+ *
+ * @param path The path
+ *
+ * @return The absolute, normalized path
+ */
+auto HMDT::FileWatcher::normalize(const std::filesystem::path& path)
+    -> std::filesystem::path
+{
+    return std::filesystem::absolute(path).lexically_normal();
+}
+
+/**
+ * @brief Waits for files to change, and records when they did.
+ *
+ * @param timeout How long to wait for a change
+ */
+void HMDT::FileWatcher::waitForEvents(std::chrono::milliseconds timeout) noexcept
+{
+#ifdef _WIN32
+    std::this_thread::sleep_for(timeout);
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto&& [file, last_write_time] : m_write_times) {
+        std::error_code ec;
+        auto write_time = std::filesystem::last_write_time(file, ec);
+        if(!ec && write_time != last_write_time) {
+            last_write_time = write_time;
+            m_pending[file] = now;
+        }
+    }
+#else
+    if(m_fd < 0) {
+        std::this_thread::sleep_for(timeout);
+        return;
+    }
+
+    pollfd pfd{ m_fd, POLLIN, 0 };
+    if(::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) {
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ssize_t length;
+    while((length = read(m_fd, buffer, sizeof(buffer))) > 0) {
+        for(char* ptr = buffer; ptr < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if(event->len == 0) {
+                continue;
+            }
+
+            auto dir_it = m_directories.find(event->wd);
+            if(dir_it == m_directories.end()) {
+                continue;
+            }
+
+            // Events come in for everything in the directory, so skip every
+            //   file which is not actually being watched
+            auto file = dir_it->second / event->name;
+            if(m_watched.count(file) != 0) {
+                m_pending[file] = now;
+            }
+        }
+    }
+#endif
+}
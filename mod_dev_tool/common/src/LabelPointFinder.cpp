@@ -0,0 +1,259 @@
+/**
+ * @file LabelPointFinder.cpp
+ *
+ * @brief Defines functions for finding a good point inside of every province
+ *        to place labels, buildings and units at.
+ *
+ * @par The distance transform is the separable exact Euclidean transform from
+ *      "Distance Transforms of Sampled Functions" by Felzenszwalb and
+ *      Huttenlocher.
+ */
+
+#include "LabelPointFinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    /**
+     * @brief Scratch space for the distance transform of a single province,
+     *        kept around between provinces so it only has to grow.
+     */
+    struct Workspace {
+        std::vector<uint8_t> inside; //!< Whether each pixel is in the province
+        std::vector<double> column_distance; //!< Squared distance along Y
+        std::vector<uint32_t> last; //!< Last outside row seen in each column
+
+        std::vector<uint32_t> v; //!< Roots of the parabolas in the envelope
+        std::vector<double> z; //!< Where each parabola takes over
+    };
+
+    /**
+     * @brief Finds the label point of a single province.
+     * @details The province is copied into a mask covering its bounding box
+     *          plus a 1 pixel border, so that every pixel outside of the
+     *          province (including off the edge of the map) counts as an edge.
+     *
+     * @param width The width of the map
+     * @param province_matrix The province of every pixel of the map
+     * @param id The province to find the label point of
+     * @param extents The extents of the province
+     * @param ws Scratch space to use
+     *
+     * @return The position of the label point, and its squared distance from
+     *         the edge of the province
+     */
+    std::pair<HMDT::Point2D, uint64_t> findPoleOfInaccessibility(
+            uint32_t width,
+            const HMDT::ProvinceID* province_matrix,
+            const HMDT::ProvinceID& id,
+            const HMDT::ProvincePixelStats& extents,
+            Workspace& ws)
+    {
+        auto grid_w = extents.max_x - extents.min_x + 3;
+        auto grid_h = extents.max_y - extents.min_y + 3;
+        auto grid_size = static_cast<uint64_t>(grid_w) * grid_h;
+
+        ws.inside.assign(grid_size, 0);
+        for(uint32_t y = extents.min_y; y <= extents.max_y; ++y) {
+            auto* inside = &ws.inside[HMDT::xyToIndex(grid_w, 1, y - extents.min_y + 1)];
+            const auto* matrix_row = &province_matrix[HMDT::xyToIndex(width, extents.min_x, y)];
+
+            for(uint32_t x = 0; x <= extents.max_x - extents.min_x; ++x) {
+                inside[x] = (matrix_row[x] == id);
+            }
+        }
+
+        // Pass 1: Squared distance to the closest outside pixel in the same
+        //   column. The border guarantees one exists both above and below.
+        ws.column_distance.resize(grid_size);
+        ws.last.assign(grid_w, 0);
+        for(uint32_t y = 0; y < grid_h; ++y) {
+            auto row = HMDT::xyToIndex(grid_w, 0, y);
+            for(uint32_t x = 0; x < grid_w; ++x) {
+                if(!ws.inside[row + x]) ws.last[x] = y;
+
+                double dy = y - ws.last[x];
+                ws.column_distance[row + x] = dy * dy;
+            }
+        }
+
+        ws.last.assign(grid_w, grid_h - 1);
+        for(uint32_t y = grid_h; y-- > 0; ) {
+            auto row = HMDT::xyToIndex(grid_w, 0, y);
+            for(uint32_t x = 0; x < grid_w; ++x) {
+                if(!ws.inside[row + x]) ws.last[x] = y;
+
+                double dy = ws.last[x] - y;
+                ws.column_distance[row + x] = std::min(ws.column_distance[row + x],
+                                                       dy * dy);
+            }
+        }
+
+        // Pass 2: For every row, the lower envelope of the parabolas rooted at
+        //   each column gives the squared distance to the closest outside
+        //   pixel overall. Only the largest one is kept.
+        ws.v.resize(grid_w);
+        ws.z.resize(grid_w + 1);
+
+        auto cx = static_cast<double>(extents.sum_x) / extents.count;
+        auto cy = static_cast<double>(extents.sum_y) / extents.count;
+
+        double best_distance = -1;
+        double best_centroid_distance = 0;
+        HMDT::Point2D best{ extents.min_x, extents.min_y };
+
+        for(uint32_t y = 1; y + 1 < grid_h; ++y) {
+            auto row = HMDT::xyToIndex(grid_w, 0, y);
+            const double* g = &ws.column_distance[row];
+
+            uint32_t k = 0;
+            ws.v[0] = 0;
+            ws.z[0] = -std::numeric_limits<double>::infinity();
+            ws.z[1] = std::numeric_limits<double>::infinity();
+
+            auto intersection = [&ws, g](uint32_t q, uint32_t k) {
+                auto r = ws.v[k];
+                return ((g[q] + static_cast<double>(q) * q) -
+                        (g[r] + static_cast<double>(r) * r)) /
+                       (2.0 * q - 2.0 * r);
+            };
+
+            for(uint32_t q = 1; q < grid_w; ++q) {
+                auto s = intersection(q, k);
+                while(s <= ws.z[k]) {
+                    --k;
+                    s = intersection(q, k);
+                }
+
+                ++k;
+                ws.v[k] = q;
+                ws.z[k] = s;
+                ws.z[k + 1] = std::numeric_limits<double>::infinity();
+            }
+
+            k = 0;
+            for(uint32_t q = 1; q + 1 < grid_w; ++q) {
+                while(ws.z[k + 1] < q) ++k;
+
+                if(!ws.inside[row + q]) continue;
+
+                double dx = static_cast<double>(q) - ws.v[k];
+                auto distance = dx * dx + g[ws.v[k]];
+
+                // Ties go to whichever point is closest to the centroid, so
+                //   that labels in symmetric provinces end up in the middle
+                if(distance < best_distance) continue;
+
+                auto x = extents.min_x + q - 1;
+                auto map_y = extents.min_y + y - 1;
+                auto centroid_distance = (x - cx) * (x - cx) +
+                                         (map_y - cy) * (map_y - cy);
+
+                if(distance > best_distance ||
+                   centroid_distance < best_centroid_distance)
+                {
+                    best_distance = distance;
+                    best_centroid_distance = centroid_distance;
+                    best = HMDT::Point2D{ x, map_y };
+                }
+            }
+        }
+
+        return { best, static_cast<uint64_t>(best_distance) };
+    }
+}
+
+/**
+ * @brief Finds the pole of inaccessibility of every province: the point inside
+ *        of it which is furthest from any of its edges.
+ * @details Unlike the centroid, this point is always inside of the province,
+ *          even for concave or ring-shaped provinces, and has the most room
+ *          around it for a label or a building model.
+ *
+ *          The extents of every province are found in one pass over the map.
+ *          Afterwards, each province runs an exact distance transform over
+ *          just its own bounding box, with the provinces split across all
+ *          cores. Ties are broken on the distance to the centroid, and then on
+ *          the position, so the same map always produces the same points.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param heightmap The height of every pixel of the map. May be null, in which
+ *                  case every height is 0.
+ * @param provinces Every province on the map
+ *
+ * @return The label point of every province which has at least one pixel.
+ */
+auto HMDT::findLabelPoints(const Dimensions& dimensions,
+                           const ProvinceID* province_matrix,
+                           const uint8_t* heightmap,
+                           const ProvinceList& provinces)
+    -> Maybe<LabelPointMap>
+{
+    RETURN_ERROR_IF(province_matrix == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto width = dimensions.w;
+
+    // Give every province a dense index, in a stable order
+    std::vector<ProvinceID> ids;
+    ids.reserve(provinces.size());
+    for(auto&& [id, _] : provinces) {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    auto count = static_cast<uint32_t>(ids.size());
+
+    auto index_of = indexProvinceIDs(ids);
+
+    LabelPointMap label_points;
+    if(count == 0) {
+        return label_points;
+    }
+
+    // Pass 1: Gather the bounds and centroid of every province
+    auto extents = gatherProvincePixelStats(dimensions, province_matrix, index_of);
+
+    // Pass 2: The distance transform of every province, within its own bounds
+    std::vector<LabelPoint> points(count);
+
+    parallelForEachRange(count, [&](uint64_t begin, uint64_t end) {
+        Workspace ws;
+
+        for(auto p = begin; p < end; ++p) {
+            if(extents[p].count == 0) continue;
+
+            auto [position, distance_sq] = findPoleOfInaccessibility(width,
+                                                                     province_matrix,
+                                                                     ids[p],
+                                                                     extents[p],
+                                                                     ws);
+
+            auto index = xyToIndex(width, position.x, position.y);
+
+            points[p] = LabelPoint{
+                position,
+                std::sqrt(static_cast<double>(distance_sq)),
+                static_cast<uint8_t>(heightmap == nullptr ? 0 : heightmap[index])
+            };
+        }
+    });
+
+    for(uint32_t p = 0; p < count; ++p) {
+        if(extents[p].count != 0) {
+            label_points.emplace(ids[p], points[p]);
+        }
+    }
+
+    WRITE_DEBUG("Found label points for ", label_points.size(), " provinces.");
+
+    return label_points;
+}
+
@@ -1,7 +1,34 @@
 #include "MapData.h"
 
+#include <memory>
+
 #include "Util.h"
 
+namespace {
+    /**
+     * @brief Allocates an array of empty UUIDs.
+     * @details new UUID[count] would default-construct, and therefore
+     *          generate, a brand new UUID for every element. Generating one is
+     *          far slower than copying one, which adds up to most of the time
+     *          taken to construct a MapData for a large map.
+     *
+     * @param count How many UUIDs to allocate
+     *
+     * @return The array of UUIDs
+     */
+    std::shared_ptr<HMDT::UUID[]> makeEmptyUUIDArray(std::size_t count) {
+        std::allocator<HMDT::UUID> allocator;
+
+        auto* uuids = allocator.allocate(count);
+        std::uninitialized_fill_n(uuids, count, HMDT::EMPTY_UUID);
+
+        return std::shared_ptr<HMDT::UUID[]>(uuids, [count](HMDT::UUID* uuids) {
+            std::destroy_n(uuids, count);
+            std::allocator<HMDT::UUID>().deallocate(uuids, count);
+        });
+    }
+}
+
 HMDT::MapData::MapData():
     m_width(0),
     m_height(0),
@@ -12,7 +39,9 @@ HMDT::MapData::MapData():
     m_label_matrix(nullptr),
     m_state_id_matrix(nullptr),
     m_heightmap(nullptr),
+    m_normal_map(nullptr),
     m_rivers(nullptr),
+    m_terrain(nullptr),
     m_closed(false),
     m_state_id_matrix_updated_tag(0)
 {
@@ -22,14 +51,16 @@ HMDT::MapData::MapData(uint32_t width, uint32_t height):
     m_width(width),
     m_height(height),
     m_input(new uint8_t[getInputSize()]{ 0 }),
-    m_provinces(new UUID[getProvincesSize()]{ EMPTY_UUID }),
+    m_provinces(makeEmptyUUIDArray(getProvincesSize())),
     m_province_colors(new uint8_t[getProvinceColorsSize()]{ 0 }),
     m_province_outlines(new uint8_t[getProvinceOutlinesSize()]{ 0 }),
     m_cities(new uint8_t[getCitiesSize()]{ 0 }),
     m_label_matrix(new uint32_t[getMatrixSize()]{ 0 }),
     m_state_id_matrix(new uint32_t[getMatrixSize()]{ 0 }),
     m_heightmap(new uint8_t[getHeightMapSize()]{ 0 }),
+    m_normal_map(new uint8_t[getNormalMapSize()]{ 0 }),
     m_rivers(new uint8_t[getRiversSize()]{ 0 }),
+    m_terrain(new uint8_t[getTerrainSize()]{ 0 }),
     m_closed(false),
     m_state_id_matrix_updated_tag(0)
 {
@@ -46,7 +77,9 @@ HMDT::MapData::MapData(const MapData* other):
     m_label_matrix(other->m_label_matrix),
     m_state_id_matrix(other->m_state_id_matrix),
     m_heightmap(other->m_heightmap),
+    m_normal_map(other->m_normal_map),
     m_rivers(other->m_rivers),
+    m_terrain(other->m_terrain),
     m_closed(other->m_closed),
     m_state_id_matrix_updated_tag(other->m_state_id_matrix_updated_tag)
 {
@@ -81,7 +114,8 @@ uint32_t HMDT::MapData::getProvinceColorsSize() const {
 }
 
 uint32_t HMDT::MapData::getProvinceOutlinesSize() const {
-    return m_width * m_height * 4;
+    // One byte of OUTLINE_* flags per pixel
+    return m_width * m_height;
 }
 
 uint32_t HMDT::MapData::getCitiesSize() const {
@@ -96,10 +130,19 @@ uint32_t HMDT::MapData::getHeightMapSize() const {
     return m_width * m_height;
 }
 
+uint32_t HMDT::MapData::getNormalMapSize() const {
+    return m_width * m_height * 3;
+}
+
 uint32_t HMDT::MapData::getRiversSize() const {
     return m_width * m_height;
 }
 
+uint32_t HMDT::MapData::getTerrainSize() const {
+    // One palette index per pixel
+    return m_width * m_height;
+}
+
 bool HMDT::MapData::isClosed() const {
     return m_closed;
 }
@@ -184,6 +227,14 @@ uint32_t HMDT::MapData::getStateIDMatrixUpdatedTag() const {
     return m_state_id_matrix_updated_tag;
 }
 
+/**
+ * @brief Marks the state ID matrix (and the state borders in the province
+ *        outlines) as changed, for when they were written to in place.
+ */
+void HMDT::MapData::markStateIDMatrixUpdated() {
+    ++m_state_id_matrix_updated_tag;
+}
+
 HMDT::MapData::MapType HMDT::MapData::getHeightMap() {
     return m_heightmap;
 }
@@ -192,6 +243,14 @@ HMDT::MapData::ConstMapType HMDT::MapData::getHeightMap() const {
     return m_heightmap;
 }
 
+HMDT::MapData::MapType HMDT::MapData::getNormalMap() {
+    return m_normal_map;
+}
+
+HMDT::MapData::ConstMapType HMDT::MapData::getNormalMap() const {
+    return m_normal_map;
+}
+
 HMDT::MapData::MapType HMDT::MapData::getRivers() {
     return m_rivers;
 }
@@ -200,3 +259,11 @@ HMDT::MapData::ConstMapType HMDT::MapData::getRivers() const {
     return m_rivers;
 }
 
+HMDT::MapData::MapType HMDT::MapData::getTerrain() {
+    return m_terrain;
+}
+
+HMDT::MapData::ConstMapType HMDT::MapData::getTerrain() const {
+    return m_terrain;
+}
+
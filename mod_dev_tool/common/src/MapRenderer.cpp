@@ -0,0 +1,196 @@
+/**
+ * @file MapRenderer.cpp
+ *
+ * @brief Defines functions for rendering the map into an image without a GUI.
+ */
+
+#include "MapRenderer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! The color of pixels whose province has no color
+    const HMDT::Color MISSING_COLOR = HMDT::Color{ 0, 0, 0 };
+
+    /**
+     * @brief Blends two colors halfway.
+     */
+    HMDT::Color blend(const HMDT::Color& a, const HMDT::Color& b) {
+        return HMDT::Color{
+            static_cast<uint8_t>((a.r + b.r) / 2),
+            static_cast<uint8_t>((a.g + b.g) / 2),
+            static_cast<uint8_t>((a.b + b.b) / 2)
+        };
+    }
+}
+
+/**
+ * @brief Renders the map into an RGB image.
+ * @details Every pixel of the image is given the color of the map pixel under
+ *          its center, so the image may be scaled by any factor. Borders are
+ *          worked out from the map pixel's neighbors rather than from the
+ *          outlines stored in MapData, so they are correct even if the states
+ *          were changed since the outlines were last calculated.
+ *
+ * @param layers The layers of the map to render
+ * @param province_colors The color of every province. Provinces which are not
+ *                        in here are drawn black.
+ * @param options How to render the map. Borders which are not set are not
+ *                drawn.
+ *
+ * @return The rendered image, STATUS_PARAM_CANNOT_BE_NULL if there is no
+ *         province matrix, or STATUS_INVALID_VALUE if the scale is not
+ *         positive.
+ */
+auto HMDT::renderMap(const MapRenderLayers& layers,
+                     const std::unordered_map<ProvinceID, Color>& province_colors,
+                     const MapRenderOptions& options) noexcept
+    -> Maybe<RenderedMap>
+{
+    RETURN_ERROR_IF(layers.provinces == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF(!(options.scale > 0), STATUS_INVALID_VALUE);
+
+    const auto& dimensions = layers.dimensions;
+
+    auto draw_province_borders = options.draw_province_borders.value_or(false);
+    auto draw_state_borders = options.draw_state_borders.value_or(false) &&
+                              layers.state_ids != nullptr;
+
+    if(options.draw_state_borders.value_or(false) && layers.state_ids == nullptr)
+    {
+        WRITE_WARN("State borders were requested, but there is no state ID matrix. They will not be drawn.");
+    }
+
+    auto scaled = [&](uint32_t size) -> uint32_t {
+        return std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(size * options.scale)));
+    };
+
+    RenderedMap image;
+    image.width = scaled(dimensions.w);
+    image.height = scaled(dimensions.h);
+    image.pixels.resize(static_cast<uint64_t>(image.width) * image.height * 3, 0);
+
+    if(dimensions.w == 0 || dimensions.h == 0) {
+        return image;
+    }
+
+    // Which map column every image column samples
+    std::vector<uint32_t> source_xs(image.width);
+    for(uint32_t x = 0; x < image.width; ++x) {
+        source_xs[x] = std::min<uint32_t>(dimensions.w - 1,
+                                          static_cast<uint32_t>((x + 0.5) * dimensions.w / image.width));
+    }
+
+    // The color of every province, and whether it is selected
+    auto lookup = [&](const ProvinceID& id) {
+        auto it = province_colors.find(id);
+        return std::make_pair((it == province_colors.end()) ? MISSING_COLOR : it->second,
+                              options.selection.count(id) != 0);
+    };
+
+    auto result = tryParallelForEachRange(image.height, [&](uint64_t begin, uint64_t end) {
+        CachedProvinceLookup cached(lookup);
+
+        for(auto y = begin; y < end; ++y) {
+            auto source_y = std::min<uint32_t>(dimensions.h - 1,
+                                               static_cast<uint32_t>((y + 0.5) * dimensions.h / image.height));
+
+            for(uint32_t x = 0; x < image.width; ++x) {
+                auto source_x = source_xs[x];
+                auto index = xyToIndex(dimensions.w, source_x, source_y);
+
+                auto [province_color, selected] = cached(layers.provinces[index]);
+
+                Color color = province_color;
+                if(layers.heightmap != nullptr) {
+                    auto height = layers.heightmap[index];
+                    color = Color{ height, height, height };
+                }
+
+                if(selected) {
+                    color = blend(color, options.selection_color);
+                }
+
+                if((draw_province_borders &&
+                    calculateEdgeFlags(dimensions, layers.provinces, source_x, source_y) != 0) ||
+                   (draw_state_borders &&
+                    calculateEdgeFlags(dimensions, layers.state_ids, source_x, source_y) != 0))
+                {
+                    color = options.border_color;
+                }
+
+                auto* pixel = &image.pixels[xyToIndex(image.width * 3, x * 3, y)];
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+            }
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    return image;
+}
+
+/**
+ * @brief Gets the map mode with the given name.
+ *
+ * @param name The name of the map mode, in any case
+ *
+ * @return The map mode, or std::nullopt if there is no map mode with that name.
+ */
+auto HMDT::mapModeFromString(const std::string& name) noexcept
+    -> std::optional<MapMode>
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    for(auto mode : { MapMode::PROVINCES, MapMode::STATES, MapMode::CONTINENTS,
+                      MapMode::TERRAIN, MapMode::COASTAL, MapMode::HEIGHTMAP })
+    {
+        std::stringstream ss;
+        ss << mode;
+
+        if(ss.str() == lower) {
+            return mode;
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Outputs the given map mode into a stream
+ *
+ * @param stream The stream to output into
+ * @param mode The map mode to output
+ *
+ * @return The given stream after output.
+ */
+std::ostream& HMDT::operator<<(std::ostream& stream, const MapMode& mode) {
+    switch(mode) {
+        case MapMode::PROVINCES:
+            return stream << "provinces";
+        case MapMode::STATES:
+            return stream << "states";
+        case MapMode::CONTINENTS:
+            return stream << "continents";
+        case MapMode::TERRAIN:
+            return stream << "terrain";
+        case MapMode::COASTAL:
+            return stream << "coastal";
+        case MapMode::HEIGHTMAP:
+            return stream << "heightmap";
+    }
+
+    return stream;
+}
+
@@ -0,0 +1,642 @@
+/**
+ * @file ModReader.cpp
+ *
+ * @brief Defines readers for the map and state files of an existing mod (or
+ *        of the base game), so that they can be imported into a project.
+ */
+
+#include "ModReader.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <set>
+#include <system_error>
+#include <unordered_map>
+
+#include "Logger.h"
+
+#include "Constants.h"
+#include "RecordParser.h"
+#include "ScriptTokenizer.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! The UTF-8 byte order mark which files written by some editors start with
+    constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+
+    //! Marks a pixel whose color is not one of the known colors
+    constexpr uint32_t UNKNOWN_PROVINCE = std::numeric_limits<uint32_t>::max();
+
+    std::string_view skipBOM(std::string_view buffer) noexcept {
+        if(buffer.substr(0, UTF8_BOM.size()) == UTF8_BOM) {
+            buffer.remove_prefix(UTF8_BOM.size());
+        }
+
+        return buffer;
+    }
+
+    /**
+     * @brief Reads an operator, which must be '='
+     */
+    HMDT::MaybeVoid expectAssignment(HMDT::ScriptTokenizer& tokenizer) noexcept
+    {
+        auto token = tokenizer.next();
+        if(token.type != HMDT::ScriptTokenType::OPERATOR || token.text != "=") {
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected '=', but found '", token.text, "'.");
+            RETURN_ERROR(HMDT::STATUS_UNEXPECTED_TOKEN);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Reads a '{' which opens a block
+     */
+    HMDT::MaybeVoid expectOpenBrace(HMDT::ScriptTokenizer& tokenizer) noexcept {
+        auto token = tokenizer.next();
+        if(token.type != HMDT::ScriptTokenType::OPEN_BRACE) {
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected '{', but found '", token.text, "'.");
+            RETURN_ERROR(HMDT::STATUS_UNEXPECTED_TOKEN);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Reads the key of the next statement in a block
+     *
+     * @param tokenizer The tokenizer to read from
+     * @param in_block Whether the statement is inside of a block, in which case
+     *                 a '}' ends the block. Otherwise the end of the file does.
+     *
+     * @return The key, or std::nullopt if the block or file has ended
+     */
+    HMDT::Maybe<std::optional<std::string_view>> nextKey(HMDT::ScriptTokenizer& tokenizer,
+                                                         bool in_block) noexcept
+    {
+        auto token = tokenizer.next();
+
+        switch(token.type) {
+            case HMDT::ScriptTokenType::WORD:
+            case HMDT::ScriptTokenType::STRING:
+                return std::optional<std::string_view>{ token.text };
+            case HMDT::ScriptTokenType::CLOSE_BRACE:
+                if(in_block) {
+                    return std::optional<std::string_view>{};
+                }
+                break;
+            case HMDT::ScriptTokenType::END_OF_FILE:
+                if(!in_block) {
+                    return std::optional<std::string_view>{};
+                }
+
+                WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                            ": expected '}', but the script ended.");
+                RETURN_ERROR(HMDT::STATUS_UNEXPECTED_END_OF_SCRIPT);
+            case HMDT::ScriptTokenType::INVALID:
+                WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                            ": string is never closed.");
+                RETURN_ERROR(HMDT::STATUS_UNTERMINATED_STRING);
+            default:
+                break;
+        }
+
+        WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                    ": expected a key, but found '", token.text, "'.");
+        RETURN_ERROR(HMDT::STATUS_UNEXPECTED_TOKEN);
+    }
+
+    /**
+     * @brief Reads a single value (a word or a string) and decodes it
+     *
+     * @tparam T The type of value to decode
+     * @param tokenizer The tokenizer to read from
+     * @param result Where to place the decoded value
+     *
+     * @return STATUS_SUCCESS on success, or an error code if the value is
+     *         missing or is not a valid T.
+     */
+    template<typename T>
+    HMDT::MaybeVoid parseScalar(HMDT::ScriptTokenizer& tokenizer, T& result) noexcept
+    {
+        auto token = tokenizer.next();
+        if(token.type != HMDT::ScriptTokenType::WORD &&
+           token.type != HMDT::ScriptTokenType::STRING)
+        {
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected ", HMDT::describeFieldType<T>(),
+                        ", but found '", token.text, "'.");
+            RETURN_ERROR(HMDT::STATUS_UNEXPECTED_TOKEN);
+        }
+
+        bool decoded;
+        if constexpr(std::is_same_v<T, bool>) {
+            // Scripts write booleans as yes/no rather than true/false
+            decoded = true;
+            if(token.text == "yes") {
+                result = true;
+            } else if(token.text == "no") {
+                result = false;
+            } else {
+                decoded = HMDT::decodeField(token.text, result);
+            }
+        } else {
+            decoded = HMDT::decodeField(token.text, result);
+        }
+
+        if(!decoded) {
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected ", HMDT::describeFieldType<T>(),
+                        ", but found '", token.text, "'.");
+            RETURN_ERROR(HMDT::STATUS_INVALID_FIELD);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Parses the inside of a 'state = { ... }' block
+     */
+    HMDT::MaybeVoid parseStateBlock(HMDT::ScriptTokenizer& tokenizer,
+                                    HMDT::StateDefinition& state) noexcept
+    {
+        while(true) {
+            auto key = nextKey(tokenizer, true);
+            RETURN_IF_ERROR(key);
+
+            if(!key->has_value()) break;
+
+            auto res = expectAssignment(tokenizer);
+            RETURN_IF_ERROR(res);
+
+            if(**key == "id") {
+                res = parseScalar(tokenizer, state.id);
+            } else if(**key == "name") {
+                res = parseScalar(tokenizer, state.name);
+            } else if(**key == "manpower") {
+                res = parseScalar(tokenizer, state.manpower);
+            } else if(**key == "state_category") {
+                res = parseScalar(tokenizer, state.category);
+            } else if(**key == "buildings_max_level_factor") {
+                res = parseScalar(tokenizer, state.buildings_max_level_factor);
+            } else if(**key == "impassable") {
+                res = parseScalar(tokenizer, state.impassable);
+            } else if(**key == "provinces") {
+                res = expectOpenBrace(tokenizer);
+                RETURN_IF_ERROR(res);
+
+                while(tokenizer.peek().type != HMDT::ScriptTokenType::CLOSE_BRACE) {
+                    uint32_t province_id = 0;
+                    res = parseScalar(tokenizer, province_id);
+                    RETURN_IF_ERROR(res);
+
+                    try {
+                        state.provinces.push_back(province_id);
+                    } catch(const std::bad_alloc&) {
+                        RETURN_ERROR(HMDT::STATUS_BADALLOC);
+                    }
+                }
+
+                // Consume the closing brace
+                tokenizer.next();
+            } else {
+                // Everything else (history, resources, ...) is not imported
+                res = tokenizer.skipValue();
+            }
+
+            RETURN_IF_ERROR(res);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+}
+
+/**
+ * @brief Parses the contents of a definition.csv file.
+ * @details Each line is in the format
+ *          ID;R;G;B;TYPE;COASTAL;TERRAIN;CONTINENT. The line for province 0,
+ *          which HoI4 requires but which is not a real province, is skipped.
+ *
+ * @param contents The contents of the file
+ *
+ * @return Every province defined in the file, or an error code if any line is
+ *         malformed.
+ */
+auto HMDT::parseProvinceDefinitions(std::string_view contents) noexcept
+    -> Maybe<std::vector<ProvinceDefinition>>
+{
+    std::vector<ProvinceDefinition> definitions;
+
+    RecordParser parser(skipBOM(contents), ';');
+    while(parser.nextRecord()) {
+        ProvinceDefinition definition{ 0, Color{ 0, 0, 0 }, ProvinceType::UNKNOWN,
+                                       false, "", 0 };
+
+        auto res = parser.parseFields(definition.id,
+                                      definition.color.r,
+                                      definition.color.g,
+                                      definition.color.b,
+                                      definition.type,
+                                      definition.coastal,
+                                      definition.terrain);
+        if(IS_SUCCESS(res)) {
+            res = parser.parseOptionalField(definition.continent);
+        }
+
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to parse line #", parser.getLineNumber(),
+                        ": '", parser.getRecord(), "'");
+            RETURN_IF_ERROR(res);
+        }
+
+        if(definition.id == 0) continue;
+
+        try {
+            definitions.push_back(std::move(definition));
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(STATUS_BADALLOC);
+        }
+    }
+
+    return definitions;
+}
+
+/**
+ * @brief Parses the contents of a continent.txt file, which is in the form
+ *        'continents = { europe north_america ... }'
+ *
+ * @param contents The contents of the file
+ *
+ * @return The name of every continent, in the order they are listed, or an
+ *         error code if the file is malformed.
+ */
+auto HMDT::parseContinents(std::string_view contents) noexcept
+    -> Maybe<std::vector<std::string>>
+{
+    std::vector<std::string> continents;
+
+    ScriptTokenizer tokenizer(contents);
+    while(true) {
+        auto key = nextKey(tokenizer, false);
+        RETURN_IF_ERROR(key);
+
+        if(!key->has_value()) break;
+
+        auto res = expectAssignment(tokenizer);
+        RETURN_IF_ERROR(res);
+
+        if(**key != "continents") {
+            res = tokenizer.skipValue();
+            RETURN_IF_ERROR(res);
+            continue;
+        }
+
+        res = expectOpenBrace(tokenizer);
+        RETURN_IF_ERROR(res);
+
+        while(tokenizer.peek().type != ScriptTokenType::CLOSE_BRACE) {
+            std::string continent;
+            res = parseScalar(tokenizer, continent);
+            RETURN_IF_ERROR(res);
+
+            try {
+                continents.push_back(std::move(continent));
+            } catch(const std::bad_alloc&) {
+                RETURN_ERROR(STATUS_BADALLOC);
+            }
+        }
+
+        // Consume the closing brace
+        tokenizer.next();
+    }
+
+    return continents;
+}
+
+/**
+ * @brief Parses the contents of a single history/states file.
+ * @details Only the fields which a project stores for a state are read. Every
+ *          other block (such as history or resources) is skipped over.
+ *
+ * @param contents The contents of the file
+ *
+ * @return The state defined in the file, STATUS_VALUE_NOT_FOUND if the file
+ *         does not define a state, or an error code if it is malformed.
+ */
+auto HMDT::parseStateDefinition(std::string_view contents) noexcept
+    -> Maybe<StateDefinition>
+{
+    StateDefinition state{ 0, "", 0, "", DEFAULT_BUILDINGS_MAX_LEVEL_FACTOR,
+                           false, { } };
+    bool found_state = false;
+
+    ScriptTokenizer tokenizer(contents);
+    while(true) {
+        auto key = nextKey(tokenizer, false);
+        RETURN_IF_ERROR(key);
+
+        if(!key->has_value()) break;
+
+        auto res = expectAssignment(tokenizer);
+        RETURN_IF_ERROR(res);
+
+        if(**key == "state" && !found_state) {
+            res = expectOpenBrace(tokenizer);
+            RETURN_IF_ERROR(res);
+
+            res = parseStateBlock(tokenizer, state);
+            RETURN_IF_ERROR(res);
+
+            found_state = true;
+        } else {
+            res = tokenizer.skipValue();
+            RETURN_IF_ERROR(res);
+        }
+    }
+
+    RETURN_ERROR_IF(!found_state, STATUS_VALUE_NOT_FOUND);
+
+    return state;
+}
+
+/**
+ * @brief Reads every state file in a history/states directory. The files are
+ *        read and parsed in parallel.
+ *
+ * @param root The directory to read the state files from
+ *
+ * @return Every state, sorted by ID, or the error of the first file (in path
+ *         order) which could not be read.
+ */
+auto HMDT::readStateDefinitions(const std::filesystem::path& root) noexcept
+    -> Maybe<std::vector<StateDefinition>>
+{
+    std::vector<std::filesystem::path> paths;
+
+    try {
+        std::error_code ec;
+        for(auto it = std::filesystem::directory_iterator(root, ec);
+                it != std::filesystem::directory_iterator();
+                it.increment(ec))
+        {
+            RETURN_ERROR_IF(ec.value() != 0, ec);
+
+            if(it->is_regular_file() && it->path().extension() == ".txt") {
+                paths.push_back(it->path());
+            }
+        }
+        RETURN_ERROR_IF(ec.value() != 0, ec);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Sort the paths so that errors are always reported for the same file
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::optional<StateDefinition>> states(paths.size());
+    std::vector<std::error_code> errors(paths.size());
+
+    auto read_result = tryParallelForEachRange(paths.size(), [&](uint64_t begin, uint64_t end) {
+        for(auto i = begin; i < end; ++i) {
+            auto contents = readFileToString(paths[i]);
+            if(IS_FAILURE(contents)) {
+                errors[i] = contents.error();
+                continue;
+            }
+
+            auto state = parseStateDefinition(*contents);
+            if(IS_FAILURE(state)) {
+                WRITE_ERROR("Failed to parse state file ", paths[i]);
+                errors[i] = state.error();
+                continue;
+            }
+
+            states[i] = std::move(*state);
+        }
+    });
+    RETURN_IF_ERROR(read_result);
+
+    std::vector<StateDefinition> result;
+    result.reserve(paths.size());
+    for(std::size_t i = 0; i < paths.size(); ++i) {
+        RETURN_ERROR_IF(errors[i].value() != 0, errors[i]);
+
+        result.push_back(std::move(*states[i]));
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const StateDefinition& s1, const StateDefinition& s2) {
+                  return s1.id < s2.id;
+              });
+
+    return result;
+}
+
+/**
+ * @brief Finds which province every pixel of a province map belongs to.
+ * @details This is done in two parallel passes over the map. The first maps
+ *          every pixel's color to a province index, and the second finds every
+ *          province's bounding box, size, and neighbors. Colors which are not
+ *          known are given indices after the known ones, in sorted order, so
+ *          the result never depends on how the work was split up.
+ *
+ * @param data The province map, as 3 bytes of RGB per pixel, top row first
+ * @param dimensions The dimensions of the map
+ * @param known_colors The color of every known province
+ *
+ * @return The index of the map, or STATUS_BADALLOC if there was not enough
+ *         memory to build it.
+ */
+auto HMDT::indexProvinceMap(const unsigned char* data,
+                            const Dimensions& dimensions,
+                            const std::vector<Color>& known_colors) noexcept
+    -> Maybe<ProvinceMapIndex>
+{
+    const uint32_t width = dimensions.w;
+    const uint32_t height = dimensions.h;
+    const uint64_t size = static_cast<uint64_t>(width) * height;
+
+    auto readRGB = [data](uint64_t i) -> uint32_t {
+        return (static_cast<uint32_t>(data[i * 3]) << 16) |
+               (static_cast<uint32_t>(data[i * 3 + 1]) << 8) |
+               static_cast<uint32_t>(data[i * 3 + 2]);
+    };
+
+    ProvinceMapIndex index;
+    std::unordered_map<uint32_t, uint32_t> color_indices;
+    std::set<uint32_t> unknown_rgbs;
+    std::mutex mutex;
+
+    try {
+        index.pixel_provinces.resize(size);
+
+        color_indices.reserve(known_colors.size());
+        for(uint32_t i = 0; i < known_colors.size(); ++i) {
+            auto [_, inserted] = color_indices.emplace(colorToRGB(known_colors[i]), i);
+            if(!inserted) {
+                WRITE_WARN("Color ", known_colors[i], " is used by more than "
+                           "one province. Only the first will be used.");
+            }
+        }
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // First pass: map every pixel to a known province. Neighboring pixels are
+    //   usually the same color, so remember the last lookup to skip most of
+    //   the hashing.
+    auto result = tryParallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        std::set<uint32_t> local_unknown_rgbs;
+
+        // Start with a value that no 24-bit color can ever be
+        uint32_t last_rgb = UNKNOWN_PROVINCE;
+        uint32_t last_index = UNKNOWN_PROVINCE;
+
+        for(auto i = begin; i < end; ++i) {
+            auto rgb = readRGB(i);
+            if(rgb != last_rgb) {
+                last_rgb = rgb;
+
+                if(auto it = color_indices.find(rgb); it != color_indices.end()) {
+                    last_index = it->second;
+                } else {
+                    last_index = UNKNOWN_PROVINCE;
+                    local_unknown_rgbs.insert(rgb);
+                }
+            }
+
+            index.pixel_provinces[i] = last_index;
+        }
+
+        std::lock_guard lock(mutex);
+        unknown_rgbs.insert(local_unknown_rgbs.begin(),
+                            local_unknown_rgbs.end());
+    });
+    RETURN_IF_ERROR(result);
+
+    const uint32_t province_count = known_colors.size() + unknown_rgbs.size();
+
+    // Give every unknown color an index after the known ones, and then fill
+    //   those indices in
+    if(!unknown_rgbs.empty()) {
+        try {
+            index.unknown_colors.reserve(unknown_rgbs.size());
+            for(auto rgb : unknown_rgbs) {
+                color_indices.emplace(rgb, known_colors.size() + index.unknown_colors.size());
+                index.unknown_colors.push_back(RGBToColor(rgb));
+            }
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(STATUS_BADALLOC);
+        }
+
+        result = tryParallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+            for(auto i = begin; i < end; ++i) {
+                if(index.pixel_provinces[i] == UNKNOWN_PROVINCE) {
+                    index.pixel_provinces[i] = color_indices.at(readRGB(i));
+                }
+            }
+        });
+        RETURN_IF_ERROR(result);
+    }
+
+    // Second pass: find the bounding box, size, and neighbors of every
+    //   province
+    constexpr BoundingBox EMPTY_BOX{
+        { std::numeric_limits<uint32_t>::max(), 0 },
+        { 0, std::numeric_limits<uint32_t>::max() }
+    };
+
+    try {
+        index.bounding_boxes.assign(province_count, EMPTY_BOX);
+        index.pixel_counts.assign(province_count, 0);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    result = tryParallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        std::vector<BoundingBox> bounding_boxes(province_count, EMPTY_BOX);
+        std::vector<uint64_t> pixel_counts(province_count, 0);
+        std::vector<std::pair<uint32_t, uint32_t>> adjacencies;
+
+        auto addAdjacency = [&adjacencies](uint32_t p1, uint32_t p2) {
+            std::pair<uint32_t, uint32_t> pair = std::minmax(p1, p2);
+
+            // Borders are mostly long runs of the same two provinces
+            if(adjacencies.empty() || adjacencies.back() != pair) {
+                adjacencies.push_back(pair);
+            }
+        };
+
+        for(auto i = begin; i < end; ++i) {
+            uint32_t x = i % width;
+            uint32_t y = i / width;
+            auto province = index.pixel_provinces[i];
+
+            auto& bounding_box = bounding_boxes[province];
+            bounding_box.bottom_left.x = std::min(bounding_box.bottom_left.x, x);
+            bounding_box.bottom_left.y = std::max(bounding_box.bottom_left.y, y);
+            bounding_box.top_right.x = std::max(bounding_box.top_right.x, x);
+            bounding_box.top_right.y = std::min(bounding_box.top_right.y, y);
+
+            ++pixel_counts[province];
+
+            if(x + 1 < width) {
+                if(auto right = index.pixel_provinces[i + 1]; right != province) {
+                    addAdjacency(province, right);
+                }
+            }
+
+            if(y + 1 < height) {
+                if(auto below = index.pixel_provinces[i + width]; below != province) {
+                    addAdjacency(province, below);
+                }
+            }
+        }
+
+        std::sort(adjacencies.begin(), adjacencies.end());
+        adjacencies.erase(std::unique(adjacencies.begin(), adjacencies.end()),
+                          adjacencies.end());
+
+        std::lock_guard lock(mutex);
+        for(uint32_t p = 0; p < province_count; ++p) {
+            if(pixel_counts[p] == 0) continue;
+
+            auto& bounding_box = index.bounding_boxes[p];
+            bounding_box.bottom_left.x = std::min(bounding_box.bottom_left.x,
+                                                  bounding_boxes[p].bottom_left.x);
+            bounding_box.bottom_left.y = std::max(bounding_box.bottom_left.y,
+                                                  bounding_boxes[p].bottom_left.y);
+            bounding_box.top_right.x = std::max(bounding_box.top_right.x,
+                                                bounding_boxes[p].top_right.x);
+            bounding_box.top_right.y = std::min(bounding_box.top_right.y,
+                                                bounding_boxes[p].top_right.y);
+
+            index.pixel_counts[p] += pixel_counts[p];
+        }
+
+        index.adjacencies.insert(index.adjacencies.end(),
+                                 adjacencies.begin(), adjacencies.end());
+    });
+    RETURN_IF_ERROR(result);
+
+    std::sort(index.adjacencies.begin(), index.adjacencies.end());
+    index.adjacencies.erase(std::unique(index.adjacencies.begin(),
+                                        index.adjacencies.end()),
+                            index.adjacencies.end());
+
+    // Provinces which are not in the map at all get an empty bounding box
+    for(uint32_t p = 0; p < province_count; ++p) {
+        if(index.pixel_counts[p] == 0) {
+            index.bounding_boxes[p] = BoundingBox{ { 0, 0 }, { 0, 0 } };
+        }
+    }
+
+    return index;
+}
+
@@ -0,0 +1,1194 @@
+/**
+ * @file ProjectDiff.cpp
+ *
+ * @brief Defines functions for finding what changed between two versions of
+ *        a project.
+ */
+
+#include "ProjectDiff.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "nlohmann/json.hpp"
+
+#include "BitMap.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    using PixelCounts = std::unordered_map<HMDT::ProvinceID, uint64_t>;
+
+    /**
+     * @brief Converts any streamable value into a string for a PropertyChange
+     */
+    template<typename T>
+    std::string toPropertyString(const T& value) {
+        std::stringstream ss;
+        ss << std::boolalpha << value;
+        return ss.str();
+    }
+
+    /**
+     * @brief Adds a PropertyChange to the list if the two values differ
+     */
+    template<typename T>
+    void addIfChanged(std::vector<HMDT::PropertyChange>& properties,
+                      const std::string& name,
+                      const T& old_value, const T& new_value)
+    {
+        if(old_value != new_value) {
+            properties.push_back(HMDT::PropertyChange{
+                name, toPropertyString(old_value), toPropertyString(new_value)
+            });
+        }
+    }
+
+    /**
+     * @brief Reads a layer one band of rows at a time.
+     *
+     * @param dimensions The dimensions of the layer
+     * @param reader The layer
+     * @param band_height How many rows are in each band
+     * @param visit Called as visit(band, first_row, row_count) for every band,
+     *              from top to bottom
+     *
+     * @return STATUS_SUCCESS on success, or the first error returned by either
+     *         reader or visit
+     */
+    template<typename T, typename F>
+    HMDT::MaybeVoid forEachBand(const HMDT::Dimensions& dimensions,
+                                const HMDT::LayerBandReader<T>& reader,
+                                uint32_t band_height, F&& visit)
+    {
+        std::vector<T> buffer;
+
+        for(uint32_t top = 0; top < dimensions.h; top += band_height) {
+            uint32_t row_count = std::min(band_height, dimensions.h - top);
+
+            auto band = reader(top, row_count, buffer);
+            RETURN_IF_ERROR(band);
+
+            auto result = visit(*band, top, row_count);
+            RETURN_IF_ERROR(result);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Reads both versions of a layer side by side, one band of rows at
+     *        a time.
+     * @details Only one band of each version is held at once, so no more than
+     *          two bands worth of memory is needed no matter how large the
+     *          layer is.
+     *
+     * @param dimensions The dimensions of both versions of the layer
+     * @param old_reader The old version of the layer
+     * @param new_reader The new version of the layer
+     * @param band_height How many rows are in each band
+     * @param visit Called as visit(old_band, new_band, first_row, row_count)
+     *              for every band, from top to bottom
+     *
+     * @return STATUS_SUCCESS on success, or the first error returned by either
+     *         reader or visit
+     */
+    template<typename T, typename F>
+    HMDT::MaybeVoid forEachBandPair(const HMDT::Dimensions& dimensions,
+                                    const HMDT::LayerBandReader<T>& old_reader,
+                                    const HMDT::LayerBandReader<T>& new_reader,
+                                    uint32_t band_height, F&& visit)
+    {
+        std::vector<T> old_buffer;
+        std::vector<T> new_buffer;
+
+        for(uint32_t top = 0; top < dimensions.h; top += band_height) {
+            uint32_t row_count = std::min(band_height, dimensions.h - top);
+
+            auto old_band = old_reader(top, row_count, old_buffer);
+            RETURN_IF_ERROR(old_band);
+
+            auto new_band = new_reader(top, row_count, new_buffer);
+            RETURN_IF_ERROR(new_band);
+
+            auto result = visit(*old_band, *new_band, top, row_count);
+            RETURN_IF_ERROR(result);
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Compares both versions of one band of a per-pixel layer, where
+     *        the band is a single row of tiles.
+     * @details Rows of a tile are compared in bulk first, so only rows which
+     *          actually differ get compared pixel by pixel.
+     *
+     * @param width The width of the layer
+     * @param old_band The old version of the band
+     * @param new_band The new version of the band
+     * @param top The first row of the band
+     * @param row_count How many rows are in the band
+     * @param tile_size The width and height of each tile
+     * @param diff The diff to add every changed tile of this band to
+     *
+     * @return STATUS_SUCCESS on success, or an error code on failure
+     */
+    template<typename T>
+    HMDT::MaybeVoid diffBand(uint32_t width, const T* old_band,
+                             const T* new_band, uint32_t top,
+                             uint32_t row_count, uint32_t tile_size,
+                             HMDT::LayerDiff& diff) noexcept
+    {
+        uint32_t tiles_across = (width + tile_size - 1) / tile_size;
+
+        std::vector<uint64_t> changed_in_tile;
+        try {
+            changed_in_tile.resize(tiles_across, 0);
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(HMDT::STATUS_BADALLOC);
+        }
+
+        std::mutex changed_mutex;
+
+        auto result = HMDT::tryParallelForEachRange(row_count, [&](uint64_t begin, uint64_t end) {
+            std::vector<uint64_t> local_changed(tiles_across, 0);
+
+            for(uint64_t y = begin; y < end; ++y) {
+                const T* old_row = old_band + HMDT::xyToIndex(width, 0, y);
+                const T* new_row = new_band + HMDT::xyToIndex(width, 0, y);
+
+                if(std::equal(old_row, old_row + width, new_row)) {
+                    continue;
+                }
+
+                for(uint32_t tile_x = 0; tile_x < tiles_across; ++tile_x) {
+                    uint32_t left = tile_x * tile_size;
+                    uint32_t right = std::min(left + tile_size, width);
+
+                    if(std::equal(old_row + left, old_row + right, new_row + left)) {
+                        continue;
+                    }
+
+                    for(uint32_t x = left; x < right; ++x) {
+                        if(!(old_row[x] == new_row[x])) {
+                            ++local_changed[tile_x];
+                        }
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(changed_mutex);
+            for(uint32_t tile_x = 0; tile_x < tiles_across; ++tile_x) {
+                changed_in_tile[tile_x] += local_changed[tile_x];
+            }
+        });
+        RETURN_IF_ERROR(result);
+
+        for(uint32_t tile_x = 0; tile_x < tiles_across; ++tile_x) {
+            if(changed_in_tile[tile_x] == 0) {
+                continue;
+            }
+
+            uint32_t left = tile_x * tile_size;
+            diff.changed_tiles.push_back(HMDT::Rectangle{
+                left, top, std::min(tile_size, width - left), row_count
+            });
+            diff.changed_pixel_count += changed_in_tile[tile_x];
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Compares both versions of a per-pixel layer, one tile-high band
+     *        at a time.
+     *
+     * @param dimensions The dimensions of both versions of the layer
+     * @param old_reader The old version of the layer
+     * @param new_reader The new version of the layer
+     * @param tile_size The width and height of each tile
+     *
+     * @return Every changed tile, and how many pixels changed
+     */
+    template<typename T>
+    HMDT::Maybe<HMDT::LayerDiff> diffLayer(const HMDT::Dimensions& dimensions,
+                                           const HMDT::LayerBandReader<T>& old_reader,
+                                           const HMDT::LayerBandReader<T>& new_reader,
+                                           uint32_t tile_size) noexcept
+    {
+        HMDT::LayerDiff diff;
+
+        auto result = forEachBandPair(dimensions, old_reader, new_reader, tile_size,
+            [&](const T* old_band, const T* new_band, uint32_t top,
+                uint32_t row_count)
+            {
+                return diffBand(dimensions.w, old_band, new_band, top,
+                                row_count, tile_size, diff);
+            });
+        RETURN_IF_ERROR(result);
+
+        return diff;
+    }
+
+    /**
+     * @brief How many pixels each province has, and how many of those moved
+     *        between provinces.
+     */
+    struct ProvincePixelTally {
+        PixelCounts old_counts;
+        PixelCounts new_counts;
+
+        //! How many pixels each province lost to another province
+        PixelCounts lost;
+
+        //! How many pixels each province gained from another province
+        PixelCounts gained;
+
+        /**
+         * @brief Adds every count of another tally to this one
+         */
+        void merge(const ProvincePixelTally& other) {
+            auto add_counts = [](PixelCounts& counts, const PixelCounts& other_counts) {
+                for(auto&& [id, count] : other_counts) {
+                    counts[id] += count;
+                }
+            };
+
+            add_counts(old_counts, other.old_counts);
+            add_counts(new_counts, other.new_counts);
+            add_counts(lost, other.lost);
+            add_counts(gained, other.gained);
+        }
+    };
+
+    /**
+     * @brief Counts how many pixels each province has in one band.
+     *
+     * @param width The width of the province layer
+     * @param band The province of every pixel in the band
+     * @param row_count How many rows are in the band
+     * @param counts The counts to add the band's pixels to
+     *
+     * @return STATUS_SUCCESS on success, or an error code on failure
+     */
+    HMDT::MaybeVoid countBandPixels(uint32_t width,
+                                    const HMDT::ProvinceID* band,
+                                    uint32_t row_count,
+                                    PixelCounts& counts) noexcept
+    {
+        std::mutex counts_mutex;
+
+        return HMDT::tryParallelForEachRange(row_count, [&](uint64_t begin, uint64_t end) {
+            PixelCounts local_counts;
+
+            auto find_count = [&local_counts](const HMDT::ProvinceID& id) -> uint64_t* {
+                return &local_counts[id];
+            };
+            HMDT::CachedProvinceLookup cached_count(find_count);
+
+            for(uint64_t y = begin; y < end; ++y) {
+                for(uint32_t x = 0; x < width; ++x) {
+                    ++*cached_count(band[HMDT::xyToIndex(width, x, y)]);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(counts_mutex);
+            for(auto&& [id, count] : local_counts) {
+                counts[id] += count;
+            }
+        });
+    }
+
+    /**
+     * @brief Counts the pixels of every province in one band of both versions
+     *        of the province layer, and which of them moved between provinces.
+     * @details Only the old version's pixels are counted, as the new counts
+     *          follow from the old ones and what moved.
+     *
+     * @param width The width of the province layer
+     * @param old_band The old version of the band
+     * @param new_band The new version of the band
+     * @param row_count How many rows are in the band
+     * @param tally The tally to add the band to
+     *
+     * @return STATUS_SUCCESS on success, or an error code on failure
+     */
+    HMDT::MaybeVoid tallyBandPixels(uint32_t width,
+                                    const HMDT::ProvinceID* old_band,
+                                    const HMDT::ProvinceID* new_band,
+                                    uint32_t row_count,
+                                    ProvincePixelTally& tally) noexcept
+    {
+        std::mutex tally_mutex;
+
+        return HMDT::tryParallelForEachRange(row_count, [&](uint64_t begin, uint64_t end) {
+            ProvincePixelTally local_tally;
+
+            auto find_count = [&local_tally](const HMDT::ProvinceID& id) -> uint64_t* {
+                return &local_tally.old_counts[id];
+            };
+            HMDT::CachedProvinceLookup cached_count(find_count);
+
+            for(uint64_t y = begin; y < end; ++y) {
+                const auto* old_row = old_band + HMDT::xyToIndex(width, 0, y);
+                const auto* new_row = new_band + HMDT::xyToIndex(width, 0, y);
+
+                for(uint32_t x = 0; x < width; ++x) {
+                    ++*cached_count(old_row[x]);
+                }
+
+                if(std::equal(old_row, old_row + width, new_row)) {
+                    continue;
+                }
+
+                for(uint32_t x = 0; x < width; ++x) {
+                    if(old_row[x] != new_row[x]) {
+                        ++local_tally.lost[old_row[x]];
+                        ++local_tally.gained[new_row[x]];
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(tally_mutex);
+            tally.merge(local_tally);
+        });
+    }
+
+    /**
+     * @brief Counts the pixels of every province in both versions of the
+     *        province layer, and how many of them moved between provinces.
+     * @details The province layer of both versions is streamed side by side
+     *          one tile-high band at a time, and every changed tile is added
+     *          to pixel_diff along the way.
+     *
+     * @param old_layers The old version
+     * @param new_layers The new version
+     * @param tile_size The width and height of each tile
+     * @param pixel_diff The diff to add every changed tile to
+     *
+     * @return The tally of every province's pixels
+     */
+    HMDT::Maybe<ProvincePixelTally> tallyProvincePixels(const HMDT::ProjectDiffLayers& old_layers,
+                                                        const HMDT::ProjectDiffLayers& new_layers,
+                                                        uint32_t tile_size,
+                                                        HMDT::LayerDiff& pixel_diff) noexcept
+    {
+        const auto& old_dimensions = old_layers.dimensions;
+        const auto& new_dimensions = new_layers.dimensions;
+
+        ProvincePixelTally tally;
+
+        if(old_dimensions.w != new_dimensions.w ||
+           old_dimensions.h != new_dimensions.h)
+        {
+            pixel_diff.dimensions_changed = true;
+
+            // Nothing lines up anymore, so both versions have to be counted
+            //   on their own
+            auto result = forEachBand(old_dimensions, old_layers.provinces, tile_size,
+                [&](const HMDT::ProvinceID* band, uint32_t, uint32_t row_count) {
+                    return countBandPixels(old_dimensions.w, band, row_count,
+                                           tally.old_counts);
+                });
+            RETURN_IF_ERROR(result);
+
+            result = forEachBand(new_dimensions, new_layers.provinces, tile_size,
+                [&](const HMDT::ProvinceID* band, uint32_t, uint32_t row_count) {
+                    return countBandPixels(new_dimensions.w, band, row_count,
+                                           tally.new_counts);
+                });
+            RETURN_IF_ERROR(result);
+
+            std::unordered_set<HMDT::ProvinceID> ids;
+            for(auto&& [id, _] : tally.old_counts) ids.insert(id);
+            for(auto&& [id, _] : tally.new_counts) ids.insert(id);
+
+            for(auto&& id : ids) {
+                auto old_count = tally.old_counts[id];
+                auto new_count = tally.new_counts[id];
+                if(old_count > new_count) {
+                    tally.lost[id] += old_count - new_count;
+                } else if(new_count > old_count) {
+                    tally.gained[id] += new_count - old_count;
+                }
+            }
+        } else {
+            auto result = forEachBandPair(new_dimensions, old_layers.provinces,
+                                          new_layers.provinces, tile_size,
+                [&](const HMDT::ProvinceID* old_band,
+                    const HMDT::ProvinceID* new_band,
+                    uint32_t top, uint32_t row_count) -> HMDT::MaybeVoid
+                {
+                    auto result = diffBand(new_dimensions.w, old_band, new_band,
+                                           top, row_count, tile_size,
+                                           pixel_diff);
+                    RETURN_IF_ERROR(result);
+
+                    return tallyBandPixels(new_dimensions.w, old_band,
+                                           new_band, row_count, tally);
+                });
+            RETURN_IF_ERROR(result);
+
+            // Every province keeps the pixels it didn't lose, so the new
+            //   counts follow from the old ones
+            tally.new_counts = tally.old_counts;
+            for(auto&& [id, count] : tally.lost) tally.new_counts[id] -= count;
+            for(auto&& [id, count] : tally.gained) tally.new_counts[id] += count;
+        }
+
+        return tally;
+    }
+
+    /**
+     * @brief Finds every property which changed between two versions of a
+     *        province.
+     */
+    void diffProvince(const HMDT::Province& old_province,
+                      const HMDT::Province& new_province,
+                      std::vector<HMDT::PropertyChange>& properties)
+    {
+        addIfChanged(properties, "color", old_province.unique_color,
+                                          new_province.unique_color);
+        addIfChanged(properties, "type", old_province.type, new_province.type);
+        addIfChanged(properties, "coastal", old_province.coastal,
+                                            new_province.coastal);
+        addIfChanged(properties, "terrain", old_province.terrain,
+                                            new_province.terrain);
+        addIfChanged(properties, "continent", old_province.continent,
+                                              new_province.continent);
+        addIfChanged(properties, "state", old_province.state,
+                                          new_province.state);
+        addIfChanged(properties, "parent", old_province.parent_id,
+                                           new_province.parent_id);
+    }
+
+    /**
+     * @brief Finds every province which was added, removed, reshaped or
+     *        edited.
+     */
+    std::vector<HMDT::ProvinceChange> diffProvinces(const HMDT::ProvinceList& old_list,
+                                                    const HMDT::ProvinceList& new_list,
+                                                    const ProvincePixelTally& tally)
+    {
+        const auto& [old_counts, new_counts, lost, gained] = tally;
+
+        std::set<HMDT::ProvinceID> ids;
+        for(auto&& [id, _] : old_list) ids.insert(id);
+        for(auto&& [id, _] : new_list) ids.insert(id);
+        for(auto&& [id, _] : lost) ids.insert(id);
+        for(auto&& [id, _] : gained) ids.insert(id);
+
+        std::vector<HMDT::ProvinceChange> changes;
+        for(auto&& id : ids) {
+            auto old_it = old_list.find(id);
+            auto new_it = new_list.find(id);
+
+            HMDT::ProvinceChange change;
+            change.id = id;
+
+            if(auto it = old_counts.find(id); it != old_counts.end()) {
+                change.old_pixel_count = it->second;
+            }
+            if(auto it = new_counts.find(id); it != new_counts.end()) {
+                change.new_pixel_count = it->second;
+            }
+            if(auto it = lost.find(id); it != lost.end()) {
+                change.changed_pixel_count += it->second;
+            }
+            if(auto it = gained.find(id); it != gained.end()) {
+                change.changed_pixel_count += it->second;
+            }
+
+            if(old_it != old_list.end() && new_it != new_list.end()) {
+                change.type = HMDT::ChangeType::MODIFIED;
+                diffProvince(old_it->second, new_it->second, change.properties);
+            } else if(new_it != new_list.end()) {
+                change.type = HMDT::ChangeType::ADDED;
+            } else if(old_it != old_list.end()) {
+                change.type = HMDT::ChangeType::REMOVED;
+            } else {
+                // Pixels of a province which isn't in either list, so all we
+                //   can go off of is where its pixels are
+                change.type = change.old_pixel_count == 0 ? HMDT::ChangeType::ADDED :
+                              change.new_pixel_count == 0 ? HMDT::ChangeType::REMOVED :
+                                                            HMDT::ChangeType::MODIFIED;
+            }
+
+            if(change.type == HMDT::ChangeType::MODIFIED &&
+               change.properties.empty() && change.changed_pixel_count == 0)
+            {
+                continue;
+            }
+
+            changes.push_back(std::move(change));
+        }
+
+        return changes;
+    }
+
+    /**
+     * @brief Finds every state which was added, removed or edited.
+     */
+    std::vector<HMDT::StateChange> diffStates(const HMDT::StateList& old_list,
+                                              const HMDT::StateList& new_list)
+    {
+        std::set<HMDT::StateID> ids;
+        for(auto&& [id, _] : old_list) ids.insert(id);
+        for(auto&& [id, _] : new_list) ids.insert(id);
+
+        std::vector<HMDT::StateChange> changes;
+        for(auto&& id : ids) {
+            auto old_it = old_list.find(id);
+            auto new_it = new_list.find(id);
+
+            HMDT::StateChange change{ id, HMDT::ChangeType::MODIFIED, { }, { }, { } };
+
+            std::set<HMDT::ProvinceID> old_provinces;
+            std::set<HMDT::ProvinceID> new_provinces;
+
+            if(old_it != old_list.end()) {
+                old_provinces.insert(old_it->second.provinces.begin(),
+                                     old_it->second.provinces.end());
+            }
+            if(new_it != new_list.end()) {
+                new_provinces.insert(new_it->second.provinces.begin(),
+                                     new_it->second.provinces.end());
+            }
+
+            std::set_difference(new_provinces.begin(), new_provinces.end(),
+                                old_provinces.begin(), old_provinces.end(),
+                                std::back_inserter(change.added_provinces));
+            std::set_difference(old_provinces.begin(), old_provinces.end(),
+                                new_provinces.begin(), new_provinces.end(),
+                                std::back_inserter(change.removed_provinces));
+
+            if(old_it == old_list.end()) {
+                change.type = HMDT::ChangeType::ADDED;
+            } else if(new_it == new_list.end()) {
+                change.type = HMDT::ChangeType::REMOVED;
+            } else {
+                const auto& old_state = old_it->second;
+                const auto& new_state = new_it->second;
+
+                addIfChanged(change.properties, "name", old_state.name,
+                                                        new_state.name);
+                addIfChanged(change.properties, "manpower", old_state.manpower,
+                                                            new_state.manpower);
+                addIfChanged(change.properties, "category", old_state.category,
+                                                            new_state.category);
+                addIfChanged(change.properties, "buildings_max_level_factor",
+                             old_state.buildings_max_level_factor,
+                             new_state.buildings_max_level_factor);
+                addIfChanged(change.properties, "impassable",
+                             old_state.impassable, new_state.impassable);
+                addIfChanged(change.properties, "color", old_state.color,
+                                                         new_state.color);
+
+                if(change.properties.empty() &&
+                   change.added_provinces.empty() &&
+                   change.removed_provinces.empty())
+                {
+                    continue;
+                }
+            }
+
+            changes.push_back(std::move(change));
+        }
+
+        return changes;
+    }
+
+    /**
+     * @brief Compares an optional per-pixel layer of both versions
+     */
+    HMDT::Maybe<HMDT::LayerDiff> diffOptionalLayer(const HMDT::ProjectDiffLayers& old_layers,
+                                                   const HMDT::LayerBandReader<uint8_t>& old_reader,
+                                                   const HMDT::ProjectDiffLayers& new_layers,
+                                                   const HMDT::LayerBandReader<uint8_t>& new_reader,
+                                                   uint32_t tile_size) noexcept
+    {
+        HMDT::LayerDiff diff;
+        if(!old_reader || !new_reader) {
+            return diff;
+        }
+
+        if(old_layers.dimensions.w != new_layers.dimensions.w ||
+           old_layers.dimensions.h != new_layers.dimensions.h)
+        {
+            diff.dimensions_changed = true;
+            return diff;
+        }
+
+        return diffLayer(new_layers.dimensions, old_reader, new_reader, tile_size);
+    }
+
+    /**
+     * @brief Draws every pixel which changed in one layer on top of an image.
+     * @details Only the bands which hold a changed tile get read.
+     *
+     * @param image The image to draw onto
+     * @param layer_diff The diff of the layer
+     * @param old_reader The old version of the layer
+     * @param new_reader The new version of the layer
+     * @param color The color to draw changed pixels in
+     *
+     * @return STATUS_SUCCESS on success, or an error code on failure
+     */
+    template<typename T>
+    HMDT::MaybeVoid drawLayerChanges(HMDT::RenderedMap& image,
+                                     const HMDT::LayerDiff& layer_diff,
+                                     const HMDT::LayerBandReader<T>& old_reader,
+                                     const HMDT::LayerBandReader<T>& new_reader,
+                                     const HMDT::Color& color) noexcept
+    {
+        if(!old_reader || !new_reader) {
+            return HMDT::STATUS_SUCCESS;
+        }
+
+        std::vector<T> old_buffer;
+        std::vector<T> new_buffer;
+
+        // Changed tiles are in order from top to bottom, and every tile in the
+        //   same row of tiles covers the same band of rows
+        for(auto it = layer_diff.changed_tiles.begin(); it != layer_diff.changed_tiles.end(); ) {
+            uint32_t top = it->y;
+            uint32_t row_count = it->h;
+
+            auto old_band = old_reader(top, row_count, old_buffer);
+            RETURN_IF_ERROR(old_band);
+
+            auto new_band = new_reader(top, row_count, new_buffer);
+            RETURN_IF_ERROR(new_band);
+
+            for(; it != layer_diff.changed_tiles.end() && it->y == top; ++it) {
+                for(uint32_t y = 0; y < row_count; ++y) {
+                    for(uint32_t x = it->x; x < it->x + it->w; ++x) {
+                        auto band_index = HMDT::xyToIndex(image.width, x, y);
+                        if((*old_band)[band_index] == (*new_band)[band_index]) {
+                            continue;
+                        }
+
+                        auto* pixel = &image.pixels[HMDT::xyToIndex(image.width, x, top + y) * 3];
+                        pixel[0] = std::max(pixel[0], color.r);
+                        pixel[1] = std::max(pixel[1], color.g);
+                        pixel[2] = std::max(pixel[2], color.b);
+                    }
+                }
+            }
+        }
+
+        return HMDT::STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Converts a LayerDiff to json
+     */
+    nlohmann::json toJSON(const HMDT::LayerDiff& diff) {
+        auto tiles = nlohmann::json::array();
+        for(auto&& tile : diff.changed_tiles) {
+            tiles.push_back({ { "x", tile.x }, { "y", tile.y },
+                              { "w", tile.w }, { "h", tile.h } });
+        }
+
+        return {
+            { "dimensions_changed", diff.dimensions_changed },
+            { "changed_pixel_count", diff.changed_pixel_count },
+            { "changed_tiles", tiles }
+        };
+    }
+
+    /**
+     * @brief Converts a list of PropertyChanges to json
+     */
+    nlohmann::json toJSON(const std::vector<HMDT::PropertyChange>& properties) {
+        auto json = nlohmann::json::array();
+        for(auto&& [name, old_value, new_value] : properties) {
+            json.push_back({ { "name", name },
+                             { "old", old_value },
+                             { "new", new_value } });
+        }
+
+        return json;
+    }
+
+    /**
+     * @brief Converts a list of ProvinceIDs to json
+     */
+    nlohmann::json toJSON(const std::vector<HMDT::ProvinceID>& ids) {
+        auto json = nlohmann::json::array();
+        for(auto&& id : ids) {
+            json.push_back(toPropertyString(id));
+        }
+
+        return json;
+    }
+
+    /**
+     * @brief Writes a LayerDiff as a single line of text
+     */
+    void writeLayerText(std::ostream& stream, const std::string& name,
+                        const HMDT::LayerDiff& diff)
+    {
+        if(diff.dimensions_changed) {
+            stream << name << ": dimensions changed" << std::endl;
+        } else if(!diff.empty()) {
+            stream << name << ": " << diff.changed_pixel_count
+                   << " changed pixels in " << diff.changed_tiles.size()
+                   << " tiles" << std::endl;
+        }
+    }
+
+    /**
+     * @brief Writes every PropertyChange, one per line
+     */
+    void writePropertiesText(std::ostream& stream,
+                             const std::vector<HMDT::PropertyChange>& properties,
+                             const std::string& indent)
+    {
+        for(auto&& [name, old_value, new_value] : properties) {
+            stream << indent << name << ": '" << old_value << "' -> '"
+                   << new_value << '\'' << std::endl;
+        }
+    }
+
+    /**
+     * @brief Gets the single character used to mark a change in text output
+     */
+    char getChangeMarker(HMDT::ChangeType type) {
+        switch(type) {
+            case HMDT::ChangeType::ADDED:
+                return '+';
+            case HMDT::ChangeType::REMOVED:
+                return '-';
+            case HMDT::ChangeType::MODIFIED:
+                return '~';
+        }
+
+        return '?';
+    }
+}
+
+bool HMDT::LayerDiff::empty() const noexcept {
+    return !dimensions_changed && changed_pixel_count == 0;
+}
+
+bool HMDT::ProjectDiff::empty() const noexcept {
+    return metadata.empty() && provinces.empty() && states.empty() &&
+           province_pixels.empty() && heightmap.empty() && rivers.empty();
+}
+
+/**
+ * @brief Finds everything that changed between two versions of a project's
+ *        map and history.
+ * @details Every per-pixel layer of both versions is streamed side by side
+ *          one tile-high band at a time, so no more than a band of each
+ *          version is ever held at once no matter how large the map is. The
+ *          province layer is only read once, with the pixels of every province
+ *          counted along the way.
+ *
+ * @param old_layers The old version
+ * @param new_layers The new version
+ * @param tile_size The width and height of each tile which gets compared
+ *
+ * @return Everything that changed between old_layers and new_layers. The
+ *         metadata is left empty, as that is not part of the layers.
+ */
+auto HMDT::diffProjectLayers(const ProjectDiffLayers& old_layers,
+                             const ProjectDiffLayers& new_layers,
+                             uint32_t tile_size) noexcept
+    -> Maybe<ProjectDiff>
+{
+    for(auto* layers : { &old_layers, &new_layers }) {
+        RETURN_ERROR_IF(!layers->provinces ||
+                        layers->province_list == nullptr ||
+                        layers->state_list == nullptr,
+                        STATUS_PARAM_CANNOT_BE_NULL);
+    }
+    RETURN_ERROR_IF(tile_size == 0, STATUS_INVALID_VALUE);
+
+    ProjectDiff diff;
+    diff.old_dimensions = old_layers.dimensions;
+    diff.new_dimensions = new_layers.dimensions;
+
+    auto tally = tallyProvincePixels(old_layers, new_layers, tile_size,
+                                     diff.province_pixels);
+    RETURN_IF_ERROR(tally);
+
+    diff.provinces = diffProvinces(*old_layers.province_list,
+                                   *new_layers.province_list, *tally);
+    diff.states = diffStates(*old_layers.state_list, *new_layers.state_list);
+
+    auto heightmap = diffOptionalLayer(old_layers, old_layers.heightmap,
+                                       new_layers, new_layers.heightmap,
+                                       tile_size);
+    RETURN_IF_ERROR(heightmap);
+    diff.heightmap = std::move(*heightmap);
+
+    auto rivers = diffOptionalLayer(old_layers, old_layers.rivers,
+                                    new_layers, new_layers.rivers,
+                                    tile_size);
+    RETURN_IF_ERROR(rivers);
+    diff.rivers = std::move(*rivers);
+
+    return diff;
+}
+
+/**
+ * @brief Renders where the per-pixel layers changed into an image.
+ * @details The new heightmap is drawn dimmed as a backdrop, and every changed
+ *          pixel is drawn on top of it in DIFF_PROVINCE_COLOR,
+ *          DIFF_HEIGHTMAP_COLOR or DIFF_RIVERS_COLOR. Pixels which changed in
+ *          more than one layer get a mix of those colors. The layers are read
+ *          one band at a time, and only the bands with changes get compared.
+ *
+ * @param old_layers The old version
+ * @param new_layers The new version
+ * @param diff The diff between old_layers and new_layers
+ *
+ * @return The image, which is the size of the map
+ */
+auto HMDT::renderProjectDiff(const ProjectDiffLayers& old_layers,
+                             const ProjectDiffLayers& new_layers,
+                             const ProjectDiff& diff) noexcept
+    -> Maybe<RenderedMap>
+{
+    RETURN_ERROR_IF(!old_layers.provinces || !new_layers.provinces,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF(old_layers.dimensions.w != new_layers.dimensions.w ||
+                    old_layers.dimensions.h != new_layers.dimensions.h,
+                    STATUS_DIMENSION_MISMATCH);
+
+    const auto& dimensions = new_layers.dimensions;
+
+    RenderedMap image{ dimensions.w, dimensions.h, { } };
+    try {
+        image.pixels.resize(static_cast<uint64_t>(dimensions.w) * dimensions.h * 3, 0);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    if(new_layers.heightmap) {
+        auto result = forEachBand(dimensions, new_layers.heightmap,
+                                  PROJECT_DIFF_TILE_SIZE,
+            [&](const uint8_t* band, uint32_t top, uint32_t row_count) {
+                auto* pixels = &image.pixels[xyToIndex(dimensions.w, 0, top) * 3];
+                uint64_t size = static_cast<uint64_t>(dimensions.w) * row_count;
+
+                for(uint64_t i = 0; i < size; ++i) {
+                    std::fill_n(pixels + i * 3, 3, band[i] / 4);
+                }
+
+                return MaybeVoid{ STATUS_SUCCESS };
+            });
+        RETURN_IF_ERROR(result);
+    }
+
+    auto result = drawLayerChanges(image, diff.province_pixels,
+                                   old_layers.provinces, new_layers.provinces,
+                                   DIFF_PROVINCE_COLOR);
+    RETURN_IF_ERROR(result);
+
+    result = drawLayerChanges(image, diff.heightmap, old_layers.heightmap,
+                              new_layers.heightmap, DIFF_HEIGHTMAP_COLOR);
+    RETURN_IF_ERROR(result);
+
+    result = drawLayerChanges(image, diff.rivers, old_layers.rivers,
+                              new_layers.rivers, DIFF_RIVERS_COLOR);
+    RETURN_IF_ERROR(result);
+
+    return image;
+}
+
+/**
+ * @brief Reads the province layer from a project's shape data file, one band
+ *        at a time.
+ * @details Only the header is read up front, and every band is read straight
+ *          out of the file when it is asked for.
+ *
+ * @param path The path to the shape data file
+ * @param dimensions Set to the dimensions of the province layer
+ *
+ * @return The reader, or an error code if the file could not be opened or is
+ *         too short to hold the whole layer
+ */
+auto HMDT::readBandsFromShapeData(const std::filesystem::path& path,
+                                  Dimensions& dimensions) noexcept
+    -> Maybe<LayerBandReader<ProvinceID>>
+{
+    std::shared_ptr<std::ifstream> in;
+    try {
+        in = std::make_shared<std::ifstream>(path, std::ios::binary | std::ios::in);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    if(!*in) {
+        WRITE_ERROR("Failed to open file ", path);
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    char magic[4];
+    uint32_t width = 0;
+    uint32_t height = 0;
+    if(!safeRead(*in, &magic, &width, &height)) {
+        WRITE_ERROR("Failed to read in header information from ", path);
+        RETURN_ERROR(STATUS_READ_TOO_FEW_BYTES);
+    }
+
+    if(SHAPEDATA_MAGIC.compare(0, std::string::npos, magic, sizeof(magic)) != 0) {
+        WRITE_ERROR(path, " is not a shape data file.");
+        RETURN_ERROR(STATUS_INVALID_VALUE);
+    }
+
+    uint64_t offset = in->tellg();
+    uint64_t size = static_cast<uint64_t>(width) * height * sizeof(ProvinceID);
+
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(path, ec);
+    RETURN_ERROR_IF(ec.value() != 0, ec);
+
+    if(file_size < offset + size) {
+        WRITE_ERROR(path, " is too short to hold a ", width, 'x', height,
+                    " map.");
+        RETURN_ERROR(STATUS_READ_TOO_FEW_BYTES);
+    }
+
+    dimensions = Dimensions{ width, height };
+
+    return LayerBandReader<ProvinceID>(
+        [in, offset, width](uint32_t first_row, uint32_t row_count,
+                            std::vector<ProvinceID>& buffer)
+            -> Maybe<const ProvinceID*>
+        {
+            uint64_t count = static_cast<uint64_t>(row_count) * width;
+
+            try {
+                // Generating a new ID for every pixel would take far longer
+                //   than reading them, so fill the band with empty ones
+                buffer.resize(count, EMPTY_UUID);
+            } catch(const std::bad_alloc&) {
+                RETURN_ERROR(STATUS_BADALLOC);
+            }
+
+            in->clear();
+            in->seekg(offset + static_cast<uint64_t>(first_row) * width * sizeof(ProvinceID),
+                      in->beg);
+
+            auto res = safeRead2(buffer.data(), count * sizeof(ProvinceID), *in);
+            RETURN_IF_ERROR(res);
+
+            return static_cast<const ProvinceID*>(buffer.data());
+        });
+}
+
+/**
+ * @brief Reads an 8-bit BitMap one band at a time.
+ * @details Only the headers are read up front, and every band is read
+ *          straight out of the file when it is asked for.
+ *
+ * @param path The path to the BitMap
+ * @param dimensions The dimensions that the BitMap is expected to have
+ *
+ * @return The reader, or an error code if the file could not be read, is not
+ *         8-bit, or does not have the expected dimensions
+ */
+auto HMDT::readBandsFromBitMap(const std::filesystem::path& path,
+                               const Dimensions& dimensions) noexcept
+    -> Maybe<LayerBandReader<uint8_t>>
+{
+    std::shared_ptr<std::ifstream> in;
+    std::shared_ptr<BitMap2> bitmap;
+    try {
+        in = std::make_shared<std::ifstream>(path, std::ios::binary | std::ios::in);
+        bitmap = std::make_shared<BitMap2>();
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    if(!*in) {
+        WRITE_ERROR("Failed to open file ", path);
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    auto header = readBMPHeader(*in, *bitmap);
+    RETURN_IF_ERROR(header);
+
+    RETURN_ERROR_IF(bitmap->info_header.v1.bitsPerPixel != 8,
+                    STATUS_INVALID_BIT_DEPTH);
+
+    if(static_cast<uint32_t>(bitmap->info_header.v1.width) != dimensions.w ||
+       static_cast<uint32_t>(bitmap->info_header.v1.height) != dimensions.h)
+    {
+        WRITE_ERROR(path, " is ", bitmap->info_header.v1.width, 'x',
+                    bitmap->info_header.v1.height, ", but the map is ",
+                    dimensions.w, 'x', dimensions.h);
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+
+    return LayerBandReader<uint8_t>(
+        [in, bitmap](uint32_t first_row, uint32_t row_count,
+                     std::vector<uint8_t>& buffer)
+            -> Maybe<const uint8_t*>
+        {
+            try {
+                buffer.resize(static_cast<uint64_t>(row_count) *
+                              bitmap->info_header.v1.width);
+            } catch(const std::bad_alloc&) {
+                RETURN_ERROR(STATUS_BADALLOC);
+            }
+
+            auto res = readBMPRows(*in, *bitmap, first_row, row_count,
+                                   buffer.data());
+            RETURN_IF_ERROR(res);
+
+            return static_cast<const uint8_t*>(buffer.data());
+        });
+}
+
+/**
+ * @brief Writes a human-readable summary of a ProjectDiff.
+ *
+ * @param stream The stream to write to
+ * @param diff The diff to write
+ */
+void HMDT::writeProjectDiffText(std::ostream& stream, const ProjectDiff& diff) {
+    if(diff.empty()) {
+        stream << "No differences." << std::endl;
+        return;
+    }
+
+    if(diff.old_dimensions.w != diff.new_dimensions.w ||
+       diff.old_dimensions.h != diff.new_dimensions.h)
+    {
+        stream << "Dimensions: " << diff.old_dimensions.w << 'x'
+               << diff.old_dimensions.h << " -> " << diff.new_dimensions.w
+               << 'x' << diff.new_dimensions.h << std::endl;
+    }
+
+    if(!diff.metadata.empty()) {
+        stream << "Project:" << std::endl;
+        writePropertiesText(stream, diff.metadata, "  ");
+    }
+
+    if(!diff.provinces.empty()) {
+        stream << "Provinces: " << diff.provinces.size() << " changed"
+               << std::endl;
+
+        for(auto&& change : diff.provinces) {
+            stream << "  " << getChangeMarker(change.type) << ' ' << change.id;
+
+            switch(change.type) {
+                case ChangeType::ADDED:
+                    stream << " (" << change.new_pixel_count << " pixels)";
+                    break;
+                case ChangeType::REMOVED:
+                    stream << " (" << change.old_pixel_count << " pixels)";
+                    break;
+                case ChangeType::MODIFIED:
+                    if(change.changed_pixel_count != 0) {
+                        stream << " (" << change.old_pixel_count << " -> "
+                               << change.new_pixel_count << " pixels, "
+                               << change.changed_pixel_count << " changed)";
+                    }
+                    break;
+            }
+            stream << std::endl;
+
+            writePropertiesText(stream, change.properties, "      ");
+        }
+    }
+
+    if(!diff.states.empty()) {
+        stream << "States: " << diff.states.size() << " changed" << std::endl;
+
+        for(auto&& change : diff.states) {
+            stream << "  " << getChangeMarker(change.type) << ' ' << change.id
+                   << std::endl;
+
+            for(auto&& id : change.added_provinces) {
+                stream << "      + province " << id << std::endl;
+            }
+            for(auto&& id : change.removed_provinces) {
+                stream << "      - province " << id << std::endl;
+            }
+
+            writePropertiesText(stream, change.properties, "      ");
+        }
+    }
+
+    writeLayerText(stream, "Province pixels", diff.province_pixels);
+    writeLayerText(stream, "Heightmap", diff.heightmap);
+    writeLayerText(stream, "Rivers", diff.rivers);
+}
+
+/**
+ * @brief Writes a ProjectDiff as json.
+ *
+ * @param stream The stream to write to
+ * @param diff The diff to write
+ */
+void HMDT::writeProjectDiffJSON(std::ostream& stream, const ProjectDiff& diff) {
+    using json = nlohmann::json;
+
+    json provinces = json::array();
+    for(auto&& change : diff.provinces) {
+        provinces.push_back({
+            { "id", toPropertyString(change.id) },
+            { "change", toPropertyString(change.type) },
+            { "old_pixel_count", change.old_pixel_count },
+            { "new_pixel_count", change.new_pixel_count },
+            { "changed_pixel_count", change.changed_pixel_count },
+            { "properties", toJSON(change.properties) }
+        });
+    }
+
+    json states = json::array();
+    for(auto&& change : diff.states) {
+        states.push_back({
+            { "id", change.id },
+            { "change", toPropertyString(change.type) },
+            { "added_provinces", toJSON(change.added_provinces) },
+            { "removed_provinces", toJSON(change.removed_provinces) },
+            { "properties", toJSON(change.properties) }
+        });
+    }
+
+    json root = {
+        { "old_dimensions", { { "w", diff.old_dimensions.w },
+                              { "h", diff.old_dimensions.h } } },
+        { "new_dimensions", { { "w", diff.new_dimensions.w },
+                              { "h", diff.new_dimensions.h } } },
+        { "metadata", toJSON(diff.metadata) },
+        { "provinces", provinces },
+        { "states", states },
+        { "layers", {
+            { "provinces", toJSON(diff.province_pixels) },
+            { "heightmap", toJSON(diff.heightmap) },
+            { "rivers", toJSON(diff.rivers) }
+        } }
+    };
+
+    stream << root.dump(4) << std::endl;
+}
+
+std::ostream& HMDT::operator<<(std::ostream& stream, const ChangeType& type) {
+    switch(type) {
+        case ChangeType::ADDED:
+            return stream << "added";
+        case ChangeType::REMOVED:
+            return stream << "removed";
+        case ChangeType::MODIFIED:
+            return stream << "modified";
+    }
+
+    return stream;
+}
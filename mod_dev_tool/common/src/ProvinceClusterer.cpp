@@ -0,0 +1,396 @@
+/**
+ * @file ProvinceClusterer.cpp
+ *
+ * @brief Defines functions for grouping provinces into contiguous clusters,
+ *        such as states and strategic clusters.
+ */
+
+#include "ProvinceClusterer.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <tuple>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a province which has not been put into a cluster yet
+    constexpr uint32_t NO_CLUSTER = std::numeric_limits<uint32_t>::max();
+}
+
+/**
+ * @brief Partitions provinces into contiguous clusters of roughly the same
+ *        size.
+ * @details Provinces of different groups are never put into the same cluster.
+ *          Each connected group of provinces of the same kind gets a number of
+ *          clusters proportional to its size, and the seeds of those clusters
+ *          are spread as far apart as possible. The clusters are then grown one
+ *          province at a time, always growing whichever cluster is currently
+ *          the smallest, into whichever of its neighbors is closest to its
+ *          seed. This keeps every cluster contiguous and compact.
+ *
+ *          Groups which are too small to be a cluster on their own (such as
+ *          small islands) are either added to the closest cluster of the same
+ *          group, or kept as a cluster of their own.
+ *
+ *          Every tie is broken on the order the provinces first appear on the
+ *          map, so the same map and seed always produce the same clusters.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param provinces Every province on the map
+ * @param options How to cluster the provinces
+ *
+ * @return The provinces of every cluster, in the order they first appear on
+ *         the map.
+ */
+auto HMDT::clusterProvinces(const Dimensions& dimensions,
+                            const ProvinceID* province_matrix,
+                            const ProvinceList& provinces,
+                            const ProvinceClusterOptions& options)
+    -> Maybe<std::vector<std::vector<ProvinceID>>>
+{
+    RETURN_ERROR_IF(province_matrix == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF(options.target_size == 0, STATUS_INVALID_VALUE);
+    RETURN_ERROR_IF(!options.group_of, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto target_size = options.target_size;
+
+    // Give every province which is being clustered a dense index
+    std::vector<ProvinceID> ids;
+    std::vector<uint32_t> group;
+    ids.reserve(provinces.size());
+    for(auto&& [id, province] : provinces) {
+        if(options.group_of(province) != ProvinceClusterOptions::NO_GROUP) {
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    auto count = static_cast<uint32_t>(ids.size());
+
+    auto index_of = indexProvinceIDs(ids);
+    group.reserve(count);
+    for(auto&& id : ids) {
+        group.push_back(options.group_of(provinces.at(id)));
+    }
+
+    std::vector<std::vector<ProvinceID>> clusters;
+    if(count == 0) {
+        return clusters;
+    }
+
+    // Gather the area and centroid of every province
+    auto stats = gatherProvincePixelStats(dimensions, province_matrix, index_of);
+
+    // Province IDs are random, so put every province into the order they
+    //   first appear on the map instead. Every tie after this is broken on
+    //   that order, so the same map always produces the same clusters no
+    //   matter what IDs its provinces were given.
+    {
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&stats, &ids](uint32_t a, uint32_t b) {
+            return std::tie(stats[a].first, ids[a]) < std::tie(stats[b].first, ids[b]);
+        });
+
+        std::vector<ProvinceID> sorted_ids(count);
+        std::vector<uint32_t> sorted_group(count);
+        std::vector<ProvincePixelStats> sorted_stats(count);
+        for(uint32_t i = 0; i < count; ++i) {
+            sorted_ids[i] = ids[order[i]];
+            sorted_group[i] = group[order[i]];
+            sorted_stats[i] = stats[order[i]];
+            index_of[sorted_ids[i]] = i;
+        }
+
+        ids = std::move(sorted_ids);
+        group = std::move(sorted_group);
+        stats = std::move(sorted_stats);
+    }
+
+    std::vector<double> centroid_x(count);
+    std::vector<double> centroid_y(count);
+    for(uint32_t p = 0; p < count; ++p) {
+        auto n = std::max<uint64_t>(stats[p].count, 1);
+        centroid_x[p] = static_cast<double>(stats[p].sum_x) / n;
+        centroid_y[p] = static_cast<double>(stats[p].sum_y) / n;
+    }
+
+    auto distance2 = [&centroid_x, &centroid_y](double x, double y, uint32_t p)
+    {
+        auto dx = centroid_x[p] - x;
+        auto dy = centroid_y[p] - y;
+        return dx * dx + dy * dy;
+    };
+
+    // How much every province counts towards the size of its cluster
+    std::vector<uint64_t> weight(count);
+    for(uint32_t p = 0; p < count; ++p) {
+        weight[p] = (options.measure == ProvinceClusterOptions::Measure::AREA) ? stats[p].count : 1;
+    }
+
+    // Only provinces of the same group are connected to each other.
+    //   Adjacencies are not guaranteed to be recorded on both sides, so add
+    //   every edge in both directions
+    std::vector<std::vector<uint32_t>> edges(count);
+    for(uint32_t p = 0; p < count; ++p) {
+        for(auto&& adj_id : provinces.at(ids[p]).adjacent_provinces) {
+            if(auto it = index_of.find(adj_id); it != index_of.end() &&
+                                                it->second != p &&
+                                                group[it->second] == group[p])
+            {
+                edges[p].push_back(it->second);
+                edges[it->second].push_back(p);
+            }
+        }
+    }
+    for(auto&& adjacent : edges) {
+        std::sort(adjacent.begin(), adjacent.end());
+        adjacent.erase(std::unique(adjacent.begin(), adjacent.end()),
+                       adjacent.end());
+    }
+
+    std::vector<uint32_t> cluster_of(count, NO_CLUSTER);
+    std::vector<uint64_t> cluster_sizes;
+
+    std::vector<std::vector<uint32_t>> small_components;
+
+    std::optional<std::mt19937_64> rng;
+    if(options.seed) {
+        rng.emplace(*options.seed);
+    }
+
+    std::vector<bool> visited(count, false);
+    for(uint32_t start = 0; start < count; ++start) {
+        if(visited[start]) continue;
+
+        // Find every province connected to this one
+        std::vector<uint32_t> component{ start };
+        visited[start] = true;
+        for(size_t i = 0; i < component.size(); ++i) {
+            for(auto&& q : edges[component[i]]) {
+                if(!visited[q]) {
+                    visited[q] = true;
+                    component.push_back(q);
+                }
+            }
+        }
+
+        uint64_t area = 0;
+        uint64_t size = 0;
+        double sum_x = 0;
+        double sum_y = 0;
+        for(auto&& p : component) {
+            area += stats[p].count;
+            size += weight[p];
+            sum_x += stats[p].sum_x;
+            sum_y += stats[p].sum_y;
+        }
+
+        auto cluster_count = std::min<uint64_t>((size + target_size / 2) / target_size,
+                                                component.size());
+        if(!options.merge_small_components) {
+            cluster_count = std::max<uint64_t>(cluster_count, 1);
+        }
+
+        // Too small to be a cluster on its own, deal with these at the end
+        if(cluster_count == 0) {
+            small_components.push_back(std::move(component));
+            continue;
+        }
+
+        // Spread the seeds as far apart as possible, starting with whichever
+        //   province is the furthest out from the middle of the component, or
+        //   from a random province of it if there is a seed
+        std::vector<uint32_t> seeds;
+        {
+            auto n = static_cast<double>(std::max<uint64_t>(area, 1));
+            auto cx = sum_x / n;
+            auto cy = sum_y / n;
+
+            if(rng) {
+                auto first = component[(*rng)() % component.size()];
+                cx = centroid_x[first];
+                cy = centroid_y[first];
+            }
+
+            std::vector<double> nearest_seed(component.size());
+            for(size_t i = 0; i < component.size(); ++i) {
+                nearest_seed[i] = distance2(cx, cy, component[i]);
+            }
+
+            while(seeds.size() < cluster_count) {
+                size_t best = component.size();
+                for(size_t i = 0; i < component.size(); ++i) {
+                    auto p = component[i];
+                    if(cluster_of[p] != NO_CLUSTER) continue;
+
+                    if(best == component.size() ||
+                       nearest_seed[i] > nearest_seed[best] ||
+                       (nearest_seed[i] == nearest_seed[best] && p < component[best]))
+                    {
+                        best = i;
+                    }
+                }
+
+                auto seed = component[best];
+                cluster_of[seed] = cluster_sizes.size() + seeds.size();
+                seeds.push_back(seed);
+
+                // The middle of the component only picks the first seed, after
+                //   that only the distance to the other seeds matters
+                for(size_t i = 0; i < component.size(); ++i) {
+                    auto d = distance2(centroid_x[seed], centroid_y[seed], component[i]);
+                    nearest_seed[i] = (seeds.size() == 1) ? d : std::min(nearest_seed[i], d);
+                }
+            }
+        }
+
+        // Grow the clusters, always growing the smallest one into whichever of
+        //   its neighbors is closest to its seed
+        using FrontierEntry = std::pair<double, uint32_t>;
+        using Frontier = std::priority_queue<FrontierEntry,
+                                             std::vector<FrontierEntry>,
+                                             std::greater<FrontierEntry>>;
+        using SizeEntry = std::pair<uint64_t, uint32_t>;
+
+        auto first_cluster = static_cast<uint32_t>(cluster_sizes.size());
+        std::vector<Frontier> frontiers(seeds.size());
+        std::priority_queue<SizeEntry, std::vector<SizeEntry>,
+                            std::greater<SizeEntry>> smallest;
+
+        auto claim = [&](uint32_t i, uint32_t p) {
+            auto seed = seeds[i];
+
+            cluster_of[p] = first_cluster + i;
+            cluster_sizes[first_cluster + i] += weight[p];
+
+            for(auto&& q : edges[p]) {
+                if(cluster_of[q] == NO_CLUSTER) {
+                    frontiers[i].push({ distance2(centroid_x[seed], centroid_y[seed], q), q });
+                }
+            }
+        };
+
+        cluster_sizes.resize(cluster_sizes.size() + seeds.size(), 0);
+        for(uint32_t i = 0; i < seeds.size(); ++i) {
+            claim(i, seeds[i]);
+            smallest.push({ cluster_sizes[first_cluster + i], i });
+        }
+
+        while(!smallest.empty()) {
+            auto i = smallest.top().second;
+            smallest.pop();
+
+            auto& frontier = frontiers[i];
+            while(!frontier.empty() && cluster_of[frontier.top().second] != NO_CLUSTER) {
+                frontier.pop();
+            }
+
+            // This cluster has been boxed in by the others, so it's done
+            if(frontier.empty()) continue;
+
+            auto p = frontier.top().second;
+            frontier.pop();
+
+            claim(i, p);
+            smallest.push({ cluster_sizes[first_cluster + i], i });
+        }
+    }
+
+    // Add every group that was too small to the closest cluster of the same
+    //   kind
+    if(!small_components.empty()) {
+        std::vector<double> cluster_x(cluster_sizes.size(), 0);
+        std::vector<double> cluster_y(cluster_sizes.size(), 0);
+        std::vector<uint64_t> cluster_pixels(cluster_sizes.size(), 0);
+        std::vector<uint32_t> cluster_group(cluster_sizes.size(), 0);
+        for(uint32_t p = 0; p < count; ++p) {
+            if(auto r = cluster_of[p]; r != NO_CLUSTER) {
+                cluster_x[r] += stats[p].sum_x;
+                cluster_y[r] += stats[p].sum_y;
+                cluster_pixels[r] += stats[p].count;
+                cluster_group[r] = group[p];
+            }
+        }
+        for(size_t r = 0; r < cluster_sizes.size(); ++r) {
+            auto n = static_cast<double>(std::max<uint64_t>(cluster_pixels[r], 1));
+            cluster_x[r] /= n;
+            cluster_y[r] /= n;
+        }
+
+        for(auto&& component : small_components) {
+            uint64_t area = 0;
+            uint64_t size = 0;
+            double cx = 0;
+            double cy = 0;
+            for(auto&& p : component) {
+                area += stats[p].count;
+                size += weight[p];
+                cx += stats[p].sum_x;
+                cy += stats[p].sum_y;
+            }
+
+            auto n = static_cast<double>(std::max<uint64_t>(area, 1));
+            cx /= n;
+            cy /= n;
+
+            auto component_group = group[component.front()];
+
+            uint32_t best = NO_CLUSTER;
+            double best_distance = std::numeric_limits<double>::infinity();
+            for(uint32_t r = 0; r < cluster_sizes.size(); ++r) {
+                if(cluster_group[r] != component_group) continue;
+
+                auto dx = cluster_x[r] - cx;
+                auto dy = cluster_y[r] - cy;
+                if(auto d = dx * dx + dy * dy; d < best_distance) {
+                    best = r;
+                    best_distance = d;
+                }
+            }
+
+            // Nothing of the same kind to join, so it has to be a cluster
+            //   anyway
+            if(best == NO_CLUSTER) {
+                best = cluster_sizes.size();
+                cluster_sizes.push_back(size);
+                cluster_x.push_back(cx);
+                cluster_y.push_back(cy);
+                cluster_pixels.push_back(area);
+                cluster_group.push_back(component_group);
+            } else {
+                cluster_sizes[best] += size;
+            }
+
+            for(auto&& p : component) {
+                cluster_of[p] = best;
+            }
+        }
+    }
+
+    // Number the clusters in the order they first appear on the map too
+    std::vector<uint32_t> cluster_order(cluster_sizes.size(), NO_CLUSTER);
+    for(uint32_t p = 0; p < count; ++p) {
+        auto& c = cluster_order[cluster_of[p]];
+        if(c == NO_CLUSTER) {
+            c = clusters.size();
+            clusters.emplace_back();
+        }
+
+        clusters[c].push_back(ids[p]);
+    }
+
+    WRITE_DEBUG("Clustered ", count, " provinces into ", clusters.size(),
+                " clusters.");
+
+    return clusters;
+}
+
@@ -0,0 +1,865 @@
+/**
+ * @file ProvinceGenerator.cpp
+ *
+ * @brief Defines functions for generating a province map from a land, sea and
+ *        lake mask.
+ *
+ * @par The mask is first broken up into regions, each of which is a connected
+ *      area of a single province type. Every region is given a share of the
+ *      provinces based on how much of the map it covers, and seeds for those
+ *      provinces are scattered over it with Poisson-disc sampling (so that no
+ *      two seeds are too close together). The seeds are then relaxed with a
+ *      few iterations of Lloyd's algorithm, and every pixel becomes a part of
+ *      the closest seed in its own region. Provinces therefore never cross a
+ *      coastline.
+ *
+ * @par Every random value is derived from a SplitMix64 stream rather than from
+ *      std::*_distribution, since the distributions are not guaranteed to
+ *      produce the same sequence across standard library implementations.
+ *      Pixel weights are integers, so that sums over them come out the same
+ *      no matter how the work is split between threads.
+ */
+
+#include "ProvinceGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "UniqueColorGenerator.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a pixel which does not belong to anything yet
+    constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+    //! The weight of a land or lake pixel where the density map is darkest
+    constexpr uint32_t BASE_PIXEL_WEIGHT = 256;
+
+    //! How many times more densely the brightest parts of a density map are
+    //!   filled with provinces than the darkest parts
+    constexpr uint32_t MAX_DENSITY_RATIO = 4;
+
+    //! How many random candidates are tried for every seed a region needs
+    //!   before the seeds are allowed to be closer together
+    constexpr uint64_t SEED_ATTEMPTS_PER_PROVINCE = 30;
+
+    //! How close two seeds may be, as a fraction of how far apart they would
+    //!   be on a hexagonal grid of the same density
+    constexpr double SEED_SPACING_FACTOR = 0.7;
+
+    //! How far apart the points of a hexagonal grid are, relative to the
+    //!   square root of the area of each cell. This is sqrt(2 / sqrt(3)).
+    constexpr double HEX_GRID_SPACING = 1.0745699318;
+
+    /**
+     * @brief A tiny, portable PRNG
+     */
+    struct SplitMix64 {
+        uint64_t state;
+
+        uint64_t next() noexcept {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        //! Returns a value in [0, 1)
+        double nextDouble() noexcept {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    /**
+     * @brief A connected area of the mask which is all one province type
+     */
+    struct Region {
+        HMDT::ProvinceType type;
+
+        //! Where the pixels of this region start in the region pixel order
+        uint64_t first;
+
+        //! How many pixels are in this region
+        uint64_t size;
+
+        //! The sum of the weight of every pixel in this region
+        uint64_t weight;
+
+        //! The lowest and highest weight of any pixel in this region
+        uint32_t min_weight;
+        uint32_t max_weight;
+
+        //! The bounding box of this region
+        uint32_t min_x;
+        uint32_t min_y;
+        uint32_t max_x;
+        uint32_t max_y;
+
+        //! How many provinces this region is split into
+        uint32_t province_count;
+    };
+
+    /**
+     * @brief Where a single province is grown from
+     */
+    struct Seed {
+        double x;
+        double y;
+        uint32_t region;
+    };
+
+    /**
+     * @brief Decides what type of province a pixel of the mask is for. Blue
+     *        pixels are sea, green pixels are lakes, and everything else is
+     *        land.
+     */
+    HMDT::ProvinceType classifyMaskColor(uint8_t r, uint8_t g, uint8_t b) noexcept
+    {
+        if(b > r && b >= g) {
+            return HMDT::ProvinceType::SEA;
+        } else if(g > r && g > b) {
+            return HMDT::ProvinceType::LAKE;
+        } else {
+            return HMDT::ProvinceType::LAND;
+        }
+    }
+
+    /**
+     * @brief Finds every region of the mask.
+     *
+     * @param dimensions The dimensions of the mask
+     * @param types The province type of every pixel
+     * @param weights The weight of every pixel
+     * @param region_of Filled with the region of every pixel
+     * @param order Filled with every pixel, grouped by region
+     *
+     * @return Every region
+     */
+    std::vector<Region> findRegions(const HMDT::Dimensions& dimensions,
+                                    const std::vector<HMDT::ProvinceType>& types,
+                                    const std::vector<uint16_t>& weights,
+                                    std::vector<uint32_t>& region_of,
+                                    std::vector<uint32_t>& order) noexcept
+    {
+        auto [width, height] = dimensions;
+        uint64_t size = static_cast<uint64_t>(width) * height;
+
+        std::vector<Region> regions;
+
+        region_of.assign(size, NO_INDEX);
+        order.clear();
+        order.reserve(size);
+
+        for(uint64_t start = 0; start < size; ++start) {
+            if(region_of[start] != NO_INDEX) {
+                continue;
+            }
+
+            uint32_t r = regions.size();
+
+            Region region{
+                types[start], order.size(), 0, 0, NO_INDEX, 0, width, height,
+                0, 0, 0
+            };
+
+            region_of[start] = r;
+            order.push_back(start);
+
+            // The pixels already found are also the queue of pixels to visit
+            for(uint64_t head = region.first; head < order.size(); ++head) {
+                auto i = order[head];
+                uint32_t x = i % width;
+                uint32_t y = i / width;
+
+                region.weight += weights[i];
+                region.min_weight = std::min<uint32_t>(region.min_weight, weights[i]);
+                region.max_weight = std::max<uint32_t>(region.max_weight, weights[i]);
+                region.min_x = std::min(region.min_x, x);
+                region.min_y = std::min(region.min_y, y);
+                region.max_x = std::max(region.max_x, x);
+                region.max_y = std::max(region.max_y, y);
+
+                auto visit = [&](uint64_t n) {
+                    if(region_of[n] == NO_INDEX && types[n] == region.type) {
+                        region_of[n] = r;
+                        order.push_back(n);
+                    }
+                };
+
+                if(y > 0) visit(i - width);
+                if(x + 1 < width) visit(i + 1);
+                if(y + 1 < height) visit(i + width);
+                if(x > 0) visit(i - 1);
+            }
+
+            region.size = order.size() - region.first;
+            regions.push_back(region);
+        }
+
+        return regions;
+    }
+
+    /**
+     * @brief Scatters the seeds of one region with Poisson-disc sampling.
+     * @details Candidates are picked at random, with heavier pixels picked
+     *          more often, and are thrown away if they are too close to a seed
+     *          which was already placed. If too many candidates are thrown
+     *          away, then the seeds are allowed to be closer together and the
+     *          rest are placed.
+     *
+     * @param region The region
+     * @param region_index The index of the region
+     * @param width The width of the mask
+     * @param order Every pixel, grouped by region
+     * @param weights The weight of every pixel
+     * @param weight_per_province How much weight every province should cover
+     * @param seed The seed for the generator
+     *
+     * @return The seeds of the region. There may be fewer than the region
+     *         needs if it is almost entirely full of provinces.
+     */
+    std::vector<Seed> placeSeeds(const Region& region, uint32_t region_index,
+                                 uint32_t width,
+                                 const std::vector<uint32_t>& order,
+                                 const std::vector<uint16_t>& weights,
+                                 double weight_per_province,
+                                 uint64_t seed) noexcept
+    {
+        SplitMix64 rng{ seed ^ ((region_index + 1) * 0xD1B54A32D192ED03ULL) };
+
+        // How close two seeds may be around a pixel of the given weight
+        auto spacingFor = [weight_per_province](uint32_t weight) {
+            return SEED_SPACING_FACTOR * HEX_GRID_SPACING *
+                   std::sqrt(weight_per_province / weight);
+        };
+
+        // Bucket the seeds into a grid over the region, so that only nearby
+        //   seeds have to be checked
+        double cell_size = std::max(1.0, spacingFor(region.max_weight));
+        auto reach = static_cast<int64_t>(std::ceil(spacingFor(region.min_weight) / cell_size));
+
+        int64_t grid_w = static_cast<int64_t>((region.max_x - region.min_x) / cell_size) + 1;
+        int64_t grid_h = static_cast<int64_t>((region.max_y - region.min_y) / cell_size) + 1;
+
+        std::vector<uint32_t> cell_heads(grid_w * grid_h, NO_INDEX);
+
+        std::vector<Seed> seeds;
+        std::vector<double> spacings;
+        std::vector<uint32_t> next_in_cell;
+
+        const uint64_t max_attempts = region.province_count * SEED_ATTEMPTS_PER_PROVINCE;
+
+        // Every pass lets the seeds get twice as close together, and the last
+        //   one only keeps two seeds from being on the same pixel
+        for(double scale = 1.0; seeds.size() < region.province_count; scale /= 2) {
+            bool last_pass = scale < 1.0 / 16;
+
+            for(uint64_t attempt = 0;
+                attempt < max_attempts && seeds.size() < region.province_count;
+                ++attempt)
+            {
+                auto i = order[region.first + rng.next() % region.size];
+
+                // Heavier pixels are picked more often
+                if(rng.nextDouble() * region.max_weight >= weights[i]) {
+                    continue;
+                }
+
+                double x = i % width;
+                double y = i / width;
+                double spacing = spacingFor(weights[i]);
+
+                int64_t cx = static_cast<int64_t>((x - region.min_x) / cell_size);
+                int64_t cy = static_cast<int64_t>((y - region.min_y) / cell_size);
+
+                bool too_close = false;
+                for(int64_t gy = std::max<int64_t>(cy - reach, 0);
+                    !too_close && gy <= std::min(cy + reach, grid_h - 1); ++gy)
+                {
+                    for(int64_t gx = std::max<int64_t>(cx - reach, 0);
+                        !too_close && gx <= std::min(cx + reach, grid_w - 1); ++gx)
+                    {
+                        for(auto s = cell_heads[gy * grid_w + gx]; s != NO_INDEX;
+                                 s = next_in_cell[s])
+                        {
+                            double dx = seeds[s].x - x;
+                            double dy = seeds[s].y - y;
+                            double distance = dx * dx + dy * dy;
+
+                            double min_distance = last_pass ? 0 : std::max(spacing, spacings[s]) * scale;
+
+                            if(distance == 0 || distance < min_distance * min_distance)
+                            {
+                                too_close = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if(too_close) {
+                    continue;
+                }
+
+                auto& head = cell_heads[cy * grid_w + cx];
+                next_in_cell.push_back(head);
+                head = seeds.size();
+
+                seeds.push_back(Seed{ x, y, region_index });
+                spacings.push_back(spacing);
+            }
+
+            if(last_pass) {
+                break;
+            }
+        }
+
+        // Every region needs at least one seed, or its pixels would have no
+        //   province to go to
+        if(seeds.empty()) {
+            auto i = order[region.first];
+            seeds.push_back(Seed{ static_cast<double>(i % width),
+                                  static_cast<double>(i / width),
+                                  region_index });
+        }
+
+        return seeds;
+    }
+
+    /**
+     * @brief Buckets seeds into a uniform grid over the map, so that the
+     *        closest seed to a pixel can be found by only looking at nearby
+     *        cells.
+     */
+    struct SeedGrid {
+        SeedGrid(const HMDT::Dimensions& dimensions,
+                 const std::vector<Seed>& seeds) noexcept
+        {
+            auto [width, height] = dimensions;
+
+            cell_size = std::max(1U, static_cast<uint32_t>(
+                        std::sqrt(static_cast<double>(width) * height / seeds.size())));
+            grid_w = (width + cell_size - 1) / cell_size;
+            grid_h = (height + cell_size - 1) / cell_size;
+
+            auto cellOf = [this](const Seed& seed) {
+                return static_cast<uint64_t>(seed.y / cell_size) * grid_w +
+                       static_cast<uint64_t>(seed.x / cell_size);
+            };
+
+            cell_starts.assign(static_cast<uint64_t>(grid_w) * grid_h + 1, 0);
+            for(auto&& seed : seeds) {
+                ++cell_starts[cellOf(seed) + 1];
+            }
+            for(uint64_t c = 1; c < cell_starts.size(); ++c) {
+                cell_starts[c] += cell_starts[c - 1];
+            }
+
+            cell_seeds.resize(seeds.size());
+
+            std::vector<uint32_t> cursor(cell_starts.begin(), cell_starts.end() - 1);
+            for(uint32_t s = 0; s < seeds.size(); ++s) {
+                cell_seeds[cursor[cellOf(seeds[s])]++] = s;
+            }
+        }
+
+        /**
+         * @brief Finds the closest seed to a pixel which is in the given
+         *        region. Ties go to the seed with the lowest index.
+         */
+        uint32_t findNearest(const std::vector<Seed>& seeds, uint32_t x,
+                             uint32_t y, uint32_t region) const noexcept
+        {
+            const int64_t cx = x / cell_size;
+            const int64_t cy = y / cell_size;
+            const int64_t max_ring = std::max(grid_w, grid_h);
+
+            double best_distance = std::numeric_limits<double>::infinity();
+            uint32_t best_seed = NO_INDEX;
+
+            for(int64_t ring = 0; ring <= max_ring; ++ring) {
+                for(int64_t gy = cy - ring; gy <= cy + ring; ++gy) {
+                    if(gy < 0 || gy >= grid_h) continue;
+
+                    // Only the outer edge of the ring is new
+                    int64_t step = (gy == cy - ring || gy == cy + ring) ? 1 : ring * 2;
+                    for(int64_t gx = cx - ring; gx <= cx + ring; gx += step) {
+                        if(gx < 0 || gx >= grid_w) continue;
+
+                        auto cell = gy * grid_w + gx;
+                        for(auto i = cell_starts[cell]; i < cell_starts[cell + 1]; ++i)
+                        {
+                            auto s = cell_seeds[i];
+                            if(seeds[s].region != region) {
+                                continue;
+                            }
+
+                            double dx = seeds[s].x - x;
+                            double dy = seeds[s].y - y;
+                            double distance = dx * dx + dy * dy;
+
+                            if(distance < best_distance ||
+                               (distance == best_distance && s < best_seed))
+                            {
+                                best_distance = distance;
+                                best_seed = s;
+                            }
+                        }
+                    }
+                }
+
+                // Every seed in the next ring is at least ring*cell_size
+                //   pixels away, so we can stop once we beat that
+                double ring_distance = static_cast<double>(ring) * cell_size;
+                if(best_distance <= ring_distance * ring_distance) {
+                    break;
+                }
+            }
+
+            return best_seed;
+        }
+
+        uint32_t cell_size;
+        int64_t grid_w;
+        int64_t grid_h;
+
+        std::vector<uint32_t> cell_starts;
+        std::vector<uint32_t> cell_seeds;
+    };
+
+    /**
+     * @brief Gives every pixel to the closest seed in its region.
+     *
+     * @param dimensions The dimensions of the mask
+     * @param seeds Every seed
+     * @param region_of The region of every pixel
+     * @param owners Filled with the seed of every pixel
+     */
+    void assignPixels(const HMDT::Dimensions& dimensions,
+                      const std::vector<Seed>& seeds,
+                      const std::vector<uint32_t>& region_of,
+                      std::vector<uint32_t>& owners)
+    {
+        auto [width, height] = dimensions;
+
+        SeedGrid grid(dimensions, seeds);
+
+        owners.resize(static_cast<uint64_t>(width) * height);
+
+        HMDT::parallelForEachRange(height, [&](uint32_t begin, uint32_t end) {
+            for(uint32_t y = begin; y < end; ++y) {
+                for(uint32_t x = 0; x < width; ++x) {
+                    auto index = HMDT::xyToIndex(width, x, y);
+                    owners[index] = grid.findNearest(seeds, x, y, region_of[index]);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Moves every seed to the weighted middle of its cell. A seed is
+     *        left where it is if the middle is outside of its region, or if it
+     *        has no pixels.
+     *
+     * @param dimensions The dimensions of the mask
+     * @param owners The seed of every pixel
+     * @param weights The weight of every pixel
+     * @param region_of The region of every pixel
+     * @param seeds Every seed
+     */
+    void moveSeedsToCentroids(const HMDT::Dimensions& dimensions,
+                              const std::vector<uint32_t>& owners,
+                              const std::vector<uint16_t>& weights,
+                              const std::vector<uint32_t>& region_of,
+                              std::vector<Seed>& seeds)
+    {
+        auto [width, height] = dimensions;
+
+        std::vector<uint64_t> sum_x(seeds.size(), 0);
+        std::vector<uint64_t> sum_y(seeds.size(), 0);
+        std::vector<uint64_t> sum_weight(seeds.size(), 0);
+        std::mutex mutex;
+
+        HMDT::parallelForEachRange(height, [&](uint32_t begin, uint32_t end) {
+            std::vector<uint64_t> local_x(seeds.size(), 0);
+            std::vector<uint64_t> local_y(seeds.size(), 0);
+            std::vector<uint64_t> local_weight(seeds.size(), 0);
+
+            for(uint32_t y = begin; y < end; ++y) {
+                for(uint32_t x = 0; x < width; ++x) {
+                    auto index = HMDT::xyToIndex(width, x, y);
+                    auto s = owners[index];
+                    auto weight = weights[index];
+
+                    local_x[s] += static_cast<uint64_t>(weight) * x;
+                    local_y[s] += static_cast<uint64_t>(weight) * y;
+                    local_weight[s] += weight;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for(uint32_t s = 0; s < seeds.size(); ++s) {
+                sum_x[s] += local_x[s];
+                sum_y[s] += local_y[s];
+                sum_weight[s] += local_weight[s];
+            }
+        });
+
+        for(uint32_t s = 0; s < seeds.size(); ++s) {
+            if(sum_weight[s] == 0) {
+                continue;
+            }
+
+            double x = static_cast<double>(sum_x[s]) / sum_weight[s];
+            double y = static_cast<double>(sum_y[s]) / sum_weight[s];
+
+            auto px = std::min(static_cast<uint32_t>(std::lround(x)), width - 1);
+            auto py = std::min(static_cast<uint32_t>(std::lround(y)), height - 1);
+
+            if(region_of[HMDT::xyToIndex(width, px, py)] == seeds[s].region) {
+                seeds[s].x = x;
+                seeds[s].y = y;
+            }
+        }
+    }
+
+    /**
+     * @brief Makes sure that every province is a single connected shape.
+     * @details A cell in a region which is not convex can come out in more
+     *          than one part. Only the largest part of every cell is kept, and
+     *          every other part is grown back over by whichever neighboring
+     *          cells in the same region reach it first.
+     *
+     * @param dimensions The dimensions of the mask
+     * @param region_of The region of every pixel
+     * @param seed_count The number of seeds
+     * @param owners The seed of every pixel
+     */
+    void makeProvincesContiguous(const HMDT::Dimensions& dimensions,
+                                 const std::vector<uint32_t>& region_of,
+                                 uint32_t seed_count,
+                                 std::vector<uint32_t>& owners) noexcept
+    {
+        auto [width, height] = dimensions;
+        uint64_t size = static_cast<uint64_t>(width) * height;
+
+        auto forEachNeighbor = [width = width, height = height](uint64_t i, auto&& func) {
+            uint32_t x = i % width;
+            uint32_t y = i / width;
+
+            if(y > 0) func(i - width);
+            if(x + 1 < width) func(i + 1);
+            if(y + 1 < height) func(i + width);
+            if(x > 0) func(i - 1);
+        };
+
+        // Find every connected part of every cell, and the largest one of each
+        std::vector<uint32_t> parts(size, NO_INDEX);
+        std::vector<uint64_t> part_sizes;
+        std::vector<uint32_t> largest(seed_count, NO_INDEX);
+        std::vector<uint64_t> to_visit;
+
+        for(uint64_t start = 0; start < size; ++start) {
+            if(parts[start] != NO_INDEX) {
+                continue;
+            }
+
+            uint32_t part = part_sizes.size();
+            uint64_t part_size = 0;
+
+            parts[start] = part;
+            to_visit.push_back(start);
+
+            while(!to_visit.empty()) {
+                auto i = to_visit.back();
+                to_visit.pop_back();
+
+                ++part_size;
+
+                forEachNeighbor(i, [&](uint64_t n) {
+                    if(parts[n] == NO_INDEX && owners[n] == owners[start]) {
+                        parts[n] = part;
+                        to_visit.push_back(n);
+                    }
+                });
+            }
+
+            part_sizes.push_back(part_size);
+
+            if(auto& best = largest[owners[start]];
+               best == NO_INDEX || part_size > part_sizes[best])
+            {
+                best = part;
+            }
+        }
+
+        if(part_sizes.size() <= seed_count) {
+            return;
+        }
+
+        auto original_owners = owners;
+
+        for(uint64_t i = 0; i < size; ++i) {
+            if(largest[owners[i]] != parts[i]) {
+                owners[i] = NO_INDEX;
+            }
+        }
+
+        // Grow breadth-first so that every kept part grows at the same rate,
+        //   starting from every kept pixel which touches a removed one
+        std::vector<uint64_t> frontier;
+        for(uint64_t i = 0; i < size; ++i) {
+            if(owners[i] == NO_INDEX) {
+                continue;
+            }
+
+            bool touches_removed = false;
+            forEachNeighbor(i, [&](uint64_t n) {
+                touches_removed |= (owners[n] == NO_INDEX);
+            });
+
+            if(touches_removed) {
+                frontier.push_back(i);
+            }
+        }
+
+        for(uint64_t head = 0; head < frontier.size(); ++head) {
+            auto i = frontier[head];
+
+            forEachNeighbor(i, [&](uint64_t n) {
+                if(owners[n] == NO_INDEX && region_of[n] == region_of[i]) {
+                    owners[n] = owners[i];
+                    frontier.push_back(n);
+                }
+            });
+        }
+
+        // Should never happen, as every part borders another cell of its region
+        for(uint64_t i = 0; i < size; ++i) {
+            if(owners[i] == NO_INDEX) {
+                owners[i] = original_owners[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the terrain a generated province of the given type gets
+     */
+    HMDT::TerrainID getDefaultTerrain(HMDT::ProvinceType type) noexcept {
+        switch(type) {
+            case HMDT::ProvinceType::SEA:
+                return "ocean";
+            case HMDT::ProvinceType::LAKE:
+                return "lakes";
+            case HMDT::ProvinceType::LAND:
+            case HMDT::ProvinceType::UNKNOWN:
+            default:
+                return "plains";
+        }
+    }
+}
+
+/**
+ * @brief Generates a province map from a land, sea and lake mask.
+ * @details Blue pixels of the mask are sea, green pixels are lakes, and every
+ *          other pixel is land. Every connected area of the mask gets at least
+ *          one province, so an island a few pixels across will be a province
+ *          which is too small for the game.
+ *
+ * @param dimensions The dimensions of the mask
+ * @param mask The mask, 3 bytes (RGB) per pixel
+ * @param density How densely every part of the map is filled with provinces,
+ *                1 byte per pixel with brighter pixels getting more provinces.
+ *                May be nullptr, in which case the whole map is filled evenly.
+ * @param options The options to generate the map with
+ *
+ * @return The generated map, or STATUS_INVALID_VALUE if the mask is empty.
+ */
+auto HMDT::generateProvinceMap(const Dimensions& dimensions,
+                               const uint8_t* mask,
+                               const uint8_t* density,
+                               const ProvinceGeneratorOptions& options) noexcept
+    -> Maybe<GeneratedProvinceMap>
+{
+    auto [width, height] = dimensions;
+    uint64_t size = static_cast<uint64_t>(width) * height;
+
+    if(mask == nullptr || size == 0) {
+        WRITE_ERROR("Cannot generate provinces from an empty mask.");
+        RETURN_ERROR(STATUS_INVALID_VALUE);
+    }
+
+    if(options.sea_province_scale <= 0) {
+        WRITE_ERROR("Sea provinces must be scaled by more than 0, not ",
+                    options.sea_province_scale, '.');
+        RETURN_ERROR(STATUS_INVALID_VALUE);
+    }
+
+    std::vector<ProvinceType> types;
+    std::vector<uint16_t> weights;
+    std::vector<uint32_t> region_of;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> owners;
+
+    try {
+        types.resize(size);
+        weights.resize(size);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    auto sea_weight = std::max(1L, std::lround(BASE_PIXEL_WEIGHT / options.sea_province_scale));
+
+    auto result = tryParallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        for(auto i = begin; i < end; ++i) {
+            types[i] = classifyMaskColor(mask[i * 3], mask[i * 3 + 1], mask[i * 3 + 2]);
+
+            uint32_t weight = (types[i] == ProvinceType::SEA) ? sea_weight : BASE_PIXEL_WEIGHT;
+            if(density != nullptr) {
+                weight += weight * (MAX_DENSITY_RATIO - 1) * density[i] / 255;
+            }
+
+            weights[i] = weight;
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    std::vector<Region> regions;
+    try {
+        regions = findRegions(dimensions, types, weights, region_of, order);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Share the provinces out between the regions by weight
+    uint64_t total_weight = 0;
+    for(auto&& region : regions) {
+        total_weight += region.weight;
+    }
+
+    uint32_t target_count = options.province_count;
+    if(target_count == 0) {
+        target_count = std::max<uint64_t>(1, size / DEFAULT_PIXELS_PER_GENERATED_PROVINCE);
+    }
+
+    double weight_per_province = static_cast<double>(total_weight) / target_count;
+
+    for(auto&& region : regions) {
+        auto count = std::llround(region.weight / weight_per_province);
+        region.province_count = std::clamp<uint64_t>(count, 1, region.size);
+    }
+
+    // Scatter the seeds of every region in parallel. Every region has its own
+    //   random stream, so the result does not depend on which thread does it.
+    std::vector<std::vector<Seed>> region_seeds(regions.size());
+    {
+        std::atomic<uint64_t> next_region = 0;
+
+        auto thread_count = std::min<uint64_t>(std::max(std::thread::hardware_concurrency(), 1U),
+                                               regions.size());
+
+        try {
+            std::vector<std::future<void>> futures;
+            for(uint64_t t = 0; t < thread_count; ++t) {
+                futures.push_back(std::async(std::launch::async, [&]() {
+                    for(auto r = next_region++; r < regions.size(); r = next_region++) {
+                        region_seeds[r] = placeSeeds(regions[r], r, width, order,
+                                                     weights, weight_per_province,
+                                                     options.seed);
+                    }
+                }));
+            }
+
+            for(auto&& future : futures) {
+                future.get();
+            }
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(STATUS_BADALLOC);
+        }
+    }
+
+    std::vector<Seed> seeds;
+    for(auto&& rs : region_seeds) {
+        seeds.insert(seeds.end(), rs.begin(), rs.end());
+    }
+    region_seeds.clear();
+
+    order.clear();
+    order.shrink_to_fit();
+
+    WRITE_DEBUG("Placed ", seeds.size(), " seeds in ", regions.size(), " regions.");
+
+    try {
+        for(uint32_t iteration = 0; iteration < options.relaxation_iterations; ++iteration)
+        {
+            assignPixels(dimensions, seeds, region_of, owners);
+            moveSeedsToCentroids(dimensions, owners, weights, region_of, seeds);
+        }
+
+        assignPixels(dimensions, seeds, region_of, owners);
+        makeProvincesContiguous(dimensions, region_of, seeds.size(), owners);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Number the provinces in seed order, skipping any seeds which were left
+    //   without any pixels
+    std::vector<bool> has_pixels(seeds.size(), false);
+    for(auto&& s : owners) {
+        has_pixels[s] = true;
+    }
+
+    GeneratedProvinceMap map;
+    std::vector<uint32_t> seed_to_province(seeds.size(), NO_INDEX);
+
+    // Start over from the beginning of each list, so that the same mask always
+    //   gets the same colors
+    resetUniqueColorGenerator(ProvinceType::LAND);
+    resetUniqueColorGenerator(ProvinceType::SEA);
+    resetUniqueColorGenerator(ProvinceType::LAKE);
+
+    for(uint32_t s = 0; s < seeds.size(); ++s) {
+        if(!has_pixels[s]) {
+            continue;
+        }
+
+        auto type = regions[seeds[s].region].type;
+
+        seed_to_province[s] = map.definitions.size();
+        map.definitions.push_back(ProvinceDefinition{
+            static_cast<uint32_t>(map.definitions.size() + 1),
+            generateUniqueColor(type), type, false, getDefaultTerrain(type), 0
+        });
+    }
+
+    try {
+        map.image.resize(size * 3);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    result = tryParallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        for(auto i = begin; i < end; ++i) {
+            const auto& color = map.definitions[seed_to_province[owners[i]]].color;
+
+            map.image[i * 3] = color.r;
+            map.image[i * 3 + 1] = color.g;
+            map.image[i * 3 + 2] = color.b;
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    WRITE_INFO("Generated ", map.definitions.size(), " provinces in ",
+               regions.size(), " regions of the mask.");
+
+    return map;
+}
+
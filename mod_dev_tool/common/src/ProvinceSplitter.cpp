@@ -0,0 +1,496 @@
+/**
+ * @file ProvinceSplitter.cpp
+ *
+ * @brief Defines functions for splitting a province into several smaller,
+ *        compact pieces.
+ *
+ * @par Pieces are found with Lloyd's algorithm (k-means) over the position of
+ *      every pixel, seeded with farthest point sampling so that the same shape
+ *      is always split the same way. Only an evenly spaced sample of the pixels
+ *      of a large shape is clustered, and every pixel is then given to the
+ *      closest of the resulting centers. k-means knows nothing about the outline
+ *      of the shape, so a piece of a non-convex shape can end up in more than
+ *      one part. Every piece keeps only its largest connected part, and the rest
+ *      is then grown back over by whichever neighboring pieces reach it first.
+ */
+
+#include "ProvinceSplitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Util.h"
+
+namespace {
+    //! Marks a pixel which has not been given a piece yet
+    constexpr uint32_t NO_PIECE = std::numeric_limits<uint32_t>::max();
+
+    //! The most iterations of Lloyd's algorithm which are run for one split
+    constexpr uint32_t MAX_LLOYD_ITERATIONS = 16;
+
+    //! The most pixels of a shape that Lloyd's algorithm is run over
+    constexpr uint64_t MAX_LLOYD_SAMPLES = 1 << 16;
+
+    /**
+     * @brief The center of a single piece
+     */
+    struct Center {
+        double x;
+        double y;
+    };
+
+    double distanceSquared(const HMDT::Point2D& point, const Center& center) noexcept
+    {
+        auto dx = point.x - center.x;
+        auto dy = point.y - center.y;
+
+        return dx * dx + dy * dy;
+    }
+
+    uint32_t findNearestCenter(const HMDT::Point2D& point,
+                               const std::vector<Center>& centers) noexcept
+    {
+        uint32_t nearest = 0;
+        double nearest_distance = std::numeric_limits<double>::infinity();
+
+        for(uint32_t c = 0; c < centers.size(); ++c) {
+            if(auto distance = distanceSquared(point, centers[c]);
+               distance < nearest_distance)
+            {
+                nearest_distance = distance;
+                nearest = c;
+            }
+        }
+
+        return nearest;
+    }
+
+    /**
+     * @brief Picks the starting center of every piece. The first is the pixel
+     *        furthest from the middle of the shape, and every one after that is
+     *        the pixel furthest from all of the centers picked so far.
+     *
+     * @param pixels Every pixel in the shape. Must have at least count pixels.
+     * @param count How many centers to pick
+     *
+     * @return The starting centers
+     */
+    std::vector<Center> seedCenters(const std::vector<HMDT::Point2D>& pixels,
+                                    uint32_t count) noexcept
+    {
+        Center middle{ 0, 0 };
+        for(auto&& pixel : pixels) {
+            middle.x += pixel.x;
+            middle.y += pixel.y;
+        }
+        middle.x /= pixels.size();
+        middle.y /= pixels.size();
+
+        auto furthest = std::max_element(pixels.begin(), pixels.end(),
+                                         [&middle](const auto& p1, const auto& p2) {
+                                             return distanceSquared(p1, middle) < distanceSquared(p2, middle);
+                                         });
+
+        std::vector<Center> centers;
+        centers.reserve(count);
+        centers.push_back(Center{ static_cast<double>(furthest->x),
+                                  static_cast<double>(furthest->y) });
+
+        // The distance from every pixel to the closest center picked so far
+        std::vector<double> closest(pixels.size(),
+                                    std::numeric_limits<double>::infinity());
+
+        while(centers.size() < count) {
+            uint64_t furthest_index = 0;
+            double furthest_distance = -1;
+
+            for(uint64_t i = 0; i < pixels.size(); ++i) {
+                closest[i] = std::min(closest[i],
+                                      distanceSquared(pixels[i], centers.back()));
+
+                if(closest[i] > furthest_distance) {
+                    furthest_distance = closest[i];
+                    furthest_index = i;
+                }
+            }
+
+            centers.push_back(Center{ static_cast<double>(pixels[furthest_index].x),
+                                      static_cast<double>(pixels[furthest_index].y) });
+        }
+
+        return centers;
+    }
+
+    /**
+     * @brief Runs Lloyd's algorithm until no pixel changes pieces, or until
+     *        MAX_LLOYD_ITERATIONS is reached.
+     *
+     * @param pixels Every pixel in the shape
+     * @param centers The center of every piece. Updated as the pieces move.
+     * @param pieces Filled with the piece of every pixel
+     */
+    void runLloyd(const std::vector<HMDT::Point2D>& pixels,
+                  std::vector<Center>& centers,
+                  std::vector<uint32_t>& pieces) noexcept
+    {
+        std::vector<double> sum_x(centers.size());
+        std::vector<double> sum_y(centers.size());
+        std::vector<uint64_t> counts(centers.size());
+
+        pieces.assign(pixels.size(), NO_PIECE);
+
+        for(uint32_t iteration = 0; iteration < MAX_LLOYD_ITERATIONS; ++iteration)
+        {
+            std::fill(sum_x.begin(), sum_x.end(), 0.0);
+            std::fill(sum_y.begin(), sum_y.end(), 0.0);
+            std::fill(counts.begin(), counts.end(), 0);
+
+            bool changed = false;
+
+            for(uint64_t i = 0; i < pixels.size(); ++i) {
+                auto nearest = findNearestCenter(pixels[i], centers);
+
+                if(pieces[i] != nearest) {
+                    pieces[i] = nearest;
+                    changed = true;
+                }
+
+                sum_x[nearest] += pixels[i].x;
+                sum_y[nearest] += pixels[i].y;
+                ++counts[nearest];
+            }
+
+            if(!changed) {
+                break;
+            }
+
+            // A piece which lost all of its pixels keeps its old center
+            for(uint32_t c = 0; c < centers.size(); ++c) {
+                if(counts[c] != 0) {
+                    centers[c] = Center{ sum_x[c] / counts[c], sum_y[c] / counts[c] };
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Makes sure that every piece is a single connected shape.
+     * @details Only the largest connected part of every piece is kept. Every
+     *          other part is handed out, pixel by pixel, to whichever kept
+     *          piece grows into it first. Pixels which are not connected to
+     *          any kept piece (because the shape itself is in more than one
+     *          part) stay where they were.
+     *
+     * @param pixels Every pixel in the shape
+     * @param pieces The piece of every pixel
+     * @param count The number of pieces
+     */
+    void makePiecesContiguous(const std::vector<HMDT::Point2D>& pixels,
+                              std::vector<uint32_t>& pieces,
+                              uint32_t count) noexcept
+    {
+        uint32_t min_x = std::numeric_limits<uint32_t>::max();
+        uint32_t min_y = std::numeric_limits<uint32_t>::max();
+        uint32_t max_x = 0;
+        uint32_t max_y = 0;
+        for(auto&& [x, y] : pixels) {
+            min_x = std::min(min_x, x);
+            min_y = std::min(min_y, y);
+            max_x = std::max(max_x, x);
+            max_y = std::max(max_y, y);
+        }
+
+        // Lay the pixels out in a grid over the bounding box, so that the
+        //   neighbors of a pixel can be looked up directly
+        uint32_t grid_w = max_x - min_x + 1;
+        uint32_t grid_h = max_y - min_y + 1;
+        std::vector<uint32_t> grid(static_cast<uint64_t>(grid_w) * grid_h, NO_PIECE);
+        for(uint32_t i = 0; i < pixels.size(); ++i) {
+            grid[HMDT::xyToIndex(grid_w, pixels[i].x - min_x, pixels[i].y - min_y)] = i;
+        }
+
+        auto forEachNeighbor = [&](uint32_t i, auto&& func) {
+            auto x = pixels[i].x - min_x;
+            auto y = pixels[i].y - min_y;
+
+            if(y > 0) func(grid[HMDT::xyToIndex(grid_w, x, y - 1)]);
+            if(x + 1 < grid_w) func(grid[HMDT::xyToIndex(grid_w, x + 1, y)]);
+            if(y + 1 < grid_h) func(grid[HMDT::xyToIndex(grid_w, x, y + 1)]);
+            if(x > 0) func(grid[HMDT::xyToIndex(grid_w, x - 1, y)]);
+        };
+
+        // Find every connected part of every piece, and the largest one of each
+        std::vector<uint32_t> components(pixels.size(), NO_PIECE);
+        std::vector<uint64_t> component_sizes;
+        std::vector<uint32_t> largest(count, NO_PIECE);
+        std::vector<uint32_t> to_visit;
+
+        for(uint32_t i = 0; i < pixels.size(); ++i) {
+            if(components[i] != NO_PIECE) {
+                continue;
+            }
+
+            uint32_t component = component_sizes.size();
+            component_sizes.push_back(0);
+
+            components[i] = component;
+            to_visit.push_back(i);
+
+            while(!to_visit.empty()) {
+                auto p = to_visit.back();
+                to_visit.pop_back();
+
+                ++component_sizes[component];
+
+                forEachNeighbor(p, [&](uint32_t n) {
+                    if(n != NO_PIECE && components[n] == NO_PIECE &&
+                       pieces[n] == pieces[i])
+                    {
+                        components[n] = component;
+                        to_visit.push_back(n);
+                    }
+                });
+            }
+
+            if(auto& best = largest[pieces[i]];
+               best == NO_PIECE || component_sizes[component] > component_sizes[best])
+            {
+                best = component;
+            }
+        }
+
+        if(component_sizes.size() <= count) {
+            return;
+        }
+
+        auto original_pieces = pieces;
+
+        std::vector<uint32_t> frontier;
+        frontier.reserve(pixels.size());
+        for(uint32_t i = 0; i < pixels.size(); ++i) {
+            if(largest[pieces[i]] == components[i]) {
+                frontier.push_back(i);
+            } else {
+                pieces[i] = NO_PIECE;
+            }
+        }
+
+        // Grow breadth-first so that every kept piece grows at the same rate
+        for(uint64_t head = 0; head < frontier.size(); ++head) {
+            auto p = frontier[head];
+
+            forEachNeighbor(p, [&](uint32_t n) {
+                if(n != NO_PIECE && pieces[n] == NO_PIECE) {
+                    pieces[n] = pieces[p];
+                    frontier.push_back(n);
+                }
+            });
+        }
+
+        for(uint32_t i = 0; i < pixels.size(); ++i) {
+            if(pieces[i] == NO_PIECE) {
+                pieces[i] = original_pieces[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Renumbers the pieces so that there are no gaps between the
+     *        numbers of pieces which still have pixels in them.
+     *
+     * @param pieces The piece of every pixel
+     * @param count The number of pieces before renumbering
+     */
+    void renumberPieces(std::vector<uint32_t>& pieces, uint32_t count) noexcept
+    {
+        std::vector<uint32_t> new_numbers(count, NO_PIECE);
+        uint32_t next = 0;
+
+        for(auto& piece : pieces) {
+            if(new_numbers[piece] == NO_PIECE) {
+                new_numbers[piece] = next++;
+            }
+
+            piece = new_numbers[piece];
+        }
+    }
+
+    /**
+     * @brief Finds every piece of a split shape which is still too large
+     *
+     * @param pixels Every pixel in the shape
+     * @param pieces The piece of every pixel
+     * @param count The number of pieces
+     * @param dimensions The dimensions of the whole map
+     *
+     * @return Whether each piece is too large
+     */
+    std::vector<bool> findOversizedPieces(const std::vector<HMDT::Point2D>& pixels,
+                                          const std::vector<uint32_t>& pieces,
+                                          uint32_t count,
+                                          const HMDT::Dimensions& dimensions) noexcept
+    {
+        std::vector<uint32_t> min_x(count, std::numeric_limits<uint32_t>::max());
+        std::vector<uint32_t> min_y(count, std::numeric_limits<uint32_t>::max());
+        std::vector<uint32_t> max_x(count, 0);
+        std::vector<uint32_t> max_y(count, 0);
+
+        for(uint64_t i = 0; i < pixels.size(); ++i) {
+            auto piece = pieces[i];
+            min_x[piece] = std::min(min_x[piece], pixels[i].x);
+            min_y[piece] = std::min(min_y[piece], pixels[i].y);
+            max_x[piece] = std::max(max_x[piece], pixels[i].x);
+            max_y[piece] = std::max(max_y[piece], pixels[i].y);
+        }
+
+        std::vector<bool> oversized(count, false);
+        for(uint32_t piece = 0; piece < count; ++piece) {
+            oversized[piece] = HMDT::isShapeTooLarge(max_x[piece] - min_x[piece],
+                                                     max_y[piece] - min_y[piece],
+                                                     dimensions);
+        }
+
+        return oversized;
+    }
+}
+
+/**
+ * @brief Splits a shape into compact, connected pieces.
+ *
+ * @param pixels Every pixel in the shape, with no duplicates
+ * @param count How many pieces to split the shape into
+ *
+ * @return The piece of every pixel, numbered from 0 in the order that each
+ *         piece is first seen in pixels. Fewer pieces than asked for may be
+ *         returned if the shape has fewer pixels than that.
+ */
+auto HMDT::partitionShape(const std::vector<Point2D>& pixels,
+                          uint32_t count) noexcept
+    -> std::vector<uint32_t>
+{
+    count = static_cast<uint32_t>(std::min<uint64_t>(count, pixels.size()));
+
+    if(count <= 1) {
+        return std::vector<uint32_t>(pixels.size(), 0);
+    }
+
+    std::vector<uint32_t> pieces;
+
+    // Large shapes only cluster a sample of their pixels, since Lloyd's
+    //   algorithm only needs to know roughly where the pixels are
+    if(pixels.size() > MAX_LLOYD_SAMPLES) {
+        auto stride = (pixels.size() + MAX_LLOYD_SAMPLES - 1) / MAX_LLOYD_SAMPLES;
+
+        std::vector<Point2D> samples;
+        samples.reserve(pixels.size() / stride + 1);
+        for(uint64_t i = 0; i < pixels.size(); i += stride) {
+            samples.push_back(pixels[i]);
+        }
+
+        auto centers = seedCenters(samples, count);
+        runLloyd(samples, centers, pieces);
+
+        pieces.resize(pixels.size());
+        parallelForEachRange(pixels.size(), [&](uint64_t begin, uint64_t end) {
+            for(auto i = begin; i < end; ++i) {
+                pieces[i] = findNearestCenter(pixels[i], centers);
+            }
+        });
+    } else {
+        auto centers = seedCenters(pixels, count);
+        runLloyd(pixels, centers, pieces);
+    }
+
+    makePiecesContiguous(pixels, pieces, count);
+    renumberPieces(pieces, count);
+
+    return pieces;
+}
+
+/**
+ * @brief Splits a shape into compact, connected pieces, none of which are too
+ *        large for the map.
+ * @details The shape is first split into the fewest pieces which could
+ *          possibly fit. Any piece which is still too large after that is then
+ *          split again on its own, so that the rest of the shape does not get
+ *          split any more than it needs to be.
+ *
+ * @param pixels Every pixel in the shape, with no duplicates
+ * @param dimensions The dimensions of the whole map
+ *
+ * @return The piece of every pixel, numbered from 0 with no gaps. Every pixel
+ *         is in piece 0 if the shape is not too large.
+ */
+auto HMDT::partitionOversizedShape(const std::vector<Point2D>& pixels,
+                                   const Dimensions& dimensions) noexcept
+    -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> pieces(pixels.size(), 0);
+
+    if(pixels.empty() || !findOversizedPieces(pixels, pieces, 1, dimensions).front())
+    {
+        return pieces;
+    }
+
+    auto [min_x, max_x] = std::minmax_element(pixels.begin(), pixels.end(),
+                                              [](auto&& p1, auto&& p2) { return p1.x < p2.x; });
+    auto [min_y, max_y] = std::minmax_element(pixels.begin(), pixels.end(),
+                                              [](auto&& p1, auto&& p2) { return p1.y < p2.y; });
+
+    // Every piece must be less than 1/8th of the map across, so a shape which
+    //   is N/8ths of the map across needs at least N+1 pieces. Pieces in the
+    //   middle of a large shape come out roughly hexagonal, which only covers
+    //   about 2/3rds of a square bounding box.
+    double max_width = dimensions.w / 8.0;
+    double max_height = dimensions.h / 8.0;
+    double max_area = std::pow(std::min(max_width, max_height), 2) * 2 / 3;
+
+    uint32_t count = std::max({
+        2U,
+        static_cast<uint32_t>((max_x->x - min_x->x) / max_width) + 1,
+        static_cast<uint32_t>((max_y->y - min_y->y) / max_height) + 1,
+        static_cast<uint32_t>(pixels.size() / max_area) + 1
+    });
+
+    pieces = partitionShape(pixels, count);
+    count = *std::max_element(pieces.begin(), pieces.end()) + 1;
+
+    auto oversized = findOversizedPieces(pixels, pieces, count, dimensions);
+
+    // The index of every pixel in each piece which is still too large
+    std::vector<std::vector<uint64_t>> oversized_indices(count);
+    for(uint64_t i = 0; i < pixels.size(); ++i) {
+        if(oversized[pieces[i]]) {
+            oversized_indices[pieces[i]].push_back(i);
+        }
+    }
+
+    // Every piece is split into at least 2 smaller pieces, so this always
+    //   ends once the pieces get small enough
+    auto next_piece = count;
+    for(auto&& indices : oversized_indices) {
+        if(indices.empty()) {
+            continue;
+        }
+
+        std::vector<Point2D> piece_pixels;
+        piece_pixels.reserve(indices.size());
+        for(auto&& i : indices) {
+            piece_pixels.push_back(pixels[i]);
+        }
+
+        auto sub_pieces = partitionOversizedShape(piece_pixels, dimensions);
+
+        // The first sub-piece keeps the number of the piece it came from
+        for(uint64_t i = 0; i < indices.size(); ++i) {
+            if(sub_pieces[i] != 0) {
+                pieces[indices[i]] = next_piece + sub_pieces[i] - 1;
+            }
+        }
+
+        next_piece += *std::max_element(sub_pieces.begin(), sub_pieces.end());
+    }
+
+    return pieces;
+}
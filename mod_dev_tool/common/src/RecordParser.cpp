@@ -0,0 +1,311 @@
+/**
+ * @file RecordParser.cpp
+ *
+ * @brief Defines a parser for delimited text files, such as the .csv files
+ *        used by both HoI4 and the project files.
+ */
+
+#include "RecordParser.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+/**
+ * @brief Reads an entire file into memory in a single read
+ *
+ * @param path The file to read
+ *
+ * @return The contents of the file, or an error code if it could not be read
+ */
+auto HMDT::readFileToString(const std::filesystem::path& path) noexcept
+    -> Maybe<std::string>
+{
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    RETURN_ERROR_IF(ec.value() != 0, ec);
+
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    std::string contents;
+    try {
+        contents.resize(size);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate ", size, " bytes for ", path, ": ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    if(!in.read(contents.data(), size)) {
+        WRITE_ERROR("Only read ", in.gcount(), " of ", size, " bytes from ", path);
+        RETURN_ERROR(STATUS_READ_TOO_FEW_BYTES);
+    }
+
+    return contents;
+}
+
+/**
+ * @brief Removes spaces and tabs from both ends of a field
+ *
+ * @param field The field to trim
+ *
+ * @return The trimmed field
+ */
+std::string_view HMDT::trimField(std::string_view field) noexcept {
+    auto begin = field.find_first_not_of(" \t");
+    if(begin == std::string_view::npos) {
+        return std::string_view{};
+    }
+
+    auto end = field.find_last_not_of(" \t");
+    return field.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Decodes a text field, as-is
+ */
+bool HMDT::decodeField(std::string_view field, std::string& result) noexcept {
+    try {
+        result.assign(field);
+    } catch(const std::bad_alloc&) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decodes a text field as a view into the buffer being parsed. The
+ *        result is only valid for as long as that buffer is.
+ */
+bool HMDT::decodeField(std::string_view field, std::string_view& result) noexcept
+{
+    result = field;
+    return true;
+}
+
+/**
+ * @brief Decodes a boolean field, which may be either true/false or 1/0
+ */
+bool HMDT::decodeField(std::string_view field, bool& result) noexcept {
+    field = trimField(field);
+
+    if(field == "true" || field == "1") {
+        result = true;
+    } else if(field == "false" || field == "0") {
+        result = false;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decodes a floating point field
+ */
+bool HMDT::decodeField(std::string_view field, float& result) noexcept {
+    field = trimField(field);
+
+    float value;
+    auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(),
+                                     value);
+    if(ec != std::errc() || end != field.data() + field.size()) {
+        return false;
+    }
+
+    result = value;
+    return true;
+}
+
+/**
+ * @brief Decodes a floating point field
+ */
+bool HMDT::decodeField(std::string_view field, double& result) noexcept {
+    field = trimField(field);
+
+    double value;
+    auto [end, ec] = std::from_chars(field.data(), field.data() + field.size(),
+                                     value);
+    if(ec != std::errc() || end != field.data() + field.size()) {
+        return false;
+    }
+
+    result = value;
+    return true;
+}
+
+/**
+ * @brief Decodes a province type field. Anything which is not a known type is
+ *        decoded as ProvinceType::UNKNOWN.
+ */
+bool HMDT::decodeField(std::string_view field, ProvinceType& result) noexcept {
+    field = trimField(field);
+
+    if(field == "land") {
+        result = ProvinceType::LAND;
+    } else if(field == "sea") {
+        result = ProvinceType::SEA;
+    } else if(field == "lake") {
+        result = ProvinceType::LAKE;
+    } else {
+        result = ProvinceType::UNKNOWN;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decodes a UUID field, which must be in the form
+ *        "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX"
+ */
+bool HMDT::decodeField(std::string_view field, UUID& result) noexcept {
+    field = trimField(field);
+
+    if(field.size() != UUID::STRING_REPR_LENGTH) {
+        return false;
+    }
+
+    // Copy the field onto the stack, as the system functions need it to be
+    //   null-terminated
+    char uuid_str[UUID::STRING_REPR_LENGTH + 1];
+    for(std::size_t i = 0; i < field.size(); ++i) {
+        auto c = field[i];
+
+        bool is_dash = (i == 8 || i == 13 || i == 18 || i == 23);
+        if(is_dash ? (c != '-') : (std::isxdigit(static_cast<unsigned char>(c)) == 0))
+        {
+            return false;
+        }
+
+        uuid_str[i] = c;
+    }
+    uuid_str[UUID::STRING_REPR_LENGTH] = '\0';
+
+    auto uuid = UUID::parse(uuid_str);
+    if(IS_FAILURE(uuid)) {
+        return false;
+    }
+
+    result = *uuid;
+    return true;
+}
+
+/**
+ * @brief Creates a new RecordParser. No records are parsed until nextRecord is
+ *        called.
+ *
+ * @param buffer The text to parse. Must outlive this parser.
+ * @param delim The delimiter between each field of a record
+ */
+HMDT::RecordParser::RecordParser(std::string_view buffer, char delim) noexcept:
+    m_buffer(buffer),
+    m_delim(delim),
+    m_next_record_offset(0),
+    m_record(),
+    m_field_offset(std::string_view::npos),
+    m_line_number(0),
+    m_allow_trailing_characters(false)
+{ }
+
+/**
+ * @brief Moves onto the next non-empty record
+ *
+ * @return True if there was another record, false if the end of the buffer has
+ *         been reached.
+ */
+bool HMDT::RecordParser::nextRecord() noexcept {
+    while(m_next_record_offset < m_buffer.size()) {
+        auto end = m_buffer.find('\n', m_next_record_offset);
+        if(end == std::string_view::npos) {
+            end = m_buffer.size();
+        }
+
+        auto record = m_buffer.substr(m_next_record_offset,
+                                      end - m_next_record_offset);
+        m_next_record_offset = end + 1;
+        ++m_line_number;
+
+        if(!record.empty() && record.back() == '\r') {
+            record.remove_suffix(1);
+        }
+
+        if(record.empty()) continue;
+
+        m_record = record;
+        m_field_offset = 0;
+        return true;
+    }
+
+    m_record = std::string_view{};
+    m_field_offset = std::string_view::npos;
+    return false;
+}
+
+/**
+ * @brief Checks if the current record has any fields left to parse. Note that
+ *        a record ending in a delimiter has one more, empty field after it.
+ */
+bool HMDT::RecordParser::hasMoreFields() const noexcept {
+    return m_field_offset != std::string_view::npos;
+}
+
+/**
+ * @brief Gets the whole of the current record
+ */
+std::string_view HMDT::RecordParser::getRecord() const noexcept {
+    return m_record;
+}
+
+/**
+ * @brief Gets the 1-based line number of the current record
+ */
+std::size_t HMDT::RecordParser::getLineNumber() const noexcept {
+    return m_line_number;
+}
+
+/**
+ * @brief Gets the 1-based column where the next field starts. If there are no
+ *        more fields, then this is the column just past the end of the record.
+ */
+std::size_t HMDT::RecordParser::getColumnNumber() const noexcept {
+    return (hasMoreFields() ? m_field_offset : m_record.size()) + 1;
+}
+
+/**
+ * @brief Sets whether numbers may be followed by other characters in the same
+ *        field. This is how files written by older versions of the tool were
+ *        parsed, so it should be allowed when loading those.
+ *
+ * @param allow Whether to ignore anything following a number, with a warning,
+ *              instead of failing
+ */
+void HMDT::RecordParser::setAllowTrailingCharacters(bool allow) noexcept {
+    m_allow_trailing_characters = allow;
+}
+
+/**
+ * @brief Splits the next field off of the current record. Must only be called
+ *        if hasMoreFields() is true.
+ *
+ * @return The next field
+ */
+std::string_view HMDT::RecordParser::nextField() noexcept {
+    std::string_view field;
+
+    auto end = m_record.find(m_delim, m_field_offset);
+    if(end == std::string_view::npos) {
+        field = m_record.substr(m_field_offset);
+        m_field_offset = std::string_view::npos;
+    } else {
+        field = m_record.substr(m_field_offset, end - m_field_offset);
+        m_field_offset = end + 1;
+    }
+
+    return field;
+}
+
@@ -0,0 +1,116 @@
+/**
+ * @file RecordWriter.cpp
+ *
+ * @brief Defines a writer for delimited text files, such as the .csv files
+ *        used by both HoI4 and the project files.
+ */
+
+#include "RecordWriter.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+/**
+ * @brief Encodes a text field, as-is
+ */
+void HMDT::encodeField(std::string& buffer, std::string_view value) {
+    buffer.append(value);
+}
+
+/**
+ * @brief Encodes a text field, as-is
+ */
+void HMDT::encodeField(std::string& buffer, const char* value) {
+    buffer.append(value);
+}
+
+/**
+ * @brief Encodes a boolean field as either true or false
+ */
+void HMDT::encodeField(std::string& buffer, bool value) {
+    buffer.append(value ? "true" : "false");
+}
+
+/**
+ * @brief Encodes a province type field, in the same way as it is output into a
+ *        stream.
+ */
+void HMDT::encodeField(std::string& buffer, ProvinceType value) {
+    switch(value) {
+        case ProvinceType::LAND:
+            buffer.append("land");
+            break;
+        case ProvinceType::LAKE:
+            buffer.append("lake");
+            break;
+        case ProvinceType::SEA:
+            buffer.append("sea");
+            break;
+        case ProvinceType::UNKNOWN:
+        default:
+            buffer.append("UNKNOWN{");
+            encodeField(buffer, static_cast<int>(value));
+            buffer.push_back('}');
+            break;
+    }
+}
+
+/**
+ * @brief Encodes a UUID field, in the form "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX"
+ */
+void HMDT::encodeField(std::string& buffer, const UUID& value) {
+    char str[UUID::STRING_REPR_LENGTH + 1];
+    value.toChars(str);
+
+    buffer.append(str, UUID::STRING_REPR_LENGTH);
+}
+
+/**
+ * @brief Creates a new RecordWriter
+ *
+ * @param buffer The buffer to append every record to. Must outlive this writer.
+ * @param delim The delimiter between each field of a record
+ */
+HMDT::RecordWriter::RecordWriter(std::string& buffer, char delim) noexcept:
+    m_buffer(buffer),
+    m_delim(delim),
+    m_at_record_start(true)
+{ }
+
+/**
+ * @brief Ends the current record, so that the next field starts a new one
+ */
+void HMDT::RecordWriter::endRecord() {
+    m_buffer.push_back('\n');
+    m_at_record_start = true;
+}
+
+/**
+ * @brief Writes every buffer into a file, in order, with one write each
+ *
+ * @param path The file to write to
+ * @param buffers The buffers to write
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the file could not be
+ *         written.
+ */
+auto HMDT::writeBuffersToFile(const std::filesystem::path& path,
+                              const std::vector<std::string>& buffers) noexcept
+    -> MaybeVoid
+{
+    std::ofstream out(path);
+    if(!out) {
+        WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    for(auto&& buffer : buffers) {
+        if(!out.write(buffer.data(), buffer.size())) {
+            WRITE_ERROR("Failed to write ", buffer.size(), " bytes to ", path);
+            RETURN_ERROR(std::make_error_code(std::errc::io_error));
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
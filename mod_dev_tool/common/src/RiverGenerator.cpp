@@ -0,0 +1,398 @@
+/**
+ * @file RiverGenerator.cpp
+ *
+ * @brief Defines functions for generating rivers from a heightmap.
+ *
+ * @par Depressions are filled and flow directions assigned in a single pass
+ *      with the "Priority-Flood" algorithm by Barnes, Lehman and Mulla. As
+ *      heights are only 8 bits, the priority queue is a queue per height,
+ *      which makes the whole pass linear.
+ */
+
+#include "RiverGenerator.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "Logger.h"
+
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks that a pixel is not a part of any river
+    constexpr uint32_t NO_PIXEL = std::numeric_limits<uint32_t>::max();
+
+    //! Marks that water does not flow anywhere out of a pixel
+    constexpr uint8_t NO_DIRECTION = 4;
+
+    //! The shortest a river can be, so that its source and its end are never
+    //!   on the same pixel
+    constexpr size_t MIN_RIVER_LENGTH = 3;
+
+    /**
+     * @brief What kind of ground every pixel is
+     */
+    enum class Ground: uint8_t {
+        LAND,
+        WATER,
+        UNKNOWN
+    };
+
+    /**
+     * @brief A river which still has to be traced
+     */
+    struct Branch {
+        uint32_t catchment; //!< How many pixels drain through the first pixel
+        uint32_t start; //!< The first (furthest downstream) pixel
+        uint32_t junction; //!< The pixel of the river this flows into, if any
+
+        /**
+         * @brief Orders branches so that the largest ones are traced first.
+         *        Ties are broken on the pixel, so the output is stable.
+         */
+        bool operator<(const Branch& other) const {
+            return std::tie(catchment, other.start) <
+                   std::tie(other.catchment, start);
+        }
+    };
+
+    /**
+     * @brief Gets the pixel next to another one in a given direction.
+     *
+     * @param width The width of the map
+     * @param height The height of the map
+     * @param index The pixel to start from
+     * @param direction 0 for north, 1 for east, 2 for south, and 3 for west
+     *
+     * @return The neighboring pixel, or NO_PIXEL if it is off of the map
+     */
+    uint32_t neighbor(uint32_t width, uint32_t height, uint32_t index,
+                      uint8_t direction)
+    {
+        auto x = index % width;
+        auto y = index / width;
+
+        switch(direction) {
+            case 0: return (y == 0) ? NO_PIXEL : index - width;
+            case 1: return (x + 1 == width) ? NO_PIXEL : index + 1;
+            case 2: return (y + 1 == height) ? NO_PIXEL : index + width;
+            case 3: return (x == 0) ? NO_PIXEL : index - 1;
+            default: return NO_PIXEL;
+        }
+    }
+
+    /**
+     * @brief Gets which direction is the opposite of another.
+     */
+    constexpr uint8_t opposite(uint8_t direction) {
+        return (direction + 2) % 4;
+    }
+
+    /**
+     * @brief Picks the width of a river based on how much water flows through
+     *        it.
+     * @details Every doubling of the catchment makes the river one step wider.
+     *
+     * @param catchment How many pixels drain through the river pixel
+     * @param min_catchment How many pixels drain through the narrowest river
+     *
+     * @return The rivers color index for the river pixel
+     */
+    uint8_t riverWidth(uint32_t catchment, uint32_t min_catchment) {
+        uint8_t width = HMDT::RIVER_NARROWEST_INDEX;
+        for(auto ratio = catchment / min_catchment;
+            ratio > 1 && width < HMDT::RIVER_WIDEST_INDEX;
+            ratio >>= 1)
+        {
+            ++width;
+        }
+
+        return width;
+    }
+}
+
+/**
+ * @brief Generates a river network by simulating where rain would flow over
+ *        the heightmap.
+ * @details Every sea and lake pixel is an outlet. Starting from the outlets,
+ *          the heightmap is flooded upwards, lowest pixels first. Every pixel
+ *          drains into whichever neighbor flooded it, which routes water over
+ *          flat areas and out of depressions without needing to modify the
+ *          heightmap. If the map has no water at all, the edges of the map are
+ *          used as the outlets instead.
+ *
+ *          Walking the flood order backwards then gives how many pixels drain
+ *          through every pixel. Rivers are traced upstream from the coast
+ *          wherever at least min_catchment pixels drain through, always
+ *          following the largest stream, with the smaller streams becoming
+ *          tributaries. A river is cut short where it would touch another
+ *          river (or itself), so that every river stays 1 pixel wide.
+ *
+ *          Water is only ever routed between the 4 orthogonal neighbors, as
+ *          HoI4 requires rivers to be connected along their edges.
+ *
+ *          Every river starts with a source pixel, and tributaries end with a
+ *          flow-in pixel next to the river they join. As every pixel only
+ *          drains into a single neighbor, rivers never split and so no
+ *          flow-out pixels are needed.
+ *
+ * @param dimensions The dimensions of the map
+ * @param heightmap The height of every pixel of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param provinces Every province on the map
+ * @param min_catchment How many pixels must drain through a pixel for it to be
+ *                      a river
+ * @param rivers Where to write the rivers map. Must be as large as the map.
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::generateRivers(const Dimensions& dimensions,
+                          const uint8_t* heightmap,
+                          const ProvinceID* province_matrix,
+                          const ProvinceList& provinces,
+                          uint32_t min_catchment,
+                          uint8_t* rivers)
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(heightmap == nullptr || province_matrix == nullptr ||
+                    rivers == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF(min_catchment == 0, STATUS_INVALID_VALUE);
+
+    auto width = dimensions.w;
+    auto height = dimensions.h;
+    uint64_t size = static_cast<uint64_t>(width) * height;
+
+    if(size == 0) {
+        return STATUS_SUCCESS;
+    }
+
+    RETURN_ERROR_IF(size >= NO_PIXEL, STATUS_INVALID_VALUE);
+
+    std::vector<Ground> ground;
+    std::vector<uint8_t> directions;
+    std::vector<uint32_t> catchments;
+    try {
+        ground.resize(size);
+        directions.resize(size, NO_DIRECTION);
+        catchments.resize(size, 0);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for the flow simulation: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Pass 1: What kind of ground every pixel is
+    auto ground_of = [&provinces](const ProvinceID& id) {
+        if(auto it = provinces.find(id); it != provinces.end()) {
+            switch(it->second.type) {
+                case ProvinceType::LAND:
+                    return Ground::LAND;
+                case ProvinceType::SEA:
+                case ProvinceType::LAKE:
+                    return Ground::WATER;
+                case ProvinceType::UNKNOWN:
+                    break;
+            }
+        }
+
+        return Ground::UNKNOWN;
+    };
+
+    parallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        CachedProvinceLookup cached(ground_of);
+
+        for(auto index = begin; index < end; ++index) {
+            ground[index] = cached(province_matrix[index]);
+
+            switch(ground[index]) {
+                case Ground::LAND:
+                    rivers[index] = RIVER_LAND_INDEX;
+                    break;
+                case Ground::WATER:
+                    rivers[index] = RIVER_WATER_INDEX;
+                    break;
+                case Ground::UNKNOWN:
+                    rivers[index] = RIVER_UNKNOWN_INDEX;
+                    break;
+            }
+        }
+    });
+
+    // Pass 2: Flood the map from the outlets upwards. As a pixel is never
+    //   flooded at a lower level than the one which flooded it, reading the
+    //   queues back in order gives the order the pixels were flooded in.
+    std::vector<std::vector<uint32_t>> levels(256);
+    std::vector<bool> flooded(size, false);
+
+    for(uint32_t index = 0; index < size; ++index) {
+        if(ground[index] == Ground::WATER) {
+            flooded[index] = true;
+            levels[0].push_back(index);
+        }
+    }
+
+    if(levels[0].empty()) {
+        for(uint32_t index = 0; index < size; ++index) {
+            auto x = index % width;
+            auto y = index / width;
+            if(x == 0 || y == 0 || x + 1 == width || y + 1 == height) {
+                flooded[index] = true;
+                levels[heightmap[index]].push_back(index);
+            }
+        }
+    }
+
+    for(uint32_t level = 0; level < levels.size(); ++level) {
+        // The queue may grow while it is being read, so don't hold onto any
+        //   references into it
+        for(size_t i = 0; i < levels[level].size(); ++i) {
+            auto index = levels[level][i];
+
+            for(uint8_t d = 0; d < 4; ++d) {
+                auto next = neighbor(width, height, index, d);
+                if(next == NO_PIXEL || flooded[next]) continue;
+
+                flooded[next] = true;
+                directions[next] = opposite(d);
+                levels[std::max<uint32_t>(heightmap[next], level)].push_back(next);
+            }
+        }
+    }
+
+    // Pass 3: How many pixels drain through every pixel, by walking the flood
+    //   order backwards so that every pixel is done before the one it drains
+    //   into
+    for(uint32_t level = levels.size(); level-- > 0; ) {
+        for(auto it = levels[level].rbegin(); it != levels[level].rend(); ++it) {
+            auto index = *it;
+            if(ground[index] == Ground::WATER) continue;
+
+            catchments[index] += 1;
+
+            if(auto d = directions[index]; d != NO_DIRECTION) {
+                catchments[neighbor(width, height, index, d)] += catchments[index];
+            }
+        }
+    }
+
+    // Free up the flood queues before tracing
+    levels.clear();
+    levels.shrink_to_fit();
+
+    // Pass 4: Trace the rivers upstream from the coast, largest first
+    auto is_river = [rivers](uint32_t index) {
+        return rivers[index] <= RIVER_WIDEST_INDEX;
+    };
+    auto drains_into = [&](uint32_t index) {
+        return neighbor(width, height, index, directions[index]);
+    };
+
+    std::priority_queue<Branch> branches;
+    for(uint32_t index = 0; index < size; ++index) {
+        if(ground[index] != Ground::LAND || catchments[index] < min_catchment) {
+            continue;
+        }
+
+        // Rivers start wherever they meet the sea, or the edge of the map if
+        //   there is no sea
+        if(auto d = directions[index]; d == NO_DIRECTION ||
+                                       ground[drains_into(index)] == Ground::WATER)
+        {
+            branches.push({ catchments[index], index, NO_PIXEL });
+        }
+    }
+
+    std::vector<bool> has_tributary(size, false);
+
+    size_t river_count = 0;
+    while(!branches.empty()) {
+        auto branch = branches.top();
+        branches.pop();
+
+        // Only one tributary may join at each pixel, and never at the source
+        //   or end of another tributary
+        if(branch.junction != NO_PIXEL &&
+           (has_tributary[branch.junction] ||
+            rivers[branch.junction] < RIVER_NARROWEST_INDEX))
+        {
+            continue;
+        }
+
+        std::vector<uint32_t> path;
+        std::vector<Branch> tributaries;
+
+        auto previous = branch.junction;
+        auto current = branch.start;
+        while(current != NO_PIXEL && !is_river(current)) {
+            // Don't touch any other river, or any other part of this one
+            bool touches = false;
+            for(uint8_t d = 0; d < 4 && !touches; ++d) {
+                auto next = neighbor(width, height, current, d);
+                touches = next != NO_PIXEL && next != previous && is_river(next);
+            }
+            if(touches) break;
+
+            path.push_back(current);
+            rivers[current] = riverWidth(catchments[current], min_catchment);
+
+            // Keep following the largest stream which flows in here, and leave
+            //   the rest for later
+            auto upstream = NO_PIXEL;
+            for(uint8_t d = 0; d < 4; ++d) {
+                auto next = neighbor(width, height, current, d);
+                if(next == NO_PIXEL || ground[next] != Ground::LAND ||
+                   directions[next] != opposite(d) ||
+                   catchments[next] < min_catchment)
+                {
+                    continue;
+                }
+
+                if(upstream == NO_PIXEL ||
+                   catchments[next] > catchments[upstream] ||
+                   (catchments[next] == catchments[upstream] && next < upstream))
+                {
+                    if(upstream != NO_PIXEL) {
+                        tributaries.push_back({ catchments[upstream], upstream, current });
+                    }
+                    upstream = next;
+                } else {
+                    tributaries.push_back({ catchments[next], next, current });
+                }
+            }
+
+            previous = current;
+            current = upstream;
+        }
+
+        // Too short to fit its markers in, so drop it and everything which
+        //   would have flowed into it
+        if(path.size() < MIN_RIVER_LENGTH) {
+            for(auto&& index : path) {
+                rivers[index] = RIVER_LAND_INDEX;
+            }
+            continue;
+        }
+
+        rivers[path.back()] = RIVER_SOURCE_INDEX;
+        if(branch.junction != NO_PIXEL) {
+            rivers[path.front()] = RIVER_FLOW_IN_INDEX;
+            has_tributary[branch.junction] = true;
+        }
+
+        for(auto&& tributary : tributaries) {
+            branches.push(tributary);
+        }
+
+        ++river_count;
+    }
+
+    WRITE_DEBUG("Generated ", river_count, " rivers.");
+
+    return STATUS_SUCCESS;
+}
+
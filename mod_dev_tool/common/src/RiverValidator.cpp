@@ -0,0 +1,295 @@
+/**
+ * @file RiverValidator.cpp
+ *
+ * @brief Defines functions for finding mistakes in a rivers map which HoI4
+ *        would either crash on or silently not draw.
+ */
+
+#include "RiverValidator.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <tuple>
+
+#include "Logger.h"
+
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a pixel which is not a part of any river
+    constexpr uint32_t NO_COMPONENT = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief Checks if a pixel at an offset from another one is on the map.
+     */
+    bool isOnMap(uint32_t width, uint32_t height, uint32_t x, uint32_t y,
+                 int32_t dx, int32_t dy)
+    {
+        return !(dx < 0 && x == 0) && !(dy < 0 && y == 0) &&
+               !(dx > 0 && x + 1 == width) && !(dy > 0 && y + 1 == height);
+    }
+}
+
+/**
+ * @brief Finds every mistake in a rivers map which would stop HoI4 from
+ *        drawing the rivers correctly.
+ * @details Every group of connected river pixels is a single river system,
+ *          made up of one main river and every tributary joining it. Each of
+ *          those needs its own source, and each tributary ends in a flow-in
+ *          marker, so a system needs exactly one more source than it has
+ *          flow-in markers. Besides that, river pixels may never form a 2x2
+ *          block, never touch only diagonally, and every end of a river which
+ *          is not a marker has to touch a sea or a lake.
+ *
+ *          Pixels are classified and river systems are found in time linear to
+ *          the size of the map, and then every river system is checked in
+ *          parallel.
+ *
+ * @param dimensions The dimensions of the map
+ * @param rivers The rivers map
+ * @param palette What color index every value in the rivers map stands for
+ * @param province_matrix The province of every pixel of the map
+ * @param provinces Every province on the map
+ *
+ * @return Every mistake found, ordered by position.
+ */
+auto HMDT::validateRivers(const Dimensions& dimensions,
+                          const uint8_t* rivers,
+                          const RiverPalette& palette,
+                          const ProvinceID* province_matrix,
+                          const ProvinceList& provinces)
+    -> Maybe<std::vector<RiverIssue>>
+{
+    RETURN_ERROR_IF(rivers == nullptr || province_matrix == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto width = dimensions.w;
+    auto height = dimensions.h;
+    uint64_t size = static_cast<uint64_t>(width) * height;
+
+    std::vector<RiverIssue> issues;
+    std::mutex issues_mutex;
+
+    if(size == 0) {
+        return issues;
+    }
+
+    RETURN_ERROR_IF(size >= NO_COMPONENT, STATUS_INVALID_VALUE);
+
+    auto color_at = [&](uint32_t index) {
+        return palette[rivers[index]];
+    };
+    auto is_river = [&](uint32_t index) {
+        return color_at(index) <= RIVER_WIDEST_INDEX;
+    };
+    auto is_river_at = [&](uint32_t x, uint32_t y) {
+        return is_river(xyToIndex(width, x, y));
+    };
+
+    // Pass 1: Find every river pixel, and every pixel which isn't a valid color
+    std::vector<std::vector<uint32_t>> range_river_pixels;
+    std::mutex river_pixels_mutex;
+
+    parallelForEachRange(size, [&](uint64_t begin, uint64_t end) {
+        std::vector<uint32_t> river_pixels;
+        std::vector<RiverIssue> local_issues;
+
+        for(auto index = begin; index < end; ++index) {
+            auto color = color_at(index);
+
+            if(color == INVALID_RIVER_COLOR) {
+                local_issues.push_back({
+                    RiverIssueType::INVALID_COLOR,
+                    Point2D{ static_cast<uint32_t>(index % width),
+                             static_cast<uint32_t>(index / width) }
+                });
+            } else if(color <= RIVER_WIDEST_INDEX) {
+                river_pixels.push_back(index);
+            }
+        }
+
+        std::scoped_lock lock(river_pixels_mutex, issues_mutex);
+        range_river_pixels.push_back(std::move(river_pixels));
+        issues.insert(issues.end(), local_issues.begin(), local_issues.end());
+    });
+
+    std::vector<uint32_t> river_pixels;
+    for(auto&& pixels : range_river_pixels) {
+        river_pixels.insert(river_pixels.end(), pixels.begin(), pixels.end());
+    }
+    range_river_pixels.clear();
+    std::sort(river_pixels.begin(), river_pixels.end());
+
+    // Pass 2: Group the river pixels into river systems. Every system is
+    //   stored contiguously, starting from its first pixel on the map.
+    std::vector<uint32_t> components(size, NO_COMPONENT);
+    std::vector<uint32_t> ordered_pixels;
+    std::vector<size_t> offsets;
+    ordered_pixels.reserve(river_pixels.size());
+
+    for(auto&& start : river_pixels) {
+        if(components[start] != NO_COMPONENT) continue;
+
+        auto component = static_cast<uint32_t>(offsets.size());
+        offsets.push_back(ordered_pixels.size());
+
+        components[start] = component;
+        ordered_pixels.push_back(start);
+
+        for(size_t i = offsets.back(); i < ordered_pixels.size(); ++i) {
+            auto index = ordered_pixels[i];
+            auto x = index % width;
+            auto y = index / width;
+
+            for(auto [dx, dy] : { std::pair{ 0, -1 }, std::pair{ 1, 0 },
+                                  std::pair{ 0, 1 }, std::pair{ -1, 0 } })
+            {
+                if(!isOnMap(width, height, x, y, dx, dy)) continue;
+
+                auto next = xyToIndex(width, x + dx, y + dy);
+                if(is_river(next) && components[next] == NO_COMPONENT) {
+                    components[next] = component;
+                    ordered_pixels.push_back(next);
+                }
+            }
+        }
+    }
+    offsets.push_back(ordered_pixels.size());
+
+    auto is_water = [&](uint32_t index) {
+        auto it = provinces.find(province_matrix[index]);
+        return it != provinces.end() && (it->second.type == ProvinceType::SEA ||
+                                         it->second.type == ProvinceType::LAKE);
+    };
+
+    // Pass 3: Check every river system on its own
+    parallelForEachRange(offsets.size() - 1, [&](uint64_t begin, uint64_t end) {
+        std::vector<RiverIssue> local_issues;
+
+        for(auto c = begin; c < end; ++c) {
+            std::vector<uint32_t> sources;
+            uint32_t flow_ins = 0;
+
+            for(auto i = offsets[c]; i < offsets[c + 1]; ++i) {
+                auto index = ordered_pixels[i];
+                uint32_t x = index % width;
+                uint32_t y = index / width;
+                auto color = color_at(index);
+
+                if(color == RIVER_SOURCE_INDEX) {
+                    sources.push_back(index);
+                } else if(color == RIVER_FLOW_IN_INDEX) {
+                    ++flow_ins;
+                }
+
+                // Only look right and down, so each block and each diagonal is
+                //   only reported once
+                bool right = isOnMap(width, height, x, y, 1, 0) && is_river_at(x + 1, y);
+                bool down = isOnMap(width, height, x, y, 0, 1) && is_river_at(x, y + 1);
+                bool left = isOnMap(width, height, x, y, -1, 0) && is_river_at(x - 1, y);
+                bool up = isOnMap(width, height, x, y, 0, -1) && is_river_at(x, y - 1);
+
+                if(right && down && is_river_at(x + 1, y + 1)) {
+                    local_issues.push_back({ RiverIssueType::BLOB, Point2D{ x, y } });
+                }
+
+                if(!right && !down && isOnMap(width, height, x, y, 1, 1) &&
+                   is_river_at(x + 1, y + 1))
+                {
+                    local_issues.push_back({ RiverIssueType::DIAGONAL_CONNECTION, Point2D{ x, y } });
+                }
+
+                if(!left && !down && isOnMap(width, height, x, y, -1, 1) &&
+                   is_river_at(x - 1, y + 1))
+                {
+                    local_issues.push_back({ RiverIssueType::DIAGONAL_CONNECTION, Point2D{ x, y } });
+                }
+
+                // Markers are allowed to be the end of a river, anything else
+                //   has to run into the sea or a lake
+                auto neighbors = right + down + left + up;
+                if(neighbors <= 1 && color >= RIVER_NARROWEST_INDEX) {
+                    bool reaches_water = false;
+                    for(auto [dx, dy] : { std::pair{ 0, -1 }, std::pair{ 1, 0 },
+                                          std::pair{ 0, 1 }, std::pair{ -1, 0 } })
+                    {
+                        if(isOnMap(width, height, x, y, dx, dy) &&
+                           is_water(xyToIndex(width, x + dx, y + dy)))
+                        {
+                            reaches_water = true;
+                            break;
+                        }
+                    }
+
+                    if(!reaches_water) {
+                        local_issues.push_back({ RiverIssueType::INLAND_END, Point2D{ x, y } });
+                    }
+                }
+            }
+
+            // One source for the main river, and one for every tributary
+            auto expected_sources = flow_ins + 1;
+            if(sources.size() < expected_sources) {
+                auto first = ordered_pixels[offsets[c]];
+                local_issues.push_back({
+                    RiverIssueType::MISSING_SOURCE,
+                    Point2D{ first % width, first / width }
+                });
+            } else if(sources.size() > expected_sources) {
+                std::sort(sources.begin(), sources.end());
+                for(auto i = expected_sources; i < sources.size(); ++i) {
+                    local_issues.push_back({
+                        RiverIssueType::EXTRA_SOURCE,
+                        Point2D{ sources[i] % width, sources[i] / width }
+                    });
+                }
+            }
+        }
+
+        std::lock_guard lock(issues_mutex);
+        issues.insert(issues.end(), local_issues.begin(), local_issues.end());
+    });
+
+    std::sort(issues.begin(), issues.end(),
+              [](const RiverIssue& i1, const RiverIssue& i2) {
+                  return std::tie(i1.position.y, i1.position.x, i1.type) <
+                         std::tie(i2.position.y, i2.position.x, i2.type);
+              });
+
+    WRITE_DEBUG("Found ", issues.size(), " issues in ", offsets.size() - 1,
+                " river systems.");
+
+    return issues;
+}
+
+/**
+ * @brief Outputs a description of a river issue type into a stream
+ *
+ * @param stream The stream to output into
+ * @param type The river issue type to output
+ *
+ * @return The given stream after output.
+ */
+std::ostream& HMDT::operator<<(std::ostream& stream, const RiverIssueType& type)
+{
+    switch(type) {
+        case RiverIssueType::INVALID_COLOR:
+            return stream << "Color is not in the rivers palette";
+        case RiverIssueType::MISSING_SOURCE:
+            return stream << "River is missing a source";
+        case RiverIssueType::EXTRA_SOURCE:
+            return stream << "River has too many sources";
+        case RiverIssueType::BLOB:
+            return stream << "River is more than 1 pixel wide";
+        case RiverIssueType::DIAGONAL_CONNECTION:
+            return stream << "River pixels only touch diagonally";
+        case RiverIssueType::INLAND_END:
+            return stream << "River ends inland without a marker";
+    }
+
+    return stream;
+}
+
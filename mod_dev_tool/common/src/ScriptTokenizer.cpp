@@ -0,0 +1,246 @@
+/**
+ * @file ScriptTokenizer.cpp
+ *
+ * @brief Defines a tokenizer for the script files used by HoI4, such as the
+ *        state history files.
+ */
+
+#include "ScriptTokenizer.h"
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+
+namespace {
+    //! The UTF-8 byte order mark which some script files start with
+    constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+
+    bool isSpace(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' ||
+               c == '\v';
+    }
+
+    /**
+     * @brief Checks if a character ends a bare word
+     */
+    bool isWordBreak(char c) noexcept {
+        return isSpace(c) || c == '=' || c == '<' || c == '>' || c == '{' ||
+               c == '}' || c == '"' || c == '#';
+    }
+}
+
+/**
+ * @brief Creates a new ScriptTokenizer. No tokens are read until next or peek
+ *        is called.
+ *
+ * @param buffer The script to tokenize. Must outlive this tokenizer.
+ */
+HMDT::ScriptTokenizer::ScriptTokenizer(std::string_view buffer) noexcept:
+    m_buffer(buffer),
+    m_offset(0),
+    m_line(1),
+    m_line_start(0),
+    m_peeked()
+{
+    if(m_buffer.substr(0, UTF8_BOM.size()) == UTF8_BOM) {
+        m_offset = m_line_start = UTF8_BOM.size();
+    }
+}
+
+/**
+ * @brief Reads the next token, consuming it
+ *
+ * @return The next token, or a token of type END_OF_FILE if there are none left
+ */
+auto HMDT::ScriptTokenizer::next() noexcept -> ScriptToken {
+    if(m_peeked) {
+        auto token = *m_peeked;
+        m_peeked.reset();
+        return token;
+    }
+
+    return lex();
+}
+
+/**
+ * @brief Looks at the next token, without consuming it
+ *
+ * @return The next token, or a token of type END_OF_FILE if there are none left
+ */
+auto HMDT::ScriptTokenizer::peek() noexcept -> const ScriptToken& {
+    if(!m_peeked) {
+        m_peeked = lex();
+    }
+
+    return *m_peeked;
+}
+
+/**
+ * @brief Skips over a whole value, which is either a single word or string, or
+ *        an entire block including every block nested inside of it.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the value is malformed
+ *         or the script ends before the value does.
+ */
+auto HMDT::ScriptTokenizer::skipValue() noexcept -> MaybeVoid {
+    auto token = next();
+
+    switch(token.type) {
+        case ScriptTokenType::WORD:
+        case ScriptTokenType::STRING:
+            return STATUS_SUCCESS;
+        case ScriptTokenType::OPEN_BRACE:
+            break;
+        case ScriptTokenType::INVALID:
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": string is never closed.");
+            RETURN_ERROR(STATUS_UNTERMINATED_STRING);
+        case ScriptTokenType::END_OF_FILE:
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected a value, but the script ended.");
+            RETURN_ERROR(STATUS_UNEXPECTED_END_OF_SCRIPT);
+        default:
+            WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                        ": expected a value, but found '", token.text, "'.");
+            RETURN_ERROR(STATUS_UNEXPECTED_TOKEN);
+    }
+
+    // Count the depth rather than recursing, so that deeply nested blocks can't
+    //   overflow the stack
+    std::size_t depth = 1;
+    while(depth > 0) {
+        token = next();
+
+        switch(token.type) {
+            case ScriptTokenType::OPEN_BRACE:
+                ++depth;
+                break;
+            case ScriptTokenType::CLOSE_BRACE:
+                --depth;
+                break;
+            case ScriptTokenType::INVALID:
+                WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                            ": string is never closed.");
+                RETURN_ERROR(STATUS_UNTERMINATED_STRING);
+            case ScriptTokenType::END_OF_FILE:
+                WRITE_ERROR("Line ", token.line, ", column ", token.column,
+                            ": expected '}', but the script ended.");
+                RETURN_ERROR(STATUS_UNEXPECTED_END_OF_SCRIPT);
+            default:
+                break;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Reads the next token out of the buffer
+ */
+auto HMDT::ScriptTokenizer::lex() noexcept -> ScriptToken {
+    // Skip past any whitespace and comments, keeping track of lines as we go
+    while(m_offset < m_buffer.size()) {
+        auto c = m_buffer[m_offset];
+
+        if(c == '\n') {
+            ++m_offset;
+            ++m_line;
+            m_line_start = m_offset;
+        } else if(isSpace(c)) {
+            ++m_offset;
+        } else if(c == '#') {
+            auto end = m_buffer.find('\n', m_offset);
+            m_offset = (end == std::string_view::npos) ? m_buffer.size() : end;
+        } else {
+            break;
+        }
+    }
+
+    ScriptToken token{ ScriptTokenType::END_OF_FILE, std::string_view{},
+                       m_line, m_offset - m_line_start + 1 };
+
+    if(m_offset >= m_buffer.size()) {
+        return token;
+    }
+
+    auto start = m_offset;
+    auto c = m_buffer[start];
+    auto next_c = (start + 1 < m_buffer.size()) ? m_buffer[start + 1] : '\0';
+
+    if(c == '{') {
+        token.type = ScriptTokenType::OPEN_BRACE;
+        m_offset = start + 1;
+    } else if(c == '}') {
+        token.type = ScriptTokenType::CLOSE_BRACE;
+        m_offset = start + 1;
+    } else if(c == '=' || c == '<' || c == '>') {
+        token.type = ScriptTokenType::OPERATOR;
+        m_offset = start + ((next_c == '=') ? 2 : 1);
+    } else if((c == '!' || c == '?') && next_c == '=') {
+        token.type = ScriptTokenType::OPERATOR;
+        m_offset = start + 2;
+    } else if(c == '"') {
+        auto end = start + 1;
+        while(end < m_buffer.size() && m_buffer[end] != '"') {
+            // Skip over escaped characters, so that \" doesn't end the string
+            if(m_buffer[end] == '\\' && end + 1 < m_buffer.size()) {
+                ++end;
+            }
+            ++end;
+        }
+
+        if(end >= m_buffer.size()) {
+            token.type = ScriptTokenType::INVALID;
+            token.text = m_buffer.substr(start);
+            m_offset = m_buffer.size();
+            return token;
+        }
+
+        token.type = ScriptTokenType::STRING;
+        token.text = m_buffer.substr(start + 1, end - start - 1);
+        m_offset = end + 1;
+
+        // Strings may span multiple lines, so keep the line count right
+        for(auto i = start; i < end; ++i) {
+            if(m_buffer[i] == '\n') {
+                ++m_line;
+                m_line_start = i + 1;
+            }
+        }
+
+        return token;
+    } else {
+        auto end = start + 1;
+        while(end < m_buffer.size() && !isWordBreak(m_buffer[end])) {
+            ++end;
+        }
+
+        token.type = ScriptTokenType::WORD;
+        m_offset = end;
+    }
+
+    token.text = m_buffer.substr(start, m_offset - start);
+    return token;
+}
+
+std::ostream& HMDT::operator<<(std::ostream& o, const ScriptTokenType& type) {
+    switch(type) {
+        case ScriptTokenType::WORD:
+            return (o << "WORD");
+        case ScriptTokenType::STRING:
+            return (o << "STRING");
+        case ScriptTokenType::OPERATOR:
+            return (o << "OPERATOR");
+        case ScriptTokenType::OPEN_BRACE:
+            return (o << "OPEN_BRACE");
+        case ScriptTokenType::CLOSE_BRACE:
+            return (o << "CLOSE_BRACE");
+        case ScriptTokenType::INVALID:
+            return (o << "INVALID");
+        case ScriptTokenType::END_OF_FILE:
+            return (o << "END_OF_FILE");
+    }
+
+    return o;
+}
+
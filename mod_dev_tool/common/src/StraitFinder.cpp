@@ -0,0 +1,365 @@
+/**
+ * @file StraitFinder.cpp
+ *
+ * @brief Defines functions for finding narrow sea crossings between separate
+ *        landmasses.
+ *
+ * @par The distance transform is the separable exact Euclidean transform from
+ *      "Distance Transforms of Sampled Functions" by Felzenszwalb and
+ *      Huttenlocher, extended to also remember which land pixel is closest.
+ */
+
+#include "StraitFinder.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a pixel as being part of a sea province
+    constexpr uint32_t SEA_PIXEL = std::numeric_limits<uint32_t>::max() - 1;
+
+    //! Marks a pixel that is neither land nor sea, which can't be crossed
+    constexpr uint32_t BLOCKED_PIXEL = std::numeric_limits<uint32_t>::max();
+
+    //! Marks that no land pixel exists in the same row/column
+    constexpr uint32_t NO_LAND = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief The best crossing found so far between two land provinces
+     */
+    struct Candidate {
+        uint64_t distance_sq; //!< The squared distance between the two shores
+        uint32_t from_index; //!< The pixel index of the first shore
+        uint32_t to_index; //!< The pixel index of the second shore
+        uint32_t sea_index; //!< A sea pixel along the crossing
+    };
+
+    using CandidateMap = std::map<std::pair<HMDT::ProvinceID, HMDT::ProvinceID>,
+                                  Candidate>;
+
+    /**
+     * @brief Checks if one candidate is a better crossing than another.
+     * @details Ties are broken on the pixel indices, so that the same map
+     *          always produces the same crossings no matter how the work was
+     *          split between threads.
+     */
+    bool isBetter(const Candidate& c1, const Candidate& c2) {
+        return std::tie(c1.distance_sq, c1.from_index, c1.to_index, c1.sea_index) <
+               std::tie(c2.distance_sq, c2.from_index, c2.to_index, c2.sea_index);
+    }
+
+    /**
+     * @brief Adds a candidate to the map, if it is better than the one already
+     *        there.
+     */
+    void addCandidate(CandidateMap& candidates,
+                      const std::pair<HMDT::ProvinceID, HMDT::ProvinceID>& key,
+                      const Candidate& candidate)
+    {
+        if(auto it = candidates.find(key); it == candidates.end()) {
+            candidates.emplace(key, candidate);
+        } else if(isBetter(candidate, it->second)) {
+            it->second = candidate;
+        }
+    }
+
+    /**
+     * @brief Labels every land province with the landmass it is a part of.
+     * @details Landmasses are found by walking the province adjacencies rather
+     *          than the pixels, as there are far fewer provinces than pixels.
+     *
+     * @param provinces Every province
+     *
+     * @return A mapping of every land province to its landmass
+     */
+    std::unordered_map<HMDT::ProvinceID, uint32_t> labelLandmasses(
+            const HMDT::ProvinceList& provinces)
+    {
+        std::unordered_map<HMDT::ProvinceID, uint32_t> landmasses;
+
+        // Visit in a fixed order, so that landmass numbers are stable
+        std::vector<HMDT::ProvinceID> land_provinces;
+        for(auto&& [id, province] : provinces) {
+            if(province.type == HMDT::ProvinceType::LAND) {
+                land_provinces.push_back(id);
+            }
+        }
+        std::sort(land_provinces.begin(), land_provinces.end());
+
+        uint32_t next_landmass = 0;
+        for(auto&& start : land_provinces) {
+            if(landmasses.count(start) != 0) continue;
+
+            std::queue<HMDT::ProvinceID> to_visit;
+            to_visit.push(start);
+            landmasses[start] = next_landmass;
+
+            while(!to_visit.empty()) {
+                auto id = to_visit.front();
+                to_visit.pop();
+
+                for(auto&& adj_id : provinces.at(id).adjacent_provinces) {
+                    if(auto it = provinces.find(adj_id);
+                            it != provinces.end() &&
+                            it->second.type == HMDT::ProvinceType::LAND &&
+                            landmasses.count(adj_id) == 0)
+                    {
+                        landmasses[adj_id] = next_landmass;
+                        to_visit.push(adj_id);
+                    }
+                }
+            }
+
+            ++next_landmass;
+        }
+
+        return landmasses;
+    }
+}
+
+/**
+ * @brief Finds every place where two land provinces on different landmasses
+ *        are separated by a narrow stretch of sea.
+ * @details A distance transform over the land/sea mask finds the closest land
+ *          pixel to every pixel. Wherever two neighboring pixels (at least one
+ *          of which is sea) are closest to land on different landmasses, the
+ *          two land pixels are on opposite shores of the water between them.
+ *          Only the narrowest such crossing is kept for each pair of land
+ *          provinces.
+ *
+ *          Every pass is linear in the number of pixels, and is split across
+ *          all cores.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param provinces Every province on the map
+ * @param max_width The widest distance (between the two shore pixels) which
+ *                  will still be considered a strait
+ *
+ * @return Every strait, ordered by the provinces on either side.
+ */
+auto HMDT::findStraits(const Dimensions& dimensions,
+                       const ProvinceID* province_matrix,
+                       const ProvinceList& provinces,
+                       uint32_t max_width)
+    -> Maybe<std::vector<Strait>>
+{
+    RETURN_ERROR_IF(province_matrix == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto width = dimensions.w;
+    auto height = dimensions.h;
+    uint64_t size = static_cast<uint64_t>(width) * height;
+
+    if(size == 0 || max_width == 0) {
+        return std::vector<Strait>{};
+    }
+
+    auto landmasses = labelLandmasses(provinces);
+
+    std::unique_ptr<uint32_t[]> landmass_matrix;
+    std::unique_ptr<uint32_t[]> nearest_row;
+    std::unique_ptr<uint32_t[]> nearest;
+    try {
+        landmass_matrix.reset(new uint32_t[size]);
+        nearest_row.reset(new uint32_t[size]);
+        nearest.reset(new uint32_t[size]);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for the distance transform: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Pass 1: Which landmass every pixel is on, or if it is sea or blocked
+    mapProvinceMatrix(province_matrix, size, landmass_matrix.get(),
+                      [&](const ProvinceID& id) -> uint32_t {
+        if(auto it = landmasses.find(id); it != landmasses.end()) {
+            return it->second;
+        } else if(auto pit = provinces.find(id);
+                  pit != provinces.end() &&
+                  pit->second.type == ProvinceType::SEA)
+        {
+            return SEA_PIXEL;
+        } else {
+            return BLOCKED_PIXEL;
+        }
+    });
+
+    auto is_land = [&landmass_matrix](uint64_t index) {
+        return landmass_matrix[index] < SEA_PIXEL;
+    };
+
+    // Pass 2: For every column, the row of the closest land pixel in that
+    //   same column
+    //   Each thread sweeps its columns a whole row at a time, rather than a
+    //   whole column at a time, to stay friendly to the cache
+    parallelForEachRange(width, [&](uint64_t begin, uint64_t end) {
+        std::vector<uint32_t> last(end - begin, NO_LAND);
+
+        for(uint32_t y = 0; y < height; ++y) {
+            for(auto x = begin; x < end; ++x) {
+                auto index = xyToIndex(width, x, y);
+                if(is_land(index)) last[x - begin] = y;
+                nearest_row[index] = last[x - begin];
+            }
+        }
+
+        std::fill(last.begin(), last.end(), NO_LAND);
+
+        for(uint32_t y = height; y-- > 0; ) {
+            for(auto x = begin; x < end; ++x) {
+                auto index = xyToIndex(width, x, y);
+                if(is_land(index)) last[x - begin] = y;
+
+                auto next = last[x - begin];
+                if(next != NO_LAND && (nearest_row[index] == NO_LAND ||
+                                       next - y < y - nearest_row[index]))
+                {
+                    nearest_row[index] = next;
+                }
+            }
+        }
+    });
+
+    // Pass 3: For every row, the closest land pixel overall, by taking the
+    //   lower envelope of the parabolas rooted at each column's closest pixel
+    parallelForEachRange(height, [&](uint64_t begin, uint64_t end) {
+        std::vector<int64_t> g(width);
+        std::vector<uint32_t> v(width);
+        std::vector<double> z(width + 1);
+
+        for(auto y = begin; y < end; ++y) {
+            // Squared vertical distance from each column's closest land pixel
+            for(uint32_t q = 0; q < width; ++q) {
+                auto row = nearest_row[xyToIndex(width, q, y)];
+                g[q] = (row == NO_LAND) ? -1
+                                        : (static_cast<int64_t>(row) - static_cast<int64_t>(y)) *
+                                          (static_cast<int64_t>(row) - static_cast<int64_t>(y));
+            }
+
+            // Build the lower envelope, skipping columns without any land
+            int64_t k = -1;
+            for(uint32_t q = 0; q < width; ++q) {
+                if(g[q] < 0) continue;
+
+                double s = 0;
+                while(k >= 0) {
+                    auto p = v[k];
+                    s = static_cast<double>((g[q] + static_cast<int64_t>(q) * q) -
+                                            (g[p] + static_cast<int64_t>(p) * p)) /
+                        (2.0 * (static_cast<double>(q) - p));
+                    if(s <= z[k]) {
+                        --k;
+                    } else {
+                        break;
+                    }
+                }
+
+                ++k;
+                v[k] = q;
+                z[k] = (k == 0) ? -std::numeric_limits<double>::infinity() : s;
+                z[k + 1] = std::numeric_limits<double>::infinity();
+            }
+
+            // Read the closest land pixel of every column off of the envelope
+            int64_t j = 0;
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = xyToIndex(width, x, y);
+
+                if(k < 0) {
+                    nearest[index] = NO_LAND;
+                    continue;
+                }
+
+                while(z[j + 1] < x) ++j;
+
+                auto q = v[j];
+                nearest[index] = static_cast<uint32_t>(
+                        xyToIndex(width, q, nearest_row[xyToIndex(width, q, y)]));
+            }
+        }
+    });
+
+    // Pass 4: Look for neighbors which are closest to different landmasses
+    const uint64_t max_width_sq = static_cast<uint64_t>(max_width) * max_width;
+
+    CandidateMap candidates;
+    std::mutex candidates_mutex;
+
+    parallelForEachRange(height, [&](uint64_t begin, uint64_t end) {
+        CandidateMap local_candidates;
+
+        auto check = [&](uint64_t i1, uint64_t i2) {
+            auto l1 = landmass_matrix[i1];
+            auto l2 = landmass_matrix[i2];
+
+            // The crossing has to actually be over the sea
+            if(l1 == BLOCKED_PIXEL || l2 == BLOCKED_PIXEL) return;
+            if(l1 != SEA_PIXEL && l2 != SEA_PIXEL) return;
+
+            auto f1 = nearest[i1];
+            auto f2 = nearest[i2];
+            if(f1 == NO_LAND || f2 == NO_LAND) return;
+            if(landmass_matrix[f1] == landmass_matrix[f2]) return;
+
+            int64_t dx = static_cast<int64_t>(f1 % width) - static_cast<int64_t>(f2 % width);
+            int64_t dy = static_cast<int64_t>(f1 / width) - static_cast<int64_t>(f2 / width);
+            uint64_t distance_sq = dx * dx + dy * dy;
+            if(distance_sq > max_width_sq) return;
+
+            auto from = province_matrix[f1];
+            auto to = province_matrix[f2];
+            if(to < from) {
+                std::swap(from, to);
+                std::swap(f1, f2);
+            }
+
+            addCandidate(local_candidates, { from, to },
+                         Candidate{ distance_sq, f1, f2,
+                                    static_cast<uint32_t>(l1 == SEA_PIXEL ? i1 : i2) });
+        };
+
+        for(auto y = begin; y < end; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = xyToIndex(width, x, y);
+
+                if(x + 1 < width) check(index, index + 1);
+                if(y + 1 < height) check(index, index + width);
+            }
+        }
+
+        std::lock_guard lock(candidates_mutex);
+        for(auto&& [key, candidate] : local_candidates) {
+            addCandidate(candidates, key, candidate);
+        }
+    });
+
+    std::vector<Strait> straits;
+    straits.reserve(candidates.size());
+
+    for(auto&& [key, candidate] : candidates) {
+        Point2D start{ candidate.from_index % width, candidate.from_index / width };
+        Point2D stop{ candidate.to_index % width, candidate.to_index / width };
+
+        // Prefer whichever sea province is half-way across
+        auto middle = xyToIndex(width, (start.x + stop.x) / 2, (start.y + stop.y) / 2);
+        auto through = (landmass_matrix[middle] == SEA_PIXEL) ? middle
+                                                                : candidate.sea_index;
+
+        straits.push_back(Strait{
+            key.first, key.second, province_matrix[through],
+            start, stop,
+            std::sqrt(static_cast<double>(candidate.distance_sq))
+        });
+    }
+
+    return straits;
+}
+
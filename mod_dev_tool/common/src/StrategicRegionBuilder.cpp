@@ -0,0 +1,52 @@
+/**
+ * @file StrategicRegionBuilder.cpp
+ *
+ * @brief Defines functions for partitioning provinces into strategic regions.
+ */
+
+#include "StrategicRegionBuilder.h"
+
+#include "Logger.h"
+
+#include "ProvinceClusterer.h"
+
+/**
+ * @brief Partitions every province into contiguous strategic regions of
+ *        roughly the same area.
+ * @details Sea provinces and all other provinces are never put into the same
+ *          region. Groups which are too small to be a region on their own
+ *          (such as small islands) are added to the closest region of the same
+ *          kind. See clusterProvinces for how the regions are grown.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param provinces Every province on the map
+ * @param target_area The area in pixels that each region should aim for
+ *
+ * @return The provinces of every region, in the order they first appear on
+ *         the map.
+ */
+auto HMDT::clusterStrategicRegions(const Dimensions& dimensions,
+                                   const ProvinceID* province_matrix,
+                                   const ProvinceList& provinces,
+                                   uint64_t target_area)
+    -> Maybe<std::vector<std::vector<ProvinceID>>>
+{
+    ProvinceClusterOptions options;
+    options.measure = ProvinceClusterOptions::Measure::AREA;
+    options.target_size = target_area;
+    options.group_of = [](const Province& province) -> uint32_t {
+        return province.type == ProvinceType::SEA ? 1 : 0;
+    };
+    options.merge_small_components = true;
+
+    auto regions = clusterProvinces(dimensions, province_matrix, provinces,
+                                    options);
+    RETURN_IF_ERROR(regions);
+
+    WRITE_DEBUG("Clustered ", provinces.size(), " provinces into ",
+                regions->size(), " strategic regions.");
+
+    return regions;
+}
+
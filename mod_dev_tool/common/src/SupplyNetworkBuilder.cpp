@@ -0,0 +1,358 @@
+/**
+ * @file SupplyNetworkBuilder.cpp
+ *
+ * @brief Defines functions for generating supply hubs and the railways which
+ *        connect them.
+ */
+
+#include "SupplyNetworkBuilder.h"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <tuple>
+
+#include "Logger.h"
+
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a pixel or province index which is not a land province
+    constexpr uint32_t NOT_LAND = HMDT::NO_PROVINCE_INDEX;
+
+    //! How much each unit of height difference between two provinces adds to
+    //!   the cost of building a railway between them, in pixels
+    constexpr double SLOPE_COST = 2.0;
+
+    //! How much having to bridge a river adds to the cost of building a
+    //!   railway between two provinces, in pixels
+    constexpr double RIVER_CROSSING_COST = 50.0;
+
+    /**
+     * @brief Finds the root of a union-find set, compressing the path to it
+     */
+    uint32_t findRoot(std::vector<uint32_t>& parents, uint32_t i) {
+        while(parents[i] != i) {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+}
+
+/**
+ * @brief Generates supply hubs, and a railway network connecting all of them.
+ * @details The largest land province of every state is picked as a hub. Any
+ *          landmass without a state still gets one hub, in its largest
+ *          province.
+ *
+ *          A multi-source Dijkstra is then run from every hub over the land
+ *          province adjacency graph, which assigns every province to its
+ *          cheapest hub. Wherever two neighboring provinces belong to different
+ *          hubs, the path through them is a candidate railway between those
+ *          two hubs, and a minimum spanning tree over the cheapest candidate
+ *          of each pair of hubs picks which railways get built.
+ *
+ *          The cost of moving between two provinces is the distance between
+ *          their centroids, plus a penalty for the difference in their average
+ *          heights, plus a penalty if a river runs along their shared border.
+ *
+ *          Every tie is broken on the order of the province IDs, so the same
+ *          map always produces the same network.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param heightmap The height of every pixel of the map
+ * @param rivers The rivers color index of every pixel of the map, or nullptr
+ *               if no rivers should be taken into account
+ * @param provinces Every province on the map
+ * @param states Every state on the map
+ *
+ * @return The supply hubs and railways.
+ */
+auto HMDT::buildSupplyNetwork(const Dimensions& dimensions,
+                              const ProvinceID* province_matrix,
+                              const uint8_t* heightmap,
+                              const uint8_t* rivers,
+                              const ProvinceList& provinces,
+                              const StateList& states)
+    -> Maybe<SupplyNetwork>
+{
+    RETURN_ERROR_IF(province_matrix == nullptr || heightmap == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto width = dimensions.w;
+    auto height = dimensions.h;
+    uint64_t size = static_cast<uint64_t>(width) * height;
+
+    // Give every land province a dense index, in a stable order
+    std::vector<ProvinceID> land_provinces;
+    for(auto&& [id, province] : provinces) {
+        if(province.type == ProvinceType::LAND) {
+            land_provinces.push_back(id);
+        }
+    }
+    std::sort(land_provinces.begin(), land_provinces.end());
+
+    auto count = static_cast<uint32_t>(land_provinces.size());
+
+    auto index_of = indexProvinceIDs(land_provinces);
+
+    SupplyNetwork network;
+    if(count == 0) {
+        return network;
+    }
+
+    std::unique_ptr<uint32_t[]> index_matrix;
+    try {
+        index_matrix.reset(new uint32_t[size]);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for the province indices: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Look up every pixel's province just once
+    buildProvinceIndexMatrix(province_matrix, size, index_of, index_matrix.get());
+
+    // Gather the centroid and average height of every province, and every
+    //   shared border that a river runs along
+    std::vector<ProvincePixelStats> stats(count);
+    std::set<std::pair<uint32_t, uint32_t>> river_borders;
+    std::mutex stats_mutex;
+
+    parallelForEachRange(height, [&](uint64_t begin, uint64_t end) {
+        std::vector<ProvincePixelStats> local_stats(count);
+        std::set<std::pair<uint32_t, uint32_t>> local_river_borders;
+
+        auto is_river = [rivers](uint64_t index) {
+            return rivers[index] <= RIVER_WIDEST_INDEX;
+        };
+
+        auto check_border = [&](uint64_t i1, uint64_t i2) {
+            auto p1 = index_matrix[i1];
+            auto p2 = index_matrix[i2];
+
+            if(p1 != p2 && p1 != NOT_LAND && p2 != NOT_LAND &&
+               (is_river(i1) || is_river(i2)))
+            {
+                local_river_borders.insert(std::minmax(p1, p2));
+            }
+        };
+
+        for(auto y = begin; y < end; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = xyToIndex(width, x, y);
+                auto p = index_matrix[index];
+
+                if(p == NOT_LAND) continue;
+
+                local_stats[p].addPixel(x, y, index);
+                local_stats[p].addHeight(heightmap[index]);
+
+                if(rivers != nullptr) {
+                    if(x + 1 < width) check_border(index, index + 1);
+                    if(y + 1 < height) check_border(index, index + width);
+                }
+            }
+        }
+
+        std::lock_guard lock(stats_mutex);
+        for(uint32_t p = 0; p < count; ++p) {
+            stats[p].merge(local_stats[p]);
+        }
+        river_borders.insert(local_river_borders.begin(),
+                             local_river_borders.end());
+    });
+
+    // Build the weighted land province graph
+    std::vector<std::vector<std::pair<uint32_t, double>>> edges(count);
+    {
+        auto centroid = [&stats](uint32_t p) {
+            auto n = std::max<uint64_t>(stats[p].count, 1);
+            return std::make_tuple(static_cast<double>(stats[p].sum_x) / n,
+                                   static_cast<double>(stats[p].sum_y) / n,
+                                   static_cast<double>(stats[p].height_sum) / n);
+        };
+
+        for(uint32_t p = 0; p < count; ++p) {
+            auto [px, py, ph] = centroid(p);
+
+            for(auto&& adj_id : provinces.at(land_provinces[p]).adjacent_provinces)
+            {
+                auto it = index_of.find(adj_id);
+                if(it == index_of.end()) continue;
+
+                auto q = it->second;
+                auto [qx, qy, qh] = centroid(q);
+
+                double cost = std::hypot(px - qx, py - qy) +
+                              SLOPE_COST * std::abs(ph - qh);
+                if(river_borders.count(std::minmax(p, q)) != 0) {
+                    cost += RIVER_CROSSING_COST;
+                }
+
+                edges[p].emplace_back(q, cost);
+            }
+
+            std::sort(edges[p].begin(), edges[p].end());
+        }
+    }
+
+    // Pick the hubs: the largest province of every state first
+    std::vector<uint32_t> hubs;
+    std::vector<bool> is_hub(count, false);
+
+    auto is_larger = [&stats](uint32_t p, uint32_t best) {
+        return best == NOT_LAND || stats[p].count > stats[best].count ||
+               (stats[p].count == stats[best].count && p < best);
+    };
+
+    for(auto&& [state_id, state] : states) {
+        uint32_t best = NOT_LAND;
+        for(auto&& id : state.provinces) {
+            if(auto it = index_of.find(id); it != index_of.end() &&
+                                            is_larger(it->second, best))
+            {
+                best = it->second;
+            }
+        }
+
+        if(best != NOT_LAND && !is_hub[best]) {
+            is_hub[best] = true;
+            hubs.push_back(best);
+        }
+    }
+
+    // Then the largest province of every landmass which has no hub yet
+    {
+        std::vector<bool> visited(count, false);
+        for(uint32_t start = 0; start < count; ++start) {
+            if(visited[start]) continue;
+
+            bool has_hub = false;
+            uint32_t best = NOT_LAND;
+
+            std::vector<uint32_t> to_visit{ start };
+            visited[start] = true;
+            while(!to_visit.empty()) {
+                auto p = to_visit.back();
+                to_visit.pop_back();
+
+                has_hub = has_hub || is_hub[p];
+                if(is_larger(p, best)) best = p;
+
+                for(auto&& [q, _] : edges[p]) {
+                    if(!visited[q]) {
+                        visited[q] = true;
+                        to_visit.push_back(q);
+                    }
+                }
+            }
+
+            if(!has_hub) {
+                is_hub[best] = true;
+                hubs.push_back(best);
+            }
+        }
+    }
+
+    // Multi-source Dijkstra, finding the cheapest hub for every province
+    std::vector<double> distance(count, std::numeric_limits<double>::infinity());
+    std::vector<uint32_t> owner(count, NOT_LAND);
+    std::vector<uint32_t> previous(count, NOT_LAND);
+    {
+        using QueueEntry = std::pair<double, uint32_t>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                            std::greater<QueueEntry>> queue;
+
+        for(auto&& hub : hubs) {
+            distance[hub] = 0;
+            owner[hub] = hub;
+            queue.push({ 0, hub });
+        }
+
+        while(!queue.empty()) {
+            auto [d, p] = queue.top();
+            queue.pop();
+
+            if(d > distance[p]) continue;
+
+            for(auto&& [q, cost] : edges[p]) {
+                if(d + cost < distance[q]) {
+                    distance[q] = d + cost;
+                    owner[q] = owner[p];
+                    previous[q] = p;
+                    queue.push({ distance[q], q });
+                }
+            }
+        }
+    }
+
+    // The cheapest connection between every pair of neighboring hubs
+    using Link = std::tuple<double, uint32_t, uint32_t>; // cost, p, q
+    std::map<std::pair<uint32_t, uint32_t>, Link> hub_links;
+    for(uint32_t p = 0; p < count; ++p) {
+        for(auto&& [q, cost] : edges[p]) {
+            if(p > q || owner[p] == owner[q] ||
+               owner[p] == NOT_LAND || owner[q] == NOT_LAND)
+            {
+                continue;
+            }
+
+            Link link{ distance[p] + cost + distance[q], p, q };
+            auto key = std::minmax(owner[p], owner[q]);
+
+            if(auto it = hub_links.find(key); it == hub_links.end()) {
+                hub_links.emplace(key, link);
+            } else if(link < it->second) {
+                it->second = link;
+            }
+        }
+    }
+
+    // Only build the cheapest links which still connect up separate parts of
+    //   the network
+    std::vector<std::pair<Link, std::pair<uint32_t, uint32_t>>> sorted_links;
+    for(auto&& [key, link] : hub_links) {
+        sorted_links.push_back({ link, key });
+    }
+    std::sort(sorted_links.begin(), sorted_links.end());
+
+    std::vector<uint32_t> parents(count);
+    for(uint32_t p = 0; p < count; ++p) parents[p] = p;
+
+    for(auto&& [link, key] : sorted_links) {
+        auto r1 = findRoot(parents, key.first);
+        auto r2 = findRoot(parents, key.second);
+        if(r1 == r2) continue;
+
+        parents[r2] = r1;
+
+        auto [cost, p, q] = link;
+
+        // Walk back from p to its hub, then forward from q to its hub
+        std::vector<ProvinceID> railway;
+        for(auto i = p; i != NOT_LAND; i = previous[i]) {
+            railway.push_back(land_provinces[i]);
+        }
+        std::reverse(railway.begin(), railway.end());
+        for(auto i = q; i != NOT_LAND; i = previous[i]) {
+            railway.push_back(land_provinces[i]);
+        }
+
+        network.railways.push_back(std::move(railway));
+    }
+
+    std::sort(hubs.begin(), hubs.end());
+    for(auto&& hub : hubs) {
+        network.supply_nodes.push_back(land_provinces[hub]);
+    }
+
+    return network;
+}
+
@@ -0,0 +1,161 @@
+/**
+ * @file TerrainVoter.cpp
+ *
+ * @brief Defines functions for picking the terrain of every province from a
+ *        terrain map.
+ */
+
+#include "TerrainVoter.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <mutex>
+
+#include "Logger.h"
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! Marks a palette index or province which does not vote
+    constexpr uint32_t NO_VOTE = std::numeric_limits<uint32_t>::max();
+}
+
+/**
+ * @brief Picks the terrain of every province by which terrain covers the most
+ *        pixels of it.
+ * @details Every pixel of the terrain map votes for the terrain of its palette
+ *          index, in a single pass over the map. Pixels whose palette index has
+ *          no terrain, or which are ignored, do not vote, so a province whose
+ *          pixels are all ignored is left out of the result.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel of the map
+ * @param terrain_map The palette index of every pixel of the terrain map
+ * @param provinces Every province on the map
+ * @param index_terrains The terrain of every palette index. Indices past the
+ *                       end, or which are empty, have no terrain.
+ * @param options How to vote
+ *
+ * @return The winning terrain of every province which got at least one vote.
+ */
+auto HMDT::voteProvinceTerrains(const Dimensions& dimensions,
+                                const ProvinceID* province_matrix,
+                                const uint8_t* terrain_map,
+                                const ProvinceList& provinces,
+                                const std::vector<TerrainID>& index_terrains,
+                                const TerrainVoteOptions& options)
+    -> Maybe<std::unordered_map<ProvinceID, TerrainID>>
+{
+    RETURN_ERROR_IF(province_matrix == nullptr || terrain_map == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto width = dimensions.w;
+    auto height = dimensions.h;
+
+    // Every palette index votes for a terrain slot, and terrains are given
+    //   slots in the order of their lowest palette index
+    std::array<uint32_t, 256> slot_of_index;
+    slot_of_index.fill(NO_VOTE);
+
+    std::vector<TerrainID> slot_terrains;
+    for(uint32_t index = 0; index < slot_of_index.size() && index < index_terrains.size(); ++index)
+    {
+        const auto& terrain = index_terrains[index];
+        if(terrain.empty() ||
+           options.ignored_indices.count(index) != 0 ||
+           options.ignored_terrains.count(terrain) != 0)
+        {
+            continue;
+        }
+
+        auto it = std::find(slot_terrains.begin(), slot_terrains.end(), terrain);
+        slot_of_index[index] = std::distance(slot_terrains.begin(), it);
+        if(it == slot_terrains.end()) {
+            slot_terrains.push_back(terrain);
+        }
+    }
+
+    std::unordered_map<ProvinceID, TerrainID> result;
+
+    auto slot_count = static_cast<uint32_t>(slot_terrains.size());
+    if(slot_count == 0) {
+        WRITE_WARN("No palette index of the terrain map has a terrain which can be voted for.");
+        return result;
+    }
+
+    // Give every province which is being voted on a dense index
+    std::vector<ProvinceID> ids;
+    for(auto&& [id, province] : provinces) {
+        if(province.type == ProvinceType::LAND || options.include_water) {
+            ids.push_back(id);
+        }
+    }
+
+    auto index_of = indexProvinceIDs(ids);
+    auto lookup = [&index_of](const ProvinceID& id) {
+        return findProvinceIndex(index_of, id);
+    };
+
+    auto count = static_cast<uint32_t>(ids.size());
+
+    // The number of pixels of every terrain slot in every province
+    std::vector<uint32_t> votes(static_cast<uint64_t>(count) * slot_count, 0);
+    std::mutex votes_mutex;
+
+    parallelForEachRange(height, [&](uint64_t begin, uint64_t end) {
+        std::vector<uint32_t> local_votes(votes.size(), 0);
+
+        CachedProvinceLookup cached(lookup);
+
+        for(auto y = begin; y < end; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = xyToIndex(width, x, y);
+
+                auto p = cached(province_matrix[index]);
+                auto slot = slot_of_index[terrain_map[index]];
+                if(p == NO_PROVINCE_INDEX || slot == NO_VOTE) continue;
+
+                ++local_votes[static_cast<uint64_t>(p) * slot_count + slot];
+            }
+        }
+
+        std::lock_guard lock(votes_mutex);
+        std::transform(votes.begin(), votes.end(), local_votes.begin(),
+                       votes.begin(), std::plus<uint32_t>{});
+    });
+
+    for(uint32_t p = 0; p < count; ++p) {
+        const auto* province_votes = &votes[static_cast<uint64_t>(p) * slot_count];
+
+        auto most_votes = *std::max_element(province_votes, province_votes + slot_count);
+        if(most_votes == 0) continue;
+
+        uint32_t winner = NO_VOTE;
+        for(uint32_t slot = 0; slot < slot_count; ++slot) {
+            if(province_votes[slot] != most_votes) continue;
+
+            // Slots are in palette order, so the first tied slot is the first
+            //   listed one, and the last tied slot is the last listed one
+            if(winner == NO_VOTE || options.tie_break == TerrainTieBreak::LAST_LISTED)
+            {
+                winner = slot;
+            }
+
+            if(options.tie_break == TerrainTieBreak::KEEP_CURRENT &&
+               slot_terrains[slot] == provinces.at(ids[p]).terrain)
+            {
+                winner = slot;
+                break;
+            }
+        }
+
+        result[ids[p]] = slot_terrains[winner];
+    }
+
+    WRITE_DEBUG("Voted on the terrain of ", result.size(), " provinces.");
+
+    return result;
+}
+
@@ -0,0 +1,133 @@
+/**
+ * @file TileHash.cpp
+ *
+ * @brief Defines functions for finding which tiles of a map layer changed
+ *        between two versions of it.
+ */
+
+#include "TileHash.h"
+
+#include <algorithm>
+#include <new>
+
+#include "Util.h"
+
+namespace {
+    //! FNV-1a 64-bit offset basis
+    constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+
+    //! FNV-1a 64-bit prime
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+}
+
+/**
+ * @brief Hashes every tile of a map layer.
+ * @details Tiles are laid out left to right, then top to bottom. Tiles on the
+ *          right and bottom edges are smaller if the dimensions are not a
+ *          multiple of the tile size.
+ *
+ * @param dimensions The dimensions of the layer
+ * @param data The layer. Must be dimensions.w * dimensions.h * depth bytes
+ * @param depth How many bytes make up a single pixel
+ * @param tile_size The width and height of each tile
+ *
+ * @return The hash of every tile, STATUS_BADALLOC if the hashes could not be
+ *         allocated, or an error code if the tiles could not be hashed in
+ *         parallel.
+ */
+auto HMDT::hashTiles(const Dimensions& dimensions, const uint8_t* data,
+                     uint32_t depth, uint32_t tile_size) noexcept
+    -> Maybe<std::vector<uint64_t>>
+{
+    if(data == nullptr || tile_size == 0 || depth == 0) {
+        return std::vector<uint64_t>{};
+    }
+
+    uint32_t tiles_across = (dimensions.w + tile_size - 1) / tile_size;
+    uint32_t tiles_down = (dimensions.h + tile_size - 1) / tile_size;
+
+    std::vector<uint64_t> hashes;
+    try {
+        hashes.resize(static_cast<uint64_t>(tiles_across) * tiles_down,
+                      FNV_OFFSET_BASIS);
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    // Each row of tiles is hashed separately, so they never share a hash
+    auto result = tryParallelForEachRange(tiles_down, [&](uint64_t begin, uint64_t end) {
+        for(uint64_t tile_y = begin; tile_y < end; ++tile_y) {
+            uint32_t top = tile_y * tile_size;
+            uint32_t bottom = std::min(top + tile_size, dimensions.h);
+
+            for(uint32_t y = top; y < bottom; ++y) {
+                const uint8_t* row = data + xyToIndex(dimensions.w * depth, 0, y);
+
+                for(uint32_t tile_x = 0; tile_x < tiles_across; ++tile_x) {
+                    uint64_t start = static_cast<uint64_t>(tile_x) * tile_size * depth;
+                    uint64_t stop = std::min<uint64_t>(start + tile_size * depth,
+                                                       static_cast<uint64_t>(dimensions.w) * depth);
+
+                    auto& hash = hashes[tile_y * tiles_across + tile_x];
+                    for(uint64_t i = start; i < stop; ++i) {
+                        hash = (hash ^ row[i]) * FNV_PRIME;
+                    }
+                }
+            }
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    return hashes;
+}
+
+/**
+ * @brief Finds every tile which is different between two versions of a map
+ *        layer, by comparing the hashes of each tile.
+ *
+ * @param dimensions The dimensions of both versions of the layer
+ * @param old_data The old version of the layer
+ * @param new_data The new version of the layer
+ * @param depth How many bytes make up a single pixel
+ * @param tile_size The width and height of each tile
+ *
+ * @return The area of every changed tile, clamped to the map, or an error code
+ *         if either version could not be hashed.
+ */
+auto HMDT::findChangedTiles(const Dimensions& dimensions,
+                            const uint8_t* old_data, const uint8_t* new_data,
+                            uint32_t depth, uint32_t tile_size) noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    auto old_hashes = hashTiles(dimensions, old_data, depth, tile_size);
+    RETURN_IF_ERROR(old_hashes);
+
+    auto new_hashes = hashTiles(dimensions, new_data, depth, tile_size);
+    RETURN_IF_ERROR(new_hashes);
+
+    std::vector<Rectangle> changed;
+    if(old_hashes->size() != new_hashes->size()) {
+        return changed;
+    }
+
+    uint32_t tiles_across = (dimensions.w + tile_size - 1) / tile_size;
+
+    try {
+        for(uint64_t tile = 0; tile < new_hashes->size(); ++tile) {
+            if((*old_hashes)[tile] == (*new_hashes)[tile]) {
+                continue;
+            }
+
+            uint32_t left = (tile % tiles_across) * tile_size;
+            uint32_t top = (tile / tiles_across) * tile_size;
+
+            changed.push_back(Rectangle{ left, top,
+                                         std::min(tile_size, dimensions.w - left),
+                                         std::min(tile_size, dimensions.h - top) });
+        }
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    return changed;
+}
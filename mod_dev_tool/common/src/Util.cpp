@@ -4,6 +4,8 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
+#include <mutex>
 
 #include "Constants.h"
 #include "BitMap.h"
@@ -60,6 +62,24 @@ HMDT::Color HMDT::RGBToColor(std::uint32_t rgb) {
                 };
 }
 
+/**
+ * @brief Makes up a color from a string, such as the name of a terrain.
+ * @details Uses FNV-1a rather than std::hash, as std::hash is allowed to differ
+ *          between runs, and the same string should always get the same color.
+ *
+ * @param str The string to make a color from
+ *
+ * @return The color for the string
+ */
+HMDT::Color HMDT::colorFromString(const std::string& str) {
+    std::uint32_t hash = 2166136261U;
+    for(auto c : str) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619U;
+    }
+
+    return RGBToColor(hash);
+}
+
 void HMDT::ltrim(std::string& str) {
     str.erase(str.begin(), str.begin() + str.find_first_not_of(" \t\n\r"));
 }
@@ -289,6 +309,22 @@ bool HMDT::isShapeTooLarge(uint32_t s_width, uint32_t s_height,
            static_cast<float>(s_height) >= (i_height / 8.0f);
 }
 
+/**
+ * @brief Checks if a shape is too large for a map of the given size
+ *
+ * @param s_width The width of the shape's bounding box
+ * @param s_height The height of the shape's bounding box
+ * @param dimensions The dimensions of the map
+ *
+ * @return True if the shape is 1/8th of the map's width or height or larger
+ */
+bool HMDT::isShapeTooLarge(uint32_t s_width, uint32_t s_height,
+                           const Dimensions& dimensions)
+{
+    return static_cast<float>(s_width) >= (dimensions.w / 8.0f) ||
+           static_cast<float>(s_height) >= (dimensions.h / 8.0f);
+}
+
 /**
  * @brief Calculates the width and height of the given boundingg box
  *
@@ -324,6 +360,315 @@ void HMDT::writeColorTo(unsigned char* color_data, uint32_t w,
     color_data[index + 2] = c.r;
 }
 
+/**
+ * @brief Gives every province a dense index, in the order they are given
+ *
+ * @param ids Every province to index
+ *
+ * @return The index of every province
+ */
+auto HMDT::indexProvinceIDs(const std::vector<ProvinceID>& ids)
+    -> ProvinceIndexMap
+{
+    ProvinceIndexMap index_of;
+    index_of.reserve(ids.size());
+    for(uint32_t i = 0; i < ids.size(); ++i) {
+        index_of[ids[i]] = i;
+    }
+
+    return index_of;
+}
+
+/**
+ * @brief Finds the dense index of a province
+ *
+ * @param index_of The index of every province
+ * @param id The province to find
+ *
+ * @return The index of the province, or NO_PROVINCE_INDEX if it has none
+ */
+uint32_t HMDT::findProvinceIndex(const ProvinceIndexMap& index_of,
+                                 const ProvinceID& id) noexcept
+{
+    auto it = index_of.find(id);
+    return (it == index_of.end()) ? NO_PROVINCE_INDEX : it->second;
+}
+
+/**
+ * @brief Looks up the dense index of every pixel's province just once, so
+ *        that later passes over the map only deal with plain integers.
+ *
+ * @param province_matrix The province of every pixel
+ * @param size The number of pixels
+ * @param index_of The index of every province
+ * @param index_matrix Filled with the index of every pixel's province, or
+ *                     NO_PROVINCE_INDEX if it has none
+ */
+void HMDT::buildProvinceIndexMatrix(const ProvinceID* province_matrix,
+                                    uint64_t size,
+                                    const ProvinceIndexMap& index_of,
+                                    uint32_t* index_matrix)
+{
+    mapProvinceMatrix(province_matrix, size, index_matrix,
+                      [&index_of](const ProvinceID& id) {
+                          return findProvinceIndex(index_of, id);
+                      });
+}
+
+/**
+ * @brief Adds a single pixel to the totals
+ *
+ * @param x The X coordinate of the pixel
+ * @param y The Y coordinate of the pixel
+ * @param index The index of the pixel
+ */
+void HMDT::ProvincePixelStats::addPixel(uint32_t x, uint32_t y,
+                                        uint64_t index) noexcept
+{
+    ++count;
+    sum_x += x;
+    sum_y += y;
+    min_x = std::min(min_x, x);
+    min_y = std::min(min_y, y);
+    max_x = std::max(max_x, x);
+    max_y = std::max(max_y, y);
+    first = std::min(first, index);
+}
+
+/**
+ * @brief Adds the height of a single pixel to the totals
+ *
+ * @param height The height of the pixel
+ */
+void HMDT::ProvincePixelStats::addHeight(uint8_t height) noexcept {
+    height_sum += height;
+    min_height = std::min(min_height, height);
+    max_height = std::max(max_height, height);
+}
+
+/**
+ * @brief Adds every total from another set of stats for the same province,
+ *        such as those gathered by another thread.
+ *
+ * @param other The stats to add
+ */
+void HMDT::ProvincePixelStats::merge(const ProvincePixelStats& other) noexcept {
+    count += other.count;
+    sum_x += other.sum_x;
+    sum_y += other.sum_y;
+    min_x = std::min(min_x, other.min_x);
+    min_y = std::min(min_y, other.min_y);
+    max_x = std::max(max_x, other.max_x);
+    max_y = std::max(max_y, other.max_y);
+    first = std::min(first, other.first);
+
+    height_sum += other.height_sum;
+    min_height = std::min(min_height, other.min_height);
+    max_height = std::max(max_height, other.max_height);
+}
+
+/**
+ * @brief Gathers the stats of every indexed province in one pass over the
+ *        map, split across all cores.
+ *
+ * @param dimensions The dimensions of the map
+ * @param province_matrix The province of every pixel
+ * @param index_of The index of every province to gather stats for. Every
+ *                 other province is skipped.
+ *
+ * @return The stats of every province, by index
+ */
+auto HMDT::gatherProvincePixelStats(const Dimensions& dimensions,
+                                    const ProvinceID* province_matrix,
+                                    const ProvinceIndexMap& index_of)
+    -> std::vector<ProvincePixelStats>
+{
+    auto count = index_of.size();
+
+    std::vector<ProvincePixelStats> stats(count);
+    std::mutex stats_mutex;
+
+    auto lookup = [&index_of](const ProvinceID& id) {
+        return findProvinceIndex(index_of, id);
+    };
+
+    parallelForEachRange(dimensions.h, [&](uint64_t begin, uint64_t end) {
+        std::vector<ProvincePixelStats> local_stats(count);
+        CachedProvinceLookup cached(lookup);
+
+        for(auto y = begin; y < end; ++y) {
+            for(uint32_t x = 0; x < dimensions.w; ++x) {
+                auto index = xyToIndex(dimensions.w, x, y);
+
+                if(auto p = cached(province_matrix[index]);
+                   p != NO_PROVINCE_INDEX)
+                {
+                    local_stats[p].addPixel(x, y, index);
+                }
+            }
+        }
+
+        std::lock_guard lock(stats_mutex);
+        for(uint32_t p = 0; p < count; ++p) {
+            stats[p].merge(local_stats[p]);
+        }
+    });
+
+    return stats;
+}
+
+/**
+ * @brief Gets every pixel within a circle, clipped to the given dimensions
+ *
+ * @param dimensions The dimensions to clip to
+ * @param center The center of the circle
+ * @param radius The radius of the circle. A radius of 0 is a single pixel.
+ *
+ * @return Every pixel within the circle
+ */
+auto HMDT::getPixelsInCircle(const Dimensions& dimensions,
+                             const Point2D& center, uint32_t radius)
+    -> std::vector<Point2D>
+{
+    std::vector<Point2D> pixels;
+
+    if(!isInImage(dimensions, center.x, center.y)) {
+        return pixels;
+    }
+
+    int64_t r = radius;
+    int64_t min_x = std::max<int64_t>(0, center.x - r);
+    int64_t max_x = std::min<int64_t>(dimensions.w - 1, center.x + r);
+    int64_t min_y = std::max<int64_t>(0, center.y - r);
+    int64_t max_y = std::min<int64_t>(dimensions.h - 1, center.y + r);
+
+    for(int64_t y = min_y; y <= max_y; ++y) {
+        for(int64_t x = min_x; x <= max_x; ++x) {
+            int64_t dx = x - center.x;
+            int64_t dy = y - center.y;
+
+            if(dx * dx + dy * dy <= r * r) {
+                pixels.push_back({ static_cast<uint32_t>(x),
+                                   static_cast<uint32_t>(y) });
+            }
+        }
+    }
+
+    return pixels;
+}
+
+/**
+ * @brief Gets every pixel touched by dragging a circular brush along a path
+ *
+ * @param dimensions The dimensions to clip to
+ * @param path Every point the brush was moved to, in order
+ * @param radius The radius of the brush
+ *
+ * @return Every pixel touched by the brush. Each pixel is only returned once.
+ */
+auto HMDT::getPixelsAlongStroke(const Dimensions& dimensions,
+                                const std::vector<Point2D>& path,
+                                uint32_t radius)
+    -> std::vector<Point2D>
+{
+    std::vector<Point2D> pixels;
+    std::unordered_set<uint64_t> seen;
+
+    auto dab = [&](const Point2D& center) {
+        for(auto&& point : getPixelsInCircle(dimensions, center, radius)) {
+            if(seen.insert(xyToIndex(dimensions.w, point.x, point.y)).second) {
+                pixels.push_back(point);
+            }
+        }
+    };
+
+    for(size_t i = 0; i < path.size(); ++i) {
+        if(i == 0) {
+            dab(path[i]);
+            continue;
+        }
+
+        // Fill in the gaps between each point, as mouse motion events are not
+        //   guaranteed to be reported for every pixel
+        int64_t dx = static_cast<int64_t>(path[i].x) - path[i - 1].x;
+        int64_t dy = static_cast<int64_t>(path[i].y) - path[i - 1].y;
+        int64_t steps = std::max(std::abs(dx), std::abs(dy));
+
+        for(int64_t step = 1; step <= steps; ++step) {
+            dab({ static_cast<uint32_t>(path[i - 1].x + (dx * step) / steps),
+                  static_cast<uint32_t>(path[i - 1].y + (dy * step) / steps) });
+        }
+    }
+
+    return pixels;
+}
+
+/**
+ * @brief Gets every pixel whose center is inside of a polygon, using the
+ *        even-odd rule. Used for lasso selections.
+ *
+ * @param dimensions The dimensions to clip to
+ * @param vertices The vertices of the polygon. The polygon is implicitly
+ *                 closed.
+ *
+ * @return Every pixel inside of the polygon
+ */
+auto HMDT::getPixelsInPolygon(const Dimensions& dimensions,
+                              const std::vector<Point2D>& vertices)
+    -> std::vector<Point2D>
+{
+    std::vector<Point2D> pixels;
+
+    if(vertices.size() < 3) {
+        return pixels;
+    }
+
+    uint32_t min_y = dimensions.h;
+    uint32_t max_y = 0;
+    for(auto&& vertex : vertices) {
+        min_y = std::min(min_y, vertex.y);
+        max_y = std::max(max_y, vertex.y);
+    }
+    max_y = std::min(max_y, dimensions.h - 1);
+
+    std::vector<double> crossings;
+
+    // Scanline fill: find where each row crosses the edges of the polygon, and
+    //   fill in between every pair of crossings
+    for(uint32_t y = min_y; y <= max_y; ++y) {
+        double scan_y = y + 0.5;
+
+        crossings.clear();
+        for(size_t i = 0; i < vertices.size(); ++i) {
+            const auto& a = vertices[i];
+            const auto& b = vertices[(i + 1) % vertices.size()];
+
+            double ay = a.y + 0.5;
+            double by = b.y + 0.5;
+
+            if((ay <= scan_y && by > scan_y) || (by <= scan_y && ay > scan_y)) {
+                double t = (scan_y - ay) / (by - ay);
+                crossings.push_back((a.x + 0.5) + t * (static_cast<double>(b.x) - a.x));
+            }
+        }
+
+        std::sort(crossings.begin(), crossings.end());
+
+        for(size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            auto start = std::max(0.0, std::ceil(crossings[i] - 0.5));
+            auto end = std::min<double>(dimensions.w - 1,
+                                        std::floor(crossings[i + 1] - 0.5));
+
+            for(auto x = static_cast<int64_t>(start); x <= static_cast<int64_t>(end); ++x)
+            {
+                pixels.push_back({ static_cast<uint32_t>(x), y });
+            }
+        }
+    }
+
+    return pixels;
+}
+
 // Forward declaration
 namespace HMDT {
     ProvinceType getProvinceType(const Color&);
@@ -352,7 +697,7 @@ auto HMDT::createProvincesFromShapeList(const PolygonList& shapes)
             "None",
             0,
             shape.bounding_box,
-            { },
+            shape.adjacent_labels,
             INVALID_PROVINCE  /* parent_id */,
             { } /* children */
         };
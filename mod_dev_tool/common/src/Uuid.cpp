@@ -141,7 +141,39 @@ std::size_t HMDT::UUID::hash() const noexcept {
     return std::hash<HMDT::UUID>()(*this);
 }
 
+/**
+ * @brief Writes the string representation of this UUID into a buffer, without
+ *        needing to allocate a std::string for it first.
+ *
+ * @param str The buffer to write into. Must have room for STRING_REPR_LENGTH
+ *            characters plus a null-terminator.
+ */
+void HMDT::UUID::toChars(char* str) const noexcept {
+#ifdef WIN32
+    unsigned char* rpc_str;
+    UuidToStringA(&m_internal_uuid, &rpc_str);
+
+    std::memcpy(str, rpc_str, STRING_REPR_LENGTH + 1);
+
+    RpcStringFreeA(&rpc_str);
+#else
+    uuid_unparse(m_internal_uuid, str);
+#endif
+}
+
 HMDT::Maybe<HMDT::UUID> HMDT::UUID::parse(const std::string& str) noexcept {
+    return parse(str.c_str());
+}
+
+/**
+ * @brief Parses a UUID out of a null-terminated string, without needing to
+ *        allocate a std::string for it first.
+ *
+ * @param str The string to parse
+ *
+ * @return The parsed UUID
+ */
+HMDT::Maybe<HMDT::UUID> HMDT::UUID::parse(const char* str) noexcept {
     UUID uuid(EMPTY_UUID);
 
 #ifdef WIN32
@@ -149,11 +181,11 @@ HMDT::Maybe<HMDT::UUID> HMDT::UUID::parse(const std::string& str) noexcept {
     //   non-const pointer rather than by const pointer. So, make sure we cast
     //   away the const-ness before calling this function.
     auto status = UuidFromStringA(
-            reinterpret_cast<RPC_CSTR>(const_cast<char*>(str.c_str())),
+            reinterpret_cast<RPC_CSTR>(const_cast<char*>(str)),
             const_cast<SystemUUIDType*>(&uuid.m_internal_uuid));
     constexpr auto FAILURE_STATUS = RPC_S_INVALID_STRING_UUID;
 #else
-    auto status = uuid_parse(str.c_str(), uuid.m_internal_uuid);
+    auto status = uuid_parse(str, uuid.m_internal_uuid);
     constexpr auto FAILURE_STATUS = -1;
 #endif
 
@@ -213,18 +245,8 @@ HMDT::HashOnlyUUID::HashOnlyUUID(std::size_t hash):
 { }
 
 std::string std::to_string(const HMDT::UUID& uuid) {
-#ifdef WIN32
-    unsigned char* str;
-    UuidToStringA(&uuid.getSystemType(), &str);
-
-    std::string s((char*)str);
-
-    RpcStringFreeA(&str);
-#else
-
-    char s[37];
-    uuid_unparse(uuid.getSystemType(), s);
-#endif
+    char s[HMDT::UUID::STRING_REPR_LENGTH + 1];
+    uuid.toChars(s);
 
     return s;
 }
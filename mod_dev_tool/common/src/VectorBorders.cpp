@@ -0,0 +1,628 @@
+/**
+ * @file VectorBorders.cpp
+ *
+ * @brief Defines functions for tracing the borders between regions of a
+ *        per-pixel layer into vector lines, and for writing them out.
+ */
+
+#include "VectorBorders.h"
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <tuple>
+
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    //! There is a border along the edge going right from a corner
+    constexpr uint8_t EDGE_RIGHT = 0x1;
+
+    //! There is a border along the edge going down from a corner
+    constexpr uint8_t EDGE_DOWN = 0x2;
+
+    //! The border going right from a corner is already part of an arc
+    constexpr uint8_t VISITED_RIGHT = 0x4;
+
+    //! The border going down from a corner is already part of an arc
+    constexpr uint8_t VISITED_DOWN = 0x8;
+
+    /**
+     * @brief A direction to walk along the edges between pixels
+     */
+    enum class Direction {
+        RIGHT,
+        DOWN,
+        LEFT,
+        UP
+    };
+
+    constexpr Direction ALL_DIRECTIONS[] = {
+        Direction::RIGHT, Direction::DOWN, Direction::LEFT, Direction::UP
+    };
+
+    Direction opposite(Direction direction) {
+        switch(direction) {
+            case Direction::RIGHT: return Direction::LEFT;
+            case Direction::DOWN: return Direction::UP;
+            case Direction::LEFT: return Direction::RIGHT;
+            case Direction::UP: default: return Direction::DOWN;
+        }
+    }
+
+    /**
+     * @brief Every corner of every pixel, along with which of the edges
+     *        between pixels starting at it are borders.
+     * @details Only the edges going right and down are stored on each corner,
+     *          the edges going left and up are stored on the corners they
+     *          come from instead, so that every edge is only stored once.
+     */
+    class CornerGrid {
+        public:
+            CornerGrid(const HMDT::Dimensions& dimensions):
+                m_dimensions(dimensions),
+                m_width(dimensions.w + 1),
+                m_height(dimensions.h + 1),
+                m_edges(static_cast<uint64_t>(m_width) * m_height, 0)
+            { }
+
+            uint8_t& at(uint32_t x, uint32_t y) {
+                return m_edges[HMDT::xyToIndex(m_width, x, y)];
+            }
+
+            uint32_t width() const { return m_width; }
+            uint32_t height() const { return m_height; }
+
+            /**
+             * @brief Finds which corner and flag an edge is stored on
+             */
+            std::pair<uint8_t*, uint8_t> findEdge(uint32_t x, uint32_t y,
+                                                  Direction direction)
+            {
+                switch(direction) {
+                    case Direction::RIGHT:
+                        return { (x + 1 < m_width) ? &at(x, y) : nullptr, EDGE_RIGHT };
+                    case Direction::DOWN:
+                        return { (y + 1 < m_height) ? &at(x, y) : nullptr, EDGE_DOWN };
+                    case Direction::LEFT:
+                        return { (x > 0) ? &at(x - 1, y) : nullptr, EDGE_RIGHT };
+                    case Direction::UP: default:
+                        return { (y > 0) ? &at(x, y - 1) : nullptr, EDGE_DOWN };
+                }
+            }
+
+            bool hasEdge(uint32_t x, uint32_t y, Direction direction) {
+                auto [corner, flag] = findEdge(x, y, direction);
+                return corner != nullptr && (*corner & flag);
+            }
+
+            bool isVisited(uint32_t x, uint32_t y, Direction direction) {
+                auto [corner, flag] = findEdge(x, y, direction);
+                return corner != nullptr && (*corner & toVisitedFlag(flag));
+            }
+
+            void markVisited(uint32_t x, uint32_t y, Direction direction) {
+                if(auto [corner, flag] = findEdge(x, y, direction); corner) {
+                    *corner |= toVisitedFlag(flag);
+                }
+            }
+
+            /**
+             * @brief Counts how many borders meet at a corner
+             */
+            uint32_t countEdges(uint32_t x, uint32_t y) {
+                uint32_t count = 0;
+                for(auto direction : ALL_DIRECTIONS) {
+                    count += hasEdge(x, y, direction);
+                }
+                return count;
+            }
+
+            /**
+             * @brief Finds the pixel on either side of an edge
+             *
+             * @return The pixel on the left and on the right when walking
+             *         along the edge in the given direction, or
+             *         BORDER_OUTSIDE_MAP for either of them
+             */
+            std::pair<uint64_t, uint64_t> findSides(uint32_t x, uint32_t y,
+                                                    Direction direction) const
+            {
+                auto pixel = [this](bool inside, uint32_t px, uint32_t py) {
+                    return inside ? HMDT::xyToIndex(m_dimensions.w, px, py)
+                                  : HMDT::BORDER_OUTSIDE_MAP;
+                };
+
+                // Note that y points down, so walking right has the pixel
+                //   above on the left
+                switch(direction) {
+                    case Direction::RIGHT:
+                        return { pixel(y > 0, x, y - 1),
+                                 pixel(y < m_dimensions.h, x, y) };
+                    case Direction::DOWN:
+                        return { pixel(x < m_dimensions.w, x, y),
+                                 pixel(x > 0, x - 1, y) };
+                    case Direction::LEFT:
+                        return { pixel(y < m_dimensions.h, x - 1, y),
+                                 pixel(y > 0, x - 1, y - 1) };
+                    case Direction::UP: default:
+                        return { pixel(x > 0, x - 1, y - 1),
+                                 pixel(x < m_dimensions.w, x, y - 1) };
+                }
+            }
+
+        private:
+            static uint8_t toVisitedFlag(uint8_t edge_flag) {
+                return (edge_flag == EDGE_RIGHT) ? VISITED_RIGHT : VISITED_DOWN;
+            }
+
+            HMDT::Dimensions m_dimensions;
+
+            uint32_t m_width;
+            uint32_t m_height;
+
+            //! The EDGE_* and VISITED_* flags of every corner
+            std::vector<uint8_t> m_edges;
+    };
+
+    /**
+     * @brief Finds every edge between two pixels of a different region, and
+     *        every edge along the outside of the map.
+     */
+    template<typename T>
+    void findBorderEdges(const HMDT::Dimensions& dimensions, const T* labels,
+                         CornerGrid& grid)
+    {
+        HMDT::parallelForEachRange(grid.height(), [&](uint64_t begin, uint64_t end)
+        {
+            for(uint32_t y = begin; y < end; ++y) {
+                for(uint32_t x = 0; x < grid.width(); ++x) {
+                    uint8_t flags = 0;
+
+                    // Between the pixel above and the pixel below
+                    if(x < dimensions.w &&
+                       (y == 0 || y == dimensions.h ||
+                        labels[HMDT::xyToIndex(dimensions.w, x, y - 1)] !=
+                            labels[HMDT::xyToIndex(dimensions.w, x, y)]))
+                    {
+                        flags |= EDGE_RIGHT;
+                    }
+
+                    // Between the pixel on the left and the pixel on the right
+                    if(y < dimensions.h &&
+                       (x == 0 || x == dimensions.w ||
+                        labels[HMDT::xyToIndex(dimensions.w, x - 1, y)] !=
+                            labels[HMDT::xyToIndex(dimensions.w, x, y)]))
+                    {
+                        flags |= EDGE_DOWN;
+                    }
+
+                    grid.at(x, y) = flags;
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Walks along a border from a corner until reaching a junction, or
+     *        until coming back around to the corner again.
+     * @details Only the corners where the border turns are kept.
+     */
+    HMDT::BorderArc traceArc(CornerGrid& grid, uint32_t start_x,
+                             uint32_t start_y, Direction direction)
+    {
+        HMDT::BorderArc arc;
+        std::tie(arc.left_pixel, arc.right_pixel) = grid.findSides(start_x, start_y,
+                                                                   direction);
+        arc.points.push_back({ start_x, start_y });
+
+        uint32_t x = start_x;
+        uint32_t y = start_y;
+
+        while(true) {
+            grid.markVisited(x, y, direction);
+
+            switch(direction) {
+                case Direction::RIGHT: ++x; break;
+                case Direction::DOWN: ++y; break;
+                case Direction::LEFT: --x; break;
+                case Direction::UP: --y; break;
+            }
+
+            if((x == start_x && y == start_y) || grid.countEdges(x, y) != 2) {
+                arc.points.push_back({ x, y });
+                break;
+            }
+
+            // Every other corner has exactly one more border going out of it
+            auto came_from = opposite(direction);
+            for(auto next : ALL_DIRECTIONS) {
+                if(next != came_from && grid.hasEdge(x, y, next)) {
+                    if(next != direction) {
+                        arc.points.push_back({ x, y });
+                    }
+                    direction = next;
+                    break;
+                }
+            }
+        }
+
+        return arc;
+    }
+
+    template<typename T>
+    auto extractBordersImpl(const HMDT::Dimensions& dimensions, const T* labels) noexcept
+        -> HMDT::Maybe<std::vector<HMDT::BorderArc>>
+    {
+        RETURN_ERROR_IF(labels == nullptr, HMDT::STATUS_PARAM_CANNOT_BE_NULL);
+
+        std::vector<HMDT::BorderArc> arcs;
+
+        try {
+            CornerGrid grid(dimensions);
+            findBorderEdges(dimensions, labels, grid);
+
+            // Start with every arc which ends at a junction, so that every
+            //   junction is always at the end of an arc
+            for(uint32_t y = 0; y < grid.height(); ++y) {
+                for(uint32_t x = 0; x < grid.width(); ++x) {
+                    // A corner with no borders going right or down can at
+                    //   most have two, so it can't be a junction
+                    if(grid.at(x, y) == 0) continue;
+
+                    auto count = grid.countEdges(x, y);
+                    if(count == 2) continue;
+
+                    for(auto direction : ALL_DIRECTIONS) {
+                        if(grid.hasEdge(x, y, direction) &&
+                           !grid.isVisited(x, y, direction))
+                        {
+                            arcs.push_back(traceArc(grid, x, y, direction));
+                        }
+                    }
+                }
+            }
+
+            // Whatever is left forms closed rings, such as around a region
+            //   which only has a single neighbor. The first corner found for
+            //   each ring is its top-left one, which always has a border
+            //   going right out of it.
+            for(uint32_t y = 0; y < grid.height(); ++y) {
+                for(uint32_t x = 0; x < grid.width(); ++x) {
+                    if((grid.at(x, y) & (EDGE_RIGHT | VISITED_RIGHT)) == EDGE_RIGHT)
+                    {
+                        arcs.push_back(traceArc(grid, x, y, Direction::RIGHT));
+                    }
+                }
+            }
+        } catch(const std::bad_alloc&) {
+            RETURN_ERROR(HMDT::STATUS_BADALLOC);
+        }
+
+        return arcs;
+    }
+
+    /**
+     * @brief Calculates how far a point is from the line segment between two
+     *        other points.
+     */
+    double distanceToSegment(const HMDT::Point2D& point,
+                             const HMDT::Point2D& start,
+                             const HMDT::Point2D& end)
+    {
+        double px = point.x, py = point.y;
+        double sx = start.x, sy = start.y;
+        double dx = static_cast<double>(end.x) - sx;
+        double dy = static_cast<double>(end.y) - sy;
+
+        double length_sq = dx * dx + dy * dy;
+        double t = 0;
+        if(length_sq > 0) {
+            t = std::clamp(((px - sx) * dx + (py - sy) * dy) / length_sq, 0.0, 1.0);
+        }
+
+        return std::hypot(px - (sx + t * dx), py - (sy + t * dy));
+    }
+
+    /**
+     * @brief Simplifies a single arc with the Douglas-Peucker algorithm,
+     *        keeping both of its ends where they are.
+     */
+    void simplifyArc(HMDT::BorderArc& arc, double tolerance) {
+        auto& points = arc.points;
+        if(points.size() <= 2) {
+            return;
+        }
+
+        auto last = points.size() - 1;
+
+        std::vector<bool> keep(points.size(), false);
+        keep.front() = true;
+        keep.back() = true;
+
+        std::vector<std::pair<size_t, size_t>> segments;
+        if(arc.isRing()) {
+            // A ring starts and ends at the same point, so it also gets
+            //   anchored at the point furthest away from its start
+            size_t furthest = 0;
+            double furthest_distance = -1;
+            for(size_t i = 1; i < last; ++i) {
+                auto distance = distanceToSegment(points[i], points[0], points[0]);
+                if(distance > furthest_distance) {
+                    furthest = i;
+                    furthest_distance = distance;
+                }
+            }
+
+            keep[furthest] = true;
+            segments.push_back({ 0, furthest });
+            segments.push_back({ furthest, last });
+        } else {
+            segments.push_back({ 0, last });
+        }
+
+        while(!segments.empty()) {
+            auto [first, end] = segments.back();
+            segments.pop_back();
+
+            size_t furthest = first;
+            double furthest_distance = -1;
+            for(size_t i = first + 1; i < end; ++i) {
+                auto distance = distanceToSegment(points[i], points[first],
+                                                  points[end]);
+                if(distance > furthest_distance) {
+                    furthest = i;
+                    furthest_distance = distance;
+                }
+            }
+
+            if(furthest != first && furthest_distance > tolerance) {
+                keep[furthest] = true;
+                segments.push_back({ first, furthest });
+                segments.push_back({ furthest, end });
+            }
+        }
+
+        // A ring needs at least three distinct points to still enclose
+        //   anything, so leave rings which would collapse as they are
+        auto kept = std::count(keep.begin(), keep.end(), true);
+        if(arc.isRing() && kept < 4) {
+            return;
+        }
+
+        std::vector<HMDT::Point2D> simplified;
+        simplified.reserve(kept);
+        for(size_t i = 0; i < points.size(); ++i) {
+            if(keep[i]) {
+                simplified.push_back(points[i]);
+            }
+        }
+
+        points = std::move(simplified);
+    }
+
+    /**
+     * @brief Writes a string with every character which is special to XML
+     *        escaped
+     */
+    void writeEscapedXML(std::ostream& out, const std::string& str) {
+        for(auto c : str) {
+            switch(c) {
+                case '&': out << "&amp;"; break;
+                case '<': out << "&lt;"; break;
+                case '>': out << "&gt;"; break;
+                case '"': out << "&quot;"; break;
+                default: out << c; break;
+            }
+        }
+    }
+
+    /**
+     * @brief Writes a string as a JSON string, or null if it is empty
+     */
+    void writeJSONLabel(std::ostream& out, const std::string& str) {
+        if(str.empty()) {
+            out << "null";
+            return;
+        }
+
+        out << '"';
+        for(auto c : str) {
+            if(c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+/**
+ * @brief Checks whether the arc is a closed ring rather than running between
+ *        two junctions.
+ */
+bool HMDT::BorderArc::isRing() const noexcept {
+    return points.size() > 2 &&
+           points.front().x == points.back().x &&
+           points.front().y == points.back().y;
+}
+
+/**
+ * @brief Traces every border between provinces into arcs.
+ * @details Every edge between pixels is checked in parallel, after which the
+ *          borders are followed from junction to junction. The outside of
+ *          the map counts as a border too.
+ *
+ * @param dimensions The dimensions of the map
+ * @param provinces The province of every pixel
+ *
+ * @return Every border, or STATUS_PARAM_CANNOT_BE_NULL if provinces is null.
+ */
+auto HMDT::extractBorders(const Dimensions& dimensions,
+                          const ProvinceID* provinces) noexcept
+    -> Maybe<std::vector<BorderArc>>
+{
+    return extractBordersImpl(dimensions, provinces);
+}
+
+/**
+ * @brief Traces every border between states into arcs.
+ * @details Every edge between pixels is checked in parallel, after which the
+ *          borders are followed from junction to junction. The outside of
+ *          the map counts as a border too.
+ *
+ * @param dimensions The dimensions of the map
+ * @param states The state of every pixel
+ *
+ * @return Every border, or STATUS_PARAM_CANNOT_BE_NULL if states is null.
+ */
+auto HMDT::extractBorders(const Dimensions& dimensions,
+                          const StateID* states) noexcept
+    -> Maybe<std::vector<BorderArc>>
+{
+    return extractBordersImpl(dimensions, states);
+}
+
+/**
+ * @brief Simplifies every arc in parallel, removing every point which is
+ *        closer than the tolerance to the line that would replace it.
+ * @details The ends of each arc never move, so arcs which meet at a junction
+ *          still meet after being simplified, and as every border is only
+ *          ever part of a single arc, neighboring regions never end up with
+ *          gaps or overlaps between them.
+ *
+ * @param arcs The arcs to simplify
+ * @param tolerance How far, in pixels, a simplified arc may stray from the
+ *                  original one. 0 only removes points in the middle of
+ *                  straight lines.
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_BADALLOC if an arc could not
+ *         be simplified.
+ */
+auto HMDT::simplifyBorders(std::vector<BorderArc>& arcs,
+                           double tolerance) noexcept
+    -> MaybeVoid
+{
+    auto result = tryParallelForEachRange(arcs.size(),
+                                          [&](uint64_t begin, uint64_t end)
+    {
+        for(auto i = begin; i < end; ++i) {
+            simplifyArc(arcs[i], tolerance);
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Writes borders as an SVG image, with one path per arc.
+ * @details Each layer is drawn as its own group, on top of and with thicker
+ *          lines than the layer before it. The regions on either side of
+ *          every path are written as its data-left and data-right attributes.
+ *
+ * @param out The stream to write to
+ * @param dimensions The dimensions of the map
+ * @param layers Every layer to write
+ */
+void HMDT::writeBordersSVG(std::ostream& out, const Dimensions& dimensions,
+                           const std::vector<BorderLayer>& layers)
+{
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<svg xmlns=\"http://www.w3.org/2000/svg\""
+        << " width=\"" << dimensions.w << "\" height=\"" << dimensions.h << '"'
+        << " viewBox=\"0 0 " << dimensions.w << ' ' << dimensions.h << "\">\n";
+
+    for(size_t l = 0; l < layers.size(); ++l) {
+        const auto& layer = layers[l];
+
+        out << "  <g id=\"";
+        writeEscapedXML(out, layer.name);
+        out << "\" fill=\"none\" stroke=\"black\" stroke-width=\"" << (l + 1)
+            << "\" stroke-linejoin=\"round\" stroke-linecap=\"round\">\n";
+
+        for(size_t i = 0; i < layer.arcs.size(); ++i) {
+            const auto& arc = layer.arcs[i];
+
+            out << "    <path d=\"";
+
+            // A ring is closed back up to its first point instead
+            auto count = arc.isRing() ? arc.points.size() - 1 : arc.points.size();
+            for(size_t p = 0; p < count; ++p) {
+                out << (p == 0 ? 'M' : 'L') << arc.points[p].x << ' '
+                                            << arc.points[p].y;
+            }
+            if(arc.isRing()) {
+                out << 'Z';
+            }
+            out << '"';
+
+            if(i < layer.arc_labels.size()) {
+                const auto& [left, right] = layer.arc_labels[i];
+
+                out << " data-left=\"";
+                writeEscapedXML(out, left);
+                out << "\" data-right=\"";
+                writeEscapedXML(out, right);
+                out << '"';
+            }
+
+            out << "/>\n";
+        }
+
+        out << "  </g>\n";
+    }
+
+    out << "</svg>\n";
+}
+
+/**
+ * @brief Writes borders as a GeoJSON FeatureCollection, with one LineString
+ *        feature per arc.
+ * @details Coordinates are in pixels with y pointing up, so that the map is
+ *          not upside down in GIS tools. Every feature has the name of its
+ *          layer and the region on either side of it as its "layer", "left"
+ *          and "right" properties, where a missing region is null.
+ *
+ * @param out The stream to write to
+ * @param dimensions The dimensions of the map
+ * @param layers Every layer to write
+ */
+void HMDT::writeBordersGeoJSON(std::ostream& out, const Dimensions& dimensions,
+                               const std::vector<BorderLayer>& layers)
+{
+    out << "{\"type\":\"FeatureCollection\",\"features\":[";
+
+    bool first_feature = true;
+    for(auto&& layer : layers) {
+        for(size_t i = 0; i < layer.arcs.size(); ++i) {
+            const auto& arc = layer.arcs[i];
+
+            out << (first_feature ? "\n" : ",\n");
+            first_feature = false;
+
+            out << "{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\","
+                   "\"coordinates\":[";
+            for(size_t p = 0; p < arc.points.size(); ++p) {
+                out << (p == 0 ? "[" : ",[") << arc.points[p].x << ','
+                    << (dimensions.h - arc.points[p].y) << ']';
+            }
+            out << "]},\"properties\":{\"layer\":";
+            writeJSONLabel(out, layer.name);
+
+            std::string left, right;
+            if(i < layer.arc_labels.size()) {
+                std::tie(left, right) = layer.arc_labels[i];
+            }
+
+            out << ",\"left\":";
+            writeJSONLabel(out, left);
+            out << ",\"right\":";
+            writeJSONLabel(out, right);
+            out << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+}
@@ -11,6 +11,9 @@
 #include "WorldNormalBuilder.h"
 
 #include <cmath> // std::sqrt
+#include <memory>
+
+#include "Logger.h"
 
 #include "BitMap.h"
 #include "Util.h"
@@ -55,52 +58,128 @@ namespace {
     }
 }
 
+/**
+ * @brief Generates a world normal map from the given input.
+ *
+ * @param heightmap The input heightmap to generate a normal map from. Must be
+ *                  an 8-bit image.
+ * @param normal_data The output image data array. All normal map information
+ *                    will be written here.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the heightmap is not
+ *         an 8-bit image.
+ */
 auto HMDT::generateWorldNormalMap(const BitMap2& heightmap,
                                   unsigned char* normal_data)
     -> MaybeVoid
 {
-    auto width = heightmap.info_header.v1.width;
-    auto height = heightmap.info_header.v1.height;
+    uint32_t width = heightmap.info_header.v1.width;
+    uint32_t height = heightmap.info_header.v1.height;
 
     // Heightmaps _MUST_ be 8-bit images
     if(heightmap.info_header.v1.bitsPerPixel != 8) {
         RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
     }
 
-    // For every single pixel
-    for(int y = 0; y < height; ++y) {
-        for(int x = 0; x < width; ++x) {
+    // Resolve every pixel through the color table once up-front, so that the
+    //   filter itself only has to deal with plain height values
+    std::unique_ptr<uint8_t[]> heights;
+    try {
+        heights.reset(new uint8_t[width * height]);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate enough space for the heightmap data.");
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    for(uint32_t index = 0; index < width * height; ++index) {
+        auto color = getColorAt(heightmap, index);
+        RETURN_IF_ERROR(color);
+
+        heights[index] = static_cast<uint8_t>((color->r + color->g + color->b) / 3);
+    }
+
+    return generateWorldNormalMap(heights.get(), Dimensions{ width, height },
+                                  normal_data);
+}
+
+/**
+ * @brief Generates a world normal map from raw 8-bit height values.
+ *
+ * @param heightmap The input heights, one byte per pixel.
+ * @param dimensions The dimensions of the heightmap.
+ * @param normal_data The output image data array. All normal map information
+ *                    will be written here.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if a parameter is null.
+ */
+auto HMDT::generateWorldNormalMap(const uint8_t* heightmap,
+                                  const Dimensions& dimensions,
+                                  unsigned char* normal_data)
+    -> MaybeVoid
+{
+    return generateWorldNormalMap(heightmap, dimensions, normal_data,
+                                  Rectangle{ 0, 0, dimensions.w, dimensions.h });
+}
+
+/**
+ * @brief Generates only one region of a world normal map from raw 8-bit
+ *        height values.
+ * @details Every pixel of the region is filtered with its neighbors, even the
+ *          ones outside of the region, so regenerating a region produces
+ *          exactly the same output as regenerating the whole map. Pixels of
+ *          normal_data outside of the region are left untouched.
+ *
+ * @param heightmap The input heights, one byte per pixel.
+ * @param dimensions The dimensions of the heightmap.
+ * @param normal_data The output image data array, sized for the whole map.
+ * @param region The region of the map to regenerate.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if a parameter is null
+ *         or the region does not fit inside of the map.
+ */
+auto HMDT::generateWorldNormalMap(const uint8_t* heightmap,
+                                  const Dimensions& dimensions,
+                                  unsigned char* normal_data,
+                                  const Rectangle& region)
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(heightmap == nullptr || normal_data == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    if(region.x + region.w > dimensions.w || region.y + region.h > dimensions.h)
+    {
+        WRITE_ERROR("Region (", region.x, ", ", region.y, ", ", region.w, ", ",
+                    region.h, ") does not fit inside of a ", dimensions.w, "x",
+                    dimensions.h, " heightmap.");
+        RETURN_ERROR(STATUS_OUT_OF_RANGE);
+    }
+
+    auto width = dimensions.w;
+
+    // For every single pixel in the region
+    for(uint32_t y = region.y; y < region.y + region.h; ++y) {
+        // Neighboring rows, clamped to the edges of the map
+        auto y0 = (y == 0) ? y : y - 1;
+        auto y1 = (y + 1 == dimensions.h) ? y : y + 1;
+
+        for(uint32_t x = region.x; x < region.x + region.w; ++x) {
             // Index into normal_data based on our current X,Y coordinate
             // Hardcode 3 because we want the output to have a pixel-depth of 3
             auto index = xyToIndex(width * 3, x * 3, y);
 
-            // Surrounding pixels
-            auto top_left  = getAsPixel(heightmap, clamp(x - 1, 0, width), clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top_left);
-            auto top       = getAsPixel(heightmap, x, clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top);
-            auto top_right = getAsPixel(heightmap, clamp(x + 1, 0, width), clamp(y - 1, 0, height));
-            RETURN_IF_ERROR(top_right);
-            auto left      = getAsPixel(heightmap, clamp(x - 1, 0, width), y);
-            RETURN_IF_ERROR(left);
-            auto right     = getAsPixel(heightmap, clamp(x + 1, 0, width), y);
-            RETURN_IF_ERROR(right);
-            auto bot_left  = getAsPixel(heightmap, clamp(x - 1, 0, width), clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot_left);
-            auto bot       = getAsPixel(heightmap, x, clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot);
-            auto bot_right = getAsPixel(heightmap, clamp(x + 1, 0, width), clamp(y + 1, 0, height));
-            RETURN_IF_ERROR(bot_right);
+            // Neighboring columns, clamped to the edges of the map
+            auto x0 = (x == 0) ? x : x - 1;
+            auto x1 = (x + 1 == width) ? x : x + 1;
 
             // Get intensities of surrounding pixels
-            double tl_intensity = intensity(top_left->color);
-            double t_intensity = intensity(top->color);
-            double tr_intensity = intensity(top_right->color);
-            double l_intensity = intensity(left->color);
-            double r_intensity = intensity(right->color);
-            double bl_intensity = intensity(bot_left->color);
-            double b_intensity = intensity(bot->color);
-            double br_intensity = intensity(bot_right->color);
+            double tl_intensity = heightmap[xyToIndex(width, x0, y0)] / 255.0;
+            double t_intensity  = heightmap[xyToIndex(width, x,  y0)] / 255.0;
+            double tr_intensity = heightmap[xyToIndex(width, x1, y0)] / 255.0;
+            double l_intensity  = heightmap[xyToIndex(width, x0, y)] / 255.0;
+            double r_intensity  = heightmap[xyToIndex(width, x1, y)] / 255.0;
+            double bl_intensity = heightmap[xyToIndex(width, x0, y1)] / 255.0;
+            double b_intensity  = heightmap[xyToIndex(width, x,  y1)] / 255.0;
+            double br_intensity = heightmap[xyToIndex(width, x1, y1)] / 255.0;
 
             // sobel filter
             double dX = (tr_intensity + 2.0 * r_intensity + br_intensity) - (tl_intensity + 2.0 * l_intensity + bl_intensity);
@@ -116,9 +195,10 @@ auto HMDT::generateWorldNormalMap(const BitMap2& heightmap,
             auto b = static_cast<std::uint8_t>((nZ + 1.0) * (255.0 / 2.0));
 
             // Finally, place the new color data into the output array.
-            normal_data[index] = r;
+            //  Note: Make sure that B and R are swapped (because .BMP format)
+            normal_data[index] = b;
             normal_data[index + 1] = g;
-            normal_data[index + 2] = b;
+            normal_data[index + 2] = r;
         }
     }
 
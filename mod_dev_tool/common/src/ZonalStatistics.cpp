@@ -0,0 +1,252 @@
+/**
+ * @file ZonalStatistics.cpp
+ *
+ * @brief Defines functions for computing statistics of every province from
+ *        the per-pixel map layers.
+ */
+
+#include "ZonalStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+
+namespace {
+    /**
+     * @brief Everything gathered about a single province while going over
+     *        the map, before it gets turned into ProvinceStatistics.
+     */
+    struct Accumulator {
+        HMDT::ProvincePixelStats pixels;
+
+        uint64_t perimeter = 0;
+        std::unordered_map<HMDT::ProvinceID, uint64_t> border_lengths;
+
+        double slope_sum = 0;
+
+        uint64_t river_pixel_count = 0;
+    };
+
+    using AccumulatorMap = std::unordered_map<HMDT::ProvinceID, Accumulator>;
+
+    /**
+     * @brief Calculates how steep the heightmap is at a single pixel, using
+     *        the difference between the pixels on either side of it.
+     */
+    double calculateSlope(const HMDT::Dimensions& dimensions,
+                          const uint8_t* heightmap, uint32_t x, uint32_t y)
+    {
+        auto left = (x > 0) ? x - 1 : x;
+        auto right = (x + 1 < dimensions.w) ? x + 1 : x;
+        auto up = (y > 0) ? y - 1 : y;
+        auto down = (y + 1 < dimensions.h) ? y + 1 : y;
+
+        double dx = 0;
+        if(right != left) {
+            dx = (static_cast<double>(heightmap[HMDT::xyToIndex(dimensions.w, right, y)]) -
+                  heightmap[HMDT::xyToIndex(dimensions.w, left, y)]) / (right - left);
+        }
+
+        double dy = 0;
+        if(down != up) {
+            dy = (static_cast<double>(heightmap[HMDT::xyToIndex(dimensions.w, x, down)]) -
+                  heightmap[HMDT::xyToIndex(dimensions.w, x, up)]) / (down - up);
+        }
+
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    /**
+     * @brief Adds everything in one accumulator into another
+     */
+    void mergeAccumulator(Accumulator& into, Accumulator&& from) {
+        into.pixels.merge(from.pixels);
+        into.perimeter += from.perimeter;
+
+        for(auto&& [id, length] : from.border_lengths) {
+            into.border_lengths[id] += length;
+        }
+
+        into.slope_sum += from.slope_sum;
+
+        into.river_pixel_count += from.river_pixel_count;
+    }
+}
+
+/**
+ * @brief Computes the statistics of every province in a single parallel pass
+ *        over the map layers.
+ * @details Only the statistics for the requested layers are overwritten, so
+ *          statistics which are still up to date can be kept from an earlier
+ *          call. The pixel count is always recomputed, and provinces which no
+ *          longer have any pixels are removed. As every statistic depends on
+ *          the shape of the provinces, all of them must be requested again
+ *          whenever the provinces layer changes.
+ *
+ * @param layers The layers to compute the statistics from
+ * @param which A combination of ZONAL_LAYER_* flags for which statistics to
+ *              compute
+ * @param statistics The statistics to update
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_PARAM_CANNOT_BE_NULL if a
+ *         layer needed by one of the requested statistics is missing.
+ */
+auto HMDT::computeZonalStatistics(const ZonalStatisticsLayers& layers,
+                                  uint8_t which,
+                                  ProvinceStatisticsMap& statistics) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(layers.provinces == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF((which & ZONAL_LAYER_HEIGHTMAP) && layers.heightmap == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+    RETURN_ERROR_IF((which & ZONAL_LAYER_RIVERS) && layers.rivers == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    const auto& dimensions = layers.dimensions;
+    const auto* provinces = layers.provinces;
+
+    bool do_borders = which & ZONAL_LAYER_PROVINCES;
+    bool do_heights = which & ZONAL_LAYER_HEIGHTMAP;
+    bool do_rivers = which & ZONAL_LAYER_RIVERS;
+
+    AccumulatorMap accumulators;
+    std::mutex accumulators_mutex;
+
+    auto result = tryParallelForEachRange(dimensions.h, [&](uint64_t begin, uint64_t end) {
+        AccumulatorMap local_accumulators;
+
+        auto find_accumulator = [&local_accumulators](const ProvinceID& id) {
+            return &local_accumulators[id];
+        };
+        CachedProvinceLookup cached_accumulator(find_accumulator);
+
+        for(uint32_t y = begin; y < end; ++y) {
+            for(uint32_t x = 0; x < dimensions.w; ++x) {
+                auto index = xyToIndex(dimensions.w, x, y);
+                const auto& id = provinces[index];
+
+                auto& accumulator = *cached_accumulator(id);
+                accumulator.pixels.addPixel(x, y, index);
+
+                if(do_borders) {
+                    // Each border is only looked at from the pixel above or to
+                    //   the left of it, and is then counted for both sides
+                    auto add_border = [&](const ProvinceID& other_id) {
+                        if(other_id != id) {
+                            ++accumulator.perimeter;
+                            ++accumulator.border_lengths[other_id];
+
+                            auto& other = local_accumulators[other_id];
+                            ++other.perimeter;
+                            ++other.border_lengths[id];
+                        }
+                    };
+
+                    if(x + 1 < dimensions.w) {
+                        add_border(provinces[index + 1]);
+                    }
+                    if(y + 1 < dimensions.h) {
+                        add_border(provinces[index + dimensions.w]);
+                    }
+
+                    // The edges of the map are a part of the perimeter too
+                    accumulator.perimeter += (x == 0) + (x + 1 == dimensions.w) +
+                                             (y == 0) + (y + 1 == dimensions.h);
+                }
+
+                if(do_heights) {
+                    auto height = layers.heightmap[index];
+
+                    accumulator.pixels.addHeight(height);
+                    accumulator.slope_sum += calculateSlope(dimensions,
+                                                            layers.heightmap,
+                                                            x, y);
+                }
+
+                if(do_rivers && layers.rivers[index] <= RIVER_WIDEST_INDEX) {
+                    ++accumulator.river_pixel_count;
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(accumulators_mutex);
+        for(auto&& [id, accumulator] : local_accumulators) {
+            mergeAccumulator(accumulators[id], std::move(accumulator));
+        }
+    });
+    RETURN_IF_ERROR(result);
+
+    // Forget about every province which is no longer on the map
+    for(auto it = statistics.begin(); it != statistics.end();) {
+        if(accumulators.count(it->first) == 0) {
+            it = statistics.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for(auto&& [id, accumulator] : accumulators) {
+        auto& stats = statistics[id];
+        stats.pixel_count = accumulator.pixels.count;
+
+        if(do_borders) {
+            stats.perimeter = accumulator.perimeter;
+            stats.border_lengths = std::move(accumulator.border_lengths);
+        }
+
+        if(do_heights) {
+            stats.min_height = accumulator.pixels.min_height;
+            stats.max_height = accumulator.pixels.max_height;
+            stats.mean_height = static_cast<double>(accumulator.pixels.height_sum) /
+                                accumulator.pixels.count;
+            stats.mean_slope = accumulator.slope_sum / accumulator.pixels.count;
+        }
+
+        if(do_rivers) {
+            stats.river_pixel_count = accumulator.river_pixel_count;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Calculates the length of a province's coastline, from how much of
+ *        its border it shares with each neighbor.
+ * @details The province types are looked up here rather than while computing
+ *          the statistics, so that the statistics do not need to be computed
+ *          again whenever a province's type is changed.
+ *
+ * @param statistics The statistics of the province
+ * @param province The province
+ * @param provinces Every province, for looking up the type of each neighbor
+ *
+ * @return How many pixel edges the province shares with provinces on the
+ *         other side of the coast. That is water provinces for land
+ *         provinces, and land provinces for sea and lake provinces.
+ */
+uint64_t HMDT::getCoastlineLength(const ProvinceStatistics& statistics,
+                                  const Province& province,
+                                  const ProvinceList& provinces) noexcept
+{
+    auto is_water = [](const Province& p) {
+        return p.type == ProvinceType::SEA || p.type == ProvinceType::LAKE;
+    };
+
+    bool province_is_water = is_water(province);
+
+    uint64_t length = 0;
+    for(auto&& [id, border_length] : statistics.border_lengths) {
+        if(auto it = provinces.find(id);
+                it != provinces.end() && is_water(it->second) != province_is_water)
+        {
+            length += border_length;
+        }
+    }
+
+    return length;
+}
@@ -5,6 +5,10 @@
 namespace HMDT {
     int runHeadless();
     int runGUIApplication();
+    int runRenderMap();
+    int runDiffProjects();
+    int runProvinceStatistics();
+    int runExportBorders();
 
     int runApplication();
 }
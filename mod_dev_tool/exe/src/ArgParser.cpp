@@ -29,6 +29,17 @@ void HMDT::printHelp() {
     std::cout << "\t   --debug                 Should debugging features be enabled." << std::endl;
     std::cout << "\t   --dont-write-logfiles   Should log files get written to a file." << std::endl;
     std::cout << "\t   --fix-warnings-on-load  Whether or not problems in a project file should attempt to be fixed when they are loaded." << std::endl;
+    std::cout << "\t   --split-oversized-provinces Split provinces which are too large for the map into smaller ones when importing." << std::endl;
+    std::cout << "\t   --absorb-tiny-provinces Merge provinces which are too small into their neighbors when importing." << std::endl;
+    std::cout << "\t   --render-map=MODE       Render INFILE (a project file) into the bitmap OUTPATH without the GUI. MODE is one of provinces, states, continents, terrain, coastal, or heightmap." << std::endl;
+    std::cout << "\t   --render-scale=N        How many pixels of the rendered image every pixel of the map becomes. Defaults to 1." << std::endl;
+    std::cout << "\t   --render-selection=IDS  A comma-separated list of province IDs to draw as selected in the rendered image." << std::endl;
+    std::cout << "\t   --diff=PROJECT          Compare INFILE (a project file) against the older project file PROJECT and write what changed to OUTPATH without the GUI." << std::endl;
+    std::cout << "\t   --diff-format=FORMAT    The format to write the differences in. FORMAT is one of text or json. Defaults to text." << std::endl;
+    std::cout << "\t   --diff-image=FILE       Also render every changed pixel into the bitmap FILE." << std::endl;
+    std::cout << "\t   --province-stats=FORMAT Write the statistics of every province in INFILE (a project file) to OUTPATH without the GUI. FORMAT is one of csv or json." << std::endl;
+    std::cout << "\t   --export-borders=FORMAT Trace the province and state borders of INFILE (a project file) into OUTPATH without the GUI. FORMAT is one of svg or geojson." << std::endl;
+    std::cout << "\t   --borders-simplify=N    How many pixels the exported borders may be simplified by. Defaults to 0." << std::endl;
     std::cout << "\t-v,--verbose               Display all output." << std::endl;
     std::cout << "\t-q,--quiet                 Display only errors and warnings (does not affect this message)." << std::endl;
     std::cout << "\t-h,--help                  Display this message and exit." << std::endl;
@@ -65,11 +76,22 @@ auto HMDT::parseArgs(int argc, char** argv) -> ProgramOptions {
         { "debug", no_argument, NULL, 8 },
         { "dont-write-logfiles", no_argument, NULL, 9 },
         { "fix-warnings-on-load", no_argument, NULL, 10 },
+        { "split-oversized-provinces", no_argument, NULL, 11 },
+        { "absorb-tiny-provinces", no_argument, NULL, 12 },
+        { "render-map", required_argument, NULL, 13 },
+        { "render-scale", required_argument, NULL, 14 },
+        { "render-selection", required_argument, NULL, 15 },
+        { "diff", required_argument, NULL, 16 },
+        { "diff-format", required_argument, NULL, 17 },
+        { "diff-image", required_argument, NULL, 18 },
+        { "province-stats", required_argument, NULL, 19 },
+        { "export-borders", required_argument, NULL, 20 },
+        { "borders-simplify", required_argument, NULL, 21 },
         { nullptr, 0, nullptr, 0}
     };
 
     // Setup default option values
-    ProgramOptions prog_opts { 0, "", "", false, false, "", "", false, "", false, false, false, false, false };
+    ProgramOptions prog_opts { 0, "", "", false, false, "", "", false, "", false, false, false, false, false, false, false, "", 1.0, "", "", "text", "", "", "", 0.0 };
 
     int optindex = 0;
     int c = 0;
@@ -139,6 +161,98 @@ auto HMDT::parseArgs(int argc, char** argv) -> ProgramOptions {
             case 10: // --fix-warnings-on-load
                 prog_opts.fix_warnings_on_load = true;
                 break;
+            case 11: // --split-oversized-provinces
+                prog_opts.split_oversized_provinces = true;
+                break;
+            case 12: // --absorb-tiny-provinces
+                prog_opts.absorb_tiny_provinces = true;
+                break;
+            case 13: // --render-map
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'render-map'. Assuming no option.");
+                    prog_opts.render_map_mode = "";
+                } else {
+                    prog_opts.render_map_mode = optarg;
+                }
+                break;
+            case 14: // --render-scale
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'render-scale'. Assuming 1.");
+                    prog_opts.render_scale = 1.0;
+                } else {
+                    try {
+                        prog_opts.render_scale = std::stod(optarg);
+                    } catch(const std::exception&) {
+                        WRITE_ERROR("Invalid argument to option 'render-scale': `"s + optarg + '`');
+                        prog_opts.status = 1;
+                        printHelp();
+                        return prog_opts;
+                    }
+                }
+                break;
+            case 15: // --render-selection
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'render-selection'. Assuming no option.");
+                    prog_opts.render_selection = "";
+                } else {
+                    prog_opts.render_selection = optarg;
+                }
+                break;
+            case 16: // --diff
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'diff'. Assuming no option.");
+                    prog_opts.diff_against = "";
+                } else {
+                    prog_opts.diff_against = optarg;
+                }
+                break;
+            case 17: // --diff-format
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'diff-format'. Assuming text.");
+                    prog_opts.diff_format = "text";
+                } else {
+                    prog_opts.diff_format = optarg;
+                }
+                break;
+            case 18: // --diff-image
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'diff-image'. Assuming no option.");
+                    prog_opts.diff_image = "";
+                } else {
+                    prog_opts.diff_image = optarg;
+                }
+                break;
+            case 19: // --province-stats
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'province-stats'. Assuming no option.");
+                    prog_opts.province_stats_format = "";
+                } else {
+                    prog_opts.province_stats_format = optarg;
+                }
+                break;
+            case 20: // --export-borders
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'export-borders'. Assuming no option.");
+                    prog_opts.export_borders_format = "";
+                } else {
+                    prog_opts.export_borders_format = optarg;
+                }
+                break;
+            case 21: // --borders-simplify
+                if(optarg == nullptr) {
+                    WRITE_WARN("Missing argument to option 'borders-simplify'. Assuming 0.");
+                    prog_opts.borders_simplify = 0.0;
+                } else {
+                    try {
+                        prog_opts.borders_simplify = std::stod(optarg);
+                    } catch(const std::exception&) {
+                        WRITE_ERROR("Invalid argument to option 'borders-simplify': `"s + optarg + '`');
+                        prog_opts.status = 1;
+                        printHelp();
+                        return prog_opts;
+                    }
+                }
+                break;
             case 'v': // -v,--verbose
                 if(prog_opts.quiet) {
                     WRITE_ERROR("Conflicting command line arguments 'v' and 'q'");
@@ -178,8 +292,14 @@ auto HMDT::parseArgs(int argc, char** argv) -> ProgramOptions {
     if(auto i = optind; i < argc - 1) {
         prog_opts.infilename = argv[i];
         prog_opts.outpath = argv[i + 1];
-    } else if(prog_opts.headless) {
-        // We only require the file options if we are in headless mode
+    } else if(prog_opts.headless || !prog_opts.render_map_mode.empty() ||
+              !prog_opts.diff_against.empty() ||
+              !prog_opts.province_stats_format.empty() ||
+              !prog_opts.export_borders_format.empty())
+    {
+        // We only require the file options if we are in headless mode, are
+        //   rendering the map, are diffing projects, or are writing province
+        //   statistics or borders
         WRITE_ERROR("Missing required argument(s)");
         prog_opts.status = 1;
         printHelp();
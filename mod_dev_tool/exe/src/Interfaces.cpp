@@ -11,8 +11,15 @@
 #include "BitMap.h" // BitMap
 #include "Types.h" // Point, Color, Polygon, Pixel
 #include "Logger.h"
+#include "RecordWriter.h"
 #include "Util.h"
 #include "Options.h"
+#include "MapRenderer.h"
+#include "ProjectDiff.h"
+#include "VectorBorders.h"
+
+// Project
+#include "HoI4Project.h"
 
 // GUI
 #include "Driver.h"
@@ -192,10 +199,38 @@ int HMDT::runHeadless() {
     }
 
     WRITE_INFO("Writing province definition file...");
-    std::ofstream output_csv(output_path / "definition.csv");
-
-    for(auto&& [id, province] : provinces) {
-        output_csv << std::dec << province << std::endl;
+    {
+        // Sort by color, as that is decided by the input image rather than
+        //   being randomly generated
+        std::vector<const Province*> sorted_provinces;
+        sorted_provinces.reserve(provinces.size());
+        for(auto&& [id, province] : provinces) {
+            sorted_provinces.push_back(&province);
+        }
+        std::sort(sorted_provinces.begin(), sorted_provinces.end(),
+                  [](const Province* p1, const Province* p2) {
+                      return colorToRGB(p1->unique_color) <
+                             colorToRGB(p2->unique_color);
+                  });
+
+        auto res = writeRecordsToFile(output_path / "definition.csv",
+                                      sorted_provinces.size(), ';',
+            [&sorted_provinces](size_t i, RecordWriter& writer) {
+                const auto* province = sorted_provinces[i];
+
+                writer.writeRecord(province->id,
+                                   province->unique_color.r,
+                                   province->unique_color.g,
+                                   province->unique_color.b,
+                                   province->type,
+                                   province->coastal,
+                                   province->terrain,
+                                   province->continent);
+            });
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to write the province definition file.");
+            return 1;
+        }
     }
 
     // Only produce each state definition file if there are actually states to
@@ -268,8 +303,240 @@ int HMDT::runGUIApplication() {
     return 0;
 }
 
+/**
+ * @brief Renders the project at the input path into the bitmap at the output
+ *        path, without starting the GUI.
+ *
+ * @return 0 on success, or 1 if the project could not be loaded or rendered.
+ */
+int HMDT::runRenderMap() {
+    auto mode = mapModeFromString(prog_opts.render_map_mode);
+    if(!mode) {
+        WRITE_ERROR("Unknown map mode '", prog_opts.render_map_mode, "'.");
+        return 1;
+    }
+
+    MapRenderOptions options;
+    options.scale = prog_opts.render_scale;
+
+    std::stringstream selection(prog_opts.render_selection);
+    for(std::string id_str; std::getline(selection, id_str, ',');) {
+        trim(id_str);
+        if(id_str.empty()) continue;
+
+        if(auto id = fromString<ProvinceID>(id_str); id) {
+            options.selection.insert(*id);
+        } else {
+            WRITE_ERROR("Invalid province ID '", id_str, "'.");
+            return 1;
+        }
+    }
+
+    WRITE_INFO("Loading project ", prog_opts.infilename);
+
+    Project::HoI4Project project;
+    project.setPath(prog_opts.infilename);
+
+    if(auto res = project.load(); IS_FAILURE(res)) {
+        WRITE_ERROR("Failed to load the project.");
+        return 1;
+    }
+
+    auto image = project.renderMap(*mode, options);
+    if(IS_FAILURE(image)) {
+        WRITE_ERROR("Failed to render the map.");
+        return 1;
+    }
+
+    WRITE_INFO("Writing the rendered map to ", prog_opts.outpath);
+
+    auto res = writeBMP2(prog_opts.outpath, image->pixels.data(),
+                         image->width, image->height);
+    if(IS_FAILURE(res)) {
+        WRITE_ERROR("Failed to write the rendered map.");
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compares the project at the input path against an older version of
+ *        it, and writes what changed to the output path without starting the
+ *        GUI.
+ *
+ * @return 0 on success, or 1 if either project could not be loaded or the
+ *         differences could not be written.
+ */
+int HMDT::runDiffProjects() {
+    if(prog_opts.diff_format != "text" && prog_opts.diff_format != "json") {
+        WRITE_ERROR("Unknown diff format '", prog_opts.diff_format, "'.");
+        return 1;
+    }
+
+    Project::HoI4Project old_project;
+    Project::HoI4Project new_project;
+
+    for(auto&& [project, path] : { std::make_pair(&old_project, prog_opts.diff_against),
+                                   std::make_pair(&new_project, prog_opts.infilename) })
+    {
+        WRITE_INFO("Loading project ", path);
+
+        // Only the lists get loaded, as the per-pixel layers are streamed
+        //   from disk while comparing
+        project->setPath(path);
+        if(auto res = project->loadForDiff(path); IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to load the project ", path);
+            return 1;
+        }
+    }
+
+    auto diff = new_project.diff(old_project);
+    if(IS_FAILURE(diff)) {
+        WRITE_ERROR("Failed to compare the projects.");
+        return 1;
+    }
+
+    WRITE_INFO("Writing the differences to ", prog_opts.outpath);
+    {
+        std::ofstream out(prog_opts.outpath);
+        if(!out) {
+            WRITE_ERROR("Failed to open ", prog_opts.outpath, " for writing.");
+            return 1;
+        }
+
+        if(prog_opts.diff_format == "json") {
+            writeProjectDiffJSON(out, *diff);
+        } else {
+            writeProjectDiffText(out, *diff);
+        }
+    }
+
+    if(!prog_opts.diff_image.empty()) {
+        auto image = new_project.renderDiff(old_project, *diff);
+        if(IS_FAILURE(image)) {
+            WRITE_ERROR("Failed to render the differences.");
+            return 1;
+        }
+
+        WRITE_INFO("Writing the rendered differences to ", prog_opts.diff_image);
+
+        auto res = writeBMP2(prog_opts.diff_image, image->pixels.data(),
+                             image->width, image->height);
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to write the rendered differences.");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Writes the statistics of every province in the project at the input
+ *        path to the output path, without starting the GUI.
+ *
+ * @return 0 on success, or 1 if the project could not be loaded or the
+ *         statistics could not be written.
+ */
+int HMDT::runProvinceStatistics() {
+    if(prog_opts.province_stats_format != "csv" &&
+       prog_opts.province_stats_format != "json")
+    {
+        WRITE_ERROR("Unknown province statistics format '",
+                    prog_opts.province_stats_format, "'.");
+        return 1;
+    }
+
+    WRITE_INFO("Loading project ", prog_opts.infilename);
+
+    Project::HoI4Project project;
+    project.setPath(prog_opts.infilename);
+
+    if(auto res = project.load(); IS_FAILURE(res)) {
+        WRITE_ERROR("Failed to load the project.");
+        return 1;
+    }
+
+    auto& map_project = project.getMapProject();
+
+    auto res = (prog_opts.province_stats_format == "json")
+                   ? map_project.writeProvinceStatisticsJSON(prog_opts.outpath)
+                   : map_project.writeProvinceStatisticsCSV(prog_opts.outpath);
+    if(IS_FAILURE(res)) {
+        WRITE_ERROR("Failed to write the province statistics.");
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Traces the borders of the project at the input path into vector
+ *        lines, and writes them to the output path without starting the GUI.
+ *
+ * @return 0 on success, or 1 if the project could not be loaded or the
+ *         borders could not be traced or written.
+ */
+int HMDT::runExportBorders() {
+    if(prog_opts.export_borders_format != "svg" &&
+       prog_opts.export_borders_format != "geojson")
+    {
+        WRITE_ERROR("Unknown borders format '", prog_opts.export_borders_format, "'.");
+        return 1;
+    }
+
+    if(prog_opts.borders_simplify < 0) {
+        WRITE_ERROR("Borders cannot be simplified by a negative amount.");
+        return 1;
+    }
+
+    WRITE_INFO("Loading project ", prog_opts.infilename);
+
+    Project::HoI4Project project;
+    project.setPath(prog_opts.infilename);
+
+    if(auto res = project.load(); IS_FAILURE(res)) {
+        WRITE_ERROR("Failed to load the project.");
+        return 1;
+    }
+
+    auto layers = project.extractBorders(prog_opts.borders_simplify);
+    if(IS_FAILURE(layers)) {
+        WRITE_ERROR("Failed to trace the borders.");
+        return 1;
+    }
+
+    WRITE_INFO("Writing the borders to ", prog_opts.outpath);
+
+    std::ofstream out(prog_opts.outpath);
+    if(!out) {
+        WRITE_ERROR("Failed to open ", prog_opts.outpath, " for writing.");
+        return 1;
+    }
+
+    auto map_data = project.getMapProject().getMapData();
+    Dimensions dimensions{ map_data->getWidth(), map_data->getHeight() };
+
+    if(prog_opts.export_borders_format == "geojson") {
+        writeBordersGeoJSON(out, dimensions, *layers);
+    } else {
+        writeBordersSVG(out, dimensions, *layers);
+    }
+
+    return 0;
+}
+
 int HMDT::runApplication() {
-    if(prog_opts.headless) {
+    if(!prog_opts.export_borders_format.empty()) {
+        return runExportBorders();
+    } else if(!prog_opts.province_stats_format.empty()) {
+        return runProvinceStatistics();
+    } else if(!prog_opts.diff_against.empty()) {
+        return runDiffProjects();
+    } else if(!prog_opts.render_map_mode.empty()) {
+        return runRenderMap();
+    } else if(prog_opts.headless) {
         return runHeadless();
     } else {
         return runGUIApplication();
@@ -1,8 +1,9 @@
 
 #include "StateDefinitionBuilder.h"
 
-#include <fstream>
+#include <string_view>
 
+#include "RecordParser.h"
 #include "Util.h"
 #include "Logger.h"
 
@@ -10,59 +11,35 @@ auto HMDT::createStatesList(const ProvinceList& provinces,
                             const std::filesystem::path& state_info_path)
     -> StateList
 {
-    std::ifstream state_info_file(state_info_path);
     StateList states;
 
     // CSV file is of the following format:
-    //  <State ID>;<State Name>;<Manpower>;<Category>;<BuildingsMaxLevelFactor>;<Impassable>
-    if(state_info_file) {
-        auto line_num = 0;
-        for(std::string line; std::getline(state_info_file, line); ++line_num) {
-            // Skip over empty lines
-            if(!line.empty()) {
-                std::string raw_id, raw_name, raw_manpower, raw_category;
-                StateID id;
-                size_t manpower;
-
-                auto last_comma = 0;
-                auto comma = line.find_first_of(';');
-                if(comma == std::string::npos) goto csvParseFailure;
-                raw_id = line.substr(0, comma);
-
-                last_comma = comma + 1;
-                comma = line.find_first_of(';', last_comma);
-                if(comma == std::string::npos) goto csvParseFailure;
-                raw_name = line.substr(last_comma, comma - last_comma);
-
-                last_comma = comma + 1;
-                comma = line.find_first_of(';', last_comma);
-                if(comma == std::string::npos) goto csvParseFailure;
-                raw_manpower = line.substr(last_comma, comma - last_comma);
-
-                // No need to search for the next comma, as there shouldn't _be_ one
-                //  Just grab until the end of the line, damn the consequences
-                last_comma = comma + 1;
-                raw_category = line.substr(last_comma);
-
-                // Now that we have each raw value, go ahead and try to parse them
-
-                trim(raw_id);
-                trim(raw_name);
-                trim(raw_manpower);
-                trim(raw_category);
-                
-                id = std::atoi(raw_id.c_str());
-                manpower = std::atoi(raw_manpower.c_str());
-
-                states[id] = {
-                    id, raw_name, manpower, raw_category, 0.0f, false, std::vector<ProvinceID>(), Color{0,0,0}
-                };
+    //  <State ID>;<State Name>;<Manpower>;<Category>
+    if(std::error_code ec; std::filesystem::exists(state_info_path, ec)) {
+        auto contents = readFileToString(state_info_path);
+        if(IS_FAILURE(contents)) {
+            return StateList();
+        }
 
-                continue;
-csvParseFailure:
-                WRITE_ERROR("Failed to parse CSV file on line #", line_num);
+        RecordParser parser(*contents, ';');
+        parser.setAllowTrailingCharacters(); // atoi() used to allow this
+        while(parser.nextRecord()) {
+            StateID id;
+            std::string_view name;
+            size_t manpower;
+            std::string_view category;
+
+            auto res = parser.parseFields(id, name, manpower, category);
+            if(IS_FAILURE(res)) {
+                WRITE_ERROR("Failed to parse CSV file on line #", parser.getLineNumber());
                 return StateList();
             }
+
+            states[id] = {
+                id, std::string(trimField(name)), manpower,
+                std::string(trimField(category)), 0.0f, false,
+                std::vector<ProvinceID>(), Color{0,0,0}
+            };
         }
     }
 
@@ -0,0 +1,25 @@
+#version 410 core
+
+out vec4 FragColor; // Output color value
+
+// The height of every pixel
+uniform sampler2D heights;
+
+// The normal of every pixel, with each axis mapped from [-1, 1] to [0, 1]
+uniform sampler2D normals;
+
+// Where the light which shades the slopes comes from
+const vec3 LIGHT_DIRECTION = normalize(vec3(-1.0, 1.0, 1.0));
+
+in vec2 texture_coords; // Input from vertex shader
+
+void main() {
+    float height = texture(heights, texture_coords).r;
+    vec3 normal = normalize(texture(normals, texture_coords).rgb * 2.0 - 1.0);
+
+    // Darken slopes which face away from the light, so that the shape of the
+    //   terrain stands out
+    float light = max(dot(normal, LIGHT_DIRECTION), 0.0);
+
+    FragColor = vec4(vec3(height) * (0.5 + 0.5 * light), 1.0);
+}
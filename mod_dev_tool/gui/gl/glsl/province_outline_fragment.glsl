@@ -2,12 +2,21 @@
 
 out vec4 FragColor; // Output color value
 
-uniform sampler2D map_texture;
+// One byte of edge flags per pixel. See the OUTLINE_* constants
+uniform usampler2D outline_flags;
+
+// Which of the edge flags should be rendered
+uniform uint outline_mask;
+
+// The color that the outlines will appear rendered as
+uniform vec3 outline_color;
 
 in vec2 texture_coords; // Input from vertex shader
 
 void main() {
-    // Render the border anywhere that is "white" in the texture
-    FragColor = vec4(0, 0, 0, texture(map_texture, texture_coords).a);
+    uint flags = texture(outline_flags, texture_coords).r;
+
+    // Render the border anywhere that has one of the requested edges set
+    FragColor = vec4(outline_color, float((flags & outline_mask) != 0u));
 }
 
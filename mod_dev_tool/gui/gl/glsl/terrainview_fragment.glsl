@@ -0,0 +1,29 @@
+#version 410 core
+
+out vec4 FragColor; // Output color value
+
+// The terrain color of the province under every pixel
+uniform sampler2D terrain_colors;
+
+// One byte of edge flags per pixel. See the OUTLINE_* constants
+uniform usampler2D outline_flags;
+
+// Which of the edge flags should be rendered
+uniform uint outline_mask;
+
+// The color that the outlines will appear rendered as
+uniform vec3 outline_color;
+
+in vec2 texture_coords; // Input from vertex shader
+
+void main() {
+    uint flags = texture(outline_flags, texture_coords).r;
+
+    vec4 terrain_color = texture(terrain_colors, texture_coords);
+
+    // Draw province borders on top, so that provinces with the same terrain
+    //   can still be told apart
+    FragColor = mix(terrain_color, vec4(outline_color, 1.0),
+                    float((flags & outline_mask) != 0u));
+}
+
@@ -0,0 +1,53 @@
+/**
+ * @file HeightMapRenderingView.h
+ *
+ * @file Defines the HeightMapRenderingView class
+ */
+
+#ifndef HEIGHTMAPRENDERINGVIEW_H
+# define HEIGHTMAPRENDERINGVIEW_H
+
+# include <vector>
+
+# include "MapRenderingViewBase.h"
+
+namespace HMDT::GUI::GL {
+    /**
+     * @brief Renders the heightmap, shaded by the normal map
+     */
+    class HeightMapRenderingView: public MapRenderingViewBase {
+        public:
+            HeightMapRenderingView() = default;
+
+            virtual void init() override;
+            virtual void beginRender() override;
+            virtual void render() override;
+
+            virtual void onMapDataChanged(std::shared_ptr<const MapData>) override;
+            virtual void onHeightMapChanged(const std::vector<Rectangle>&) override;
+
+        protected:
+            virtual void setupUniforms() override;
+
+            virtual const std::string& getVertexShaderSource() const override;
+            virtual const std::string& getFragmentShaderSource() const override;
+
+            void updateHeightMapTextures();
+            void updateDirtyRegions();
+
+        private:
+            std::shared_ptr<const MapData> m_map_data;
+
+            //! The height of every pixel
+            Texture m_heightmap_texture;
+
+            //! The normal of every pixel
+            Texture m_normal_texture;
+
+            //! Every region which changed since the textures were last uploaded
+            std::vector<Rectangle> m_dirty_regions;
+    };
+}
+
+#endif
+
@@ -43,6 +43,7 @@ namespace HMDT::GUI::GL {
 
             virtual void onMapDataChanged(std::shared_ptr<const MapData>) = 0;
             virtual void onSelectionChanged(std::optional<IMapDrawingAreaBase::SelectionInfo>) { };
+            virtual void onHeightMapChanged(const std::vector<Rectangle>&) { };
 
             virtual void beginRender() = 0;
             virtual void render() = 0;
@@ -45,6 +45,7 @@ namespace HMDT::GUI::GL {
             virtual void onSetData(std::shared_ptr<const MapData>) override;
             virtual void onShow() override;
             virtual void onSelectionChanged(std::optional<SelectionInfo>) override;
+            virtual void onHeightMapChanged(const std::vector<Rectangle>&) override;
 
             void initShaderMacros();
 
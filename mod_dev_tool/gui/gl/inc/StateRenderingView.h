@@ -34,6 +34,8 @@ namespace HMDT::GUI::GL {
             Texture& getStateIDMatrixTexture();
 
             void updateStateIDTexture();
+            void updateOutlineTexture();
+            void updateStateColorsTexture();
 
         private:
             std::shared_ptr<const MapData> m_map_data;
@@ -41,6 +43,15 @@ namespace HMDT::GUI::GL {
             //! The state ID texture
             Texture m_state_id_texture;
 
+            //! The province and state border flags of every pixel
+            Texture m_outline_texture;
+
+            //! The color of every state, indexed by state ID
+            Texture m_state_colors_texture;
+
+            //! The number of state IDs in m_state_colors_texture
+            uint32_t m_num_state_colors = 0;
+
             //! A tag for the last state ID matrix value, used to know if it needs to be refreshed
             uint32_t m_last_state_id_matrix_updated_tag = -1;
     };
@@ -0,0 +1,55 @@
+/**
+ * @file TerrainRenderingView.h
+ *
+ * @file Defines the TerrainRenderingView class
+ */
+
+#ifndef TERRAINRENDERINGVIEW_H
+# define TERRAINRENDERINGVIEW_H
+
+# include <optional>
+
+# include "MapRenderingViewBase.h"
+
+# include "IMapDrawingArea.h" // SelectionInfo
+
+namespace HMDT::GUI::GL {
+    /**
+     * @brief Renders every province in the color of its terrain
+     */
+    class TerrainRenderingView: public MapRenderingViewBase {
+        public:
+            TerrainRenderingView() = default;
+
+            virtual void init() override;
+            virtual void beginRender() override;
+            virtual void render() override;
+
+            virtual void onMapDataChanged(std::shared_ptr<const MapData>) override;
+            virtual void onSelectionChanged(std::optional<IMapDrawingAreaBase::SelectionInfo>) override;
+
+        protected:
+            virtual void setupUniforms() override;
+
+            virtual const std::string& getVertexShaderSource() const override;
+            virtual const std::string& getFragmentShaderSource() const override;
+
+            void updateTerrainTexture();
+            void updateOutlineTexture();
+
+        private:
+            std::shared_ptr<const MapData> m_map_data;
+
+            //! The terrain color of every pixel
+            Texture m_terrain_texture;
+
+            //! The province outline flags of every pixel
+            Texture m_outline_texture;
+
+            //! A tag for the last province terrains value, used to know if the terrain texture needs to be refreshed
+            uint32_t m_last_province_terrains_updated_tag = -1;
+    };
+}
+
+#endif
+
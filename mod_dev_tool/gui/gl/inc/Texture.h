@@ -13,6 +13,8 @@
 # include <string>
 # include <optional>
 
+# include "Types.h"
+
 namespace HMDT::GUI::GL {
     /**
      * @brief Represents an OpenGL texture
@@ -47,6 +49,7 @@ namespace HMDT::GUI::GL {
                 RED, GREEN, BLUE, ALPHA,
                 RGB,
                 RGBA,
+                RED8UI,
                 RED32I,
                 RED32UI
             };
@@ -117,6 +120,28 @@ namespace HMDT::GUI::GL {
                                typeToDataType(typeid(T)), data, format);
             }
 
+            /**
+             * @brief Sends new data for part of the texture to the GPU.
+             *
+             * @details Implicitly calls bind(). The texture must already have
+             *          been created with setTextureData.
+             *
+             * @tparam T The type of data being passed in
+             *
+             * @param internal_format The format of the data
+             * @param area The part of the texture to replace
+             * @param data The data of the whole texture. Only the part inside
+             *             of area is sent.
+             */
+            template<typename T>
+            void setTextureSubData(Format internal_format, const Rectangle& area,
+                                   const T* data,
+                                   std::optional<uint32_t> format = std::nullopt)
+            {
+                setTextureSubData(internal_format, area,
+                                  typeToDataType(typeid(T)), data, format);
+            }
+
             uint32_t getTextureUnitID() const;
             uint32_t getTextureID() const;
             uint32_t getWidth() const;
@@ -139,6 +164,8 @@ namespace HMDT::GUI::GL {
 
             void setTextureData(Format, uint32_t, uint32_t, uint32_t,
                                 const void*, std::optional<uint32_t>);
+            void setTextureSubData(Format, const Rectangle&, uint32_t,
+                                   const void*, std::optional<uint32_t>);
 
         private:
             //! The texture ID
@@ -0,0 +1,183 @@
+/**
+ * @file HeightMapRenderingView.cpp
+ *
+ * @file Defines the HeightMapRenderingView class
+ */
+
+#include "HeightMapRenderingView.h"
+
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "GLShaderSources.h"
+#include "GLUtils.h"
+
+#include "Logger.h"
+
+/**
+ * @brief Initializes a HeightMapRenderingView
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::init() {
+    MapRenderingViewBase::init();
+
+    // We set these values away from the textures, as there is no real need to
+    //  set them multiple times.
+    m_heightmap_texture.setTextureUnitID(Texture::Unit::TEX_UNIT0);
+    m_heightmap_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+    m_heightmap_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+    m_normal_texture.setTextureUnitID(Texture::Unit::TEX_UNIT2);
+    m_normal_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+    m_normal_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+}
+
+void HMDT::GUI::GL::HeightMapRenderingView::beginRender() {
+    MapRenderingViewBase::beginRender();
+
+    // Sculpting only changes a few tiles at a time, so only send those again
+    if(!m_dirty_regions.empty()) {
+        updateDirtyRegions();
+    }
+}
+
+/**
+ * @brief Uploads the whole heightmap and normal map.
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::updateHeightMapTextures() {
+    if(m_map_data == nullptr) return;
+
+    auto heightmap = m_map_data->getHeightMap();
+    auto normal_map = m_map_data->getNormalMap();
+    if(heightmap.expired() || normal_map.expired()) return;
+
+    WRITE_DEBUG("Updating heightmap textures.");
+
+    auto [iwidth, iheight] = m_map_data->getDimensions();
+
+    // Rows of the heightmap and normal map are not guaranteed to be a
+    //   multiple of the default alignment of 4
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    HMDT_LOG_GL_ERRORS();
+
+    m_heightmap_texture.bind();
+    m_heightmap_texture.setTextureData(Texture::Format::RED,
+                                       iwidth, iheight,
+                                       heightmap.lock().get());
+    m_heightmap_texture.bind(false);
+
+    // The normal map is stored as BGR, as it gets exported as a .bmp
+    m_normal_texture.bind();
+    m_normal_texture.setTextureData(Texture::Format::RGB,
+                                    iwidth, iheight,
+                                    normal_map.lock().get(),
+                                    GL_BGR);
+    m_normal_texture.bind(false);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    HMDT_LOG_GL_ERRORS();
+
+    m_dirty_regions.clear();
+}
+
+/**
+ * @brief Uploads only the regions of the heightmap and normal map which
+ *        changed since they were last uploaded.
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::updateDirtyRegions() {
+    if(m_map_data == nullptr) return;
+
+    auto heightmap = m_map_data->getHeightMap();
+    auto normal_map = m_map_data->getNormalMap();
+    if(heightmap.expired() || normal_map.expired()) return;
+
+    auto [iwidth, iheight] = m_map_data->getDimensions();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    HMDT_LOG_GL_ERRORS();
+
+    for(auto&& region : m_dirty_regions) {
+        m_heightmap_texture.setTextureSubData(Texture::Format::RED, region,
+                                              heightmap.lock().get());
+
+        // Changing a height also changes the normals of every pixel next to
+        //   it, so send a one pixel apron around the region as well
+        uint32_t left = (region.x == 0) ? 0 : region.x - 1;
+        uint32_t top = (region.y == 0) ? 0 : region.y - 1;
+        uint32_t right = std::min(region.x + region.w + 1, iwidth);
+        uint32_t bottom = std::min(region.y + region.h + 1, iheight);
+
+        m_normal_texture.setTextureSubData(Texture::Format::RGB,
+                                           Rectangle{ left, top,
+                                                      right - left,
+                                                      bottom - top },
+                                           normal_map.lock().get(),
+                                           GL_BGR);
+    }
+
+    m_heightmap_texture.bind(false);
+    m_normal_texture.bind(false);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    HMDT_LOG_GL_ERRORS();
+
+    WRITE_DEBUG("Uploaded ", m_dirty_regions.size(), " changed heightmap regions.");
+
+    m_dirty_regions.clear();
+}
+
+/**
+ * @brief Renders the heightmap, shaded by the normal map.
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::render() {
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Return early if m_map_data is null, as that likely means we do not have
+    //  any textures uploaded
+    if(m_map_data == nullptr) return;
+
+    m_heightmap_texture.activate();
+    m_normal_texture.activate();
+
+    MapRenderingViewBase::render();
+}
+
+void HMDT::GUI::GL::HeightMapRenderingView::setupUniforms() {
+    getMapProgram().uniform("heights", m_heightmap_texture);
+    getMapProgram().uniform("normals", m_normal_texture);
+}
+
+const std::string& HMDT::GUI::GL::HeightMapRenderingView::getVertexShaderSource() const
+{
+    return ShaderSources::heightmapview_vertex;
+}
+
+const std::string& HMDT::GUI::GL::HeightMapRenderingView::getFragmentShaderSource() const
+{
+    return ShaderSources::heightmapview_fragment;
+}
+
+/**
+ * @brief Rebuilds every texture from the new map data
+ *
+ * @param map_data The new map data
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::onMapDataChanged(std::shared_ptr<const MapData> map_data)
+{
+    m_map_data = map_data;
+
+    updateHeightMapTextures();
+}
+
+/**
+ * @brief Remembers which regions of the heightmap changed, so that they can
+ *        be uploaded the next time the map is rendered.
+ *
+ * @param regions Every region of the heightmap which changed
+ */
+void HMDT::GUI::GL::HeightMapRenderingView::onHeightMapChanged(const std::vector<Rectangle>& regions)
+{
+    m_dirty_regions.insert(m_dirty_regions.end(), regions.begin(), regions.end());
+}
+
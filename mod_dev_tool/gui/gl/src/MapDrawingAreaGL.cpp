@@ -23,6 +23,8 @@
 #include "GLUtils.h"
 #include "ProvinceRenderingView.h"
 #include "StateRenderingView.h"
+#include "TerrainRenderingView.h"
+#include "HeightMapRenderingView.h"
 
 HMDT::GUI::GL::MapDrawingArea::MapDrawingArea():
     m_initialized(false)
@@ -141,6 +143,8 @@ void HMDT::GUI::GL::MapDrawingArea::init() {
 
     m_rendering_views[ViewingMode::PROVINCE_VIEW].reset(new ProvinceRenderingView());
     m_rendering_views[ViewingMode::STATES_VIEW].reset(new StateRenderingView());
+    m_rendering_views[ViewingMode::TERRAIN_VIEW].reset(new TerrainRenderingView());
+    m_rendering_views[ViewingMode::HEIGHTMAP_VIEW].reset(new HeightMapRenderingView());
 
     WRITE_DEBUG("Initializing each rendering view.");
     for(auto&& [viewing_mode, rendering_view] : m_rendering_views) {
@@ -208,6 +212,18 @@ void HMDT::GUI::GL::MapDrawingArea::onSelectionChanged(std::optional<SelectionIn
     queue_draw();
 }
 
+/**
+ * @brief Tells every rendering view which regions of the heightmap changed
+ *
+ * @param regions Every region of the heightmap which changed
+ */
+void HMDT::GUI::GL::MapDrawingArea::onHeightMapChanged(const std::vector<Rectangle>& regions)
+{
+    for(auto&& [_, rendering_view] : m_rendering_views) {
+        rendering_view->onHeightMapChanged(regions);
+    }
+}
+
 void HMDT::GUI::GL::MapDrawingArea::queueDraw() {
     queue_draw();
     show_all();
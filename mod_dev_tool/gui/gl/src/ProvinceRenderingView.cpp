@@ -14,9 +14,12 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include "GLShaderSources.h"
+#include "GLUtils.h"
 
 #include "Logger.h"
 
+#include "Constants.h"
+
 #include "Driver.h"
 
 #include "MapDrawingAreaGL.h"
@@ -157,7 +160,9 @@ void HMDT::GUI::GL::ProvinceRenderingView::render() {
         glm::mat4 transform = glm::mat4{1.0f};
         transform = glm::scale(transform, glm::vec3{scale_factor, scale_factor, 1});
         m_selection_shader.uniform("transform", transform);
-        m_outline_shader.uniform("map_texture", m_outline_texture);
+        m_outline_shader.uniform("outline_flags", m_outline_texture);
+        m_outline_shader.uniform("outline_mask", static_cast<uint32_t>(OUTLINE_PROVINCE_MASK));
+        m_outline_shader.uniform("outline_color", PROVINCE_OUTLINE_COLOR);
 
         m_outline_texture.activate();
 
@@ -228,11 +233,22 @@ void HMDT::GUI::GL::ProvinceRenderingView::onMapDataChanged(std::shared_ptr<cons
             // map_texture->setWrapping(Texture::Axis::S, Texture::WrapMode::CLAMP_TO_EDGE);
             // map_texture->setWrapping(Texture::Axis::T, Texture::WrapMode::CLAMP_TO_EDGE);
 
-            m_outline_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::LINEAR);
-            m_outline_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::LINEAR);
+            // Integer textures cannot be linearly filtered
+            m_outline_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+            m_outline_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+            // Each row is only width bytes long, which is not guaranteed to be
+            //   a multiple of the default alignment of 4
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            HMDT_LOG_GL_ERRORS();
+
+            m_outline_texture.setTextureData(Texture::Format::RED8UI,
+                                             iwidth, iheight,
+                                             map_data->getProvinceOutlines().lock().get(),
+                                             GL_RED_INTEGER);
 
-            m_outline_texture.setTextureData(Texture::Format::RGBA,
-                                             iwidth, iheight, map_data->getProvinceOutlines().lock().get());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            HMDT_LOG_GL_ERRORS();
         }
         m_outline_texture.bind(false);
     }
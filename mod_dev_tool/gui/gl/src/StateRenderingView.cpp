@@ -6,11 +6,15 @@
 
 #include "StateRenderingView.h"
 
+#include <vector>
+
 #include <GL/glew.h>
 
 #include "GLShaderSources.h"
+#include "GLUtils.h"
 
 #include "Logger.h"
+#include "Constants.h"
 #include "Util.h"
 
 #include "Driver.h"
@@ -35,6 +39,16 @@ void HMDT::GUI::GL::StateRenderingView::init() {
         m_state_id_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
         m_state_id_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
 
+        // Integer textures cannot be linearly filtered
+        m_outline_texture.setTextureUnitID(Texture::Unit::TEX_UNIT5);
+        m_outline_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+        m_outline_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+        // Colors are looked up by state ID, so they must never be blended
+        m_state_colors_texture.setTextureUnitID(Texture::Unit::TEX_UNIT4);
+        m_state_colors_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+        m_state_colors_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
         updateStateIDTexture();
     }
 }
@@ -67,6 +81,9 @@ void HMDT::GUI::GL::StateRenderingView::updateStateIDTexture() {
             }
             m_state_id_texture.bind(false);
 
+            // The state borders are rebuilt along with the state ID matrix
+            updateOutlineTexture();
+
             // Make sure we update what the current tag is
             m_last_state_id_matrix_updated_tag = m_map_data->getStateIDMatrixUpdatedTag();
         }
@@ -74,8 +91,84 @@ void HMDT::GUI::GL::StateRenderingView::updateStateIDTexture() {
 }
 
 /**
- * @brief Renders the base map, then the current selection, and then the map
- *        outlines on top of that.
+ * @brief Uploads the border flags which were built on the CPU, so that the
+ *        shader only has to look up a single texel to know if a pixel is on a
+ *        state border.
+ */
+void HMDT::GUI::GL::StateRenderingView::updateOutlineTexture() {
+    if(m_map_data == nullptr) return;
+
+    auto outlines = m_map_data->getProvinceOutlines();
+    if(outlines.expired()) return;
+
+    auto [iwidth, iheight] = m_map_data->getDimensions();
+
+    m_outline_texture.bind();
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        HMDT_LOG_GL_ERRORS();
+
+        m_outline_texture.setTextureData(Texture::Format::RED8UI,
+                                         iwidth, iheight,
+                                         outlines.lock().get(),
+                                         GL_RED_INTEGER);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        HMDT_LOG_GL_ERRORS();
+    }
+    m_outline_texture.bind(false);
+}
+
+/**
+ * @brief Uploads the color of every state into a texture indexed by state ID.
+ * @details This is small enough to be rebuilt every frame, which means that
+ *          changing the color of a state needs no tag to be tracked.
+ */
+void HMDT::GUI::GL::StateRenderingView::updateStateColorsTexture() {
+    //! The widest the texture is allowed to get before wrapping into rows
+    constexpr uint32_t MAX_WIDTH = 1024;
+
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) return;
+
+    const auto& states = opt_project->get().getHistoryProject().getStateProject().getStates();
+
+    // StateMap is ordered, so the last state has the largest ID
+    m_num_state_colors = states.empty() ? 1 : states.rbegin()->first + 1;
+
+    uint32_t width = std::min(m_num_state_colors, MAX_WIDTH);
+    uint32_t height = (m_num_state_colors + width - 1) / width;
+
+    std::vector<uint8_t> colors(static_cast<uint64_t>(width) * height * 3, 0);
+    for(auto&& [id, state] : states) {
+        // States without any provinces are never drawn
+        if(state.provinces.empty()) continue;
+
+        colors[id * 3] = state.color.r;
+        colors[id * 3 + 1] = state.color.g;
+        colors[id * 3 + 2] = state.color.b;
+    }
+
+    m_state_colors_texture.bind();
+    {
+        // Each row is only width * 3 bytes long, which is not guaranteed to
+        //   be a multiple of the default alignment of 4
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        HMDT_LOG_GL_ERRORS();
+
+        m_state_colors_texture.setTextureData(Texture::Format::RGB,
+                                              width, height,
+                                              colors.data());
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        HMDT_LOG_GL_ERRORS();
+    }
+    m_state_colors_texture.bind(false);
+}
+
+/**
+ * @brief Renders every state in its color, with the state borders and the
+ *        current selection on top, in a single pass.
  */
 void HMDT::GUI::GL::StateRenderingView::render() {
     glClearColor(0.0, 0.0, 0.0, 1.0);
@@ -87,13 +180,22 @@ void HMDT::GUI::GL::StateRenderingView::render() {
 
     if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
         auto& map_project = opt_project->get().getMapProject();
-        auto& history_project = opt_project->get().getHistoryProject();
 
-        getMapProgram().uniform("tex_dimensions", glm::ivec2(m_state_id_texture.getWidth(),
-                                                             m_state_id_texture.getHeight()));
         getMapProgram().uniform("state_id_matrix", m_state_id_texture);
         m_state_id_texture.activate();
 
+        // Borders come from the flags built on the CPU, so every state is
+        //   drawn in a single pass no matter how many states there are
+        updateStateColorsTexture();
+        getMapProgram().uniform("state_colors", m_state_colors_texture);
+        getMapProgram().uniform("num_state_colors", m_num_state_colors);
+        m_state_colors_texture.activate();
+
+        getMapProgram().uniform("outline_flags", m_outline_texture);
+        getMapProgram().uniform("outline_mask", static_cast<uint32_t>(OUTLINE_STATE_MASK));
+        getMapProgram().uniform("outline_color", PROVINCE_OUTLINE_COLOR);
+        m_outline_texture.activate();
+
         // Set uniforms related to selection
         {
             getMapProgram().uniform("selection", getSelectionTexture());
@@ -116,15 +218,7 @@ void HMDT::GUI::GL::StateRenderingView::render() {
             getMapProgram().uniform("num_selected", static_cast<uint32_t>(selection_ids.size()));
         }
 
-        // Render the normal map first for each state that exists
-        for(auto&& [id, state] : history_project.getStateProject().getStates()) {
-            if(state.provinces.empty()) continue;
-
-            getMapProgram().uniform("state_color", state.color);
-            getMapProgram().uniform("state_id", id);
-
-            MapRenderingViewBase::render();
-        }
+        MapRenderingViewBase::render();
     }
 
     // TODO: Render selections
@@ -132,6 +226,8 @@ void HMDT::GUI::GL::StateRenderingView::render() {
 
 void HMDT::GUI::GL::StateRenderingView::setupUniforms() {
     getMapProgram().uniform("state_id_matrix", getStateIDMatrixTexture());
+    getMapProgram().uniform("outline_flags", m_outline_texture);
+    getMapProgram().uniform("state_colors", m_state_colors_texture);
 }
 
 const std::string& HMDT::GUI::GL::StateRenderingView::getVertexShaderSource() const
@@ -145,11 +241,16 @@ const std::string& HMDT::GUI::GL::StateRenderingView::getFragmentShaderSource()
 }
 
 /**
- * @brief
+ * @brief Makes sure that every texture gets rebuilt from the new map data
+ *
+ * @param map_data The new map data
  */
 void HMDT::GUI::GL::StateRenderingView::onMapDataChanged(std::shared_ptr<const MapData> map_data)
 {
     m_map_data = map_data;
+
+    // The new map data may happen to have the same tag as the old one
+    m_last_state_id_matrix_updated_tag = -1;
 }
 
 /**
@@ -0,0 +1,214 @@
+/**
+ * @file TerrainRenderingView.cpp
+ *
+ * @file Defines the TerrainRenderingView class
+ */
+
+#include "TerrainRenderingView.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GLShaderSources.h"
+#include "GLUtils.h"
+
+#include "Logger.h"
+#include "Constants.h"
+#include "Util.h"
+
+#include "Driver.h"
+
+#include "MapDrawingAreaGL.h"
+
+/**
+ * @brief Initializes a TerrainRenderingView
+ */
+void HMDT::GUI::GL::TerrainRenderingView::init() {
+    MapRenderingViewBase::init();
+
+    // We set these values away from the textures, as there is no real need to
+    //  set them multiple times.
+    m_terrain_texture.setTextureUnitID(Texture::Unit::TEX_UNIT0);
+    m_terrain_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+    m_terrain_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+
+    // Integer textures cannot be linearly filtered
+    m_outline_texture.setTextureUnitID(Texture::Unit::TEX_UNIT2);
+    m_outline_texture.setFiltering(Texture::FilterType::MAG, Texture::Filter::NEAREST);
+    m_outline_texture.setFiltering(Texture::FilterType::MIN, Texture::Filter::NEAREST);
+}
+
+void HMDT::GUI::GL::TerrainRenderingView::beginRender() {
+    MapRenderingViewBase::beginRender();
+
+    // Only rebuild the terrain texture if the terrain of a province changed
+    if(auto opt_project = Driver::getInstance().getProject();
+            opt_project && m_map_data != nullptr)
+    {
+        const auto& terrain_project = opt_project->get().getMapProject().getTerrainProject();
+
+        if(m_last_province_terrains_updated_tag != terrain_project.getProvinceTerrainsUpdatedTag())
+        {
+            updateTerrainTexture();
+        }
+    }
+}
+
+/**
+ * @brief Builds the terrain color of every pixel from the terrain of the
+ *        province it belongs to.
+ */
+void HMDT::GUI::GL::TerrainRenderingView::updateTerrainTexture() {
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project || m_map_data == nullptr) return;
+
+    auto provinces_mtx = m_map_data->getProvinces();
+    if(provinces_mtx.expired()) return;
+
+    auto& map_project = opt_project->get().getMapProject();
+    const auto& terrain_project = map_project.getTerrainProject();
+
+    WRITE_DEBUG("Updating terrain texture.");
+
+    // Look up every terrain's color only once
+    std::unordered_map<ProvinceID, Color> province_colors;
+    std::unordered_map<TerrainID, Color> terrain_colors;
+    for(auto&& [id, province] : map_project.getProvinceProject().getProvinces()) {
+        auto it = terrain_colors.find(province.terrain);
+        if(it == terrain_colors.end()) {
+            it = terrain_colors.emplace(province.terrain,
+                                        terrain_project.getTerrainColor(province.terrain)).first;
+        }
+
+        province_colors[id] = it->second;
+    }
+
+    auto [iwidth, iheight] = m_map_data->getDimensions();
+    auto* provinces = provinces_mtx.lock().get();
+
+    std::vector<uint8_t> colors(static_cast<uint64_t>(iwidth) * iheight * 3, 0);
+
+    auto color_of = [&province_colors](const ProvinceID& id) {
+        auto it = province_colors.find(id);
+        return (it == province_colors.end()) ? Color{ 0, 0, 0 } : it->second;
+    };
+    CachedProvinceLookup cached_color(color_of);
+
+    for(uint64_t i = 0; i < static_cast<uint64_t>(iwidth) * iheight; ++i) {
+        const auto& color = cached_color(provinces[i]);
+
+        colors[i * 3] = color.r;
+        colors[i * 3 + 1] = color.g;
+        colors[i * 3 + 2] = color.b;
+    }
+
+    m_terrain_texture.bind();
+    {
+        // Each row is only width * 3 bytes long, which is not guaranteed to
+        //   be a multiple of the default alignment of 4
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        HMDT_LOG_GL_ERRORS();
+
+        m_terrain_texture.setTextureData(Texture::Format::RGB,
+                                         iwidth, iheight,
+                                         colors.data());
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        HMDT_LOG_GL_ERRORS();
+    }
+    m_terrain_texture.bind(false);
+
+    // Make sure we update what the current tag is
+    m_last_province_terrains_updated_tag = terrain_project.getProvinceTerrainsUpdatedTag();
+}
+
+/**
+ * @brief Uploads the province outlines, so that they can be drawn on top of
+ *        the terrain.
+ */
+void HMDT::GUI::GL::TerrainRenderingView::updateOutlineTexture() {
+    if(m_map_data == nullptr) return;
+
+    auto outlines = m_map_data->getProvinceOutlines();
+    if(outlines.expired()) return;
+
+    auto [iwidth, iheight] = m_map_data->getDimensions();
+
+    m_outline_texture.bind();
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        HMDT_LOG_GL_ERRORS();
+
+        m_outline_texture.setTextureData(Texture::Format::RED8UI,
+                                         iwidth, iheight,
+                                         outlines.lock().get(),
+                                         GL_RED_INTEGER);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        HMDT_LOG_GL_ERRORS();
+    }
+    m_outline_texture.bind(false);
+}
+
+/**
+ * @brief Renders the terrain of every province, with the province outlines on
+ *        top of it.
+ */
+void HMDT::GUI::GL::TerrainRenderingView::render() {
+    glClearColor(0.0, 0.0, 0.0, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Return early if m_map_data is null, as that likely means we do not have
+    //  any textures uploaded
+    if(m_map_data == nullptr) return;
+
+    getMapProgram().uniform("outline_mask", static_cast<uint32_t>(OUTLINE_PROVINCE_MASK));
+    getMapProgram().uniform("outline_color", PROVINCE_OUTLINE_COLOR);
+
+    m_terrain_texture.activate();
+    m_outline_texture.activate();
+
+    MapRenderingViewBase::render();
+
+    // TODO: Render selections
+}
+
+void HMDT::GUI::GL::TerrainRenderingView::setupUniforms() {
+    getMapProgram().uniform("terrain_colors", m_terrain_texture);
+    getMapProgram().uniform("outline_flags", m_outline_texture);
+}
+
+const std::string& HMDT::GUI::GL::TerrainRenderingView::getVertexShaderSource() const
+{
+    return ShaderSources::terrainview_vertex;
+}
+
+const std::string& HMDT::GUI::GL::TerrainRenderingView::getFragmentShaderSource() const
+{
+    return ShaderSources::terrainview_fragment;
+}
+
+/**
+ * @brief Rebuilds every texture from the new map data
+ *
+ * @param map_data The new map data
+ */
+void HMDT::GUI::GL::TerrainRenderingView::onMapDataChanged(std::shared_ptr<const MapData> map_data)
+{
+    m_map_data = map_data;
+
+    updateTerrainTexture();
+    updateOutlineTexture();
+}
+
+/**
+ * @brief Selections are not drawn in the terrain view yet
+ *
+ * @param selection Info about the selected province, or std::nullopt
+ */
+void HMDT::GUI::GL::TerrainRenderingView::onSelectionChanged(std::optional<IMapDrawingAreaBase::SelectionInfo> selection)
+{
+}
+
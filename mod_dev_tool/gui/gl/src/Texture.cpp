@@ -108,6 +108,49 @@ void HMDT::GUI::GL::Texture::setTextureData(Format internal_format,
     m_height = height;
 }
 
+/**
+ * @brief Sends new data for part of the texture to the GPU.
+ *
+ * @details Implicitly calls bind()
+ *
+ * @param internal_format The format of the data
+ * @param area The part of the texture to replace
+ * @param data_type The data type being passed in
+ * @param data The data of the whole texture. Only the part inside of area is
+ *             sent.
+ */
+void HMDT::GUI::GL::Texture::setTextureSubData(Format internal_format,
+                                               const Rectangle& area,
+                                               uint32_t data_type,
+                                               const void* data,
+                                               std::optional<uint32_t> format)
+{
+    auto gl_target = targetToGLTarget(m_target);
+
+    uint32_t gl_format = formatToGLFormat(internal_format);
+    if(format) {
+        gl_format = *format;
+    }
+
+    bind();
+
+    // Rows of the area are spread out across the whole texture, so tell GL
+    //   how to step from one to the next
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, m_width);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, area.x);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, area.y);
+    HMDT_LOG_GL_ERRORS();
+
+    glTexSubImage2D(gl_target, 0 /* mipmapping */, area.x, area.y,
+                    area.w, area.h, gl_format, data_type, data);
+    HMDT_LOG_GL_ERRORS();
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    HMDT_LOG_GL_ERRORS();
+}
+
 uint32_t HMDT::GUI::GL::Texture::getTextureUnitID() const {
     return m_texture_unit;
 }
@@ -223,6 +266,8 @@ uint32_t HMDT::GUI::GL::Texture::formatToGLFormat(Format format) {
             return GL_RGB;
         case Format::RGBA:
             return GL_RGBA;
+        case Format::RED8UI:
+            return GL_R8UI;
         case Format::RED32I:
             return GL_R32I;
         case Format::RED32UI:
@@ -2,6 +2,7 @@
 # define IMAPDRAWINGAREA_H
 
 # include <functional>
+# include <vector>
 
 # include "gdkmm/event.h"
 # include "gtkmm/widget.h"
@@ -34,6 +35,7 @@ namespace HMDT::GUI {
             };
 
             using SelectionCallback = std::function<void(uint32_t, uint32_t)>;
+            using StrokeCallback = std::function<void(const std::vector<Point2D>&)>;
             using SelectionList = std::set<SelectionInfo, SelectionInfoLess>;
 
             enum class ZoomDirection {
@@ -45,6 +47,18 @@ namespace HMDT::GUI {
             enum class ViewingMode {
                 PROVINCE_VIEW,
                 STATES_VIEW,
+                TERRAIN_VIEW,
+                HEIGHTMAP_VIEW,
+            };
+
+            /**
+             * @brief What clicking on the map does
+             */
+            enum class Tool {
+                SELECT, //!< Clicking selects provinces
+                BRUSH,  //!< Dragging draws a stroke with the brush
+                FILL,   //!< Clicking picks the connected part of a province
+                LASSO   //!< Dragging draws the outline of an area to pick
             };
 
             constexpr static ViewingMode DEFAULT_VIEWING_MODE = ViewingMode::PROVINCE_VIEW;
@@ -53,6 +67,8 @@ namespace HMDT::GUI {
             virtual ~IMapDrawingAreaBase() = default;
 
             void setMapData(const std::shared_ptr<const MapData>);
+            void refreshMapData();
+            void refreshHeightMap(const std::vector<Rectangle>&);
 
             ViewingMode setViewingMode(ViewingMode);
 
@@ -72,6 +88,13 @@ namespace HMDT::GUI {
 
             void setOnProvinceSelectCallback(const SelectionCallback&);
             void setOnMultiProvinceSelectionCallback(const SelectionCallback&);
+            void setOnStrokeCallback(const StrokeCallback&);
+
+            void setTool(Tool);
+            Tool getTool() const;
+
+            void setBrushRadius(uint32_t);
+            uint32_t getBrushRadius() const;
 
             void setSelection();
             void setSelection(const SelectionInfo&);
@@ -101,10 +124,19 @@ namespace HMDT::GUI {
             virtual void onSetData(std::shared_ptr<const MapData>) = 0;
             virtual void onShow() = 0;
             virtual void onSelectionChanged(std::optional<SelectionInfo>) { };
+            virtual void onHeightMapChanged(const std::vector<Rectangle>&) { };
 
             const SelectionCallback& getOnSelect() const;
             const SelectionCallback& getOnMultiSelect() const;
 
+            void beginStroke(const Point2D&);
+            void continueStroke(const Point2D&);
+            void endStroke();
+
+            void fill(const Point2D&);
+
+            bool isStrokeTool() const;
+
         private:
             std::shared_ptr<const MapData> m_map_data;
 
@@ -114,6 +146,18 @@ namespace HMDT::GUI {
             //! Called when a province is multi-selected (shift+click)
             SelectionCallback m_on_multiselect;
 
+            //! Called with every pixel picked by the brush, fill, or lasso
+            StrokeCallback m_on_stroke;
+
+            //! What clicking on the map does
+            Tool m_tool;
+
+            //! The radius of the brush, in pixels
+            uint32_t m_brush_radius;
+
+            //! Every point the mouse was dragged through in the current stroke
+            std::vector<Point2D> m_stroke_path;
+
             //! The current selection
             SelectionList m_selections;
 
@@ -134,8 +178,11 @@ namespace HMDT::GUI {
     class IMapDrawingArea: public IMapDrawingAreaBase, public BaseGtkWidget {
         public:
             IMapDrawingArea() {
-                // Mark that we want to receive button presses
-                BaseGtkWidget::add_events(Gdk::BUTTON_PRESS_MASK);
+                // Mark that we want to receive button presses, and drags for
+                //   the brush
+                BaseGtkWidget::add_events(Gdk::BUTTON_PRESS_MASK |
+                                          Gdk::BUTTON_RELEASE_MASK |
+                                          Gdk::BUTTON1_MOTION_MASK);
             }
 
             virtual ~IMapDrawingArea() = default;
@@ -191,7 +238,11 @@ namespace HMDT::GUI {
                     auto x = event->x * (1 / getScaleFactor());
                     auto y = event->y * (1 / getScaleFactor());
 
-                    if(event->state & GDK_SHIFT_MASK) {
+                    if(isStrokeTool()) {
+                        beginStroke({ static_cast<uint32_t>(x), static_cast<uint32_t>(y) });
+                    } else if(getTool() == Tool::FILL) {
+                        fill({ static_cast<uint32_t>(x), static_cast<uint32_t>(y) });
+                    } else if(event->state & GDK_SHIFT_MASK) {
                         getOnMultiSelect()(x, y);
                     } else {
                         getOnSelect()(x, y);
@@ -201,6 +252,27 @@ namespace HMDT::GUI {
                 return true;
             }
 
+            virtual bool on_motion_notify_event(GdkEventMotion* event) override {
+                if(hasData() && isStrokeTool() &&
+                   (event->state & GDK_BUTTON1_MASK))
+                {
+                    auto x = event->x * (1 / getScaleFactor());
+                    auto y = event->y * (1 / getScaleFactor());
+
+                    continueStroke({ static_cast<uint32_t>(x), static_cast<uint32_t>(y) });
+                }
+
+                return true;
+            }
+
+            virtual bool on_button_release_event(GdkEventButton* event) override {
+                if(hasData() && isStrokeTool() && event->button == 1) {
+                    endStroke();
+                }
+
+                return true;
+            }
+
             virtual void setSizeRequest(int width = -1, int height = -1) {
                 BaseGtkWidget::set_size_request(width, height);
             }
@@ -17,12 +17,18 @@ namespace HMDT::GUI {
     MaybeVoid endAddProvinceMap(Window&, std::any);
 
     ////////////////////////////////////////////////////////////////////////////
-    Maybe<std::any> addHeightMap(Window&,
-                                 const std::vector<std::filesystem::path>&);
+    Maybe<std::any> initAddHeightMap(Window&,
+                                     const std::vector<std::filesystem::path>&);
+    MaybeVoid addHeightMapWorker(Window&, std::any);
+    MaybeVoid postStartAddHeightMap(Window&, std::any);
+    MaybeVoid endAddHeightMap(Window&, std::any);
 
     ////////////////////////////////////////////////////////////////////////////
-    Maybe<std::any> addRivers(Window&,
-                              const std::vector<std::filesystem::path>&);
+    Maybe<std::any> initAddRivers(Window&,
+                                  const std::vector<std::filesystem::path>&);
+    MaybeVoid addRiversWorker(Window&, std::any);
+    MaybeVoid postStartAddRivers(Window&, std::any);
+    MaybeVoid endAddRivers(Window&, std::any);
 }
 
 #endif
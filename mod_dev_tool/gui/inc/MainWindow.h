@@ -7,12 +7,22 @@
 #ifndef MAIN_WINDOW_H
 # define MAIN_WINDOW_H
 
+# include <filesystem>
 # include <functional>
+# include <map>
+# include <memory>
+# include <mutex>
+# include <optional>
+# include <string>
 # include <variant>
+# include <vector>
 
 # include "BitMap.h"
+# include "FileWatcher.h"
 # include "Types.h"
 
+# include "IProject.h"
+
 # include "BaseMainWindow.h"
 # include "MainWindowDrawingAreaPart.h"
 # include "MainWindowPropertiesPanePart.h"
@@ -36,6 +46,15 @@ namespace HMDT::GUI {
             //! The default position of the file tree pane
             static constexpr std::int32_t DEFAULT_FILE_TREE_POSITION = 330;
 
+            /**
+             * @brief Every input layer which can be reloaded when the file it
+             *        was loaded from changes.
+             */
+            enum class WatchedLayer {
+                HEIGHTMAP,
+                RIVERS
+            };
+
             MainWindow(Gtk::Application&);
             virtual ~MainWindow();
 
@@ -45,6 +64,9 @@ namespace HMDT::GUI {
 
             OptionalReference<LogViewerWindow> getLogViewerWindow();
 
+            void addWatchedInput(const std::filesystem::path&, WatchedLayer,
+                                 bool = false);
+
             template<typename T>
             T* thisAs() const noexcept {
                 static_assert(std::is_base_of_v<T, MainWindow>,
@@ -71,6 +93,9 @@ namespace HMDT::GUI {
             void initializeProjectActions();
             void initializeHelpActions();
 
+            void toggleBrush(const std::string&, IMapDrawingAreaBase::Tool,
+                             std::optional<Project::IHeightMapProject::SculptMode>);
+
             void newProject();
             void openProject();
 
@@ -83,7 +108,39 @@ namespace HMDT::GUI {
             void exportProject();
             void exportProjectAs(const std::string& = "Export To...");
 
+            void startWatchingInputs();
+            void stopWatchingInputs();
+            void reloadWatchedInput(const std::filesystem::path&);
+            void commitReloadedInputs();
+
+            void onBrushStroke(const std::vector<Point2D>&);
+            void onProvincesRepainted(bool);
+            void onHeightMapSculpted();
+
         private:
+            /**
+             * @brief An input file which gets reloaded when it changes
+             */
+            struct WatchedInput {
+                //! Which layer the file was loaded into
+                WatchedLayer layer;
+
+                //! Whether the user agreed to convert the file when adding it
+                bool allow_conversion;
+            };
+
+            /**
+             * @brief A layer which was reloaded in the background, waiting
+             *        to be handed off to the project
+             */
+            struct ReloadedInput {
+                //! Which layer was reloaded
+                WatchedLayer layer;
+
+                //! The new contents of the layer
+                std::shared_ptr<BitMap2> bitmap;
+            };
+
             //! The toolbar of the application
             Toolbar* m_toolbar;
 
@@ -101,6 +158,27 @@ namespace HMDT::GUI {
 
             //! The window for adding files into the current project
             std::unique_ptr<AddFileWindow> m_add_file_window;
+
+            //! How the brush sculpts the heightmap, or std::nullopt if it
+            //!   paints provinces instead
+            std::optional<Project::IHeightMapProject::SculptMode> m_sculpt_mode;
+
+            //! Guards m_watched_inputs and m_reloaded_inputs, as both are
+            //!   used from the watcher thread
+            std::mutex m_watched_inputs_mutex;
+
+            //! Every input file which gets reloaded when it changes
+            std::map<std::filesystem::path, WatchedInput> m_watched_inputs;
+
+            //! Every layer reloaded in the background since the last commit
+            std::vector<ReloadedInput> m_reloaded_inputs;
+
+            //! The dispatcher which commits reloaded layers on the main thread
+            uint32_t m_reload_dispatcher_id;
+
+            //! Watches the input files. Declared last so that its thread is
+            //!   stopped before anything it uses gets destroyed
+            std::unique_ptr<FileWatcher> m_input_watcher;
     };
 }
 
@@ -50,6 +50,7 @@ namespace HMDT::GUI {
             virtual void addWidgetToParent(Gtk::Widget&) override;
 
             void updateMergedListElements(const Province* prov);
+            void updateStatistics(const Province* prov);
             void updateProperties(const Province*, bool);
 
             void rebuildContinentMenu(const std::set<std::string>&);
@@ -60,7 +61,9 @@ namespace HMDT::GUI {
             void buildProvinceTypeField();
             void buildTerrainTypeField();
             void buildContinentField();
+            void buildStatisticsField();
             void buildStateCreationButton();
+            void buildStrategicRegionCreationButton();
             void buildMergeProvincesButton();
             void buildMergedListWindow();
 
@@ -83,9 +86,14 @@ namespace HMDT::GUI {
             Gtk::Button* m_add_button;
             Gtk::Button* m_rem_button;
 
+            //! Shows the statistics of the province, such as its area
+            Gtk::Label* m_statistics_label;
 
             Gtk::Button* m_create_state_button;
 
+            //! Button used to create a strategic region from the selection
+            Gtk::Button* m_create_strategic_region_button;
+
             bool m_is_updating_properties;
 
             //! Button used to merge two or more provinces together
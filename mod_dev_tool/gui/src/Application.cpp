@@ -72,7 +72,16 @@ void HMDT::GUI::Application::on_startup() {
 
     createMenu("Root", gettext("Edit"), {
         { gettext("_Undo"), "win.undo", {} },
-        { gettext("_Redo"), "win.redo", {} }
+        { gettext("_Redo"), "win.redo", {} },
+        { gettext("_Paint Province"), "win.paint_province", {} },
+        { gettext("_Fill Province"), "win.fill_province", {} },
+        { gettext("_Lasso Province"), "win.lasso_province", {} },
+        { gettext("_Sculpt Heightmap"), "win.sculpt", {
+            { gettext("_Raise"), "win.sculpt.raise" },
+            { gettext("_Lower"), "win.sculpt.lower" },
+            { gettext("_Smooth"), "win.sculpt.smooth" },
+            { gettext("_Flatten"), "win.sculpt.flatten" },
+        } },
     });
 
     createMenu("Root", gettext("View"), {
@@ -84,7 +93,10 @@ void HMDT::GUI::Application::on_startup() {
         { gettext("_Switch Views"), "win.switch_views", {
             { gettext("_Province View"), "win.switch_views.province" },
             { gettext("_State View"), "win.switch_views.state" },
+            { gettext("_Terrain View"), "win.switch_views.terrain" },
+            { gettext("_Heightmap View"), "win.switch_views.heightmap" },
         } },
+        { gettext("_Export Map Image"), "win.export_map_image", {} },
         { gettext("Debug"), "win.debug", {
             { gettext("Render Adjacencies"), "win.debug.render_adjacencies" },
         } },
@@ -95,6 +107,17 @@ void HMDT::GUI::Application::on_startup() {
         { gettext("Export Project"), "win.export_project", {} },
         { gettext("Export Project To"), "win.export_project_as", {} },
         { gettext("Generate Template River Map"), "win.generate_template_rivers", {} },
+        { gettext("Generate Rivers From Heightmap"), "win.generate_rivers", {} },
+        { gettext("Validate Rivers"), "win.validate_rivers", {} },
+        { gettext("Generate Strategic Regions"), "win.generate_strategic_regions", {} },
+        { gettext("Generate States"), "win.generate_states", {} },
+        { gettext("Load Terrain Map"), "win.load_terrain_map", {} },
+        { gettext("Assign Terrain From Terrain Map"), "win.assign_terrain", {} },
+        { gettext("Import Mod Map Folder"), "win.import_mod", {} },
+        { gettext("Generate Provinces From Mask"), "win.generate_provinces", {} },
+        { gettext("Split Oversized Provinces"), "win.split_oversized_provinces", {} },
+        { gettext("Absorb Tiny Provinces"), "win.absorb_tiny_provinces", {} },
+        { gettext("Watch Input Files For Changes"), "win.watch_inputs", {} },
     });
 
     createMenu("Root", gettext("Help"), {
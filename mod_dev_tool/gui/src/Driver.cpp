@@ -2,6 +2,7 @@
 #include "Driver.h"
 
 #include "Application.h"
+#include "ActionManager.h"
 #include "Util.h"
 #include "Logger.h"
 
@@ -107,17 +108,25 @@ auto HMDT::GUI::Driver::getProject() -> OptionalReference<HProject> {
 
 /**
  * @brief Sets the main project object.
+ * @details The action history is cleared first, as every action holds onto
+ *          the project that it was performed on.
  *
  * @param project 
  */
 void HMDT::GUI::Driver::setProject(UniqueProject&& project) {
+    Action::ActionManager::getInstance().clearHistory();
+
     m_project = std::move(project);
 }
 
 /**
  * @brief Unloads the main project object.
+ * @details The action history is cleared first, as every action holds onto
+ *          the project that it was performed on.
  */
 void HMDT::GUI::Driver::setProject() {
+    Action::ActionManager::getInstance().clearHistory();
+
     m_project = nullptr;
 }
 
@@ -11,6 +11,10 @@ HMDT::GUI::IMapDrawingAreaBase::IMapDrawingAreaBase():
     m_map_data(nullptr),
     m_on_select([](auto...) { }),      // The default callback does nothing
     m_on_multiselect([](auto...) { }),
+    m_on_stroke([](auto...) { }),
+    m_tool(Tool::SELECT),
+    m_brush_radius(DEFAULT_BRUSH_RADIUS),
+    m_stroke_path(),
     m_selections(),
     m_scale_factor(DEFAULT_ZOOM),
     m_viewing_mode(DEFAULT_VIEWING_MODE)
@@ -57,6 +61,31 @@ void HMDT::GUI::IMapDrawingAreaBase::setMapData(std::shared_ptr<const MapData> m
     resetZoom();
 }
 
+/**
+ * @brief Sends the current map data to the renderer again, without changing
+ *        the zoom level. Used after the map data has been edited in place.
+ */
+void HMDT::GUI::IMapDrawingAreaBase::refreshMapData() {
+    if(!hasData()) return;
+
+    onSetData(m_map_data);
+    queueDraw();
+}
+
+/**
+ * @brief Sends only the given regions of the heightmap and normal map to the
+ *        renderer again. Used after the heightmap has been sculpted.
+ *
+ * @param regions Every region of the heightmap which changed
+ */
+void HMDT::GUI::IMapDrawingAreaBase::refreshHeightMap(const std::vector<Rectangle>& regions)
+{
+    if(!hasData() || regions.empty()) return;
+
+    onHeightMapChanged(regions);
+    queueDraw();
+}
+
 void HMDT::GUI::IMapDrawingAreaBase::setOnProvinceSelectCallback(const SelectionCallback& callback)
 {
     m_on_select = callback;
@@ -67,6 +96,34 @@ void HMDT::GUI::IMapDrawingAreaBase::setOnMultiProvinceSelectionCallback(const S
     m_on_multiselect = callback;
 }
 
+void HMDT::GUI::IMapDrawingAreaBase::setOnStrokeCallback(const StrokeCallback& callback)
+{
+    m_on_stroke = callback;
+}
+
+/**
+ * @brief Changes what clicking on the map does. Any stroke which is in
+ *        progress is thrown away.
+ *
+ * @param tool The new tool
+ */
+void HMDT::GUI::IMapDrawingAreaBase::setTool(Tool tool) {
+    m_tool = tool;
+    m_stroke_path.clear();
+}
+
+auto HMDT::GUI::IMapDrawingAreaBase::getTool() const -> Tool {
+    return m_tool;
+}
+
+void HMDT::GUI::IMapDrawingAreaBase::setBrushRadius(uint32_t radius) {
+    m_brush_radius = radius;
+}
+
+uint32_t HMDT::GUI::IMapDrawingAreaBase::getBrushRadius() const {
+    return m_brush_radius;
+}
+
 void HMDT::GUI::IMapDrawingAreaBase::setSelection() {
     onSelectionChanged(std::nullopt);
     m_selections.clear();
@@ -160,6 +217,83 @@ auto HMDT::GUI::IMapDrawingAreaBase::getOnMultiSelect() const
     return m_on_multiselect;
 }
 
+/**
+ * @brief Starts a new brush stroke at the given point
+ *
+ * @param point The point on the map where the mouse was pressed
+ */
+void HMDT::GUI::IMapDrawingAreaBase::beginStroke(const Point2D& point) {
+    m_stroke_path = { point };
+}
+
+/**
+ * @brief Adds a point to the current brush stroke
+ *
+ * @param point The point on the map which the mouse was dragged to
+ */
+void HMDT::GUI::IMapDrawingAreaBase::continueStroke(const Point2D& point) {
+    if(m_stroke_path.empty()) return;
+
+    // Motion events come in far more often than the mouse moves a whole pixel
+    if(auto& last = m_stroke_path.back(); last.x != point.x || last.y != point.y)
+    {
+        m_stroke_path.push_back(point);
+    }
+}
+
+/**
+ * @brief Finishes the current stroke, and calls the stroke callback with every
+ *        pixel of the map that the brush went over, or that the lasso closed
+ *        around.
+ */
+void HMDT::GUI::IMapDrawingAreaBase::endStroke() {
+    if(m_stroke_path.empty() || !hasData()) return;
+
+    auto [width, height] = m_map_data->getDimensions();
+
+    std::vector<Point2D> pixels;
+    if(m_tool == Tool::LASSO) {
+        pixels = getPixelsInPolygon(Dimensions{ width, height }, m_stroke_path);
+    } else {
+        pixels = getPixelsAlongStroke(Dimensions{ width, height },
+                                      m_stroke_path, m_brush_radius);
+    }
+    m_stroke_path.clear();
+
+    if(!pixels.empty()) {
+        m_on_stroke(pixels);
+    }
+}
+
+/**
+ * @brief Calls the stroke callback with every pixel connected to the given
+ *        point which belongs to the same province.
+ *
+ * @param point The point on the map which was clicked
+ */
+void HMDT::GUI::IMapDrawingAreaBase::fill(const Point2D& point) {
+    if(!hasData()) return;
+
+    auto [width, height] = m_map_data->getDimensions();
+
+    std::vector<Point2D> pixels;
+    if(auto provinces = m_map_data->getProvinces().lock(); provinces) {
+        pixels = getConnectedPixels(Dimensions{ width, height },
+                                    provinces.get(), point);
+    }
+
+    if(!pixels.empty()) {
+        m_on_stroke(pixels);
+    }
+}
+
+/**
+ * @brief Whether dragging on the map with the current tool draws a stroke
+ */
+bool HMDT::GUI::IMapDrawingAreaBase::isStrokeTool() const {
+    return m_tool == Tool::BRUSH || m_tool == Tool::LASSO;
+}
+
 auto HMDT::GUI::IMapDrawingAreaBase::getSelections() const
     -> const SelectionList&
 {
@@ -189,6 +323,12 @@ std::ostream& HMDT::GUI::operator<<(std::ostream& stream,
         case IMapDrawingAreaBase::ViewingMode::STATES_VIEW:
             stream << "STATES_VIEW";
             break;
+        case IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW:
+            stream << "TERRAIN_VIEW";
+            break;
+        case IMapDrawingAreaBase::ViewingMode::HEIGHTMAP_VIEW:
+            stream << "HEIGHTMAP_VIEW";
+            break;
     }
 
     return stream;
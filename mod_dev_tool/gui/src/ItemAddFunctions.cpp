@@ -1,6 +1,9 @@
 
 #include "ItemAddFunctions.h"
 
+#include <atomic>
+#include <sstream>
+
 #include <libintl.h>
 
 #include "gtkmm.h"
@@ -13,6 +16,8 @@
 #include "GraphicalDebugger.h"
 #include "ProgressBarDialog.h"
 
+#include "LayerLoadProgress.h"
+
 namespace {
     struct AddProvinceMapData {
         //! The path that was added
@@ -45,6 +50,217 @@ namespace {
         //! The id of the Dispatcher for updating UI elements
         uint32_t ui_dispatcher_id;
     };
+
+    /**
+     * @brief Everything shared between the callbacks which load a single map
+     *        layer, such as the heightmap or the rivers.
+     */
+    struct AddMapLayerData {
+        //! The path that was added
+        std::filesystem::path path;
+
+        //! The progress bar dialog cancel button
+        Gtk::Button* cancel_button;
+
+        //! The progress bar dialog done button
+        Gtk::Button* done_button;
+
+        //! The drawing area of the window
+        std::shared_ptr<HMDT::GUI::IMapDrawingAreaBase> drawing_area;
+
+        //! The progress bar dialog window
+        std::shared_ptr<HMDT::GUI::ProgressBarDialog> progress_dialog;
+
+        //! How far along the worker is
+        std::shared_ptr<HMDT::Project::LayerLoadProgress> progress;
+
+        //! The result of the worker. Only valid once finished is true
+        std::shared_ptr<HMDT::MaybeVoid> result;
+
+        //! Whether the worker has finished, successfully or not
+        std::shared_ptr<std::atomic<bool>> finished;
+
+        //! A shared boolean for communicating if an estop was triggered
+        std::shared_ptr<bool> did_estop;
+
+        //! Whether the end callback has already run
+        std::shared_ptr<bool> did_end;
+
+        //! The id of the Dispatcher for updating UI elements
+        uint32_t ui_dispatcher_id;
+    };
+
+    struct AddHeightMapData: public AddMapLayerData {
+        //! Whether the user agreed to convert the heightmap to 8-bit greyscale
+        bool allow_conversion;
+
+        //! The heightmap loaded by the worker, waiting to be handed off
+        std::shared_ptr<HMDT::Project::IHeightMapProject::PendingHeightMap> pending;
+    };
+
+    struct AddRiversData: public AddMapLayerData {
+        //! The rivers map loaded by the worker, waiting to be handed off
+        std::shared_ptr<std::shared_ptr<HMDT::BitMap2>> pending;
+    };
+
+    /**
+     * @brief Sets up the progress dialog and the dispatcher which keeps it up
+     *        to date for loading a map layer.
+     *
+     * @param window The window which is loading the layer
+     * @param path The path to the layer
+     * @param data The data to set up
+     *
+     * @return STATUS_SUCCESS on success, or an error code on failure.
+     */
+    HMDT::MaybeVoid initAddMapLayer(HMDT::GUI::Window& window,
+                                    const std::filesystem::path& path,
+                                    AddMapLayerData& data)
+    {
+        using namespace HMDT;
+        using namespace HMDT::GUI;
+
+        MainWindow& main_window = dynamic_cast<MainWindow&>(window);
+
+        data.path = path;
+        data.drawing_area = main_window.getDrawingArea();
+        data.progress_dialog = std::make_shared<ProgressBarDialog>(window, gettext("Loading..."), "", true);
+        data.progress = std::make_shared<Project::LayerLoadProgress>();
+        data.result = std::make_shared<MaybeVoid>(STATUS_SUCCESS);
+        data.finished = std::make_shared<std::atomic<bool>>(false);
+        data.did_estop = std::make_shared<bool>(false);
+        data.did_end = std::make_shared<bool>(false);
+        data.ui_dispatcher_id = 0;
+
+        // Set up the Progress Bar Dialog
+        {
+            data.progress_dialog->setShowText(true);
+
+            data.done_button = data.progress_dialog->add_button("OK", Gtk::RESPONSE_OK);
+            data.done_button->set_sensitive(false);
+
+            data.cancel_button = data.progress_dialog->add_button("Cancel", Gtk::RESPONSE_CANCEL);
+
+            data.progress_dialog->show_all();
+        }
+
+        // The worker only ever notifies this dispatcher, all Gtk code gets
+        //   run here on the main thread
+        auto maybe_id = window.setupDispatcher([data](uint32_t) {
+            data.progress_dialog->setText(toString(data.progress->getStage()));
+            data.progress_dialog->setFraction(data.progress->getFraction());
+
+            if(*data.finished) {
+                if(IS_FAILURE(*data.result)) {
+                    data.progress_dialog->setText(data.result->error().message());
+                }
+
+                // Disable the cancel button (we've already finished), and
+                //  enable the done button so that the user can close the box
+                //  and move on
+                data.done_button->set_sensitive(true);
+                data.cancel_button->set_sensitive(false);
+            }
+        });
+        RETURN_IF_ERROR(maybe_id);
+
+        data.ui_dispatcher_id = *maybe_id;
+
+        // TODO: Is it safe to capture the window by reference? It should always
+        //   exist while this callback might be used
+        data.progress->setStageCallback(
+            [ui_dispatcher_id = data.ui_dispatcher_id, &window](Project::LayerLoadProgress::Stage)
+            {
+                auto res = window.notifyDispatcher(ui_dispatcher_id);
+                WRITE_IF_ERROR(res);
+            });
+
+        return STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Runs the progress dialog until the user either closes it or
+     *        cancels the load.
+     *
+     * @param data The data for the layer being loaded
+     *
+     * @return STATUS_SUCCESS, or STATUS_LOAD_CANCELLED if the user cancelled.
+     */
+    HMDT::MaybeVoid runAddMapLayerDialog(const AddMapLayerData& data) {
+        using namespace HMDT;
+
+        auto response = data.progress_dialog->run();
+        data.progress_dialog->hide();
+
+        // If the user cancels the action, then stop the worker as soon as it
+        //   finishes its current stage
+        if(response == Gtk::RESPONSE_DELETE_EVENT ||
+           response == Gtk::RESPONSE_CANCEL)
+        {
+            data.progress->estop();
+            *data.did_estop = true;
+
+            WRITE_WARN("Layer load cancelled. Halting the worker asap!");
+            RETURN_ERROR(STATUS_LOAD_CANCELLED);
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    /**
+     * @brief Marks the worker as finished, and lets the dispatcher know so that
+     *        it can update the progress dialog.
+     *
+     * @param window The window which is loading the layer
+     * @param data The data for the layer being loaded
+     * @param result The result of the worker
+     */
+    void finishAddMapLayerWorker(HMDT::GUI::Window& window,
+                                 const AddMapLayerData& data,
+                                 const HMDT::MaybeVoid& result)
+    {
+        *data.result = result;
+        *data.finished = true;
+
+        auto res = window.notifyDispatcher(data.ui_dispatcher_id);
+        WRITE_IF_ERROR(res);
+    }
+
+    /**
+     * @brief Tears down everything set up by initAddMapLayer.
+     * @details The end callback may get called twice if the load was
+     *          cancelled, so this also makes sure that only the first call
+     *          does anything.
+     *
+     * @param window The window which is loading the layer
+     * @param data The data for the layer being loaded
+     *
+     * @return STATUS_SUCCESS if the layer should be handed off to the project,
+     *         or an error code otherwise.
+     */
+    HMDT::MaybeVoid endAddMapLayer(HMDT::GUI::Window& window,
+                                   const AddMapLayerData& data)
+    {
+        using namespace HMDT;
+
+        if(*data.did_end) {
+            RETURN_ERROR(STATUS_LOAD_CANCELLED);
+        }
+        *data.did_end = true;
+
+        WRITE_DEBUG("Tearing down the ui dispatcher.");
+        auto res = window.teardownDispatcher(data.ui_dispatcher_id);
+        RETURN_IF_ERROR(res);
+
+        // Don't finish loading if we stopped early
+        if(*data.did_estop) {
+            RETURN_ERROR(STATUS_LOAD_CANCELLED);
+        }
+
+        RETURN_IF_ERROR(*data.result);
+
+        return STATUS_SUCCESS;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -308,87 +524,187 @@ HMDT::MaybeVoid HMDT::GUI::endAddProvinceMap(Window& window, std::any data) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-auto HMDT::GUI::addHeightMap(Window& window,
-                             const std::vector<std::filesystem::path>& paths)
+auto HMDT::GUI::initAddHeightMap(Window& window,
+                                 const std::vector<std::filesystem::path>& paths)
     -> Maybe<std::any>
 {
-    if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
-        auto& project = opt_project->get();
+    if(paths.empty()) {
+        WRITE_ERROR("Expected at least 1 path, got 0.");
+        RETURN_ERROR(STATUS_EXPECTED_PATHS);
+    }
 
-        project.getMapProject().getHeightMapProject().setPromptCallback(
-            [&window](const std::string& message,
-                      const std::vector<std::string>& opts,
-                      const Project::IProject::PromptType& /*type*/)
-                -> uint32_t
-            {
-                // TODO: We should make use of the PromptType here
-
-                // Create a dialog with no buttons, as we will just add the ones
-                //   specified in opts.
-                Gtk::MessageDialog dialog(window,
-                                          message,
-                                          true /* use_markup */,
-                                          Gtk::MESSAGE_QUESTION /* type */,
-                                          Gtk::BUTTONS_NONE /* buttons */);
-                for(uint32_t i = 0; i < opts.size(); ++i) {
-                    dialog.add_button(opts.at(i), i);
-                }
+    auto opt_project = Driver::getInstance().getProject();
+    RETURN_ERROR_IF(!opt_project, STATUS_NO_PROJECT_LOADED);
+
+    auto& heightmap_project = opt_project->get().getMapProject().getHeightMapProject();
+
+    // Only read the header here, so that we can ask about converting the
+    //   heightmap now, rather than blocking the worker on the user later
+    auto bpp = heightmap_project.checkFile(paths.front());
+    RETURN_IF_ERROR(bpp);
+
+    AddHeightMapData data;
+    data.allow_conversion = false;
+    data.pending = std::make_shared<Project::IHeightMapProject::PendingHeightMap>();
+
+    if(*bpp != 8) {
+        std::stringstream prompt_ss;
+        prompt_ss << "Heightmaps must be an 8-bit greyscale image (loaded "
+                     "image has BPP=" << *bpp << "). Convert to 8-bit image?";
+
+        Gtk::MessageDialog dialog(window,
+                                  prompt_ss.str(),
+                                  true /* use_markup */,
+                                  Gtk::MESSAGE_QUESTION /* type */,
+                                  Gtk::BUTTONS_YES_NO /* buttons */);
+        if(dialog.run() != Gtk::RESPONSE_YES) {
+            WRITE_ERROR("Not converting input image. Cannot continue loading.");
+            RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+        }
 
-                return dialog.run();
-            });
+        data.allow_conversion = true;
+    }
+
+    auto res = initAddMapLayer(window, paths.front(), data);
+    RETURN_IF_ERROR(res);
 
-        WRITE_DEBUG("Loading new heightmap into HeightMapProject.");
-        auto res = project.getMapProject().getHeightMapProject().loadFile(paths.front());
+    return data;
+}
 
-        // Make sure we reset before checking for errors
-        project.getMapProject().getHeightMapProject().resetPromptCallback();
+HMDT::MaybeVoid HMDT::GUI::addHeightMapWorker(Window& window, std::any data) {
+    AddHeightMapData ahd_data = std::any_cast<AddHeightMapData>(data);
 
-        RETURN_IF_ERROR(res);
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) {
+        finishAddMapLayerWorker(window, ahd_data, STATUS_NO_PROJECT_LOADED);
+        return STATUS_SUCCESS;
+    }
+
+    WRITE_DEBUG("Loading new heightmap on the worker thread.");
+    auto pending = opt_project->get().getMapProject().getHeightMapProject()
+                       .prepareFile(ahd_data.path, ahd_data.allow_conversion,
+                                    *ahd_data.progress);
+    if(IS_SUCCESS(pending)) {
+        *ahd_data.pending = std::move(*pending);
     }
 
+    // Always report back, so that the end callback gets to run even if we
+    //   failed
+    finishAddMapLayerWorker(window, ahd_data,
+                            IS_SUCCESS(pending) ? MaybeVoid{STATUS_SUCCESS}
+                                                : MaybeVoid{pending.error()});
+
+    return STATUS_SUCCESS;
+}
+
+HMDT::MaybeVoid HMDT::GUI::postStartAddHeightMap(Window&, std::any data) {
+    return runAddMapLayerDialog(std::any_cast<AddHeightMapData>(data));
+}
+
+HMDT::MaybeVoid HMDT::GUI::endAddHeightMap(Window& window, std::any data) {
+    AddHeightMapData ahd_data = std::any_cast<AddHeightMapData>(data);
+
+    auto res = endAddMapLayer(window, ahd_data);
+    RETURN_IF_ERROR(res);
+
+    auto opt_project = Driver::getInstance().getProject();
+    RETURN_ERROR_IF(!opt_project, STATUS_NO_PROJECT_LOADED);
+
+    // Hand off the whole layer at once, now that we are back on the main
+    //   thread
+    WRITE_DEBUG("Assigning the new heightmap to the HeightMapProject.");
+    res = opt_project->get().getMapProject().getHeightMapProject()
+              .commitFile(std::move(*ahd_data.pending));
+    RETURN_IF_ERROR(res);
+
+    // Reload the heightmap whenever it gets edited outside of the tool
+    dynamic_cast<MainWindow&>(window).addWatchedInput(ahd_data.path,
+                                                      MainWindow::WatchedLayer::HEIGHTMAP,
+                                                      ahd_data.allow_conversion);
+
+    ahd_data.drawing_area->queueDraw();
+
     return STATUS_SUCCESS;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-auto HMDT::GUI::addRivers(Window& window,
-                          const std::vector<std::filesystem::path>& paths)
+auto HMDT::GUI::initAddRivers(Window& window,
+                              const std::vector<std::filesystem::path>& paths)
     -> Maybe<std::any>
 {
-    if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
-        auto& project = opt_project->get();
+    if(paths.empty()) {
+        WRITE_ERROR("Expected at least 1 path, got 0.");
+        RETURN_ERROR(STATUS_EXPECTED_PATHS);
+    }
 
-        project.getMapProject().getRiversProject().setPromptCallback(
-            [&window](const std::string& message,
-                      const std::vector<std::string>& opts,
-                      const Project::IProject::PromptType& /*type*/)
-                -> uint32_t
-            {
-                // TODO: We should make use of the PromptType here
-
-                // Create a dialog with no buttons, as we will just add the ones
-                //   specified in opts.
-                Gtk::MessageDialog dialog(window,
-                                          message,
-                                          true /* use_markup */,
-                                          Gtk::MESSAGE_QUESTION /* type */,
-                                          Gtk::BUTTONS_NONE /* buttons */);
-                for(uint32_t i = 0; i < opts.size(); ++i) {
-                    dialog.add_button(opts.at(i), i);
-                }
+    auto opt_project = Driver::getInstance().getProject();
+    RETURN_ERROR_IF(!opt_project, STATUS_NO_PROJECT_LOADED);
 
-                return dialog.run();
-            });
+    // Rivers can never be converted, so reject them before ever starting the
+    //   worker
+    auto bpp = opt_project->get().getMapProject().getRiversProject().checkFile(paths.front());
+    RETURN_IF_ERROR(bpp);
 
-        WRITE_DEBUG("Loading new rivers map into RiversProject.");
-        auto res = project.getMapProject().getRiversProject().loadFile(paths.front());
+    AddRiversData data;
+    data.pending = std::make_shared<std::shared_ptr<BitMap2>>();
 
-        // Make sure we reset before checking for errors
-        project.getMapProject().getRiversProject().resetPromptCallback();
+    auto res = initAddMapLayer(window, paths.front(), data);
+    RETURN_IF_ERROR(res);
 
-        RETURN_IF_ERROR(res);
+    return data;
+}
+
+HMDT::MaybeVoid HMDT::GUI::addRiversWorker(Window& window, std::any data) {
+    AddRiversData ard_data = std::any_cast<AddRiversData>(data);
+
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) {
+        finishAddMapLayerWorker(window, ard_data, STATUS_NO_PROJECT_LOADED);
+        return STATUS_SUCCESS;
+    }
+
+    WRITE_DEBUG("Loading new rivers map on the worker thread.");
+    auto pending = opt_project->get().getMapProject().getRiversProject()
+                       .prepareFile(ard_data.path, *ard_data.progress);
+    if(IS_SUCCESS(pending)) {
+        *ard_data.pending = *pending;
     }
 
+    // Always report back, so that the end callback gets to run even if we
+    //   failed
+    finishAddMapLayerWorker(window, ard_data,
+                            IS_SUCCESS(pending) ? MaybeVoid{STATUS_SUCCESS}
+                                                : MaybeVoid{pending.error()});
+
     return STATUS_SUCCESS;
 }
 
+HMDT::MaybeVoid HMDT::GUI::postStartAddRivers(Window&, std::any data) {
+    return runAddMapLayerDialog(std::any_cast<AddRiversData>(data));
+}
+
+HMDT::MaybeVoid HMDT::GUI::endAddRivers(Window& window, std::any data) {
+    AddRiversData ard_data = std::any_cast<AddRiversData>(data);
+
+    auto res = endAddMapLayer(window, ard_data);
+    RETURN_IF_ERROR(res);
+
+    auto opt_project = Driver::getInstance().getProject();
+    RETURN_ERROR_IF(!opt_project, STATUS_NO_PROJECT_LOADED);
+
+    // Hand off the whole layer at once, now that we are back on the main
+    //   thread
+    WRITE_DEBUG("Assigning the new rivers map to the RiversProject.");
+    res = opt_project->get().getMapProject().getRiversProject()
+              .commitFile(*ard_data.pending);
+    RETURN_IF_ERROR(res);
+
+    // Reload the rivers whenever they get edited outside of the tool
+    dynamic_cast<MainWindow&>(window).addWatchedInput(ard_data.path,
+                                                      MainWindow::WatchedLayer::RIVERS);
+
+    ard_data.drawing_area->queueDraw();
+
+    return STATUS_SUCCESS;
+}
@@ -70,10 +70,10 @@ DEFINE_ITEM_TYPE(
         "map/*",
         "history/states/*"
     } /* extra_overrides */,
-    HMDT::GUI::addHeightMap /* init_add_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* add_worker_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* post_start_add_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* end_add_callback  */,
+    HMDT::GUI::initAddHeightMap /* init_add_callback */,
+    HMDT::GUI::addHeightMapWorker /* add_worker_callback */,
+    HMDT::GUI::postStartAddHeightMap /* post_start_add_callback */,
+    HMDT::GUI::endAddHeightMap /* end_add_callback */,
     [](HMDT::GUI::Window& parent_window) -> HMDT::MaybeVoid {
         return HMDT::STATUS_NOT_IMPLEMENTED;
     } /* on_remove_callback */
@@ -101,10 +101,10 @@ DEFINE_ITEM_TYPE(
         "map/*",
         "history/states/*"
     } /* extra_overrides */,
-    HMDT::GUI::addRivers /* init_add_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* add_worker_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* post_start_add_callback */,
-    HMDT::GUI::ItemType::DEFAULT_POSTINIT_CALLBACK /* end_add_callback  */,
+    HMDT::GUI::initAddRivers /* init_add_callback */,
+    HMDT::GUI::addRiversWorker /* add_worker_callback */,
+    HMDT::GUI::postStartAddRivers /* post_start_add_callback */,
+    HMDT::GUI::endAddRivers /* end_add_callback */,
     [](HMDT::GUI::Window& parent_window) -> HMDT::MaybeVoid {
         return HMDT::STATUS_NOT_IMPLEMENTED;
     } /* on_remove_callback */
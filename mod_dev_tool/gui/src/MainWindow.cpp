@@ -1,5 +1,6 @@
 #include "MainWindow.h"
 
+#include <algorithm>
 #include <thread>
 #include <sstream>
 
@@ -12,6 +13,7 @@
 #include "BitMap.h"
 #include "Constants.h"
 #include "Logger.h"
+#include "MapRenderer.h"
 #include "Util.h" // overloaded
 #include "Options.h"
 #include "Preferences.h"
@@ -20,6 +22,9 @@
 #include "ShapeFinder2.h" // ShapeFinder
 
 #include "ActionManager.h"
+#include "AssignTerrainAction.h"
+#include "PaintProvinceAction.h"
+#include "SculptHeightMapAction.h"
 
 #include "GraphicalDebugger.h"
 #include "Application.h"
@@ -31,6 +36,40 @@
 #include "Item.h"
 
 #include "NodeKeyNames.h"
+#include "LayerLoadProgress.h"
+
+namespace {
+    using SculptMode = HMDT::Project::IHeightMapProject::SculptMode;
+    using Tool = HMDT::GUI::IMapDrawingAreaBase::Tool;
+
+    /**
+     * @brief An action which turns on a brush
+     */
+    struct BrushAction {
+        //! The name of the action
+        std::string name;
+
+        //! How the brush picks pixels on the map
+        Tool tool;
+
+        //! How the brush sculpts the heightmap, or std::nullopt if it paints
+        //!   provinces instead
+        std::optional<SculptMode> sculpt_mode;
+    };
+
+    /**
+     * @brief Every action which turns on a brush
+     */
+    const std::vector<BrushAction> BRUSH_ACTIONS = {
+        { "paint_province", Tool::BRUSH, std::nullopt },
+        { "fill_province", Tool::FILL, std::nullopt },
+        { "lasso_province", Tool::LASSO, std::nullopt },
+        { "sculpt.raise", Tool::BRUSH, SculptMode::RAISE },
+        { "sculpt.lower", Tool::BRUSH, SculptMode::LOWER },
+        { "sculpt.smooth", Tool::BRUSH, SculptMode::SMOOTH },
+        { "sculpt.flatten", Tool::BRUSH, SculptMode::FLATTEN }
+    };
+}
 
 /**
  * @brief Constructs the main window.
@@ -39,12 +78,16 @@
  */
 HMDT::GUI::MainWindow::MainWindow(Gtk::Application& application):
     BaseMainWindow(APPLICATION_NAME, application),
-    MainWindowDrawingAreaPart()
+    MainWindowDrawingAreaPart(),
+    m_sculpt_mode(std::nullopt),
+    m_reload_dispatcher_id(0)
 {
     set_size_request(512, 512);
 }
 
-HMDT::GUI::MainWindow::~MainWindow() { }
+HMDT::GUI::MainWindow::~MainWindow() {
+    stopWatchingInputs();
+}
 
 /**
  * @brief Initializes every action for the menubar
@@ -128,6 +171,46 @@ void HMDT::GUI::MainWindow::initializeEditActions() {
             WRITE_WARN("Failed to redo action.");
         }
     });
+
+    // Dragging on the map uses whichever brush is on, instead of selecting
+    //   provinces
+    for(auto&& [name, tool, mode] : BRUSH_ACTIONS) {
+        auto brush_action = add_action_bool(name, [this, name = name, tool = tool, mode = mode]() {
+            toggleBrush(name, tool, mode);
+        });
+        brush_action->change_state(false);
+        brush_action->set_enabled(false);
+    }
+}
+
+/**
+ * @brief Turns a brush on, or back off if it already was. Only one brush can
+ *        be on at a time.
+ *
+ * @param name The name of the brush's action
+ * @param tool How the brush picks pixels on the map
+ * @param mode How the brush sculpts the heightmap, or std::nullopt if it
+ *             paints provinces instead
+ */
+void HMDT::GUI::MainWindow::toggleBrush(const std::string& name,
+                                        IMapDrawingAreaBase::Tool tool,
+                                        std::optional<Project::IHeightMapProject::SculptMode> mode)
+{
+    auto self = lookupAction<Gio::SimpleAction>(name);
+    bool state;
+    self->get_state<bool>(state);
+
+    for(auto&& brush : BRUSH_ACTIONS) {
+        lookupAction<Gio::SimpleAction>(brush.name)->change_state(false);
+    }
+
+    if(state) {
+        m_drawing_area->setTool(IMapDrawingAreaBase::Tool::SELECT);
+    } else {
+        m_sculpt_mode = mode;
+        m_drawing_area->setTool(tool);
+        self->change_state(true);
+    }
 }
 
 /**
@@ -183,10 +266,16 @@ void HMDT::GUI::MainWindow::initializeViewActions() {
             auto self = lookup_action("switch_views.province");
             self->change_state(true);
 
-            // Change the state view to be disabled
+            // Change the other views to be disabled
             auto state_option = lookup_action("switch_views.state");
             state_option->change_state(false);
 
+            auto terrain_option = lookup_action("switch_views.terrain");
+            terrain_option->change_state(false);
+
+            auto heightmap_option = lookup_action("switch_views.heightmap");
+            heightmap_option->change_state(false);
+
             auto prev_mode = m_drawing_area->setViewingMode(IMapDrawingAreaBase::ViewingMode::PROVINCE_VIEW);
             WRITE_DEBUG("Switched from rendering view ", prev_mode, " to ",
                         IMapDrawingAreaBase::ViewingMode::PROVINCE_VIEW);
@@ -197,18 +286,132 @@ void HMDT::GUI::MainWindow::initializeViewActions() {
             auto self = lookup_action("switch_views.state");
             self->change_state(true);
 
-            // Change the province view to be disabled
+            // Change the other views to be disabled
             auto province_option = lookup_action("switch_views.province");
             province_option->change_state(false);
 
+            auto terrain_option = lookup_action("switch_views.terrain");
+            terrain_option->change_state(false);
+
+            auto heightmap_option = lookup_action("switch_views.heightmap");
+            heightmap_option->change_state(false);
+
             auto prev_mode = m_drawing_area->setViewingMode(IMapDrawingAreaBase::ViewingMode::STATES_VIEW);
             WRITE_DEBUG("Switched from rendering view ", prev_mode, " to ",
                         IMapDrawingAreaBase::ViewingMode::STATES_VIEW);
         });
 
+        add_action_bool("switch_views.terrain", [this]() {
+            // Change us to be enabled
+            auto self = lookup_action("switch_views.terrain");
+            self->change_state(true);
+
+            // Change the other views to be disabled
+            auto province_option = lookup_action("switch_views.province");
+            province_option->change_state(false);
+
+            auto state_option = lookup_action("switch_views.state");
+            state_option->change_state(false);
+
+            auto heightmap_option = lookup_action("switch_views.heightmap");
+            heightmap_option->change_state(false);
+
+            auto prev_mode = m_drawing_area->setViewingMode(IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW);
+            WRITE_DEBUG("Switched from rendering view ", prev_mode, " to ",
+                        IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW);
+        });
+
+        add_action_bool("switch_views.heightmap", [this]() {
+            // Change us to be enabled
+            auto self = lookup_action("switch_views.heightmap");
+            self->change_state(true);
+
+            // Change the other views to be disabled
+            auto province_option = lookup_action("switch_views.province");
+            province_option->change_state(false);
+
+            auto state_option = lookup_action("switch_views.state");
+            state_option->change_state(false);
+
+            auto terrain_option = lookup_action("switch_views.terrain");
+            terrain_option->change_state(false);
+
+            auto prev_mode = m_drawing_area->setViewingMode(IMapDrawingAreaBase::ViewingMode::HEIGHTMAP_VIEW);
+            WRITE_DEBUG("Switched from rendering view ", prev_mode, " to ",
+                        IMapDrawingAreaBase::ViewingMode::HEIGHTMAP_VIEW);
+        });
+
         provinceview_action->change_state(true);
     }
 
+    {
+        auto export_map_image_action = add_action("export_map_image", [this]() {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& project = opt_project->get();
+
+                // Render whatever is currently being viewed
+                auto mode = MapMode::PROVINCES;
+                switch(m_drawing_area->getViewingMode()) {
+                    case IMapDrawingAreaBase::ViewingMode::PROVINCE_VIEW:
+                        mode = MapMode::PROVINCES;
+                        break;
+                    case IMapDrawingAreaBase::ViewingMode::STATES_VIEW:
+                        mode = MapMode::STATES;
+                        break;
+                    case IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW:
+                        mode = MapMode::TERRAIN;
+                        break;
+                    case IMapDrawingAreaBase::ViewingMode::HEIGHTMAP_VIEW:
+                        mode = MapMode::HEIGHTMAP;
+                        break;
+                }
+
+                std::optional<std::filesystem::path> path;
+
+                NativeDialog::FileDialog dialog(gettext("Export Map Image..."),
+                                                NativeDialog::FileDialog::SELECT_FILE |
+                                                NativeDialog::FileDialog::SELECT_TO_SAVE);
+                dialog.addFilter(gettext("Bitmap Files"), "bmp")
+                      .addFilter(gettext("All files"), "*")
+                      .setAllowsMultipleSelection(false)
+                      .setDecideHandler([&path](const NativeDialog::Dialog& dialog) {
+                            auto& fdlg = dynamic_cast<const NativeDialog::FileDialog&>(dialog);
+                            path = fdlg.selectedPathes().front();
+                      }).show();
+
+                if(!path) return;
+
+                MapRenderOptions options;
+                if(mode == MapMode::PROVINCES) {
+                    options.selection = SelectionManager::getInstance().getSelectedProvinceLabels();
+                }
+
+                auto image = project.renderMap(mode, options);
+                WRITE_IF_ERROR(image);
+
+                auto failed = IS_FAILURE(image);
+                if(!failed) {
+                    auto res = writeBMP2(*path, image->pixels.data(),
+                                         image->width, image->height);
+                    WRITE_IF_ERROR(res);
+
+                    failed = IS_FAILURE(res);
+                }
+
+                if(failed) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Failed to export the map image. See the log for details."),
+                            false, Gtk::MESSAGE_ERROR);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to export a map image.");
+            }
+        });
+        export_map_image_action->set_enabled(false);
+    }
+
     // Debug actions
     {
         auto render_adjacencies_action = add_action_bool("debug.render_adjacencies", [this]()
@@ -321,6 +524,579 @@ void HMDT::GUI::MainWindow::initializeProjectActions() {
         });
         generate_template_rivers_action->set_enabled(false);
     }
+
+    {
+        auto generate_rivers_action = add_action("generate_rivers",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& rivers_project = opt_project->get().getMapProject().getRiversProject();
+
+                // Make sure the user actually wants to throw away any rivers
+                //   they drew by hand
+                Gtk::MessageDialog confirm_dialog(*this,
+                        gettext("This will replace any existing rivers. Continue?"),
+                        false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO);
+                if(confirm_dialog.run() != Gtk::RESPONSE_YES) {
+                    return;
+                }
+
+                auto res = rivers_project.generateRivers(DEFAULT_RIVER_MIN_CATCHMENT);
+                WRITE_IF_ERROR(res);
+
+                if(IS_SUCCESS(res)) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Successfully generated rivers from the heightmap."),
+                            false, Gtk::MESSAGE_INFO);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to generate rivers.");
+            }
+        });
+        generate_rivers_action->set_enabled(false);
+    }
+
+    {
+        auto validate_rivers_action = add_action("validate_rivers",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& map_project = opt_project->get().getMapProject();
+
+                auto res = map_project.getRiversProject().validateRivers();
+                WRITE_IF_ERROR(res);
+                if(IS_FAILURE(res)) {
+                    return;
+                }
+
+                const auto& issues = *res;
+                if(issues.empty()) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("No problems were found in the rivers."),
+                            false, Gtk::MESSAGE_INFO);
+                    dialog.run();
+                    return;
+                }
+
+                std::stringstream title_ss;
+                title_ss << issues.size() << ' '
+                         << gettext("problems were found in the rivers.");
+                if(issues.size() > MAX_DISPLAYED_RIVER_ISSUES) {
+                    title_ss << ' ' << gettext("Only the first")
+                             << ' ' << MAX_DISPLAYED_RIVER_ISSUES << ' '
+                             << gettext("are listed.");
+                }
+
+                Gtk::Dialog dialog(gettext("Validate Rivers"), *this, true);
+                dialog.add_button(gettext("Close"), Gtk::RESPONSE_CLOSE);
+                dialog.set_default_size(400, 400);
+
+                Gtk::Label title_label(title_ss.str());
+                Gtk::ScrolledWindow issues_window;
+                Gtk::ListBox issues_list;
+
+                issues_window.set_vexpand();
+                issues_window.add(issues_list);
+
+                dialog.get_content_area()->pack_start(title_label, Gtk::PACK_SHRINK);
+                dialog.get_content_area()->pack_start(issues_window);
+
+                auto count = std::min<size_t>(issues.size(), MAX_DISPLAYED_RIVER_ISSUES);
+                for(size_t i = 0; i < count; ++i) {
+                    std::stringstream issue_ss;
+                    issue_ss << '(' << issues[i].position.x << ", "
+                             << issues[i].position.y << "): "
+                             << issues[i].type;
+
+                    auto* label = Gtk::manage(new Gtk::Label(issue_ss.str()));
+                    label->set_halign(Gtk::ALIGN_START);
+                    issues_list.append(*label);
+                }
+
+                // Highlight the province each issue is in, so that it can be
+                //   found on the map
+                auto map_data = map_project.getMapData();
+                issues_list.signal_row_selected().connect(
+                    [&issues, map_data](Gtk::ListBoxRow* row)
+                    {
+                        if(row == nullptr) return;
+
+                        const auto& position = issues[row->get_index()].position;
+                        auto index = xyToIndex(map_data->getWidth(),
+                                               position.x, position.y);
+
+                        SelectionManager::getInstance().selectProvince(
+                                map_data->getProvinces().lock()[index]);
+                    });
+
+                dialog.show_all_children();
+                dialog.run();
+            } else {
+                WRITE_ERROR("No project is loaded, unable to validate rivers.");
+            }
+        });
+        validate_rivers_action->set_enabled(false);
+    }
+
+    {
+        auto generate_strategic_regions_action = add_action("generate_strategic_regions",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& region_project = opt_project->get().getMapProject().getStrategicRegionProject();
+
+                // Make sure the user actually wants to throw away every region
+                //   they already have
+                if(!region_project.getStrategicRegions().empty()) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("This will replace every existing strategic region. Continue?"),
+                            false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO);
+                    if(dialog.run() != Gtk::RESPONSE_YES) {
+                        return;
+                    }
+                }
+
+                auto res = region_project.generateStrategicRegions(DEFAULT_STRATEGIC_REGION_COUNT);
+                WRITE_IF_ERROR(res);
+
+                if(IS_SUCCESS(res)) {
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully generated strategic regions.")
+                       << "</b>\n\n"
+                       << gettext("Number of regions: ")
+                       << region_project.getStrategicRegions().size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to generate strategic regions.");
+            }
+        });
+        generate_strategic_regions_action->set_enabled(false);
+    }
+
+    {
+        auto generate_states_action = add_action("generate_states",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& state_project = opt_project->get().getHistoryProject().getStateProject();
+
+                // Make sure the user actually wants to throw away every state
+                //   they already have
+                if(!state_project.getStates().empty()) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("This will replace every existing state. Continue?"),
+                            false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO);
+                    if(dialog.run() != Gtk::RESPONSE_YES) {
+                        return;
+                    }
+                }
+
+                auto res = state_project.generateStates(DEFAULT_PROVINCES_PER_STATE, 0);
+                WRITE_IF_ERROR(res);
+
+                if(IS_SUCCESS(res)) {
+                    m_drawing_area->queueDraw();
+
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully generated states.")
+                       << "</b>\n\n"
+                       << gettext("Number of states: ")
+                       << state_project.getStates().size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to generate states.");
+            }
+        });
+        generate_states_action->set_enabled(false);
+    }
+
+    {
+        auto load_terrain_map_action = add_action("load_terrain_map", [this]() {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& terrain_project = opt_project->get().getMapProject().getTerrainProject();
+
+                std::optional<std::filesystem::path> path;
+
+                NativeDialog::FileDialog dialog(gettext("Select Terrain Map..."),
+                                                NativeDialog::FileDialog::SELECT_FILE);
+                dialog.setAllowsMultipleSelection(false)
+                      .setDecideHandler([&path](const NativeDialog::Dialog& dialog) {
+                            auto& fdlg = dynamic_cast<const NativeDialog::FileDialog&>(dialog);
+                            path = fdlg.selectedPathes().front();
+                      }).show();
+
+                if(!path) return;
+
+                auto res = terrain_project.loadFile(*path);
+                WRITE_IF_ERROR(res);
+
+                if(IS_FAILURE(res)) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Failed to load the terrain map. See the log for details."),
+                            false, Gtk::MESSAGE_ERROR);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to load a terrain map.");
+            }
+        });
+        load_terrain_map_action->set_enabled(false);
+    }
+
+    {
+        auto assign_terrain_action = add_action("assign_terrain", [this]() {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& map_project = opt_project->get().getMapProject();
+                auto& terrain_project = map_project.getTerrainProject();
+
+                if(!terrain_project.hasTerrainMap()) {
+                    activate_action("load_terrain_map");
+
+                    if(!terrain_project.hasTerrainMap()) return;
+                }
+
+                auto changes = terrain_project.calculateProvinceTerrains({});
+                WRITE_IF_ERROR(changes);
+                if(IS_FAILURE(changes)) {
+                    return;
+                }
+
+                if(changes->empty()) {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Every province already has the terrain of the terrain map."),
+                            false, Gtk::MESSAGE_INFO);
+                    dialog.run();
+                    return;
+                }
+
+                {
+                    std::stringstream ss;
+                    ss << gettext("Number of provinces whose terrain will change: ")
+                       << changes->size() << "\n\n"
+                       << gettext("Continue?");
+                    Gtk::MessageDialog dialog(*this, ss.str(), false,
+                                              Gtk::MESSAGE_QUESTION,
+                                              Gtk::BUTTONS_YES_NO);
+                    if(dialog.run() != Gtk::RESPONSE_YES) {
+                        return;
+                    }
+                }
+
+                // Go through the ActionManager so that this can be undone
+                if(!Action::ActionManager::getInstance().doAction(
+                        new Action::AssignTerrainAction(map_project, *changes)))
+                {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Failed to assign terrain. See the log for details."),
+                            false, Gtk::MESSAGE_ERROR);
+                    dialog.run();
+                    return;
+                }
+
+                m_drawing_area->queueDraw();
+            } else {
+                WRITE_ERROR("No project is loaded, unable to assign terrain.");
+            }
+        });
+        assign_terrain_action->set_enabled(false);
+    }
+
+    {
+        auto import_mod_action = add_action("import_mod", [this]() {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& project = opt_project->get();
+
+                // Make sure the user actually wants to throw away the map they
+                //   already have
+                if(!project.getMapProject().getProvinceProject().getProvinces().empty())
+                {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("This will replace every existing province and state. Continue?"),
+                            false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO);
+                    if(dialog.run() != Gtk::RESPONSE_YES) {
+                        return;
+                    }
+                }
+
+                std::optional<std::filesystem::path> mod_root;
+
+                NativeDialog::FileDialog dialog(gettext("Import Mod Folder..."),
+                                                NativeDialog::FileDialog::SELECT_DIR);
+                dialog.setAllowsMultipleSelection(false)
+                      .setDecideHandler([&mod_root](const NativeDialog::Dialog& dialog) {
+                            auto& fdlg = dynamic_cast<const NativeDialog::FileDialog&>(dialog);
+                            mod_root = fdlg.selectedPathes().front();
+                      }).show();
+
+                if(!mod_root) return;
+
+                auto res = project.importMod(*mod_root);
+                WRITE_IF_ERROR(res);
+
+                // Point the drawing area and file tree at the new data, even
+                //   if the import failed part of the way through
+                m_drawing_area->setMapData(project.getMapProject().getMapData());
+                m_drawing_area->queueDraw();
+
+                auto result = MainWindowFileTreePart::onProjectOpened();
+                WRITE_IF_ERROR(result);
+
+                if(IS_SUCCESS(res)) {
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully imported the mod.")
+                       << "</b>\n\n"
+                       << gettext("Number of provinces: ")
+                       << project.getMapProject().getProvinceProject().getProvinces().size()
+                       << '\n'
+                       << gettext("Number of states: ")
+                       << project.getHistoryProject().getStateProject().getStates().size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                } else {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Failed to import the mod. See the log for details."),
+                            false, Gtk::MESSAGE_ERROR);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to import a mod.");
+            }
+        });
+        import_mod_action->set_enabled(false);
+    }
+
+    {
+        auto generate_provinces_action = add_action("generate_provinces", [this]() {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& project = opt_project->get();
+
+                // Make sure the user actually wants to throw away the map they
+                //   already have
+                if(!project.getMapProject().getProvinceProject().getProvinces().empty())
+                {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("This will replace every existing province and state. Continue?"),
+                            false, Gtk::MESSAGE_QUESTION, Gtk::BUTTONS_YES_NO);
+                    if(dialog.run() != Gtk::RESPONSE_YES) {
+                        return;
+                    }
+                }
+
+                ProvinceGeneratorOptions options;
+                bool use_density_map = false;
+
+                {
+                    Gtk::Dialog dialog(gettext("Generate Provinces"), *this, true);
+                    dialog.add_button(gettext("Generate"), Gtk::RESPONSE_ACCEPT);
+                    dialog.add_button(gettext("Cancel"), Gtk::RESPONSE_CANCEL);
+
+                    Gtk::Grid grid;
+                    grid.set_row_spacing(5);
+                    grid.set_column_spacing(5);
+
+                    Gtk::Label count_label(gettext("Number of provinces (0 to pick from the map size)"));
+                    auto count_adjustment = Gtk::Adjustment::create(0, 0, 100000, 100, 1000);
+                    Gtk::SpinButton count_button(count_adjustment);
+
+                    Gtk::Label seed_label(gettext("Seed"));
+                    auto seed_adjustment = Gtk::Adjustment::create(0, 0, 1000000, 1, 100);
+                    Gtk::SpinButton seed_button(seed_adjustment);
+
+                    Gtk::CheckButton density_button(gettext("Use a density map (such as a heightmap)"));
+
+                    grid.attach(count_label, 0, 0);
+                    grid.attach(count_button, 1, 0);
+                    grid.attach(seed_label, 0, 1);
+                    grid.attach(seed_button, 1, 1);
+                    grid.attach(density_button, 0, 2, 2, 1);
+
+                    dialog.get_content_area()->pack_start(grid);
+                    dialog.show_all_children();
+
+                    if(dialog.run() != Gtk::RESPONSE_ACCEPT) {
+                        return;
+                    }
+
+                    options.province_count = count_button.get_value_as_int();
+                    options.seed = seed_button.get_value_as_int();
+                    use_density_map = density_button.get_active();
+                }
+
+                std::optional<std::filesystem::path> mask_path;
+                std::filesystem::path density_path;
+
+                NativeDialog::FileDialog mask_dialog(gettext("Select Land/Sea Mask..."),
+                                                     NativeDialog::FileDialog::SELECT_FILE);
+                mask_dialog.setAllowsMultipleSelection(false)
+                           .setDecideHandler([&mask_path](const NativeDialog::Dialog& dialog) {
+                                auto& fdlg = dynamic_cast<const NativeDialog::FileDialog&>(dialog);
+                                mask_path = fdlg.selectedPathes().front();
+                           }).show();
+
+                if(!mask_path) return;
+
+                if(use_density_map) {
+                    NativeDialog::FileDialog density_dialog(gettext("Select Density Map..."),
+                                                            NativeDialog::FileDialog::SELECT_FILE);
+                    density_dialog.setAllowsMultipleSelection(false)
+                                  .setDecideHandler([&density_path](const NativeDialog::Dialog& dialog) {
+                                        auto& fdlg = dynamic_cast<const NativeDialog::FileDialog&>(dialog);
+                                        density_path = fdlg.selectedPathes().front();
+                                  }).show();
+
+                    if(density_path.empty()) return;
+                }
+
+                auto res = project.generateProvinces(*mask_path, density_path,
+                                                     options);
+                WRITE_IF_ERROR(res);
+
+                // Point the drawing area and file tree at the new data, even
+                //   if generating failed part of the way through
+                m_drawing_area->setSelection();
+                m_drawing_area->setMapData(project.getMapProject().getMapData());
+                m_drawing_area->queueDraw();
+
+                auto result = MainWindowFileTreePart::onProjectOpened();
+                WRITE_IF_ERROR(result);
+
+                if(IS_SUCCESS(res)) {
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully generated provinces.")
+                       << "</b>\n\n"
+                       << gettext("Number of provinces: ")
+                       << project.getMapProject().getProvinceProject().getProvinces().size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                } else {
+                    Gtk::MessageDialog dialog(*this,
+                            gettext("Failed to generate provinces. See the log for details."),
+                            false, Gtk::MESSAGE_ERROR);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to generate provinces.");
+            }
+        });
+        generate_provinces_action->set_enabled(false);
+    }
+
+    {
+        auto split_oversized_provinces_action = add_action("split_oversized_provinces",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& map_project = opt_project->get().getMapProject();
+
+                auto edit = map_project.getProvinceProject().splitOversizedProvinces();
+                WRITE_IF_ERROR(edit);
+
+                if(IS_SUCCESS(edit)) {
+                    // The provinces layer changed, so everything drawn from
+                    //   it has to be rebuilt
+                    m_drawing_area->setSelection();
+                    m_drawing_area->setMapData(map_project.getMapData());
+                    m_drawing_area->queueDraw();
+
+                    auto result = MainWindowFileTreePart::onProjectOpened();
+                    WRITE_IF_ERROR(result);
+
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully split oversized provinces.")
+                       << "</b>\n\n"
+                       << gettext("Number of new provinces: ")
+                       << edit->new_provinces.size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to split oversized provinces.");
+            }
+        });
+        split_oversized_provinces_action->set_enabled(false);
+    }
+
+    {
+        auto absorb_tiny_provinces_action = add_action("absorb_tiny_provinces",
+        [this]()
+        {
+            if(auto opt_project = Driver::getInstance().getProject(); opt_project)
+            {
+                auto& map_project = opt_project->get().getMapProject();
+
+                auto absorbed = map_project.getProvinceProject().absorbTinyProvinces();
+                WRITE_IF_ERROR(absorbed);
+
+                if(IS_SUCCESS(absorbed)) {
+                    // The provinces layer changed, so everything drawn from
+                    //   it has to be rebuilt
+                    m_drawing_area->setSelection();
+                    m_drawing_area->setMapData(map_project.getMapData());
+                    m_drawing_area->queueDraw();
+
+                    auto result = MainWindowFileTreePart::onProjectOpened();
+                    WRITE_IF_ERROR(result);
+
+                    std::stringstream ss;
+                    ss << "<b>"
+                       << gettext("Successfully absorbed tiny provinces.")
+                       << "</b>\n\n"
+                       << gettext("Number of provinces absorbed: ")
+                       << absorbed->size();
+                    Gtk::MessageDialog dialog(*this, ss.str(), true,
+                                              Gtk::MESSAGE_INFO);
+                    dialog.run();
+                }
+            } else {
+                WRITE_ERROR("No project is loaded, unable to absorb tiny provinces.");
+            }
+        });
+        absorb_tiny_provinces_action->set_enabled(false);
+    }
+
+    {
+        auto watch_inputs_action = add_action_bool("watch_inputs", [this]() {
+            auto self = lookupAction<Gio::SimpleAction>("watch_inputs");
+            bool state;
+            self->get_state<bool>(state);
+
+            if(state) {
+                WRITE_INFO("No longer watching input files for changes.");
+                stopWatchingInputs();
+            } else {
+                WRITE_INFO("Watching input files for changes.");
+                startWatchingInputs();
+            }
+
+            self->change_state(!state);
+        });
+        watch_inputs_action->change_state(false);
+        watch_inputs_action->set_enabled(false);
+    }
 }
 
 /**
@@ -688,18 +1464,34 @@ void HMDT::GUI::MainWindow::initializeCallbacks() {
             getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
             getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
         });
-        Action::ActionManager::getInstance().setOnUndoActionCallback([this](const auto&...)
+        Action::ActionManager::getInstance().setOnUndoActionCallback([this](const auto& action)
         {
             m_toolbar->updateUndoRedoButtons();
 
+            if(dynamic_cast<const Action::PaintProvinceAction*>(&action) != nullptr)
+            {
+                onProvincesRepainted(true);
+            } else if(dynamic_cast<const Action::SculptHeightMapAction*>(&action) != nullptr)
+            {
+                onHeightMapSculpted();
+            }
+
             // Update each properties pane that an action has been undone
             getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
             getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
         });
-        Action::ActionManager::getInstance().setOnRedoActionCallback([this](const auto&...)
+        Action::ActionManager::getInstance().setOnRedoActionCallback([this](const auto& action)
         {
             m_toolbar->updateUndoRedoButtons();
 
+            if(dynamic_cast<const Action::PaintProvinceAction*>(&action) != nullptr)
+            {
+                onProvincesRepainted(true);
+            } else if(dynamic_cast<const Action::SculptHeightMapAction*>(&action) != nullptr)
+            {
+                onHeightMapSculpted();
+            }
+
             // Update each properties pane that an action has been redone
             getProvincePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedProvinceCount() > 1);
             getStatePropertiesPane().updateProperties(SelectionManager::getInstance().getSelectedStateCount() > 1);
@@ -707,6 +1499,14 @@ void HMDT::GUI::MainWindow::initializeCallbacks() {
 
     }
 
+    // Drawing area callbacks
+    {
+        m_drawing_area->setOnStrokeCallback([this](const std::vector<Point2D>& pixels)
+        {
+            onBrushStroke(pixels);
+        });
+    }
+
     // File Tree callbacks
     {
         setOnNodeDoubleClickCallback([this](Project::Hierarchy::INodePtr node,
@@ -925,7 +1725,22 @@ void HMDT::GUI::MainWindow::onProjectOpened() {
     getAction("export_project")->set_enabled(true);
     getAction("export_project_as")->set_enabled(true);
     getAction("generate_template_rivers")->set_enabled(true);
+    getAction("generate_rivers")->set_enabled(true);
+    getAction("validate_rivers")->set_enabled(true);
+    getAction("generate_strategic_regions")->set_enabled(true);
+    getAction("generate_states")->set_enabled(true);
+    getAction("load_terrain_map")->set_enabled(true);
+    getAction("assign_terrain")->set_enabled(true);
+    getAction("export_map_image")->set_enabled(true);
+    getAction("import_mod")->set_enabled(true);
+    getAction("generate_provinces")->set_enabled(true);
+    getAction("split_oversized_provinces")->set_enabled(true);
+    getAction("absorb_tiny_provinces")->set_enabled(true);
+    getAction("watch_inputs")->set_enabled(true);
     getAction("add_item")->set_enabled(true);
+    for(auto&& brush : BRUSH_ACTIONS) {
+        getAction(brush.name)->set_enabled(true);
+    }
 
     // Issue callback to the properties pane to inform it that a project has
     //   been opened
@@ -956,8 +1771,36 @@ void HMDT::GUI::MainWindow::onProjectClosed() {
     getAction("export_project")->set_enabled(false);
     getAction("export_project_as")->set_enabled(false);
     getAction("generate_template_rivers")->set_enabled(false);
+    getAction("generate_rivers")->set_enabled(false);
+    getAction("validate_rivers")->set_enabled(false);
+    getAction("generate_strategic_regions")->set_enabled(false);
+    getAction("generate_states")->set_enabled(false);
+    getAction("load_terrain_map")->set_enabled(false);
+    getAction("assign_terrain")->set_enabled(false);
+    getAction("export_map_image")->set_enabled(false);
+    getAction("import_mod")->set_enabled(false);
+    getAction("generate_provinces")->set_enabled(false);
+    getAction("split_oversized_provinces")->set_enabled(false);
+    getAction("absorb_tiny_provinces")->set_enabled(false);
     getAction("add_item")->set_enabled(false);
 
+    // The watched inputs all belonged to the project which was just closed
+    {
+        stopWatchingInputs();
+
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        m_watched_inputs.clear();
+    }
+    lookupAction<Gio::SimpleAction>("watch_inputs")->change_state(false);
+    getAction("watch_inputs")->set_enabled(false);
+
+    // There is nothing left to paint or sculpt, so go back to selecting
+    m_drawing_area->setTool(IMapDrawingAreaBase::Tool::SELECT);
+    for(auto&& brush : BRUSH_ACTIONS) {
+        lookupAction<Gio::SimpleAction>(brush.name)->change_state(false);
+        getAction(brush.name)->set_enabled(false);
+    }
+
     {
         ProvincePreviewDrawingArea::DataPtr null_data; // Do not construct
         getProvincePropertiesPane().setProvince(nullptr, null_data);
@@ -967,6 +1810,279 @@ void HMDT::GUI::MainWindow::onProjectClosed() {
     }
 }
 
+/**
+ * @brief Called when a brush stroke on the map ends, or when the fill or lasso
+ *        tool picks an area. Sculpts the heightmap under the stroke if a
+ *        sculpting brush is on, and otherwise paints every picked pixel into
+ *        the selected province.
+ *
+ * @param pixels Every pixel that the brush passed over
+ */
+void HMDT::GUI::MainWindow::onBrushStroke(const std::vector<Point2D>& pixels) {
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project || pixels.empty()) {
+        return;
+    }
+
+    auto& map_project = opt_project->get().getMapProject();
+
+    if(m_sculpt_mode) {
+        auto action = new Action::SculptHeightMapAction(map_project,
+                                                        *m_sculpt_mode,
+                                                        pixels,
+                                                        DEFAULT_SCULPT_STRENGTH);
+
+        // Go through the ActionManager so that this can be undone
+        if(!Action::ActionManager::getInstance().doAction(action)) {
+            WRITE_ERROR("Failed to sculpt the heightmap.");
+            return;
+        }
+
+        onHeightMapSculpted();
+        return;
+    }
+
+    const auto& selected = SelectionManager::getInstance().getSelectedProvinceLabels();
+    if(selected.size() != 1) {
+        WRITE_WARN("Select exactly one province to paint with, ",
+                   selected.size(), " are selected.");
+        return;
+    }
+
+    auto action = new Action::PaintProvinceAction(map_project, *selected.begin(),
+                                                  pixels);
+
+    // Go through the ActionManager so that this can be undone
+    if(!Action::ActionManager::getInstance().doAction(action)) {
+        WRITE_ERROR("Failed to paint province ", *selected.begin());
+        return;
+    }
+
+    // Only rebuild the file tree if provinces were created or removed, as it
+    //   is far too slow to do on every stroke
+    bool provinces_changed = false;
+    if(const auto& edit = action->getEdit(); edit) {
+        provinces_changed = !edit->new_provinces.empty() ||
+            std::any_of(edit->old_provinces.begin(), edit->old_provinces.end(),
+                        [&map_project](const Province& province) {
+                            return !map_project.getProvinceProject().isValidProvinceID(province.id);
+                        });
+    }
+
+    onProvincesRepainted(provinces_changed);
+}
+
+/**
+ * @brief Updates everything drawn from the provinces layer after it has been
+ *        painted on.
+ *
+ * @param provinces_changed Whether provinces may have been created or removed
+ */
+void HMDT::GUI::MainWindow::onProvincesRepainted(bool provinces_changed) {
+    m_drawing_area->refreshMapData();
+
+    if(provinces_changed) {
+        auto result = MainWindowFileTreePart::onProjectOpened();
+        WRITE_IF_ERROR(result);
+    }
+}
+
+/**
+ * @brief Brings the normals up to date after the heightmap has been sculpted.
+ * @details Only the tiles touched since the last update get regenerated, and
+ *          only those tiles are re-uploaded to the drawing area.
+ */
+void HMDT::GUI::MainWindow::onHeightMapSculpted() {
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) {
+        return;
+    }
+
+    auto regions = opt_project->get().getMapProject().getHeightMapProject().updateNormalMap();
+    WRITE_IF_ERROR(regions);
+
+    if(IS_SUCCESS(regions)) {
+        WRITE_DEBUG("Regenerated the normals of ", regions->size(), " regions.");
+
+        // Only the regions which were sculpted need to be sent to the
+        //   renderer again
+        m_drawing_area->refreshHeightMap(*regions);
+    }
+}
+
+/**
+ * @brief Remembers an input file, so that it gets reloaded whenever it changes
+ *        while input files are being watched.
+ *
+ * @param path The file the layer was loaded from
+ * @param layer Which layer the file was loaded into
+ * @param allow_conversion Whether the user agreed to convert the file
+ */
+void HMDT::GUI::MainWindow::addWatchedInput(const std::filesystem::path& path,
+                                            WatchedLayer layer,
+                                            bool allow_conversion)
+{
+    auto file = std::filesystem::absolute(path).lexically_normal();
+
+    {
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        m_watched_inputs[file] = WatchedInput{ layer, allow_conversion };
+    }
+
+    if(m_input_watcher != nullptr) {
+        auto res = m_input_watcher->watch(file);
+        WRITE_IF_ERROR(res);
+    }
+}
+
+/**
+ * @brief Starts watching every input file, reloading each one in the
+ *        background when it changes.
+ */
+void HMDT::GUI::MainWindow::startWatchingInputs() {
+    if(m_input_watcher != nullptr) {
+        return;
+    }
+
+    auto maybe_id = setupDispatcher([this]() {
+        commitReloadedInputs();
+    });
+    if(IS_FAILURE(maybe_id)) {
+        WRITE_ERROR("Failed to set up the dispatcher for reloading input files.");
+        return;
+    }
+    m_reload_dispatcher_id = *maybe_id;
+
+    m_input_watcher.reset(new FileWatcher);
+
+    {
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        for(auto&& [path, input] : m_watched_inputs) {
+            auto res = m_input_watcher->watch(path);
+            WRITE_IF_ERROR(res);
+        }
+    }
+
+    auto res = m_input_watcher->start([this](const std::filesystem::path& path) {
+        reloadWatchedInput(path);
+    });
+    WRITE_IF_ERROR(res);
+}
+
+/**
+ * @brief Stops watching the input files.
+ */
+void HMDT::GUI::MainWindow::stopWatchingInputs() {
+    if(m_input_watcher == nullptr) {
+        return;
+    }
+
+    // Stops the watcher thread before anything else goes away
+    m_input_watcher.reset();
+
+    auto res = teardownDispatcher(m_reload_dispatcher_id);
+    WRITE_IF_ERROR(res);
+
+    std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+    m_reloaded_inputs.clear();
+}
+
+/**
+ * @brief Reads an input file which changed. Runs on the watcher thread.
+ * @details Only the file gets read here, it is handed off to the project by
+ *          commitReloadedInputs back on the main thread.
+ *
+ * @param path The input file which changed
+ */
+void HMDT::GUI::MainWindow::reloadWatchedInput(const std::filesystem::path& path)
+{
+    WatchedInput input;
+    {
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        auto it = m_watched_inputs.find(path);
+        if(it == m_watched_inputs.end()) {
+            return;
+        }
+
+        input = it->second;
+    }
+
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) {
+        return;
+    }
+    auto& map_project = opt_project->get().getMapProject();
+
+    WRITE_INFO("Reloading ", path);
+
+    Project::LayerLoadProgress progress;
+    Maybe<std::shared_ptr<BitMap2>> bitmap;
+    switch(input.layer) {
+        case WatchedLayer::HEIGHTMAP:
+            bitmap = map_project.getHeightMapProject().readFile(path,
+                                                                input.allow_conversion,
+                                                                progress);
+            break;
+        case WatchedLayer::RIVERS:
+            bitmap = map_project.getRiversProject().prepareFile(path, progress);
+            break;
+    }
+
+    if(IS_FAILURE(bitmap)) {
+        WRITE_ERROR("Failed to reload ", path, ": ", bitmap.error().message());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        m_reloaded_inputs.push_back(ReloadedInput{ input.layer, *bitmap });
+    }
+
+    auto res = notifyDispatcher(m_reload_dispatcher_id);
+    WRITE_IF_ERROR(res);
+}
+
+/**
+ * @brief Hands every reloaded layer off to the project, only updating the
+ *        tiles which actually changed.
+ */
+void HMDT::GUI::MainWindow::commitReloadedInputs() {
+    std::vector<ReloadedInput> reloaded;
+    {
+        std::lock_guard<std::mutex> lock(m_watched_inputs_mutex);
+        std::swap(reloaded, m_reloaded_inputs);
+    }
+
+    auto opt_project = Driver::getInstance().getProject();
+    if(!opt_project) {
+        return;
+    }
+    auto& map_project = opt_project->get().getMapProject();
+
+    for(auto&& [layer, bitmap] : reloaded) {
+        Maybe<std::vector<Rectangle>> changed;
+        switch(layer) {
+            case WatchedLayer::HEIGHTMAP:
+                changed = map_project.getHeightMapProject().commitChangedTiles(bitmap);
+                break;
+            case WatchedLayer::RIVERS:
+                changed = map_project.getRiversProject().commitChangedTiles(bitmap);
+                break;
+        }
+
+        WRITE_IF_ERROR(changed);
+        if(IS_SUCCESS(changed)) {
+            WRITE_INFO("Reloaded ", changed->size(), " changed tiles.");
+
+            if(layer == WatchedLayer::HEIGHTMAP) {
+                m_drawing_area->refreshHeightMap(*changed);
+            }
+        }
+    }
+
+    m_drawing_area->queueDraw();
+}
+
 /**
  * @brief Saves the currently set Driver project (if one is in fact set)
  */
@@ -3,6 +3,9 @@
 
 #include <libintl.h>
 
+#include <iomanip>
+#include <sstream>
+
 #include "gtkmm/messagedialog.h"
 #include "gtkmm/label.h"
 #include "gtkmm/frame.h"
@@ -58,9 +61,15 @@ void HMDT::GUI::ProvincePropertiesPane::init() {
     buildContinentField();
     addWidget<Gtk::Label>("");
 
+    buildStatisticsField();
+    addWidget<Gtk::Label>("");
+
     buildStateCreationButton();
     addWidget<Gtk::Label>("");
 
+    buildStrategicRegionCreationButton();
+    addWidget<Gtk::Label>("");
+
     buildMergeProvincesButton();
     addWidget<Gtk::Label>("");
 
@@ -185,6 +194,14 @@ void HMDT::GUI::ProvincePropertiesPane::buildTerrainTypeField() {
     });
 }
 
+void HMDT::GUI::ProvincePropertiesPane::buildStatisticsField() {
+    addWidget<Gtk::Label>(gettext("Statistics"));
+
+    m_statistics_label = addWidget<Gtk::Label>("");
+    m_statistics_label->set_xalign(0);
+    m_statistics_label->set_selectable(true);
+}
+
 void HMDT::GUI::ProvincePropertiesPane::buildContinentField() {
     addWidget<Gtk::Label>(gettext("Continent"));
 
@@ -370,6 +387,26 @@ void HMDT::GUI::ProvincePropertiesPane::buildStateCreationButton() {
     });
 }
 
+/**
+ * @brief Creates the button to make a new strategic region out of every
+ *        selected province
+ */
+void HMDT::GUI::ProvincePropertiesPane::buildStrategicRegionCreationButton() {
+    m_create_strategic_region_button = addWidget<Gtk::Button>(gettext("Create Strategic Region"));
+
+    m_create_strategic_region_button->signal_clicked().connect([]() {
+        if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
+            auto& region_project = opt_project->get().getMapProject().getStrategicRegionProject();
+
+            auto selected = SelectionManager::getInstance().getSelectedProvinceLabels();
+            auto id = region_project.addNewStrategicRegion(std::vector<ProvinceID>(selected.begin(),
+                                                                                   selected.end()));
+
+            WRITE_INFO("Created strategic region ", id, " out of ",
+                       selected.size(), " provinces.");
+        }
+    });
+}
 
 /**
  * @brief Creates the button to merge two or more provinces together
@@ -496,6 +533,48 @@ void HMDT::GUI::ProvincePropertiesPane::updateMergedListElements(const Province*
     }
 }
 
+/**
+ * @brief Updates the statistics shown for a new province
+ * @details The statistics are only computed again if a layer they depend on
+ *          changed since they were last shown.
+ *
+ * @param prov The province to update with, or nullptr to clear them
+ */
+void HMDT::GUI::ProvincePropertiesPane::updateStatistics(const Province* prov)
+{
+    if(prov == nullptr) {
+        m_statistics_label->set_text("");
+        return;
+    }
+
+    if(auto opt_project = Driver::getInstance().getProject(); opt_project) {
+        auto& map_project = opt_project->get().getMapProject();
+
+        auto statistics = map_project.getProvinceStatistics(prov->id);
+        if(IS_FAILURE(statistics)) {
+            m_statistics_label->set_text("");
+            return;
+        }
+
+        const auto& provinces = map_project.getProvinceProject().getProvinces();
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2)
+           << gettext("Area: ") << statistics->pixel_count << std::endl
+           << gettext("Perimeter: ") << statistics->perimeter << std::endl
+           << gettext("Coastline: ")
+                << getCoastlineLength(*statistics, *prov, provinces) << std::endl
+           << gettext("Height: ") << +statistics->min_height << " - "
+                                  << +statistics->max_height
+                                  << " (" << statistics->mean_height << ')'
+                                  << std::endl
+           << gettext("Mean Slope: ") << statistics->mean_slope << std::endl
+           << gettext("River Pixels: ") << statistics->river_pixel_count;
+
+        m_statistics_label->set_text(ss.str());
+    }
+}
+
 void HMDT::GUI::ProvincePropertiesPane::addWidgetToParent(Gtk::Widget& widget) {
     m_box.add(widget);
 }
@@ -512,6 +591,7 @@ void HMDT::GUI::ProvincePropertiesPane::setEnabled(bool enabled) {
     m_continent_menu->set_sensitive(enabled);
 
     m_create_state_button->set_sensitive(enabled);
+    m_create_strategic_region_button->set_sensitive(enabled);
 }
 
 void HMDT::GUI::ProvincePropertiesPane::setProvince(Province* prov,
@@ -527,6 +607,7 @@ void HMDT::GUI::ProvincePropertiesPane::setProvince(Province* prov,
     // Set this to be enabled afterwards without worrying about multiselect
     if(is_multiselect) {
         m_create_state_button->set_sensitive(m_province != nullptr);
+        m_create_strategic_region_button->set_sensitive(m_province != nullptr);
     }
 
     updateProperties(prov, is_multiselect);
@@ -584,6 +665,7 @@ void HMDT::GUI::ProvincePropertiesPane::updateProperties(const Province* prov,
     m_merge_provinces_button->set_sensitive(prov != nullptr && is_multiselect);
 
     updateMergedListElements(prov);
+    updateStatistics(is_multiselect ? nullptr : prov);
 
     m_is_updating_properties = false;
 }
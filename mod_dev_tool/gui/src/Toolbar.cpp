@@ -108,6 +108,9 @@ void HMDT::GUI::Toolbar::init() {
                     newMode = IMapDrawingAreaBase::ViewingMode::STATES_VIEW;
                     break;
                 case IMapDrawingAreaBase::ViewingMode::STATES_VIEW:
+                    newMode = IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW;
+                    break;
+                case IMapDrawingAreaBase::ViewingMode::TERRAIN_VIEW:
                     newMode = IMapDrawingAreaBase::ViewingMode::PROVINCE_VIEW;
                     break;
                 // No default case here because we want compiler errors if we
@@ -16,6 +16,8 @@ namespace HMDT::Project::Hierarchy {
         static constexpr const char* HEIGHT_MAP = HMDT_LOCALIZE("HeightMap");
         static constexpr const char* HISTORY = HMDT_LOCALIZE("History");
         static constexpr const char* RIVERS = HMDT_LOCALIZE("Rivers");
+        static constexpr const char* TERRAIN = HMDT_LOCALIZE("Terrain");
+        static constexpr const char* STRATEGIC_REGIONS = HMDT_LOCALIZE("StrategicRegions");
     };
 
     /**
@@ -25,6 +27,7 @@ namespace HMDT::Project::Hierarchy {
         static constexpr const char* PROVINCES = HMDT_LOCALIZE("Provinces");
         static constexpr const char* STATES = HMDT_LOCALIZE("States");
         static constexpr const char* CONTINENTS = HMDT_LOCALIZE("Continents");
+        static constexpr const char* STRATEGIC_REGIONS = HMDT_LOCALIZE("StrategicRegions");
     };
 
     /**
@@ -1,6 +1,9 @@
 #ifndef HEIGHTMAP_PROJECT_H
 # define HEIGHTMAP_PROJECT_H
 
+# include <set>
+# include <vector>
+
 # include "BitMap.h"
 
 # include "IProject.h"
@@ -34,15 +37,36 @@ namespace HMDT::Project {
 
             virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept override;
 
+            virtual Maybe<uint16_t> checkFile(const std::filesystem::path&) const noexcept override;
+            virtual Maybe<PendingHeightMap> prepareFile(const std::filesystem::path&, bool, LayerLoadProgress&) const noexcept override;
+            virtual MaybeVoid commitFile(PendingHeightMap&&) noexcept override;
+
+            virtual Maybe<std::shared_ptr<BitMap2>> readFile(const std::filesystem::path&, bool, LayerLoadProgress&) const noexcept override;
+            virtual Maybe<std::vector<Rectangle>> commitChangedTiles(std::shared_ptr<BitMap2>) noexcept override;
+            virtual Maybe<std::vector<Rectangle>> reloadFile(const std::filesystem::path&, bool) noexcept override;
+
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
+            virtual Maybe<HeightMapEdit> sculpt(SculptMode, const std::vector<Point2D>&, uint8_t) noexcept override;
+            virtual MaybeVoid revertHeightMapEdit(const HeightMapEdit&) noexcept override;
+            virtual Maybe<std::vector<Rectangle>> updateNormalMap() noexcept override;
+
             MonadOptionalRef<const BitMap2> getBitMap() const;
 
+            std::vector<Rectangle> getDirtyRegions() const;
+            MaybeVoid regenerateNormalMap() noexcept;
+
+        protected:
+            void setHeight(uint64_t, uint8_t);
+
         private:
             //! The parent project
             IRootMapProject& m_parent_project;
 
             std::shared_ptr<BitMap2> m_heightmap_bmp;
+
+            //! Every HEIGHTMAP_TILE_SIZE tile whose normals are out of date
+            std::set<uint32_t> m_dirty_tiles;
     };
 }
 
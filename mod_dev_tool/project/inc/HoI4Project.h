@@ -6,6 +6,9 @@
 # include <filesystem>
 
 # include "Version.h"
+# include "MapRenderer.h"
+# include "ProjectDiff.h"
+# include "VectorBorders.h"
 
 # include "IProject.h"
 # include "MapProject.h"
@@ -56,6 +59,7 @@ namespace HMDT::Project {
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
             MaybeVoid load();
+            MaybeVoid loadForDiff(const std::filesystem::path&);
             MaybeVoid save(bool = true);
             MaybeVoid export_() const noexcept;
 
@@ -65,6 +69,18 @@ namespace HMDT::Project {
             void setPathAndName(const std::filesystem::path&);
 
             void importFile(const std::filesystem::path&);
+            MaybeVoid importMod(const std::filesystem::path&) noexcept;
+            MaybeVoid generateProvinces(const std::filesystem::path&,
+                                        const std::filesystem::path&,
+                                        const ProvinceGeneratorOptions&) noexcept;
+
+            Maybe<RenderedMap> renderMap(MapMode, const MapRenderOptions&) const noexcept;
+
+            Maybe<ProjectDiff> diff(const HoI4Project&) const noexcept;
+            Maybe<RenderedMap> renderDiff(const HoI4Project&,
+                                          const ProjectDiff&) const noexcept;
+
+            Maybe<std::vector<BorderLayer>> extractBorders(double) const noexcept;
 
             void setToolVersion(const Version&);
             void setHoI4Version(const Version&);
@@ -74,9 +90,12 @@ namespace HMDT::Project {
 
             virtual MaybeVoid save(const std::filesystem::path&) override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
+            MaybeVoid loadProjectFile(const std::filesystem::path&);
 
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
 
+            Maybe<ProjectDiffLayers> getDiffLayers() const noexcept;
+
         private:
             //! The path to the project file (The .hoi4proj file)
             std::filesystem::path m_path;
@@ -107,6 +126,10 @@ namespace HMDT::Project {
 
             //! The path to export into.
             std::filesystem::path m_export_root;
+
+            //! Whether the per-pixel layers are streamed from the saved files
+            //!   when diffing, as they were never loaded
+            bool m_stream_diff_layers;
     };
 
     using Project = HoI4Project;
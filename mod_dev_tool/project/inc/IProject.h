@@ -7,6 +7,7 @@
 # include <set>
 # include <map>
 # include <string>
+# include <vector>
 
 # include "fifo_map.hpp"
 
@@ -15,13 +16,22 @@
 # include "Version.h"
 
 # include "Terrain.h"
+# include "StraitFinder.h"
+# include "LabelPointFinder.h"
+# include "RiverValidator.h"
+# include "SupplyNetworkBuilder.h"
+# include "TerrainVoter.h"
+# include "ZonalStatistics.h"
 
 # include "INode.h"
 
+# include "LayerLoadProgress.h"
+
 // Forward declarations
 namespace HMDT {
     class MapData;
     class ShapeFinder;
+    struct BitMap2;
 }
 
 namespace HMDT::Project {
@@ -110,6 +120,39 @@ namespace HMDT::Project {
     struct IProvinceProject: public IMapProject {
         using ProvinceDataPtr = std::shared_ptr<unsigned char[]>;
 
+        /**
+         * @brief Records everything changed by a single edit of the provinces
+         *        layer, so that the edit can be reverted later.
+         */
+        struct ProvinceEdit {
+            //! Every pixel index whose province changed, and its old province
+            std::vector<std::pair<uint64_t, ProvinceID>> old_pixels;
+
+            //! Every province which was modified or removed, before the edit
+            std::vector<Province> old_provinces;
+
+            //! Every province which was created by the edit
+            std::vector<ProvinceID> new_provinces;
+
+            //! The provinces of every modified state, before the edit
+            std::map<StateID, std::vector<ProvinceID>> old_state_provinces;
+        };
+
+        /**
+         * @brief A province which was too small, and was absorbed into one of
+         *        its neighbors
+         */
+        struct AbsorbedProvince {
+            //! The province which was absorbed. It no longer exists.
+            ProvinceID id;
+
+            //! The province which now has all of its pixels
+            ProvinceID into;
+
+            //! How many pixels the absorbed province had
+            uint64_t pixel_count;
+        };
+
         bool isValidProvinceLabel(uint32_t) const;
         bool isValidProvinceID(ProvinceID) const;
 
@@ -138,15 +181,66 @@ namespace HMDT::Project {
         virtual MaybeVoid unmergeProvince(const ProvinceID&) noexcept;
 
         virtual std::set<ProvinceID> getMergedProvinces(const ProvinceID&) const noexcept;
+
+        virtual Maybe<ProvinceEdit> paintProvince(const ProvinceID&, const std::vector<Point2D>&) noexcept = 0;
+        virtual MaybeVoid revertProvinceEdit(const ProvinceEdit&) noexcept = 0;
+
+        virtual Maybe<ProvinceEdit> splitProvince(const ProvinceID&, uint32_t) noexcept = 0;
+        virtual Maybe<ProvinceEdit> splitOversizedProvinces() noexcept = 0;
+
+        virtual Maybe<std::vector<AbsorbedProvince>> absorbTinyProvinces() noexcept = 0;
     };
 
     /**
      * @brief The interface for the HeightMapProject
      */
     struct IHeightMapProject: public IMapProject {
+        /**
+         * @brief The different ways a sculpting brush can modify the heightmap
+         */
+        enum class SculptMode {
+            RAISE, //!< Adds the brush strength to every pixel
+            LOWER, //!< Subtracts the brush strength from every pixel
+            SMOOTH, //!< Blends every pixel towards the average of its neighbors
+            FLATTEN //!< Blends every pixel towards the average under the brush
+        };
+
+        /**
+         * @brief Records everything changed by a single sculpting stroke, so
+         *        that the stroke can be reverted later.
+         */
+        struct HeightMapEdit {
+            //! Every pixel index whose height changed, and its old height
+            std::vector<std::pair<uint64_t, uint8_t>> old_heights;
+        };
+
+        /**
+         * @brief A heightmap which has been fully loaded and processed, but
+         *        which has not been handed off to the project yet.
+         */
+        struct PendingHeightMap {
+            //! The heightmap, already converted to 8-bit greyscale
+            std::shared_ptr<BitMap2> bitmap;
+
+            //! The world normals generated from the heightmap
+            std::shared_ptr<uint8_t[]> normal_map;
+        };
+
         virtual ~IHeightMapProject() = default;
 
         virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept = 0;
+
+        virtual Maybe<uint16_t> checkFile(const std::filesystem::path&) const noexcept = 0;
+        virtual Maybe<PendingHeightMap> prepareFile(const std::filesystem::path&, bool, LayerLoadProgress&) const noexcept = 0;
+        virtual MaybeVoid commitFile(PendingHeightMap&&) noexcept = 0;
+
+        virtual Maybe<std::shared_ptr<BitMap2>> readFile(const std::filesystem::path&, bool, LayerLoadProgress&) const noexcept = 0;
+        virtual Maybe<std::vector<Rectangle>> commitChangedTiles(std::shared_ptr<BitMap2>) noexcept = 0;
+        virtual Maybe<std::vector<Rectangle>> reloadFile(const std::filesystem::path&, bool) noexcept = 0;
+
+        virtual Maybe<HeightMapEdit> sculpt(SculptMode, const std::vector<Point2D>&, uint8_t) noexcept = 0;
+        virtual MaybeVoid revertHeightMapEdit(const HeightMapEdit&) noexcept = 0;
+        virtual Maybe<std::vector<Rectangle>> updateNormalMap() noexcept = 0;
     };
 
     /**
@@ -171,7 +265,70 @@ namespace HMDT::Project {
         virtual ~IRiversProject() = default;
 
         virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept = 0;
+
+        virtual Maybe<uint16_t> checkFile(const std::filesystem::path&) const noexcept = 0;
+        virtual Maybe<std::shared_ptr<BitMap2>> prepareFile(const std::filesystem::path&, LayerLoadProgress&) const noexcept = 0;
+        virtual MaybeVoid commitFile(std::shared_ptr<BitMap2>) noexcept = 0;
+
+        virtual Maybe<std::vector<Rectangle>> commitChangedTiles(std::shared_ptr<BitMap2>) noexcept = 0;
+        virtual Maybe<std::vector<Rectangle>> reloadFile(const std::filesystem::path&) noexcept = 0;
         virtual MaybeVoid writeTemplate(const std::filesystem::path&) const noexcept = 0;
+
+        virtual MaybeVoid generateRivers(uint32_t) noexcept = 0;
+        virtual Maybe<std::vector<RiverIssue>> validateRivers() const noexcept = 0;
+    };
+
+    /**
+     * @brief The interface for the TerrainProject
+     */
+    struct ITerrainProject: public IMapProject {
+        /**
+         * @brief A change to the terrain of a single province
+         */
+        struct TerrainChange {
+            ProvinceID id; //!< The province which was changed
+            TerrainID old_terrain; //!< The terrain before the change
+            TerrainID new_terrain; //!< The terrain after the change
+        };
+
+        virtual ~ITerrainProject() = default;
+
+        virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept = 0;
+        virtual bool hasTerrainMap() const noexcept = 0;
+
+        virtual std::vector<TerrainID> getIndexTerrains() const noexcept = 0;
+        virtual Color getTerrainColor(const TerrainID&) const noexcept = 0;
+
+        virtual Maybe<std::vector<TerrainChange>> calculateProvinceTerrains(const TerrainVoteOptions&) const noexcept = 0;
+        virtual MaybeVoid applyTerrainChanges(const std::vector<TerrainChange>&, bool = false) noexcept = 0;
+
+        virtual uint32_t getProvinceTerrainsUpdatedTag() const noexcept = 0;
+    };
+
+    /**
+     * @brief The interface for the StrategicRegionProject
+     */
+    struct IStrategicRegionProject: public IMapProject {
+        using StrategicRegionMap = std::map<StrategicRegionID, StrategicRegion>;
+
+        virtual ~IStrategicRegionProject() = default;
+
+        bool isValidStrategicRegionID(StrategicRegionID) const;
+
+        MaybeRef<const StrategicRegion> getStrategicRegionForID(StrategicRegionID) const;
+
+        virtual const StrategicRegionMap& getStrategicRegions() const noexcept = 0;
+
+        virtual MaybeRef<const StrategicRegion> getStrategicRegionForProvince(ProvinceID) const noexcept = 0;
+
+        virtual StrategicRegionID addNewStrategicRegion(const std::vector<ProvinceID>&) noexcept = 0;
+        virtual MaybeVoid removeStrategicRegion(StrategicRegionID) noexcept = 0;
+
+        virtual MaybeVoid moveProvinceToStrategicRegion(ProvinceID, StrategicRegionID) noexcept = 0;
+        virtual MaybeVoid setStrategicRegionName(StrategicRegionID, const std::string&) noexcept = 0;
+
+        virtual MaybeVoid generateStrategicRegions(uint32_t) noexcept = 0;
+        virtual MaybeVoid generateStrategicRegionsOfSize(uint64_t) noexcept = 0;
     };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -207,10 +364,14 @@ namespace HMDT::Project {
         virtual const State& getStateForIterator(StateMap::const_iterator) const = 0;
 
         virtual void updateStateIDMatrix() = 0;
+        virtual void updateStateIDMatrix(const std::vector<ProvinceID>&) = 0;
 
         virtual MaybeVoid addProvinceToState(StateID, ProvinceID) = 0;
         virtual MaybeVoid removeProvinceFromState(StateID, ProvinceID) = 0;
 
+        virtual MaybeVoid generateStates(uint32_t, uint64_t) noexcept = 0;
+        virtual MaybeVoid generateStatesOfSize(uint64_t, uint64_t) noexcept = 0;
+
         protected:
             virtual StateMap& getStateMap() = 0;
     };
@@ -233,6 +394,22 @@ namespace HMDT::Project {
 
         virtual void calculateCoastalProvinces(bool = false) = 0;
 
+        virtual Maybe<std::vector<Strait>> findStraits() const noexcept = 0;
+
+        virtual uint32_t getMaxStraitWidth() const noexcept = 0;
+        virtual void setMaxStraitWidth(uint32_t) noexcept = 0;
+
+        virtual Maybe<SupplyNetwork> buildSupplyNetwork() const noexcept = 0;
+
+        virtual Maybe<LabelPointMap> findLabelPoints() const noexcept = 0;
+
+        virtual Maybe<ProvinceStatistics> getProvinceStatistics(const ProvinceID&) noexcept = 0;
+        virtual Maybe<ProvinceStatisticsMap> getAllProvinceStatistics() noexcept = 0;
+        virtual void invalidateProvinceStatistics(uint8_t) noexcept = 0;
+
+        virtual MaybeVoid writeProvinceStatisticsCSV(const std::filesystem::path&) noexcept = 0;
+        virtual MaybeVoid writeProvinceStatisticsJSON(const std::filesystem::path&) noexcept = 0;
+
         // TODO: This should be its own sub-project
         virtual const std::vector<Terrain>& getTerrains() const = 0;
 
@@ -249,6 +426,12 @@ namespace HMDT::Project {
 
         virtual IRiversProject& getRiversProject() noexcept = 0;
         virtual const IRiversProject& getRiversProject() const noexcept = 0;
+
+        virtual ITerrainProject& getTerrainProject() noexcept = 0;
+        virtual const ITerrainProject& getTerrainProject() const noexcept = 0;
+
+        virtual IStrategicRegionProject& getStrategicRegionProject() noexcept = 0;
+        virtual const IStrategicRegionProject& getStrategicRegionProject() const noexcept = 0;
     };
 
     struct IRootHistoryProject: public IHistoryProject {
@@ -0,0 +1,64 @@
+/**
+ * @file LayerLoadProgress.h
+ *
+ * @brief Defines the progress tracker used when loading a map layer on a
+ *        worker thread.
+ */
+
+#ifndef LAYER_LOAD_PROGRESS_H
+# define LAYER_LOAD_PROGRESS_H
+
+# include <atomic>
+# include <functional>
+# include <string>
+
+namespace HMDT::Project {
+    /**
+     * @brief Tracks how far along a map layer (such as the heightmap or the
+     *        rivers) is while it is being loaded on a worker thread.
+     * @details The worker thread moves through each stage, while any other
+     *          thread may read the current stage or ask for the load to stop.
+     *          Stopping is only checked between stages, so the worker will
+     *          finish whatever stage it is currently in first.
+     */
+    class LayerLoadProgress {
+        public:
+            enum class Stage {
+                START,
+                READING,
+                CONVERTING,
+                PROCESSING,
+                DONE
+            };
+
+            //! Called on the worker thread every time the stage changes
+            using StageCallback = std::function<void(Stage)>;
+
+            LayerLoadProgress();
+
+            void setStage(Stage);
+            Stage getStage() const noexcept;
+
+            float getFraction() const noexcept;
+
+            void estop() noexcept;
+            bool isStopped() const noexcept;
+
+            void setStageCallback(const StageCallback&);
+
+        private:
+            //! The stage the load is currently at
+            std::atomic<Stage> m_stage;
+
+            //! Whether or not the load should stop
+            std::atomic<bool> m_do_estop;
+
+            //! Called every time the stage changes
+            StageCallback m_stage_callback;
+    };
+
+    std::string toString(const LayerLoadProgress::Stage&);
+}
+
+#endif
+
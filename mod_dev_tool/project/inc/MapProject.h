@@ -11,6 +11,7 @@
 # include "Types.h"
 # include "BitMap.h"
 # include "MapData.h"
+# include "ProvinceGenerator.h"
 
 # include "Terrain.h"
 
@@ -20,6 +21,8 @@
 # include "ContinentProject.h"
 # include "HeightMapProject.h"
 # include "RiversProject.h"
+# include "TerrainProject.h"
+# include "StrategicRegionProject.h"
 
 namespace HMDT::Project {
     /**
@@ -39,6 +42,14 @@ namespace HMDT::Project {
             virtual void import(const ShapeFinder&, std::shared_ptr<MapData>) override;
             virtual bool validateData() override;
 
+            MaybeVoid importMod(const BitMap2&,
+                                const std::vector<ProvinceDefinition>&,
+                                const std::vector<std::string>&,
+                                const std::filesystem::path&) noexcept;
+
+            MaybeVoid generateProvinces(const BitMap2&, const BitMap2*,
+                                        const ProvinceGeneratorOptions&) noexcept;
+
             virtual IRootProject& getRootParent() override;
             virtual const IRootProject& getRootParent() const override;
 
@@ -54,9 +65,15 @@ namespace HMDT::Project {
             virtual RiversProject& getRiversProject() noexcept override;
             virtual const RiversProject& getRiversProject() const noexcept override;
 
+            virtual TerrainProject& getTerrainProject() noexcept override;
+            virtual const TerrainProject& getTerrainProject() const noexcept override;
+
             virtual HeightMapProject& getHeightMapProject() noexcept override;
             virtual const HeightMapProject& getHeightMapProject() const noexcept override;
 
+            virtual StrategicRegionProject& getStrategicRegionProject() noexcept override;
+            virtual const StrategicRegionProject& getStrategicRegionProject() const noexcept override;
+
             virtual void moveProvinceToState(ProvinceID, StateID) override;
             virtual void moveProvinceToState(Province&, StateID) override;
             virtual void removeProvinceFromState(Province&, bool = true) override;
@@ -65,11 +82,29 @@ namespace HMDT::Project {
 
             virtual void calculateCoastalProvinces(bool = false) override;
 
+            virtual Maybe<std::vector<Strait>> findStraits() const noexcept override;
+
+            virtual uint32_t getMaxStraitWidth() const noexcept override;
+            virtual void setMaxStraitWidth(uint32_t) noexcept override;
+
+            virtual Maybe<SupplyNetwork> buildSupplyNetwork() const noexcept override;
+
+            virtual Maybe<LabelPointMap> findLabelPoints() const noexcept override;
+
+            virtual Maybe<ProvinceStatistics> getProvinceStatistics(const ProvinceID&) noexcept override;
+            virtual Maybe<ProvinceStatisticsMap> getAllProvinceStatistics() noexcept override;
+            virtual void invalidateProvinceStatistics(uint8_t) noexcept override;
+
+            virtual MaybeVoid writeProvinceStatisticsCSV(const std::filesystem::path&) noexcept override;
+            virtual MaybeVoid writeProvinceStatisticsJSON(const std::filesystem::path&) noexcept override;
+
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
         protected:
             MaybeVoid validateProvinceStateID(StateID, ProvinceID);
 
+            MaybeVoid updateProvinceStatistics() noexcept;
+
         private:
             //! The Provinces project
             ProvinceProject m_provinces_project;
@@ -83,6 +118,12 @@ namespace HMDT::Project {
             //! The HeightMap project
             RiversProject m_rivers_project;
 
+            //! The Terrain project
+            TerrainProject m_terrain_project;
+
+            //! The StrategicRegion project
+            StrategicRegionProject m_strategic_region_project;
+
             //! The shared map data
             std::shared_ptr<MapData> m_map_data;
 
@@ -91,6 +132,20 @@ namespace HMDT::Project {
 
             //! The parent project that this MapProject belongs to
             IProject& m_parent_project;
+
+            //! The widest sea crossing which will be exported as a strait
+            uint32_t m_max_strait_width;
+
+            //! The statistics of every province, computed the last time they
+            //!   were asked for
+            ProvinceStatisticsMap m_province_statistics;
+
+            //! The ZONAL_LAYER_* flags for which statistics are still up to
+            //!   date
+            uint8_t m_valid_province_statistics;
+
+            //! The dimensions of the map the statistics were computed for
+            Dimensions m_province_statistics_dimensions;
     };
 }
 
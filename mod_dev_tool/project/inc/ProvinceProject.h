@@ -2,6 +2,7 @@
 # define PROVINCE_PROJECT_H
 
 # include "IProject.h"
+# include "ModReader.h"
 # include "Types.h"
 
 namespace HMDT::Project {
@@ -15,9 +16,13 @@ namespace HMDT::Project {
 
             virtual MaybeVoid save(const std::filesystem::path&) override;
             virtual MaybeVoid load(const std::filesystem::path&) override;
+            MaybeVoid loadProvinceList(const std::filesystem::path&);
             virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
             virtual void import(const ShapeFinder&, std::shared_ptr<MapData>) override;
 
+            MaybeVoid importProvinces(const std::vector<ProvinceDefinition>&,
+                                      const std::vector<std::string>&) noexcept;
+
             virtual std::shared_ptr<MapData> getMapData() override;
             virtual const std::shared_ptr<MapData> getMapData() const override;
 
@@ -43,6 +48,14 @@ namespace HMDT::Project {
 
             Maybe<std::shared_ptr<Hierarchy::IGroupNode>> visitProvinces(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept;
 
+            virtual Maybe<ProvinceEdit> paintProvince(const ProvinceID&, const std::vector<Point2D>&) noexcept override;
+            virtual MaybeVoid revertProvinceEdit(const ProvinceEdit&) noexcept override;
+
+            virtual Maybe<ProvinceEdit> splitProvince(const ProvinceID&, uint32_t) noexcept override;
+            virtual Maybe<ProvinceEdit> splitOversizedProvinces() noexcept override;
+
+            virtual Maybe<std::vector<AbsorbedProvince>> absorbTinyProvinces() noexcept override;
+
             void buildProvinceOutlines();
         protected:
             MaybeVoid saveShapeLabels(const std::filesystem::path&);
@@ -58,6 +71,52 @@ namespace HMDT::Project {
             std::unique_ptr<unsigned char[]> getProvinceColorsForExport() const noexcept;
 
             void rebuildUUIDToIDMap() noexcept;
+            void assignExportIDs(std::vector<ProvinceID>) noexcept;
+            void releaseExportIDs(const std::vector<ProvinceID>&) noexcept;
+            void renumberExportIDs() noexcept;
+
+            /**
+             * @brief A single connected piece of a province
+             */
+            struct ConnectedComponent {
+                //! The index of every pixel in this piece
+                std::vector<uint64_t> pixels;
+
+                //! The bounding box of this piece
+                BoundingBox bounding_box;
+
+                //! Whether pixels holds every pixel of this piece. Only the
+                //!   largest piece is ever left incomplete.
+                bool complete = true;
+            };
+
+            std::vector<ConnectedComponent> findConnectedComponents(const ProvinceID&,
+                                                                    const Rectangle&,
+                                                                    const std::vector<uint64_t>& = { }) const noexcept;
+            BoundingBox shrinkBoundingBox(const ProvinceID&, const BoundingBox&) const noexcept;
+
+            /**
+             * @brief How a single province is to be split into pieces
+             */
+            struct ProvinceSplit {
+                //! The province to split
+                ProvinceID id;
+
+                //! Every pixel in the province
+                std::vector<Point2D> pixels;
+
+                //! The piece that each pixel goes into. Piece 0 stays in the
+                //!   original province.
+                std::vector<uint32_t> pieces;
+            };
+
+            std::vector<Point2D> getProvincePixels(const Province&) const noexcept;
+            Maybe<ProvinceEdit> applyProvinceSplits(const std::vector<ProvinceSplit>&) noexcept;
+
+            MaybeVoid rebuildPixels(const std::vector<std::pair<uint64_t, ProvinceID>>&) noexcept;
+            void updateAdjacencies(const std::vector<std::pair<uint64_t, ProvinceID>>&,
+                                   const std::map<ProvinceID, std::set<ProvinceID>>&) noexcept;
+            bool doProvincesTouch(const ProvinceID&, const ProvinceID&) const noexcept;
 
         private:
             void buildProvinceCache(const Province*);
@@ -80,8 +139,18 @@ namespace HMDT::Project {
             //! Maps old IDs to UUIDs (only used when converting old projects)
             std::unordered_map<uint32_t, UUID> m_oldid_to_uuid;
 
-            //! Maps UUIDs to old IDs (required for exporting)
+            //! Maps UUIDs to old IDs (required for exporting). These are saved
+            //!   with the project, and are kept for provinces which get
+            //!   removed so that undoing the removal gives them back.
             std::unordered_map<UUID, uint32_t> m_uuid_to_oldid;
+
+            //! The export ID to give to the next new province
+            uint32_t m_next_export_id;
+
+            //! Maps UUIDs to the IDs every province is actually exported with.
+            //!   These are the saved IDs of every province which still
+            //!   exists, numbered from 1 with no gaps.
+            std::unordered_map<UUID, uint32_t> m_uuid_to_export_id;
     };
 }
 
@@ -34,15 +34,26 @@ namespace HMDT::Project {
 
             virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept override;
 
+            virtual Maybe<uint16_t> checkFile(const std::filesystem::path&) const noexcept override;
+            virtual Maybe<std::shared_ptr<BitMap2>> prepareFile(const std::filesystem::path&, LayerLoadProgress&) const noexcept override;
+            virtual MaybeVoid commitFile(std::shared_ptr<BitMap2>) noexcept override;
+
+            virtual Maybe<std::vector<Rectangle>> commitChangedTiles(std::shared_ptr<BitMap2>) noexcept override;
+            virtual Maybe<std::vector<Rectangle>> reloadFile(const std::filesystem::path&) noexcept override;
+
             MonadOptionalRef<const BitMap2> getBitMap() const;
 
             virtual MaybeVoid writeTemplate(const std::filesystem::path&) const noexcept override;
 
+            virtual MaybeVoid generateRivers(uint32_t) noexcept override;
+            virtual Maybe<std::vector<RiverIssue>> validateRivers() const noexcept override;
+
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
         protected:
             MaybeVoid generateTemplate(std::unique_ptr<unsigned char[]>&) const noexcept;
             static ColorTable generateColorTable() noexcept;
+            RiverPalette generatePalette() const noexcept;
 
         private:
             //! The parent project
@@ -7,6 +7,8 @@
 # include <filesystem>
 
 # include "IProject.h"
+# include "ModReader.h"
+# include "ProvinceClusterer.h"
 # include "Types.h"
 # include "Maybe.h"
 
@@ -50,10 +52,16 @@ namespace HMDT::Project {
             virtual const State& getStateForIterator(StateMap::const_iterator) const override;
 
             virtual void updateStateIDMatrix() override;
+            virtual void updateStateIDMatrix(const std::vector<ProvinceID>&) override;
+
+            MaybeVoid importStates(const std::vector<StateDefinition>&) noexcept;
 
             virtual MaybeVoid addProvinceToState(StateID, ProvinceID) override;
             virtual MaybeVoid removeProvinceFromState(StateID, ProvinceID) override;
 
+            virtual MaybeVoid generateStates(uint32_t, uint64_t) noexcept override;
+            virtual MaybeVoid generateStatesOfSize(uint64_t, uint64_t) noexcept override;
+
             virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
 
             Maybe<std::shared_ptr<Hierarchy::IGroupNode>> visitStates(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept;
@@ -63,6 +71,8 @@ namespace HMDT::Project {
             virtual StateMap& getStateMap() override;
 
         private:
+            MaybeVoid generateStatesWith(ProvinceClusterOptions) noexcept;
+
             //! The parent project that this HistoryProject belongs to
             IRootHistoryProject& m_parent_project;
 
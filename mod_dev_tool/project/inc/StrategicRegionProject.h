@@ -0,0 +1,66 @@
+#ifndef STRATEGIC_REGION_PROJECT_H
+# define STRATEGIC_REGION_PROJECT_H
+
+# include <unordered_map>
+
+# include "IProject.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Defines a strategic region project for HoI4
+     */
+    class StrategicRegionProject: public IStrategicRegionProject {
+        public:
+            StrategicRegionProject(IRootMapProject&);
+
+            virtual ~StrategicRegionProject() = default;
+
+            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid load(const std::filesystem::path&) override;
+            virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
+
+            virtual IRootProject& getRootParent() override;
+            virtual const IRootProject& getRootParent() const override;
+
+            virtual std::shared_ptr<MapData> getMapData() override;
+            virtual const std::shared_ptr<MapData> getMapData() const override;
+
+            virtual void import(const ShapeFinder&, std::shared_ptr<MapData>) override;
+
+            virtual bool validateData() override;
+
+            virtual IRootMapProject& getRootMapParent() override;
+            virtual const IRootMapProject& getRootMapParent() const override;
+
+            virtual const StrategicRegionMap& getStrategicRegions() const noexcept override;
+
+            virtual MaybeRef<const StrategicRegion> getStrategicRegionForProvince(ProvinceID) const noexcept override;
+
+            virtual StrategicRegionID addNewStrategicRegion(const std::vector<ProvinceID>&) noexcept override;
+            virtual MaybeVoid removeStrategicRegion(StrategicRegionID) noexcept override;
+
+            virtual MaybeVoid moveProvinceToStrategicRegion(ProvinceID, StrategicRegionID) noexcept override;
+            virtual MaybeVoid setStrategicRegionName(StrategicRegionID, const std::string&) noexcept override;
+
+            virtual MaybeVoid generateStrategicRegions(uint32_t) noexcept override;
+            virtual MaybeVoid generateStrategicRegionsOfSize(uint64_t) noexcept override;
+
+            virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
+
+        protected:
+            void removeProvinceFromStrategicRegion(ProvinceID) noexcept;
+
+        private:
+            //! The parent project
+            IRootMapProject& m_parent_project;
+
+            //! All strategic regions defined for this project
+            StrategicRegionMap m_strategic_regions;
+
+            //! Which strategic region every province belongs to
+            std::unordered_map<ProvinceID, StrategicRegionID> m_province_regions;
+    };
+}
+
+#endif
+
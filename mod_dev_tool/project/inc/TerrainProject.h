@@ -0,0 +1,62 @@
+#ifndef TERRAIN_PROJECT_H
+# define TERRAIN_PROJECT_H
+
+# include "BitMap.h"
+
+# include "IProject.h"
+
+namespace HMDT::Project {
+    /**
+     * @brief Defines a terrain map project for HoI4
+     */
+    class TerrainProject: public ITerrainProject {
+        public:
+            TerrainProject(IRootMapProject&);
+
+            virtual ~TerrainProject() = default;
+
+            virtual MaybeVoid save(const std::filesystem::path&) override;
+            virtual MaybeVoid load(const std::filesystem::path&) override;
+            virtual MaybeVoid export_(const std::filesystem::path&) const noexcept override;
+
+            virtual IRootProject& getRootParent() override;
+            virtual const IRootProject& getRootParent() const override;
+
+            virtual std::shared_ptr<MapData> getMapData() override;
+            virtual const std::shared_ptr<MapData> getMapData() const override;
+
+            virtual void import(const ShapeFinder&, std::shared_ptr<MapData>) override;
+
+            virtual bool validateData() override;
+
+            virtual IRootMapProject& getRootMapParent() override;
+            virtual const IRootMapProject& getRootMapParent() const override;
+
+            virtual MaybeVoid loadFile(const std::filesystem::path&) noexcept override;
+            virtual bool hasTerrainMap() const noexcept override;
+
+            MonadOptionalRef<const BitMap2> getBitMap() const;
+
+            virtual std::vector<TerrainID> getIndexTerrains() const noexcept override;
+            virtual Color getTerrainColor(const TerrainID&) const noexcept override;
+
+            virtual Maybe<std::vector<TerrainChange>> calculateProvinceTerrains(const TerrainVoteOptions&) const noexcept override;
+            virtual MaybeVoid applyTerrainChanges(const std::vector<TerrainChange>&, bool = false) noexcept override;
+
+            virtual uint32_t getProvinceTerrainsUpdatedTag() const noexcept override;
+
+            virtual Maybe<std::shared_ptr<Hierarchy::INode>> visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>&) const noexcept override;
+
+        private:
+            //! The parent project
+            IRootMapProject& m_parent_project;
+
+            std::shared_ptr<BitMap2> m_terrain_bmp;
+
+            //! Changed every time the terrain of any province is changed
+            uint32_t m_province_terrains_updated_tag;
+    };
+}
+
+#endif
+
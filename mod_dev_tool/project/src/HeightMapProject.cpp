@@ -3,7 +3,10 @@
 
 #include <fstream>
 #include <cstring>
+#include <cmath>
 #include <memory>
+#include <algorithm>
+#include <sstream>
 
 #include "Logger.h"
 
@@ -13,6 +16,7 @@
 #include "Util.h"
 
 #include "WorldNormalBuilder.h"
+#include "TileHash.h"
 
 #include "ProjectNode.h"
 #include "PropertyNode.h"
@@ -77,8 +81,7 @@ auto HMDT::Project::HeightMapProject::load(const std::filesystem::path& root)
 auto HMDT::Project::HeightMapProject::export_(const std::filesystem::path& root) const noexcept
     -> MaybeVoid
 {
-    // TODO: Do we want to export from MapData's heightmap? Or just use the
-    //       BitMap object?
+    // Export from MapData's heightmap, as that is the one which gets sculpted
     auto res = writeBMP2(root / HEIGHTMAP_FILENAME,
                          getMapData()->getHeightMap().lock().get(),
                          getMapData()->getWidth(), getMapData()->getHeight(),
@@ -88,8 +91,7 @@ auto HMDT::Project::HeightMapProject::export_(const std::filesystem::path& root)
 
     {
         // Normal map is a 24-bit bitmap
-        auto normal_data_size = getMapData()->getWidth() *
-                                getMapData()->getWidth() * 3;
+        auto normal_data_size = getMapData()->getNormalMapSize();
         std::unique_ptr<unsigned char[]> normal_data;
         try {
             normal_data.reset(new unsigned char[normal_data_size]);
@@ -98,7 +100,12 @@ auto HMDT::Project::HeightMapProject::export_(const std::filesystem::path& root)
             RETURN_ERROR(STATUS_BADALLOC);
         }
 
-        res = generateWorldNormalMap(*m_heightmap_bmp, normal_data.get());
+        // Always generate the whole map fresh, as there may still be dirty
+        //   tiles which haven't been updated in MapData's normal map yet
+        res = generateWorldNormalMap(getMapData()->getHeightMap().lock().get(),
+                                     Dimensions{ getMapData()->getWidth(),
+                                                 getMapData()->getHeight() },
+                                     normal_data.get());
         RETURN_IF_ERROR(res);
 
         res = writeBMP2(root / NORMALMAP_FILENAME, normal_data.get(),
@@ -147,42 +154,31 @@ auto HMDT::Project::HeightMapProject::getRootMapParent() const
     return m_parent_project.getRootMapParent();
 }
 
+/**
+ * @brief Loads a heightmap, asking the user if it needs to be converted to
+ *        8-bit greyscale first.
+ * @details The currently loaded heightmap is only replaced once the new one
+ *          has been completely loaded, so it is left untouched on failure.
+ *
+ * @param path The path to the heightmap
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
 auto HMDT::Project::HeightMapProject::loadFile(const std::filesystem::path& path) noexcept
     -> MaybeVoid
 {
-    try {
-        m_heightmap_bmp.reset(new BitMap2);
-    } catch(const std::bad_alloc& e) {
-        WRITE_ERROR("Failed to allocate space for new bitmap: ", e.what());
-        RETURN_ERROR(STATUS_BADALLOC);
-    }
-
-    auto res = readBMP(path, m_heightmap_bmp);
-    RETURN_IF_ERROR(res);
-
-    WRITE_DEBUG(*m_heightmap_bmp);
-
-    if(auto d = getMapData()->getDimensions();
-            d.first != m_heightmap_bmp->info_header.v1.width ||
-            d.second != m_heightmap_bmp->info_header.v1.height)
-    {
-        WRITE_ERROR("Heightmap dimensions (",
-                    m_heightmap_bmp->info_header.v1.width, ", ",
-                    m_heightmap_bmp->info_header.v1.height, ") do not match the"
-                    " previously loaded dimensions (", d.first, ", ", d.second,
-                    ")");
-        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
-    }
+    auto bpp = checkFile(path);
+    RETURN_IF_ERROR(bpp);
 
     // Just in case the input image is not actually an 8-bit images
-    uint8_t* heightmap_data;
-    if(auto bpp = m_heightmap_bmp->info_header.v1.bitsPerPixel; bpp != 8) {
-        WRITE_WARN("Heightmaps must be 8-bit greyscale images, not ", bpp, ". "
+    bool allow_conversion = false;
+    if(*bpp != 8) {
+        WRITE_WARN("Heightmaps must be 8-bit greyscale images, not ", *bpp, ". "
                    "Checking if the user is okay with converting it.");
 
         std::stringstream prompt_ss;
         prompt_ss << "Heightmaps must be an 8-bit greyscale image (loaded "
-                     "image has BPP=" << bpp << "). Convert to 8-bit image?";
+                     "image has BPP=" << *bpp << "). Convert to 8-bit image?";
 
         auto response = prompt(prompt_ss.str(), {"Yes", "No"});
         if(response.error() == STATUS_CALLBACK_NOT_REGISTERED) {
@@ -195,8 +191,7 @@ auto HMDT::Project::HeightMapProject::loadFile(const std::filesystem::path& path
 
         switch(*response) {
             case 0:
-                res = convertBitMapTo8BPPGreyscale(*m_heightmap_bmp);
-                RETURN_IF_ERROR(res);
+                allow_conversion = true;
                 break;
             case 1:
                 WRITE_ERROR("Not converting input image. Cannot continue loading.");
@@ -208,18 +203,300 @@ auto HMDT::Project::HeightMapProject::loadFile(const std::filesystem::path& path
         }
     }
 
-    heightmap_data = m_heightmap_bmp->data.get();
+    LayerLoadProgress progress;
+
+    auto pending = prepareFile(path, allow_conversion, progress);
+    RETURN_IF_ERROR(pending);
+
+    auto res = commitFile(std::move(*pending));
+    RETURN_IF_ERROR(res);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Checks only the header of a heightmap, so that any questions about
+ *        it can be asked before it is actually loaded.
+ *
+ * @param path The path to the heightmap
+ *
+ * @return The bits per pixel of the heightmap if its dimensions match the map,
+ *         or an error code otherwise. Anything other than 8 must be converted.
+ */
+auto HMDT::Project::HeightMapProject::checkFile(const std::filesystem::path& path) const noexcept
+    -> Maybe<uint16_t>
+{
+    BitMap2 header;
+
+    auto res = readBMPHeader(path, header);
+    RETURN_IF_ERROR(res);
+
+    if(auto d = getMapData()->getDimensions();
+            d.first != header.info_header.v1.width ||
+            d.second != header.info_header.v1.height)
+    {
+        WRITE_ERROR("Heightmap dimensions (",
+                    header.info_header.v1.width, ", ",
+                    header.info_header.v1.height, ") do not match the"
+                    " previously loaded dimensions (", d.first, ", ", d.second,
+                    ")");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+
+    return header.info_header.v1.bitsPerPixel;
+}
+
+/**
+ * @brief Loads and processes a heightmap without touching the project, so
+ *        that it is safe to call from a worker thread.
+ * @details Never prompts the user, so any conversion must already be agreed
+ *          to. The load is stopped between each stage if progress.estop() is
+ *          called. Hand the result to commitFile to actually use it.
+ *
+ * @param path The path to the heightmap
+ * @param allow_conversion Whether the heightmap may be converted to 8-bit
+ *                         greyscale if it isn't already
+ * @param progress Tracks the progress of the load
+ *
+ * @return The loaded heightmap and its normal map, or an error code. If the
+ *         load was stopped early then STATUS_LOAD_CANCELLED is returned.
+ */
+auto HMDT::Project::HeightMapProject::prepareFile(const std::filesystem::path& path,
+                                                  bool allow_conversion,
+                                                  LayerLoadProgress& progress) const noexcept
+    -> Maybe<PendingHeightMap>
+{
+    auto map_data = getMapData();
+
+    PendingHeightMap pending;
+
+    auto bitmap = readFile(path, allow_conversion, progress);
+    RETURN_IF_ERROR(bitmap);
+
+    pending.bitmap = *bitmap;
+
+    progress.setStage(LayerLoadProgress::Stage::PROCESSING);
+    try {
+        pending.normal_map.reset(new uint8_t[map_data->getNormalMapSize()]);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate enough space for the world normal data.");
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    auto normal_res = generateWorldNormalMap(pending.bitmap->data.get(),
+                                             Dimensions{ map_data->getWidth(),
+                                                         map_data->getHeight() },
+                                             pending.normal_map.get());
+    RETURN_IF_ERROR(normal_res);
+
+    RETURN_ERROR_IF(progress.isStopped(), STATUS_LOAD_CANCELLED);
+
+    progress.setStage(LayerLoadProgress::Stage::DONE);
+
+    return pending;
+}
+
+/**
+ * @brief Reads a heightmap and converts it to 8-bit greyscale, without
+ *        touching the project.
+ * @details This is the first half of prepareFile, and leaves the progress at
+ *          whichever stage it finished. Safe to call from a worker thread.
+ *
+ * @param path The path to the heightmap
+ * @param allow_conversion Whether the heightmap may be converted to 8-bit
+ *                         greyscale if it isn't already
+ * @param progress Tracks the progress of the load
+ *
+ * @return The heightmap, or an error code. If the load was stopped early then
+ *         STATUS_LOAD_CANCELLED is returned.
+ */
+auto HMDT::Project::HeightMapProject::readFile(const std::filesystem::path& path,
+                                               bool allow_conversion,
+                                               LayerLoadProgress& progress) const noexcept
+    -> Maybe<std::shared_ptr<BitMap2>>
+{
+    std::shared_ptr<BitMap2> bitmap;
+
+    progress.setStage(LayerLoadProgress::Stage::READING);
+    try {
+        bitmap.reset(new BitMap2);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for new bitmap: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    auto res = readBMP(path, bitmap);
+    RETURN_IF_ERROR(res);
+
+    WRITE_DEBUG(*bitmap);
+
+    if(auto d = getMapData()->getDimensions();
+            d.first != bitmap->info_header.v1.width ||
+            d.second != bitmap->info_header.v1.height)
+    {
+        WRITE_ERROR("Heightmap dimensions (",
+                    bitmap->info_header.v1.width, ", ",
+                    bitmap->info_header.v1.height, ") do not match the"
+                    " previously loaded dimensions (", d.first, ", ", d.second,
+                    ")");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+
+    RETURN_ERROR_IF(progress.isStopped(), STATUS_LOAD_CANCELLED);
+
+    if(auto bpp = bitmap->info_header.v1.bitsPerPixel; bpp != 8) {
+        if(!allow_conversion) {
+            WRITE_ERROR("Heightmaps must be 8-bit greyscale images, not ", bpp,
+                        ", and converting it was not allowed.");
+            RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+        }
+
+        progress.setStage(LayerLoadProgress::Stage::CONVERTING);
+
+        auto conv_res = convertBitMapTo8BPPGreyscale(*bitmap);
+        RETURN_IF_ERROR(conv_res);
+
+        RETURN_ERROR_IF(progress.isStopped(), STATUS_LOAD_CANCELLED);
+    }
+
+    return bitmap;
+}
+
+/**
+ * @brief Hands a heightmap loaded by prepareFile off to the project, replacing
+ *        the current one all at once.
+ * @details This only copies memory, so it is cheap enough to call on the GUI
+ *          thread.
+ *
+ * @param pending The heightmap returned by prepareFile
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the heightmap no
+ *         longer fits the map.
+ */
+auto HMDT::Project::HeightMapProject::commitFile(PendingHeightMap&& pending) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(pending.bitmap == nullptr || pending.normal_map == nullptr,
+                    STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto map_data = getMapData();
+
+    // The map may have changed while the heightmap was being loaded
+    if(auto d = map_data->getDimensions();
+            d.first != pending.bitmap->info_header.v1.width ||
+            d.second != pending.bitmap->info_header.v1.height)
+    {
+        WRITE_ERROR("Heightmap dimensions no longer match the map.");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+    RETURN_ERROR_IF(pending.bitmap->info_header.v1.bitsPerPixel != 8,
+                    STATUS_INVALID_BIT_DEPTH);
 
     // Load heightmap data into MapData
     // This operation is fairly simple, as we are not making any modifications
     //   to the data itself, and just loading it into memory
-    std::memcpy(getMapData()->getHeightMap().lock().get(),
-                heightmap_data,
-                getMapData()->getHeightMapSize());
+    std::memcpy(map_data->getHeightMap().lock().get(),
+                pending.bitmap->data.get(),
+                map_data->getHeightMapSize());
+    std::memcpy(map_data->getNormalMap().lock().get(),
+                pending.normal_map.get(),
+                map_data->getNormalMapSize());
+
+    m_heightmap_bmp = std::move(pending.bitmap);
+    m_dirty_tiles.clear();
+
+    getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_HEIGHTMAP);
 
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Replaces the heightmap with a new version of it, only touching the
+ *        tiles which actually changed.
+ * @details Each changed tile is marked dirty and has its normals regenerated,
+ *          just like a sculpting stroke. Meant for reloading a heightmap which
+ *          was edited outside of the tool.
+ *
+ * @param bitmap The new heightmap, as returned by readFile
+ *
+ * @return Every tile which changed, or an error code if the heightmap does not
+ *         fit the map.
+ */
+auto HMDT::Project::HeightMapProject::commitChangedTiles(std::shared_ptr<BitMap2> bitmap) noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    RETURN_ERROR_IF(bitmap == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto map_data = getMapData();
+    auto width = map_data->getWidth();
+    auto height = map_data->getHeight();
+
+    if(width != bitmap->info_header.v1.width ||
+       height != bitmap->info_header.v1.height)
+    {
+        WRITE_ERROR("Heightmap dimensions no longer match the map.");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+    RETURN_ERROR_IF(bitmap->info_header.v1.bitsPerPixel != 8,
+                    STATUS_INVALID_BIT_DEPTH);
+
+    auto heightmap = map_data->getHeightMap().lock();
+
+    auto changed = findChangedTiles({ width, height }, heightmap.get(),
+                                    bitmap->data.get(), 1 /* depth */,
+                                    LAYER_RELOAD_TILE_SIZE);
+    RETURN_IF_ERROR(changed);
+
+    auto tiles_across = (width + HEIGHTMAP_TILE_SIZE - 1) / HEIGHTMAP_TILE_SIZE;
+
+    for(auto&& tile : *changed) {
+        for(uint32_t y = tile.y; y < tile.y + tile.h; ++y) {
+            auto index = xyToIndex(width, tile.x, y);
+            std::memcpy(heightmap.get() + index, bitmap->data.get() + index,
+                        tile.w);
+        }
+
+        m_dirty_tiles.insert((tile.y / HEIGHTMAP_TILE_SIZE) * tiles_across +
+                             (tile.x / HEIGHTMAP_TILE_SIZE));
+    }
+
+    // The new bitmap is now exactly what is in MapData
+    m_heightmap_bmp = bitmap;
+
+    if(!changed->empty()) {
+        getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_HEIGHTMAP);
+    }
+
+    WRITE_DEBUG(changed->size(), " heightmap tiles changed.");
+
+    auto regions = updateNormalMap();
+    RETURN_IF_ERROR(regions);
+
+    return changed;
+}
+
+/**
+ * @brief Reloads a heightmap which was edited outside of the tool, only
+ *        updating the tiles which changed.
+ *
+ * @param path The path to the heightmap
+ * @param allow_conversion Whether the heightmap may be converted to 8-bit
+ *                         greyscale if it isn't already
+ *
+ * @return Every tile which changed, or an error code on failure.
+ */
+auto HMDT::Project::HeightMapProject::reloadFile(const std::filesystem::path& path,
+                                                 bool allow_conversion) noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    LayerLoadProgress progress;
+
+    auto bitmap = readFile(path, allow_conversion, progress);
+    RETURN_IF_ERROR(bitmap);
+
+    return commitChangedTiles(*bitmap);
+}
+
 auto HMDT::Project::HeightMapProject::getBitMap() const
     -> MonadOptionalRef<const BitMap2>
 {
@@ -230,6 +507,260 @@ auto HMDT::Project::HeightMapProject::getBitMap() const
     }
 }
 
+/**
+ * @brief Sculpts the heightmap with a brush.
+ * @details The new heights are all calculated from the heights before the
+ *          stroke, so the order of the pixels does not matter. Every tile that
+ *          gets modified is marked dirty, see updateNormalMap.
+ *
+ * @param mode How the brush modifies the heightmap
+ * @param pixels Every pixel under the brush
+ * @param strength How strong the brush is. For RAISE and LOWER this is how
+ *                 much gets added or subtracted, for SMOOTH and FLATTEN it is
+ *                 how far each pixel is blended, with 255 being all the way.
+ *
+ * @return Everything that was changed, so that the stroke can be reverted.
+ */
+auto HMDT::Project::HeightMapProject::sculpt(SculptMode mode,
+                                             const std::vector<Point2D>& pixels,
+                                             uint8_t strength) noexcept
+    -> Maybe<HeightMapEdit>
+{
+    if(m_heightmap_bmp == nullptr) {
+        WRITE_ERROR("No heightmap has been loaded, cannot sculpt yet.");
+        RETURN_ERROR(STATUS_NO_DATA_LOADED);
+    }
+
+    auto map_data = getMapData();
+    auto width = map_data->getWidth();
+    auto height = map_data->getHeight();
+    auto heightmap = map_data->getHeightMap().lock();
+
+    // Only touch each pixel once, no matter how many times the brush went over
+    //   it
+    std::vector<uint64_t> indices;
+    indices.reserve(pixels.size());
+    for(auto&& [x, y] : pixels) {
+        if(x >= width || y >= height) {
+            WRITE_ERROR("Pixel (", x, ", ", y, ") is outside of the heightmap.");
+            RETURN_ERROR(STATUS_OUT_OF_RANGE);
+        }
+
+        indices.push_back(xyToIndex(width, x, y));
+    }
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    // Flatten towards the average height under the whole brush
+    double flatten_target = 0;
+    if(mode == SculptMode::FLATTEN && !indices.empty()) {
+        for(auto&& index : indices) {
+            flatten_target += heightmap[index];
+        }
+        flatten_target /= indices.size();
+    }
+
+    auto blend = [strength](double from, double to) -> uint8_t {
+        auto value = from + (to - from) * (strength / 255.0);
+        return static_cast<uint8_t>(clamp(std::round(value), 0.0, 255.0));
+    };
+
+    // Calculate every new height first, so that smoothing never reads a height
+    //   which was already modified by this same stroke
+    std::vector<uint8_t> new_heights(indices.size());
+    for(size_t i = 0; i < indices.size(); ++i) {
+        auto index = indices[i];
+        auto old_height = heightmap[index];
+
+        switch(mode) {
+            case SculptMode::RAISE:
+                new_heights[i] = static_cast<uint8_t>(std::min(old_height + strength, 255));
+                break;
+            case SculptMode::LOWER:
+                new_heights[i] = static_cast<uint8_t>(std::max(old_height - strength, 0));
+                break;
+            case SculptMode::SMOOTH: {
+                uint32_t x = index % width;
+                uint32_t y = index / width;
+
+                // Average of the 3x3 neighborhood, clamped to the map
+                uint32_t sum = 0;
+                uint32_t count = 0;
+                for(uint32_t ny = (y == 0 ? 0 : y - 1); ny <= std::min(y + 1, height - 1); ++ny) {
+                    for(uint32_t nx = (x == 0 ? 0 : x - 1); nx <= std::min(x + 1, width - 1); ++nx) {
+                        sum += heightmap[xyToIndex(width, nx, ny)];
+                        ++count;
+                    }
+                }
+
+                new_heights[i] = blend(old_height, static_cast<double>(sum) / count);
+                break;
+            }
+            case SculptMode::FLATTEN:
+                new_heights[i] = blend(old_height, flatten_target);
+                break;
+        }
+    }
+
+    HeightMapEdit edit;
+    for(size_t i = 0; i < indices.size(); ++i) {
+        auto index = indices[i];
+
+        if(heightmap[index] != new_heights[i]) {
+            edit.old_heights.push_back({ index, heightmap[index] });
+            setHeight(index, new_heights[i]);
+        }
+    }
+
+    if(!edit.old_heights.empty()) {
+        getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_HEIGHTMAP);
+    }
+
+    return edit;
+}
+
+/**
+ * @brief Reverts a single sculpting stroke.
+ *
+ * @param edit The edit returned when the stroke was made
+ *
+ * @return STATUS_SUCCESS on success, or an error code if no heightmap is
+ *         loaded or the edit does not fit this heightmap.
+ */
+auto HMDT::Project::HeightMapProject::revertHeightMapEdit(const HeightMapEdit& edit) noexcept
+    -> MaybeVoid
+{
+    if(m_heightmap_bmp == nullptr) {
+        WRITE_ERROR("No heightmap has been loaded, cannot revert sculpting.");
+        RETURN_ERROR(STATUS_NO_DATA_LOADED);
+    }
+
+    auto size = getMapData()->getHeightMapSize();
+
+    for(auto it = edit.old_heights.rbegin(); it != edit.old_heights.rend(); ++it)
+    {
+        RETURN_ERROR_IF(it->first >= size, STATUS_OUT_OF_RANGE);
+
+        setHeight(it->first, it->second);
+    }
+
+    getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_HEIGHTMAP);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Sets the height of a single pixel, and marks its tile as dirty.
+ *
+ * @param index The index of the pixel
+ * @param value The new height
+ */
+void HMDT::Project::HeightMapProject::setHeight(uint64_t index, uint8_t value)
+{
+    auto map_data = getMapData();
+
+    map_data->getHeightMap().lock()[index] = value;
+
+    // Keep the bitmap in sync too, as that is what gets saved. Both have the
+    //   exact same layout, see loadFile
+    if(m_heightmap_bmp != nullptr) {
+        m_heightmap_bmp->data[index] = value;
+    }
+
+    auto width = map_data->getWidth();
+    auto tiles_across = (width + HEIGHTMAP_TILE_SIZE - 1) / HEIGHTMAP_TILE_SIZE;
+
+    uint32_t tile_x = (index % width) / HEIGHTMAP_TILE_SIZE;
+    uint32_t tile_y = (index / width) / HEIGHTMAP_TILE_SIZE;
+
+    m_dirty_tiles.insert(tile_y * tiles_across + tile_x);
+}
+
+/**
+ * @brief Gets every region of the normal map which is out of date.
+ * @details Each region is a dirty tile, plus a one pixel apron on each side
+ *          (clamped to the map), as changing a height also changes the normals
+ *          of every pixel next to it.
+ *
+ * @return Every out of date region
+ */
+auto HMDT::Project::HeightMapProject::getDirtyRegions() const
+    -> std::vector<Rectangle>
+{
+    auto width = getMapData()->getWidth();
+    auto height = getMapData()->getHeight();
+    auto tiles_across = (width + HEIGHTMAP_TILE_SIZE - 1) / HEIGHTMAP_TILE_SIZE;
+
+    std::vector<Rectangle> regions;
+    regions.reserve(m_dirty_tiles.size());
+
+    for(auto&& tile : m_dirty_tiles) {
+        uint32_t left = (tile % tiles_across) * HEIGHTMAP_TILE_SIZE;
+        uint32_t top = (tile / tiles_across) * HEIGHTMAP_TILE_SIZE;
+        uint32_t right = std::min(left + HEIGHTMAP_TILE_SIZE, width);
+        uint32_t bottom = std::min(top + HEIGHTMAP_TILE_SIZE, height);
+
+        // Add the apron
+        left = (left == 0) ? 0 : left - 1;
+        top = (top == 0) ? 0 : top - 1;
+        right = std::min(right + 1, width);
+        bottom = std::min(bottom + 1, height);
+
+        regions.push_back(Rectangle{ left, top, right - left, bottom - top });
+    }
+
+    return regions;
+}
+
+/**
+ * @brief Regenerates the normals of only the regions of the normal map which
+ *        are out of date.
+ *
+ * @return The regions that were regenerated, so that only they need to be
+ *         uploaded again.
+ */
+auto HMDT::Project::HeightMapProject::updateNormalMap() noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    auto map_data = getMapData();
+    auto regions = getDirtyRegions();
+
+    auto heightmap = map_data->getHeightMap().lock();
+    auto normal_map = map_data->getNormalMap().lock();
+    Dimensions dimensions{ map_data->getWidth(), map_data->getHeight() };
+
+    for(auto&& region : regions) {
+        auto res = generateWorldNormalMap(heightmap.get(), dimensions,
+                                          normal_map.get(), region);
+        RETURN_IF_ERROR(res);
+    }
+
+    m_dirty_tiles.clear();
+
+    return regions;
+}
+
+/**
+ * @brief Regenerates the whole normal map.
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
+auto HMDT::Project::HeightMapProject::regenerateNormalMap() noexcept
+    -> MaybeVoid
+{
+    auto map_data = getMapData();
+
+    auto res = generateWorldNormalMap(map_data->getHeightMap().lock().get(),
+                                      Dimensions{ map_data->getWidth(),
+                                                  map_data->getHeight() },
+                                      map_data->getNormalMap().lock().get());
+    RETURN_IF_ERROR(res);
+
+    m_dirty_tiles.clear();
+
+    return STATUS_SUCCESS;
+}
+
 /**
  * @brief Builds the project hierarchy tree for HeightMapProject
  *
@@ -2,14 +2,20 @@
 #include "HoI4Project.h"
 
 #include <fstream>
+#include <future>
 #include <iomanip>
+#include <optional>
 #include <cstring>
 #include <cerrno>
 
 #include "nlohmann/json.hpp"
 
 #include "Logger.h"
+#include "Util.h"
 #include "Constants.h"
+#include "ModReader.h"
+#include "Options.h"
+#include "RecordParser.h"
 #include "StatusCodes.h"
 
 #include "GroupNode.h"
@@ -26,7 +32,8 @@ HMDT::Project::HoI4Project::HoI4Project():
     m_tags(),
     m_overrides(),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_stream_diff_layers(false)
 { }
 
 HMDT::Project::HoI4Project::HoI4Project(const std::filesystem::path& path):
@@ -38,7 +45,8 @@ HMDT::Project::HoI4Project::HoI4Project(const std::filesystem::path& path):
     m_tags(),
     m_overrides(),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_stream_diff_layers(false)
 {
 }
 
@@ -51,7 +59,8 @@ HMDT::Project::HoI4Project::HoI4Project(HoI4Project&& other):
     m_tags(std::move(other.m_tags)),
     m_overrides(std::move(other.m_overrides)),
     m_map_project(*this),
-    m_history_project(*this)
+    m_history_project(*this),
+    m_stream_diff_layers(other.m_stream_diff_layers)
 { }
 
 const std::filesystem::path& HMDT::Project::HoI4Project::getPath() const {
@@ -142,7 +151,91 @@ auto HMDT::Project::HoI4Project::getHistoryProject() const noexcept
 }
 
 /**
- * @brief Loads a json file referenced by 'path'
+ * @brief Loads a project from the json file referenced by 'path', along with
+ *        all of its sub-projects.
+ *
+ * @param path The path to load the project file from
+ *
+ * @return True if the project file could be loaded correctly, false otherwise.
+ */
+auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
+    -> MaybeVoid
+{
+    m_stream_diff_layers = false;
+
+    auto result = loadProjectFile(path);
+    RETURN_IF_ERROR(result);
+
+    // If the data isn't there, we can still finish successfully loading, but we
+    //  will not have any of the actual project's data
+    // So just log a warning that the data might be missing and move on
+    if(!std::filesystem::exists(getMetaRoot())) {
+        WRITE_WARN("Project meta directory ", getMetaRoot(),
+                   " is missing. This folder contains the actual project "
+                   "data, so it missing could imply a loss of data. Please "
+                   "verify this path.");
+        return STATUS_SUCCESS;
+    }
+
+    // Load in sub-projects
+    result = m_map_project.load(getMapRoot());
+    RETURN_IF_ERROR(result);
+
+    result = m_history_project.load(getHistoryRoot());
+    RETURN_IF_ERROR(result);
+
+    ////////////////////////////////////////////////////////////////////////////
+
+    RETURN_ERROR_IF(!validateData(), STATUS_PROJECT_VALIDATION_FAILED);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Loads only what is needed to diff this project against another
+ *        version of it.
+ * @details None of the per-pixel layers get loaded. Instead, diff() and
+ *          renderDiff() stream them from the saved files one band at a time,
+ *          so that comparing two full-size maps does not need either of them
+ *          in memory. Projects saved with the old shape data format are loaded
+ *          in full instead.
+ *
+ * @param path The path to load the project file from
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
+auto HMDT::Project::HoI4Project::loadForDiff(const std::filesystem::path& path)
+    -> MaybeVoid
+{
+    auto result = loadProjectFile(path);
+    RETURN_IF_ERROR(result);
+
+    if(getToolVersion() <= "0.25.0"_V) {
+        WRITE_WARN("Project ", path, " was saved by tool version ",
+                   getToolVersion(), ", so it has to be loaded in full.");
+        return load(path);
+    }
+
+    if(!std::filesystem::exists(getMetaRoot())) {
+        WRITE_WARN("Project meta directory ", getMetaRoot(),
+                   " is missing, so the project has no data to compare.");
+        return STATUS_SUCCESS;
+    }
+
+    result = m_map_project.getProvinceProject().loadProvinceList(getMapRoot());
+    RETURN_IF_ERROR(result);
+
+    result = m_history_project.load(getHistoryRoot());
+    RETURN_IF_ERROR(result);
+
+    m_stream_diff_layers = true;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Loads only the project file referenced by 'path', without any of
+ *        the sub-projects.
  * @details Format of the project file should be as follows:
  * @code
  *     {
@@ -158,7 +251,7 @@ auto HMDT::Project::HoI4Project::getHistoryProject() const noexcept
  *
  * @return True if the project file could be loaded correctly, false otherwise.
  */
-auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
+auto HMDT::Project::HoI4Project::loadProjectFile(const std::filesystem::path& path)
     -> MaybeVoid
 {
     using json = nlohmann::json;
@@ -206,6 +299,7 @@ auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
             std::vector<std::string> overrides;
             proj["overrides"].get_to(overrides);
 
+            m_overrides.clear();
             std::transform(overrides.begin(), overrides.end(),
                            std::back_inserter(m_overrides),
                            [](const std::string& path) {
@@ -234,28 +328,6 @@ auto HMDT::Project::HoI4Project::load(const std::filesystem::path& path)
         RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
     }
 
-    // If the data isn't there, we can still finish successfully loading, but we
-    //  will not have any of the actual project's data
-    // So just log a warning that the data might be missing and move on
-    if(!std::filesystem::exists(getMetaRoot())) {
-        WRITE_WARN("Project meta directory ", getMetaRoot(),
-                   " is missing. This folder contains the actual project "
-                   "data, so it missing could imply a loss of data. Please "
-                   "verify this path.");
-        return STATUS_SUCCESS;
-    }
-
-    // Load in sub-projects
-    auto result = m_map_project.load(getMapRoot());
-    RETURN_IF_ERROR(result);
-
-    result = m_history_project.load(getHistoryRoot());
-    RETURN_IF_ERROR(result);
-
-    ////////////////////////////////////////////////////////////////////////////
-
-    RETURN_ERROR_IF(!validateData(), STATUS_PROJECT_VALIDATION_FAILED);
-
     return STATUS_SUCCESS;
 }
 
@@ -382,6 +454,526 @@ auto HMDT::Project::HoI4Project::export_(const std::filesystem::path& root) cons
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Imports the map and states of an existing mod (or of the base game)
+ *        into this project, replacing any which are already loaded.
+ * @details Reads map/provinces.bmp, map/definition.csv, map/continent.txt,
+ *          map/heightmap.bmp, map/rivers.bmp and every file in history/states.
+ *          Only provinces.bmp and definition.csv are required. The files are
+ *          all read and parsed at the same time before anything is replaced,
+ *          so a mod which fails to parse leaves the project untouched.
+ *
+ * @param root The root folder of the mod
+ *
+ * @return STATUS_SUCCESS on success, or an error code if any file could not be
+ *         read or imported.
+ */
+auto HMDT::Project::HoI4Project::importMod(const std::filesystem::path& root) noexcept
+    -> MaybeVoid
+{
+    auto map_root = root / "map";
+    auto states_root = root / "history" / "states";
+
+    WRITE_INFO("Importing mod from ", root);
+
+    auto provinces_image = std::make_shared<BitMap2>();
+    auto image_future = std::async(std::launch::async,
+        [&map_root, provinces_image]() -> MaybeVoid {
+            auto res = readBMP(map_root / PROVINCES_FILENAME, *provinces_image);
+            RETURN_IF_ERROR(res);
+
+            return STATUS_SUCCESS;
+        });
+
+    auto definitions_future = std::async(std::launch::async,
+        [&map_root]() -> Maybe<std::vector<ProvinceDefinition>> {
+            auto contents = readFileToString(map_root / PROVINCEDATA_FILENAME);
+            RETURN_IF_ERROR(contents);
+
+            return parseProvinceDefinitions(*contents);
+        });
+
+    auto continents_future = std::async(std::launch::async,
+        [&map_root]() -> Maybe<std::vector<std::string>> {
+            auto path = map_root / CONTINENT_FILENAME;
+            if(std::error_code ec; !std::filesystem::exists(path, ec)) {
+                WRITE_WARN("File ", path, " does not exist, no continents will be imported.");
+                return std::vector<std::string>{};
+            }
+
+            auto contents = readFileToString(path);
+            RETURN_IF_ERROR(contents);
+
+            return parseContinents(*contents);
+        });
+
+    auto states_future = std::async(std::launch::async,
+        [&states_root]() -> Maybe<std::vector<StateDefinition>> {
+            if(std::error_code ec; !std::filesystem::is_directory(states_root, ec)) {
+                WRITE_WARN("Folder ", states_root, " does not exist, no states will be imported.");
+                return std::vector<StateDefinition>{};
+            }
+
+            return readStateDefinitions(states_root);
+        });
+
+    // Wait for every file, even if one fails, so that nothing is left running
+    //   with references to this stack frame
+    auto image_result = image_future.get();
+    auto definitions = definitions_future.get();
+    auto continents = continents_future.get();
+    auto states = states_future.get();
+
+    RETURN_IF_ERROR(image_result);
+    RETURN_IF_ERROR(definitions);
+    RETURN_IF_ERROR(continents);
+    RETURN_IF_ERROR(states);
+
+    WRITE_INFO("Read ", definitions->size(), " provinces, ", continents->size(),
+               " continents, and ", states->size(), " states.");
+
+    auto result = m_map_project.importMod(*provinces_image, *definitions,
+                                          *continents, map_root);
+    RETURN_IF_ERROR(result);
+
+    result = m_history_project.getStateProject().importStates(*states);
+    RETURN_IF_ERROR(result);
+
+    // Clean up only once the states are known, so that every split off piece
+    //   stays in the same state as the province it came from
+    if(prog_opts.absorb_tiny_provinces) {
+        auto absorbed = m_map_project.getProvinceProject().absorbTinyProvinces();
+        RETURN_IF_ERROR(absorbed);
+    }
+
+    if(prog_opts.split_oversized_provinces) {
+        auto edit = m_map_project.getProvinceProject().splitOversizedProvinces();
+        RETURN_IF_ERROR(edit);
+    }
+
+    // The province map is needed again when the project is next loaded
+    auto inputs_root = getInputsRoot();
+    std::error_code ec;
+    if(!std::filesystem::exists(inputs_root, ec)) {
+        std::filesystem::create_directories(inputs_root, ec);
+        RETURN_ERROR_IF(ec.value() != 0, ec);
+    }
+
+    std::filesystem::copy_file(map_root / PROVINCES_FILENAME,
+                               inputs_root / INPUT_PROVINCEMAP_FILENAME,
+                               std::filesystem::copy_options::overwrite_existing,
+                               ec);
+    RETURN_ERROR_IF(ec.value() != 0, ec);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Replaces every province and state with provinces generated from a
+ *        land, sea and lake mask.
+ *
+ * @param mask_path The path to the mask
+ * @param density_path The path to an image saying how densely to fill every
+ *                     part of the map (such as a heightmap), or an empty path
+ *                     to fill it evenly
+ * @param options The options to generate the provinces with
+ *
+ * @return STATUS_SUCCESS on success, or an error code if either image could
+ *         not be read or the provinces could not be generated.
+ */
+auto HMDT::Project::HoI4Project::generateProvinces(const std::filesystem::path& mask_path,
+                                                   const std::filesystem::path& density_path,
+                                                   const ProvinceGeneratorOptions& options) noexcept
+    -> MaybeVoid
+{
+    WRITE_INFO("Generating provinces from ", mask_path);
+
+    BitMap2 mask;
+    auto mask_future = std::async(std::launch::async,
+        [&mask_path, &mask]() -> MaybeVoid {
+            auto res = readBMP(mask_path, mask);
+            RETURN_IF_ERROR(res);
+
+            return STATUS_SUCCESS;
+        });
+
+    std::optional<BitMap2> density;
+    if(!density_path.empty()) {
+        density.emplace();
+
+        auto res = readBMP(density_path, *density);
+        RETURN_IF_ERROR(res);
+
+        if(density->info_header.v1.bitsPerPixel != 8) {
+            auto result = convertBitMapTo8BPPGreyscale(*density);
+            RETURN_IF_ERROR(result);
+        }
+    }
+
+    auto mask_result = mask_future.get();
+    RETURN_IF_ERROR(mask_result);
+
+    auto result = m_map_project.generateProvinces(mask,
+                                                  density ? &*density : nullptr,
+                                                  options);
+    RETURN_IF_ERROR(result);
+
+    // None of the old states refer to provinces which still exist
+    result = m_history_project.getStateProject().importStates({ });
+    RETURN_IF_ERROR(result);
+
+    if(prog_opts.absorb_tiny_provinces) {
+        auto absorbed = m_map_project.getProvinceProject().absorbTinyProvinces();
+        RETURN_IF_ERROR(absorbed);
+    }
+
+    if(prog_opts.split_oversized_provinces) {
+        auto edit = m_map_project.getProvinceProject().splitOversizedProvinces();
+        RETURN_IF_ERROR(edit);
+    }
+
+    // The province map is needed again when the project is next loaded
+    auto inputs_root = getInputsRoot();
+    std::error_code ec;
+    if(!std::filesystem::exists(inputs_root, ec)) {
+        std::filesystem::create_directories(inputs_root, ec);
+        RETURN_ERROR_IF(ec.value() != 0, ec);
+    }
+
+    auto map_data = m_map_project.getMapData();
+    auto [width, height] = map_data->getDimensions();
+
+    result = writeBMP2(inputs_root / INPUT_PROVINCEMAP_FILENAME,
+                       map_data->getInput().lock().get(), width, height);
+    RETURN_IF_ERROR(result);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Renders the map in the given map mode.
+ * @details Borders which are not set in the options are drawn the same way as
+ *          the view for that map mode in the GUI draws them.
+ *
+ * @param mode The map mode to render
+ * @param options How to render the map
+ *
+ * @return The rendered image, or an error code if the map could not be
+ *         rendered.
+ */
+auto HMDT::Project::HoI4Project::renderMap(MapMode mode,
+                                           const MapRenderOptions& options) const noexcept
+    -> Maybe<RenderedMap>
+{
+    auto map_data = m_map_project.getMapData();
+    RETURN_ERROR_IF(map_data == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto provinces_matrix = map_data->getProvinces().lock();
+    auto state_id_matrix = map_data->getStateIDMatrix().lock();
+    auto heightmap = map_data->getHeightMap().lock();
+
+    MapRenderLayers layers{
+        Dimensions{ map_data->getWidth(), map_data->getHeight() },
+        provinces_matrix.get(),
+        state_id_matrix.get(),
+        nullptr
+    };
+
+    MapRenderOptions resolved_options = options;
+    auto draw_province_borders = [&](bool draw) {
+        resolved_options.draw_province_borders = options.draw_province_borders.value_or(draw);
+    };
+    auto draw_state_borders = [&](bool draw) {
+        resolved_options.draw_state_borders = options.draw_state_borders.value_or(draw);
+    };
+
+    const auto& provinces = m_map_project.getProvinceProject().getProvinces();
+    const auto& states = m_history_project.getStateProject().getStates();
+    const auto& terrain_project = m_map_project.getTerrainProject();
+
+    std::unordered_map<ProvinceID, Color> province_colors;
+    province_colors.reserve(provinces.size());
+
+    for(auto&& [id, province] : provinces) {
+        auto is_water = province.type == ProvinceType::SEA ||
+                        province.type == ProvinceType::LAKE;
+        Color color = PROVINCE_OUTLINE_COLOR;
+
+        switch(mode) {
+            case MapMode::PROVINCES:
+            case MapMode::HEIGHTMAP:
+                color = province.unique_color;
+                break;
+            case MapMode::STATES:
+                if(auto it = states.find(province.state); it != states.end()) {
+                    color = it->second.color;
+                }
+                break;
+            case MapMode::CONTINENTS:
+                color = is_water ? RENDER_WATER_COLOR
+                                 : colorFromString(province.continent);
+                break;
+            case MapMode::TERRAIN:
+                color = terrain_project.getTerrainColor(province.terrain);
+                break;
+            case MapMode::COASTAL:
+                color = is_water ? RENDER_WATER_COLOR
+                                 : (province.coastal ? RENDER_COASTAL_COLOR
+                                                     : RENDER_INLAND_COLOR);
+                break;
+        }
+
+        province_colors[id] = color;
+    }
+
+    switch(mode) {
+        case MapMode::PROVINCES:
+        case MapMode::TERRAIN:
+        case MapMode::CONTINENTS:
+        case MapMode::COASTAL:
+            draw_province_borders(true);
+            draw_state_borders(false);
+            break;
+        case MapMode::STATES:
+            draw_province_borders(false);
+            draw_state_borders(true);
+            break;
+        case MapMode::HEIGHTMAP:
+            layers.heightmap = heightmap.get();
+            RETURN_ERROR_IF(layers.heightmap == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+            draw_province_borders(false);
+            draw_state_borders(false);
+            break;
+    }
+
+    WRITE_INFO("Rendering the map in mode '", mode, "' at scale ", options.scale);
+
+    return HMDT::renderMap(layers, province_colors, resolved_options);
+}
+
+/**
+ * @brief Finds everything that changed between another version of this
+ *        project and this one.
+ *
+ * @param old_project The older version of this project
+ *
+ * @return Everything that changed going from old_project to this project
+ */
+auto HMDT::Project::HoI4Project::diff(const HoI4Project& old_project) const noexcept
+    -> Maybe<ProjectDiff>
+{
+    WRITE_INFO("Comparing against ", old_project.getPath());
+
+    auto old_layers = old_project.getDiffLayers();
+    RETURN_IF_ERROR(old_layers);
+
+    auto new_layers = getDiffLayers();
+    RETURN_IF_ERROR(new_layers);
+
+    auto diff = diffProjectLayers(*old_layers, *new_layers);
+    RETURN_IF_ERROR(diff);
+
+    auto join_paths = [](const std::vector<std::filesystem::path>& paths) {
+        std::vector<std::string> strings;
+        for(auto&& path : paths) {
+            strings.push_back(path.generic_string());
+        }
+
+        return join(strings.begin(), strings.end(), ", ");
+    };
+
+    auto add_if_changed = [&diff](const std::string& name,
+                                  const std::string& old_value,
+                                  const std::string& new_value)
+    {
+        if(old_value != new_value) {
+            diff->metadata.push_back(PropertyChange{ name, old_value, new_value });
+        }
+    };
+
+    add_if_changed("name", old_project.m_name, m_name);
+    add_if_changed("tool_version", old_project.m_tool_version.str(),
+                                   m_tool_version.str());
+    add_if_changed("hoi4_version", old_project.m_hoi4_version.str(),
+                                   m_hoi4_version.str());
+    add_if_changed("tags",
+                   join(old_project.m_tags.begin(), old_project.m_tags.end(), ", "),
+                   join(m_tags.begin(), m_tags.end(), ", "));
+    add_if_changed("overrides", join_paths(old_project.m_overrides),
+                                join_paths(m_overrides));
+
+    WRITE_INFO("Found ", diff->provinces.size(), " changed provinces and ",
+               diff->states.size(), " changed states.");
+
+    return diff;
+}
+
+/**
+ * @brief Renders where the map changed between another version of this
+ *        project and this one.
+ *
+ * @param old_project The older version of this project
+ * @param diff The diff returned by diff(old_project)
+ *
+ * @return The rendered image
+ */
+auto HMDT::Project::HoI4Project::renderDiff(const HoI4Project& old_project,
+                                            const ProjectDiff& diff) const noexcept
+    -> Maybe<RenderedMap>
+{
+    auto old_layers = old_project.getDiffLayers();
+    RETURN_IF_ERROR(old_layers);
+
+    auto new_layers = getDiffLayers();
+    RETURN_IF_ERROR(new_layers);
+
+    return renderProjectDiff(*old_layers, *new_layers, diff);
+}
+
+/**
+ * @brief Traces the borders between every province and every state into
+ *        vector lines.
+ *
+ * @param tolerance How far, in pixels, the simplified borders may stray from
+ *                  the borders on the map. 0 keeps them exact.
+ *
+ * @return The province borders followed by the state borders, or an error
+ *         code if they could not be traced.
+ */
+auto HMDT::Project::HoI4Project::extractBorders(double tolerance) const noexcept
+    -> Maybe<std::vector<BorderLayer>>
+{
+    auto map_data = m_map_project.getMapData();
+    RETURN_ERROR_IF(map_data == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    Dimensions dimensions{ map_data->getWidth(), map_data->getHeight() };
+
+    auto provinces_matrix = map_data->getProvinces().lock();
+    auto state_id_matrix = map_data->getStateIDMatrix().lock();
+
+    const auto& province_project = m_map_project.getProvinceProject();
+    const auto& provinces = province_project.getProvinces();
+    const auto& states = m_history_project.getStateProject().getStates();
+
+    // Provinces are named by the ID they get exported with, and states by
+    //   their own ID
+    auto province_label = [&](uint64_t pixel) -> std::string {
+        if(pixel == BORDER_OUTSIDE_MAP) return "";
+
+        const auto& id = provinces_matrix[pixel];
+        return provinces.count(id) != 0
+                   ? std::to_string(province_project.getIDForProvinceID(id))
+                   : "";
+    };
+    auto state_label = [&](uint64_t pixel) -> std::string {
+        if(pixel == BORDER_OUTSIDE_MAP) return "";
+
+        auto id = state_id_matrix[pixel];
+        return states.count(id) != 0 ? std::to_string(id) : "";
+    };
+
+    std::vector<BorderLayer> layers(2);
+    layers[0].name = "provinces";
+    layers[1].name = "states";
+
+    WRITE_INFO("Tracing province borders...");
+    auto province_arcs = HMDT::extractBorders(dimensions, provinces_matrix.get());
+    RETURN_IF_ERROR(province_arcs);
+    layers[0].arcs = std::move(*province_arcs);
+
+    WRITE_INFO("Tracing state borders...");
+    auto state_arcs = HMDT::extractBorders(dimensions, state_id_matrix.get());
+    RETURN_IF_ERROR(state_arcs);
+    layers[1].arcs = std::move(*state_arcs);
+
+    auto finish_layer = [tolerance](BorderLayer& layer, const auto& get_label)
+        -> MaybeVoid
+    {
+        auto result = simplifyBorders(layer.arcs, tolerance);
+        RETURN_IF_ERROR(result);
+
+        layer.arc_labels.reserve(layer.arcs.size());
+        for(auto&& arc : layer.arcs) {
+            layer.arc_labels.emplace_back(get_label(arc.left_pixel),
+                                          get_label(arc.right_pixel));
+        }
+
+        WRITE_INFO("Traced ", layer.arcs.size(), " ", layer.name, " borders.");
+
+        return STATUS_SUCCESS;
+    };
+
+    auto result = finish_layer(layers[0], province_label);
+    RETURN_IF_ERROR(result);
+
+    result = finish_layer(layers[1], state_label);
+    RETURN_IF_ERROR(result);
+
+    return layers;
+}
+
+/**
+ * @brief Gets every layer and list of this project which gets compared when
+ *        diffing.
+ * @details If the project was loaded with loadForDiff then the per-pixel
+ *          layers are streamed from the saved files. Otherwise they stay owned
+ *          by the MapData, so they are only valid for as long as it does not
+ *          get replaced.
+ *
+ * @return The layers, or an error code if the saved layers could not be
+ *         opened
+ */
+auto HMDT::Project::HoI4Project::getDiffLayers() const noexcept
+    -> Maybe<ProjectDiffLayers>
+{
+    ProjectDiffLayers layers{ };
+    layers.province_list = &m_map_project.getProvinceProject().getProvinces();
+    layers.state_list = &m_history_project.getStateProject().getStates();
+
+    if(m_stream_diff_layers) {
+        auto map_root = getMapRoot();
+
+        auto provinces = readBandsFromShapeData(map_root / SHAPEDATA_FILENAME,
+                                                layers.dimensions);
+        RETURN_IF_ERROR(provinces);
+        layers.provinces = std::move(*provinces);
+
+        // The heightmap and rivers are optional, so they are only compared if
+        //   they were saved in a form that can be streamed
+        auto read_optional = [&](const std::string& filename)
+            -> LayerBandReader<uint8_t>
+        {
+            auto path = map_root / filename;
+            if(std::error_code ec; !std::filesystem::exists(path, ec)) {
+                return nullptr;
+            }
+
+            auto reader = readBandsFromBitMap(path, layers.dimensions);
+            if(IS_FAILURE(reader)) {
+                WRITE_WARN("Unable to stream ", path, ", so it will not be compared.");
+                return nullptr;
+            }
+
+            return *reader;
+        };
+
+        layers.heightmap = read_optional(HEIGHTMAP_FILENAME);
+        layers.rivers = read_optional(RIVERS_FILENAME);
+    } else if(auto map_data = m_map_project.getMapData(); map_data != nullptr) {
+        layers.dimensions = Dimensions{ map_data->getWidth(),
+                                        map_data->getHeight() };
+        layers.provinces = readBandsFromMemory(map_data->getProvinces().lock().get(),
+                                               layers.dimensions);
+        layers.heightmap = readBandsFromMemory(map_data->getHeightMap().lock().get(),
+                                               layers.dimensions);
+        layers.rivers = readBandsFromMemory(map_data->getRivers().lock().get(),
+                                            layers.dimensions);
+    }
+
+    return layers;
+}
+
 HMDT::MaybeVoid HMDT::Project::HoI4Project::load() {
     return load(m_path);
 }
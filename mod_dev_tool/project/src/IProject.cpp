@@ -570,3 +570,19 @@ bool HMDT::Project::IContinentProject::doesContinentExist(const std::string& con
     return getContinentList().count(continent) != 0;
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool HMDT::Project::IStrategicRegionProject::isValidStrategicRegionID(StrategicRegionID region_id) const
+{
+    return getStrategicRegions().count(region_id) != 0;
+}
+
+auto HMDT::Project::IStrategicRegionProject::getStrategicRegionForID(StrategicRegionID region_id) const
+    -> MaybeRef<const StrategicRegion>
+{
+    if(isValidStrategicRegionID(region_id)) {
+        return std::ref(getStrategicRegions().at(region_id));
+    }
+    return STATUS_STRATEGIC_REGION_DOES_NOT_EXIST;
+}
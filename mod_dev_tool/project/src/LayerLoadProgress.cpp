@@ -0,0 +1,71 @@
+
+#include "LayerLoadProgress.h"
+
+HMDT::Project::LayerLoadProgress::LayerLoadProgress():
+    m_stage(Stage::START),
+    m_do_estop(false),
+    m_stage_callback([](Stage) { })
+{ }
+
+/**
+ * @brief Moves the load on to the next stage, and notifies the stage callback.
+ *
+ * @param stage The new stage
+ */
+void HMDT::Project::LayerLoadProgress::setStage(Stage stage) {
+    m_stage = stage;
+    m_stage_callback(stage);
+}
+
+auto HMDT::Project::LayerLoadProgress::getStage() const noexcept -> Stage {
+    return m_stage;
+}
+
+/**
+ * @brief Gets roughly how far along the load is.
+ *
+ * @return A value between 0 and 1, based only on the current stage.
+ */
+float HMDT::Project::LayerLoadProgress::getFraction() const noexcept {
+    return static_cast<float>(getStage()) / static_cast<float>(Stage::DONE);
+}
+
+/**
+ * @brief Asks the load to stop as soon as the current stage finishes.
+ */
+void HMDT::Project::LayerLoadProgress::estop() noexcept {
+    m_do_estop = true;
+}
+
+bool HMDT::Project::LayerLoadProgress::isStopped() const noexcept {
+    return m_do_estop;
+}
+
+/**
+ * @brief Sets the callback to run every time the stage changes.
+ * @details Must be set before the load is started, as the callback gets called
+ *          from the worker thread.
+ *
+ * @param callback The callback
+ */
+void HMDT::Project::LayerLoadProgress::setStageCallback(const StageCallback& callback)
+{
+    m_stage_callback = callback;
+}
+
+std::string HMDT::Project::toString(const LayerLoadProgress::Stage& stage) {
+    switch(stage) {
+        case LayerLoadProgress::Stage::START:
+            return "Start";
+        case LayerLoadProgress::Stage::READING:
+            return "Reading";
+        case LayerLoadProgress::Stage::CONVERTING:
+            return "Converting";
+        case LayerLoadProgress::Stage::PROCESSING:
+            return "Processing";
+        case LayerLoadProgress::Stage::DONE:
+            return "Done";
+        default:
+            return "<ERROR: INVALID STAGE>";
+    }
+}
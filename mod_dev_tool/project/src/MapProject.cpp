@@ -2,9 +2,14 @@
 #include "MapProject.h"
 
 #include <fstream>
+#include <map>
+#include <sstream>
+#include <iomanip>
 #include <cstring>
 #include <cerrno>
 
+#include "nlohmann/json.hpp"
+
 #include "Options.h"
 #include "Logger.h"
 #include "Constants.h"
@@ -12,6 +17,7 @@
 #include "StatusCodes.h"
 
 #include "ProvinceMapBuilder.h"
+#include "RecordWriter.h"
 
 #include "HoI4Project.h"
 
@@ -23,9 +29,15 @@ HMDT::Project::MapProject::MapProject(IProject& parent_project):
     m_continent_project(*this),
     m_heightmap_project(*this),
     m_rivers_project(*this),
+    m_terrain_project(*this),
+    m_strategic_region_project(*this),
     m_map_data(new MapData),
     m_terrains(getDefaultTerrains()),
-    m_parent_project(parent_project)
+    m_parent_project(parent_project),
+    m_max_strait_width(DEFAULT_MAX_STRAIT_WIDTH),
+    m_province_statistics(),
+    m_valid_province_statistics(0),
+    m_province_statistics_dimensions{0, 0}
 {
 }
 
@@ -73,6 +85,15 @@ auto HMDT::Project::MapProject::save(const std::filesystem::path& path)
     }
     RETURN_IF_ERROR(result);
 
+    result = m_terrain_project.save(path);
+    if(result == STATUS_NO_DATA_LOADED) {
+        result = STATUS_SUCCESS;
+    }
+    RETURN_IF_ERROR(result);
+
+    result = m_strategic_region_project.save(path);
+    RETURN_IF_ERROR(result);
+
     return result;
 }
 
@@ -122,6 +143,7 @@ auto HMDT::Project::MapProject::load(const std::filesystem::path& path)
         //  references are also updated too
         m_map_data->~MapData();
         new (m_map_data.get()) MapData(iwidth, iheight);
+        invalidateProvinceStatistics(ZONAL_LAYER_ALL);
     }
 
     auto input_data = m_map_data->getInput().lock();
@@ -154,6 +176,18 @@ auto HMDT::Project::MapProject::load(const std::filesystem::path& path)
         RETURN_IF_ERROR(result);
     }
 
+    if(auto result = m_terrain_project.load(path);
+            result.error() != std::errc::no_such_file_or_directory)
+    {
+        RETURN_IF_ERROR(result);
+    }
+
+    if(auto result = m_strategic_region_project.load(path);
+            result.error() != std::errc::no_such_file_or_directory)
+    {
+        RETURN_IF_ERROR(result);
+    }
+
     return STATUS_SUCCESS;
 }
 
@@ -187,18 +221,43 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
     result = m_rivers_project.export_(root);
     RETURN_IF_ERROR(result);
 
+    result = m_terrain_project.export_(root);
+    RETURN_IF_ERROR(result);
+
+    result = m_strategic_region_project.export_(root);
+    RETURN_IF_ERROR(result);
+
     ////////////////////////////////////////////////////////////////////////////
     // TODO: These are files that will still be required by HoI4, but which we
     //  have no editing capabilities for and which can be left blank
 
     // Adjacencies
     {
+        auto straits = findStraits();
+        RETURN_IF_ERROR(straits);
+
         // adjacencies.csv
-        if(std::ofstream adjacencies(root / "adjacencies.csv"); adjacencies) {
-            adjacencies << "From;To;Type;Through;start_x;start_y;stop_x;stop_y;adjacency_rule_name;Comment";
-            // TODO
+        if(std::ofstream adjacencies(root / ADJACENCIES_FILENAME); adjacencies) {
+            adjacencies << "From;To;Type;Through;start_x;start_y;stop_x;stop_y;adjacency_rule_name;Comment\n";
+
+            // HoI4 puts the origin of the map in the bottom-left corner
+            auto height = getMapData()->getHeight();
+
+            for(auto&& strait : *straits) {
+                adjacencies << m_provinces_project.getIDForProvinceID(strait.from) << ';'
+                            << m_provinces_project.getIDForProvinceID(strait.to) << ';'
+                            << "sea;"
+                            << m_provinces_project.getIDForProvinceID(strait.through) << ';'
+                            << strait.start.x << ';' << (height - 1 - strait.start.y) << ';'
+                            << strait.stop.x << ';' << (height - 1 - strait.stop.y) << ';'
+                            << ';'
+                            << "Generated strait\n";
+            }
+
+            // The file has to be terminated with this line
+            adjacencies << "-1;-1;;-1;-1;-1;-1;-1;-1\n";
         } else {
-            WRITE_ERROR("Failed to open file ", root / "adjacencies.csv");
+            WRITE_ERROR("Failed to open file ", root / ADJACENCIES_FILENAME);
             RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
         }
 
@@ -212,6 +271,44 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
         }
     }
 
+    // Supply
+    {
+        auto network = buildSupplyNetwork();
+        RETURN_IF_ERROR(network);
+
+        // supply_nodes.txt
+        if(std::ofstream supply_nodes(root / SUPPLY_NODES_FILENAME); supply_nodes)
+        {
+            // Level ProvinceID
+            // NOTE: Level is defined as 1 by default. This is only changed
+            //   in common/buildings/00_buildings.txt, so we will need to
+            //   limit the max to whatever is defined in there (either the
+            //   vanilla version or an overridden version defined in this
+            //   mod)
+            for(auto&& id : network->supply_nodes) {
+                supply_nodes << "1 " << m_provinces_project.getIDForProvinceID(id) << '\n';
+            }
+        } else {
+            WRITE_ERROR("Failed to open file ", root / SUPPLY_NODES_FILENAME);
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
+
+        // railways.txt
+        if(std::ofstream railways(root / RAILWAYS_FILENAME); railways) {
+            // Level NumProvinces ProvinceID...
+            for(auto&& railway : network->railways) {
+                railways << "1 " << railway.size();
+                for(auto&& id : railway) {
+                    railways << ' ' << m_provinces_project.getIDForProvinceID(id);
+                }
+                railways << '\n';
+            }
+        } else {
+            WRITE_ERROR("Failed to open file ", root / RAILWAYS_FILENAME);
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
+    }
+
     // Buildings
     {
         // NOTE: These files can be modified with the Nudge tool, but they need to
@@ -219,10 +316,107 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
         //  (otherwise the game could crash)
         // TODO: Do we want to try and replicate the Nudge tool?
 
+        auto label_points = findLabelPoints();
+        RETURN_IF_ERROR(label_points);
+
+        const auto& states = getRootParent().getHistoryProject().getStateProject().getStates();
+        const auto& provinces = m_provinces_project.getProvinces();
+
+        // HoI4 puts the origin of the map in the bottom-left corner, and
+        //   positions are written as X;Height;Y
+        auto height = getMapData()->getHeight();
+        auto write_position = [height](std::ostream& out, const LabelPoint& point)
+            -> std::ostream&
+        {
+            return out << point.position.x << ';'
+                       << (point.height * HEIGHTMAP_WORLD_SCALE) << ';'
+                       << (height - 1 - point.position.y);
+        };
+
+        // The province in every state with the most room around it, which is
+        //   where all of the state-wide buildings go
+        std::map<StateID, ProvinceID> state_centers;
+        for(auto&& [state_id, state] : states) {
+            const LabelPoint* best = nullptr;
+            for(auto&& id : state.provinces) {
+                if(auto it = label_points->find(id);
+                        it != label_points->end() &&
+                        (best == nullptr || it->second.radius > best->radius))
+                {
+                    best = &it->second;
+                    state_centers[state_id] = id;
+                }
+            }
+        }
+
         // buildings.txt
         if(std::ofstream buildings(root / "buildings.txt"); buildings) {
-            // State ID (integer); building ID (string); X position; Y position; Z position; Rotation; Adjacent sea province (integer)
-            buildings << "1;arms_factory;0;0;0;0;0";
+            // Buildings which only have one model for the entire state
+            // NOTE: Custom buildings defined by the mod are not placed yet
+            constexpr std::string_view STATE_BUILDINGS[] = {
+                "arms_factory", "industrial_complex", "dockyard", "air_base",
+                "anti_air_building", "synthetic_refinery", "fuel_silo",
+                "radar_station", "rocket_site", "nuclear_reactor"
+            };
+
+            bool wrote_any = false;
+
+            // State ID (integer); building ID (string); X position; Height; Y position; Rotation; Adjacent sea province (integer)
+            for(auto&& [state_id, state] : states) {
+                if(auto it = state_centers.find(state_id); it != state_centers.end())
+                {
+                    const auto& point = label_points->at(it->second);
+                    for(auto&& building : STATE_BUILDINGS) {
+                        buildings << state_id << ';' << building << ';';
+                        write_position(buildings, point) << ";0;0\n";
+                    }
+                    wrote_any = true;
+                }
+
+                // Buildings which have a model in every province
+                for(auto&& id : state.provinces) {
+                    auto pit = provinces.find(id);
+                    auto lit = label_points->find(id);
+                    if(pit == provinces.end() || lit == label_points->end() ||
+                       pit->second.type != ProvinceType::LAND)
+                    {
+                        continue;
+                    }
+
+                    buildings << state_id << ";bunker;";
+                    write_position(buildings, lit->second) << ";0;0\n";
+                    wrote_any = true;
+
+                    if(!pit->second.coastal) continue;
+
+                    // Naval bases need to know which sea they open onto, so
+                    //   pick the lowest numbered one for a stable export
+                    uint32_t sea_id = 0;
+                    for(auto&& adj_id : pit->second.adjacent_provinces) {
+                        if(auto ait = provinces.find(adj_id);
+                                ait != provinces.end() &&
+                                ait->second.type == ProvinceType::SEA)
+                        {
+                            auto adj_num = m_provinces_project.getIDForProvinceID(adj_id);
+                            if(sea_id == 0 || adj_num < sea_id) {
+                                sea_id = adj_num;
+                            }
+                        }
+                    }
+
+                    buildings << state_id << ";coastal_bunker;";
+                    write_position(buildings, lit->second) << ";0;0\n";
+
+                    if(sea_id != 0) {
+                        buildings << state_id << ";naval_base;";
+                        write_position(buildings, lit->second) << ";0;" << sea_id << '\n';
+                    }
+                }
+            }
+
+            if(!wrote_any) {
+                buildings << "1;arms_factory;0;0;0;0;0";
+            }
         } else {
             WRITE_ERROR("Failed to open file ", root / "buildings.txt");
             RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
@@ -232,7 +426,14 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
         //  Which province the airports appear in for each state
         if(std::ofstream airports(root / "airports.txt"); airports) {
             // State ID (integer)={province id }
-            airports << "1={1 }";
+            for(auto&& [state_id, id] : state_centers) {
+                airports << state_id << "={"
+                         << m_provinces_project.getIDForProvinceID(id) << " }\n";
+            }
+
+            if(state_centers.empty()) {
+                airports << "1={1 }";
+            }
         } else {
             WRITE_ERROR("Failed to open file ", root / "airports.txt");
             RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
@@ -242,11 +443,39 @@ auto HMDT::Project::MapProject::export_(const std::filesystem::path& root) const
         //  Which province the rocketsites appear in for each state
         if(std::ofstream rocketsites(root / "rocketsites.txt"); rocketsites) {
             // State ID (integer)={province id }
-            rocketsites << "1={1 }";
+            for(auto&& [state_id, id] : state_centers) {
+                rocketsites << state_id << "={"
+                            << m_provinces_project.getIDForProvinceID(id) << " }\n";
+            }
+
+            if(state_centers.empty()) {
+                rocketsites << "1={1 }";
+            }
         } else {
             WRITE_ERROR("Failed to open file ", root / "rocketsites.txt");
             RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
         }
+
+        // unitstacks.txt
+        //  Where units stand in each province
+        if(std::ofstream unitstacks(root / UNITSTACKS_FILENAME); unitstacks) {
+            // Write them out in the same order as definition.csv
+            std::map<uint32_t, const LabelPoint*> ordered_points;
+            for(auto&& [id, point] : *label_points) {
+                ordered_points[m_provinces_project.getIDForProvinceID(id)] = &point;
+            }
+
+            // Province ID (integer); Type (integer); X position; Height; Y position; Rotation; Offset
+            // NOTE: Only type 0 (a unit standing still) is generated, the rest
+            //   are left to the Nudge tool
+            for(auto&& [num_id, point] : ordered_points) {
+                unitstacks << num_id << ";0;";
+                write_position(unitstacks, *point) << ";0;0\n";
+            }
+        } else {
+            WRITE_ERROR("Failed to open file ", root / UNITSTACKS_FILENAME);
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
     }
 
     // Cities
@@ -409,10 +638,146 @@ void HMDT::Project::MapProject::import(const ShapeFinder& sf,
     // Do a placement new to make sure that we use the same memory location
     m_map_data->~MapData();
     new (m_map_data.get()) MapData(map_data.get());
+    invalidateProvinceStatistics(ZONAL_LAYER_ALL);
 
     {
         m_provinces_project.import(sf, map_data);
+        m_strategic_region_project.import(sf, map_data);
+    }
+}
+
+/**
+ * @brief Replaces all map data with that of an existing mod
+ *
+ * @param provinces_image The mod's provinces.bmp
+ * @param definitions Every province in the mod's definition.csv
+ * @param continents Every continent in the mod's continent.txt, in order
+ * @param map_root The mod's map folder. The heightmap, rivers map and terrain
+ *                 map are also loaded from here if they exist.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if any part of the map
+ *         could not be imported.
+ */
+auto HMDT::Project::MapProject::importMod(const BitMap2& provinces_image,
+                                          const std::vector<ProvinceDefinition>& definitions,
+                                          const std::vector<std::string>& continents,
+                                          const std::filesystem::path& map_root) noexcept
+    -> MaybeVoid
+{
+    if(auto bpp = provinces_image.info_header.v1.bitsPerPixel; bpp != 24) {
+        WRITE_ERROR("Province maps must be 24-bit images, not ", bpp, '.');
+        RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+    }
+
+    uint32_t width = provinces_image.info_header.v1.width;
+    uint32_t height = provinces_image.info_header.v1.height;
+
+    // Do a placement new so we keep the same memory location but update all
+    //  of the data inside the shared MapData instead, so that all
+    //  references are also updated too
+    m_map_data->~MapData();
+    new (m_map_data.get()) MapData(width, height);
+    invalidateProvinceStatistics(ZONAL_LAYER_ALL);
+
+    auto input_data = m_map_data->getInput().lock();
+    std::copy(provinces_image.data.get(),
+              provinces_image.data.get() + m_map_data->getInputSize(),
+              input_data.get());
+
+    m_continent_project.getContinents() = IContinentProject::ContinentSet(continents.begin(),
+                                                                          continents.end());
+
+    auto result = m_provinces_project.importProvinces(definitions, continents);
+    RETURN_IF_ERROR(result);
+
+    if(std::error_code ec; std::filesystem::exists(map_root / HEIGHTMAP_FILENAME, ec))
+    {
+        result = m_heightmap_project.loadFile(map_root / HEIGHTMAP_FILENAME);
+        RETURN_IF_ERROR(result);
+    }
+
+    if(std::error_code ec; std::filesystem::exists(map_root / RIVERS_FILENAME, ec))
+    {
+        result = m_rivers_project.loadFile(map_root / RIVERS_FILENAME);
+        RETURN_IF_ERROR(result);
+    }
+
+    if(std::error_code ec; std::filesystem::exists(map_root / TERRAIN_FILENAME, ec))
+    {
+        result = m_terrain_project.loadFile(map_root / TERRAIN_FILENAME);
+        RETURN_IF_ERROR(result);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Replaces all map data with provinces generated from a land, sea and
+ *        lake mask.
+ *
+ * @param mask The mask to generate provinces from
+ * @param density How densely to fill every part of the map, or nullptr to fill
+ *                it evenly. Must be an 8-bit image the same size as the mask.
+ * @param options The options to generate the provinces with
+ *
+ * @return STATUS_SUCCESS on success, STATUS_INVALID_BIT_DEPTH or
+ *         STATUS_DIMENSION_MISMATCH if either image is not usable, or an
+ *         error code if the provinces could not be generated.
+ */
+auto HMDT::Project::MapProject::generateProvinces(const BitMap2& mask,
+                                                  const BitMap2* density,
+                                                  const ProvinceGeneratorOptions& options) noexcept
+    -> MaybeVoid
+{
+    if(auto bpp = mask.info_header.v1.bitsPerPixel; bpp != 24) {
+        WRITE_ERROR("Province masks must be 24-bit images, not ", bpp, '.');
+        RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
     }
+
+    uint32_t width = mask.info_header.v1.width;
+    uint32_t height = mask.info_header.v1.height;
+
+    if(density != nullptr) {
+        if(auto bpp = density->info_header.v1.bitsPerPixel; bpp != 8) {
+            WRITE_ERROR("Density maps must be 8-bit images, not ", bpp, '.');
+            RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+        }
+
+        if(density->info_header.v1.width != width ||
+           density->info_header.v1.height != height)
+        {
+            WRITE_ERROR("Density map dimensions (", density->info_header.v1.width,
+                        ", ", density->info_header.v1.height, ") do not match "
+                        "the mask dimensions (", width, ", ", height, ")");
+            RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+        }
+    }
+
+    auto generated = generateProvinceMap(Dimensions{width, height},
+                                         mask.data.get(),
+                                         density != nullptr ? density->data.get() : nullptr,
+                                         options);
+    RETURN_IF_ERROR(generated);
+
+    // Do a placement new so we keep the same memory location but update all
+    //  of the data inside the shared MapData instead, so that all
+    //  references are also updated too
+    m_map_data->~MapData();
+    new (m_map_data.get()) MapData(width, height);
+    invalidateProvinceStatistics(ZONAL_LAYER_ALL);
+
+    auto input_data = m_map_data->getInput().lock();
+    std::copy(generated->image.begin(), generated->image.end(),
+              input_data.get());
+
+    m_continent_project.getContinents().clear();
+
+    auto result = m_provinces_project.importProvinces(generated->definitions, { });
+    RETURN_IF_ERROR(result);
+
+    calculateCoastalProvinces();
+
+    return STATUS_SUCCESS;
 }
 
 auto HMDT::Project::MapProject::getProvinceProject() noexcept
@@ -451,6 +816,30 @@ auto HMDT::Project::MapProject::getRiversProject() const noexcept
     return m_rivers_project;
 }
 
+auto HMDT::Project::MapProject::getTerrainProject() noexcept
+    -> TerrainProject&
+{
+    return m_terrain_project;
+}
+
+auto HMDT::Project::MapProject::getTerrainProject() const noexcept
+    -> const TerrainProject&
+{
+    return m_terrain_project;
+}
+
+auto HMDT::Project::MapProject::getStrategicRegionProject() noexcept
+    -> StrategicRegionProject&
+{
+    return m_strategic_region_project;
+}
+
+auto HMDT::Project::MapProject::getStrategicRegionProject() const noexcept
+    -> const StrategicRegionProject&
+{
+    return m_strategic_region_project;
+}
+
 auto HMDT::Project::MapProject::getMapData() -> std::shared_ptr<MapData> {
     return m_map_data;
 }
@@ -500,11 +889,12 @@ void HMDT::Project::MapProject::moveProvinceToState(ProvinceID prov_id,
 void HMDT::Project::MapProject::moveProvinceToState(Province& province,
                                                     StateID state_id)
 {
-    removeProvinceFromState(province);
+    removeProvinceFromState(province, false);
     province.state = state_id;
     getRootParent().getHistoryProject().getStateProject().addProvinceToState(state_id, province.id);
 
-    getRootParent().getHistoryProject().getStateProject().updateStateIDMatrix();
+    // Only the pixels of this one province changed state
+    getRootParent().getHistoryProject().getStateProject().updateStateIDMatrix({ province.id });
 }
 
 /**
@@ -523,7 +913,7 @@ void HMDT::Project::MapProject::removeProvinceFromState(Province& province,
     }
     province.state = -1;
 
-    if(update_state_id_matrix) getRootParent().getHistoryProject().getStateProject().updateStateIDMatrix();
+    if(update_state_id_matrix) getRootParent().getHistoryProject().getStateProject().updateStateIDMatrix({ province.id });
 }
 
 /**
@@ -564,6 +954,356 @@ void HMDT::Project::MapProject::calculateCoastalProvinces(bool dry) {
     WRITE_INFO("Done.");
 }
 
+/**
+ * @brief Finds every candidate sea crossing between land provinces on
+ *        different landmasses.
+ *
+ * @return Every strait no wider than getMaxStraitWidth()
+ */
+auto HMDT::Project::MapProject::findStraits() const noexcept
+    -> Maybe<std::vector<Strait>>
+{
+    WRITE_INFO("Finding straits no wider than ", m_max_strait_width, " pixels...");
+
+    auto map_data = getMapData();
+
+    auto straits = HMDT::findStraits({ map_data->getWidth(), map_data->getHeight() },
+                                     map_data->getProvinces().lock().get(),
+                                     m_provinces_project.getProvinces(),
+                                     m_max_strait_width);
+    RETURN_IF_ERROR(straits);
+
+    WRITE_INFO("Found ", straits->size(), " straits.");
+
+    return straits;
+}
+
+/**
+ * @brief Gets the widest sea crossing which will be exported as a strait
+ */
+uint32_t HMDT::Project::MapProject::getMaxStraitWidth() const noexcept {
+    return m_max_strait_width;
+}
+
+/**
+ * @brief Sets the widest sea crossing which will be exported as a strait
+ *
+ * @param max_strait_width The distance in pixels between the two shores
+ */
+void HMDT::Project::MapProject::setMaxStraitWidth(uint32_t max_strait_width) noexcept
+{
+    m_max_strait_width = max_strait_width;
+}
+
+/**
+ * @brief Generates supply hubs and the railways connecting them from the
+ *        provinces, states, heightmap and rivers.
+ *
+ * @return The supply network
+ */
+auto HMDT::Project::MapProject::buildSupplyNetwork() const noexcept
+    -> Maybe<SupplyNetwork>
+{
+    WRITE_INFO("Building supply network...");
+
+    auto map_data = getMapData();
+
+    // Only take rivers into account if there actually are some, as an empty
+    //   rivers map is all river sources
+    const uint8_t* rivers = nullptr;
+    if(m_rivers_project.getBitMap()) {
+        rivers = map_data->getRivers().lock().get();
+    }
+
+    const auto& states = getRootParent().getHistoryProject().getStateProject().getStates();
+
+    auto network = HMDT::buildSupplyNetwork({ map_data->getWidth(), map_data->getHeight() },
+                                            map_data->getProvinces().lock().get(),
+                                            map_data->getHeightMap().lock().get(),
+                                            rivers,
+                                            m_provinces_project.getProvinces(),
+                                            states);
+    RETURN_IF_ERROR(network);
+
+    WRITE_INFO("Built ", network->supply_nodes.size(), " supply hubs and ",
+               network->railways.size(), " railways.");
+
+    return network;
+}
+
+/**
+ * @brief Finds the point inside of every province which is furthest from its
+ *        edges, for placing labels, buildings and units at.
+ *
+ * @return The label point of every province
+ */
+auto HMDT::Project::MapProject::findLabelPoints() const noexcept
+    -> Maybe<LabelPointMap>
+{
+    WRITE_INFO("Finding province label points...");
+
+    auto map_data = getMapData();
+
+    auto label_points = HMDT::findLabelPoints({ map_data->getWidth(), map_data->getHeight() },
+                                              map_data->getProvinces().lock().get(),
+                                              map_data->getHeightMap().lock().get(),
+                                              m_provinces_project.getProvinces());
+    RETURN_IF_ERROR(label_points);
+
+    WRITE_INFO("Found label points for ", label_points->size(), " provinces.");
+
+    return label_points;
+}
+
+/**
+ * @brief Gets the statistics of a single province, computing them first if
+ *        they are out of date.
+ *
+ * @param id The province to get the statistics of
+ *
+ * @return The province's statistics, STATUS_KEY_NOT_FOUND if the province
+ *         has no pixels on the map, or an error code if the statistics could
+ *         not be computed.
+ */
+auto HMDT::Project::MapProject::getProvinceStatistics(const ProvinceID& id) noexcept
+    -> Maybe<ProvinceStatistics>
+{
+    RETURN_IF_ERROR(updateProvinceStatistics());
+
+    if(auto it = m_province_statistics.find(id); it != m_province_statistics.end())
+    {
+        return it->second;
+    }
+
+    RETURN_ERROR(STATUS_KEY_NOT_FOUND);
+}
+
+/**
+ * @brief Gets the statistics of every province, computing them first if they
+ *        are out of date.
+ *
+ * @return The statistics of every province, or an error code if they could
+ *         not be computed.
+ */
+auto HMDT::Project::MapProject::getAllProvinceStatistics() noexcept
+    -> Maybe<ProvinceStatisticsMap>
+{
+    RETURN_IF_ERROR(updateProvinceStatistics());
+
+    return m_province_statistics;
+}
+
+/**
+ * @brief Marks the province statistics computed from some layers as out of
+ *        date, so that they get computed again the next time they are asked
+ *        for.
+ * @details Every statistic depends on the shape of the provinces, so
+ *          invalidating ZONAL_LAYER_PROVINCES invalidates all of them.
+ *
+ * @param which A combination of ZONAL_LAYER_* flags for the layers which
+ *              changed
+ */
+void HMDT::Project::MapProject::invalidateProvinceStatistics(uint8_t which) noexcept
+{
+    if(which & ZONAL_LAYER_PROVINCES) {
+        which = ZONAL_LAYER_ALL;
+    }
+
+    m_valid_province_statistics &= ~which;
+}
+
+/**
+ * @brief Computes the province statistics for every layer which changed since
+ *        they were last computed.
+ * @details The heightmap and rivers statistics are only computed if those
+ *          layers have actually been loaded, and are otherwise left at 0.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the statistics could
+ *         not be computed.
+ */
+auto HMDT::Project::MapProject::updateProvinceStatistics() noexcept
+    -> MaybeVoid
+{
+    auto map_data = getMapData();
+    Dimensions dimensions{ map_data->getWidth(), map_data->getHeight() };
+
+    if(dimensions.w != m_province_statistics_dimensions.w ||
+       dimensions.h != m_province_statistics_dimensions.h)
+    {
+        invalidateProvinceStatistics(ZONAL_LAYER_ALL);
+    }
+
+    uint8_t which = ZONAL_LAYER_ALL & ~m_valid_province_statistics;
+    if(which == 0) {
+        return STATUS_SUCCESS;
+    }
+
+    ZonalStatisticsLayers layers;
+    layers.dimensions = dimensions;
+    layers.provinces = map_data->getProvinces().lock().get();
+
+    auto map_data_heightmap = map_data->getHeightMap().lock();
+    if(m_heightmap_project.getBitMap()) {
+        layers.heightmap = map_data_heightmap.get();
+    } else {
+        which &= ~ZONAL_LAYER_HEIGHTMAP;
+    }
+
+    // An empty rivers map is all river sources, so only count rivers if there
+    //   actually are some
+    auto map_data_rivers = map_data->getRivers().lock();
+    if(m_rivers_project.getBitMap()) {
+        layers.rivers = map_data_rivers.get();
+    } else {
+        which &= ~ZONAL_LAYER_RIVERS;
+    }
+
+    WRITE_INFO("Computing province statistics...");
+
+    RETURN_IF_ERROR(computeZonalStatistics(layers, which, m_province_statistics));
+
+    m_valid_province_statistics = ZONAL_LAYER_ALL;
+    m_province_statistics_dimensions = dimensions;
+
+    WRITE_INFO("Computed statistics for ", m_province_statistics.size(),
+               " provinces.");
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Writes the statistics of every province to a CSV file, one province
+ *        per line, ordered by their exported ID.
+ *
+ * @param path The file to write to
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the statistics could
+ *         not be computed or written.
+ */
+auto HMDT::Project::MapProject::writeProvinceStatisticsCSV(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
+{
+    RETURN_IF_ERROR(updateProvinceStatistics());
+
+    struct StatisticsRecord {
+        uint32_t id;
+        const Province* province;
+        const ProvinceStatistics* statistics;
+    };
+
+    const auto& provinces = m_provinces_project.getProvinces();
+
+    std::vector<StatisticsRecord> records;
+    records.reserve(m_province_statistics.size());
+    for(auto&& [id, statistics] : m_province_statistics) {
+        if(auto it = provinces.find(id); it != provinces.end()) {
+            records.push_back({ m_provinces_project.getIDForProvinceID(id),
+                                &it->second, &statistics });
+        }
+    }
+
+    std::sort(records.begin(), records.end(),
+              [](const StatisticsRecord& r1, const StatisticsRecord& r2) {
+                  return r1.id < r2.id;
+              });
+
+    // The first record is the header, so every province is offset by one
+    auto res = writeRecordsToFile(path, records.size() + 1, ';',
+        [&records, &provinces](size_t i, RecordWriter& writer) {
+            if(i == 0) {
+                writer.writeRecord("id", "uuid", "pixels", "perimeter",
+                                   "coastline", "min_height", "max_height",
+                                   "mean_height", "mean_slope", "river_pixels");
+                return;
+            }
+
+            const auto& [id, province, statistics] = records[i - 1];
+
+            writer.writeRecord(id, province->id,
+                               statistics->pixel_count,
+                               statistics->perimeter,
+                               getCoastlineLength(*statistics, *province, provinces),
+                               statistics->min_height,
+                               statistics->max_height,
+                               std::to_string(statistics->mean_height),
+                               std::to_string(statistics->mean_slope),
+                               statistics->river_pixel_count);
+        });
+    RETURN_IF_ERROR(res);
+
+    WRITE_INFO("Wrote statistics for ", records.size(), " provinces to ", path);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Writes the statistics of every province to a JSON file, as an array
+ *        of objects ordered by their exported ID.
+ *
+ * @param path The file to write to
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the statistics could
+ *         not be computed or written.
+ */
+auto HMDT::Project::MapProject::writeProvinceStatisticsJSON(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
+{
+    using json = nlohmann::json;
+
+    RETURN_IF_ERROR(updateProvinceStatistics());
+
+    const auto& provinces = m_provinces_project.getProvinces();
+
+    std::map<uint32_t, json> sorted_statistics;
+    for(auto&& [id, statistics] : m_province_statistics) {
+        auto it = provinces.find(id);
+        if(it == provinces.end()) {
+            continue;
+        }
+
+        std::stringstream uuid;
+        uuid << id;
+
+        std::map<std::string, uint64_t> borders;
+        for(auto&& [neighbor, length] : statistics.border_lengths) {
+            if(provinces.count(neighbor) != 0) {
+                borders[std::to_string(m_provinces_project.getIDForProvinceID(neighbor))] = length;
+            }
+        }
+
+        auto export_id = m_provinces_project.getIDForProvinceID(id);
+        sorted_statistics[export_id] = {
+            { "id", export_id },
+            { "uuid", uuid.str() },
+            { "pixels", statistics.pixel_count },
+            { "perimeter", statistics.perimeter },
+            { "coastline", getCoastlineLength(statistics, it->second, provinces) },
+            { "borders", borders },
+            { "min_height", statistics.min_height },
+            { "max_height", statistics.max_height },
+            { "mean_height", statistics.mean_height },
+            { "mean_slope", statistics.mean_slope },
+            { "river_pixels", statistics.river_pixel_count }
+        };
+    }
+
+    json all_statistics = json::array();
+    for(auto&& [_, statistics] : sorted_statistics) {
+        all_statistics.push_back(std::move(statistics));
+    }
+
+    if(std::ofstream out(path); out) {
+        out << std::setw(4) << all_statistics << std::endl;
+    } else {
+        WRITE_ERROR("Failed to write file to ", path, ". Reason: ", std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    WRITE_INFO("Wrote statistics for ", all_statistics.size(), " provinces to ", path);
+
+    return STATUS_SUCCESS;
+}
+
 /**
  * @brief Builds the project hierarchy tree for MapProject
  *
@@ -615,6 +1355,24 @@ auto HMDT::Project::MapProject::visit(const std::function<MaybeVoid(std::shared_
         });
     RETURN_IF_ERROR(result);
 
+    result = getTerrainProject().visit(visitor)
+        .andThen([&map_project_node](auto terrain_project_node) -> MaybeVoid {
+            auto result = map_project_node->addChild(terrain_project_node);
+            RETURN_IF_ERROR(result);
+
+            return STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(result);
+
+    result = getStrategicRegionProject().visit(visitor)
+        .andThen([&map_project_node](auto region_project_node) -> MaybeVoid {
+            auto result = map_project_node->addChild(region_project_node);
+            RETURN_IF_ERROR(result);
+
+            return STATUS_SUCCESS;
+        });
+    RETURN_IF_ERROR(result);
+
     return map_project_node;
 }
 
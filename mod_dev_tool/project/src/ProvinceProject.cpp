@@ -1,16 +1,28 @@
 
 #include "ProvinceProject.h"
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <fstream>
+#include <future>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 #include <cerrno>
 #include <cstring>
 
 #include "Constants.h"
 #include "MapData.h"
 #include "Util.h"
+#include "BorderMask.h"
 #include "StatusCodes.h"
+#include "UniqueColorGenerator.h"
 #include "Options.h"
 #include "BitMap.h"
+#include "RecordParser.h"
+#include "RecordWriter.h"
+#include "ProvinceSplitter.h"
 
 #include "ShapeFinder2.h"
 
@@ -24,7 +36,8 @@
 
 HMDT::Project::ProvinceProject::ProvinceProject(IRootMapProject& parent_project):
     m_parent_project(parent_project),
-    m_provinces()
+    m_provinces(),
+    m_next_export_id(1)
 {
 }
 
@@ -72,10 +85,7 @@ auto HMDT::Project::ProvinceProject::load(const std::filesystem::path& path)
         auto shapelabels_result = loadShapeLabels(path);
         RETURN_IF_ERROR(shapelabels_result);
     } else {
-        auto provdata_result = loadProvinceData2(path);
-        if(provdata_result.error() == std::errc::no_such_file_or_directory) {
-            provdata_result = STATUS_SUCCESS;
-        }
+        auto provdata_result = loadProvinceList(path);
         RETURN_IF_ERROR(provdata_result);
 
         auto shapelabels_result = loadShapeLabels2(path);
@@ -87,8 +97,39 @@ auto HMDT::Project::ProvinceProject::load(const std::filesystem::path& path)
     buildGraphicsData();
     buildProvinceOutlines();
 
-    // Rebuild the uuid->id map last
-    rebuildUUIDToIDMap();
+    // Projects saved before export IDs were kept with the province data will
+    //   not have them for every province, so number the rest after them
+    std::vector<ProvinceID> ids;
+    ids.reserve(m_provinces.size());
+    for(auto&& [id, _] : m_provinces) {
+        ids.push_back(id);
+    }
+    assignExportIDs(std::move(ids));
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Loads only the list of provinces, without any of the per-pixel data
+ *        which goes with it.
+ * @details Only the current province data format is supported, so this should
+ *          not be used for projects from tool version 0.25.0 or older.
+ *
+ * @param path The root path of all province data
+ *
+ * @return STATUS_SUCCESS on success, or if there is no province data to load.
+ *         An error code otherwise.
+ */
+auto HMDT::Project::ProvinceProject::loadProvinceList(const std::filesystem::path& path)
+    -> MaybeVoid
+{
+    auto result = loadProvinceData2(path);
+    if(result.error() == std::errc::no_such_file_or_directory) {
+        result = STATUS_SUCCESS;
+    }
+    RETURN_IF_ERROR(result);
+
+    renumberExportIDs();
 
     return STATUS_SUCCESS;
 }
@@ -128,32 +169,6 @@ auto HMDT::Project::ProvinceProject::export_(const std::filesystem::path& root)
     result = saveProvinceData(root, true);
     RETURN_IF_ERROR(result);
 
-    // Next, export supply_nodes.txt and railways.txt
-    {
-        if(std::ofstream supply_nodes(root / "supply_nodes.txt"); supply_nodes)
-        {
-            // Level ProvinceID
-            // for(auto&& province : m_provinces) {
-                // TODO
-                // NOTE: Level is defined as 1 by default. This is only changed
-                //   in common/buildings/00_buildings.txt, so we will need to
-                //   limit the max to whatever is defined in there (either the
-                //   vanilla version or an overridden version defined in this
-                //   mod)
-            // }
-        } else {
-            WRITE_ERROR("Failed to open file ", root / "supply_nodes.txt");
-            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-        }
-
-        if(std::ofstream railways(root / "railways.txt"); railways) {
-            // TODO
-        } else {
-            WRITE_ERROR("Failed to open file ", root / "railways.txt");
-            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-        }
-    }
-
     return STATUS_SUCCESS;
 }
 
@@ -166,8 +181,193 @@ void HMDT::Project::ProvinceProject::import(const ShapeFinder& sf, std::shared_p
 
     buildProvinceOutlines();
 
+    rebuildUUIDToIDMap();
+
+    if(prog_opts.absorb_tiny_provinces) {
+        if(auto result = absorbTinyProvinces(); IS_FAILURE(result)) {
+            WRITE_WARN("Failed to absorb tiny provinces.");
+        }
+    }
+
+    if(prog_opts.split_oversized_provinces) {
+        if(auto result = splitOversizedProvinces(); IS_FAILURE(result)) {
+            WRITE_WARN("Failed to split oversized provinces.");
+        }
+    }
+
+    // Every province is new, so number them again now that absorbing and
+    //   splitting are done, rather than leaving gaps where provinces were
+    //   absorbed
+    if(prog_opts.absorb_tiny_provinces || prog_opts.split_oversized_provinces) {
+        rebuildUUIDToIDMap();
+    }
+}
+
+/**
+ * @brief Replaces every province with those of an existing mod, using the
+ *        province map already in the input data.
+ * @details Every province is given a UUID which sorts in the same order as
+ *          its ID in the mod, so that exporting gives the provinces back the
+ *          same IDs (as long as the mod's IDs have no gaps in them). Colors in
+ *          the map which are not defined are imported as new provinces after
+ *          all of the defined ones, and defined provinces which are not in the
+ *          map are skipped.
+ *
+ * @param definitions Every province defined by the mod
+ * @param continents Every continent defined by the mod, in the order they are
+ *                   listed in continent.txt
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the map could not be
+ *         indexed.
+ */
+auto HMDT::Project::ProvinceProject::importProvinces(const std::vector<ProvinceDefinition>& definitions,
+                                                     const std::vector<std::string>& continents) noexcept
+    -> MaybeVoid
+{
+    auto map_data = getMapData();
+    auto [width, height] = map_data->getDimensions();
+
+    std::vector<Color> colors;
+    colors.reserve(definitions.size());
+    for(auto&& definition : definitions) {
+        colors.push_back(definition.color);
+    }
+
+    auto index = indexProvinceMap(map_data->getInput().lock().get(),
+                                  Dimensions{width, height}, colors);
+    RETURN_IF_ERROR(index);
+
+    // Visit the defined provinces in ID order, followed by the undefined ones
+    std::vector<uint32_t> order;
+    order.reserve(index->pixel_counts.size());
+    for(uint32_t i = 0; i < definitions.size(); ++i) {
+        if(index->pixel_counts[i] == 0) {
+            WRITE_WARN("Province ", definitions[i].id, " has color ",
+                       definitions[i].color, ", which is not in the province "
+                       "map. Skipping it.");
+            continue;
+        }
+
+        order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(),
+              [&definitions](uint32_t i1, uint32_t i2) {
+                  return definitions[i1].id < definitions[i2].id;
+              });
+
+    if(!index->unknown_colors.empty()) {
+        WRITE_WARN(index->unknown_colors.size(), " colors in the province map "
+                   "are not defined, importing them as new provinces.");
+    }
+    for(uint32_t i = definitions.size(); i < index->pixel_counts.size(); ++i) {
+        order.push_back(i);
+    }
+
+    std::vector<ProvinceID> ids(order.size());
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<ProvinceID> index_to_id(index->pixel_counts.size(), EMPTY_UUID);
+    for(std::size_t o = 0; o < order.size(); ++o) {
+        index_to_id[order[o]] = ids[o];
+    }
+
+    m_provinces.clear();
+    m_oldid_to_uuid.clear();
+    m_data_cache.clear();
+
+    m_oldid_to_uuid[0] = EMPTY_UUID;
+
+    m_provinces.reserve(order.size());
+    for(auto i : order) {
+        const auto& id = index_to_id[i];
+
+        Province province{
+            id, Color{0, 0, 0}, ProvinceType::UNKNOWN, false, "unknown", "None",
+            0, index->bounding_boxes[i], { }, INVALID_PROVINCE, { }
+        };
+
+        if(i < definitions.size()) {
+            const auto& definition = definitions[i];
+
+            province.unique_color = definition.color;
+            province.type = definition.type;
+            province.coastal = definition.coastal;
+            province.terrain = definition.terrain;
+
+            // Continents are 1 based, with 0 meaning no continent
+            if(definition.continent > 0 && definition.continent <= continents.size())
+            {
+                province.continent = continents[definition.continent - 1];
+            } else if(definition.continent != 0) {
+                WRITE_WARN("Province ", definition.id, " is on continent ",
+                           definition.continent, ", which does not exist.");
+            }
+
+            m_oldid_to_uuid[definition.id] = id;
+        } else {
+            province.unique_color = index->unknown_colors[i - definitions.size()];
+        }
+
+        m_provinces.emplace(id, std::move(province));
+    }
+
+    for(auto&& [i1, i2] : index->adjacencies) {
+        const auto& id1 = index_to_id[i1];
+        const auto& id2 = index_to_id[i2];
+
+        m_provinces.at(id1).adjacent_provinces.insert(id2);
+        m_provinces.at(id2).adjacent_provinces.insert(id1);
+    }
+
+    std::vector<Color> index_to_color(index_to_id.size(), Color{0, 0, 0});
+    for(auto i : order) {
+        index_to_color[i] = m_provinces.at(index_to_id[i]).unique_color;
+    }
+
+    // Fill in every layer of the map data from the index
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto label_matrix = map_data->getLabelMatrix().lock();
+        auto graphics_data = map_data->getProvinceColors().lock();
+
+        auto result = tryParallelForEachRange(
+            static_cast<uint64_t>(width) * height,
+            [&](uint64_t begin, uint64_t end) {
+            for(auto i = begin; i < end; ++i) {
+                auto p = index->pixel_provinces[i];
+                const auto& id = index_to_id[p];
+                const auto& color = index_to_color[p];
+
+                prov_matrix[i] = id;
+                label_matrix[i] = id.hash();
+
+                // Flip the colors from RGB to BGR because BitMap is a bad format
+                graphics_data[i * 3] = color.b;
+                graphics_data[i * 3 + 1] = color.g;
+                graphics_data[i * 3 + 2] = color.r;
+            }
+        });
+        RETURN_IF_ERROR(result);
+    }
+
+    // The adjacencies are already known from the index, so only the outlines
+    //   layer needs to be built. Unlike buildProvinceOutlines, every pixel can
+    //   be done independently here.
+    {
+        auto outlines = map_data->getProvinceOutlines().lock();
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto state_id_matrix = map_data->getStateIDMatrix().lock();
+
+        auto result = buildBorderMask(Dimensions{ width, height },
+                                      prov_matrix.get(), state_id_matrix.get(),
+                                      outlines.get());
+        RETURN_IF_ERROR(result);
+    }
+
     // Rebuild the uuid->id map last
     rebuildUUIDToIDMap();
+
+    return STATUS_SUCCESS;
 }
 
 bool HMDT::Project::ProvinceProject::validateData() {
@@ -244,6 +444,9 @@ auto HMDT::Project::ProvinceProject::saveShapeLabels(const std::filesystem::path
 /**
  * @brief Writes all province data to a .csv file (the same sort of file as
  *        would be loaded by HoI4
+ * @details Provinces are written in order of their ID, so that saving the same
+ *          provinces always produces the same file. Every line is formatted in
+ *          parallel, as this can be slow for large maps.
  *
  * @param root The root where the csv file should be written to
  * @param is_export Whether or not to include extra (i.e: non-HoI4) data, or
@@ -257,86 +460,136 @@ auto HMDT::Project::ProvinceProject::saveProvinceData(const std::filesystem::pat
 {
     auto path = root / PROVINCEDATA_FILENAME;
 
-    if(std::ofstream out(path); out) {
-        const auto& continents = getRootMapParent().getContinentProject().getContinentList();
+    const auto& continents = getRootMapParent().getContinentProject().getContinentList();
 
-        bool assume_unknown_continents = false;
+    // Every province to write, along with the numeric ID and continent it
+    //   gets exported with
+    struct ProvinceRecord {
+        const Province* province;
+        uint32_t id;
+        size_t continent;
+    };
 
-        // Write one line to the CSV for each province
-        for(auto&& [id, province] : m_provinces) {
-            // If we are exporting, then we need to output a numeric ID number,
-            //   not the internal UUID we use
-            if(is_export) {
-                // For provinces that have been merged with another, skip
-                //   actually writing them when exporting because we want to
-                //   only export their parent's information
-                if(province.parent_id != INVALID_PROVINCE) {
-                    continue;
-                }
+    std::vector<ProvinceRecord> records;
+    records.reserve(m_provinces.size());
 
-                // Sanity check
-                RETURN_ERROR_IF(m_uuid_to_oldid.count(id) == 0,
-                                STATUS_VALUE_NOT_FOUND);
+    bool assume_unknown_continents = false;
 
-                out << getIDForProvinceID(id) << ';';
-            } else {
-                out << province.id << ';';
+    for(auto&& [id, province] : m_provinces) {
+        // If we are exporting, then we need to output a numeric ID number,
+        //   not the internal UUID we use
+        if(!is_export) {
+            // Keep the ID the province gets exported with, so that it does not
+            //   change the next time the project is loaded
+            auto it = m_uuid_to_oldid.find(id);
+            records.push_back({ &province,
+                                it != m_uuid_to_oldid.end() ? it->second : 0,
+                                0 });
+            continue;
+        }
+
+        // For provinces that have been merged with another, skip actually
+        //   writing them when exporting because we want to only export their
+        //   parent's information
+        if(province.parent_id != INVALID_PROVINCE) {
+            continue;
+        }
+
+        // Sanity check
+        RETURN_ERROR_IF(m_uuid_to_export_id.count(id) == 0, STATUS_VALUE_NOT_FOUND);
+
+        auto index = getIndexInSet(continents, province.continent);
+        if(IS_FAILURE(index)) {
+            // Make sure we don't prompt the user for every single issue
+            if(!assume_unknown_continents) {
+                WRITE_WARN("Unknown continent '", province.continent,
+                           "' detected for province ID=", province.id);
+
+                std::stringstream ss;
+                ss << "An unknown continent '" << province.continent
+                   << "' was detected for province ID=" << province.id
+                   << ".\nContinuing will assume all unknown "
+                      "continents are blank/0.";
+                auto result = prompt(ss.str(),
+                                     {"Continue", "Stop Exporting"},
+                                     PromptType::ERROR);
+
+                if(IS_FAILURE(result) || *result == 1) {
+                    RETURN_IF_ERROR(index);
+                } else {
+                    assume_unknown_continents = true;
+                }
             }
 
-            out << static_cast<int>(province.unique_color.r) << ';'
-                << static_cast<int>(province.unique_color.g) << ';'
-                << static_cast<int>(province.unique_color.b) << ';'
-                << province.type << ';'
-                << (province.coastal ? "true" : "false")
-                << ';' << province.terrain << ';';
+            index = 0;
+        } else {
+            // Continents are 1 based, so convert the index to the ID
+            ++(*index);
+        }
+
+        records.push_back({ &province, getIDForProvinceID(id), *index });
+    }
 
-            if(!is_export) {
-                out << province.continent << ';'
-                    << province.bounding_box.bottom_left.x << ';'
-                    << province.bounding_box.bottom_left.y << ';'
-                    << province.bounding_box.top_right.x << ';'
-                    << province.bounding_box.top_right.y << ';'
-                    << province.state << ';'
-                    << province.parent_id;
+    std::sort(records.begin(), records.end(),
+              [is_export](const ProvinceRecord& r1, const ProvinceRecord& r2) {
+                  return is_export ? r1.id < r2.id
+                                   : r1.province->id < r2.province->id;
+              });
+
+    // Merged provinces are not written on their own, which leaves gaps that
+    //   HoI4 will complain about
+    if(is_export) {
+        if(auto gap = std::adjacent_find(records.begin(), records.end(),
+                                         [](const ProvinceRecord& r1,
+                                            const ProvinceRecord& r2)
+                                         {
+                                             return r1.id + 1 != r2.id;
+                                         });
+                gap != records.end())
+        {
+            WRITE_WARN("Exported province IDs are not contiguous, the first "
+                       "missing ID is ", gap->id + 1, '.');
+        }
+    }
+
+    // Write one line to the CSV for each province
+    auto res = writeRecordsToFile(path, records.size(), ';',
+        [&records, is_export](size_t i, RecordWriter& writer) {
+            const auto& [province, id, continent] = records[i];
+
+            if(is_export) {
+                writer.writeField(id);
             } else {
-                auto index = getIndexInSet(continents, province.continent);
-                if(IS_FAILURE(index)) {
-                    // Make sure we don't prompt the user for every single issue
-                    if(!assume_unknown_continents) {
-                        WRITE_WARN("Unknown continent '", province.continent,
-                                   "' detected for province ID=", province.id);
+                writer.writeField(province->id);
+            }
 
-                        std::stringstream ss;
-                        ss << "An unknown continent '" << province.continent
-                           << "' was detected for province ID=" << province.id
-                           << ".\nContinuing will assume all unknown "
-                              "continents are blank/0.";
-                        auto result = prompt(ss.str(),
-                                             {"Continue", "Stop Exporting"},
-                                             PromptType::ERROR);
-
-                        if(IS_FAILURE(result) || *result == 1) {
-                            RETURN_IF_ERROR(index);
-                        } else {
-                            assume_unknown_continents = true;
-                        }
-                    }
+            writer.writeFields(province->unique_color.r,
+                               province->unique_color.g,
+                               province->unique_color.b,
+                               province->type,
+                               province->coastal,
+                               province->terrain);
 
-                    index = 0;
+            if(!is_export) {
+                writer.writeFields(province->continent,
+                                   province->bounding_box.bottom_left.x,
+                                   province->bounding_box.bottom_left.y,
+                                   province->bounding_box.top_right.x,
+                                   province->bounding_box.top_right.y,
+                                   province->state,
+                                   province->parent_id);
+
+                // 0 is never a valid export ID, so leave it out
+                if(id != 0) {
+                    writer.writeRecord(id);
                 } else {
-                    // Continents are 1 based, so convert the index to the ID
-                    ++(*index);
+                    writer.writeRecord("");
                 }
-
-                out << *index;
+            } else {
+                writer.writeRecord(continent);
             }
-
-            out << std::endl;
-        }
-    } else {
-        WRITE_ERROR("Failed to open file ", path);
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
-    }
+        });
+    RETURN_IF_ERROR(res);
 
     return STATUS_SUCCESS;
 }
@@ -557,63 +810,75 @@ auto HMDT::Project::ProvinceProject::loadProvinceData(const std::filesystem::pat
 
         WRITE_WARN("File ", path, " does not exist.");
         return std::make_error_code(std::errc::no_such_file_or_directory);
-    } else if(std::ifstream in(path); in) {
-        std::string line;
-
-        // Make sure we don't have any provinces in the list first
-        m_provinces.clear();
-
-        // Get every line from the CSV file for parsing
-        for(uint32_t line_num = 1; std::getline(in, line); ++line_num) {
-            if(line.empty()) continue;
-
-            WRITE_DEBUG("Parsing CSV line ", line);
-
-            std::stringstream ss(line);
-
-            Province prov;
-
-            prov.parent_id = INVALID_PROVINCE;
-
-            // Attempt to parse the entire CSV line, we expect it to look like:
-            //  ID;R;G;B;ProvinceType;IsCoastal;TerrainType;ContinentID;BB.BottomLeft.X;BB.BottomLeft.Y;BB.TopRight.X;BB.TopRight.Y;StateID
-            uint32_t id;
-            if(!parseValuesSkipMissing<';'>(ss, &id,
-                                                &prov.unique_color.r,
-                                                &prov.unique_color.g,
-                                                &prov.unique_color.b,
-                                                &prov.type,
-                                                &prov.coastal,
-                                                &prov.terrain,
-                                                &prov.continent,
-                                                &prov.bounding_box.bottom_left.x,
-                                                &prov.bounding_box.bottom_left.y,
-                                                &prov.bounding_box.top_right.x,
-                                                &prov.bounding_box.top_right.y,
-                                                &prov.state, true))
-            {
-                WRITE_ERROR("Failed to parse line #", line_num, ": '", line, "'");
-                RETURN_ERROR(std::make_error_code(std::errc::bad_message));
-            }
+    }
 
-            if(m_oldid_to_uuid.count(id) == 0) {
-                // Create the new UUID for the old ID and give it to the
-                //   province to hold onto
-                prov.id = m_oldid_to_uuid[id];
+    auto contents = readFileToString(path);
+    RETURN_IF_ERROR(contents);
 
-                WRITE_DEBUG("Mapping old province ID ", id, " to ", prov.id);
-            }
+    // Make sure we don't have any provinces in the list first
+    m_provinces.clear();
+    m_uuid_to_oldid.clear();
+    m_next_export_id = 1;
+
+    // Get every line from the CSV file for parsing. Files from older versions
+    //   may have junk after some numbers, which used to be ignored, so keep
+    //   ignoring it (with a warning) rather than refusing to load the project
+    RecordParser parser(*contents, ';');
+    parser.setAllowTrailingCharacters();
+    while(parser.nextRecord()) {
+        WRITE_DEBUG("Parsing CSV line ", parser.getRecord());
+
+        // Start from an empty ID, as generating a new UUID for every province
+        //   takes longer than parsing the rest of the line
+        Province prov{ EMPTY_UUID, Color{ 0, 0, 0 }, ProvinceType::UNKNOWN,
+                       false, "", "", 0, { { 0, 0 }, { 0, 0 } }, { },
+                       INVALID_PROVINCE, { } };
+
+        // Attempt to parse the entire CSV line, we expect it to look like:
+        //  ID;R;G;B;ProvinceType;IsCoastal;TerrainType;ContinentID;BB.BottomLeft.X;BB.BottomLeft.Y;BB.TopRight.X;BB.TopRight.Y;StateID
+        uint32_t id;
+        auto res = parser.parseFields(id,
+                                      prov.unique_color.r,
+                                      prov.unique_color.g,
+                                      prov.unique_color.b,
+                                      prov.type,
+                                      prov.coastal,
+                                      prov.terrain,
+                                      prov.continent,
+                                      prov.bounding_box.bottom_left.x,
+                                      prov.bounding_box.bottom_left.y,
+                                      prov.bounding_box.top_right.x,
+                                      prov.bounding_box.top_right.y);
+        if(IS_SUCCESS(res)) {
+            res = parser.parseOptionalField(prov.state);
+        }
 
-            m_provinces[prov.id] = prov;
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to parse line #", parser.getLineNumber(),
+                        " of ", path, ": '", parser.getRecord(), "'");
+            RETURN_IF_ERROR(res);
         }
 
-        WRITE_DEBUG("Loaded information for ",
-                   m_provinces.size(), " provinces");
-    } else {
-        WRITE_ERROR("Failed to open file ", path);
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        if(m_oldid_to_uuid.count(id) == 0) {
+            // Create the new UUID for the old ID and give it to the
+            //   province to hold onto
+            prov.id = m_oldid_to_uuid[id];
+
+            WRITE_DEBUG("Mapping old province ID ", id, " to ", prov.id);
+        }
+
+        // The old ID is what the province was exported with, so keep it
+        if(m_uuid_to_oldid.count(prov.id) == 0) {
+            m_uuid_to_oldid[prov.id] = id;
+            m_next_export_id = std::max(m_next_export_id, id + 1);
+        }
+
+        m_provinces[prov.id] = prov;
     }
 
+    WRITE_DEBUG("Loaded information for ",
+               m_provinces.size(), " provinces");
+
     return STATUS_SUCCESS;
 }
 
@@ -635,72 +900,92 @@ auto HMDT::Project::ProvinceProject::loadProvinceData2(const std::filesystem::pa
 
         WRITE_WARN("File ", path, " does not exist.");
         return std::make_error_code(std::errc::no_such_file_or_directory);
-    } else if(std::ifstream in(path); in) {
-        std::string line;
-
-        // Make sure we don't have any provinces in the list first
-        m_provinces.clear();
-
-        // Get every line from the CSV file for parsing
-        for(uint32_t line_num = 1; std::getline(in, line); ++line_num) {
-            if(line.empty()) continue;
-
-            std::stringstream ss(line);
-
-            Province prov;
-
-            prov.parent_id = INVALID_PROVINCE;
-
-            // Attempt to parse the entire CSV line, we expect it to look like:
-            //  ID;R;G;B;ProvinceType;IsCoastal;TerrainType;ContinentID;BB.BottomLeft.X;BB.BottomLeft.Y;BB.TopRight.X;BB.TopRight.Y;StateID
-            if(!parseValuesSkipMissing<';'>(ss, &prov.id,
-                                                &prov.unique_color.r,
-                                                &prov.unique_color.g,
-                                                &prov.unique_color.b,
-                                                &prov.type,
-                                                &prov.coastal,
-                                                &prov.terrain,
-                                                &prov.continent,
-                                                &prov.bounding_box.bottom_left.x,
-                                                &prov.bounding_box.bottom_left.y,
-                                                &prov.bounding_box.top_right.x,
-                                                &prov.bounding_box.top_right.y,
-                                                &prov.state, true,
-                                                &prov.parent_id, true))
-            {
-                WRITE_ERROR("Failed to parse line #", line_num, ": '", line, "'");
-                RETURN_ERROR(std::make_error_code(std::errc::bad_message));
-            }
+    }
 
-            // Sanity check
-            if(m_provinces.count(prov.id) != 0) {
-                WRITE_WARN("Province with id ", prov.id, " already exists! Are "
-                           "there two provinces listed in ", path, " which "
-                           "share an ID?");
-            }
+    auto contents = readFileToString(path);
+    RETURN_IF_ERROR(contents);
+
+    // Make sure we don't have any provinces in the list first
+    m_provinces.clear();
+    m_uuid_to_oldid.clear();
+    m_next_export_id = 1;
+
+    std::unordered_set<uint32_t> used_export_ids;
+
+    // Get every line from the CSV file for parsing
+    RecordParser parser(*contents, ';');
+    parser.setAllowTrailingCharacters();
+    while(parser.nextRecord()) {
+        // Start from an empty ID, as generating a new UUID for every province
+        //   takes longer than parsing the rest of the line
+        Province prov{ EMPTY_UUID, Color{ 0, 0, 0 }, ProvinceType::UNKNOWN,
+                       false, "", "", 0, { { 0, 0 }, { 0, 0 } }, { },
+                       INVALID_PROVINCE, { } };
+
+        // Attempt to parse the entire CSV line, we expect it to look like:
+        //  ID;R;G;B;ProvinceType;IsCoastal;TerrainType;ContinentID;BB.BottomLeft.X;BB.BottomLeft.Y;BB.TopRight.X;BB.TopRight.Y;StateID;ParentID;ExportID
+        uint32_t export_id = 0;
+        auto res = parser.parseFields(prov.id,
+                                      prov.unique_color.r,
+                                      prov.unique_color.g,
+                                      prov.unique_color.b,
+                                      prov.type,
+                                      prov.coastal,
+                                      prov.terrain,
+                                      prov.continent,
+                                      prov.bounding_box.bottom_left.x,
+                                      prov.bounding_box.bottom_left.y,
+                                      prov.bounding_box.top_right.x,
+                                      prov.bounding_box.top_right.y);
+        if(IS_SUCCESS(res)) {
+            res = parser.parseOptionalFields(prov.state, prov.parent_id,
+                                             export_id);
+        }
+
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to parse line #", parser.getLineNumber(),
+                        " of ", path, ": '", parser.getRecord(), "'");
+            RETURN_IF_ERROR(res);
+        }
 
-            // Add the province into the vector
-            m_provinces[prov.id] = prov;
+        // Sanity check
+        if(m_provinces.count(prov.id) != 0) {
+            WRITE_WARN("Province with id ", prov.id, " already exists! Are "
+                       "there two provinces listed in ", path, " which "
+                       "share an ID?");
         }
 
-        // Post load processing
-        // Take care of any additional linking that needs to be done after all
-        //  Province objects exist
-        for(auto&& [prov_id, prov] : m_provinces) {
-            // Make sure that each province is added to its own parent's list of
-            //   children
-            if(isValidProvinceID(prov.parent_id)) {
-                m_provinces[prov.parent_id].children.insert(prov_id);
+        // Older projects did not save export IDs, so those provinces get
+        //   numbered once everything is loaded
+        if(export_id != 0) {
+            if(auto used = used_export_ids.insert(export_id); used.second) {
+                m_uuid_to_oldid[prov.id] = export_id;
+                m_next_export_id = std::max(m_next_export_id, export_id + 1);
+            } else {
+                WRITE_WARN("Province ", prov.id, " has export ID ", export_id,
+                           ", which is already used by another province. It "
+                           "will be given a new one.");
             }
         }
 
-        WRITE_DEBUG("Loaded information for ",
-                   m_provinces.size(), " provinces");
-    } else {
-        WRITE_ERROR("Failed to open file ", path);
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        // Add the province into the vector
+        m_provinces[prov.id] = prov;
     }
 
+    // Post load processing
+    // Take care of any additional linking that needs to be done after all
+    //  Province objects exist
+    for(auto&& [prov_id, prov] : m_provinces) {
+        // Make sure that each province is added to its own parent's list of
+        //   children
+        if(isValidProvinceID(prov.parent_id)) {
+            m_provinces[prov.parent_id].children.insert(prov_id);
+        }
+    }
+
+    WRITE_DEBUG("Loaded information for ",
+               m_provinces.size(), " provinces");
+
     return STATUS_SUCCESS;
 }
 
@@ -802,9 +1087,19 @@ void HMDT::Project::ProvinceProject::buildProvinceCache(const Province* province
     }
 }
 
+/**
+ * @brief Rebuilds the adjacency lists of every province, as well as the
+ *        province outlines layer.
+ *
+ * @details Each pixel of the outlines layer is a single byte of OUTLINE_*
+ *          flags, with the province borders in the low bits and the state
+ *          borders in the high bits. The color is left up to the renderer.
+ */
 void HMDT::Project::ProvinceProject::buildProvinceOutlines() {
     auto prov_outline_data = getMapData()->getProvinceOutlines().lock();
     auto graphics_data = getMapData()->getProvinceColors().lock();
+    auto prov_matrix = getMapData()->getProvinces().lock();
+    auto state_id_matrix = getMapData()->getStateIDMatrix().lock();
 
     auto [width, height] = getMapData()->getDimensions();
     Dimensions dimensions{width, height};
@@ -816,8 +1111,9 @@ void HMDT::Project::ProvinceProject::buildProvinceOutlines() {
     for(uint32_t x = 0; x < width; ++x) {
         for(uint32_t y = 0; y < height; ++y) {
             auto lindex = xyToIndex(width, x, y);
-            auto label = getMapData()->getProvinces().lock()[lindex];
-            auto gindex = xyToIndex(width * 4, x * 4, y);
+            auto label = prov_matrix[lindex];
+
+            prov_outline_data[lindex] = 0;
 
             if(!isValidProvinceID(label)) {
                 WRITE_WARN("ProvinceID matrix has label ", label,
@@ -848,120 +1144,1439 @@ void HMDT::Project::ProvinceProject::buildProvinceOutlines() {
             // Recalculate adjacencies for this pixel
             auto is_adjacent = ShapeFinder::calculateAdjacency(dimensions,
                                                                graphics_data.get(),
-                                                               getMapData()->getProvinces().lock().get(),
+                                                               prov_matrix.get(),
                                                                province.adjacent_provinces,
                                                                {x, y});
-            // If this pixel is adjacent to any others, then make it visible as
-            //  an outline
+            // If this pixel is adjacent to any others, then mark which sides
+            //  of it are borders
             if(is_adjacent) {
-                prov_outline_data[gindex] = 0xFF;
-                prov_outline_data[gindex + 1] = 0xFF;
-                prov_outline_data[gindex + 2] = 0xFF;
-                prov_outline_data[gindex + 3] = 0xFF;
+                prov_outline_data[lindex] =
+                    calculateEdgeFlags(dimensions, prov_matrix.get(), x, y) |
+                    (calculateEdgeFlags(dimensions, state_id_matrix.get(), x, y) << OUTLINE_STATE_SHIFT);
             }
         }
     }
 }
 
 /**
- * @brief Builds the graphics data array
+ * @brief Moves a set of pixels into the given province, and then re-labels
+ *        every province which was touched.
+ *
+ * @details Any province which is no longer a single connected shape is split:
+ *          its largest piece keeps the original ID, and every other piece
+ *          becomes a new province with the same properties. Provinces which
+ *          lose all of their pixels are removed. Only the painted area and
+ *          the pixels around it are searched, along with any pieces which get
+ *          cut off, and adjacencies are only updated where pixels changed. This
+ *          keeps the cost bounded by the size of the edit rather than by the
+ *          size of the provinces it touches.
+ *
+ * @param id The province to paint the pixels into
+ * @param pixels Every pixel to paint. Pixels outside of the map are ignored.
+ *
+ * @return A record of the edit which can be passed to revertProvinceEdit, or a
+ *         failure code if id is not a valid province.
  */
-void HMDT::Project::ProvinceProject::buildGraphicsData() {
-    // Rebuild the graphics data
+auto HMDT::Project::ProvinceProject::paintProvince(const ProvinceID& id,
+                                                   const std::vector<Point2D>& pixels) noexcept
+    -> Maybe<ProvinceEdit>
+{
+    if(!isValidProvinceID(id)) {
+        WRITE_ERROR("Cannot paint pixels into invalid province ", id);
+        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+    }
+
     auto [width, height] = getMapData()->getDimensions();
+    Dimensions dimensions{width, height};
 
     auto prov_matrix = getMapData()->getProvinces().lock();
 
-    auto graphics_data = getMapData()->getProvinceColors().lock();
+    auto& state_project = getRootParent().getHistoryProject().getStateProject();
 
-    // Rebuild the map_data array and the adjacency lists
-    for(uint32_t x = 0; x < width; ++x) {
-        for(uint32_t y = 0; y < height; ++y) {
-            // Get the index into the prov matrix
-            auto lindex = xyToIndex(width, x, y);
+    ProvinceEdit edit;
 
-            // Get the index into the graphics data
-            //  3 == the depth
-            auto gindex = xyToIndex(width * 3, x * 3, y);
+    // The bounds of every painted pixel
+    uint32_t min_x = width;
+    uint32_t min_y = height;
+    uint32_t max_x = 0;
+    uint32_t max_y = 0;
 
-            auto id = prov_matrix[lindex];
+    // Every province which lost pixels, and the bounds of the pixels it lost
+    std::map<ProvinceID, BoundingBox> painted_over;
 
-            // Error check
-            if(!isValidProvinceID(id)) {
-                WRITE_WARN("Province matrix has ID ", id,
-                           " at position (", x, ',', y, "), which does not exist.");
-                continue;
-            }
+    for(auto&& [x, y] : pixels) {
+        if(!isInImage(dimensions, x, y)) {
+            continue;
+        }
 
-            // Rebuild color data
-            auto& province = getProvinceForID(id);
+        auto index = xyToIndex(width, x, y);
+        if(prov_matrix[index] == id) {
+            continue;
+        }
 
-            // Flip the colors from RGB to BGR because BitMap is a bad format
-            graphics_data[gindex] = province.unique_color.b;
-            graphics_data[gindex + 1] = province.unique_color.g;
-            graphics_data[gindex + 2] = province.unique_color.r;
+        edit.old_pixels.emplace_back(index, prov_matrix[index]);
+        if(auto [it, inserted] = painted_over.try_emplace(prov_matrix[index],
+                                                          BoundingBox{ { x, y }, { x, y } });
+           !inserted)
+        {
+            auto& [bottom_left, top_right] = it->second;
+            bottom_left.x = std::min(bottom_left.x, x);
+            bottom_left.y = std::max(bottom_left.y, y);
+            top_right.x = std::max(top_right.x, x);
+            top_right.y = std::min(top_right.y, y);
         }
-    }
-}
+        prov_matrix[index] = id;
 
-/**
- * @brief Gets the province colors in a form that's ready to be exported.
- *
- * @return A new flat array containing all pixel colors, or nullptr if a failure
- *         occurs
- */
-auto HMDT::Project::ProvinceProject::getProvinceColorsForExport() const noexcept
-    -> std::unique_ptr<unsigned char[]>
-{
-    auto province_colors = getMapData()->getProvinceColors().lock();
-    auto prov_matrix = getMapData()->getProvinces().lock();
-    auto [width, height] = getMapData()->getDimensions();
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+    }
 
-    std::unique_ptr<unsigned char[]> exportable_colors(new unsigned char[getMapData()->getProvinceColorsSize()]);
+    if(edit.old_pixels.empty()) {
+        WRITE_DEBUG("No pixels changed, nothing to re-label.");
+        return edit;
+    }
 
-    // TODO: Can we parallelize this?
-    for(uint32_t x = 0; x < width; ++x) {
-        for(uint32_t y = 0; y < height; ++y) {
-            // Get the index into the prov matrix
-            auto lindex = xyToIndex(width, x, y);
+    WRITE_DEBUG("Painted ", edit.old_pixels.size(), " pixels into ", id,
+                " from ", painted_over.size(), " provinces.");
 
-            // Get the index into the graphics data
-            //  3 == the depth
-            auto gindex = xyToIndex(width * 3, x * 3, y);
+    // The provinces whose shapes changed
+    std::set<ProvinceID> reshaped;
+    for(auto&& [prov_id, _] : painted_over) {
+        reshaped.insert(prov_id);
+    }
+    reshaped.insert(id);
 
-            auto id = prov_matrix[lindex];
+    // The provinces whose adjacencies may have changed: every reshaped
+    //   province, and all of their neighbors
+    std::set<ProvinceID> to_rebuild;
 
-            // Error check
-            if(!isValidProvinceID(id)) {
-                WRITE_WARN("Province matrix has ID ", id,
-                           " at position (", x, ',', y, "), which does not exist.");
-                continue;
+    // Save off everything before any of it gets modified
+    std::map<ProvinceID, Province> old_provinces;
+    auto save_province = [this, &old_provinces](const ProvinceID& prov_id) {
+        if(isValidProvinceID(prov_id) && old_provinces.count(prov_id) == 0) {
+            old_provinces.emplace(prov_id, getProvinceForID(prov_id));
+        }
+    };
+    auto save_state = [&state_project, &edit](StateID state_id) {
+        if(edit.old_state_provinces.count(state_id) == 0) {
+            if(auto state = state_project.getStateForID(state_id); IS_SUCCESS(state))
+            {
+                edit.old_state_provinces[state_id] = state->get().provinces;
             }
+        }
+    };
 
-            // Rebuild color data
-            auto maybe_root = getRootProvinceParent(id);
-            // TODO: We should really figure out how to return the error code up
-            //   from here. The reason we can't is because we cannot build a
-            //   Maybe<unique_ptr>
-            RETURN_VALUE_IF_ERROR(maybe_root, nullptr);
+    for(auto&& prov_id : reshaped) {
+        if(!isValidProvinceID(prov_id)) {
+            WRITE_WARN("Painted over pixels of unknown province ", prov_id);
+            continue;
+        }
 
-            exportable_colors[gindex] = maybe_root->get().unique_color.r;
-            exportable_colors[gindex + 1] = maybe_root->get().unique_color.g;
-            exportable_colors[gindex + 2] = maybe_root->get().unique_color.b;
+        to_rebuild.insert(prov_id);
+        for(auto&& adj_id : getProvinceForID(prov_id).adjacent_provinces) {
+            to_rebuild.insert(adj_id);
         }
     }
 
-    return exportable_colors;
-}
+    for(auto&& prov_id : to_rebuild) {
+        save_province(prov_id);
+    }
 
-/**
- * @brief Gets province preview data for the given ID
- *
- * @param id
- *
- * @return The preview data, or nullptr if the ID does not exist
- */
-auto HMDT::Project::ProvinceProject::getPreviewData(ProvinceID id)
+    for(auto&& prov_id : reshaped) {
+        if(!isValidProvinceID(prov_id)) {
+            continue;
+        }
+
+        // Every piece which gets cut off from a province has to touch one of
+        //   the pixels it lost, so only the area around those needs to be
+        //   searched. The province being painted into can only be joined up
+        //   by the painted pixels.
+        Rectangle window;
+        if(prov_id == id) {
+            window = growBorderArea(dimensions,
+                                    Rectangle{ min_x, min_y,
+                                               max_x - min_x + 1,
+                                               max_y - min_y + 1 });
+        } else {
+            auto& [bottom_left, top_right] = painted_over.at(prov_id);
+            window = growBorderArea(dimensions,
+                                    Rectangle{ bottom_left.x, top_right.y,
+                                               top_right.x - bottom_left.x + 1,
+                                               bottom_left.y - top_right.y + 1 });
+        }
+
+        // Only the bounding box of the province (grown to fit the painted
+        //   pixels) can contain any of its pixels
+        BoundingBox bounding_box = getProvinceForID(prov_id).bounding_box;
+
+        std::vector<uint64_t> seeds;
+        if(prov_id == id) {
+            // The pixels that the province already had may not reach into the
+            //   window at all, in which case they need a pixel outside of the
+            //   window to start searching from
+            std::unordered_set<uint64_t> painted;
+            for(auto&& [index, _] : edit.old_pixels) {
+                painted.insert(index);
+            }
+
+            bool had_pixels_in_window = false;
+            for(uint32_t y = window.y; y < window.y + window.h && !had_pixels_in_window; ++y) {
+                for(uint32_t x = window.x; x < window.x + window.w; ++x) {
+                    auto index = xyToIndex(width, x, y);
+                    if(prov_matrix[index] == id && painted.count(index) == 0) {
+                        had_pixels_in_window = true;
+                        break;
+                    }
+                }
+            }
+
+            if(!had_pixels_in_window) {
+                uint32_t right = std::min(bounding_box.top_right.x, width - 1);
+                uint32_t bottom = std::min(bounding_box.bottom_left.y, height - 1);
+
+                for(uint32_t y = bounding_box.top_right.y; y <= bottom && seeds.empty(); ++y) {
+                    for(uint32_t x = bounding_box.bottom_left.x; x <= right; ++x) {
+                        auto index = xyToIndex(width, x, y);
+                        if(prov_matrix[index] == id && painted.count(index) == 0) {
+                            seeds.push_back(index);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            bounding_box.bottom_left.x = std::min(bounding_box.bottom_left.x, min_x);
+            bounding_box.bottom_left.y = std::max(bounding_box.bottom_left.y, max_y);
+            bounding_box.top_right.x = std::max(bounding_box.top_right.x, max_x);
+            bounding_box.top_right.y = std::min(bounding_box.top_right.y, min_y);
+        }
+
+        auto components = findConnectedComponents(prov_id, window, seeds);
+
+        if(components.empty()) {
+            WRITE_DEBUG("Province ", prov_id, " was completely painted over, removing it.");
+
+            // Removing a merged province modifies everything it is merged with
+            for(auto&& merged_id : getMergedProvinces(prov_id)) {
+                save_province(merged_id);
+            }
+
+            if(auto& province = getProvinceForID(prov_id);
+                    province.parent_id != INVALID_PROVINCE || !province.children.empty())
+            {
+                if(auto result = unmergeProvince(prov_id); IS_FAILURE(result)) {
+                    WRITE_WARN("Failed to un-merge removed province ", prov_id);
+                }
+            }
+
+            if(auto state_id = getProvinceForID(prov_id).state;
+                    state_project.isValidStateID(state_id))
+            {
+                save_state(state_id);
+                state_project.removeProvinceFromState(state_id, prov_id);
+            }
+
+            m_data_cache.erase(prov_id);
+            m_provinces.erase(prov_id);
+            to_rebuild.erase(prov_id);
+
+            continue;
+        }
+
+        // Every other piece gets split off into its own province
+        for(size_t i = 1; i < components.size(); ++i) {
+            Province new_province = getProvinceForID(prov_id);
+            new_province.id = ProvinceID();
+            new_province.unique_color = generateUniqueColor(new_province.type);
+            new_province.bounding_box = components[i].bounding_box;
+            new_province.adjacent_provinces.clear();
+            new_province.parent_id = INVALID_PROVINCE;
+            new_province.children.clear();
+
+            auto new_id = new_province.id;
+
+            WRITE_DEBUG("Splitting ", components[i].pixels.size(),
+                        " pixels off of ", prov_id, " into new province ",
+                        new_id);
+
+            for(auto&& index : components[i].pixels) {
+                edit.old_pixels.emplace_back(index, prov_id);
+                prov_matrix[index] = new_id;
+            }
+
+            if(state_project.isValidStateID(new_province.state)) {
+                save_state(new_province.state);
+                state_project.addProvinceToState(new_province.state, new_id);
+            }
+
+            m_provinces.emplace(new_id, std::move(new_province));
+
+            edit.new_provinces.push_back(new_id);
+            to_rebuild.insert(new_id);
+        }
+
+        // A piece which was not searched all the way through still fits in the
+        //   old bounding box, it just may not fill it anymore
+        if(components.front().complete) {
+            getProvinceForID(prov_id).bounding_box = components.front().bounding_box;
+        } else {
+            getProvinceForID(prov_id).bounding_box = shrinkBoundingBox(prov_id, bounding_box);
+        }
+
+        for(auto&& component : components) {
+            if(component.complete && component.pixels.size() <= MIN_SHAPE_SIZE) {
+                WRITE_WARN("Editing province ", prov_id, " left a shape with "
+                           "only ", component.pixels.size(), " pixels. All "
+                           "provinces are required to have more than ",
+                           MIN_SHAPE_SIZE, " pixels.");
+            }
+        }
+    }
+
+    auto result = rebuildPixels(edit.old_pixels);
+    RETURN_IF_ERROR(result);
+
+    std::map<ProvinceID, std::set<ProvinceID>> old_adjacencies;
+    for(auto&& [prov_id, _] : painted_over) {
+        if(auto it = old_provinces.find(prov_id); it != old_provinces.end()) {
+            old_adjacencies.emplace(prov_id, it->second.adjacent_provinces);
+        }
+    }
+
+    updateAdjacencies(edit.old_pixels, old_adjacencies);
+
+    for(auto&& prov_id : to_rebuild) {
+        m_data_cache.erase(prov_id);
+    }
+
+    for(auto&& [_, province] : old_provinces) {
+        edit.old_provinces.push_back(std::move(province));
+    }
+
+    assignExportIDs(edit.new_provinces);
+
+    return edit;
+}
+
+/**
+ * @brief Reverts an edit made by paintProvince.
+ * @details Edits must be reverted in the reverse order that they were made in.
+ *
+ * @param edit The edit to revert
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_VALUE_NOT_FOUND if a province
+ *         created by the edit no longer exists. Nothing is changed on failure.
+ */
+auto HMDT::Project::ProvinceProject::revertProvinceEdit(const ProvinceEdit& edit) noexcept
+    -> MaybeVoid
+{
+    for(auto&& new_id : edit.new_provinces) {
+        if(!isValidProvinceID(new_id)) {
+            WRITE_ERROR("Cannot revert edit, province ", new_id, " no longer exists.");
+            RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+        }
+    }
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    // A pixel may be listed twice (painted, and then split off into a new
+    //   province), so restore them in the reverse order they were changed in
+    for(auto it = edit.old_pixels.rbegin(); it != edit.old_pixels.rend(); ++it) {
+        prov_matrix[it->first] = it->second;
+    }
+
+    for(auto&& new_id : edit.new_provinces) {
+        m_data_cache.erase(new_id);
+        m_provinces.erase(new_id);
+    }
+
+    for(auto&& province : edit.old_provinces) {
+        m_data_cache.erase(province.id);
+        m_provinces[province.id] = province;
+    }
+
+    auto& state_project = getRootParent().getHistoryProject().getStateProject();
+    for(auto&& [state_id, provinces] : edit.old_state_provinces) {
+        if(auto state = state_project.getStateForID(state_id); IS_SUCCESS(state)) {
+            state->get().provinces = provinces;
+        }
+    }
+
+    auto result = rebuildPixels(edit.old_pixels);
+    RETURN_IF_ERROR(result);
+
+    // Every removed province kept its export ID, so only the new ones have to
+    //   be given back
+    releaseExportIDs(edit.new_provinces);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Splits a province into compact, connected pieces. Every piece after
+ *        the first becomes a new province with the same properties.
+ *
+ * @param id The province to split
+ * @param count How many pieces to split the province into
+ *
+ * @return A record of the edit which can be passed to revertProvinceEdit,
+ *         STATUS_VALUE_NOT_FOUND if id is not a valid province, or
+ *         STATUS_INVALID_VALUE if count is 0.
+ */
+auto HMDT::Project::ProvinceProject::splitProvince(const ProvinceID& id,
+                                                   uint32_t count) noexcept
+    -> Maybe<ProvinceEdit>
+{
+    if(!isValidProvinceID(id)) {
+        WRITE_ERROR("Cannot split invalid province ", id);
+        RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+    }
+
+    if(count == 0) {
+        WRITE_ERROR("Cannot split province ", id, " into 0 pieces.");
+        RETURN_ERROR(STATUS_INVALID_VALUE);
+    }
+
+    ProvinceSplit split{ id, getProvincePixels(getProvinceForID(id)), { } };
+    split.pieces = partitionShape(split.pixels, count);
+
+    return applyProvinceSplits({ split });
+}
+
+/**
+ * @brief Splits every province whose bounding box is too large for the map
+ *        into as few compact, connected pieces as it takes for all of them to
+ *        fit.
+ * @details The pieces of every province are found in parallel, with each
+ *          thread taking the next province as soon as it finishes with one, so
+ *          that one very large province does not hold up the rest.
+ *
+ * @return A record of the edit which can be passed to revertProvinceEdit
+ */
+auto HMDT::Project::ProvinceProject::splitOversizedProvinces() noexcept
+    -> Maybe<ProvinceEdit>
+{
+    auto [width, height] = getMapData()->getDimensions();
+    Dimensions dimensions{width, height};
+
+    std::vector<const Province*> oversized;
+    for(auto&& [_, province] : m_provinces) {
+        if(auto [s_width, s_height] = calcDims(province.bounding_box);
+           isShapeTooLarge(s_width, s_height, dimensions))
+        {
+            oversized.push_back(&province);
+        }
+    }
+
+    if(oversized.empty()) {
+        WRITE_DEBUG("No provinces are too large, nothing to split.");
+        return ProvinceEdit{};
+    }
+
+    WRITE_INFO("Splitting ", oversized.size(), " provinces which are too large.");
+
+    std::vector<ProvinceSplit> splits(oversized.size());
+    std::atomic<uint64_t> next_split = 0;
+
+    auto thread_count = std::min<uint64_t>(std::max(std::thread::hardware_concurrency(), 1U),
+                                           oversized.size());
+
+    try {
+        std::vector<std::future<void>> futures;
+        for(uint64_t i = 0; i < thread_count; ++i) {
+            futures.push_back(std::async(std::launch::async, [&]() {
+                for(auto s = next_split++; s < oversized.size(); s = next_split++) {
+                    splits[s].id = oversized[s]->id;
+                    splits[s].pixels = getProvincePixels(*oversized[s]);
+                    splits[s].pieces = partitionOversizedShape(splits[s].pixels,
+                                                               dimensions);
+                }
+            }));
+        }
+
+        for(auto&& future : futures) {
+            future.get();
+        }
+    } catch(const std::bad_alloc&) {
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    return applyProvinceSplits(splits);
+}
+
+/**
+ * @brief Gets every pixel in a province
+ *
+ * @param province The province. Its bounding box must be correct.
+ *
+ * @return Every pixel in the province, from left to right and top to bottom
+ */
+auto HMDT::Project::ProvinceProject::getProvincePixels(const Province& province) const noexcept
+    -> std::vector<Point2D>
+{
+    std::vector<Point2D> pixels;
+
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    uint32_t right = std::min(province.bounding_box.top_right.x, width - 1);
+    uint32_t bottom = std::min(province.bounding_box.bottom_left.y, height - 1);
+
+    for(uint32_t y = province.bounding_box.top_right.y; y <= bottom; ++y) {
+        for(uint32_t x = province.bounding_box.bottom_left.x; x <= right; ++x) {
+            if(prov_matrix[xyToIndex(width, x, y)] == province.id) {
+                pixels.push_back({ x, y });
+            }
+        }
+    }
+
+    return pixels;
+}
+
+/**
+ * @brief Moves every piece of the given splits after the first into a new
+ *        province with the same properties as the province it was split from.
+ *
+ * @param splits Every province to split, and how to split it
+ *
+ * @return A record of the edit which can be passed to revertProvinceEdit, or
+ *         an error code if the layers derived from the provinces could not be
+ *         rebuilt.
+ */
+auto HMDT::Project::ProvinceProject::applyProvinceSplits(const std::vector<ProvinceSplit>& splits) noexcept
+    -> Maybe<ProvinceEdit>
+{
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    auto& state_project = getRootParent().getHistoryProject().getStateProject();
+
+    ProvinceEdit edit;
+
+    // The provinces whose adjacencies may have changed
+    std::set<ProvinceID> to_rebuild;
+
+    // Save off everything before any of it gets modified
+    std::map<ProvinceID, Province> old_provinces;
+
+    for(auto&& split : splits) {
+        if(split.pixels.empty() || !isValidProvinceID(split.id)) {
+            continue;
+        }
+
+        uint32_t piece_count = *std::max_element(split.pieces.begin(),
+                                                 split.pieces.end()) + 1;
+        if(piece_count <= 1) {
+            continue;
+        }
+
+        WRITE_DEBUG("Splitting province ", split.id, " into ", piece_count,
+                    " pieces.");
+
+        to_rebuild.insert(split.id);
+        old_provinces.emplace(split.id, getProvinceForID(split.id));
+        for(auto&& adj_id : getProvinceForID(split.id).adjacent_provinces) {
+            to_rebuild.insert(adj_id);
+            if(isValidProvinceID(adj_id) && old_provinces.count(adj_id) == 0) {
+                old_provinces.emplace(adj_id, getProvinceForID(adj_id));
+            }
+        }
+
+        // Every piece after the first gets its own province
+        std::vector<ProvinceID> piece_ids(piece_count, split.id);
+        for(uint32_t piece = 1; piece < piece_count; ++piece) {
+            Province new_province = getProvinceForID(split.id);
+            new_province.id = ProvinceID();
+            new_province.unique_color = generateUniqueColor(new_province.type);
+            new_province.adjacent_provinces.clear();
+            new_province.parent_id = INVALID_PROVINCE;
+            new_province.children.clear();
+
+            auto new_id = new_province.id;
+            piece_ids[piece] = new_id;
+
+            if(state_project.isValidStateID(new_province.state)) {
+                if(edit.old_state_provinces.count(new_province.state) == 0) {
+                    edit.old_state_provinces[new_province.state] = state_project.getStateForID(new_province.state)->get().provinces;
+                }
+                state_project.addProvinceToState(new_province.state, new_id);
+            }
+
+            m_provinces.emplace(new_id, std::move(new_province));
+
+            edit.new_provinces.push_back(new_id);
+            to_rebuild.insert(new_id);
+        }
+
+        std::vector<BoundingBox> bounding_boxes(piece_count,
+                                                BoundingBox{ { width, 0 }, { 0, height } });
+
+        for(uint64_t i = 0; i < split.pixels.size(); ++i) {
+            auto piece = split.pieces[i];
+            auto [x, y] = split.pixels[i];
+
+            auto& [bottom_left, top_right] = bounding_boxes[piece];
+            bottom_left.x = std::min(bottom_left.x, x);
+            bottom_left.y = std::max(bottom_left.y, y);
+            top_right.x = std::max(top_right.x, x);
+            top_right.y = std::min(top_right.y, y);
+
+            if(piece != 0) {
+                auto index = xyToIndex(width, x, y);
+
+                edit.old_pixels.emplace_back(index, split.id);
+                prov_matrix[index] = piece_ids[piece];
+            }
+        }
+
+        for(uint32_t piece = 0; piece < piece_count; ++piece) {
+            getProvinceForID(piece_ids[piece]).bounding_box = bounding_boxes[piece];
+        }
+    }
+
+    auto result = rebuildPixels(edit.old_pixels);
+    RETURN_IF_ERROR(result);
+
+    std::map<ProvinceID, std::set<ProvinceID>> old_adjacencies;
+    for(auto&& split : splits) {
+        if(auto it = old_provinces.find(split.id); it != old_provinces.end()) {
+            old_adjacencies.emplace(split.id, it->second.adjacent_provinces);
+        }
+    }
+
+    updateAdjacencies(edit.old_pixels, old_adjacencies);
+
+    for(auto&& prov_id : to_rebuild) {
+        m_data_cache.erase(prov_id);
+    }
+
+    for(auto&& [_, province] : old_provinces) {
+        edit.old_provinces.push_back(std::move(province));
+    }
+
+    assignExportIDs(edit.new_provinces);
+
+    return edit;
+}
+
+/**
+ * @brief Merges every province with MIN_SHAPE_SIZE pixels or fewer into one
+ *        of its neighbors. These are almost always left over from
+ *        anti-aliasing or from a stray brush stroke.
+ * @details Each tiny province goes to the neighbor of the same type that it
+ *          shares the longest border with, or to the neighbor it shares the
+ *          longest border with overall if none have the same type. Only the
+ *          pixels of tiny provinces and the adjacency lists of their neighbors
+ *          are looked at, so the rest of the map is never scanned. Provinces
+ *          are found to be tiny from their bounding boxes, so a tiny province
+ *          which is in several pieces spread across the map is left alone.
+ *
+ * @return Every province which was absorbed, smallest first
+ */
+auto HMDT::Project::ProvinceProject::absorbTinyProvinces() noexcept
+    -> Maybe<std::vector<AbsorbedProvince>>
+{
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    auto& state_project = getRootParent().getHistoryProject().getStateProject();
+
+    // The pixels of every tiny province. A connected shape of N pixels can't
+    //   have a bounding box whose width plus height is more than N + 1, so
+    //   only provinces with a bounding box that small need to be counted.
+    std::map<ProvinceID, std::vector<uint64_t>> tiny_pixels;
+    for(auto&& [id, province] : m_provinces) {
+        if(auto [s_width, s_height] = calcDims(province.bounding_box);
+           (s_width + 1) + (s_height + 1) > MIN_SHAPE_SIZE + 1)
+        {
+            continue;
+        }
+
+        std::vector<uint64_t> pixels;
+
+        uint32_t right = std::min(province.bounding_box.top_right.x, width - 1);
+        uint32_t bottom = std::min(province.bounding_box.bottom_left.y, height - 1);
+
+        for(uint32_t y = province.bounding_box.top_right.y; y <= bottom; ++y) {
+            for(uint32_t x = province.bounding_box.bottom_left.x; x <= right; ++x) {
+                if(auto index = xyToIndex(width, x, y); prov_matrix[index] == id) {
+                    pixels.push_back(index);
+                }
+            }
+        }
+
+        if(!pixels.empty() && pixels.size() <= MIN_SHAPE_SIZE) {
+            tiny_pixels.emplace(id, std::move(pixels));
+        }
+    }
+
+    // Absorb the smallest provinces first, so that a cluster of tiny shapes
+    //   gets gathered up into its largest one before that one is absorbed
+    std::vector<ProvinceID> order;
+    for(auto&& [id, _] : tiny_pixels) {
+        order.push_back(id);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&tiny_pixels](const auto& id1, const auto& id2) {
+                         return tiny_pixels.at(id1).size() < tiny_pixels.at(id2).size();
+                     });
+
+    std::vector<AbsorbedProvince> absorbed;
+    std::vector<std::pair<uint64_t, ProvinceID>> changed_pixels;
+
+    for(auto&& id : order) {
+        const auto& pixels = tiny_pixels.at(id);
+
+        // Absorbing other tiny provinces may have made this one large enough
+        if(pixels.size() > MIN_SHAPE_SIZE) {
+            continue;
+        }
+
+        // How long of a border this province shares with each of its neighbors
+        std::map<ProvinceID, uint32_t> border_lengths;
+        for(auto&& index : pixels) {
+            uint32_t x = index % width;
+            uint32_t y = index / width;
+
+            auto count = [&](uint64_t adj_index) {
+                if(const auto& adj_id = prov_matrix[adj_index];
+                   adj_id != id && isValidProvinceID(adj_id))
+                {
+                    ++border_lengths[adj_id];
+                }
+            };
+
+            if(y > 0) count(index - width);
+            if(x + 1 < width) count(index + 1);
+            if(y + 1 < height) count(index + width);
+            if(x > 0) count(index - 1);
+        }
+
+        if(border_lengths.empty()) {
+            WRITE_WARN("Province ", id, " has only ", pixels.size(),
+                       " pixels, but has no neighbors to be absorbed into.");
+            continue;
+        }
+
+        if(auto& province = getProvinceForID(id);
+           province.parent_id != INVALID_PROVINCE || !province.children.empty())
+        {
+            if(auto result = unmergeProvince(id); IS_FAILURE(result)) {
+                WRITE_WARN("Failed to un-merge absorbed province ", id);
+            }
+        }
+
+        auto& province = getProvinceForID(id);
+
+        auto best = std::max_element(border_lengths.begin(), border_lengths.end(),
+                                     [this, &province](const auto& b1, const auto& b2) {
+                                         return std::make_pair(getProvinceForID(b1.first).type == province.type, b1.second) <
+                                                std::make_pair(getProvinceForID(b2.first).type == province.type, b2.second);
+                                     });
+        auto into_id = best->first;
+        auto& into = getProvinceForID(into_id);
+
+        for(auto&& index : pixels) {
+            changed_pixels.emplace_back(index, id);
+            prov_matrix[index] = into_id;
+
+            uint32_t x = index % width;
+            uint32_t y = index / width;
+            into.bounding_box.bottom_left.x = std::min(into.bounding_box.bottom_left.x, x);
+            into.bounding_box.bottom_left.y = std::max(into.bounding_box.bottom_left.y, y);
+            into.bounding_box.top_right.x = std::max(into.bounding_box.top_right.x, x);
+            into.bounding_box.top_right.y = std::min(into.bounding_box.top_right.y, y);
+        }
+
+        // Everything which bordered the absorbed province now borders the
+        //   province which absorbed it instead. A province may be listed as
+        //   adjacent to itself, which must be skipped as that is the set being
+        //   walked over.
+        for(auto&& adj_id : province.adjacent_provinces) {
+            if(adj_id != id && isValidProvinceID(adj_id)) {
+                getProvinceForID(adj_id).adjacent_provinces.erase(id);
+            }
+        }
+        for(auto&& [adj_id, _] : border_lengths) {
+            if(adj_id != into_id) {
+                getProvinceForID(adj_id).adjacent_provinces.insert(into_id);
+                into.adjacent_provinces.insert(adj_id);
+            }
+        }
+        into.adjacent_provinces.erase(id);
+
+        if(state_project.isValidStateID(province.state)) {
+            state_project.removeProvinceFromState(province.state, id);
+        }
+
+        // If the province doing the absorbing is tiny as well, then it takes
+        //   these pixels with it when it gets absorbed
+        if(auto it = tiny_pixels.find(into_id); it != tiny_pixels.end()) {
+            it->second.insert(it->second.end(), pixels.begin(), pixels.end());
+        }
+
+        absorbed.push_back(AbsorbedProvince{ id, into_id, pixels.size() });
+
+        m_data_cache.erase(id);
+        m_data_cache.erase(into_id);
+        m_provinces.erase(id);
+    }
+
+    renumberExportIDs();
+
+    // A province may have been absorbed into one which was then absorbed
+    //   itself, so follow each one through to where its pixels ended up
+    std::map<ProvinceID, ProvinceID> absorbed_into;
+    for(auto&& a : absorbed) {
+        absorbed_into[a.id] = a.into;
+    }
+    for(auto&& a : absorbed) {
+        for(auto it = absorbed_into.find(a.into); it != absorbed_into.end();
+                 it = absorbed_into.find(a.into))
+        {
+            a.into = it->second;
+        }
+
+        WRITE_INFO("Absorbed province ", a.id, " (", a.pixel_count,
+                   " pixels) into province ", a.into, '.');
+    }
+
+    auto result = rebuildPixels(changed_pixels);
+    RETURN_IF_ERROR(result);
+
+    WRITE_INFO("Absorbed ", absorbed.size(), " provinces with ",
+               MIN_SHAPE_SIZE, " pixels or fewer into their neighbors.");
+
+    return absorbed;
+}
+
+/**
+ * @brief Finds every connected piece of a province near an edit.
+ *
+ * @details Only the given window is searched at first. Pieces which never reach
+ *          the edge of the window are already whole. Pieces which run past the
+ *          edge may still be joined up outside of it, so they are grown
+ *          outwards all at once, one pixel at a time each, until either they
+ *          have all met or only one of them is left growing. The one left
+ *          growing is kept going until it is larger than every other piece,
+ *          and is returned incomplete. This way the cost of the search is
+ *          bounded by the window and the pieces which get cut off, rather than
+ *          by the size of the province.
+ *
+ *          The province must have been a single connected piece before the
+ *          edit, and every pixel which was taken out of it must be in the
+ *          window.
+ *
+ * @param id The province to search for
+ * @param window The area around the edit, clamped to the map
+ * @param seeds Pixels of the province outside of the window which belong to a
+ *              piece that may not reach into the window at all
+ *
+ * @return Every 4-connected piece of the province, sorted from largest to
+ *         smallest. Only the first piece may be incomplete.
+ */
+auto HMDT::Project::ProvinceProject::findConnectedComponents(const ProvinceID& id,
+                                                             const Rectangle& window,
+                                                             const std::vector<uint64_t>& seeds) const noexcept
+    -> std::vector<ConnectedComponent>
+{
+    std::vector<ConnectedComponent> components;
+
+    if(window.w == 0 || window.h == 0) {
+        return components;
+    }
+
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    uint32_t left = window.x;
+    uint32_t right = window.x + window.w - 1;
+    uint32_t top = window.y;
+    uint32_t bottom = window.y + window.h - 1;
+
+    auto in_window = [&](uint32_t x, uint32_t y) {
+        return x >= left && x <= right && y >= top && y <= bottom;
+    };
+
+    auto grow_box = [](BoundingBox& box, uint32_t x, uint32_t y) {
+        box.bottom_left.x = std::min(box.bottom_left.x, x);
+        box.bottom_left.y = std::max(box.bottom_left.y, y);
+        box.top_right.x = std::max(box.top_right.x, x);
+        box.top_right.y = std::min(box.top_right.y, y);
+    };
+
+    // Which piece each pixel of the window is in, plus one. 0 means none.
+    std::vector<uint32_t> labels(static_cast<uint64_t>(window.w) * window.h, 0);
+
+    // The pixels just outside of the window which each piece runs into
+    std::vector<std::vector<uint64_t>> exits;
+
+    std::vector<Point2D> to_visit;
+
+    for(uint32_t y = top; y <= bottom; ++y) {
+        for(uint32_t x = left; x <= right; ++x) {
+            if(labels[xyToIndex(window.w, x - left, y - top)] != 0 ||
+               prov_matrix[xyToIndex(width, x, y)] != id)
+            {
+                continue;
+            }
+
+            components.push_back(ConnectedComponent{ { }, { { x, y }, { x, y } } });
+            exits.emplace_back();
+
+            auto& component = components.back();
+            auto label = static_cast<uint32_t>(components.size());
+
+            labels[xyToIndex(window.w, x - left, y - top)] = label;
+            to_visit.push_back({ x, y });
+
+            auto visit = [&](uint32_t vx, uint32_t vy) {
+                auto vindex = xyToIndex(width, vx, vy);
+                if(prov_matrix[vindex] != id) {
+                    return;
+                }
+
+                if(!in_window(vx, vy)) {
+                    exits.back().push_back(vindex);
+                } else if(auto& vlabel = labels[xyToIndex(window.w, vx - left, vy - top)];
+                          vlabel == 0)
+                {
+                    vlabel = label;
+                    to_visit.push_back({ vx, vy });
+                }
+            };
+
+            while(!to_visit.empty()) {
+                auto point = to_visit.back();
+                to_visit.pop_back();
+
+                component.pixels.push_back(xyToIndex(width, point.x, point.y));
+                grow_box(component.bounding_box, point.x, point.y);
+
+                if(point.y > 0) visit(point.x, point.y - 1);
+                if(point.x + 1 < width) visit(point.x + 1, point.y);
+                if(point.y + 1 < height) visit(point.x, point.y + 1);
+                if(point.x > 0) visit(point.x - 1, point.y);
+            }
+        }
+    }
+
+    // Every seed starts off as its own piece, with no pixels in the window
+    for(auto&& seed : seeds) {
+        uint32_t x = seed % width;
+        uint32_t y = seed / width;
+
+        components.push_back(ConnectedComponent{ { }, { { x, y }, { x, y } } });
+        exits.push_back({ seed });
+    }
+
+    // Pieces are joined together when they meet outside of the window, with
+    //   the larger piece taking over the smaller one
+    std::vector<uint32_t> parent(components.size());
+    std::iota(parent.begin(), parent.end(), 0);
+
+    auto find = [&parent](uint32_t i) {
+        while(parent[i] != i) {
+            i = parent[i] = parent[parent[i]];
+        }
+        return i;
+    };
+
+    // The pixels each piece has yet to grow out of
+    std::vector<std::deque<uint64_t>> frontiers(components.size());
+
+    // Which piece each pixel outside of the window has been claimed by
+    std::unordered_map<uint64_t, uint32_t> owners;
+
+    auto join = [&](uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if(a == b) {
+            return;
+        }
+
+        if(components[a].pixels.size() < components[b].pixels.size()) {
+            std::swap(a, b);
+        }
+
+        auto& into = components[a];
+        auto& from = components[b];
+
+        into.pixels.insert(into.pixels.end(), from.pixels.begin(), from.pixels.end());
+        grow_box(into.bounding_box, from.bounding_box.bottom_left.x,
+                                    from.bounding_box.bottom_left.y);
+        grow_box(into.bounding_box, from.bounding_box.top_right.x,
+                                    from.bounding_box.top_right.y);
+        from.pixels.clear();
+
+        frontiers[a].insert(frontiers[a].end(), frontiers[b].begin(), frontiers[b].end());
+        frontiers[b].clear();
+
+        parent[b] = a;
+    };
+
+    auto claim = [&](uint32_t i, uint64_t index) {
+        if(auto it = owners.find(index); it != owners.end()) {
+            join(i, it->second);
+            return;
+        }
+
+        i = find(i);
+        owners.emplace(index, i);
+        components[i].pixels.push_back(index);
+        grow_box(components[i].bounding_box, index % width, index / width);
+        frontiers[i].push_back(index);
+    };
+
+    for(uint32_t i = 0; i < exits.size(); ++i) {
+        for(auto&& index : exits[i]) {
+            claim(i, index);
+        }
+    }
+
+    // The size of the largest piece which is known to be whole
+    size_t largest_complete = 0;
+
+    std::vector<uint32_t> growing;
+    for(uint32_t i = 0; i < components.size(); ++i) {
+        if(frontiers[i].empty()) {
+            largest_complete = std::max(largest_complete, components[i].pixels.size());
+        } else if(find(i) == i) {
+            growing.push_back(i);
+        }
+    }
+
+    while(!growing.empty()) {
+        // Drop every piece which either got joined into another, or which has
+        //   run out of pixels to grow into
+        std::vector<uint32_t> still_growing;
+        for(auto&& i : growing) {
+            if(find(i) != i) {
+                continue;
+            }
+
+            if(frontiers[i].empty()) {
+                largest_complete = std::max(largest_complete, components[i].pixels.size());
+            } else {
+                still_growing.push_back(i);
+            }
+        }
+        std::swap(growing, still_growing);
+
+        if(growing.size() == 1 &&
+           components[growing.front()].pixels.size() > largest_complete)
+        {
+            break;
+        }
+
+        for(auto&& i : growing) {
+            if(find(i) != i || frontiers[i].empty()) {
+                continue;
+            }
+
+            auto index = frontiers[i].front();
+            frontiers[i].pop_front();
+
+            uint32_t x = index % width;
+            uint32_t y = index / width;
+
+            auto visit = [&](uint32_t vx, uint32_t vy) {
+                auto vindex = xyToIndex(width, vx, vy);
+                if(prov_matrix[vindex] != id) {
+                    return;
+                }
+
+                if(in_window(vx, vy)) {
+                    join(i, labels[xyToIndex(window.w, vx - left, vy - top)] - 1);
+                } else {
+                    claim(i, vindex);
+                }
+            };
+
+            if(y > 0) visit(x, y - 1);
+            if(x + 1 < width) visit(x + 1, y);
+            if(y + 1 < height) visit(x, y + 1);
+            if(x > 0) visit(x - 1, y);
+        }
+    }
+
+    std::vector<ConnectedComponent> pieces;
+    for(uint32_t i = 0; i < components.size(); ++i) {
+        if(find(i) == i) {
+            components[i].complete = frontiers[i].empty();
+            pieces.push_back(std::move(components[i]));
+        }
+    }
+
+    std::stable_sort(pieces.begin(), pieces.end(),
+                     [](const auto& c1, const auto& c2) {
+                         return c1.pixels.size() > c2.pixels.size();
+                     });
+
+    return pieces;
+}
+
+/**
+ * @brief Trims every edge off of a bounding box which has no pixels of the
+ *        given province on it.
+ *
+ * @param id The province the bounding box is for
+ * @param bounding_box A bounding box which contains every pixel of id
+ *
+ * @return The smallest bounding box which contains every pixel of id, or the
+ *         given bounding box if id has no pixels in it.
+ */
+auto HMDT::Project::ProvinceProject::shrinkBoundingBox(const ProvinceID& id,
+                                                       const BoundingBox& bounding_box) const noexcept
+    -> BoundingBox
+{
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    uint32_t left = bounding_box.bottom_left.x;
+    uint32_t right = std::min(bounding_box.top_right.x, width - 1);
+    uint32_t top = bounding_box.top_right.y;
+    uint32_t bottom = std::min(bounding_box.bottom_left.y, height - 1);
+
+    if(left > right || top > bottom) {
+        return bounding_box;
+    }
+
+    auto row_has_pixel = [&](uint32_t y) {
+        for(uint32_t x = left; x <= right; ++x) {
+            if(prov_matrix[xyToIndex(width, x, y)] == id) return true;
+        }
+        return false;
+    };
+    auto column_has_pixel = [&](uint32_t x) {
+        for(uint32_t y = top; y <= bottom; ++y) {
+            if(prov_matrix[xyToIndex(width, x, y)] == id) return true;
+        }
+        return false;
+    };
+
+    while(top < bottom && !row_has_pixel(top)) ++top;
+    while(bottom > top && !row_has_pixel(bottom)) --bottom;
+    while(left < right && !column_has_pixel(left)) ++left;
+    while(right > left && !column_has_pixel(right)) --right;
+
+    return BoundingBox{ { left, bottom }, { right, top } };
+}
+
+/**
+ * @brief Rebuilds every layer of the map which is derived from the provinces
+ *        layer, but only for the given pixels and the outlines around them.
+ *
+ * @param pixels The index of every pixel to rebuild. The old province stored
+ *               alongside each index is ignored.
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the outlines could
+ *         not be rebuilt.
+ */
+auto HMDT::Project::ProvinceProject::rebuildPixels(const std::vector<std::pair<uint64_t, ProvinceID>>& pixels) noexcept
+    -> MaybeVoid
+{
+    if(pixels.empty()) {
+        return STATUS_SUCCESS;
+    }
+
+    auto [width, height] = getMapData()->getDimensions();
+    Dimensions dimensions{width, height};
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+    auto label_matrix = getMapData()->getLabelMatrix().lock();
+    auto graphics_data = getMapData()->getProvinceColors().lock();
+    auto state_id_matrix = getMapData()->getStateIDMatrix().lock();
+    auto outlines = getMapData()->getProvinceOutlines().lock();
+
+    uint32_t min_x = width;
+    uint32_t min_y = height;
+    uint32_t max_x = 0;
+    uint32_t max_y = 0;
+
+    for(auto&& [index, _] : pixels) {
+        const auto& prov_id = prov_matrix[index];
+
+        label_matrix[index] = prov_id.hash();
+
+        uint32_t x = index % width;
+        uint32_t y = index / width;
+
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+
+        if(!isValidProvinceID(prov_id)) {
+            WRITE_WARN("Province matrix has ID ", prov_id, " at position (",
+                       x, ',', y, "), which does not exist.");
+            continue;
+        }
+
+        const auto& province = getProvinceForID(prov_id);
+
+        // Flip the colors from RGB to BGR because BitMap is a bad format
+        graphics_data[index * 3] = province.unique_color.b;
+        graphics_data[index * 3 + 1] = province.unique_color.g;
+        graphics_data[index * 3 + 2] = province.unique_color.r;
+
+        state_id_matrix[index] = province.state;
+    }
+
+    // The outlines of the neighbors of every changed pixel may change as well
+    auto area = growBorderArea(dimensions,
+                               Rectangle{ min_x, min_y,
+                                          max_x - min_x + 1,
+                                          max_y - min_y + 1 });
+
+    auto result = buildBorderMask(dimensions, prov_matrix.get(),
+                                  state_id_matrix.get(), outlines.get(), area);
+    RETURN_IF_ERROR(result);
+
+    getMapData()->markStateIDMatrixUpdated();
+
+    getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_PROVINCES);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Updates the adjacencies of every province touched by an edit.
+ * @details Two provinces can only start touching where a pixel changed, so only
+ *          the changed pixels and their neighbors are looked at to find new
+ *          adjacencies. Only a province which lost pixels can stop touching one
+ *          of its old neighbors, and only if they no longer touch at any of the
+ *          changed pixels, in which case doProvincesTouch checks the rest.
+ *
+ * @param changed_pixels The index of every changed pixel. The old province
+ *                       stored alongside each index is ignored.
+ * @param old_adjacencies The adjacencies from before the edit of every
+ *                        province which lost pixels
+ */
+void HMDT::Project::ProvinceProject::updateAdjacencies(const std::vector<std::pair<uint64_t, ProvinceID>>& changed_pixels,
+                                                       const std::map<ProvinceID, std::set<ProvinceID>>& old_adjacencies) noexcept
+{
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    using ProvincePair = std::pair<ProvinceID, ProvinceID>;
+    auto make_pair = [](const ProvinceID& a, const ProvinceID& b) {
+        return (a < b) ? ProvincePair{ a, b } : ProvincePair{ b, a };
+    };
+
+    // Every pair which touches at a changed pixel
+    std::set<ProvincePair> touching;
+
+    for(auto&& [index, _] : changed_pixels) {
+        uint32_t x = index % width;
+        uint32_t y = index / width;
+
+        const auto& id = prov_matrix[index];
+
+        auto check = [&](uint32_t cx, uint32_t cy) {
+            if(const auto& adj_id = prov_matrix[xyToIndex(width, cx, cy)]; adj_id != id)
+            {
+                touching.insert(make_pair(id, adj_id));
+            }
+        };
+
+        if(y > 0) check(x, y - 1);
+        if(x + 1 < width) check(x + 1, y);
+        if(y + 1 < height) check(x, y + 1);
+        if(x > 0) check(x - 1, y);
+    }
+
+    for(auto&& [a, b] : touching) {
+        if(isValidProvinceID(a)) getProvinceForID(a).adjacent_provinces.insert(b);
+        if(isValidProvinceID(b)) getProvinceForID(b).adjacent_provinces.insert(a);
+    }
+
+    std::set<ProvincePair> checked;
+    for(auto&& [id, adjacencies] : old_adjacencies) {
+        for(auto&& adj_id : adjacencies) {
+            auto pair = make_pair(id, adj_id);
+            if(touching.count(pair) != 0 || !checked.insert(pair).second ||
+               doProvincesTouch(id, adj_id))
+            {
+                continue;
+            }
+
+            if(isValidProvinceID(id)) getProvinceForID(id).adjacent_provinces.erase(adj_id);
+            if(isValidProvinceID(adj_id)) getProvinceForID(adj_id).adjacent_provinces.erase(id);
+        }
+    }
+}
+
+/**
+ * @brief Checks if two provinces touch anywhere on the map.
+ * @details Only the overlap of their bounding boxes is searched.
+ *
+ * @param id1 The first province
+ * @param id2 The second province
+ *
+ * @return true if any pixel of id1 is next to a pixel of id2. Always false if
+ *         neither province exists.
+ */
+bool HMDT::Project::ProvinceProject::doProvincesTouch(const ProvinceID& id1,
+                                                      const ProvinceID& id2) const noexcept
+{
+    // Search along the province which exists, as its bounding box is known
+    bool valid1 = isValidProvinceID(id1);
+    bool valid2 = isValidProvinceID(id2);
+    if(!valid1 && !valid2) {
+        return false;
+    }
+
+    const auto& a = valid1 ? id1 : id2;
+    const auto& b = valid1 ? id2 : id1;
+
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    const auto& box = getProvinceForID(a).bounding_box;
+
+    uint32_t left = box.bottom_left.x;
+    uint32_t right = std::min(box.top_right.x, width - 1);
+    uint32_t top = box.top_right.y;
+    uint32_t bottom = std::min(box.bottom_left.y, height - 1);
+
+    // The pixels of a which touch b have to be within one pixel of b
+    if(valid1 && valid2) {
+        const auto& other_box = getProvinceForID(b).bounding_box;
+
+        left = std::max(left, (other_box.bottom_left.x > 0) ? other_box.bottom_left.x - 1 : 0);
+        right = std::min(right, other_box.top_right.x + 1);
+        top = std::max(top, (other_box.top_right.y > 0) ? other_box.top_right.y - 1 : 0);
+        bottom = std::min(bottom, other_box.bottom_left.y + 1);
+    }
+
+    for(uint32_t y = top; y <= bottom; ++y) {
+        for(uint32_t x = left; x <= right; ++x) {
+            if(prov_matrix[xyToIndex(width, x, y)] != a) {
+                continue;
+            }
+
+            if((y > 0 && prov_matrix[xyToIndex(width, x, y - 1)] == b) ||
+               (x + 1 < width && prov_matrix[xyToIndex(width, x + 1, y)] == b) ||
+               (y + 1 < height && prov_matrix[xyToIndex(width, x, y + 1)] == b) ||
+               (x > 0 && prov_matrix[xyToIndex(width, x - 1, y)] == b))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Builds the graphics data array
+ */
+void HMDT::Project::ProvinceProject::buildGraphicsData() {
+    // Rebuild the graphics data
+    auto [width, height] = getMapData()->getDimensions();
+
+    auto prov_matrix = getMapData()->getProvinces().lock();
+
+    auto graphics_data = getMapData()->getProvinceColors().lock();
+
+    // Rebuild the map_data array and the adjacency lists
+    for(uint32_t x = 0; x < width; ++x) {
+        for(uint32_t y = 0; y < height; ++y) {
+            // Get the index into the prov matrix
+            auto lindex = xyToIndex(width, x, y);
+
+            // Get the index into the graphics data
+            //  3 == the depth
+            auto gindex = xyToIndex(width * 3, x * 3, y);
+
+            auto id = prov_matrix[lindex];
+
+            // Error check
+            if(!isValidProvinceID(id)) {
+                WRITE_WARN("Province matrix has ID ", id,
+                           " at position (", x, ',', y, "), which does not exist.");
+                continue;
+            }
+
+            // Rebuild color data
+            auto& province = getProvinceForID(id);
+
+            // Flip the colors from RGB to BGR because BitMap is a bad format
+            graphics_data[gindex] = province.unique_color.b;
+            graphics_data[gindex + 1] = province.unique_color.g;
+            graphics_data[gindex + 2] = province.unique_color.r;
+        }
+    }
+}
+
+/**
+ * @brief Gets the province colors in a form that's ready to be exported.
+ *
+ * @return A new flat array containing all pixel colors, or nullptr if a failure
+ *         occurs
+ */
+auto HMDT::Project::ProvinceProject::getProvinceColorsForExport() const noexcept
+    -> std::unique_ptr<unsigned char[]>
+{
+    auto province_colors = getMapData()->getProvinceColors().lock();
+    auto prov_matrix = getMapData()->getProvinces().lock();
+    auto [width, height] = getMapData()->getDimensions();
+
+    std::unique_ptr<unsigned char[]> exportable_colors(new unsigned char[getMapData()->getProvinceColorsSize()]);
+
+    // TODO: Can we parallelize this?
+    for(uint32_t x = 0; x < width; ++x) {
+        for(uint32_t y = 0; y < height; ++y) {
+            // Get the index into the prov matrix
+            auto lindex = xyToIndex(width, x, y);
+
+            // Get the index into the graphics data
+            //  3 == the depth
+            auto gindex = xyToIndex(width * 3, x * 3, y);
+
+            auto id = prov_matrix[lindex];
+
+            // Error check
+            if(!isValidProvinceID(id)) {
+                WRITE_WARN("Province matrix has ID ", id,
+                           " at position (", x, ',', y, "), which does not exist.");
+                continue;
+            }
+
+            // Rebuild color data
+            auto maybe_root = getRootProvinceParent(id);
+            // TODO: We should really figure out how to return the error code up
+            //   from here. The reason we can't is because we cannot build a
+            //   Maybe<unique_ptr>
+            RETURN_VALUE_IF_ERROR(maybe_root, nullptr);
+
+            exportable_colors[gindex] = maybe_root->get().unique_color.r;
+            exportable_colors[gindex + 1] = maybe_root->get().unique_color.g;
+            exportable_colors[gindex + 2] = maybe_root->get().unique_color.b;
+        }
+    }
+
+    return exportable_colors;
+}
+
+/**
+ * @brief Gets province preview data for the given ID
+ *
+ * @param id
+ *
+ * @return The preview data, or nullptr if the ID does not exist
+ */
+auto HMDT::Project::ProvinceProject::getPreviewData(ProvinceID id)
     -> ProvinceDataPtr
 {
     if(isValidProvinceID(id)) {
@@ -1009,20 +2624,109 @@ auto HMDT::Project::ProvinceProject::getOldIDToUUIDMap() const noexcept
 
 uint32_t HMDT::Project::ProvinceProject::getIDForProvinceID(const ProvinceID& id) const noexcept
 {
-    return m_uuid_to_oldid.at(id);
+    return m_uuid_to_export_id.at(id);
 }
 
 /**
- * @brief Rebuilds the mapping of UUID->ID.
- * @details This should be called every time m_provinces changes/is updated.
+ * @brief Rebuilds the mapping of UUID->ID from scratch, throwing away every
+ *        existing export ID.
+ * @details This should only be called when every province has been replaced,
+ *          such as on import. Edits to existing provinces should use
+ *          assignExportIDs instead, so that provinces keep their IDs.
  */
 void HMDT::Project::ProvinceProject::rebuildUUIDToIDMap() noexcept {
     // Clear the old map out first
     m_uuid_to_oldid.clear();
+    m_next_export_id = 1;
 
-    uint32_t i = 0;
+    std::vector<ProvinceID> ids;
+    ids.reserve(m_provinces.size());
     for(auto&& [id, _] : m_provinces) {
-        m_uuid_to_oldid[id] = ++i;
+        ids.push_back(id);
+    }
+
+    assignExportIDs(std::move(ids));
+}
+
+/**
+ * @brief Gives every province which does not have an export ID yet the next
+ *        unused one.
+ * @details Provinces are numbered in order of their UUIDs, so that the same
+ *          provinces always get the same IDs no matter what order they are
+ *          given in. Only the given provinces are looked at.
+ *
+ * @param ids The provinces to number
+ */
+void HMDT::Project::ProvinceProject::assignExportIDs(std::vector<ProvinceID> ids) noexcept
+{
+    ids.erase(std::remove_if(ids.begin(), ids.end(),
+                             [this](const ProvinceID& id) {
+                                 return m_uuid_to_oldid.count(id) != 0;
+                             }),
+              ids.end());
+    std::sort(ids.begin(), ids.end());
+
+    for(auto&& id : ids) {
+        m_uuid_to_oldid[id] = m_next_export_id++;
+    }
+
+    renumberExportIDs();
+}
+
+/**
+ * @brief Takes back the export IDs of provinces which were removed by undoing
+ *        the edit that created them.
+ * @details Edits are undone in the reverse order that they were made in, so
+ *          these are normally the highest IDs, which are then given out again
+ *          to the next new provinces.
+ *
+ * @param ids The provinces which no longer exist
+ */
+void HMDT::Project::ProvinceProject::releaseExportIDs(const std::vector<ProvinceID>& ids) noexcept
+{
+    std::vector<uint32_t> released;
+    released.reserve(ids.size());
+    for(auto&& id : ids) {
+        if(auto it = m_uuid_to_oldid.find(id); it != m_uuid_to_oldid.end()) {
+            released.push_back(it->second);
+            m_uuid_to_oldid.erase(it);
+        }
+    }
+
+    std::sort(released.begin(), released.end(), std::greater<uint32_t>());
+    for(auto&& export_id : released) {
+        if(export_id + 1 != m_next_export_id) break;
+
+        --m_next_export_id;
+    }
+
+    renumberExportIDs();
+}
+
+/**
+ * @brief Numbers every province which still exists from 1, in the order of
+ *        their saved export IDs.
+ * @details Provinces which get removed keep their saved IDs so that undoing
+ *          the removal gives them back, which leaves gaps that HoI4 does not
+ *          allow. Every exporter goes through these IDs instead, so they all
+ *          agree with each other without the saved IDs changing.
+ */
+void HMDT::Project::ProvinceProject::renumberExportIDs() noexcept {
+    std::vector<std::pair<uint32_t, ProvinceID>> saved_ids;
+    saved_ids.reserve(m_provinces.size());
+    for(auto&& [id, _] : m_provinces) {
+        if(auto it = m_uuid_to_oldid.find(id); it != m_uuid_to_oldid.end()) {
+            saved_ids.emplace_back(it->second, id);
+        }
+    }
+
+    std::sort(saved_ids.begin(), saved_ids.end());
+
+    m_uuid_to_export_id.clear();
+
+    uint32_t export_id = 1;
+    for(auto&& [_, id] : saved_ids) {
+        m_uuid_to_export_id[id] = export_id++;
     }
 }
 
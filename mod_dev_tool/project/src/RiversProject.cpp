@@ -1,6 +1,7 @@
 
 #include "RiversProject.h"
 
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <memory>
@@ -12,6 +13,9 @@
 #include "MapData.h"
 #include "Util.h"
 
+#include "RiverGenerator.h"
+#include "RiverValidator.h"
+#include "TileHash.h"
 #include "WorldNormalBuilder.h"
 
 #include "ProjectNode.h"
@@ -84,7 +88,9 @@ auto HMDT::Project::RiversProject::export_(const std::filesystem::path& root) co
                         getMapData()->getRivers().lock().get(),
                         getMapData()->getWidth(), getMapData()->getHeight(),
                         1 /* depth */,
-                        true /* is_greyscale */);
+                        false /* is_greyscale */,
+                        BMPHeaderToUse::V4 /* version */,
+                        generateColorTable());
         RETURN_IF_ERROR(res);
     } else {
         WRITE_WARN("No imported rivers file exists.");
@@ -156,52 +162,241 @@ auto HMDT::Project::RiversProject::getRootMapParent() const
     return m_parent_project.getRootMapParent();
 }
 
+/**
+ * @brief Loads a rivers map.
+ * @details The currently loaded rivers are only replaced once the new ones
+ *          have been completely loaded, so they are left untouched on failure.
+ *
+ * @param path The path to the rivers map
+ *
+ * @return STATUS_SUCCESS on success, or an error code on failure.
+ */
 auto HMDT::Project::RiversProject::loadFile(const std::filesystem::path& path) noexcept
     -> MaybeVoid
 {
+    auto bpp = checkFile(path);
+    RETURN_IF_ERROR(bpp);
+
+    LayerLoadProgress progress;
+
+    auto rivers_bmp = prepareFile(path, progress);
+    RETURN_IF_ERROR(rivers_bmp);
+
+    auto res = commitFile(*rivers_bmp);
+    RETURN_IF_ERROR(res);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Checks only the header of a rivers map, so that it can be rejected
+ *        before it is actually loaded.
+ *
+ * @param path The path to the rivers map
+ *
+ * @return The bits per pixel of the rivers map if it can be loaded, or an
+ *         error code otherwise.
+ */
+auto HMDT::Project::RiversProject::checkFile(const std::filesystem::path& path) const noexcept
+    -> Maybe<uint16_t>
+{
+    BitMap2 header;
+
+    auto res = readBMPHeader(path, header);
+    RETURN_IF_ERROR(res);
+
+    if(auto d = getMapData()->getDimensions();
+            d.first != header.info_header.v1.width ||
+            d.second != header.info_header.v1.height)
+    {
+        WRITE_ERROR("Rivers dimensions (",
+                    header.info_header.v1.width, ", ",
+                    header.info_header.v1.height, ") do not match the"
+                    " previously loaded dimensions (", d.first, ", ", d.second,
+                    ")");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+
+    // Rivers are indexed, so unlike the heightmap there is no sensible way to
+    //   convert them
+    if(auto bpp = header.info_header.v1.bitsPerPixel; bpp != 8) {
+        WRITE_ERROR("Rivers must be 8-bit images, not ", bpp, ".");
+        RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+    }
+
+    return header.info_header.v1.bitsPerPixel;
+}
+
+/**
+ * @brief Loads a rivers map without touching the project, so that it is safe
+ *        to call from a worker thread.
+ * @details The load is stopped between each stage if progress.estop() is
+ *          called. Hand the result to commitFile to actually use it.
+ *
+ * @param path The path to the rivers map
+ * @param progress Tracks the progress of the load
+ *
+ * @return The loaded rivers map, or an error code. If the load was stopped
+ *         early then STATUS_LOAD_CANCELLED is returned.
+ */
+auto HMDT::Project::RiversProject::prepareFile(const std::filesystem::path& path,
+                                               LayerLoadProgress& progress) const noexcept
+    -> Maybe<std::shared_ptr<BitMap2>>
+{
+    std::shared_ptr<BitMap2> rivers_bmp;
+
+    progress.setStage(LayerLoadProgress::Stage::READING);
     try {
-        m_rivers_bmp.reset(new BitMap2);
+        rivers_bmp.reset(new BitMap2);
     } catch(const std::bad_alloc& e) {
         WRITE_ERROR("Failed to allocate space for new bitmap: ", e.what());
         RETURN_ERROR(STATUS_BADALLOC);
     }
 
-    auto res = readBMP(path, m_rivers_bmp);
+    auto res = readBMP(path, rivers_bmp);
     RETURN_IF_ERROR(res);
 
-    WRITE_DEBUG(*m_rivers_bmp);
+    WRITE_DEBUG(*rivers_bmp);
 
     if(auto d = getMapData()->getDimensions();
-            d.first != m_rivers_bmp->info_header.v1.width ||
-            d.second != m_rivers_bmp->info_header.v1.height)
+            d.first != rivers_bmp->info_header.v1.width ||
+            d.second != rivers_bmp->info_header.v1.height)
     {
         WRITE_ERROR("Rivers dimensions (",
-                    m_rivers_bmp->info_header.v1.width, ", ",
-                    m_rivers_bmp->info_header.v1.height, ") do not match the"
+                    rivers_bmp->info_header.v1.width, ", ",
+                    rivers_bmp->info_header.v1.height, ") do not match the"
                     " previously loaded dimensions (", d.first, ", ", d.second,
                     ")");
         RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
     }
 
     // Just in case the input image is not actually an 8-bit images
-    uint8_t* rivers_data;
-    if(auto bpp = m_rivers_bmp->info_header.v1.bitsPerPixel; bpp != 8) {
+    if(auto bpp = rivers_bmp->info_header.v1.bitsPerPixel; bpp != 8) {
         WRITE_ERROR("Rivers must be 8-bit images, not ", bpp, ".");
         RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
     }
 
-    rivers_data = m_rivers_bmp->data.get();
+    RETURN_ERROR_IF(progress.isStopped(), STATUS_LOAD_CANCELLED);
+
+    progress.setStage(LayerLoadProgress::Stage::DONE);
+
+    return rivers_bmp;
+}
+
+/**
+ * @brief Hands a rivers map loaded by prepareFile off to the project,
+ *        replacing the current one all at once.
+ *
+ * @param rivers_bmp The rivers map returned by prepareFile
+ *
+ * @return STATUS_SUCCESS on success, or an error code if the rivers map no
+ *         longer fits the map.
+ */
+auto HMDT::Project::RiversProject::commitFile(std::shared_ptr<BitMap2> rivers_bmp) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(rivers_bmp == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto map_data = getMapData();
+
+    // The map may have changed while the rivers were being loaded
+    if(auto d = map_data->getDimensions();
+            d.first != rivers_bmp->info_header.v1.width ||
+            d.second != rivers_bmp->info_header.v1.height)
+    {
+        WRITE_ERROR("Rivers dimensions no longer match the map.");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+    RETURN_ERROR_IF(rivers_bmp->info_header.v1.bitsPerPixel != 8,
+                    STATUS_INVALID_BIT_DEPTH);
 
     // Load rivers data into MapData
     // This operation is fairly simple, as we are not making any modifications
     //   to the data itself, and just loading it into memory
-    std::memcpy(getMapData()->getRivers().lock().get(),
-                rivers_data,
-                getMapData()->getRiversSize());
+    std::memcpy(map_data->getRivers().lock().get(),
+                rivers_bmp->data.get(),
+                map_data->getRiversSize());
+
+    m_rivers_bmp = rivers_bmp;
+
+    getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_RIVERS);
 
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Replaces the rivers with a new version of them, only touching the
+ *        tiles which actually changed.
+ *
+ * @param rivers_bmp The new rivers map, as returned by prepareFile
+ *
+ * @return Every tile which changed, or an error code if the rivers map does
+ *         not fit the map.
+ */
+auto HMDT::Project::RiversProject::commitChangedTiles(std::shared_ptr<BitMap2> rivers_bmp) noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    RETURN_ERROR_IF(rivers_bmp == nullptr, STATUS_PARAM_CANNOT_BE_NULL);
+
+    auto map_data = getMapData();
+    auto width = map_data->getWidth();
+    auto height = map_data->getHeight();
+
+    if(width != rivers_bmp->info_header.v1.width ||
+       height != rivers_bmp->info_header.v1.height)
+    {
+        WRITE_ERROR("Rivers dimensions no longer match the map.");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+    RETURN_ERROR_IF(rivers_bmp->info_header.v1.bitsPerPixel != 8,
+                    STATUS_INVALID_BIT_DEPTH);
+
+    auto rivers = map_data->getRivers().lock();
+
+    auto changed = findChangedTiles({ width, height }, rivers.get(),
+                                    rivers_bmp->data.get(), 1 /* depth */,
+                                    LAYER_RELOAD_TILE_SIZE);
+    RETURN_IF_ERROR(changed);
+
+    for(auto&& tile : *changed) {
+        for(uint32_t y = tile.y; y < tile.y + tile.h; ++y) {
+            auto index = xyToIndex(width, tile.x, y);
+            std::memcpy(rivers.get() + index, rivers_bmp->data.get() + index,
+                        tile.w);
+        }
+    }
+
+    // The color table may have changed too, so always take the new bitmap
+    m_rivers_bmp = rivers_bmp;
+
+    if(!changed->empty()) {
+        getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_RIVERS);
+    }
+
+    WRITE_DEBUG(changed->size(), " rivers tiles changed.");
+
+    return changed;
+}
+
+/**
+ * @brief Reloads a rivers map which was edited outside of the tool, only
+ *        updating the tiles which changed.
+ *
+ * @param path The path to the rivers map
+ *
+ * @return Every tile which changed, or an error code on failure.
+ */
+auto HMDT::Project::RiversProject::reloadFile(const std::filesystem::path& path) noexcept
+    -> Maybe<std::vector<Rectangle>>
+{
+    LayerLoadProgress progress;
+
+    auto rivers_bmp = prepareFile(path, progress);
+    RETURN_IF_ERROR(rivers_bmp);
+
+    return commitChangedTiles(*rivers_bmp);
+}
+
 auto HMDT::Project::RiversProject::getBitMap() const
     -> MonadOptionalRef<const BitMap2>
 {
@@ -233,6 +428,125 @@ auto HMDT::Project::RiversProject::writeTemplate(const std::filesystem::path& pa
     return STATUS_SUCCESS;
 }
 
+/**
+ * @brief Generates rivers from the heightmap, replacing any rivers which were
+ *        already loaded.
+ *
+ * @param min_catchment How many pixels must drain through a pixel for it to be
+ *                      a river
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::Project::RiversProject::generateRivers(uint32_t min_catchment) noexcept
+    -> MaybeVoid
+{
+    WRITE_INFO("Generating rivers from the heightmap...");
+
+    auto map_data = getMapData();
+
+    std::shared_ptr<BitMap2> rivers_bmp;
+    try {
+        rivers_bmp.reset(new BitMap2{});
+        rivers_bmp->data.reset(new unsigned char[map_data->getRiversSize()]);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for new bitmap: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    auto res = createBMP2(*rivers_bmp,
+                          map_data->getWidth(), map_data->getHeight(),
+                          1 /* depth */,
+                          false /* is_greyscale */,
+                          BMPHeaderToUse::V4 /* version */,
+                          generateColorTable());
+    RETURN_IF_ERROR(res);
+
+    res = HMDT::generateRivers({ map_data->getWidth(), map_data->getHeight() },
+                               map_data->getHeightMap().lock().get(),
+                               map_data->getProvinces().lock().get(),
+                               getRootMapParent().getProvinceProject().getProvinces(),
+                               min_catchment,
+                               rivers_bmp->data.get());
+    RETURN_IF_ERROR(res);
+
+    std::memcpy(map_data->getRivers().lock().get(),
+                rivers_bmp->data.get(),
+                map_data->getRiversSize());
+
+    m_rivers_bmp = rivers_bmp;
+
+    getRootMapParent().invalidateProvinceStatistics(ZONAL_LAYER_RIVERS);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Finds every mistake in the rivers which would stop HoI4 from drawing
+ *        them correctly.
+ *
+ * @return Every mistake found, ordered by position.
+ */
+auto HMDT::Project::RiversProject::validateRivers() const noexcept
+    -> Maybe<std::vector<RiverIssue>>
+{
+    WRITE_INFO("Validating rivers...");
+
+    auto map_data = getMapData();
+
+    return HMDT::validateRivers({ map_data->getWidth(), map_data->getHeight() },
+                                map_data->getRivers().lock().get(),
+                                generatePalette(),
+                                map_data->getProvinces().lock().get(),
+                                getRootMapParent().getProvinceProject().getProvinces());
+}
+
+/**
+ * @brief Works out which rivers color every value in the rivers map stands
+ *        for.
+ * @details A rivers file loaded from disk may have its colors in any order, or
+ *          have colors which are not valid for rivers at all, so each entry of
+ *          its color table is matched against the one we generate. If there is
+ *          no color table, then every value is assumed to already be an index
+ *          into ours.
+ *
+ * @return The palette of the currently loaded rivers
+ */
+auto HMDT::Project::RiversProject::generatePalette() const noexcept
+    -> RiverPalette
+{
+    auto expected = generateColorTable();
+
+    RiverPalette palette;
+    palette.fill(INVALID_RIVER_COLOR);
+
+    if(m_rivers_bmp == nullptr || m_rivers_bmp->color_table == nullptr) {
+        for(uint32_t i = 0; i < expected.num_colors; ++i) {
+            palette[i] = i;
+        }
+        return palette;
+    }
+
+    auto colors_used = std::min<uint32_t>(m_rivers_bmp->info_header.v1.colorsUsed,
+                                          palette.size());
+    for(uint32_t i = 0; i < colors_used; ++i) {
+        const auto& color = m_rivers_bmp->color_table[i];
+
+        for(uint32_t j = 0; j < expected.num_colors; ++j) {
+            const auto& expected_color = expected.color_table[j];
+
+            if(color.blue == expected_color.blue &&
+               color.green == expected_color.green &&
+               color.red == expected_color.red)
+            {
+                palette[i] = j;
+                break;
+            }
+        }
+    }
+
+    return palette;
+}
+
 auto HMDT::Project::RiversProject::generateTemplate(std::unique_ptr<uint8_t[]>& data) const noexcept
     -> MaybeVoid
 {
@@ -257,14 +571,14 @@ auto HMDT::Project::RiversProject::generateTemplate(std::unique_ptr<uint8_t[]>&
 
         switch(prov_type) {
             case ProvinceType::LAND:
-                data[i] = 12;
+                data[i] = RIVER_LAND_INDEX;
                 break;
             case ProvinceType::LAKE:
             case ProvinceType::SEA:
-                data[i] = 13;
+                data[i] = RIVER_WATER_INDEX;
                 break;
             case ProvinceType::UNKNOWN:
-                data[i] = 14;
+                data[i] = RIVER_UNKNOWN_INDEX;
                 break;
         }
     }
@@ -1,6 +1,7 @@
 
 #include "StateProject.h"
 
+#include <algorithm>
 #include <fstream>
 #include <cstring>
 #include <cerrno>
@@ -8,6 +9,8 @@
 #include "Logger.h"
 
 #include "Util.h"
+#include "BorderMask.h"
+#include "RecordParser.h"
 #include "Options.h"
 #include "Constants.h"
 #include "StatusCodes.h"
@@ -105,107 +108,108 @@ auto HMDT::Project::StateProject::load(const std::filesystem::path& root)
         return std::make_error_code(std::errc::no_such_file_or_directory);
     }
 
-    if(std::ifstream in(path); in) {
-        // Make sure we clear out the states map first just in case there is
-        //   some data in here (there shouldn't be)
-        m_states.clear();
-
-        // FORMAT:
-        //   ID;<State Name>;MANPOWER;<CATEGORY>;BUILDINGS_MAX_LEVEL_FACTOR;IMPASSABLE;PROVID1,PROVID2,...
-        std::string line;
-        for(size_t line_num = 0; std::getline(in, line); ++line_num) {
-            if(line.empty()) continue;
-
-            std::istringstream iss(line);
-
-            State state;
-            state.color = Color{0,0,0}; // Initialize this to nothing
-
-            std::string prov_id_data;
-            if(!parseValuesSkipMissing<';'>(iss, &state.id,
-                                                 &state.name,
-                                                 &state.manpower,
-                                                 &state.category,
-                                                 &state.buildings_max_level_factor,
-                                                 &state.impassable,
-                                                 &prov_id_data, true,
-                                                 &state.color.r, true,
-                                                 &state.color.g, true,
-                                                 &state.color.b, true))
-            {
-                WRITE_ERROR("Failed to parse line #", line_num, ": '", line, "'");
-                RETURN_ERROR(std::make_error_code(std::errc::bad_message));
-            }
-
-            WRITE_DEBUG("Reading state data {"
-                        "id=", state.id, ", "
-                        "name=", state.name, ", "
-                        "manpower=", state.manpower, ", "
-                        "category=", state.category, ", "
-                        "buildings_max_level_factor=", state.buildings_max_level_factor, ", "
-                        "impassable=", state.impassable, ", "
-                        "prov_id_data=<DATA>, "
-                        "color={",
-                        "r=", state.color.r, ", "
-                        "g=", state.color.g, ", "
-                        "b=", state.color.b, "}"
-                        "}"
-            );
-
-            // If we did not load a state color, then the color should be 0,0,0
-            // In that case, we want to generate a new unique color value
-            if(state.color == Color{0,0,0}) {
-                WRITE_WARN("Saved state data did not have a color value, generating a new one...");
-                state.color = generateUniqueColor(ProvinceType::UNKNOWN);
-            } else {
-                generateUniqueColor(ProvinceType::UNKNOWN); // "generate" a color to advance the number of colors by 1
-            }
+    auto contents = readFileToString(path);
+    RETURN_IF_ERROR(contents);
+
+    // Make sure we clear out the states map first just in case there is
+    //   some data in here (there shouldn't be)
+    m_states.clear();
+
+    // Projects from before UUIDs were introduced list their provinces by
+    //   their old numeric IDs
+    bool uses_old_ids = getRootParent().getToolVersion() <= "0.25.0"_V;
+    const auto& oldid_to_uuid_map = getRootParent().getMapProject().getProvinceProject().getOldIDToUUIDMap();
+
+    // FORMAT:
+    //   ID;<State Name>;MANPOWER;<CATEGORY>;BUILDINGS_MAX_LEVEL_FACTOR;IMPASSABLE;PROVID1,PROVID2,...;R;G;B
+    RecordParser parser(*contents, ';');
+    parser.setAllowTrailingCharacters();
+    while(parser.nextRecord()) {
+        State state;
+        state.color = Color{0,0,0}; // Initialize this to nothing
+
+        auto res = parser.parseFields(state.id,
+                                      state.name,
+                                      state.manpower,
+                                      state.category,
+                                      state.buildings_max_level_factor,
+                                      state.impassable);
+
+        // We need to parse the provinces seperately
+        if(IS_SUCCESS(res) && uses_old_ids) {
+            res = parser.parseListField<uint32_t>(',',
+                    [&state, &oldid_to_uuid_map](uint32_t oldid) -> MaybeVoid {
+                        if(oldid_to_uuid_map.count(oldid) == 0) {
+                            WRITE_ERROR("Could not find old id ", oldid, " in oldid to UUID mapping!");
+                            RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+                        }
 
-            // We need to parse the provinces seperately
-            bool err = false;
-            state.provinces = splitAndTransform<ProvinceID>(prov_id_data, ',',
-                    [this, &err](const std::string& v) {
-                        if(getRootParent().getToolVersion() <= "0.25.0"_V) {
-                            auto oldid = std::atoi(v.c_str());
+                        state.provinces.push_back(oldid_to_uuid_map.at(oldid));
+                        return STATUS_SUCCESS;
+                    });
+        } else if(IS_SUCCESS(res)) {
+            res = parser.parseListField<ProvinceID>(',',
+                    [&state](const ProvinceID& id) -> MaybeVoid {
+                        state.provinces.push_back(id);
+                        return STATUS_SUCCESS;
+                    });
+        }
 
-                            const auto& oldid_to_uuid_map = getRootParent().getMapProject().getProvinceProject().getOldIDToUUIDMap();
+        if(IS_SUCCESS(res)) {
+            res = parser.parseOptionalFields(state.color.r,
+                                             state.color.g,
+                                             state.color.b);
+        }
 
-                            if(oldid_to_uuid_map.count(oldid) == 0) {
-                                WRITE_ERROR("Could not find old id ", oldid, " in oldid to UUID mapping!");
-                                err = true;
-                                return EMPTY_UUID;
-                            }
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to parse line #", parser.getLineNumber(),
+                        " of ", path, ": '", parser.getRecord(), "'");
+            RETURN_IF_ERROR(res);
+        }
 
-                            return oldid_to_uuid_map.at(oldid);
-                        } else {
-                            return UUID::parse(v).orElse(EMPTY_UUID);
-                        }
-                    });
-            RETURN_ERROR_IF(err, STATUS_VALUE_NOT_FOUND);
-
-            if(m_states.count(state.id) != 0) {
-                WRITE_ERROR("Found multiple states with the same ID of ", state.id, "! We will skip the second one '", state.name, "' and keep '", m_states.at(state.id).name, '\'');
-            } else {
-                WRITE_DEBUG("Successfully loaded state ID ", state.id,
-                            " named ", state.name);
-                m_states[state.id] = state;
-            }
+        WRITE_DEBUG("Reading state data {"
+                    "id=", state.id, ", "
+                    "name=", state.name, ", "
+                    "manpower=", state.manpower, ", "
+                    "category=", state.category, ", "
+                    "buildings_max_level_factor=", state.buildings_max_level_factor, ", "
+                    "impassable=", state.impassable, ", "
+                    "provinces=", state.provinces.size(), ", "
+                    "color={",
+                    "r=", state.color.r, ", "
+                    "g=", state.color.g, ", "
+                    "b=", state.color.b, "}"
+                    "}"
+        );
+
+        // If we did not load a state color, then the color should be 0,0,0
+        // In that case, we want to generate a new unique color value
+        if(state.color == Color{0,0,0}) {
+            WRITE_WARN("Saved state data did not have a color value, generating a new one...");
+            state.color = generateUniqueColor(ProvinceType::UNKNOWN);
+        } else {
+            generateUniqueColor(ProvinceType::UNKNOWN); // "generate" a color to advance the number of colors by 1
         }
 
-        // Now that we've loaded every single state, we need to track which IDs
-        //  have not been used yet
-        for(StateID id = 1; id < m_states.size(); ++id) {
-            if(m_states.count(id) == 0) {
-                m_available_state_ids.push(id);
-            }
+        if(m_states.count(state.id) != 0) {
+            WRITE_ERROR("Found multiple states with the same ID of ", state.id, "! We will skip the second one '", state.name, "' and keep '", m_states.at(state.id).name, '\'');
+        } else {
+            WRITE_DEBUG("Successfully loaded state ID ", state.id,
+                        " named ", state.name);
+            m_states[state.id] = state;
         }
+    }
 
-        updateStateIDMatrix();
-    } else {
-        WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
-        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    // Now that we've loaded every single state, we need to track which IDs
+    //  have not been used yet
+    for(StateID id = 1; id < m_states.size(); ++id) {
+        if(m_states.count(id) == 0) {
+            m_available_state_ids.push(id);
+        }
     }
 
+    updateStateIDMatrix();
+
     return STATUS_SUCCESS;
 }
 
@@ -381,25 +385,120 @@ auto HMDT::Project::StateProject::getStates() const -> const StateMap& {
     return m_states;
 }
 
+/**
+ * @brief Replaces every state with those of an existing mod. The provinces
+ *        must have already been imported, as the mod's states refer to them by
+ *        their numeric IDs.
+ *
+ * @param definitions Every state defined by the mod
+ *
+ * @return STATUS_SUCCESS
+ */
+auto HMDT::Project::StateProject::importStates(const std::vector<StateDefinition>& definitions) noexcept
+    -> MaybeVoid
+{
+    auto& province_project = getRootParent().getMapProject().getProvinceProject();
+    const auto& oldid_to_uuid_map = province_project.getOldIDToUUIDMap();
+
+    m_states.clear();
+    m_available_state_ids = std::queue<StateID>{};
+
+    StateID max_id = 0;
+    for(auto&& definition : definitions) {
+        if(definition.id == 0) {
+            WRITE_WARN("State '", definition.name, "' has no ID. Skipping it.");
+            continue;
+        }
+
+        if(m_states.count(definition.id) != 0) {
+            WRITE_ERROR("Found multiple states with the same ID of ",
+                        definition.id, "! We will skip the second one '",
+                        definition.name, "' and keep '",
+                        m_states.at(definition.id).name, '\'');
+            continue;
+        }
+
+        State state{
+            definition.id,
+            definition.name,
+            definition.manpower,
+            definition.category,
+            definition.buildings_max_level_factor,
+            definition.impassable,
+            { },
+            generateUniqueColor(ProvinceType::UNKNOWN)
+        };
+
+        for(auto oldid : definition.provinces) {
+            if(oldid_to_uuid_map.count(oldid) == 0) {
+                WRITE_WARN("State ", definition.id, " has province ", oldid,
+                           ", which does not exist. Skipping it.");
+                continue;
+            }
+
+            auto& province = province_project.getProvinceForID(oldid_to_uuid_map.at(oldid));
+            if(province.state != 0) {
+                WRITE_WARN("Province ", oldid, " is in both state ",
+                           province.state, " and state ", definition.id,
+                           ". Keeping it in state ", province.state, '.');
+                continue;
+            }
+
+            province.state = definition.id;
+            state.provinces.push_back(province.id);
+        }
+
+        max_id = std::max(max_id, definition.id);
+        m_states[definition.id] = std::move(state);
+    }
+
+    // Track which IDs are not used, so that new states fill in the gaps first
+    for(StateID id = 1; id < max_id; ++id) {
+        if(m_states.count(id) == 0) {
+            m_available_state_ids.push(id);
+        }
+    }
+
+    updateStateIDMatrix();
+
+    return STATUS_SUCCESS;
+}
+
 void HMDT::Project::StateProject::updateStateIDMatrix() {
     auto state_id_matrix = getMapData()->getStateIDMatrix().lock();
 
     auto label_matrix = getMapData()->getProvinces().lock();
 
     auto* label_matrix_start = label_matrix.get();
+    auto* state_id_matrix_start = state_id_matrix.get();
 
-    parallelTransform(label_matrix_start, label_matrix_start + getMapData()->getProvincesSize(),
-                      state_id_matrix.get(),
-                      [this](ProvinceID prov_id) -> StateID {
-                          if(getRootParent().getMapProject().getProvinceProject().isValidProvinceID(prov_id))
-                          {
-                              return getRootParent().getMapProject().getProvinceProject().getProvinceForID(prov_id).state;
-                          } else {
-                              WRITE_WARN("Invalid province ID ", prov_id,
-                                         " detected when building state id matrix. Treating as though there's no state here.");
-                              return 0;
-                          }
-                      });
+    auto& province_project = getRootParent().getMapProject().getProvinceProject();
+
+    mapProvinceMatrix(label_matrix_start, getMapData()->getProvincesSize(),
+                      state_id_matrix_start,
+                      [&province_project](const ProvinceID& id) -> StateID
+    {
+        if(province_project.isValidProvinceID(id)) {
+            return province_project.getProvinceForID(id).state;
+        }
+
+        WRITE_WARN("Invalid province ID ", id,
+                   " detected when building state id matrix. Treating as though there's no state here.");
+        return 0;
+    });
+
+    // State borders are always also province borders, so only the pixels
+    //   which are already marked as a province border need to be updated
+    if(auto outlines = getMapData()->getProvinceOutlines().lock(); outlines) {
+        auto [width, height] = getMapData()->getDimensions();
+
+        auto result = updateStateBorderMask(Dimensions{ width, height },
+                                            state_id_matrix.get(),
+                                            outlines.get());
+        WRITE_IF_ERROR(result);
+    }
+
+    getMapData()->markStateIDMatrixUpdated();
 
     if(prog_opts.debug) {
         auto path = getRootParent().getDebugRoot();
@@ -427,6 +526,80 @@ void HMDT::Project::StateProject::updateStateIDMatrix() {
     WRITE_DEBUG("Done updating State ID matrix.");
 }
 
+/**
+ * @brief Updates the state ID matrix and the state borders for only the given
+ *        provinces, such as after they were moved to another state.
+ * @details Only the bounding boxes of the given provinces are visited, so the
+ *          cost is bounded by the size of the provinces rather than by the size
+ *          of the map. Their bounding boxes must be correct.
+ *
+ * @param province_ids The provinces whose state changed
+ */
+void HMDT::Project::StateProject::updateStateIDMatrix(const std::vector<ProvinceID>& province_ids)
+{
+    auto state_id_matrix = getMapData()->getStateIDMatrix().lock();
+    auto prov_matrix = getMapData()->getProvinces().lock();
+    auto outlines = getMapData()->getProvinceOutlines().lock();
+
+    auto [width, height] = getMapData()->getDimensions();
+    Dimensions dimensions{width, height};
+
+    auto& province_project = getRootParent().getMapProject().getProvinceProject();
+
+    uint32_t min_x = width;
+    uint32_t min_y = height;
+    uint32_t max_x = 0;
+    uint32_t max_y = 0;
+
+    for(auto&& id : province_ids) {
+        if(!province_project.isValidProvinceID(id)) {
+            WRITE_WARN("Invalid province ID ", id,
+                       " given when updating the state id matrix. Skipping it.");
+            continue;
+        }
+
+        const auto& province = province_project.getProvinceForID(id);
+
+        uint32_t left = province.bounding_box.bottom_left.x;
+        uint32_t top = province.bounding_box.top_right.y;
+        uint32_t right = std::min(province.bounding_box.top_right.x, width - 1);
+        uint32_t bottom = std::min(province.bounding_box.bottom_left.y, height - 1);
+
+        for(uint32_t y = top; y <= bottom; ++y) {
+            for(uint32_t x = left; x <= right; ++x) {
+                auto index = xyToIndex(width, x, y);
+
+                if(prov_matrix[index] == id) {
+                    state_id_matrix[index] = province.state;
+                }
+            }
+        }
+
+        min_x = std::min(min_x, left);
+        min_y = std::min(min_y, top);
+        max_x = std::max(max_x, right);
+        max_y = std::max(max_y, bottom);
+    }
+
+    if(min_x > max_x || min_y > max_y) {
+        return;
+    }
+
+    // The state borders of the neighbors of every changed pixel may change too
+    if(outlines) {
+        auto area = growBorderArea(dimensions,
+                                   Rectangle{ min_x, min_y,
+                                              max_x - min_x + 1,
+                                              max_y - min_y + 1 });
+
+        auto result = updateStateBorderMask(dimensions, state_id_matrix.get(),
+                                            outlines.get(), area);
+        WRITE_IF_ERROR(result);
+    }
+
+    getMapData()->markStateIDMatrixUpdated();
+}
+
 /**
  * @brief Creates a new state composed of all provinces in province_ids.
  * @details The provinces detailed in province_ids will get removed from their
@@ -477,7 +650,8 @@ auto HMDT::Project::StateProject::addNewState(const std::vector<ProvinceID>& pro
         generateUniqueColor(ProvinceType::UNKNOWN)
     };
 
-    updateStateIDMatrix();
+    // Only the pixels of the new state's provinces changed state
+    updateStateIDMatrix(province_ids);
 
     return id;
 }
@@ -492,17 +666,21 @@ auto HMDT::Project::StateProject::removeState(StateID id) noexcept -> MaybeVoid
     MaybeRef<State> state = getStateForID(id);
     RETURN_IF_ERROR(state);
 
-    state.andThen([this](const State& state) {
+    std::vector<ProvinceID> province_ids;
+    state.andThen([this, &province_ids](const State& state) {
         // Disconnect each province from this state first
         for(auto&& prov_id : state.provinces) {
             getRootParent().getMapProject().getProvinceProject().getProvinceForID(prov_id).state = -1;
         }
+
+        province_ids = state.provinces;
     });
 
     m_available_state_ids.push(id);
     m_states.erase(id);
 
-    updateStateIDMatrix();
+    // Only the pixels of the removed state's provinces changed state
+    updateStateIDMatrix(province_ids);
 
     return STATUS_SUCCESS;
 }
@@ -547,6 +725,133 @@ auto HMDT::Project::StateProject::removeProvinceFromState(StateID state_id,
     });
 }
 
+/**
+ * @brief Replaces every state with ones generated from the land provinces.
+ *
+ * @param provinces_per_state How many provinces each state should aim for
+ * @param seed The seed to generate the states with. The same seed and map
+ *             always produce the same states.
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_INVALID_VALUE if
+ *         provinces_per_state is 0.
+ */
+auto HMDT::Project::StateProject::generateStates(uint32_t provinces_per_state,
+                                                 uint64_t seed) noexcept
+    -> MaybeVoid
+{
+    WRITE_INFO("Generating states of around ", provinces_per_state, " provinces...");
+
+    ProvinceClusterOptions options;
+    options.measure = ProvinceClusterOptions::Measure::PROVINCE_COUNT;
+    options.target_size = provinces_per_state;
+    options.seed = seed;
+
+    return generateStatesWith(std::move(options));
+}
+
+/**
+ * @brief Replaces every state with ones generated from the land provinces.
+ *
+ * @param target_area The area in pixels that each state should aim for
+ * @param seed The seed to generate the states with. The same seed and map
+ *             always produce the same states.
+ *
+ * @return STATUS_SUCCESS on success, or STATUS_INVALID_VALUE if target_area
+ *         is 0.
+ */
+auto HMDT::Project::StateProject::generateStatesOfSize(uint64_t target_area,
+                                                       uint64_t seed) noexcept
+    -> MaybeVoid
+{
+    WRITE_INFO("Generating states of around ", target_area, " pixels...");
+
+    ProvinceClusterOptions options;
+    options.measure = ProvinceClusterOptions::Measure::AREA;
+    options.target_size = target_area;
+    options.seed = seed;
+
+    return generateStatesWith(std::move(options));
+}
+
+/**
+ * @brief Replaces every state with contiguous groups of land provinces, all
+ *        at once.
+ * @details States never cross from one continent to another. Groups of
+ *          provinces which are too small to be a state on their own (such as
+ *          small islands) are still given their own state, so that every state
+ *          stays contiguous.
+ *
+ * @param options How to cluster the provinces. The grouping is filled in here.
+ */
+auto HMDT::Project::StateProject::generateStatesWith(ProvinceClusterOptions options) noexcept
+    -> MaybeVoid
+{
+    auto& province_project = getRootParent().getMapProject().getProvinceProject();
+    auto& provinces = province_project.getProvinces();
+
+    // Number every continent, so that provinces on different ones are never
+    //   put into the same state
+    std::map<Continent, uint32_t> continent_groups;
+    for(auto&& [_, province] : provinces) {
+        continent_groups.emplace(province.continent, 0);
+    }
+    uint32_t group = 0;
+    for(auto&& [_, g] : continent_groups) {
+        g = group++;
+    }
+
+    options.group_of = [&continent_groups](const Province& province) -> uint32_t {
+        if(province.type != ProvinceType::LAND) {
+            return ProvinceClusterOptions::NO_GROUP;
+        }
+
+        return continent_groups.at(province.continent);
+    };
+    options.merge_small_components = false;
+
+    auto map_data = getMapData();
+    auto clusters = clusterProvinces({ map_data->getWidth(), map_data->getHeight() },
+                                     map_data->getProvinces().lock().get(),
+                                     provinces,
+                                     options);
+    RETURN_IF_ERROR(clusters);
+
+    for(auto&& [_, province] : provinces) {
+        province.state = 0;
+    }
+
+    m_states.clear();
+    m_available_state_ids = std::queue<StateID>{};
+
+    using namespace std::string_literals;
+
+    StateID id = 1;
+    for(auto&& cluster : *clusters) {
+        for(auto&& prov_id : cluster) {
+            province_project.getProvinceForID(prov_id).state = id;
+        }
+
+        m_states[id] = State {
+            id,
+            "STATE"s + std::to_string(id), /* name */
+            0, /* manpower */
+            "", /* category */
+            DEFAULT_BUILDINGS_MAX_LEVEL_FACTOR, /* buildings_max_level_factor */
+            false, /* impassable */
+            std::move(cluster),
+            generateUniqueColor(ProvinceType::UNKNOWN)
+        };
+        ++id;
+    }
+
+    // Only rebuild the state matrix once every state has been made
+    updateStateIDMatrix();
+
+    WRITE_INFO("Generated ", m_states.size(), " states.");
+
+    return STATUS_SUCCESS;
+}
+
 /**
  * @brief Builds the project hierarchy tree for StateProject
  *
@@ -0,0 +1,560 @@
+
+#include "StrategicRegionProject.h"
+
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+#include "Logger.h"
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "Util.h"
+#include "RecordParser.h"
+#include "MapData.h"
+
+#include "StrategicRegionBuilder.h"
+
+#include "GroupNode.h"
+#include "ProjectNode.h"
+#include "PropertyNode.h"
+#include "NodeKeyNames.h"
+
+namespace {
+    /**
+     * @brief The weather of a single month in an exported strategic region.
+     */
+    struct WeatherPeriod {
+        //! The last day of the month, counting from 0
+        uint32_t last_day;
+
+        double min_temperature;
+        double max_temperature;
+
+        double no_phenomenon;
+        double rain_light;
+        double rain_heavy;
+        double snow;
+        double blizzard;
+        double mud;
+    };
+
+    /**
+     * @brief A mild, temperate climate which every region is exported with,
+     *        one period for each month of the year.
+     */
+    const WeatherPeriod DEFAULT_WEATHER_PERIODS[] = {
+        { 30, -6.0,  4.0, 0.5, 0.1,  0.0,  0.25, 0.05, 0.1  },
+        { 27, -5.0,  5.0, 0.5, 0.1,  0.0,  0.25, 0.05, 0.1  },
+        { 30, -1.0, 10.0, 0.5, 0.2,  0.05, 0.1,  0.0,  0.3  },
+        { 29,  3.0, 15.0, 0.5, 0.3,  0.05, 0.0,  0.0,  0.3  },
+        { 30,  8.0, 20.0, 0.6, 0.25, 0.05, 0.0,  0.0,  0.1  },
+        { 29, 12.0, 24.0, 0.7, 0.2,  0.05, 0.0,  0.0,  0.0  },
+        { 30, 14.0, 27.0, 0.7, 0.2,  0.05, 0.0,  0.0,  0.0  },
+        { 30, 13.0, 26.0, 0.7, 0.2,  0.05, 0.0,  0.0,  0.0  },
+        { 29,  9.0, 21.0, 0.6, 0.25, 0.05, 0.0,  0.0,  0.1  },
+        { 30,  4.0, 15.0, 0.5, 0.3,  0.1,  0.0,  0.0,  0.3  },
+        { 29,  0.0,  9.0, 0.5, 0.2,  0.05, 0.1,  0.0,  0.3  },
+        { 30, -4.0,  5.0, 0.5, 0.1,  0.0,  0.2,  0.05, 0.1  },
+    };
+
+    /**
+     * @brief Writes a weather block with DEFAULT_WEATHER_PERIODS.
+     *
+     * @param out The stream to write to
+     */
+    void writeDefaultWeather(std::ostream& out) {
+        out << std::fixed << std::setprecision(2);
+
+        out << "\tweather={\n";
+        uint32_t month = 0;
+        for(auto&& period : DEFAULT_WEATHER_PERIODS) {
+            // Dates are written as day.month, both counting from 0
+            out << "\t\tperiod={\n";
+            out << "\t\t\tbetween={ 0." << month << ' '
+                << period.last_day << '.' << month << " }\n";
+            out << "\t\t\ttemperature={ " << period.min_temperature << ' '
+                << period.max_temperature << " }\n";
+            out << "\t\t\tno_phenomenon=" << period.no_phenomenon << '\n';
+            out << "\t\t\train_light=" << period.rain_light << '\n';
+            out << "\t\t\train_heavy=" << period.rain_heavy << '\n';
+            out << "\t\t\tsnow=" << period.snow << '\n';
+            out << "\t\t\tblizzard=" << period.blizzard << '\n';
+            out << "\t\t\tarctic_water=0.00\n";
+            out << "\t\t\tmud=" << period.mud << '\n';
+            out << "\t\t\tsandstorm=0.00\n";
+            out << "\t\t\tmin_snow_level=0.00\n";
+            out << "\t\t}\n";
+
+            ++month;
+        }
+        out << "\t}\n";
+    }
+}
+
+HMDT::Project::StrategicRegionProject::StrategicRegionProject(IRootMapProject& parent):
+    m_parent_project(parent),
+    m_strategic_regions(),
+    m_province_regions()
+{ }
+
+/**
+ * @brief Writes all strategic region data to root/$STRATEGICREGIONDATA_FILENAME
+ *
+ * @param root The root where all strategic region data should go
+ *
+ * @return STATUS_SUCCESS if the data was successfully saved, an error code
+ *         otherwise
+ */
+auto HMDT::Project::StrategicRegionProject::save(const std::filesystem::path& root)
+    -> MaybeVoid
+{
+    auto path = root / STRATEGICREGIONDATA_FILENAME;
+
+    if(std::ofstream out(path); out) {
+        WRITE_DEBUG("Saving strategic regions to ", path);
+
+        // FORMAT:
+        //   ID;<Region Name>;PROVID1,PROVID2,...
+        for(auto&& [id, region] : m_strategic_regions) {
+            out << id << ';' << region.name << ';';
+
+            for(auto&& prov_id : region.provinces) {
+                out << prov_id << ',';
+            }
+
+            out << '\n';
+        }
+    } else {
+        WRITE_ERROR("Failed to open file ", path, ". Reason: ", std::strerror(errno));
+        RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Loads all strategic region data from a file
+ *
+ * @param root The root where the strategic region data file should be found
+ *
+ * @return STATUS_SUCCESS if the data was successfully loaded, an error code
+ *         otherwise
+ */
+auto HMDT::Project::StrategicRegionProject::load(const std::filesystem::path& root)
+    -> MaybeVoid
+{
+    auto path = root / STRATEGICREGIONDATA_FILENAME;
+
+    // If the file doesn't exist, then return false (we didn't actually load it
+    //  after all), but don't set the error code as it is expected that the
+    //  file may not exist
+    if(std::error_code ec; !std::filesystem::exists(path, ec)) {
+        RETURN_ERROR_IF(ec.value() != 0, ec);
+
+        WRITE_WARN("No data to load! No strategic regions currently exist!");
+        return std::make_error_code(std::errc::no_such_file_or_directory);
+    }
+
+    auto contents = readFileToString(path);
+    RETURN_IF_ERROR(contents);
+
+    m_strategic_regions.clear();
+    m_province_regions.clear();
+
+    // FORMAT:
+    //   ID;<Region Name>;PROVID1,PROVID2,...
+    RecordParser parser(*contents, ';');
+    parser.setAllowTrailingCharacters();
+    while(parser.nextRecord()) {
+        StrategicRegion region;
+
+        auto res = parser.parseFields(region.id, region.name);
+        if(IS_SUCCESS(res)) {
+            res = parser.parseListField<ProvinceID>(',',
+                    [&region](const ProvinceID& id) -> MaybeVoid {
+                        region.provinces.push_back(id);
+                        return STATUS_SUCCESS;
+                    });
+        }
+
+        if(IS_FAILURE(res)) {
+            WRITE_ERROR("Failed to parse line #", parser.getLineNumber(),
+                        " of ", path, ": '", parser.getRecord(), "'");
+            RETURN_IF_ERROR(res);
+        }
+
+        if(m_strategic_regions.count(region.id) != 0) {
+            WRITE_ERROR("Found multiple strategic regions with the same ID of ",
+                        region.id, "! We will skip the second one '",
+                        region.name, "' and keep '",
+                        m_strategic_regions.at(region.id).name, '\'');
+            continue;
+        }
+
+        for(auto&& prov_id : region.provinces) {
+            m_province_regions[prov_id] = region.id;
+        }
+
+        m_strategic_regions[region.id] = std::move(region);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Exports every strategic region to root/strategicregions/ID-NAME.txt
+ *
+ * @param root The root of the exported map
+ *
+ * @return STATUS_SUCCESS if every region was exported, an error code
+ *         otherwise
+ */
+auto HMDT::Project::StrategicRegionProject::export_(const std::filesystem::path& root) const noexcept
+    -> MaybeVoid
+{
+    auto regions_root = root / STRATEGICREGIONS_FOLDER;
+
+    // First create the export path if it doesn't exist
+    if(std::error_code fs_ec; !std::filesystem::exists(regions_root, fs_ec)) {
+        RETURN_ERROR_IF(fs_ec.value() != 0 &&
+                        fs_ec != std::errc::no_such_file_or_directory,
+                        fs_ec);
+
+        auto result = std::filesystem::create_directories(regions_root, fs_ec);
+
+        RETURN_ERROR_IF(!result, fs_ec);
+    }
+
+    const auto& prov_project = m_parent_project.getProvinceProject();
+
+    for(auto&& [id, region] : m_strategic_regions) {
+        auto path = regions_root / (std::to_string(id) + "-" + region.name + ".txt");
+
+        if(std::ofstream out(path); out) {
+            out << "strategic_region={\n";
+            out << "\tid=" << id << '\n';
+            out << "\tname=\"" << region.name << "\"\n";
+
+            out << "\tprovinces={\n\t\t";
+            for(auto&& prov_id : region.provinces) {
+                // Provinces may have been painted over since the regions were
+                //   last generated
+                if(prov_project.isValidProvinceID(prov_id)) {
+                    out << prov_project.getIDForProvinceID(prov_id) << ' ';
+                }
+            }
+            out << "\n\t}\n";
+
+            writeDefaultWeather(out);
+            out << "}\n";
+        } else {
+            WRITE_ERROR("Failed to open file ", path);
+            RETURN_ERROR(std::make_error_code(static_cast<std::errc>(errno)));
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+auto HMDT::Project::StrategicRegionProject::getRootParent() -> IRootProject& {
+    return m_parent_project.getRootParent();
+}
+
+auto HMDT::Project::StrategicRegionProject::getRootParent() const
+    -> const IRootProject&
+{
+    return m_parent_project.getRootParent();
+}
+
+auto HMDT::Project::StrategicRegionProject::getMapData()
+    -> std::shared_ptr<MapData>
+{
+    return m_parent_project.getMapData();
+}
+
+auto HMDT::Project::StrategicRegionProject::getMapData() const
+    -> const std::shared_ptr<MapData>
+{
+    return m_parent_project.getMapData();
+}
+
+/**
+ * @brief Throws away every strategic region, as none of the provinces they
+ *        refer to exist anymore.
+ */
+void HMDT::Project::StrategicRegionProject::import(const ShapeFinder&,
+                                                   std::shared_ptr<MapData>)
+{
+    m_strategic_regions.clear();
+    m_province_regions.clear();
+}
+
+bool HMDT::Project::StrategicRegionProject::validateData() {
+    // We have nothing to really validate here
+    return true;
+}
+
+auto HMDT::Project::StrategicRegionProject::getRootMapParent()
+    -> IRootMapProject&
+{
+    return m_parent_project.getRootMapParent();
+}
+
+auto HMDT::Project::StrategicRegionProject::getRootMapParent() const
+    -> const IRootMapProject&
+{
+    return m_parent_project.getRootMapParent();
+}
+
+auto HMDT::Project::StrategicRegionProject::getStrategicRegions() const noexcept
+    -> const StrategicRegionMap&
+{
+    return m_strategic_regions;
+}
+
+/**
+ * @brief Gets the strategic region that a province belongs to
+ *
+ * @param prov_id The province to look up
+ *
+ * @return The strategic region, or STATUS_STRATEGIC_REGION_DOES_NOT_EXIST if
+ *         the province is not in any strategic region
+ */
+auto HMDT::Project::StrategicRegionProject::getStrategicRegionForProvince(ProvinceID prov_id) const noexcept
+    -> MaybeRef<const StrategicRegion>
+{
+    if(auto it = m_province_regions.find(prov_id); it != m_province_regions.end())
+    {
+        return getStrategicRegionForID(it->second);
+    }
+
+    return STATUS_STRATEGIC_REGION_DOES_NOT_EXIST;
+}
+
+/**
+ * @brief Creates a new strategic region out of the given provinces, taking
+ *        them out of whichever regions they were in before.
+ *
+ * @param province_ids The provinces to put into the new region
+ *
+ * @return The ID of the new strategic region
+ */
+auto HMDT::Project::StrategicRegionProject::addNewStrategicRegion(const std::vector<ProvinceID>& province_ids) noexcept
+    -> StrategicRegionID
+{
+    for(auto&& prov_id : province_ids) {
+        removeProvinceFromStrategicRegion(prov_id);
+    }
+
+    // Reuse the lowest ID which is free, IDs start from 1
+    StrategicRegionID id = 1;
+    while(m_strategic_regions.count(id) != 0) {
+        ++id;
+    }
+
+    WRITE_DEBUG("Creating new strategic region with ID ", id);
+
+    // Note that we default the name to 'REGION#'
+    using namespace std::string_literals;
+    m_strategic_regions[id] = StrategicRegion {
+        id,
+        "REGION"s + std::to_string(id), /* name */
+        province_ids
+    };
+
+    for(auto&& prov_id : province_ids) {
+        m_province_regions[prov_id] = id;
+    }
+
+    return id;
+}
+
+/**
+ * @brief Deletes a strategic region. Its provinces are left without a region.
+ *
+ * @param id The ID of the strategic region to delete
+ */
+auto HMDT::Project::StrategicRegionProject::removeStrategicRegion(StrategicRegionID id) noexcept
+    -> MaybeVoid
+{
+    auto it = m_strategic_regions.find(id);
+    RETURN_ERROR_IF(it == m_strategic_regions.end(),
+                    STATUS_STRATEGIC_REGION_DOES_NOT_EXIST);
+
+    for(auto&& prov_id : it->second.provinces) {
+        m_province_regions.erase(prov_id);
+    }
+
+    m_strategic_regions.erase(it);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Moves a province into another strategic region. If the region it was
+ *        in before ends up empty, then that region is deleted.
+ *
+ * @param prov_id The province to move
+ * @param id The strategic region to move it to
+ */
+auto HMDT::Project::StrategicRegionProject::moveProvinceToStrategicRegion(ProvinceID prov_id,
+                                                                          StrategicRegionID id) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(!m_parent_project.getProvinceProject().isValidProvinceID(prov_id),
+                    STATUS_VALUE_NOT_FOUND);
+
+    auto it = m_strategic_regions.find(id);
+    RETURN_ERROR_IF(it == m_strategic_regions.end(),
+                    STATUS_STRATEGIC_REGION_DOES_NOT_EXIST);
+
+    // Nothing to do if it's already in there
+    if(auto old = m_province_regions.find(prov_id);
+            old != m_province_regions.end() && old->second == id)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    removeProvinceFromStrategicRegion(prov_id);
+
+    it->second.provinces.push_back(prov_id);
+    m_province_regions[prov_id] = id;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Renames a strategic region
+ *
+ * @param id The strategic region to rename
+ * @param name The new name
+ */
+auto HMDT::Project::StrategicRegionProject::setStrategicRegionName(StrategicRegionID id,
+                                                                   const std::string& name) noexcept
+    -> MaybeVoid
+{
+    auto it = m_strategic_regions.find(id);
+    RETURN_ERROR_IF(it == m_strategic_regions.end(),
+                    STATUS_STRATEGIC_REGION_DOES_NOT_EXIST);
+
+    it->second.name = name;
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Replaces every strategic region with ones generated from the province
+ *        map.
+ *
+ * @param count How many strategic regions to aim for. The actual number may
+ *              be slightly different, as land and sea are never mixed.
+ */
+auto HMDT::Project::StrategicRegionProject::generateStrategicRegions(uint32_t count) noexcept
+    -> MaybeVoid
+{
+    RETURN_ERROR_IF(count == 0, STATUS_INVALID_VALUE);
+
+    auto map_data = getMapData();
+    uint64_t area = static_cast<uint64_t>(map_data->getWidth()) * map_data->getHeight();
+
+    return generateStrategicRegionsOfSize(std::max<uint64_t>(area / count, 1));
+}
+
+/**
+ * @brief Replaces every strategic region with ones generated from the province
+ *        map.
+ *
+ * @param target_area The area in pixels that each region should aim for
+ */
+auto HMDT::Project::StrategicRegionProject::generateStrategicRegionsOfSize(uint64_t target_area) noexcept
+    -> MaybeVoid
+{
+    WRITE_INFO("Generating strategic regions of around ", target_area, " pixels...");
+
+    auto map_data = getMapData();
+
+    auto regions = clusterStrategicRegions({ map_data->getWidth(), map_data->getHeight() },
+                                           map_data->getProvinces().lock().get(),
+                                           m_parent_project.getProvinceProject().getProvinces(),
+                                           target_area);
+    RETURN_IF_ERROR(regions);
+
+    m_strategic_regions.clear();
+    m_province_regions.clear();
+
+    for(auto&& provinces : *regions) {
+        addNewStrategicRegion(provinces);
+    }
+
+    WRITE_INFO("Generated ", m_strategic_regions.size(), " strategic regions.");
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Takes a province out of its strategic region, deleting the region if
+ *        that was the last province in it.
+ *
+ * @param prov_id The province to remove
+ */
+void HMDT::Project::StrategicRegionProject::removeProvinceFromStrategicRegion(ProvinceID prov_id) noexcept
+{
+    auto it = m_province_regions.find(prov_id);
+    if(it == m_province_regions.end()) return;
+
+    if(auto rit = m_strategic_regions.find(it->second);
+            rit != m_strategic_regions.end())
+    {
+        auto& provinces = rit->second.provinces;
+        provinces.erase(std::remove(provinces.begin(), provinces.end(), prov_id),
+                        provinces.end());
+
+        if(provinces.empty()) {
+            WRITE_DEBUG("Strategic region ", rit->first, " is now empty, deleting it.");
+            m_strategic_regions.erase(rit);
+        }
+    }
+
+    m_province_regions.erase(it);
+}
+
+/**
+ * @brief Builds the project hierarchy tree for StrategicRegionProject
+ *
+ * @param visitor The visitor callback
+ *
+ * @return The root node for StrategicRegionProject
+ */
+auto HMDT::Project::StrategicRegionProject::visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>& visitor) const noexcept
+    -> Maybe<std::shared_ptr<Hierarchy::INode>>
+{
+    auto region_project_node = std::make_shared<Hierarchy::ProjectNode>(Hierarchy::ProjectKeys::STRATEGIC_REGIONS);
+
+    auto result = visitor(region_project_node);
+    RETURN_IF_ERROR(result);
+
+    auto regions_node = std::make_shared<Hierarchy::GroupNode>(Hierarchy::GroupKeys::STRATEGIC_REGIONS);
+
+    for(auto&& [id, region] : m_strategic_regions) {
+        auto region_node = std::make_shared<Hierarchy::GroupNode>(region.name);
+
+        for(auto&& prov_id : region.provinces) {
+            auto property = std::make_shared<Hierarchy::ConstPropertyNode<std::string>>(std::to_string(prov_id));
+            region_node->addChild(property);
+        }
+
+        result = visitor(region_node);
+        RETURN_IF_ERROR(result);
+
+        regions_node->addChild(region_node);
+    }
+
+    result = visitor(regions_node);
+    RETURN_IF_ERROR(result);
+
+    region_project_node->addChild(regions_node);
+
+    return region_project_node;
+}
+
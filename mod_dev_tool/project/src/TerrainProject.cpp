@@ -0,0 +1,343 @@
+
+#include "TerrainProject.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "Logger.h"
+
+#include "Constants.h"
+#include "StatusCodes.h"
+#include "MapData.h"
+#include "Util.h"
+
+#include "ProjectNode.h"
+#include "NodeKeyNames.h"
+
+HMDT::Project::TerrainProject::TerrainProject(IRootMapProject& parent):
+    m_parent_project(parent),
+    m_terrain_bmp(nullptr),
+    m_province_terrains_updated_tag(0)
+{ }
+
+/**
+ * @brief Writes the terrain map to root/$TERRAIN_FILENAME
+ *
+ * @param root The root where the terrain map should go
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::Project::TerrainProject::save(const std::filesystem::path& root)
+    -> MaybeVoid
+{
+    if(m_terrain_bmp == nullptr) {
+        WRITE_ERROR("No terrain map has been loaded, cannot save yet.");
+        RETURN_ERROR(STATUS_NO_DATA_LOADED);
+    }
+
+    auto res = writeBMP(root / TERRAIN_FILENAME, m_terrain_bmp);
+    RETURN_IF_ERROR(res);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @brief Loads the terrain map from root/$TERRAIN_FILENAME
+ *
+ * @param root The root where the terrain map should be found
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::Project::TerrainProject::load(const std::filesystem::path& root)
+    -> MaybeVoid
+{
+    auto path = root / TERRAIN_FILENAME;
+
+    // It is expected that the file may not exist, as a terrain map is optional
+    if(std::error_code ec; !std::filesystem::exists(path, ec)) {
+        RETURN_ERROR_IF(ec.value() != 0, ec);
+
+        WRITE_WARN("No data to load! No terrain map currently exists!");
+        RETURN_ERROR(std::make_error_code(std::errc::no_such_file_or_directory));
+    }
+
+    return loadFile(path);
+}
+
+auto HMDT::Project::TerrainProject::export_(const std::filesystem::path& root) const noexcept
+    -> MaybeVoid
+{
+    if(m_terrain_bmp == nullptr) {
+        WRITE_WARN("No terrain map was added, so none will be exported.");
+        return STATUS_SUCCESS;
+    }
+
+    // The terrain map is exported exactly as it was loaded, so that its palette
+    //   is kept
+    auto res = writeBMP(root / TERRAIN_FILENAME, m_terrain_bmp);
+    RETURN_IF_ERROR(res);
+
+    return STATUS_SUCCESS;
+}
+
+auto HMDT::Project::TerrainProject::getRootParent() -> IRootProject& {
+    return m_parent_project.getRootParent();
+}
+
+auto HMDT::Project::TerrainProject::getRootParent() const
+    -> const IRootProject&
+{
+    return m_parent_project.getRootParent();
+}
+
+auto HMDT::Project::TerrainProject::getMapData() -> std::shared_ptr<MapData> {
+    return m_parent_project.getMapData();
+}
+
+auto HMDT::Project::TerrainProject::getMapData() const 
+    -> const std::shared_ptr<MapData>
+{
+    return m_parent_project.getMapData();
+}
+
+void HMDT::Project::TerrainProject::import(const ShapeFinder&, std::shared_ptr<MapData>) { }
+
+bool HMDT::Project::TerrainProject::validateData() {
+    // We have nothing to really validate here
+    return true;
+}
+
+auto HMDT::Project::TerrainProject::getRootMapParent() -> IRootMapProject& {
+    return m_parent_project.getRootMapParent();
+}
+
+auto HMDT::Project::TerrainProject::getRootMapParent() const
+    -> const IRootMapProject&
+{
+    return m_parent_project.getRootMapParent();
+}
+
+/**
+ * @brief Loads an 8-bit palettized terrain map from a file.
+ *
+ * @param path The file to load
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::Project::TerrainProject::loadFile(const std::filesystem::path& path) noexcept
+    -> MaybeVoid
+{
+    std::shared_ptr<BitMap2> terrain_bmp;
+    try {
+        terrain_bmp.reset(new BitMap2);
+    } catch(const std::bad_alloc& e) {
+        WRITE_ERROR("Failed to allocate space for new bitmap: ", e.what());
+        RETURN_ERROR(STATUS_BADALLOC);
+    }
+
+    auto res = readBMP(path, terrain_bmp);
+    RETURN_IF_ERROR(res);
+
+    WRITE_DEBUG(*terrain_bmp);
+
+    if(auto d = getMapData()->getDimensions();
+            d.first != terrain_bmp->info_header.v1.width ||
+            d.second != terrain_bmp->info_header.v1.height)
+    {
+        WRITE_ERROR("Terrain map dimensions (",
+                    terrain_bmp->info_header.v1.width, ", ",
+                    terrain_bmp->info_header.v1.height, ") do not match the"
+                    " previously loaded dimensions (", d.first, ", ", d.second,
+                    ")");
+        RETURN_ERROR(STATUS_DIMENSION_MISMATCH);
+    }
+
+    if(auto bpp = terrain_bmp->info_header.v1.bitsPerPixel; bpp != 8) {
+        WRITE_ERROR("Terrain maps must be 8-bit images, not ", bpp, ".");
+        RETURN_ERROR(STATUS_INVALID_BIT_DEPTH);
+    }
+
+    std::memcpy(getMapData()->getTerrain().lock().get(),
+                terrain_bmp->data.get(),
+                getMapData()->getTerrainSize());
+
+    m_terrain_bmp = terrain_bmp;
+
+    return STATUS_SUCCESS;
+}
+
+bool HMDT::Project::TerrainProject::hasTerrainMap() const noexcept {
+    return m_terrain_bmp != nullptr;
+}
+
+auto HMDT::Project::TerrainProject::getBitMap() const
+    -> MonadOptionalRef<const BitMap2>
+{
+    if(m_terrain_bmp != nullptr) {
+        return *m_terrain_bmp;
+    } else {
+        return std::nullopt;
+    }
+}
+
+/**
+ * @brief Gets the terrain of every palette index of the terrain map.
+ * @details Palette index N stands for the Nth terrain of the project, which
+ *          matches the order of the default terrain map.
+ *
+ * @return The terrain of every palette index
+ */
+auto HMDT::Project::TerrainProject::getIndexTerrains() const noexcept
+    -> std::vector<TerrainID>
+{
+    const auto& terrains = getRootMapParent().getTerrains();
+
+    std::vector<TerrainID> index_terrains;
+    index_terrains.reserve(terrains.size());
+    std::transform(terrains.begin(), terrains.end(),
+                   std::back_inserter(index_terrains),
+                   [](const Terrain& terrain) {
+                       return terrain.getIdentifier();
+                   });
+
+    return index_terrains;
+}
+
+/**
+ * @brief Gets the color a terrain is drawn with.
+ * @details This is the palette color of the terrain's first palette index. If
+ *          there is no such palette color, then a color is made up from the
+ *          name of the terrain, so that it is at least the same every time.
+ *
+ * @param terrain The terrain to get the color of
+ *
+ * @return The color of the terrain
+ */
+auto HMDT::Project::TerrainProject::getTerrainColor(const TerrainID& terrain) const noexcept
+    -> Color
+{
+    auto index_terrains = getIndexTerrains();
+
+    if(auto it = std::find(index_terrains.begin(), index_terrains.end(), terrain);
+            it != index_terrains.end() && m_terrain_bmp != nullptr &&
+            m_terrain_bmp->color_table != nullptr)
+    {
+        auto index = static_cast<uint32_t>(std::distance(index_terrains.begin(), it));
+
+        if(index < m_terrain_bmp->info_header.v1.colorsUsed) {
+            const auto& color = m_terrain_bmp->color_table[index];
+            return Color{ color.red, color.green, color.blue };
+        }
+    }
+
+    return colorFromString(terrain);
+}
+
+/**
+ * @brief Works out which terrain every province should have from the terrain
+ *        map.
+ * @details Nothing is changed, so that the result can be applied (and undone)
+ *          later with applyTerrainChanges.
+ *
+ * @param options How to vote on the terrain of every province
+ *
+ * @return Every province whose terrain would change, ordered by ID
+ */
+auto HMDT::Project::TerrainProject::calculateProvinceTerrains(const TerrainVoteOptions& options) const noexcept
+    -> Maybe<std::vector<TerrainChange>>
+{
+    if(m_terrain_bmp == nullptr) {
+        WRITE_ERROR("No terrain map has been loaded, cannot calculate province terrains.");
+        RETURN_ERROR(STATUS_NO_DATA_LOADED);
+    }
+
+    WRITE_INFO("Calculating the terrain of every province...");
+
+    auto map_data = getMapData();
+    const auto& provinces = getRootMapParent().getProvinceProject().getProvinces();
+
+    auto winners = voteProvinceTerrains({ map_data->getWidth(), map_data->getHeight() },
+                                        map_data->getProvinces().lock().get(),
+                                        map_data->getTerrain().lock().get(),
+                                        provinces,
+                                        getIndexTerrains(),
+                                        options);
+    RETURN_IF_ERROR(winners);
+
+    std::vector<TerrainChange> changes;
+    for(auto&& [id, terrain] : *winners) {
+        const auto& old_terrain = provinces.at(id).terrain;
+
+        if(old_terrain != terrain) {
+            changes.push_back(TerrainChange{ id, old_terrain, terrain });
+        }
+    }
+
+    std::sort(changes.begin(), changes.end(),
+              [](const TerrainChange& a, const TerrainChange& b) {
+                  return a.id < b.id;
+              });
+
+    WRITE_INFO("The terrain of ", changes.size(), " provinces would change.");
+
+    return changes;
+}
+
+/**
+ * @brief Sets the terrain of every province in a list of changes.
+ * @details Every province is checked before any are changed, so either all of
+ *          the changes are made or none are.
+ *
+ * @param changes The changes to make
+ * @param undo Whether to set every province back to its old terrain instead
+ *
+ * @return STATUS_SUCCESS on success, or an error code otherwise
+ */
+auto HMDT::Project::TerrainProject::applyTerrainChanges(const std::vector<TerrainChange>& changes,
+                                                        bool undo) noexcept
+    -> MaybeVoid
+{
+    auto& province_project = getRootMapParent().getProvinceProject();
+
+    for(auto&& change : changes) {
+        if(!province_project.isValidProvinceID(change.id)) {
+            WRITE_ERROR("Cannot change the terrain of province ", change.id,
+                        " as it does not exist.");
+            RETURN_ERROR(STATUS_VALUE_NOT_FOUND);
+        }
+    }
+
+    for(auto&& change : changes) {
+        province_project.getProvinceForID(change.id).terrain = undo ? change.old_terrain
+                                                                    : change.new_terrain;
+    }
+
+    ++m_province_terrains_updated_tag;
+
+    return STATUS_SUCCESS;
+}
+
+auto HMDT::Project::TerrainProject::getProvinceTerrainsUpdatedTag() const noexcept
+    -> uint32_t
+{
+    return m_province_terrains_updated_tag;
+}
+
+/**
+ * @brief Builds the project hierarchy tree for TerrainProject
+ *
+ * @param visitor The visitor callback
+ *
+ * @return The root node for TerrainProject
+ */
+auto HMDT::Project::TerrainProject::visit(const std::function<MaybeVoid(std::shared_ptr<Hierarchy::INode>)>& visitor) const noexcept
+    -> Maybe<std::shared_ptr<Hierarchy::INode>>
+{
+    auto terrain_project_node = std::make_shared<Hierarchy::ProjectNode>(Hierarchy::ProjectKeys::TERRAIN);
+
+    auto result = visitor(terrain_project_node);
+    RETURN_IF_ERROR(result);
+
+    return terrain_project_node;
+}
@@ -2,20 +2,33 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <limits>
+#include <map>
 #include <cstring>
 #include <fstream>
+#include <sstream>
+#include <set>
 #include <stack>
+#include <tuple>
 #include <vector>
 
 #include "HoI4Project.h"
+#include "AssignTerrainAction.h"
+#include "BorderMask.h"
+#include "ProvinceGenerator.h"
+#include "VectorBorders.h"
 #include "Constants.h"
 #include "StatusCodes.h"
 #include "Logger.h"
 #include "ShapeFinder2.h"
 #include "Util.h"
 #include "ProjectNode.h"
+#include "RecordParser.h"
 #include "LinkNode.h"
+#include "WorldNormalBuilder.h"
 
 #include "TestUtils.h"
 #include "TestMocks.h"
@@ -954,3 +967,3399 @@ TEST(ProjectTests, SimpleHierarchyIterationTest) {
     ASSERT_EQ(c, num_nodes);
 }
 
+
+TEST(ProjectTests, PaintProvinceSplitAndRevertTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 12;
+    constexpr uint32_t height = 6;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // Two provinces, A on the left half of the map and B on the right half
+    HMDT::ProvinceID id_a;
+    HMDT::ProvinceID id_b;
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[id_a] = HMDT::Province {
+        id_a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, height - 1 }, { 5, 0 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_b] = HMDT::Province {
+        id_b, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 6, height - 1 }, { width - 1, 0 } }, { id_a },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 6) ? id_a : id_b;
+            }
+        }
+    }
+
+    // Paint a line through the middle of B, which should split its bottom half
+    //   off into a new province
+    std::vector<HMDT::Point2D> line;
+    for(uint32_t x = 6; x < width; ++x) {
+        line.push_back({ x, 3 });
+    }
+
+    auto maybe_edit = prov_project.paintProvince(id_a, line);
+    ASSERT_SUCCEEDED(maybe_edit);
+
+    ASSERT_EQ(maybe_edit->old_pixels.size(), line.size() + 12);
+    ASSERT_EQ(maybe_edit->new_provinces.size(), 1);
+    ASSERT_EQ(provinces.size(), 3);
+
+    auto id_c = maybe_edit->new_provinces.front();
+    ASSERT_TRUE(prov_project.isValidProvinceID(id_c));
+
+    const auto& prov_a = prov_project.getProvinceForID(id_a);
+    const auto& prov_b = prov_project.getProvinceForID(id_b);
+    const auto& prov_c = prov_project.getProvinceForID(id_c);
+
+    // The largest piece keeps the original ID, and the new piece keeps the
+    //   original's properties
+    ASSERT_EQ(prov_b.bounding_box.top_right.y, 0);
+    ASSERT_EQ(prov_b.bounding_box.bottom_left.y, 2);
+    ASSERT_EQ(prov_c.bounding_box.top_right.y, 4);
+    ASSERT_EQ(prov_c.bounding_box.bottom_left.y, height - 1);
+    ASSERT_EQ(prov_c.type, HMDT::ProvinceType::SEA);
+
+    ASSERT_EQ(prov_a.bounding_box.top_right.x, width - 1);
+    ASSERT_EQ(prov_a.adjacent_provinces, (std::set<HMDT::ProvinceID>{ id_b, id_c }));
+    ASSERT_EQ(prov_b.adjacent_provinces, (std::set<HMDT::ProvinceID>{ id_a }));
+    ASSERT_EQ(prov_c.adjacent_provinces, (std::set<HMDT::ProvinceID>{ id_a }));
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto label_matrix = map_data->getLabelMatrix().lock();
+        auto outlines = map_data->getProvinceOutlines().lock();
+
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 8, 3)], id_a);
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 8, 5)], id_c);
+        ASSERT_EQ(label_matrix[HMDT::xyToIndex(width, 8, 5)],
+                  static_cast<uint32_t>(id_c.hash()));
+
+        // The painted line borders B above and C below
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 8, 3)],
+                  HMDT::OUTLINE_NORTH | HMDT::OUTLINE_SOUTH);
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 8, 0)], 0);
+    }
+
+    // Reverting should put everything back to the way it was
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*maybe_edit));
+
+    ASSERT_EQ(provinces.size(), 2);
+    ASSERT_FALSE(prov_project.isValidProvinceID(id_c));
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).bounding_box.top_right.x, 5);
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).bounding_box.bottom_left.y, height - 1);
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_a }));
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto outlines = map_data->getProvinceOutlines().lock();
+
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, x, y)], (x < 6) ? id_a : id_b);
+            }
+        }
+
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 8, 3)], 0);
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 6, 3)], HMDT::OUTLINE_WEST);
+    }
+
+    // Painting over all of B removes it entirely
+    std::vector<HMDT::Point2D> all_of_b;
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 6; x < width; ++x) {
+            all_of_b.push_back({ x, y });
+        }
+    }
+
+    maybe_edit = prov_project.paintProvince(id_a, all_of_b);
+    ASSERT_SUCCEEDED(maybe_edit);
+    ASSERT_EQ(provinces.size(), 1);
+    ASSERT_FALSE(prov_project.isValidProvinceID(id_b));
+    ASSERT_TRUE(prov_project.getProvinceForID(id_a).adjacent_provinces.empty());
+
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*maybe_edit));
+    ASSERT_EQ(provinces.size(), 2);
+    ASSERT_TRUE(prov_project.isValidProvinceID(id_b));
+
+    // Painting an invalid province should fail without changing anything
+    ASSERT_STATUS(prov_project.paintProvince(HMDT::ProvinceID(), line),
+                  HMDT::STATUS_VALUE_NOT_FOUND);
+}
+
+TEST(ProjectTests, PaintProvinceAroundHoleTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 12;
+    constexpr uint32_t height = 8;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A on the left half of the map, and B as a ring around the lake L on the
+    //   right half
+    HMDT::ProvinceID id_a;
+    HMDT::ProvinceID id_b;
+    HMDT::ProvinceID id_l;
+
+    auto in_lake = [](uint32_t x, uint32_t y) {
+        return x >= 8 && x <= 9 && y >= 2 && y <= 5;
+    };
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[id_a] = HMDT::Province {
+        id_a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, height - 1 }, { 5, 0 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_b] = HMDT::Province {
+        id_b, HMDT::Color{ 0, 255, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 6, height - 1 }, { width - 1, 0 } }, { id_a, id_l },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_l] = HMDT::Province {
+        id_l, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::LAKE, false,
+        "unknown", "None", 0, { { 8, 5 }, { 9, 2 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 6) ? id_a :
+                                                            in_lake(x, y) ? id_l :
+                                                                            id_b;
+            }
+        }
+    }
+
+    // Growing the lake through the top of the ring leaves the ring in one
+    //   piece, as both sides are still joined around the bottom of the lake
+    auto maybe_edit = prov_project.paintProvince(id_l, { { 8, 0 }, { 9, 0 },
+                                                         { 8, 1 }, { 9, 1 } });
+    ASSERT_SUCCEEDED(maybe_edit);
+    ASSERT_TRUE(maybe_edit->new_provinces.empty());
+    ASSERT_EQ(provinces.size(), 3);
+
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).bounding_box.bottom_left.x, 6);
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).bounding_box.top_right.x, width - 1);
+    ASSERT_EQ(prov_project.getProvinceForID(id_l).bounding_box.top_right.y, 0);
+    ASSERT_EQ(prov_project.getProvinceForID(id_l).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_b }));
+
+    // Growing it through the bottom as well splits the ring in two
+    auto maybe_edit2 = prov_project.paintProvince(id_l, { { 8, 6 }, { 9, 6 },
+                                                          { 8, 7 }, { 9, 7 } });
+    ASSERT_SUCCEEDED(maybe_edit2);
+    ASSERT_EQ(maybe_edit2->new_provinces.size(), 1);
+    ASSERT_EQ(provinces.size(), 4);
+
+    auto id_c = maybe_edit2->new_provinces.front();
+
+    // Both halves are the same size, so either one may keep the original ID
+    auto id_left = id_b;
+    auto id_right = id_c;
+    if(prov_project.getProvinceForID(id_b).bounding_box.bottom_left.x != 6) {
+        std::swap(id_left, id_right);
+    }
+
+    const auto& prov_left = prov_project.getProvinceForID(id_left);
+    const auto& prov_right = prov_project.getProvinceForID(id_right);
+
+    ASSERT_EQ(prov_left.bounding_box.bottom_left.x, 6);
+    ASSERT_EQ(prov_left.bounding_box.top_right.x, 7);
+    ASSERT_EQ(prov_right.bounding_box.bottom_left.x, 10);
+    ASSERT_EQ(prov_right.bounding_box.top_right.x, width - 1);
+    ASSERT_EQ(prov_left.bounding_box.top_right.y, 0);
+    ASSERT_EQ(prov_right.bounding_box.bottom_left.y, height - 1);
+
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_left }));
+    ASSERT_EQ(prov_left.adjacent_provinces, (std::set<HMDT::ProvinceID>{ id_a, id_l }));
+    ASSERT_EQ(prov_right.adjacent_provinces, (std::set<HMDT::ProvinceID>{ id_l }));
+    ASSERT_EQ(prov_project.getProvinceForID(id_l).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_b, id_c }));
+
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*maybe_edit2));
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*maybe_edit));
+
+    ASSERT_EQ(provinces.size(), 3);
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_b }));
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_a, id_l }));
+}
+
+TEST(ProjectTests, SplitOversizedProvincesTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 64;
+    constexpr uint32_t height = 64;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // Two provinces, A on the left half of the map and B on the right half.
+    //   Both are far wider and taller than 1/8th of the map.
+    HMDT::ProvinceID id_a;
+    HMDT::ProvinceID id_b;
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[id_a] = HMDT::Province {
+        id_a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, height - 1 }, { 31, 0 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_b] = HMDT::Province {
+        id_b, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 32, height - 1 }, { width - 1, 0 } }, { id_a },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 32) ? id_a : id_b;
+            }
+        }
+    }
+
+    auto maybe_edit = prov_project.splitOversizedProvinces();
+    ASSERT_SUCCEEDED(maybe_edit);
+    ASSERT_FALSE(maybe_edit->new_provinces.empty());
+    ASSERT_EQ(provinces.size(), 2 + maybe_edit->new_provinces.size());
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+
+        for(auto&& [id, province] : provinces) {
+            // Every piece must now fit, and must keep the properties of the
+            //   province it was split from
+            auto [s_width, s_height] = HMDT::calcDims(province.bounding_box);
+            ASSERT_FALSE(HMDT::isShapeTooLarge(s_width, s_height, HMDT::Dimensions{ width, height }));
+
+            ASSERT_EQ(province.type, (province.bounding_box.bottom_left.x < 32) ?
+                                         HMDT::ProvinceType::LAND :
+                                         HMDT::ProvinceType::SEA);
+
+            // Every piece must be a single connected shape, and the adjacency
+            //   list must match the map
+            std::vector<HMDT::Point2D> to_visit;
+            std::vector<bool> visited(width * height, false);
+            std::set<HMDT::ProvinceID> adjacent;
+            uint64_t pixel_count = 0;
+            uint64_t reached = 0;
+
+            for(uint32_t y = 0; y < height; ++y) {
+                for(uint32_t x = 0; x < width; ++x) {
+                    if(prov_matrix[HMDT::xyToIndex(width, x, y)] != id) continue;
+
+                    if(pixel_count++ == 0) {
+                        to_visit.push_back({ x, y });
+                        visited[HMDT::xyToIndex(width, x, y)] = true;
+                    }
+                }
+            }
+
+            while(!to_visit.empty()) {
+                auto [x, y] = to_visit.back();
+                to_visit.pop_back();
+                ++reached;
+
+                for(auto [dx, dy] : { std::pair{ -1, 0 }, std::pair{ 1, 0 }, std::pair{ 0, -1 }, std::pair{ 0, 1 } })
+                {
+                    int64_t nx = static_cast<int64_t>(x) + dx;
+                    int64_t ny = static_cast<int64_t>(y) + dy;
+                    if(nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+
+                    auto index = HMDT::xyToIndex(width, nx, ny);
+                    if(prov_matrix[index] != id) {
+                        adjacent.insert(prov_matrix[index]);
+                    } else if(!visited[index]) {
+                        visited[index] = true;
+                        to_visit.push_back({ static_cast<uint32_t>(nx), static_cast<uint32_t>(ny) });
+                    }
+                }
+            }
+
+            ASSERT_GT(pixel_count, HMDT::MIN_SHAPE_SIZE);
+            ASSERT_EQ(reached, pixel_count);
+            ASSERT_EQ(province.adjacent_provinces, adjacent);
+        }
+    }
+
+    // Reverting should put everything back to the way it was
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*maybe_edit));
+
+    ASSERT_EQ(provinces.size(), 2);
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).bounding_box.top_right.x, 31);
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_a }));
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, x, y)], (x < 32) ? id_a : id_b);
+            }
+        }
+    }
+
+    // Splitting a single province into a given number of pieces
+    maybe_edit = prov_project.splitProvince(id_b, 3);
+    ASSERT_SUCCEEDED(maybe_edit);
+    ASSERT_EQ(maybe_edit->new_provinces.size(), 2);
+    ASSERT_EQ(provinces.size(), 4);
+
+    for(auto&& new_id : maybe_edit->new_provinces) {
+        ASSERT_EQ(prov_project.getProvinceForID(new_id).type, HMDT::ProvinceType::SEA);
+    }
+
+    ASSERT_STATUS(prov_project.splitProvince(HMDT::ProvinceID(), 2),
+                  HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_STATUS(prov_project.splitProvince(id_a, 0),
+                  HMDT::STATUS_INVALID_VALUE);
+}
+
+TEST(ProjectTests, AbsorbTinyProvincesTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    constexpr uint32_t width = 12;
+    constexpr uint32_t height = 6;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A is land on the left half of the map, and B is sea on the right half
+    //   . . . . . . . . . . C D
+    //   . . . . . . . . . . D D
+    //   . . T T . . . . . . . .
+    //   . . . . . . L L . . . .
+    //   . . . . . . . . . . . .
+    //   . . . . . . . . . . . .
+    // T is a land province inside of A, L is a land province inside of B
+    //   which only touches A on one side, and C and D are sea provinces
+    HMDT::ProvinceID id_a, id_b, id_t, id_l, id_c, id_d;
+
+    auto& provinces = prov_project.getProvinces();
+    auto add_province = [&](const HMDT::ProvinceID& id, HMDT::ProvinceType type,
+                            HMDT::BoundingBox bounding_box,
+                            std::set<HMDT::ProvinceID> adjacent)
+    {
+        provinces[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, type, false, "unknown", "None", 0,
+            bounding_box, adjacent, HMDT::INVALID_PROVINCE, { }
+        };
+    };
+
+    add_province(id_a, HMDT::ProvinceType::LAND, { { 0, height - 1 }, { 5, 0 } }, { id_b, id_t, id_l });
+    add_province(id_b, HMDT::ProvinceType::SEA, { { 6, height - 1 }, { width - 1, 0 } }, { id_a, id_l, id_c, id_d });
+    add_province(id_t, HMDT::ProvinceType::LAND, { { 2, 2 }, { 3, 2 } }, { id_a });
+    add_province(id_l, HMDT::ProvinceType::LAND, { { 6, 3 }, { 7, 3 } }, { id_a, id_b });
+    add_province(id_c, HMDT::ProvinceType::SEA, { { 10, 0 }, { 10, 0 } }, { id_b, id_d });
+    add_province(id_d, HMDT::ProvinceType::SEA, { { 10, 1 }, { 11, 0 } }, { id_b, id_c });
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 6) ? id_a : id_b;
+            }
+        }
+
+        prov_matrix[HMDT::xyToIndex(width, 2, 2)] = id_t;
+        prov_matrix[HMDT::xyToIndex(width, 3, 2)] = id_t;
+        prov_matrix[HMDT::xyToIndex(width, 6, 3)] = id_l;
+        prov_matrix[HMDT::xyToIndex(width, 7, 3)] = id_l;
+        prov_matrix[HMDT::xyToIndex(width, 10, 0)] = id_c;
+        prov_matrix[HMDT::xyToIndex(width, 11, 0)] = id_d;
+        prov_matrix[HMDT::xyToIndex(width, 10, 1)] = id_d;
+        prov_matrix[HMDT::xyToIndex(width, 11, 1)] = id_d;
+    }
+
+    auto state_id = state_project.addNewState({ id_a, id_t });
+
+    auto maybe_absorbed = prov_project.absorbTinyProvinces();
+    ASSERT_SUCCEEDED(maybe_absorbed);
+
+    // Neither A nor B are tiny, so only they should be left
+    ASSERT_EQ(provinces.size(), 2);
+    ASSERT_TRUE(prov_project.isValidProvinceID(id_a));
+    ASSERT_TRUE(prov_project.isValidProvinceID(id_b));
+
+    // C is the smallest, so it goes first. D then takes C's pixels with it
+    //   into B.
+    std::map<HMDT::ProvinceID, std::pair<HMDT::ProvinceID, uint64_t>> absorbed;
+    for(auto&& [id, into, pixel_count] : *maybe_absorbed) {
+        absorbed[id] = { into, pixel_count };
+    }
+    ASSERT_EQ(maybe_absorbed->front().id, id_c);
+    ASSERT_EQ(absorbed.size(), 4);
+    ASSERT_EQ(absorbed.at(id_t), std::make_pair(id_a, uint64_t{ 2 }));
+    ASSERT_EQ(absorbed.at(id_c), std::make_pair(id_b, uint64_t{ 1 }));
+    ASSERT_EQ(absorbed.at(id_d), std::make_pair(id_b, uint64_t{ 4 }));
+
+    // L has a longer border with B, but goes to A since they are both land
+    ASSERT_EQ(absorbed.at(id_l), std::make_pair(id_a, uint64_t{ 2 }));
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto outlines = map_data->getProvinceOutlines().lock();
+
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 2, 2)], id_a);
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 7, 3)], id_a);
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 10, 0)], id_b);
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, 11, 1)], id_b);
+
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 2, 2)], 0);
+
+        // L is now a part of A's state, which B is not in
+        uint8_t edges = HMDT::OUTLINE_NORTH | HMDT::OUTLINE_EAST | HMDT::OUTLINE_SOUTH;
+        ASSERT_EQ(outlines[HMDT::xyToIndex(width, 7, 3)],
+                  edges | (edges << HMDT::OUTLINE_STATE_SHIFT));
+    }
+
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).bounding_box.top_right.x, 7);
+    ASSERT_EQ(prov_project.getProvinceForID(id_a).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_b }));
+    ASSERT_EQ(prov_project.getProvinceForID(id_b).adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ id_a }));
+
+    ASSERT_EQ(state_project.getStates().at(state_id).provinces,
+              (std::vector<HMDT::ProvinceID>{ id_a }));
+
+    // Nothing is left to absorb the second time around
+    maybe_absorbed = prov_project.absorbTinyProvinces();
+    ASSERT_SUCCEEDED(maybe_absorbed);
+    ASSERT_TRUE(maybe_absorbed->empty());
+}
+
+TEST(ProjectTests, SculptHeightMapDirtyTilesTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    // The normal map functions are not part of the IHeightMapProject interface
+    auto& heightmap_project = dynamic_cast<HMDT::Project::HeightMapProject&>(
+            map_project.getHeightMapProject());
+
+    // Big enough for a few tiles, and not a multiple of the tile size
+    constexpr uint32_t width = HMDT::HEIGHTMAP_TILE_SIZE * 2 + 22;
+    constexpr uint32_t height = HMDT::HEIGHTMAP_TILE_SIZE + 6;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A simple slope, so that every normal is different from the flat one
+    std::unique_ptr<unsigned char[]> input(new unsigned char[width * height]);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            input[HMDT::xyToIndex(width, x, y)] = static_cast<unsigned char>(50 + x);
+        }
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto input_path = write_base_path / "sculpt_heightmap.bmp";
+    auto res = HMDT::writeBMP2(input_path, input.get(), width, height,
+                               1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    res = heightmap_project.loadFile(input_path);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_TRUE(heightmap_project.getDirtyRegions().empty());
+
+    // Raise a small circle sitting right on the border between the first two
+    //   tiles
+    auto circle = HMDT::getPixelsInCircle({ width, height },
+                                          { HMDT::HEIGHTMAP_TILE_SIZE, 10 }, 3);
+
+    auto maybe_edit = heightmap_project.sculpt(
+            HMDT::Project::IHeightMapProject::SculptMode::RAISE, circle, 20);
+    ASSERT_SUCCEEDED(maybe_edit);
+    ASSERT_EQ(maybe_edit->old_heights.size(), circle.size());
+
+    auto raise_edit = *maybe_edit;
+
+    auto heights = map_data->getHeightMap().lock();
+    for(auto&& [x, y] : circle) {
+        ASSERT_EQ(heights[HMDT::xyToIndex(width, x, y)], 50 + x + 20);
+    }
+
+    // Both tiles are dirty, each with a one pixel apron around it
+    auto regions = heightmap_project.getDirtyRegions();
+    ASSERT_EQ(regions.size(), 2);
+    ASSERT_EQ(regions[0].x, 0);
+    ASSERT_EQ(regions[0].y, 0);
+    ASSERT_EQ(regions[0].w, HMDT::HEIGHTMAP_TILE_SIZE + 1);
+    ASSERT_EQ(regions[0].h, HMDT::HEIGHTMAP_TILE_SIZE + 1);
+    ASSERT_EQ(regions[1].x, HMDT::HEIGHTMAP_TILE_SIZE - 1);
+    ASSERT_EQ(regions[1].w, HMDT::HEIGHTMAP_TILE_SIZE + 2);
+
+    auto maybe_regions = heightmap_project.updateNormalMap();
+    ASSERT_SUCCEEDED(maybe_regions);
+    ASSERT_EQ(maybe_regions->size(), 2);
+    ASSERT_TRUE(heightmap_project.getDirtyRegions().empty());
+
+    // Updating only the dirty tiles must give the same result as regenerating
+    //   the whole map
+    auto normal_map = map_data->getNormalMap().lock();
+    {
+        std::unique_ptr<unsigned char[]> expected(new unsigned char[map_data->getNormalMapSize()]);
+        res = HMDT::generateWorldNormalMap(heights.get(), { width, height },
+                                           expected.get());
+        ASSERT_SUCCEEDED(res);
+
+        ASSERT_EQ(std::memcmp(normal_map.get(), expected.get(),
+                              map_data->getNormalMapSize()), 0);
+    }
+
+    // Flattening and smoothing stay within the heights under the brush
+    auto line = HMDT::getPixelsAlongStroke({ width, height },
+                                           { { 10, 40 }, { 30, 40 } }, 2);
+    maybe_edit = heightmap_project.sculpt(
+            HMDT::Project::IHeightMapProject::SculptMode::FLATTEN, line, 255);
+    ASSERT_SUCCEEDED(maybe_edit);
+    for(auto&& [x, y] : line) {
+        ASSERT_EQ(heights[HMDT::xyToIndex(width, x, y)], heights[HMDT::xyToIndex(width, 10, 40)]);
+    }
+
+    // Reverting puts every height back to the input
+    res = heightmap_project.revertHeightMapEdit(*maybe_edit);
+    ASSERT_SUCCEEDED(res);
+
+    res = heightmap_project.revertHeightMapEdit(raise_edit);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(std::memcmp(heights.get(), input.get(), width * height), 0);
+
+    // The saved bitmap gets sculpted too
+    auto bitmap = heightmap_project.getBitMap();
+    ASSERT_TRUE(bitmap.has_value());
+    ASSERT_EQ(std::memcmp(bitmap->get().data.get(), input.get(), width * height), 0);
+
+    ASSERT_SUCCEEDED(heightmap_project.updateNormalMap());
+}
+
+TEST(ProjectTests, LoadMapLayersInStagesTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    // getBitMap is not part of the IHeightMapProject interface
+    auto& heightmap_project = dynamic_cast<HMDT::Project::HeightMapProject&>(
+            map_project.getHeightMapProject());
+    auto& rivers_project = map_project.getRiversProject();
+
+    constexpr uint32_t width = 64;
+    constexpr uint32_t height = 48;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A simple slope, so that the normals are not all flat
+    std::unique_ptr<unsigned char[]> input(new unsigned char[width * height]);
+    std::unique_ptr<unsigned char[]> rgb_input(new unsigned char[width * height * 3]);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            auto index = HMDT::xyToIndex(width, x, y);
+            input[index] = static_cast<unsigned char>(50 + x + y);
+
+            rgb_input[index * 3] = input[index];
+            rgb_input[index * 3 + 1] = input[index];
+            rgb_input[index * 3 + 2] = input[index];
+        }
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto greyscale_path = write_base_path / "layer_greyscale.bmp";
+    auto rgb_path = write_base_path / "layer_rgb.bmp";
+    auto small_path = write_base_path / "layer_small.bmp";
+
+    auto res = HMDT::writeBMP2(greyscale_path, input.get(), width, height,
+                               1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+    res = HMDT::writeBMP2(rgb_path, rgb_input.get(), width, height,
+                          3 /* depth */);
+    ASSERT_SUCCEEDED(res);
+    res = HMDT::writeBMP2(small_path, input.get(), width / 2, height,
+                          1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    // Only the header gets checked, so any questions can be asked up front
+    auto bpp = heightmap_project.checkFile(greyscale_path);
+    ASSERT_SUCCEEDED(bpp);
+    ASSERT_EQ(*bpp, 8);
+
+    bpp = heightmap_project.checkFile(rgb_path);
+    ASSERT_SUCCEEDED(bpp);
+    ASSERT_EQ(*bpp, 24);
+
+    ASSERT_STATUS(heightmap_project.checkFile(small_path),
+                  HMDT::STATUS_DIMENSION_MISMATCH);
+
+    // Preparing never prompts, so converting must have been allowed already
+    {
+        HMDT::Project::LayerLoadProgress progress;
+        ASSERT_STATUS(heightmap_project.prepareFile(rgb_path, false, progress),
+                      HMDT::STATUS_INVALID_BIT_DEPTH);
+    }
+
+    // Stopping early gets noticed as soon as the current stage is done
+    {
+        HMDT::Project::LayerLoadProgress progress;
+        progress.estop();
+        ASSERT_STATUS(heightmap_project.prepareFile(greyscale_path, false, progress),
+                      HMDT::STATUS_LOAD_CANCELLED);
+        ASSERT_EQ(progress.getStage(), HMDT::Project::LayerLoadProgress::Stage::READING);
+    }
+
+    using Stage = HMDT::Project::LayerLoadProgress::Stage;
+
+    std::vector<Stage> stages;
+    HMDT::Project::LayerLoadProgress progress;
+    progress.setStageCallback([&stages](Stage stage) {
+        stages.push_back(stage);
+    });
+
+    auto pending = heightmap_project.prepareFile(rgb_path, true, progress);
+    ASSERT_SUCCEEDED(pending);
+    ASSERT_THAT(stages, ::testing::ElementsAre(Stage::READING,
+                                               Stage::CONVERTING,
+                                               Stage::PROCESSING,
+                                               Stage::DONE));
+    ASSERT_FLOAT_EQ(progress.getFraction(), 1.0f);
+
+    // Nothing is handed off to the map until it gets committed
+    auto heights = map_data->getHeightMap().lock();
+    auto normal_map = map_data->getNormalMap().lock();
+    ASSERT_TRUE(std::all_of(heights.get(), heights.get() + width * height,
+                            [](uint8_t h) { return h == 0; }));
+    ASSERT_FALSE(heightmap_project.getBitMap().has_value());
+
+    res = heightmap_project.commitFile(std::move(*pending));
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(std::memcmp(heights.get(), input.get(), width * height), 0);
+    ASSERT_TRUE(heightmap_project.getBitMap().has_value());
+
+    {
+        std::unique_ptr<unsigned char[]> expected(new unsigned char[map_data->getNormalMapSize()]);
+        res = HMDT::generateWorldNormalMap(input.get(), { width, height },
+                                           expected.get());
+        ASSERT_SUCCEEDED(res);
+
+        ASSERT_EQ(std::memcmp(normal_map.get(), expected.get(),
+                              map_data->getNormalMapSize()), 0);
+    }
+
+    // A failed load leaves the current heightmap alone
+    ASSERT_STATUS(heightmap_project.loadFile(small_path),
+                  HMDT::STATUS_DIMENSION_MISMATCH);
+    ASSERT_EQ(std::memcmp(heights.get(), input.get(), width * height), 0);
+
+    // Rivers can never be converted, so they get rejected from just the header
+    ASSERT_STATUS(rivers_project.checkFile(rgb_path),
+                  HMDT::STATUS_INVALID_BIT_DEPTH);
+
+    bpp = rivers_project.checkFile(greyscale_path);
+    ASSERT_SUCCEEDED(bpp);
+
+    stages.clear();
+    auto pending_rivers = rivers_project.prepareFile(greyscale_path, progress);
+    ASSERT_SUCCEEDED(pending_rivers);
+    ASSERT_THAT(stages, ::testing::ElementsAre(Stage::READING, Stage::DONE));
+
+    auto rivers = map_data->getRivers().lock();
+    ASSERT_TRUE(std::all_of(rivers.get(), rivers.get() + width * height,
+                            [](uint8_t r) { return r == 0; }));
+
+    res = rivers_project.commitFile(*pending_rivers);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(std::memcmp(rivers.get(), input.get(), width * height), 0);
+}
+
+TEST(ProjectTests, ReloadChangedTilesTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    // The normal map functions are not part of the IHeightMapProject interface
+    auto& heightmap_project = dynamic_cast<HMDT::Project::HeightMapProject&>(
+            map_project.getHeightMapProject());
+    auto& rivers_project = map_project.getRiversProject();
+
+    // Three tiles across and two down, with smaller tiles on the edges
+    constexpr uint32_t width = HMDT::LAYER_RELOAD_TILE_SIZE * 2 + 10;
+    constexpr uint32_t height = HMDT::LAYER_RELOAD_TILE_SIZE + 10;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    std::unique_ptr<unsigned char[]> input(new unsigned char[width * height]);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            input[HMDT::xyToIndex(width, x, y)] = static_cast<unsigned char>(50 + x / 2 + y);
+        }
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto input_path = write_base_path / "reload_layer.bmp";
+    auto res = HMDT::writeBMP2(input_path, input.get(), width, height,
+                               1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    res = heightmap_project.loadFile(input_path);
+    ASSERT_SUCCEEDED(res);
+    res = rivers_project.loadFile(input_path);
+    ASSERT_SUCCEEDED(res);
+
+    // Reloading an unchanged file does not touch anything
+    auto changed = heightmap_project.reloadFile(input_path, false);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_TRUE(changed->empty());
+
+    changed = rivers_project.reloadFile(input_path);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_TRUE(changed->empty());
+
+    // Edit the file as an artist would, in the middle tile of the top row and
+    //   the bottom right corner tile
+    input[HMDT::xyToIndex(width, HMDT::LAYER_RELOAD_TILE_SIZE + 5, 3)] = 200;
+    input[HMDT::xyToIndex(width, width - 1, height - 1)] = 10;
+
+    res = HMDT::writeBMP2(input_path, input.get(), width, height,
+                          1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    changed = heightmap_project.reloadFile(input_path, false);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_EQ(changed->size(), 2);
+    ASSERT_EQ(changed->at(0).x, HMDT::LAYER_RELOAD_TILE_SIZE);
+    ASSERT_EQ(changed->at(0).y, 0);
+    ASSERT_EQ(changed->at(1).x, HMDT::LAYER_RELOAD_TILE_SIZE * 2);
+    ASSERT_EQ(changed->at(1).y, HMDT::LAYER_RELOAD_TILE_SIZE);
+    ASSERT_EQ(changed->at(1).w, 10);
+    ASSERT_EQ(changed->at(1).h, 10);
+
+    auto heights = map_data->getHeightMap().lock();
+    ASSERT_EQ(std::memcmp(heights.get(), input.get(), width * height), 0);
+    ASSERT_EQ(std::memcmp(heightmap_project.getBitMap()->get().data.get(),
+                          input.get(), width * height), 0);
+
+    // Only the changed tiles had their normals regenerated, but the result
+    //   must be the same as regenerating all of them
+    ASSERT_TRUE(heightmap_project.getDirtyRegions().empty());
+    {
+        std::unique_ptr<unsigned char[]> expected(new unsigned char[map_data->getNormalMapSize()]);
+        res = HMDT::generateWorldNormalMap(input.get(), { width, height },
+                                           expected.get());
+        ASSERT_SUCCEEDED(res);
+
+        ASSERT_EQ(std::memcmp(map_data->getNormalMap().lock().get(),
+                              expected.get(), map_data->getNormalMapSize()), 0);
+    }
+
+    changed = rivers_project.reloadFile(input_path);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_EQ(changed->size(), 2);
+    ASSERT_EQ(std::memcmp(map_data->getRivers().lock().get(), input.get(),
+                          width * height), 0);
+
+    // A file which no longer fits leaves the current layer alone
+    res = HMDT::writeBMP2(input_path, input.get(), width / 2, height,
+                          1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    ASSERT_STATUS(heightmap_project.reloadFile(input_path, false),
+                  HMDT::STATUS_DIMENSION_MISMATCH);
+    ASSERT_EQ(std::memcmp(heights.get(), input.get(), width * height), 0);
+}
+
+TEST(ProjectTests, FindStraitsTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 40;
+    constexpr uint32_t height = 12;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // From left to right:
+    //   A1, A2 (one landmass) | narrow sea S1 | B | wide sea S2 | C
+    HMDT::ProvinceID a1, a2, s1, b, s2, c;
+
+    auto make_province = [&](const HMDT::ProvinceID& id, HMDT::ProvinceType type,
+                             std::set<HMDT::ProvinceID> adjacent)
+    {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, type, false, "unknown", "None", 0,
+            { { 0, 0 }, { 0, 0 } }, adjacent, HMDT::INVALID_PROVINCE, { }
+        };
+    };
+    make_province(a1, HMDT::ProvinceType::LAND, { a2 });
+    make_province(a2, HMDT::ProvinceType::LAND, { a1, s1 });
+    make_province(s1, HMDT::ProvinceType::SEA, { a2, b });
+    make_province(b, HMDT::ProvinceType::LAND, { s1, s2 });
+    make_province(s2, HMDT::ProvinceType::SEA, { b, c });
+    make_province(c, HMDT::ProvinceType::LAND, { s2 });
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                HMDT::ProvinceID id;
+                if(x < 5) id = a1;
+                else if(x < 10) id = a2;
+                else if(x < 14) id = s1;
+                else if(x < 20) id = b;
+                else if(x < 30) id = s2;
+                else id = c;
+
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = id;
+            }
+        }
+    }
+
+    map_project.setMaxStraitWidth(8);
+
+    auto straits = map_project.findStraits();
+    ASSERT_SUCCEEDED(straits);
+
+    // Only the narrow sea is crossable, and only from the province touching it
+    ASSERT_EQ(straits->size(), 1);
+
+    auto& strait = straits->front();
+    ASSERT_EQ(std::minmax(strait.from, strait.to), std::minmax(a2, b));
+    ASSERT_EQ(strait.through, s1);
+    ASSERT_DOUBLE_EQ(strait.width, 5.0);
+    ASSERT_EQ(strait.start.y, strait.stop.y);
+    ASSERT_EQ(std::min(strait.start.x, strait.stop.x), 9);
+    ASSERT_EQ(std::max(strait.start.x, strait.stop.x), 14);
+
+    // Widening the limit picks up the wide sea too
+    map_project.setMaxStraitWidth(11);
+
+    straits = map_project.findStraits();
+    ASSERT_SUCCEEDED(straits);
+    ASSERT_EQ(straits->size(), 2);
+
+    // Nothing is a strait if no crossing is allowed at all
+    map_project.setMaxStraitWidth(0);
+
+    straits = map_project.findStraits();
+    ASSERT_SUCCEEDED(straits);
+    ASSERT_TRUE(straits->empty());
+}
+
+TEST(ProjectTests, FindStraitsOnImportedMapTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 40;
+    constexpr uint32_t height = 12;
+
+    // The same layout as FindStraitsTest, but every adjacency comes from
+    //   importing the image rather than being filled in by hand
+    const std::vector<std::pair<uint32_t, HMDT::Color>> columns = {
+        { 5, HMDT::Color{ 10, 20, 10 } },   // A1
+        { 10, HMDT::Color{ 30, 40, 30 } },  // A2
+        { 14, HMDT::Color{ 50, 60, 50 } },  // S1
+        { 20, HMDT::Color{ 70, 80, 70 } },  // B
+        { 30, HMDT::Color{ 90, 100, 90 } }, // S2
+        { 40, HMDT::Color{ 110, 120, 110 } }  // C
+    };
+
+    std::unique_ptr<unsigned char[]> input(new unsigned char[width * height * 3]);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            auto column = std::find_if(columns.begin(), columns.end(),
+                                       [x](auto&& c) { return x < c.first; });
+            auto index = HMDT::xyToIndex(width * 3, x * 3, y);
+
+            input[index] = column->second.b;
+            input[index + 1] = column->second.g;
+            input[index + 2] = column->second.r;
+        }
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto input_path = write_base_path / "straits_provinces.bmp";
+    auto res = HMDT::writeBMP2(input_path, input.get(), width, height, 3,
+                               false, HMDT::BMPHeaderToUse::V1);
+    ASSERT_SUCCEEDED(res);
+
+    {
+        auto map_data = map_project.getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(width, height);
+
+        // TODO: ShapeFinder hasn't been switched over to the new BitMap2 object
+        //   yet, so we need to still use the deprecated one for now
+        std::unique_ptr<HMDT::BitMap> image(HMDT::readBMP(input_path));
+        ASSERT_NE(image, nullptr);
+
+        HMDT::ShapeFinder finder(image.get(),
+                                 HMDT::UnitTests::GraphicsWorkerMock::getInstance(),
+                                 map_data);
+        finder.findAllShapes();
+
+        prov_project.import(finder, map_data);
+    }
+
+    ASSERT_EQ(prov_project.getProvinces().size(), columns.size());
+
+    // Imported provinces get new colors, so find them by where they are
+    std::vector<HMDT::ProvinceID> ids;
+    {
+        auto prov_matrix = map_project.getMapData()->getProvinces().lock();
+        for(auto&& [end_x, _] : columns) {
+            ids.push_back(prov_matrix[HMDT::xyToIndex(width, end_x - 1, 0)]);
+            ASSERT_EQ(prov_project.getProvinces().count(ids.back()), 1);
+        }
+    }
+
+    auto& a2 = ids[1];
+    auto& s1 = ids[2];
+    auto& b = ids[3];
+
+    // The colors don't say what type each province is, so set them here
+    for(auto&& id : ids) {
+        prov_project.getProvinces()[id].type = HMDT::ProvinceType::LAND;
+    }
+    prov_project.getProvinces()[s1].type = HMDT::ProvinceType::SEA;
+    prov_project.getProvinces()[ids[4]].type = HMDT::ProvinceType::SEA;
+
+    // The imported adjacencies must be symmetric for the seas to be crossed
+    ASSERT_EQ(prov_project.getProvinces()[s1].adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ a2, b }));
+    ASSERT_EQ(prov_project.getProvinces()[b].adjacent_provinces,
+              (std::set<HMDT::ProvinceID>{ s1, ids[4] }));
+
+    map_project.setMaxStraitWidth(8);
+
+    auto straits = map_project.findStraits();
+    ASSERT_SUCCEEDED(straits);
+    ASSERT_EQ(straits->size(), 1);
+
+    auto& strait = straits->front();
+    ASSERT_EQ(std::minmax(strait.from, strait.to), std::minmax(a2, b));
+    ASSERT_EQ(strait.through, s1);
+    ASSERT_DOUBLE_EQ(strait.width, 5.0);
+
+    map_project.setMaxStraitWidth(11);
+
+    straits = map_project.findStraits();
+    ASSERT_SUCCEEDED(straits);
+    ASSERT_EQ(straits->size(), 2);
+}
+
+TEST(ProjectTests, BuildSupplyNetworkTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    constexpr uint32_t width = 16;
+    constexpr uint32_t height = 4;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A chain of land provinces L1-L2-L3-L4, then sea, then an island I
+    HMDT::ProvinceID l1, l2, l3, l4, sea, island;
+
+    auto make_province = [&](const HMDT::ProvinceID& id, HMDT::ProvinceType type,
+                             std::set<HMDT::ProvinceID> adjacent)
+    {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, type, false, "unknown", "None", 0,
+            { { 0, 0 }, { 0, 0 } }, adjacent, HMDT::INVALID_PROVINCE, { }
+        };
+    };
+    make_province(l1, HMDT::ProvinceType::LAND, { l2 });
+    make_province(l2, HMDT::ProvinceType::LAND, { l1, l3 });
+    make_province(l3, HMDT::ProvinceType::LAND, { l2, l4 });
+    make_province(l4, HMDT::ProvinceType::LAND, { l3, sea });
+    make_province(sea, HMDT::ProvinceType::SEA, { l4, island });
+    make_province(island, HMDT::ProvinceType::LAND, { sea });
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                HMDT::ProvinceID id;
+                if(x < 4) id = l1;
+                else if(x < 6) id = l2;
+                else if(x < 8) id = l3;
+                else if(x < 12) id = l4;
+                else if(x < 14) id = sea;
+                else id = island;
+
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = id;
+            }
+        }
+    }
+
+    // The largest province of each state becomes its hub
+    state_project.addNewState({ l1, l2 });
+    state_project.addNewState({ l3, l4 });
+
+    auto network = map_project.buildSupplyNetwork();
+    ASSERT_SUCCEEDED(network);
+
+    // The island isn't in any state, but still gets a hub of its own
+    std::vector<HMDT::ProvinceID> expected_nodes{ l1, l4, island };
+    std::sort(expected_nodes.begin(), expected_nodes.end());
+    ASSERT_EQ(network->supply_nodes, expected_nodes);
+
+    // There is only one railway, running along the whole chain
+    ASSERT_EQ(network->railways.size(), 1);
+
+    auto railway = network->railways.front();
+    if(railway.front() != l1) {
+        std::reverse(railway.begin(), railway.end());
+    }
+    ASSERT_EQ(railway, (std::vector<HMDT::ProvinceID>{ l1, l2, l3, l4 }));
+
+    // Generating it again gives exactly the same network
+    auto network2 = map_project.buildSupplyNetwork();
+    ASSERT_SUCCEEDED(network2);
+    ASSERT_EQ(network2->supply_nodes, network->supply_nodes);
+    ASSERT_EQ(network2->railways, network->railways);
+}
+
+
+TEST(ProjectTests, GenerateStrategicRegionsTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& region_project = map_project.getStrategicRegionProject();
+
+    constexpr uint32_t width = 24;
+    constexpr uint32_t height = 4;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A chain of land provinces L1-L6, a chain of sea provinces S1-S5, then a
+    //   small island I. Every province is 2 pixels wide.
+    std::vector<HMDT::ProvinceID> land(6);
+    std::vector<HMDT::ProvinceID> sea(5);
+    HMDT::ProvinceID island;
+
+    std::vector<HMDT::ProvinceID> columns;
+    columns.insert(columns.end(), land.begin(), land.end());
+    columns.insert(columns.end(), sea.begin(), sea.end());
+    columns.push_back(island);
+
+    for(size_t i = 0; i < columns.size(); ++i) {
+        std::set<HMDT::ProvinceID> adjacent;
+        if(i > 0) adjacent.insert(columns[i - 1]);
+        if(i + 1 < columns.size()) adjacent.insert(columns[i + 1]);
+
+        auto type = (i < land.size() || i + 1 == columns.size()) ?
+                        HMDT::ProvinceType::LAND : HMDT::ProvinceType::SEA;
+
+        prov_project.getProvinces()[columns[i]] = HMDT::Province {
+            columns[i], HMDT::Color{ 0, 0, 0 }, type, false, "unknown", "None",
+            0, { { 0, 0 }, { 0, 0 } }, adjacent, HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = columns[x / 2];
+            }
+        }
+    }
+
+    // 48 pixels of land makes 2 regions, 40 pixels of sea makes 2 regions, and
+    //   the 8 pixel island is too small to be a region of its own
+    auto res = region_project.generateStrategicRegionsOfSize(24);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(region_project.getStrategicRegions().size(), 4);
+
+    // Region IDs start from 1, so 0 means the province isn't in one
+    auto region_of = [&](const HMDT::ProvinceID& id) -> HMDT::StrategicRegionID {
+        auto region = region_project.getStrategicRegionForProvince(id);
+        return IS_SUCCESS(region) ? region->get().id : 0;
+    };
+
+    // Land and sea are never mixed together
+    for(auto&& [id, region] : region_project.getStrategicRegions()) {
+        auto type = prov_project.getProvinceForID(region.provinces.front()).type;
+        for(auto&& prov_id : region.provinces) {
+            ASSERT_EQ(prov_project.getProvinceForID(prov_id).type == HMDT::ProvinceType::SEA,
+                      type == HMDT::ProvinceType::SEA);
+        }
+    }
+
+    // The land chain gets split evenly down the middle
+    ASSERT_EQ(region_of(land[0]), region_of(land[1]));
+    ASSERT_EQ(region_of(land[1]), region_of(land[2]));
+    ASSERT_EQ(region_of(land[3]), region_of(land[4]));
+    ASSERT_EQ(region_of(land[4]), region_of(land[5]));
+    ASSERT_NE(region_of(land[0]), region_of(land[5]));
+
+    // The island joins the closest land region
+    ASSERT_EQ(region_of(island), region_of(land[5]));
+
+    ASSERT_NE(region_of(sea[0]), region_of(sea[4]));
+
+    // Moving a province across takes it out of its old region
+    auto east = region_of(land[5]);
+    res = region_project.moveProvinceToStrategicRegion(land[2], east);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(region_of(land[2]), east);
+    ASSERT_EQ(region_project.getStrategicRegionForID(region_of(land[0]))->get().provinces.size(), 2);
+
+    // Putting every sea province into a new region empties out the old ones
+    auto ocean = region_project.addNewStrategicRegion(sea);
+    ASSERT_EQ(region_project.getStrategicRegions().size(), 3);
+    for(auto&& id : sea) {
+        ASSERT_EQ(region_of(id), ocean);
+    }
+
+    // Everything survives being saved and loaded again
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto regions = region_project.getStrategicRegions();
+
+    res = region_project.save(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    res = region_project.removeStrategicRegion(ocean);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(region_of(sea[0]), 0);
+
+    res = region_project.load(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    ASSERT_EQ(region_project.getStrategicRegions().size(), regions.size());
+    for(auto&& [id, region] : regions) {
+        auto loaded = region_project.getStrategicRegionForID(id);
+        ASSERT_SUCCEEDED(loaded);
+        ASSERT_EQ(loaded->get().name, region.name);
+        ASSERT_EQ(loaded->get().provinces, region.provinces);
+    }
+    ASSERT_EQ(region_of(sea[0]), ocean);
+}
+
+TEST(ProjectTests, ExportStrategicRegionWeatherTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    HMDT::Project::Project hproject;
+
+    auto& region_project = hproject.getMapProject().getStrategicRegionProject();
+
+    auto id = region_project.addNewStrategicRegion({ });
+
+    auto export_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "export_regions";
+    std::filesystem::remove_all(export_path);
+
+    auto res = region_project.export_(export_path);
+    ASSERT_SUCCEEDED(res);
+
+    std::ifstream exported(export_path / HMDT::STRATEGICREGIONS_FOLDER /
+                           (std::to_string(id) + "-REGION" + std::to_string(id) + ".txt"));
+    ASSERT_TRUE(exported);
+
+    std::stringstream contents;
+    contents << exported.rdbuf();
+
+    // Every exported region gets a weather period for each month
+    auto text = contents.str();
+    size_t periods = 0;
+    for(auto pos = text.find("period={"); pos != std::string::npos;
+        pos = text.find("period={", pos + 1))
+    {
+        ++periods;
+    }
+    ASSERT_EQ(periods, 12);
+    ASSERT_NE(text.find("between={ 0.0 30.0 }"), std::string::npos);
+    ASSERT_NE(text.find("between={ 0.11 30.11 }"), std::string::npos);
+}
+
+TEST(ProjectTests, GenerateStatesTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    constexpr uint32_t width = 22;
+    constexpr uint32_t height = 4;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A chain of land provinces E1-E6 in europe and A1-A2 in asia, then two sea
+    //   provinces S1-S2, then a small european island I. Every province is 2
+    //   pixels wide.
+    std::vector<HMDT::ProvinceID> europe(6);
+    std::vector<HMDT::ProvinceID> asia(2);
+    std::vector<HMDT::ProvinceID> sea(2);
+    HMDT::ProvinceID island;
+
+    std::vector<HMDT::ProvinceID> columns;
+    columns.insert(columns.end(), europe.begin(), europe.end());
+    columns.insert(columns.end(), asia.begin(), asia.end());
+    columns.insert(columns.end(), sea.begin(), sea.end());
+    columns.push_back(island);
+
+    for(size_t i = 0; i < columns.size(); ++i) {
+        std::set<HMDT::ProvinceID> adjacent;
+        if(i > 0) adjacent.insert(columns[i - 1]);
+        if(i + 1 < columns.size()) adjacent.insert(columns[i + 1]);
+
+        auto is_sea = i >= europe.size() + asia.size() && i + 1 < columns.size();
+        auto continent = (i >= europe.size() && i < europe.size() + asia.size()) ? "asia" : "europe";
+
+        prov_project.getProvinces()[columns[i]] = HMDT::Province {
+            columns[i], HMDT::Color{ 0, 0, 0 },
+            is_sea ? HMDT::ProvinceType::SEA : HMDT::ProvinceType::LAND,
+            false, "unknown", continent,
+            0, { { 0, 0 }, { 0, 0 } }, adjacent, HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = columns[x / 2];
+            }
+        }
+    }
+
+    // Any existing state is replaced
+    state_project.addNewState({ sea[0] });
+    ASSERT_EQ(prov_project.getProvinceForID(sea[0]).state, 1);
+
+    // Europe makes 2 states of 3, asia is too small to be split but can't be
+    //   joined to europe, and the island is its own state
+    auto res = state_project.generateStates(3, 1);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(state_project.getStates().size(), 4);
+
+    auto state_of = [&](const HMDT::ProvinceID& id) {
+        return prov_project.getProvinceForID(id).state;
+    };
+
+    // Sea provinces are never put into a state
+    ASSERT_EQ(state_of(sea[0]), 0);
+    ASSERT_EQ(state_of(sea[1]), 0);
+
+    // The european chain gets split evenly down the middle
+    ASSERT_EQ(state_of(europe[0]), state_of(europe[1]));
+    ASSERT_EQ(state_of(europe[1]), state_of(europe[2]));
+    ASSERT_EQ(state_of(europe[3]), state_of(europe[4]));
+    ASSERT_EQ(state_of(europe[4]), state_of(europe[5]));
+    ASSERT_NE(state_of(europe[0]), state_of(europe[5]));
+
+    // States never cross continents
+    ASSERT_EQ(state_of(asia[0]), state_of(asia[1]));
+    ASSERT_NE(state_of(asia[0]), state_of(europe[5]));
+
+    // States are always contiguous, so the island is not added to one
+    ASSERT_NE(state_of(island), 0);
+    ASSERT_EQ(state_project.getStateForID(state_of(island))->get().provinces,
+              (std::vector<HMDT::ProvinceID>{ island }));
+
+    // Every state lists exactly the provinces which say they are in it
+    for(auto&& [id, state] : state_project.getStates()) {
+        ASSERT_EQ(state.id, id);
+        for(auto&& prov_id : state.provinces) {
+            ASSERT_EQ(state_of(prov_id), id);
+        }
+    }
+
+    // The state matrix is rebuilt for the new states
+    {
+        auto state_matrix = map_data->getStateIDMatrix().lock();
+        for(uint32_t x = 0; x < width; ++x) {
+            ASSERT_EQ(state_matrix[HMDT::xyToIndex(width, x, 0)], state_of(columns[x / 2]));
+        }
+    }
+
+    // The same seed always gives the same states
+    auto states = state_project.getStates();
+    res = state_project.generateStates(3, 1);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(state_project.getStates().size(), states.size());
+    for(auto&& [id, state] : states) {
+        ASSERT_EQ(state_project.getStates().at(id).provinces, state.provinces);
+    }
+
+    // Generating by area works the same way, 24 pixels is 3 provinces
+    res = state_project.generateStatesOfSize(24, 1);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(state_project.getStates().size(), 4);
+    ASSERT_NE(state_of(europe[0]), state_of(europe[5]));
+
+    res = state_project.generateStates(0, 1);
+    ASSERT_FALSE(IS_SUCCESS(res));
+}
+
+TEST(ProjectTests, ProvinceDataSaveIsDeterministicTest) {
+    constexpr size_t PROVINCE_COUNT = 100;
+
+    std::vector<HMDT::ProvinceID> ids(PROVINCE_COUNT);
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+
+    // Save the same provinces twice, inserted in opposite orders
+    std::string contents[2];
+    for(size_t run = 0; run < 2; ++run) {
+        HMDT::Project::Project hproject;
+
+        auto& map_project = hproject.getMapProject();
+        auto& prov_project = map_project.getProvinceProject();
+
+        auto map_data = map_project.getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(PROVINCE_COUNT, 1);
+
+        for(size_t i = 0; i < PROVINCE_COUNT; ++i) {
+            auto index = (run == 0) ? i : (PROVINCE_COUNT - i - 1);
+            auto&& id = ids[index];
+
+            prov_project.getProvinces()[id] = HMDT::Province {
+                id, HMDT::Color{ static_cast<uint8_t>(index), 0, 0 },
+                HMDT::ProvinceType::LAND, false, "unknown", "None", 0,
+                { { 0, 0 }, { 0, 0 } }, { }, HMDT::INVALID_PROVINCE, { }
+            };
+        }
+
+        auto run_path = write_base_path / ("province_run" + std::to_string(run));
+        std::filesystem::create_directories(run_path);
+
+        auto res = prov_project.save(run_path);
+        ASSERT_SUCCEEDED(res);
+
+        auto file_contents = HMDT::readFileToString(run_path / HMDT::PROVINCEDATA_FILENAME);
+        ASSERT_SUCCEEDED(file_contents);
+        contents[run] = *file_contents;
+    }
+
+    ASSERT_EQ(contents[0], contents[1]);
+
+    // Every province is written, in order of their IDs
+    std::sort(ids.begin(), ids.end());
+
+    HMDT::RecordParser parser(contents[0], ';');
+    for(auto&& id : ids) {
+        ASSERT_TRUE(parser.nextRecord());
+
+        auto parsed_id = HMDT::EMPTY_UUID;
+        ASSERT_SUCCEEDED(parser.parseField(parsed_id));
+        ASSERT_EQ(parsed_id, id);
+    }
+    ASSERT_FALSE(parser.nextRecord());
+}
+
+TEST(ProjectTests, LoadBaselineProvinceDataTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(2, 1);
+
+    auto west = HMDT::UUID::parse("00000000-0000-0000-0000-000000000001").orElse(HMDT::EMPTY_UUID);
+    auto east = HMDT::UUID::parse("00000000-0000-0000-0000-000000000002").orElse(HMDT::EMPTY_UUID);
+
+    for(auto&& id : { west, east }) {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+            "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        prov_matrix[0] = west;
+        prov_matrix[1] = east;
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "baseline_provinces";
+    std::filesystem::create_directories(write_base_path);
+
+    auto res = prov_project.save(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    // Rows as they were written by earlier versions, one without a parent ID
+    //   and one which was edited by hand to have junk after some numbers
+    {
+        std::ofstream out(write_base_path / HMDT::PROVINCEDATA_FILENAME);
+        out << "00000000-0000-0000-0000-000000000001;12;34;56;land;false;plains;europe;0;1;1;0;3"
+            << std::endl
+            << "00000000-0000-0000-0000-000000000002;78 ;90;1;Sea;true;ocean;;1;1px;2;0.0;0;"
+            << "00000000-0000-0000-0000-000000000001"
+            << std::endl;
+    }
+
+    res = prov_project.load(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    ASSERT_EQ(prov_project.getProvinces().size(), 2);
+
+    const auto& w = prov_project.getProvinceForID(west);
+    ASSERT_EQ(w.unique_color, (HMDT::Color{ 12, 34, 56 }));
+    ASSERT_EQ(w.type, HMDT::ProvinceType::LAND);
+    ASSERT_FALSE(w.coastal);
+    ASSERT_EQ(w.terrain, "plains");
+    ASSERT_EQ(w.continent, "europe");
+    ASSERT_EQ(w.state, 3);
+    ASSERT_EQ(w.parent_id, HMDT::INVALID_PROVINCE);
+    ASSERT_EQ(w.children, (std::set<HMDT::ProvinceID>{ east }));
+
+    // Unknown types are loaded as UNKNOWN, and anything after a number is
+    //   ignored, just like before
+    const auto& e = prov_project.getProvinceForID(east);
+    ASSERT_EQ(e.unique_color, (HMDT::Color{ 78, 90, 1 }));
+    ASSERT_EQ(e.type, HMDT::ProvinceType::UNKNOWN);
+    ASSERT_TRUE(e.coastal);
+    ASSERT_EQ(e.continent, "");
+    ASSERT_EQ(e.bounding_box.bottom_left.x, 1);
+    ASSERT_EQ(e.bounding_box.bottom_left.y, 1);
+    ASSERT_EQ(e.bounding_box.top_right.x, 2);
+    ASSERT_EQ(e.bounding_box.top_right.y, 0);
+    ASSERT_EQ(e.parent_id, west);
+
+    // Fields with no number at all are still errors
+    {
+        std::ofstream out(write_base_path / HMDT::PROVINCEDATA_FILENAME);
+        out << "00000000-0000-0000-0000-000000000001;red;34;56;land;false;plains;europe;0;1;1;0;3"
+            << std::endl;
+    }
+
+    res = prov_project.load(write_base_path);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+}
+
+TEST(ProjectTests, ExportIDsAreKeptTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 5;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, 2);
+
+    // C is the left column, B is the right of the top row, and A is everything
+    //   else. C has the lowest UUID, so numbering provinces from scratch would give
+    //   every other province a new ID once it is gone
+    auto id_c = HMDT::UUID::parse("00000000-0000-0000-0000-000000000001").orElse(HMDT::EMPTY_UUID);
+    auto id_b = HMDT::UUID::parse("00000000-0000-0000-0000-000000000002").orElse(HMDT::EMPTY_UUID);
+    auto id_a = HMDT::UUID::parse("00000000-0000-0000-0000-000000000003").orElse(HMDT::EMPTY_UUID);
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[id_c] = HMDT::Province {
+        id_c, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, 1 }, { 0, 0 } }, { id_a },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_a] = HMDT::Province {
+        id_a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 1, 1 }, { width - 1, 0 } }, { id_b, id_c },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_b] = HMDT::Province {
+        id_b, HMDT::Color{ 0, 255, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 2, 0 }, { width - 1, 0 } }, { id_a },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t x = 0; x < width; ++x) {
+            prov_matrix[HMDT::xyToIndex(width, x, 0)] = (x == 0) ? id_c :
+                                                        (x == 1) ? id_a :
+                                                                   id_b;
+            prov_matrix[HMDT::xyToIndex(width, x, 1)] = (x == 0) ? id_c : id_a;
+        }
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "export_ids";
+    std::filesystem::create_directories(write_base_path);
+
+    // Provinces without an export ID are numbered in order of their UUIDs
+    ASSERT_SUCCEEDED(prov_project.save(write_base_path));
+    ASSERT_SUCCEEDED(prov_project.load(write_base_path));
+
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_c), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_b), 2);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_a), 3);
+
+    // Splitting B gives the new piece the next ID, and undoing it gives that
+    //   ID back to be used again
+    auto edit = prov_project.paintProvince(id_a, { { 3, 0 } });
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_EQ(edit->new_provinces.size(), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(edit->new_provinces.front()), 4);
+
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*edit));
+
+    edit = prov_project.paintProvince(id_a, { { 3, 0 } });
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_EQ(edit->new_provinces.size(), 1);
+    auto id_n = edit->new_provinces.front();
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_n), 4);
+
+    // Removing C exports everything else without a gap, but C keeps its ID so
+    //   that undoing the removal gives it back
+    edit = prov_project.paintProvince(id_a, { { 0, 0 }, { 0, 1 } });
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_FALSE(prov_project.isValidProvinceID(id_c));
+
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_b), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_a), 2);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_n), 3);
+
+    ASSERT_SUCCEEDED(prov_project.revertProvinceEdit(*edit));
+
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_c), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_b), 2);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_a), 3);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_n), 4);
+
+    // The saved IDs do not change when C is removed, even after saving and
+    //   loading the project again
+    edit = prov_project.paintProvince(id_a, { { 0, 0 }, { 0, 1 } });
+    ASSERT_SUCCEEDED(edit);
+
+    ASSERT_SUCCEEDED(prov_project.save(write_base_path));
+    ASSERT_SUCCEEDED(prov_project.load(write_base_path));
+
+    ASSERT_EQ(provinces.size(), 3);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_b), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_a), 2);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_n), 3);
+
+    {
+        std::ifstream in(write_base_path / HMDT::PROVINCEDATA_FILENAME);
+        ASSERT_TRUE(in);
+
+        std::map<std::string, std::string> saved_ids;
+        for(std::string line; std::getline(in, line); ) {
+            saved_ids[line.substr(0, line.find(';'))] = line.substr(line.rfind(';') + 1);
+        }
+
+        ASSERT_EQ(saved_ids.size(), 3);
+        ASSERT_EQ(saved_ids["00000000-0000-0000-0000-000000000002"], "2");
+        ASSERT_EQ(saved_ids["00000000-0000-0000-0000-000000000003"], "3");
+        ASSERT_EQ(saved_ids.count("00000000-0000-0000-0000-000000000001"), 0);
+    }
+
+    // New provinces carry on from the highest saved ID. Painting B away from
+    //   the rest of it makes a new province.
+    edit = prov_project.paintProvince(id_b, { { 0, 0 } });
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_EQ(edit->new_provinces.size(), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(edit->new_provinces.front()), 4);
+}
+
+TEST(ProjectTests, ExportedIDsAreContiguousTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 3;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, 1);
+
+    // One province in each column, numbered from left to right
+    auto id_a = HMDT::UUID::parse("00000000-0000-0000-0000-000000000001").orElse(HMDT::EMPTY_UUID);
+    auto id_b = HMDT::UUID::parse("00000000-0000-0000-0000-000000000002").orElse(HMDT::EMPTY_UUID);
+    auto id_c = HMDT::UUID::parse("00000000-0000-0000-0000-000000000003").orElse(HMDT::EMPTY_UUID);
+
+    map_project.getContinentProject().addNewContinent("unknown");
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[id_a] = HMDT::Province {
+        id_a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "unknown", 0, { { 0, 0 }, { 0, 0 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_b] = HMDT::Province {
+        id_b, HMDT::Color{ 0, 255, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "unknown", 0, { { 1, 0 }, { 1, 0 } }, { id_a, id_c },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[id_c] = HMDT::Province {
+        id_c, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "unknown", 0, { { 2, 0 }, { 2, 0 } }, { id_b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        prov_matrix[0] = id_a;
+        prov_matrix[1] = id_b;
+        prov_matrix[2] = id_c;
+    }
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "contiguous_export_ids";
+    std::filesystem::create_directories(write_base_path);
+
+    ASSERT_SUCCEEDED(prov_project.save(write_base_path));
+    ASSERT_SUCCEEDED(prov_project.load(write_base_path));
+
+    // Paint B away completely
+    auto edit = prov_project.paintProvince(id_a, { { 1, 0 } });
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_FALSE(prov_project.isValidProvinceID(id_b));
+
+    auto export_path = write_base_path / "export";
+    ASSERT_SUCCEEDED(prov_project.export_(export_path));
+
+    std::ifstream in(export_path / HMDT::PROVINCEDATA_FILENAME);
+    ASSERT_TRUE(in);
+
+    std::vector<std::string> lines;
+    for(std::string line; std::getline(in, line); ) {
+        lines.push_back(line);
+    }
+
+    ASSERT_EQ(lines.size(), 2);
+    ASSERT_EQ(lines[0].substr(0, lines[0].find(';')), "1");
+    ASSERT_EQ(lines[1].substr(0, lines[1].find(';')), "2");
+
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_a), 1);
+    ASSERT_EQ(prov_project.getIDForProvinceID(id_c), 2);
+}
+
+TEST(ProjectTests, StateProjectSaveAndLoadTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(2, 1);
+
+    HMDT::ProvinceID west;
+    HMDT::ProvinceID east;
+
+    for(auto&& id : { west, east }) {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+            "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        prov_matrix[0] = west;
+        prov_matrix[1] = east;
+    }
+
+    auto state_id = state_project.addNewState({ west, east });
+    auto state = state_project.getStates().at(state_id);
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto res = state_project.save(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    res = state_project.load(write_base_path);
+    ASSERT_SUCCEEDED(res);
+
+    ASSERT_EQ(state_project.getStates().size(), 1);
+    const auto& loaded = state_project.getStates().at(state_id);
+    ASSERT_EQ(loaded.name, state.name);
+    ASSERT_EQ(loaded.manpower, state.manpower);
+    ASSERT_EQ(loaded.category, state.category);
+    ASSERT_FLOAT_EQ(loaded.buildings_max_level_factor, state.buildings_max_level_factor);
+    ASSERT_EQ(loaded.impassable, state.impassable);
+    ASSERT_EQ(loaded.provinces, state.provinces);
+    ASSERT_EQ(loaded.color, state.color);
+
+    // A broken line is reported, instead of being loaded half-way
+    {
+        std::ofstream out(write_base_path / HMDT::STATEDATA_FILENAME);
+        out << "1;Good;0;rural;1;0;;1;2;3\n"
+            << "2;Bad;lots;rural;1;0;;1;2;3\n";
+    }
+
+    res = state_project.load(write_base_path);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+}
+
+TEST(ProjectTests, ImportModTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    auto base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "import_mod";
+    std::filesystem::remove_all(base_path);
+
+    auto mod_root = base_path / "mod";
+    std::filesystem::create_directories(mod_root / "map");
+    std::filesystem::create_directories(mod_root / "history" / "states");
+
+    // 8x4 map:
+    //   A A A A B B B B
+    //   A A A A B B B B
+    //   C C C C U U U U
+    //   C C C C U U U U
+    // Where U is not defined in definition.csv
+    constexpr uint32_t WIDTH = 8;
+    constexpr uint32_t HEIGHT = 4;
+    const HMDT::Color A{ 200, 10, 10 }, B{ 10, 200, 10 }, C{ 10, 10, 200 },
+                      U{ 50, 50, 50 };
+
+    std::vector<unsigned char> pixels;
+    for(uint32_t y = 0; y < HEIGHT; ++y) {
+        for(uint32_t x = 0; x < WIDTH; ++x) {
+            auto c = (y < 2) ? ((x < 4) ? A : B) : ((x < 4) ? C : U);
+            pixels.insert(pixels.end(), { c.r, c.g, c.b });
+        }
+    }
+
+    auto res = HMDT::writeBMP2(mod_root / "map" / HMDT::PROVINCES_FILENAME,
+                               pixels.data(), WIDTH, HEIGHT);
+    ASSERT_SUCCEEDED(res);
+
+    // Province 4 is defined, but is not in the map
+    {
+        std::ofstream out(mod_root / "map" / HMDT::PROVINCEDATA_FILENAME);
+        out << "0;0;0;0;land;false;unknown;0\n"
+            << "1;200;10;10;land;false;plains;1\n"
+            << "2;10;200;10;land;true;forest;2\n"
+            << "3;10;10;200;sea;true;ocean;0\n"
+            << "4;1;2;3;land;false;plains;1\n";
+    }
+    {
+        std::ofstream out(mod_root / "map" / HMDT::CONTINENT_FILENAME);
+        out << "continents = {\n\teurope\n\tasia\n}\n";
+    }
+    {
+        std::ofstream out(mod_root / "history" / "states" / "1-First.txt");
+        out << "state={\n\tid=1\n\tname=\"STATE_1\"\n\tmanpower=100\n"
+               "\tstate_category = town\n"
+               "\thistory={ owner = FRA }\n"
+               "\tprovinces={ 1 2 }\n}\n";
+    }
+    {
+        // Province 99 does not exist, and is skipped
+        std::ofstream out(mod_root / "history" / "states" / "2-Second.txt");
+        out << "state={\n\tid=2\n\tname=\"STATE_2\"\n\tmanpower=5\n"
+               "\tstate_category = wasteland\n"
+               "\tprovinces={ 3 99 }\n\timpassable = yes\n}\n";
+    }
+
+    HMDT::Project::Project hproject;
+    hproject.setPath(base_path / "project" / "test.hoi4proj");
+
+    res = hproject.importMod(mod_root);
+    ASSERT_SUCCEEDED(res);
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    const auto& oldid_to_uuid = prov_project.getOldIDToUUIDMap();
+
+    ASSERT_EQ(map_project.getMapData()->getWidth(), WIDTH);
+    ASSERT_EQ(map_project.getMapData()->getHeight(), HEIGHT);
+
+    // The 3 defined provinces in the map, plus one for the undefined color
+    ASSERT_EQ(prov_project.getProvinces().size(), 4);
+    ASSERT_EQ(oldid_to_uuid.count(4), 0);
+
+    // Exporting gives every defined province back its original ID
+    for(uint32_t id = 1; id <= 3; ++id) {
+        ASSERT_EQ(oldid_to_uuid.count(id), 1);
+        ASSERT_EQ(prov_project.getIDForProvinceID(oldid_to_uuid.at(id)), id);
+    }
+
+    const auto& a = prov_project.getProvinceForID(oldid_to_uuid.at(1));
+    ASSERT_EQ(a.unique_color, A);
+    ASSERT_EQ(a.type, HMDT::ProvinceType::LAND);
+    ASSERT_EQ(a.terrain, "plains");
+    ASSERT_EQ(a.continent, "europe");
+    ASSERT_EQ(a.bounding_box.bottom_left.x, 0);
+    ASSERT_EQ(a.bounding_box.bottom_left.y, 1);
+    ASSERT_EQ(a.bounding_box.top_right.x, 3);
+    ASSERT_EQ(a.bounding_box.top_right.y, 0);
+
+    const auto& b = prov_project.getProvinceForID(oldid_to_uuid.at(2));
+    ASSERT_TRUE(b.coastal);
+    ASSERT_EQ(b.continent, "asia");
+
+    const auto& c = prov_project.getProvinceForID(oldid_to_uuid.at(3));
+    ASSERT_EQ(c.type, HMDT::ProvinceType::SEA);
+    ASSERT_EQ(c.continent, "None");
+
+    ASSERT_EQ(a.adjacent_provinces, (std::set<HMDT::ProvinceID>{ b.id, c.id }));
+
+    // The undefined color is imported after every defined province
+    auto prov_matrix = map_project.getMapData()->getProvinces().lock();
+    const auto& u = prov_project.getProvinceForID(prov_matrix[HMDT::xyToIndex(WIDTH, 7, 3)]);
+    ASSERT_EQ(u.unique_color, U);
+    ASSERT_EQ(prov_project.getIDForProvinceID(u.id), 4);
+    ASSERT_EQ(u.adjacent_provinces, (std::set<HMDT::ProvinceID>{ b.id, c.id }));
+
+    ASSERT_EQ(prov_matrix[HMDT::xyToIndex(WIDTH, 0, 0)], a.id);
+    ASSERT_EQ(prov_matrix[HMDT::xyToIndex(WIDTH, 5, 1)], b.id);
+
+    // The graphics data is stored as BGR
+    {
+        auto graphics_data = map_project.getMapData()->getProvinceColors().lock();
+        auto gindex = HMDT::xyToIndex(WIDTH * 3, 5 * 3, 1);
+        ASSERT_EQ(graphics_data[gindex], B.b);
+        ASSERT_EQ(graphics_data[gindex + 1], B.g);
+        ASSERT_EQ(graphics_data[gindex + 2], B.r);
+    }
+
+    const auto& continents = map_project.getContinentProject().getContinentList();
+    ASSERT_EQ(continents, (std::set<std::string>{ "europe", "asia" }));
+
+    const auto& states = hproject.getHistoryProject().getStateProject().getStates();
+    ASSERT_EQ(states.size(), 2);
+
+    ASSERT_EQ(states.at(1).name, "STATE_1");
+    ASSERT_EQ(states.at(1).manpower, 100);
+    ASSERT_EQ(states.at(1).category, "town");
+    ASSERT_EQ(states.at(1).provinces, (std::vector<HMDT::ProvinceID>{ a.id, b.id }));
+    ASSERT_EQ(a.state, 1);
+    ASSERT_EQ(b.state, 1);
+
+    ASSERT_TRUE(states.at(2).impassable);
+    ASSERT_EQ(states.at(2).provinces, (std::vector<HMDT::ProvinceID>{ c.id }));
+    ASSERT_EQ(c.state, 2);
+    ASSERT_EQ(u.state, 0);
+
+    // The province map is kept so that the project can be loaded again
+    ASSERT_TRUE(std::filesystem::exists(hproject.getInputsRoot() / HMDT::INPUT_PROVINCEMAP_FILENAME));
+
+    // definition.csv is required
+    std::filesystem::remove(mod_root / "map" / HMDT::PROVINCEDATA_FILENAME);
+    res = hproject.importMod(mod_root);
+    ASSERT_FALSE(IS_SUCCESS(res));
+}
+
+TEST(ProjectTests, GenerateProvincesTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    auto base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "generate_provinces";
+    std::filesystem::remove_all(base_path);
+    std::filesystem::create_directories(base_path);
+
+    // 64x32 mask, land on the left and sea on the right
+    constexpr uint32_t WIDTH = 64;
+    constexpr uint32_t HEIGHT = 32;
+
+    std::vector<unsigned char> pixels;
+    for(uint32_t y = 0; y < HEIGHT; ++y) {
+        for(uint32_t x = 0; x < WIDTH; ++x) {
+            if(x < WIDTH / 2) {
+                pixels.insert(pixels.end(), { 0xFF, 0, 0 });
+            } else {
+                pixels.insert(pixels.end(), { 0, 0, 0xFF });
+            }
+        }
+    }
+
+    auto mask_path = base_path / "mask.bmp";
+    auto res = HMDT::writeBMP2(mask_path, pixels.data(), WIDTH, HEIGHT);
+    ASSERT_SUCCEEDED(res);
+
+    HMDT::Project::Project hproject;
+    hproject.setPath(base_path / "project" / "test.hoi4proj");
+
+    // Any existing state is dropped along with the provinces it refers to
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+    state_project.addNewState({ });
+    ASSERT_EQ(state_project.getStates().size(), 1);
+
+    HMDT::ProvinceGeneratorOptions options;
+    options.province_count = 8;
+    options.seed = 3;
+
+    res = hproject.generateProvinces(mask_path, { }, options);
+    ASSERT_SUCCEEDED(res);
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    ASSERT_EQ(map_project.getMapData()->getWidth(), WIDTH);
+    ASSERT_EQ(map_project.getMapData()->getHeight(), HEIGHT);
+    ASSERT_GE(prov_project.getProvinces().size(), 4);
+    ASSERT_TRUE(state_project.getStates().empty());
+
+    // Every pixel belongs to a province of the type the mask gave it, and
+    //   the provinces along the shore are coastal
+    auto prov_matrix = map_project.getMapData()->getProvinces().lock();
+    for(uint32_t y = 0; y < HEIGHT; ++y) {
+        for(uint32_t x = 0; x < WIDTH; ++x) {
+            const auto& province = prov_project.getProvinceForID(prov_matrix[HMDT::xyToIndex(WIDTH, x, y)]);
+            ASSERT_EQ(province.type, (x < WIDTH / 2) ? HMDT::ProvinceType::LAND
+                                                     : HMDT::ProvinceType::SEA)
+                << "(" << x << ", " << y << ")";
+
+            if(x == WIDTH / 2 - 1) {
+                ASSERT_TRUE(province.coastal);
+            }
+        }
+    }
+
+    // The province map is kept so that the project can be loaded again
+    ASSERT_TRUE(std::filesystem::exists(hproject.getInputsRoot() / HMDT::INPUT_PROVINCEMAP_FILENAME));
+
+    // A missing mask can't be generated from, and leaves the project alone
+    auto province_count = prov_project.getProvinces().size();
+    res = hproject.generateProvinces(base_path / "missing.bmp", { }, options);
+    ASSERT_FALSE(IS_SUCCESS(res));
+    ASSERT_EQ(prov_project.getProvinces().size(), province_count);
+}
+
+TEST(ProjectTests, FindLabelPointsTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+
+    constexpr uint32_t width = 16;
+    constexpr uint32_t height = 16;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // A ring 4 pixels thick around the edge of the map, with a square in the
+    //   middle of it. The centroid of the ring is inside of the square.
+    HMDT::ProvinceID ring;
+    HMDT::ProvinceID square;
+
+    for(auto&& [id, other] : { std::pair{ ring, square }, std::pair{ square, ring } }) {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+            "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { other },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto heightmap = map_data->getHeightMap().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto edge = std::min({ x, y, width - 1 - x, height - 1 - y });
+
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (edge < 4) ? ring : square;
+                heightmap[HMDT::xyToIndex(width, x, y)] = x * 10 + y;
+            }
+        }
+    }
+
+    auto label_points = map_project.findLabelPoints();
+    ASSERT_SUCCEEDED(label_points);
+    ASSERT_EQ(label_points->size(), 2);
+
+    // The corners of the ring have the most room. They are all tied, so the
+    //   first one wins.
+    const auto& ring_point = label_points->at(ring);
+    ASSERT_EQ(ring_point.position.x, 2);
+    ASSERT_EQ(ring_point.position.y, 2);
+    ASSERT_DOUBLE_EQ(ring_point.radius, std::sqrt(8.0));
+    ASSERT_EQ(ring_point.height, 22);
+
+    // The square is furthest from its edges in its middle
+    const auto& square_point = label_points->at(square);
+    ASSERT_EQ(square_point.position.x, 7);
+    ASSERT_EQ(square_point.position.y, 7);
+    ASSERT_DOUBLE_EQ(square_point.radius, 4.0);
+    ASSERT_EQ(square_point.height, 77);
+
+    // Check against a brute force search on a map with more irregular shapes,
+    //   including ones which are split into several pieces
+    std::vector<HMDT::ProvinceID> blobs(5);
+    for(auto&& id : blobs) {
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+            "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+    prov_project.getProvinces().erase(ring);
+    prov_project.getProvinces().erase(square);
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = blobs[(x * x + 3 * y + (x * y) / 5) % 5];
+            }
+        }
+    }
+
+    label_points = map_project.findLabelPoints();
+    ASSERT_SUCCEEDED(label_points);
+    ASSERT_EQ(label_points->size(), blobs.size());
+
+    auto prov_matrix = map_data->getProvinces().lock();
+    for(auto&& id : blobs) {
+        int64_t best = 0;
+        for(int64_t y = 0; y < height; ++y) {
+            for(int64_t x = 0; x < width; ++x) {
+                if(prov_matrix[HMDT::xyToIndex(width, x, y)] != id) continue;
+
+                // Anything off of the map counts as outside of the province
+                int64_t closest = std::numeric_limits<int64_t>::max();
+                for(int64_t oy = -1; oy <= height; ++oy) {
+                    for(int64_t ox = -1; ox <= width; ++ox) {
+                        bool outside = ox < 0 || oy < 0 || ox >= width || oy >= height ||
+                                       prov_matrix[HMDT::xyToIndex(width, ox, oy)] != id;
+                        if(outside) {
+                            closest = std::min(closest, (ox - x) * (ox - x) + (oy - y) * (oy - y));
+                        }
+                    }
+                }
+                best = std::max(best, closest);
+            }
+        }
+
+        const auto& point = label_points->at(id);
+        ASSERT_EQ(prov_matrix[HMDT::xyToIndex(width, point.position.x, point.position.y)], id);
+        ASSERT_DOUBLE_EQ(point.radius, std::sqrt(static_cast<double>(best)));
+    }
+}
+
+TEST(ProjectTests, GenerateRiversTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    // getBitMap is not part of the IRiversProject interface
+    auto& rivers_project = dynamic_cast<HMDT::Project::RiversProject&>(
+            map_project.getRiversProject());
+
+    constexpr uint32_t width = 32;
+    constexpr uint32_t height = 16;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // The left-most column is sea, and everything else is land
+    HMDT::ProvinceID sea;
+    HMDT::ProvinceID land;
+
+    prov_project.getProvinces()[sea] = HMDT::Province {
+        sea, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { land },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[land] = HMDT::Province {
+        land, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, true,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    // A valley running along y=8 down to the sea, with a side valley joining
+    //   it from the north at x=16, and a pit in the middle of the main valley
+    //   which has to be filled for the water to get past it
+    auto valley_height = [](int32_t x, int32_t y) {
+        int32_t main = x + 3 * std::abs(y - 8);
+        int32_t side = (y <= 8) ? 16 + (8 - y) + 3 * std::abs(x - 16)
+                                : main;
+        return static_cast<uint8_t>(std::min(main, side));
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto heightmap = map_data->getHeightMap().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = HMDT::xyToIndex(width, x, y);
+
+                prov_matrix[index] = (x == 0) ? sea : land;
+                heightmap[index] = valley_height(x, y);
+            }
+        }
+
+        heightmap[HMDT::xyToIndex(width, 22, 8)] = 0;
+    }
+
+    auto res = rivers_project.generateRivers(20);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_TRUE(rivers_project.getBitMap());
+
+    auto rivers = map_data->getRivers().lock();
+    auto at = [&rivers](uint32_t x, uint32_t y) {
+        return rivers[HMDT::xyToIndex(width, x, y)];
+    };
+
+    // The generated map is what the project holds on to
+    ASSERT_EQ(std::memcmp(rivers.get(), rivers_project.getBitMap()->get().data.get(),
+                          width * height), 0);
+
+    // Sea stays sea, and rivers only ever run over land
+    for(uint32_t y = 0; y < height; ++y) {
+        ASSERT_EQ(at(0, y), HMDT::RIVER_WATER_INDEX);
+    }
+
+    // One river with one tributary, so 2 sources and 1 flow-in
+    uint32_t sources = 0;
+    uint32_t flow_ins = 0;
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            sources += (at(x, y) == HMDT::RIVER_SOURCE_INDEX);
+            flow_ins += (at(x, y) == HMDT::RIVER_FLOW_IN_INDEX);
+            ASSERT_NE(at(x, y), HMDT::RIVER_FLOW_OUT_INDEX);
+        }
+    }
+    ASSERT_EQ(sources, 2);
+    ASSERT_EQ(flow_ins, 1);
+
+    // The main river follows the valley all the way from the coast to past the
+    //   pit, and is widest at the coast
+    for(uint32_t x = 1; x <= 24; ++x) {
+        ASSERT_GE(at(x, 8), HMDT::RIVER_NARROWEST_INDEX) << "x=" << x;
+        ASSERT_LE(at(x, 8), HMDT::RIVER_WIDEST_INDEX) << "x=" << x;
+    }
+    ASSERT_GT(at(1, 8), at(24, 8));
+
+    // The tributary joins right next to the main river
+    ASSERT_EQ(at(16, 7), HMDT::RIVER_FLOW_IN_INDEX);
+
+    // Rivers are never more than 1 pixel thick
+    auto is_river = [&at](uint32_t x, uint32_t y) {
+        return at(x, y) <= HMDT::RIVER_WIDEST_INDEX;
+    };
+    for(uint32_t y = 0; y + 1 < height; ++y) {
+        for(uint32_t x = 0; x + 1 < width; ++x) {
+            ASSERT_FALSE(is_river(x, y) && is_river(x + 1, y) &&
+                         is_river(x, y + 1) && is_river(x + 1, y + 1));
+        }
+    }
+
+    // And the generated rivers are valid as far as HoI4 is concerned
+    auto issues = rivers_project.validateRivers();
+    ASSERT_SUCCEEDED(issues);
+    ASSERT_TRUE(issues->empty());
+}
+
+TEST(ProjectTests, ValidateRiversTest) {
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& rivers_project = map_project.getRiversProject();
+
+    constexpr uint32_t width = 12;
+    constexpr uint32_t height = 12;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    // The left-most column is sea, and everything else is land
+    HMDT::ProvinceID sea;
+    HMDT::ProvinceID land;
+
+    prov_project.getProvinces()[sea] = HMDT::Province {
+        sea, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { land },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[land] = HMDT::Province {
+        land, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, true,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto rivers = map_data->getRivers().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = HMDT::xyToIndex(width, x, y);
+
+                prov_matrix[index] = (x == 0) ? sea : land;
+                rivers[index] = (x == 0) ? HMDT::RIVER_WATER_INDEX
+                                         : HMDT::RIVER_LAND_INDEX;
+            }
+        }
+
+        auto set = [&rivers](uint32_t x, uint32_t y, uint8_t color) {
+            rivers[HMDT::xyToIndex(width, x, y)] = color;
+        };
+
+        // A valid river flowing into the sea, with a tributary joining it
+        for(uint32_t x = 1; x <= 4; ++x) {
+            set(x, 2, HMDT::RIVER_NARROWEST_INDEX);
+        }
+        set(5, 2, HMDT::RIVER_SOURCE_INDEX);
+        set(3, 1, HMDT::RIVER_FLOW_IN_INDEX);
+        set(3, 0, HMDT::RIVER_SOURCE_INDEX);
+
+        // Two valid single pixel rivers which only touch diagonally
+        set(8, 1, HMDT::RIVER_SOURCE_INDEX);
+        set(9, 2, HMDT::RIVER_SOURCE_INDEX);
+
+        // A river without a source which ends inland on both sides
+        for(uint32_t x = 3; x <= 5; ++x) {
+            set(x, 4, HMDT::RIVER_NARROWEST_INDEX);
+        }
+
+        // A river flowing into the sea with one source too many
+        set(1, 6, HMDT::RIVER_NARROWEST_INDEX);
+        set(2, 6, HMDT::RIVER_NARROWEST_INDEX);
+        set(3, 6, HMDT::RIVER_SOURCE_INDEX);
+        set(4, 6, HMDT::RIVER_SOURCE_INDEX);
+
+        // A river which is 2 pixels wide, and has no source
+        set(8, 8, HMDT::RIVER_NARROWEST_INDEX);
+        set(9, 8, HMDT::RIVER_NARROWEST_INDEX);
+        set(8, 9, HMDT::RIVER_NARROWEST_INDEX);
+        set(9, 9, HMDT::RIVER_NARROWEST_INDEX);
+
+        // A color which isn't in the palette at all
+        set(11, 11, 200);
+    }
+
+    auto res = rivers_project.validateRivers();
+    ASSERT_SUCCEEDED(res);
+
+    std::vector<std::tuple<uint32_t, uint32_t, HMDT::RiverIssueType>> expected{
+        { 8, 1, HMDT::RiverIssueType::DIAGONAL_CONNECTION },
+        { 3, 4, HMDT::RiverIssueType::MISSING_SOURCE },
+        { 3, 4, HMDT::RiverIssueType::INLAND_END },
+        { 5, 4, HMDT::RiverIssueType::INLAND_END },
+        { 4, 6, HMDT::RiverIssueType::EXTRA_SOURCE },
+        { 8, 8, HMDT::RiverIssueType::MISSING_SOURCE },
+        { 8, 8, HMDT::RiverIssueType::BLOB },
+        { 11, 11, HMDT::RiverIssueType::INVALID_COLOR },
+    };
+
+    ASSERT_EQ(res->size(), expected.size());
+    for(size_t i = 0; i < expected.size(); ++i) {
+        const auto& issue = res->at(i);
+        ASSERT_EQ(std::make_tuple(issue.position.x, issue.position.y, issue.type),
+                  expected[i]) << "i=" << i << ": " << issue.type;
+    }
+
+    // Rivers drawn with a different palette are mapped back onto ours first
+    HMDT::RiverPalette palette;
+    palette.fill(HMDT::INVALID_RIVER_COLOR);
+    for(uint32_t i = 0; i <= HMDT::RIVER_UNKNOWN_INDEX; ++i) {
+        palette[i] = i;
+    }
+    palette[200] = HMDT::RIVER_LAND_INDEX;
+
+    res = HMDT::validateRivers({ width, height },
+                               map_data->getRivers().lock().get(),
+                               palette,
+                               map_data->getProvinces().lock().get(),
+                               prov_project.getProvinces());
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(res->size(), expected.size() - 1);
+}
+
+TEST(ProjectTests, AssignTerrainTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    auto base_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "assign_terrain";
+    std::filesystem::remove_all(base_path);
+    std::filesystem::create_directories(base_path);
+
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& terrain_project = map_project.getTerrainProject();
+
+    // 8x4 map:
+    //   A A A A S S S S
+    //   A A A A S S S S
+    //   B B B B S S S S
+    //   B B B B S S S S
+    constexpr uint32_t width = 8;
+    constexpr uint32_t height = 4;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID sea;
+
+    prov_project.getProvinces()[a] = HMDT::Province {
+        a, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { b, sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[b] = HMDT::Province {
+        b, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "plains", "None", 0, { { 0, 0 }, { 0, 0 } }, { a, sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[sea] = HMDT::Province {
+        sea, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 0, 0 }, { 0, 0 } }, { a, b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    // Palette indices follow the project's terrains: 1 is ocean, 3 is forest,
+    //   4 is hills and 6 is plains. A is mostly forest, B is all hills and
+    //   the sea is ocean.
+    std::vector<unsigned char> terrain(width * height);
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = HMDT::xyToIndex(width, x, y);
+
+                if(x >= 4) {
+                    prov_matrix[index] = sea;
+                    terrain[index] = 1;
+                } else if(y < 2) {
+                    prov_matrix[index] = a;
+                    terrain[index] = (x == 0 && y == 0) ? 6 : 3;
+                } else {
+                    prov_matrix[index] = b;
+                    terrain[index] = 4;
+                }
+            }
+        }
+    }
+
+    auto makeColorTable = []() {
+        return HMDT::ColorTable {
+            7, std::unique_ptr<HMDT::RGBQuad[]>(new HMDT::RGBQuad[7]{
+                { { 0, 0, 0, 0 } },
+                { { 0xFF, 0, 0, 0 } },
+                { { 0xFF, 0x80, 0, 0 } },
+                { { 0, 0x80, 0, 0 } },
+                { { 0x40, 0x60, 0x80, 0 } },
+                { { 0x80, 0x80, 0x80, 0 } },
+                { { 0, 0xFF, 0x80, 0 } },
+            })
+        };
+    };
+
+    auto terrain_path = base_path / HMDT::TERRAIN_FILENAME;
+    auto res = HMDT::writeBMP2(terrain_path, terrain.data(), width, height,
+                               1 /* depth */, false /* is_greyscale */,
+                               HMDT::BMPHeaderToUse::V4, makeColorTable());
+    ASSERT_SUCCEEDED(res);
+
+    // Nothing can be calculated before a terrain map is loaded
+    ASSERT_FALSE(terrain_project.hasTerrainMap());
+    ASSERT_STATUS(terrain_project.calculateProvinceTerrains({}),
+                  HMDT::STATUS_NO_DATA_LOADED);
+
+    res = terrain_project.loadFile(terrain_path);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_TRUE(terrain_project.hasTerrainMap());
+
+    // Terrains are drawn in their palette color
+    auto forest_color = terrain_project.getTerrainColor("forest");
+    ASSERT_EQ(forest_color.r, 0);
+    ASSERT_EQ(forest_color.g, 0x80);
+    ASSERT_EQ(forest_color.b, 0);
+
+    // Only the land provinces whose terrain changes are returned, and nothing
+    //   is changed yet
+    auto changes = terrain_project.calculateProvinceTerrains({});
+    ASSERT_SUCCEEDED(changes);
+    ASSERT_EQ(changes->size(), 2);
+
+    std::map<HMDT::ProvinceID, HMDT::Project::ITerrainProject::TerrainChange> change_of;
+    for(auto&& change : *changes) {
+        change_of.emplace(change.id, change);
+    }
+    ASSERT_EQ(change_of.at(a).old_terrain, "unknown");
+    ASSERT_EQ(change_of.at(a).new_terrain, "forest");
+    ASSERT_EQ(change_of.at(b).old_terrain, "plains");
+    ASSERT_EQ(change_of.at(b).new_terrain, "hills");
+    ASSERT_EQ(prov_project.getProvinceForID(a).terrain, "unknown");
+
+    // Applying the changes can be undone
+    auto tag = terrain_project.getProvinceTerrainsUpdatedTag();
+
+    HMDT::Action::AssignTerrainAction action(map_project, *changes);
+    ASSERT_TRUE(action.doAction());
+    ASSERT_EQ(prov_project.getProvinceForID(a).terrain, "forest");
+    ASSERT_EQ(prov_project.getProvinceForID(b).terrain, "hills");
+    ASSERT_EQ(prov_project.getProvinceForID(sea).terrain, "unknown");
+    ASSERT_NE(terrain_project.getProvinceTerrainsUpdatedTag(), tag);
+
+    ASSERT_FALSE(action.doAction());
+
+    ASSERT_TRUE(action.undoAction());
+    ASSERT_EQ(prov_project.getProvinceForID(a).terrain, "unknown");
+    ASSERT_EQ(prov_project.getProvinceForID(b).terrain, "plains");
+
+    ASSERT_TRUE(action.doAction());
+
+    // Once applied, there is nothing left to change
+    changes = terrain_project.calculateProvinceTerrains({});
+    ASSERT_SUCCEEDED(changes);
+    ASSERT_TRUE(changes->empty());
+
+    // Sea provinces are only voted on when asked for
+    HMDT::TerrainVoteOptions options;
+    options.include_water = true;
+    changes = terrain_project.calculateProvinceTerrains(options);
+    ASSERT_SUCCEEDED(changes);
+    ASSERT_EQ(changes->size(), 1);
+    ASSERT_EQ(changes->front().id, sea);
+    ASSERT_EQ(changes->front().new_terrain, "ocean");
+
+    // Changes to provinces which don't exist are rejected without changing
+    //   anything
+    HMDT::ProvinceID missing;
+    ASSERT_STATUS(terrain_project.applyTerrainChanges({
+                      { a, "forest", "plains" },
+                      { missing, "forest", "plains" }
+                  }), HMDT::STATUS_VALUE_NOT_FOUND);
+    ASSERT_EQ(prov_project.getProvinceForID(a).terrain, "forest");
+
+    // The terrain map is saved along with the project
+    auto save_path = base_path / "saved";
+    std::filesystem::create_directories(save_path);
+    res = terrain_project.save(save_path);
+    ASSERT_SUCCEEDED(res);
+    res = terrain_project.load(save_path);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(std::memcmp(map_data->getTerrain().lock().get(), terrain.data(),
+                          width * height), 0);
+
+    // Terrain maps must match the map, and be 8-bit
+    res = HMDT::writeBMP2(base_path / "small.bmp", terrain.data(), width / 2,
+                          height, 1, false, HMDT::BMPHeaderToUse::V4,
+                          makeColorTable());
+    ASSERT_SUCCEEDED(res);
+    ASSERT_STATUS(terrain_project.loadFile(base_path / "small.bmp"),
+                  HMDT::STATUS_DIMENSION_MISMATCH);
+
+    std::vector<unsigned char> rgb(width * height * 3, 0);
+    res = HMDT::writeBMP2(base_path / "rgb.bmp", rgb.data(), width, height);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_STATUS(terrain_project.loadFile(base_path / "rgb.bmp"),
+                  HMDT::STATUS_INVALID_BIT_DEPTH);
+}
+
+TEST(ProjectTests, RenderMapTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    // 4x2 map:
+    //   A A B S
+    //   A A B S
+    constexpr uint32_t width = 4;
+    constexpr uint32_t height = 2;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID sea;
+
+    prov_project.getProvinces()[a] = HMDT::Province {
+        a, HMDT::Color{ 10, 20, 30 }, HMDT::ProvinceType::LAND, false,
+        "forest", "europe", 0, { { 0, 1 }, { 1, 0 } }, { b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[b] = HMDT::Province {
+        b, HMDT::Color{ 40, 50, 60 }, HMDT::ProvinceType::LAND, true,
+        "plains", "asia", 0, { { 2, 1 }, { 2, 0 } }, { a, sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    prov_project.getProvinces()[sea] = HMDT::Province {
+        sea, HMDT::Color{ 70, 80, 90 }, HMDT::ProvinceType::SEA, false,
+        "ocean", "", 0, { { 3, 1 }, { 3, 0 } }, { b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        auto heightmap = map_data->getHeightMap().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                auto index = HMDT::xyToIndex(width, x, y);
+
+                prov_matrix[index] = (x < 2) ? a : ((x == 2) ? b : sea);
+                heightmap[index] = x * 50;
+            }
+        }
+    }
+
+    auto state_a = state_project.addNewState({ a });
+    auto state_b = state_project.addNewState({ b });
+
+    auto pixel = [](const HMDT::RenderedMap& image, uint32_t x, uint32_t y) {
+        return HMDT::getColorAt(HMDT::Dimensions{ image.width, image.height },
+                                image.pixels.data(), x, y);
+    };
+
+    HMDT::MapRenderOptions no_borders;
+    no_borders.draw_province_borders = false;
+    no_borders.draw_state_borders = false;
+
+    // Provinces are drawn in their unique colors with province borders
+    {
+        auto image = hproject.renderMap(HMDT::MapMode::PROVINCES, {});
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, width);
+        ASSERT_EQ(image->height, height);
+        ASSERT_EQ(pixel(*image, 0, 0), (HMDT::Color{ 10, 20, 30 }));
+        ASSERT_EQ(pixel(*image, 1, 0), HMDT::PROVINCE_OUTLINE_COLOR);
+
+        auto options = no_borders;
+        options.selection = { a };
+        options.selection_color = HMDT::Color{ 110, 120, 130 };
+
+        image = hproject.renderMap(HMDT::MapMode::PROVINCES, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 1, 0), (HMDT::Color{ 60, 70, 80 }));
+        ASSERT_EQ(pixel(*image, 2, 0), (HMDT::Color{ 40, 50, 60 }));
+    }
+
+    // States are drawn in their colors with state borders, and provinces
+    //   without a state are black
+    {
+        const auto& states = state_project.getStates();
+
+        auto image = hproject.renderMap(HMDT::MapMode::STATES, {});
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0), states.at(state_a).color);
+        ASSERT_EQ(pixel(*image, 1, 0), HMDT::PROVINCE_OUTLINE_COLOR);
+
+        image = hproject.renderMap(HMDT::MapMode::STATES, no_borders);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 2, 0), states.at(state_b).color);
+        ASSERT_EQ(pixel(*image, 3, 0), (HMDT::Color{ 0, 0, 0 }));
+    }
+
+    {
+        auto image = hproject.renderMap(HMDT::MapMode::COASTAL, no_borders);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0), HMDT::RENDER_INLAND_COLOR);
+        ASSERT_EQ(pixel(*image, 2, 0), HMDT::RENDER_COASTAL_COLOR);
+        ASSERT_EQ(pixel(*image, 3, 0), HMDT::RENDER_WATER_COLOR);
+
+        image = hproject.renderMap(HMDT::MapMode::CONTINENTS, no_borders);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0), HMDT::colorFromString("europe"));
+        ASSERT_EQ(pixel(*image, 2, 0), HMDT::colorFromString("asia"));
+        ASSERT_EQ(pixel(*image, 3, 0), HMDT::RENDER_WATER_COLOR);
+
+        image = hproject.renderMap(HMDT::MapMode::TERRAIN, no_borders);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0),
+                  map_project.getTerrainProject().getTerrainColor("forest"));
+    }
+
+    // The heightmap has no borders by default
+    {
+        HMDT::MapRenderOptions options;
+        options.scale = 2;
+
+        auto image = hproject.renderMap(HMDT::MapMode::HEIGHTMAP, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, width * 2);
+        ASSERT_EQ(image->height, height * 2);
+        ASSERT_EQ(pixel(*image, 3, 0), (HMDT::Color{ 50, 50, 50 }));
+        ASSERT_EQ(pixel(*image, 6, 3), (HMDT::Color{ 150, 150, 150 }));
+    }
+}
+
+TEST(ProjectTests, IncrementalStateBordersTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& state_project = hproject.getHistoryProject().getStateProject();
+
+    // 6x2 map:
+    //   A A B B C C
+    //   A A B B C C
+    constexpr uint32_t width = 6;
+    constexpr uint32_t height = 2;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    HMDT::ProvinceID ids[3];
+    for(uint32_t i = 0; i < 3; ++i) {
+        auto& id = ids[i];
+        prov_project.getProvinces()[id] = HMDT::Province {
+            id, HMDT::Color{ 0, 0, 0 }, HMDT::ProvinceType::LAND, false,
+            "plains", "europe", 0,
+            { { i * 2, height - 1 }, { i * 2 + 1, 0 } }, { },
+            HMDT::INVALID_PROVINCE, { }
+        };
+    }
+    auto [a, b, c] = ids;
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = ids[x / 2];
+            }
+        }
+
+        ASSERT_SUCCEEDED(HMDT::buildBorderMask(HMDT::Dimensions{ width, height },
+                                               prov_matrix.get(),
+                                               map_data->getStateIDMatrix().lock().get(),
+                                               map_data->getProvinceOutlines().lock().get()));
+    }
+
+    // Every incremental update must give the same result as a full one
+    auto assertMatchesFullUpdate = [&]() {
+        auto size = width * height;
+
+        std::vector<uint32_t> state_ids(size);
+        std::vector<uint8_t> outlines(size);
+        std::memcpy(state_ids.data(), map_data->getStateIDMatrix().lock().get(),
+                    size * sizeof(uint32_t));
+        std::memcpy(outlines.data(), map_data->getProvinceOutlines().lock().get(),
+                    size);
+
+        state_project.updateStateIDMatrix();
+
+        ASSERT_EQ(std::memcmp(state_ids.data(), map_data->getStateIDMatrix().lock().get(),
+                              size * sizeof(uint32_t)), 0);
+        ASSERT_EQ(std::memcmp(outlines.data(), map_data->getProvinceOutlines().lock().get(),
+                              size), 0);
+    };
+
+    auto flags_at = [&](uint32_t x, uint32_t y) {
+        return map_data->getProvinceOutlines().lock()[HMDT::xyToIndex(width, x, y)];
+    };
+
+    auto tag = map_data->getStateIDMatrixUpdatedTag();
+
+    auto state_ab = state_project.addNewState({ a, b });
+    ASSERT_NE(map_data->getStateIDMatrixUpdatedTag(), tag);
+    ASSERT_EQ(map_data->getStateIDMatrix().lock()[HMDT::xyToIndex(width, 3, 1)], state_ab);
+    ASSERT_EQ(flags_at(1, 0), HMDT::OUTLINE_EAST);
+    ASSERT_EQ(flags_at(3, 0), HMDT::OUTLINE_EAST | (HMDT::OUTLINE_EAST << HMDT::OUTLINE_STATE_SHIFT));
+    assertMatchesFullUpdate();
+
+    auto state_c = state_project.addNewState({ c });
+    assertMatchesFullUpdate();
+
+    tag = map_data->getStateIDMatrixUpdatedTag();
+
+    map_project.moveProvinceToState(b, state_c);
+    ASSERT_NE(map_data->getStateIDMatrixUpdatedTag(), tag);
+    ASSERT_EQ(map_data->getStateIDMatrix().lock()[HMDT::xyToIndex(width, 2, 0)], state_c);
+    ASSERT_EQ(flags_at(1, 0), HMDT::OUTLINE_EAST | (HMDT::OUTLINE_EAST << HMDT::OUTLINE_STATE_SHIFT));
+    ASSERT_EQ(flags_at(3, 0), HMDT::OUTLINE_EAST);
+    assertMatchesFullUpdate();
+
+    auto res = state_project.removeState(state_ab);
+    ASSERT_SUCCEEDED(res);
+    assertMatchesFullUpdate();
+
+    map_project.removeProvinceFromState(prov_project.getProvinceForID(c));
+    assertMatchesFullUpdate();
+}
+
+TEST(ProjectTests, DiffProjectsTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // 4x2 maps:
+    //   old:       new:
+    //   A A B S    A A A S
+    //   A A B S    A A C S
+    constexpr uint32_t width = 4;
+    constexpr uint32_t height = 2;
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID c;
+    HMDT::ProvinceID sea;
+
+    auto make_province = [](const HMDT::ProvinceID& id, HMDT::Color color,
+                            HMDT::ProvinceType type, const std::string& terrain)
+    {
+        return HMDT::Province {
+            id, color, type, false, terrain, "europe", 0,
+            { { 0, 0 }, { 0, 0 } }, { }, HMDT::INVALID_PROVINCE, { }
+        };
+    };
+
+    auto setup_map = [](HMDT::Project::Project& hproject) {
+        auto map_data = hproject.getMapProject().getMapData();
+        map_data->~MapData();
+        new (map_data.get()) HMDT::MapData(width, height);
+
+        return map_data;
+    };
+
+    HMDT::Project::Project old_project;
+    old_project.setName("old");
+    auto old_map_data = setup_map(old_project);
+    {
+        auto& provinces = old_project.getMapProject().getProvinceProject().getProvinces();
+        provinces[a] = make_province(a, { 10, 20, 30 }, HMDT::ProvinceType::LAND, "forest");
+        provinces[b] = make_province(b, { 40, 50, 60 }, HMDT::ProvinceType::LAND, "plains");
+        provinces[sea] = make_province(sea, { 70, 80, 90 }, HMDT::ProvinceType::SEA, "ocean");
+
+        auto prov_matrix = old_map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 2) ? a : ((x == 2) ? b : sea);
+            }
+        }
+    }
+
+    HMDT::Project::Project new_project;
+    new_project.setName("new");
+    auto new_map_data = setup_map(new_project);
+    {
+        auto& provinces = new_project.getMapProject().getProvinceProject().getProvinces();
+        provinces[a] = make_province(a, { 10, 20, 30 }, HMDT::ProvinceType::LAND, "hills");
+        provinces[c] = make_province(c, { 100, 110, 120 }, HMDT::ProvinceType::LAND, "plains");
+        provinces[sea] = make_province(sea, { 70, 80, 90 }, HMDT::ProvinceType::SEA, "ocean");
+
+        auto prov_matrix = new_map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] =
+                    (x == 3) ? sea : ((x == 2 && y == 1) ? c : a);
+            }
+        }
+
+        new_map_data->getHeightMap().lock()[HMDT::xyToIndex(width, 3, 1)] = 100;
+        new_map_data->getRivers().lock()[HMDT::xyToIndex(width, 0, 0)] = 5;
+    }
+
+    // Both versions have the same two states, except for which province is
+    //   in the second one
+    for(auto* hproject : { &old_project, &new_project }) {
+        auto& state_project = hproject->getHistoryProject().getStateProject();
+        state_project.addNewState({ a });
+        state_project.addNewState({ (hproject == &old_project) ? b : c });
+
+        for(auto it = state_project.getStates().begin(); it != state_project.getStates().end(); ++it) {
+            state_project.getStateForIterator(it).color = HMDT::Color{ 1, 2, 3 };
+        }
+    }
+
+    // Comparing a project against itself finds nothing
+    {
+        auto diff = old_project.diff(old_project);
+        ASSERT_SUCCEEDED(diff);
+        ASSERT_TRUE(diff->empty());
+
+        std::stringstream ss;
+        HMDT::writeProjectDiffText(ss, *diff);
+        ASSERT_EQ(ss.str(), "No differences.\n");
+    }
+
+    auto diff = new_project.diff(old_project);
+    ASSERT_SUCCEEDED(diff);
+    ASSERT_FALSE(diff->empty());
+
+    ASSERT_EQ(diff->metadata.size(), 1);
+    ASSERT_EQ(diff->metadata[0].name, "name");
+    ASSERT_EQ(diff->metadata[0].old_value, "old");
+    ASSERT_EQ(diff->metadata[0].new_value, "new");
+
+    // A grew and changed terrain, B was removed, C was added, and the sea is
+    //   left out as nothing about it changed
+    ASSERT_EQ(diff->provinces.size(), 3);
+    std::map<HMDT::ProvinceID, HMDT::ProvinceChange> province_changes;
+    for(auto&& change : diff->provinces) {
+        province_changes[change.id] = change;
+    }
+    ASSERT_EQ(province_changes.count(sea), 0);
+
+    ASSERT_EQ(province_changes[a].type, HMDT::ChangeType::MODIFIED);
+    ASSERT_EQ(province_changes[a].old_pixel_count, 4);
+    ASSERT_EQ(province_changes[a].new_pixel_count, 5);
+    ASSERT_EQ(province_changes[a].changed_pixel_count, 1);
+    ASSERT_EQ(province_changes[a].properties.size(), 1);
+    ASSERT_EQ(province_changes[a].properties[0].name, "terrain");
+    ASSERT_EQ(province_changes[a].properties[0].old_value, "forest");
+    ASSERT_EQ(province_changes[a].properties[0].new_value, "hills");
+
+    ASSERT_EQ(province_changes[b].type, HMDT::ChangeType::REMOVED);
+    ASSERT_EQ(province_changes[b].old_pixel_count, 2);
+    ASSERT_EQ(province_changes[b].new_pixel_count, 0);
+
+    ASSERT_EQ(province_changes[c].type, HMDT::ChangeType::ADDED);
+    ASSERT_EQ(province_changes[c].old_pixel_count, 0);
+    ASSERT_EQ(province_changes[c].new_pixel_count, 1);
+
+    // Only the second state's membership changed
+    ASSERT_EQ(diff->states.size(), 1);
+    ASSERT_EQ(diff->states[0].id, 2);
+    ASSERT_EQ(diff->states[0].type, HMDT::ChangeType::MODIFIED);
+    ASSERT_EQ(diff->states[0].added_provinces, std::vector<HMDT::ProvinceID>{ c });
+    ASSERT_EQ(diff->states[0].removed_provinces, std::vector<HMDT::ProvinceID>{ b });
+    ASSERT_TRUE(diff->states[0].properties.empty());
+
+    // The whole map fits into a single tile
+    ASSERT_EQ(diff->province_pixels.changed_pixel_count, 2);
+    ASSERT_EQ(diff->province_pixels.changed_tiles.size(), 1);
+    ASSERT_EQ(diff->province_pixels.changed_tiles[0].w, width);
+    ASSERT_EQ(diff->province_pixels.changed_tiles[0].h, height);
+    ASSERT_EQ(diff->heightmap.changed_pixel_count, 1);
+    ASSERT_EQ(diff->rivers.changed_pixel_count, 1);
+
+    // Every changed pixel is drawn in the color of the layer it changed in
+    {
+        auto image = new_project.renderDiff(old_project, *diff);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, width);
+        ASSERT_EQ(image->height, height);
+
+        auto pixel = [&image](uint32_t x, uint32_t y) {
+            return HMDT::getColorAt(HMDT::Dimensions{ image->width, image->height },
+                                    image->pixels.data(), x, y);
+        };
+
+        ASSERT_EQ(pixel(2, 0), HMDT::DIFF_PROVINCE_COLOR);
+        ASSERT_EQ(pixel(2, 1), HMDT::DIFF_PROVINCE_COLOR);
+        ASSERT_EQ(pixel(0, 0), HMDT::DIFF_RIVERS_COLOR);
+        ASSERT_EQ(pixel(1, 1), (HMDT::Color{ 0, 0, 0 }));
+
+        // The dimmed heightmap shows through where only the height changed
+        ASSERT_EQ(pixel(3, 1), (HMDT::Color{ 25, 255, 25 }));
+    }
+
+    // Both output formats mention every change
+    {
+        std::stringstream text;
+        HMDT::writeProjectDiffText(text, *diff);
+
+        std::stringstream c_str;
+        c_str << c;
+        ASSERT_NE(text.str().find("+ " + c_str.str() + " (1 pixels)"), std::string::npos);
+        ASSERT_NE(text.str().find("terrain: 'forest' -> 'hills'"), std::string::npos);
+        ASSERT_NE(text.str().find("Heightmap: 1 changed pixels in 1 tiles"), std::string::npos);
+
+        std::stringstream json;
+        HMDT::writeProjectDiffJSON(json, *diff);
+        ASSERT_NE(json.str().find("\"change\": \"added\""), std::string::npos);
+        ASSERT_NE(json.str().find(c_str.str()), std::string::npos);
+    }
+}
+
+TEST(ProjectTests, DiffStreamedLayersTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // 5x5 maps, compared in 2x2 tiles so that every band gets read:
+    //   old:         new:
+    //   A A A A A    A A A A A
+    //   A A A A A    A A A A A
+    //   A A A A A    A A A A A
+    //   A A A A A    A B A A A
+    //   A A A A A    A A A A B
+    constexpr uint32_t width = 5;
+    constexpr uint32_t height = 5;
+    constexpr uint32_t tile_size = 2;
+    const HMDT::Dimensions dimensions{ width, height };
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+
+    std::vector<HMDT::ProvinceID> old_provinces(width * height, a);
+    std::vector<HMDT::ProvinceID> new_provinces(old_provinces);
+    new_provinces[HMDT::xyToIndex(width, 1, 3)] = b;
+    new_provinces[HMDT::xyToIndex(width, 4, 4)] = b;
+
+    std::vector<uint8_t> old_heightmap(width * height, 0);
+    std::vector<uint8_t> new_heightmap(old_heightmap);
+    new_heightmap[HMDT::xyToIndex(width, 2, 0)] = 7;
+
+    auto tmp_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(tmp_path);
+
+    // Saved the same way as ProvinceProject saves its shape data
+    auto write_shape_data = [&](const std::filesystem::path& path,
+                                const std::vector<HMDT::ProvinceID>& provinces)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::out);
+        out << HMDT::SHAPEDATA_MAGIC;
+        HMDT::writeData(out, width, height);
+        out.write(reinterpret_cast<const char*>(provinces.data()),
+                  provinces.size() * sizeof(HMDT::ProvinceID));
+        out << '\0';
+    };
+
+    auto old_shape_path = tmp_path / "diff_old_shapedata.bin";
+    auto new_shape_path = tmp_path / "diff_new_shapedata.bin";
+    write_shape_data(old_shape_path, old_provinces);
+    write_shape_data(new_shape_path, new_provinces);
+
+    auto old_heightmap_path = tmp_path / "diff_old_heightmap.bmp";
+    auto new_heightmap_path = tmp_path / "diff_new_heightmap.bmp";
+    ASSERT_SUCCEEDED(HMDT::writeBMP2(old_heightmap_path, old_heightmap.data(),
+                                     width, height, 1, true));
+    ASSERT_SUCCEEDED(HMDT::writeBMP2(new_heightmap_path, new_heightmap.data(),
+                                     width, height, 1, true));
+
+    HMDT::ProvinceList province_list;
+    HMDT::StateList state_list;
+
+    auto memory_layers = [&](const std::vector<HMDT::ProvinceID>& provinces,
+                             const std::vector<uint8_t>& heightmap)
+    {
+        HMDT::ProjectDiffLayers layers{ };
+        layers.dimensions = dimensions;
+        layers.provinces = HMDT::readBandsFromMemory(provinces.data(), dimensions);
+        layers.heightmap = HMDT::readBandsFromMemory(heightmap.data(), dimensions);
+        layers.province_list = &province_list;
+        layers.state_list = &state_list;
+        return layers;
+    };
+
+    HMDT::ProjectDiffLayers old_streamed{ };
+    HMDT::ProjectDiffLayers new_streamed{ };
+    for(auto&& [layers, shape_path, heightmap_path] : {
+            std::make_tuple(&old_streamed, old_shape_path, old_heightmap_path),
+            std::make_tuple(&new_streamed, new_shape_path, new_heightmap_path) })
+    {
+        auto provinces = HMDT::readBandsFromShapeData(shape_path, layers->dimensions);
+        ASSERT_SUCCEEDED(provinces);
+        ASSERT_EQ(layers->dimensions.w, width);
+        ASSERT_EQ(layers->dimensions.h, height);
+
+        auto heightmap = HMDT::readBandsFromBitMap(heightmap_path, layers->dimensions);
+        ASSERT_SUCCEEDED(heightmap);
+
+        layers->provinces = *provinces;
+        layers->heightmap = *heightmap;
+        layers->province_list = &province_list;
+        layers->state_list = &state_list;
+    }
+
+    // A BitMap which doesn't match the map can't be streamed alongside it
+    ASSERT_STATUS(HMDT::readBandsFromBitMap(old_heightmap_path,
+                                            HMDT::Dimensions{ width + 1, height }),
+                  HMDT::STATUS_DIMENSION_MISMATCH);
+
+    auto streamed = HMDT::diffProjectLayers(old_streamed, new_streamed, tile_size);
+    ASSERT_SUCCEEDED(streamed);
+
+    auto old_memory = memory_layers(old_provinces, old_heightmap);
+    auto new_memory = memory_layers(new_provinces, new_heightmap);
+    auto in_memory = HMDT::diffProjectLayers(old_memory, new_memory, tile_size);
+    ASSERT_SUCCEEDED(in_memory);
+
+    // Both changed pixels are in different tiles, and the last row of tiles
+    //   is clamped to the map
+    ASSERT_EQ(streamed->province_pixels.changed_pixel_count, 2);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles.size(), 2);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[0].x, 0);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[0].y, 2);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[1].x, 4);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[1].y, 4);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[1].w, 1);
+    ASSERT_EQ(streamed->province_pixels.changed_tiles[1].h, 1);
+
+    ASSERT_EQ(streamed->heightmap.changed_pixel_count, 1);
+    ASSERT_EQ(streamed->heightmap.changed_tiles.size(), 1);
+    ASSERT_EQ(streamed->heightmap.changed_tiles[0].x, 2);
+    ASSERT_EQ(streamed->heightmap.changed_tiles[0].y, 0);
+
+    std::map<HMDT::ProvinceID, HMDT::ProvinceChange> province_changes;
+    for(auto&& change : streamed->provinces) {
+        province_changes[change.id] = change;
+    }
+    ASSERT_EQ(province_changes.size(), 2);
+    ASSERT_EQ(province_changes[a].old_pixel_count, width * height);
+    ASSERT_EQ(province_changes[a].new_pixel_count, width * height - 2);
+    ASSERT_EQ(province_changes[b].type, HMDT::ChangeType::ADDED);
+    ASSERT_EQ(province_changes[b].new_pixel_count, 2);
+
+    // Streaming from disk finds exactly what comparing in memory does
+    {
+        std::stringstream streamed_json;
+        std::stringstream in_memory_json;
+        HMDT::writeProjectDiffJSON(streamed_json, *streamed);
+        HMDT::writeProjectDiffJSON(in_memory_json, *in_memory);
+        ASSERT_EQ(streamed_json.str(), in_memory_json.str());
+    }
+
+    auto streamed_image = HMDT::renderProjectDiff(old_streamed, new_streamed, *streamed);
+    ASSERT_SUCCEEDED(streamed_image);
+
+    auto in_memory_image = HMDT::renderProjectDiff(old_memory, new_memory, *in_memory);
+    ASSERT_SUCCEEDED(in_memory_image);
+
+    ASSERT_EQ(streamed_image->pixels, in_memory_image->pixels);
+    ASSERT_EQ(HMDT::getColorAt(dimensions, streamed_image->pixels.data(), 1, 3),
+              HMDT::DIFF_PROVINCE_COLOR);
+    ASSERT_EQ(HMDT::getColorAt(dimensions, streamed_image->pixels.data(), 2, 0),
+              (HMDT::Color{ 1, 255, 1 }));
+}
+
+TEST(ProjectTests, ZonalStatisticsTest) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    HMDT::Project::Project hproject;
+
+    auto& map_project = hproject.getMapProject();
+    auto& prov_project = map_project.getProvinceProject();
+    auto& heightmap_project = map_project.getHeightMapProject();
+    auto& rivers_project = map_project.getRiversProject();
+
+    // 4x2 map:
+    //   A A B S
+    //   A A B S
+    constexpr uint32_t width = 4;
+    constexpr uint32_t height = 2;
+
+    auto map_data = map_project.getMapData();
+    map_data->~MapData();
+    new (map_data.get()) HMDT::MapData(width, height);
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID sea;
+
+    auto& provinces = prov_project.getProvinces();
+    provinces[a] = HMDT::Province {
+        a, HMDT::Color{ 255, 0, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 0, height - 1 }, { 1, 0 } }, { b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[b] = HMDT::Province {
+        b, HMDT::Color{ 0, 255, 0 }, HMDT::ProvinceType::LAND, false,
+        "unknown", "None", 0, { { 2, height - 1 }, { 2, 0 } }, { a, sea },
+        HMDT::INVALID_PROVINCE, { }
+    };
+    provinces[sea] = HMDT::Province {
+        sea, HMDT::Color{ 0, 0, 255 }, HMDT::ProvinceType::SEA, false,
+        "unknown", "None", 0, { { 3, height - 1 }, { 3, 0 } }, { b },
+        HMDT::INVALID_PROVINCE, { }
+    };
+
+    {
+        auto prov_matrix = map_data->getProvinces().lock();
+        for(uint32_t y = 0; y < height; ++y) {
+            for(uint32_t x = 0; x < width; ++x) {
+                prov_matrix[HMDT::xyToIndex(width, x, y)] = (x < 2) ? a : ((x == 2) ? b : sea);
+            }
+        }
+    }
+
+    // Without a heightmap or rivers, only the shape of each province is known
+    auto stats_a = map_project.getProvinceStatistics(a);
+    ASSERT_SUCCEEDED(stats_a);
+    ASSERT_EQ(stats_a->pixel_count, 4);
+    ASSERT_EQ(stats_a->perimeter, 8);
+    ASSERT_EQ(stats_a->border_lengths.at(b), 2);
+    ASSERT_EQ(stats_a->max_height, 0);
+    ASSERT_EQ(stats_a->river_pixel_count, 0);
+    ASSERT_EQ(HMDT::getCoastlineLength(*stats_a, provinces.at(a), provinces), 0);
+
+    auto stats_b = map_project.getProvinceStatistics(b);
+    ASSERT_SUCCEEDED(stats_b);
+    ASSERT_EQ(stats_b->pixel_count, 2);
+    ASSERT_EQ(stats_b->perimeter, 6);
+    ASSERT_EQ(HMDT::getCoastlineLength(*stats_b, provinces.at(b), provinces), 2);
+
+    auto stats_sea = map_project.getProvinceStatistics(sea);
+    ASSERT_SUCCEEDED(stats_sea);
+    ASSERT_EQ(stats_sea->perimeter, 6);
+    ASSERT_EQ(HMDT::getCoastlineLength(*stats_sea, provinces.at(sea), provinces), 2);
+
+    ASSERT_STATUS(map_project.getProvinceStatistics(HMDT::ProvinceID()),
+                  HMDT::STATUS_KEY_NOT_FOUND);
+
+    // Heights rise by 10 with every column, and the lowest column is also low
+    //   enough to be a river
+    unsigned char input[width * height] = { 10, 20, 30, 40,
+                                            10, 20, 30, 40 };
+
+    auto write_base_path = HMDT::UnitTests::getTestProgramPath() / "tmp";
+    std::filesystem::create_directories(write_base_path);
+
+    auto input_path = write_base_path / "zonal_statistics.bmp";
+    auto res = HMDT::writeBMP2(input_path, input, width, height,
+                               1 /* depth */, true /* is_greyscale */);
+    ASSERT_SUCCEEDED(res);
+
+    // Loading the layers makes the statistics get computed again
+    res = heightmap_project.loadFile(input_path);
+    ASSERT_SUCCEEDED(res);
+    res = rivers_project.loadFile(input_path);
+    ASSERT_SUCCEEDED(res);
+
+    stats_a = map_project.getProvinceStatistics(a);
+    ASSERT_SUCCEEDED(stats_a);
+    ASSERT_EQ(stats_a->min_height, 10);
+    ASSERT_EQ(stats_a->max_height, 20);
+    ASSERT_DOUBLE_EQ(stats_a->mean_height, 15.0);
+    ASSERT_DOUBLE_EQ(stats_a->mean_slope, 10.0);
+    ASSERT_EQ(stats_a->river_pixel_count, 2);
+    ASSERT_EQ(stats_a->perimeter, 8);
+
+    stats_sea = map_project.getProvinceStatistics(sea);
+    ASSERT_SUCCEEDED(stats_sea);
+    ASSERT_EQ(stats_sea->min_height, 40);
+    ASSERT_DOUBLE_EQ(stats_sea->mean_slope, 10.0);
+    ASSERT_EQ(stats_sea->river_pixel_count, 0);
+
+    // Sculpting only changes the height statistics
+    auto edit = heightmap_project.sculpt(
+            HMDT::Project::IHeightMapProject::SculptMode::RAISE, { { 0, 0 } }, 50);
+    ASSERT_SUCCEEDED(edit);
+    ASSERT_FALSE(edit->old_heights.empty());
+
+    stats_a = map_project.getProvinceStatistics(a);
+    ASSERT_SUCCEEDED(stats_a);
+    ASSERT_EQ(stats_a->min_height, 10);
+    ASSERT_EQ(stats_a->max_height, 60);
+    ASSERT_EQ(stats_a->river_pixel_count, 2);
+
+    res = heightmap_project.revertHeightMapEdit(*edit);
+    ASSERT_SUCCEEDED(res);
+
+    // Painting the top of B into A reshapes all three provinces
+    auto maybe_edit = prov_project.paintProvince(a, { { 2, 0 } });
+    ASSERT_SUCCEEDED(maybe_edit);
+
+    stats_a = map_project.getProvinceStatistics(a);
+    ASSERT_SUCCEEDED(stats_a);
+    ASSERT_EQ(stats_a->pixel_count, 5);
+    ASSERT_EQ(stats_a->perimeter, 10);
+    ASSERT_EQ(stats_a->max_height, 30);
+    ASSERT_EQ(HMDT::getCoastlineLength(*stats_a, provinces.at(a), provinces), 1);
+
+    stats_b = map_project.getProvinceStatistics(b);
+    ASSERT_SUCCEEDED(stats_b);
+    ASSERT_EQ(stats_b->pixel_count, 1);
+    ASSERT_EQ(stats_b->perimeter, 4);
+
+    // Every statistic matches computing them all from scratch
+    auto all_stats = map_project.getAllProvinceStatistics();
+    ASSERT_SUCCEEDED(all_stats);
+
+    HMDT::ProvinceStatisticsMap expected;
+    res = HMDT::computeZonalStatistics({ { width, height },
+                                         map_data->getProvinces().lock().get(),
+                                         map_data->getHeightMap().lock().get(),
+                                         map_data->getRivers().lock().get() },
+                                       HMDT::ZONAL_LAYER_ALL, expected);
+    ASSERT_SUCCEEDED(res);
+    ASSERT_EQ(all_stats->size(), expected.size());
+
+    for(auto&& [id, stats] : expected) {
+        const auto& actual = all_stats->at(id);
+        ASSERT_EQ(actual.pixel_count, stats.pixel_count);
+        ASSERT_EQ(actual.perimeter, stats.perimeter);
+        ASSERT_EQ(actual.border_lengths, stats.border_lengths);
+        ASSERT_EQ(actual.min_height, stats.min_height);
+        ASSERT_EQ(actual.max_height, stats.max_height);
+        ASSERT_DOUBLE_EQ(actual.mean_height, stats.mean_height);
+        ASSERT_DOUBLE_EQ(actual.mean_slope, stats.mean_slope);
+        ASSERT_EQ(actual.river_pixel_count, stats.river_pixel_count);
+    }
+}
+
+TEST(ProjectTests, ExtractBordersTest) {
+    // 3x3 map, where every pair of provinces and the outside of the map meet
+    //   at a junction:
+    //   A A B
+    //   A A B
+    //   C C C
+    constexpr uint32_t width = 3;
+    constexpr uint32_t height = 3;
+
+    HMDT::ProvinceID a;
+    HMDT::ProvinceID b;
+    HMDT::ProvinceID c;
+
+    std::vector<HMDT::ProvinceID> provinces(width * height);
+    for(uint32_t y = 0; y < height; ++y) {
+        for(uint32_t x = 0; x < width; ++x) {
+            provinces[HMDT::xyToIndex(width, x, y)] = (y == 2) ? c : ((x == 2) ? b : a);
+        }
+    }
+
+    auto arcs = HMDT::extractBorders({ width, height }, provinces.data());
+    ASSERT_SUCCEEDED(arcs);
+
+    // Every border between two regions is a single arc running between two
+    //   junctions, and no border is traced twice
+    ASSERT_EQ(arcs->size(), 6);
+
+    auto get_id = [&](uint64_t pixel) {
+        return pixel == HMDT::BORDER_OUTSIDE_MAP ? HMDT::EMPTY_UUID
+                                                 : provinces[pixel];
+    };
+    auto get_border = [&](const HMDT::BorderArc& arc) {
+        auto left = get_id(arc.left_pixel);
+        auto right = get_id(arc.right_pixel);
+        return (left < right) ? std::make_pair(left, right)
+                              : std::make_pair(right, left);
+    };
+
+    std::set<std::pair<HMDT::ProvinceID, HMDT::ProvinceID>> borders;
+    for(auto&& arc : *arcs) {
+        ASSERT_FALSE(arc.isRing());
+        ASSERT_GE(arc.points.size(), 2);
+
+        ASSERT_NE(get_id(arc.left_pixel), get_id(arc.right_pixel));
+
+        borders.insert(get_border(arc));
+    }
+    ASSERT_EQ(borders.size(), 6);
+
+    // The border between A and B runs straight down to the junction with C
+    auto ab = std::find_if(arcs->begin(), arcs->end(), [&](const auto& arc) {
+        return get_border(arc) == ((a < b) ? std::make_pair(a, b)
+                                           : std::make_pair(b, a));
+    });
+    ASSERT_NE(ab, arcs->end());
+    ASSERT_EQ(ab->points.size(), 2);
+    ASSERT_EQ(ab->points.front().x, 2);
+    ASSERT_EQ(ab->points.front().y, 0);
+    ASSERT_EQ(ab->points.back().x, 2);
+    ASSERT_EQ(ab->points.back().y, 2);
+
+    // Walking down from the top, A is on the right and B is on the left
+    ASSERT_EQ(get_id(ab->left_pixel), b);
+    ASSERT_EQ(get_id(ab->right_pixel), a);
+
+    // 4x4 map of states, with state 2 as an island in the middle of state 1
+    constexpr uint32_t ring_size = 4;
+    std::vector<HMDT::StateID> states(ring_size * ring_size, 1);
+    for(uint32_t y = 1; y < 3; ++y) {
+        for(uint32_t x = 1; x < 3; ++x) {
+            states[HMDT::xyToIndex(ring_size, x, y)] = 2;
+        }
+    }
+
+    auto rings = HMDT::extractBorders({ ring_size, ring_size }, states.data());
+    ASSERT_SUCCEEDED(rings);
+
+    // Without any junctions, both the island and the outside of the map are
+    //   closed rings with only their corners kept
+    ASSERT_EQ(rings->size(), 2);
+    for(auto&& ring : *rings) {
+        ASSERT_TRUE(ring.isRing());
+        ASSERT_EQ(ring.points.size(), 5);
+    }
+
+    const auto& island = rings->at(1);
+    ASSERT_EQ(island.points.front().x, 1);
+    ASSERT_EQ(island.points.front().y, 1);
+    ASSERT_EQ(states[island.left_pixel], 1);
+    ASSERT_EQ(states[island.right_pixel], 2);
+
+    // Simplifying never moves the ends of an arc, and never collapses a ring
+    std::vector<HMDT::BorderArc> staircase(1);
+    staircase[0].points = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 2, 1 }, { 2, 2 },
+                            { 3, 2 }, { 3, 3 } };
+
+    ASSERT_SUCCEEDED(HMDT::simplifyBorders(staircase, 0));
+    ASSERT_EQ(staircase[0].points.size(), 7);
+
+    ASSERT_SUCCEEDED(HMDT::simplifyBorders(staircase, 1));
+    ASSERT_EQ(staircase[0].points.size(), 2);
+    ASSERT_EQ(staircase[0].points.back().x, 3);
+    ASSERT_EQ(staircase[0].points.back().y, 3);
+
+    auto simplified_rings = *rings;
+    ASSERT_SUCCEEDED(HMDT::simplifyBorders(simplified_rings, 10));
+    ASSERT_EQ(simplified_rings[1].points.size(), 5);
+
+    // Both formats write each border exactly once
+    std::vector<HMDT::BorderLayer> layers(1);
+    layers[0].name = "states";
+    layers[0].arcs = *rings;
+    layers[0].arc_labels = { { "", "1" }, { "1", "2" } };
+
+    std::stringstream svg;
+    HMDT::writeBordersSVG(svg, { ring_size, ring_size }, layers);
+    ASSERT_NE(svg.str().find("<g id=\"states\""), std::string::npos);
+    ASSERT_NE(svg.str().find("<path d=\"M1 1L3 1L3 3L1 3Z\" data-left=\"1\" data-right=\"2\"/>"),
+              std::string::npos);
+
+    std::stringstream geojson;
+    HMDT::writeBordersGeoJSON(geojson, { ring_size, ring_size }, layers);
+    ASSERT_NE(geojson.str().find("\"type\":\"FeatureCollection\""), std::string::npos);
+
+    // y points up in GeoJSON
+    ASSERT_NE(geojson.str().find("[[1,3],[3,3],[3,1],[1,1],[1,3]]"), std::string::npos);
+    ASSERT_NE(geojson.str().find("\"left\":null,\"right\":\"1\""), std::string::npos);
+}
@@ -1,11 +1,31 @@
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
 #include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
 
 #include <libintl.h>
 
 #include "Util.h"
+#include "RecordParser.h"
+#include "RecordWriter.h"
+#include "ScriptTokenizer.h"
+#include "ModReader.h"
+#include "ProvinceSplitter.h"
+#include "ProvinceGenerator.h"
+#include "TerrainVoter.h"
+#include "MapRenderer.h"
+#include "BorderMask.h"
+#include "TileHash.h"
+#include "FileWatcher.h"
 #include "Monad.h"
 #include "Maybe.h"
 #include "StatusCodes.h"
@@ -262,6 +282,1172 @@ TEST(UtilTests, ParseValuePositionTest) {
     ASSERT_EQ(ss.tellg(), start);
 }
 
+TEST(UtilTests, RecordParserTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    std::string data("1;foo bar; true ;sea;-2;2.5\r\n"
+                     "\n"
+                     "300;;false;land\n"
+                     "7;x;1;lake;3;0.5;;9\n"
+                     "00000000-0000-0000-0000-000000000001;1,,2,3,\n"
+                     "nope");
+
+    HMDT::RecordParser parser(data, ';');
+
+    uint32_t u;
+    std::string s;
+    bool b;
+    HMDT::ProvinceType p;
+    int32_t i;
+    float f;
+
+    // Every field of a full record, with the Windows line ending removed
+    ASSERT_TRUE(parser.nextRecord());
+    ASSERT_EQ(parser.getLineNumber(), 1);
+    ASSERT_EQ(parser.getRecord(), "1;foo bar; true ;sea;-2;2.5");
+    ASSERT_SUCCEEDED(parser.parseFields(u, s, b, p, i, f));
+    ASSERT_EQ(u, 1);
+    ASSERT_EQ(s, "foo bar");
+    ASSERT_TRUE(b);
+    ASSERT_EQ(p, HMDT::ProvinceType::SEA);
+    ASSERT_EQ(i, -2);
+    ASSERT_FLOAT_EQ(f, 2.5f);
+    ASSERT_FALSE(parser.hasMoreFields());
+
+    // Empty lines are skipped. Missing optional fields are left untouched, but
+    //   missing required fields are errors
+    ASSERT_TRUE(parser.nextRecord());
+    ASSERT_EQ(parser.getLineNumber(), 3);
+
+    uint8_t small = 4;
+    auto res = parser.parseField(small);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+    ASSERT_EQ(small, 4);
+
+    ASSERT_SUCCEEDED(parser.parseFields(s, b, p));
+    ASSERT_EQ(s, "");
+    ASSERT_FALSE(b);
+    ASSERT_EQ(p, HMDT::ProvinceType::LAND);
+
+    i = 42;
+    ASSERT_SUCCEEDED(parser.parseOptionalField(i));
+    ASSERT_EQ(i, 42);
+
+    ASSERT_EQ(parser.getColumnNumber(), 16);
+    res = parser.parseField(i);
+    ASSERT_EQ(res.error(), HMDT::STATUS_MISSING_FIELD);
+
+    // Empty optional fields in the middle of a record are skipped too
+    ASSERT_TRUE(parser.nextRecord());
+    ASSERT_SUCCEEDED(parser.parseFields(u, s, b, p, i, f));
+    ASSERT_TRUE(b);
+
+    uint32_t optional1 = 5;
+    uint32_t optional2 = 5;
+    ASSERT_SUCCEEDED(parser.parseOptionalFields(optional1, optional2));
+    ASSERT_EQ(optional1, 5);
+    ASSERT_EQ(optional2, 9);
+
+    // UUIDs and lists, with empty list values skipped
+    ASSERT_TRUE(parser.nextRecord());
+
+    HMDT::UUID uuid;
+    ASSERT_SUCCEEDED(parser.parseField(uuid));
+    ASSERT_EQ(uuid, HMDT::UUID::parse("00000000-0000-0000-0000-000000000001").orElse(HMDT::EMPTY_UUID));
+
+    std::vector<uint32_t> list;
+    ASSERT_SUCCEEDED(parser.parseListField<uint32_t>(',', [&list](uint32_t v) -> HMDT::MaybeVoid {
+        list.push_back(v);
+        return HMDT::STATUS_SUCCESS;
+    }));
+    ASSERT_EQ(list, (std::vector<uint32_t>{ 1, 2, 3 }));
+
+    // The last line does not need a line ending
+    ASSERT_TRUE(parser.nextRecord());
+    ASSERT_EQ(parser.getLineNumber(), 6);
+    res = parser.parseField(uuid);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+
+    ASSERT_FALSE(parser.nextRecord());
+
+    // Anything after a number is only ignored when it is allowed to be, and
+    //   fields with no number at all are always errors
+    std::string junk("12px;2.5f;x1");
+
+    HMDT::RecordParser strict_parser(junk, ';');
+    ASSERT_TRUE(strict_parser.nextRecord());
+    res = strict_parser.parseField(u);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+
+    HMDT::RecordParser lenient_parser(junk, ';');
+    lenient_parser.setAllowTrailingCharacters();
+    ASSERT_TRUE(lenient_parser.nextRecord());
+    ASSERT_SUCCEEDED(lenient_parser.parseFields(u, f));
+    ASSERT_EQ(u, 12);
+    ASSERT_FLOAT_EQ(f, 2.5f);
+    res = lenient_parser.parseField(u);
+    ASSERT_EQ(res.error(), HMDT::STATUS_INVALID_FIELD);
+    ASSERT_EQ(u, 12);
+}
+
+TEST(UtilTests, RecordWriterTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    auto uuid = HMDT::UUID::parse("00000000-0000-0000-0000-000000000001").orElse(HMDT::EMPTY_UUID);
+
+    std::string buffer;
+    HMDT::RecordWriter writer(buffer, ';');
+
+    // 8-bit values are written as numbers, not as characters
+    writer.writeRecord(uuid, uint8_t{ 255 }, int32_t{ -2 }, true,
+                       HMDT::ProvinceType::SEA, std::string("plains"), "");
+    writer.writeField(HMDT::ProvinceType::UNKNOWN);
+    writer.writeField(false);
+    writer.endRecord();
+
+    ASSERT_EQ(buffer, "00000000-0000-0000-0000-000000000001;255;-2;true;sea;plains;\n"
+                      "UNKNOWN{0};false\n");
+
+    // Whatever is written can be parsed back again
+    HMDT::RecordParser parser(buffer, ';');
+    ASSERT_TRUE(parser.nextRecord());
+
+    auto parsed_uuid = HMDT::EMPTY_UUID;
+    uint8_t u;
+    int32_t i;
+    bool b;
+    HMDT::ProvinceType p;
+    std::string s;
+    ASSERT_SUCCEEDED(parser.parseFields(parsed_uuid, u, i, b, p, s));
+    ASSERT_EQ(parsed_uuid, uuid);
+    ASSERT_EQ(u, 255);
+    ASSERT_EQ(i, -2);
+    ASSERT_TRUE(b);
+    ASSERT_EQ(p, HMDT::ProvinceType::SEA);
+    ASSERT_EQ(s, "plains");
+
+    // Writing in parallel produces the records in order, no matter how the
+    //   work gets split up
+    auto path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "records.csv";
+    std::filesystem::create_directories(path.parent_path());
+
+    constexpr size_t COUNT = 10000;
+    ASSERT_SUCCEEDED(HMDT::writeRecordsToFile(path, COUNT, ',',
+        [](size_t index, HMDT::RecordWriter& writer) {
+            writer.writeRecord(index, index * 2);
+        }));
+
+    std::string expected;
+    for(size_t index = 0; index < COUNT; ++index) {
+        expected += std::to_string(index) + ',' + std::to_string(index * 2) + '\n';
+    }
+
+    auto contents = HMDT::readFileToString(path);
+    ASSERT_SUCCEEDED(contents);
+    ASSERT_EQ(*contents, expected);
+
+    // Nothing to write still creates the file
+    ASSERT_SUCCEEDED(HMDT::writeRecordsToFile(path, 0, ',',
+        [](size_t, HMDT::RecordWriter&) { }));
+
+    contents = HMDT::readFileToString(path);
+    ASSERT_SUCCEEDED(contents);
+    ASSERT_TRUE(contents->empty());
+}
+
+TEST(UtilTests, ScriptTokenizerTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    std::string script = "\xEF\xBB\xBF# A comment\n"
+                         "state={ id = 12\n"
+                         "\tname=\"STATE_12\" # trailing comment\n"
+                         "\tx >= 3 y != no\n"
+                         "}";
+
+    using HMDT::ScriptTokenType;
+    std::tuple<ScriptTokenType, std::string_view, size_t, size_t> expected[] = {
+        { ScriptTokenType::WORD, "state", 2, 1 },
+        { ScriptTokenType::OPERATOR, "=", 2, 6 },
+        { ScriptTokenType::OPEN_BRACE, "{", 2, 7 },
+        { ScriptTokenType::WORD, "id", 2, 9 },
+        { ScriptTokenType::OPERATOR, "=", 2, 12 },
+        { ScriptTokenType::WORD, "12", 2, 14 },
+        { ScriptTokenType::WORD, "name", 3, 2 },
+        { ScriptTokenType::OPERATOR, "=", 3, 6 },
+        { ScriptTokenType::STRING, "STATE_12", 3, 7 },
+        { ScriptTokenType::WORD, "x", 4, 2 },
+        { ScriptTokenType::OPERATOR, ">=", 4, 4 },
+        { ScriptTokenType::WORD, "3", 4, 7 },
+        { ScriptTokenType::WORD, "y", 4, 9 },
+        { ScriptTokenType::OPERATOR, "!=", 4, 11 },
+        { ScriptTokenType::WORD, "no", 4, 14 },
+        { ScriptTokenType::CLOSE_BRACE, "}", 5, 1 },
+    };
+
+    HMDT::ScriptTokenizer tokenizer(script);
+    for(auto&& [type, text, line, column] : expected) {
+        ASSERT_EQ(tokenizer.peek().type, type);
+
+        auto token = tokenizer.next();
+        ASSERT_EQ(token.type, type);
+        ASSERT_EQ(token.text, text);
+        ASSERT_EQ(token.line, line);
+        ASSERT_EQ(token.column, column);
+    }
+    ASSERT_EQ(tokenizer.next().type, ScriptTokenType::END_OF_FILE);
+
+    // Whole blocks can be skipped, no matter how deeply they are nested
+    HMDT::ScriptTokenizer skip_tokenizer("{ a = { b = { c } } d } after");
+    ASSERT_SUCCEEDED(skip_tokenizer.skipValue());
+    ASSERT_EQ(skip_tokenizer.next().text, "after");
+
+    HMDT::ScriptTokenizer unclosed_tokenizer("{ a = { b }");
+    ASSERT_STATUS(unclosed_tokenizer.skipValue(), HMDT::STATUS_UNEXPECTED_END_OF_SCRIPT);
+
+    HMDT::ScriptTokenizer unterminated_tokenizer("name = \"STATE");
+    unterminated_tokenizer.next();
+    unterminated_tokenizer.next();
+    ASSERT_EQ(unterminated_tokenizer.next().type, ScriptTokenType::INVALID);
+}
+
+TEST(UtilTests, ModReaderTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // definition.csv
+    {
+        auto definitions = HMDT::parseProvinceDefinitions(
+            "\xEF\xBB\xBF" "0;0;0;0;land;false;unknown;0\r\n"
+            "1;10;20;30;land;false;plains;1\r\n"
+            "2;40;50;60;sea;true;ocean;0\r\n");
+        ASSERT_SUCCEEDED(definitions);
+        ASSERT_EQ(definitions->size(), 2);
+
+        ASSERT_EQ((*definitions)[0].id, 1);
+        ASSERT_EQ((*definitions)[0].color, (HMDT::Color{ 10, 20, 30 }));
+        ASSERT_EQ((*definitions)[0].type, HMDT::ProvinceType::LAND);
+        ASSERT_EQ((*definitions)[0].terrain, "plains");
+        ASSERT_EQ((*definitions)[0].continent, 1);
+
+        ASSERT_EQ((*definitions)[1].type, HMDT::ProvinceType::SEA);
+        ASSERT_TRUE((*definitions)[1].coastal);
+
+        ASSERT_STATUS(HMDT::parseProvinceDefinitions("1;10;20"),
+                      HMDT::STATUS_MISSING_FIELD);
+    }
+
+    // continent.txt
+    {
+        auto continents = HMDT::parseContinents(
+            "continents = {\n\teurope\n\tnorth_america # comment\n\t\"asia\"\n}\n");
+        ASSERT_SUCCEEDED(continents);
+        ASSERT_EQ(*continents, (std::vector<std::string>{ "europe", "north_america", "asia" }));
+    }
+
+    // history/states
+    {
+        auto state = HMDT::parseStateDefinition(
+            "state={\n"
+            "\tid=7\n"
+            "\tname=\"STATE_7\"\n"
+            "\tmanpower = 1322\n"
+            "\tresources={ steel=12.000 }\n"
+            "\tstate_category = town\n"
+            "\thistory={\n"
+            "\t\towner = FRA\n"
+            "\t\tvictory_points = { 11 1 }\n"
+            "\t\t1939.1.1 = { owner = GER }\n"
+            "\t}\n"
+            "\tprovinces={\n"
+            "\t\t11 542 3\n"
+            "\t}\n"
+            "\timpassable = yes\n"
+            "\tbuildings_max_level_factor=1.5\n"
+            "}\n");
+        ASSERT_SUCCEEDED(state);
+        ASSERT_EQ(state->id, 7);
+        ASSERT_EQ(state->name, "STATE_7");
+        ASSERT_EQ(state->manpower, 1322);
+        ASSERT_EQ(state->category, "town");
+        ASSERT_TRUE(state->impassable);
+        ASSERT_FLOAT_EQ(state->buildings_max_level_factor, 1.5f);
+        ASSERT_EQ(state->provinces, (std::vector<uint32_t>{ 11, 542, 3 }));
+
+        ASSERT_STATUS(HMDT::parseStateDefinition("# nothing here\n"),
+                      HMDT::STATUS_VALUE_NOT_FOUND);
+        ASSERT_STATUS(HMDT::parseStateDefinition("state={ id=1 provinces={ 1 2 }"),
+                      HMDT::STATUS_UNEXPECTED_END_OF_SCRIPT);
+        ASSERT_STATUS(HMDT::parseStateDefinition("state={ id=one }"),
+                      HMDT::STATUS_INVALID_FIELD);
+    }
+
+    // Province map indexing
+    {
+        // 4x3 map:
+        //   A A B B
+        //   A C C B
+        //   D D D D
+        // Where C is not a known color
+        HMDT::Color A{ 1, 0, 0 }, B{ 2, 0, 0 }, C{ 3, 0, 0 }, D{ 4, 0, 0 };
+        HMDT::Color pixels[] = { A, A, B, B,
+                                 A, C, C, B,
+                                 D, D, D, D };
+
+        std::vector<unsigned char> data;
+        for(auto&& c : pixels) {
+            data.insert(data.end(), { c.r, c.g, c.b });
+        }
+
+        // E is known but not in the map
+        HMDT::Color E{ 5, 0, 0 };
+        auto index = HMDT::indexProvinceMap(data.data(), { 4, 3 }, { D, B, A, E });
+        ASSERT_SUCCEEDED(index);
+
+        ASSERT_EQ(index->unknown_colors, std::vector<HMDT::Color>{ C });
+        ASSERT_EQ(index->pixel_provinces,
+                  (std::vector<uint32_t>{ 2, 2, 1, 1,
+                                          2, 4, 4, 1,
+                                          0, 0, 0, 0 }));
+        ASSERT_EQ(index->pixel_counts, (std::vector<uint64_t>{ 4, 3, 3, 0, 2 }));
+
+        // A
+        ASSERT_EQ(index->bounding_boxes[2].bottom_left.x, 0);
+        ASSERT_EQ(index->bounding_boxes[2].bottom_left.y, 1);
+        ASSERT_EQ(index->bounding_boxes[2].top_right.x, 1);
+        ASSERT_EQ(index->bounding_boxes[2].top_right.y, 0);
+
+        // C
+        ASSERT_EQ(index->bounding_boxes[4].bottom_left.x, 1);
+        ASSERT_EQ(index->bounding_boxes[4].top_right.x, 2);
+
+        std::vector<std::pair<uint32_t, uint32_t>> expected_adjacencies = {
+            { 0, 1 }, { 0, 2 }, { 0, 4 }, { 1, 2 }, { 1, 4 }, { 2, 4 }
+        };
+        ASSERT_EQ(index->adjacencies, expected_adjacencies);
+    }
+}
+
+
+TEST(UtilTests, ProvinceSplitterTests) {
+    // Checks that every piece is one 4-connected shape
+    auto isEveryPieceConnected = [](const std::vector<HMDT::Point2D>& pixels,
+                                    const std::vector<uint32_t>& pieces)
+    {
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> piece_at;
+        std::map<uint32_t, uint64_t> piece_sizes;
+        for(uint64_t i = 0; i < pixels.size(); ++i) {
+            piece_at[{ pixels[i].x, pixels[i].y }] = pieces[i];
+            ++piece_sizes[pieces[i]];
+        }
+
+        std::set<std::pair<uint32_t, uint32_t>> visited;
+        for(uint64_t i = 0; i < pixels.size(); ++i) {
+            if(visited.count({ pixels[i].x, pixels[i].y }) != 0) continue;
+
+            // The first pixel seen of every piece must reach all of the rest
+            uint64_t reached = 0;
+            std::vector<std::pair<uint32_t, uint32_t>> to_visit{ { pixels[i].x, pixels[i].y } };
+            visited.insert(to_visit.front());
+            while(!to_visit.empty()) {
+                auto [x, y] = to_visit.back();
+                to_visit.pop_back();
+                ++reached;
+
+                for(auto next : { std::pair{ x - 1, y }, std::pair{ x + 1, y },
+                                  std::pair{ x, y - 1 }, std::pair{ x, y + 1 } })
+                {
+                    if(auto it = piece_at.find(next);
+                       it != piece_at.end() && it->second == pieces[i] &&
+                       visited.insert(next).second)
+                    {
+                        to_visit.push_back(next);
+                    }
+                }
+            }
+
+            if(reached != piece_sizes[pieces[i]]) return false;
+        }
+
+        return true;
+    };
+
+    // A 20x10 rectangle split in two should be cut down the middle
+    std::vector<HMDT::Point2D> rectangle;
+    for(uint32_t y = 0; y < 10; ++y) {
+        for(uint32_t x = 0; x < 20; ++x) {
+            rectangle.push_back({ x, y });
+        }
+    }
+
+    auto pieces = HMDT::partitionShape(rectangle, 2);
+    ASSERT_EQ(pieces.size(), rectangle.size());
+    ASSERT_EQ(pieces.front(), 0);
+    ASSERT_EQ(*std::max_element(pieces.begin(), pieces.end()), 1);
+    ASSERT_EQ(std::count(pieces.begin(), pieces.end(), 0), 100);
+    ASSERT_TRUE(isEveryPieceConnected(rectangle, pieces));
+
+    // Splitting the same shape again gives the same pieces
+    ASSERT_EQ(HMDT::partitionShape(rectangle, 2), pieces);
+
+    // Asking for 1 piece, or for more pieces than there are pixels
+    ASSERT_EQ(HMDT::partitionShape(rectangle, 1),
+              std::vector<uint32_t>(rectangle.size(), 0));
+    {
+        std::vector<HMDT::Point2D> three{ { 0, 0 }, { 1, 0 }, { 2, 0 } };
+        ASSERT_EQ(HMDT::partitionShape(three, 5), (std::vector<uint32_t>{ 0, 1, 2 }));
+    }
+
+    // A thin ring can't be split into compact pieces by distance alone, so
+    //   every piece has to be fixed up to be connected
+    std::vector<HMDT::Point2D> ring;
+    for(uint32_t y = 0; y < 40; ++y) {
+        for(uint32_t x = 0; x < 40; ++x) {
+            if(x < 2 || y < 2 || x >= 38 || y >= 38) {
+                ring.push_back({ x, y });
+            }
+        }
+    }
+
+    for(uint32_t count = 2; count <= 12; ++count) {
+        pieces = HMDT::partitionShape(ring, count);
+        ASSERT_TRUE(isEveryPieceConnected(ring, pieces)) << "count = " << count;
+        ASSERT_LE(*std::max_element(pieces.begin(), pieces.end()), count - 1);
+    }
+
+    // A long strip across an 80x80 map needs at least 5 pieces for each to be
+    //   less than 1/8th of the map wide
+    std::vector<HMDT::Point2D> strip;
+    for(uint32_t y = 0; y < 4; ++y) {
+        for(uint32_t x = 0; x < 40; ++x) {
+            strip.push_back({ x, y });
+        }
+    }
+
+    pieces = HMDT::partitionOversizedShape(strip, { 80, 80 });
+    ASSERT_GE(*std::max_element(pieces.begin(), pieces.end()), 4);
+    ASSERT_TRUE(isEveryPieceConnected(strip, pieces));
+
+    for(uint32_t piece = 0; piece <= *std::max_element(pieces.begin(), pieces.end()); ++piece) {
+        uint32_t min_x = 80;
+        uint32_t max_x = 0;
+        for(uint64_t i = 0; i < strip.size(); ++i) {
+            if(pieces[i] == piece) {
+                min_x = std::min(min_x, strip[i].x);
+                max_x = std::max(max_x, strip[i].x);
+            }
+        }
+        ASSERT_FALSE(HMDT::isShapeTooLarge(max_x - min_x, 3, HMDT::Dimensions{ 80, 80 }));
+    }
+
+    // Large shapes only cluster a sample of their pixels, but every piece must
+    //   still fit and be connected
+    std::vector<HMDT::Point2D> large;
+    for(uint32_t y = 0; y < 200; ++y) {
+        for(uint32_t x = 0; x < 400; ++x) {
+            // Leave a hole in the middle so that the shape isn't convex
+            if(x < 150 || x >= 250 || y < 50 || y >= 150) {
+                large.push_back({ x, y });
+            }
+        }
+    }
+
+    pieces = HMDT::partitionOversizedShape(large, { 800, 800 });
+    ASSERT_TRUE(isEveryPieceConnected(large, pieces));
+    {
+        auto count = *std::max_element(pieces.begin(), pieces.end()) + 1;
+        std::vector<uint32_t> min_x(count, 800), min_y(count, 800), max_x(count, 0), max_y(count, 0);
+        for(uint64_t i = 0; i < large.size(); ++i) {
+            min_x[pieces[i]] = std::min(min_x[pieces[i]], large[i].x);
+            min_y[pieces[i]] = std::min(min_y[pieces[i]], large[i].y);
+            max_x[pieces[i]] = std::max(max_x[pieces[i]], large[i].x);
+            max_y[pieces[i]] = std::max(max_y[pieces[i]], large[i].y);
+        }
+
+        for(uint32_t piece = 0; piece < count; ++piece) {
+            ASSERT_NE(max_x[piece], 0) << "piece " << piece << " is empty";
+            ASSERT_FALSE(HMDT::isShapeTooLarge(max_x[piece] - min_x[piece],
+                                               max_y[piece] - min_y[piece],
+                                               HMDT::Dimensions{ 800, 800 }));
+        }
+    }
+
+    // Shapes which already fit are left alone
+    ASSERT_EQ(HMDT::partitionOversizedShape(strip, { 800, 800 }),
+              std::vector<uint32_t>(strip.size(), 0));
+}
+
+TEST(UtilTests, ProvinceGeneratorTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // 80x60 mask. The left half is land, with a bay of sea cutting into it so
+    //   that it is not convex, and a lake in its top-left corner. The right
+    //   half is sea, with a 2x2 island in it.
+    constexpr uint32_t WIDTH = 80;
+    constexpr uint32_t HEIGHT = 60;
+    const HMDT::Dimensions dimensions{ WIDTH, HEIGHT };
+
+    auto typeAt = [](uint32_t x, uint32_t y) {
+        if(x >= 4 && x < 10 && y >= 4 && y < 10) {
+            return HMDT::ProvinceType::LAKE;
+        } else if((x >= 60 && x < 62 && y >= 30 && y < 32) ||
+                  (x < 40 && !(x >= 10 && y >= 20 && y < 40)))
+        {
+            return HMDT::ProvinceType::LAND;
+        } else {
+            return HMDT::ProvinceType::SEA;
+        }
+    };
+
+    std::vector<uint8_t> mask;
+    for(uint32_t y = 0; y < HEIGHT; ++y) {
+        for(uint32_t x = 0; x < WIDTH; ++x) {
+            switch(typeAt(x, y)) {
+                case HMDT::ProvinceType::LAND:
+                    mask.insert(mask.end(), { 0xFF, 0, 0 });
+                    break;
+                case HMDT::ProvinceType::LAKE:
+                    mask.insert(mask.end(), { 0, 0xFF, 0 });
+                    break;
+                default:
+                    mask.insert(mask.end(), { 0, 0, 0xFF });
+                    break;
+            }
+        }
+    }
+
+    HMDT::ProvinceGeneratorOptions options;
+    options.province_count = 20;
+    options.seed = 1;
+
+    auto generated = HMDT::generateProvinceMap(dimensions, mask.data(), nullptr, options);
+    ASSERT_SUCCEEDED(generated);
+    ASSERT_EQ(generated->image.size(), WIDTH * HEIGHT * 3);
+
+    auto& definitions = generated->definitions;
+    ASSERT_GE(definitions.size(), 10);
+    ASSERT_LE(definitions.size(), 40);
+
+    std::map<uint32_t, uint32_t> province_of_color;
+    for(uint32_t i = 0; i < definitions.size(); ++i) {
+        ASSERT_EQ(definitions[i].id, i + 1);
+        ASSERT_TRUE(province_of_color.emplace(HMDT::colorToRGB(definitions[i].color), i).second)
+            << "color " << definitions[i].color << " is used twice";
+    }
+
+    // Every pixel is in a province of the same type as the mask
+    std::vector<uint32_t> provinces(WIDTH * HEIGHT);
+    for(uint32_t y = 0; y < HEIGHT; ++y) {
+        for(uint32_t x = 0; x < WIDTH; ++x) {
+            auto i = HMDT::xyToIndex(WIDTH, x, y);
+            HMDT::Color color{ generated->image[i * 3],
+                               generated->image[i * 3 + 1],
+                               generated->image[i * 3 + 2] };
+
+            auto it = province_of_color.find(HMDT::colorToRGB(color));
+            ASSERT_NE(it, province_of_color.end()) << "(" << x << ", " << y << ")";
+            ASSERT_EQ(definitions[it->second].type, typeAt(x, y)) << "(" << x << ", " << y << ")";
+
+            provinces[i] = it->second;
+        }
+    }
+
+    // Every province is one connected shape, even in the non-convex land
+    {
+        std::vector<uint64_t> sizes(definitions.size(), 0);
+        for(auto&& p : provinces) {
+            ++sizes[p];
+        }
+
+        std::vector<bool> visited(provinces.size(), false);
+        std::set<uint32_t> seen;
+        for(uint32_t start = 0; start < provinces.size(); ++start) {
+            if(visited[start]) continue;
+
+            ASSERT_TRUE(seen.insert(provinces[start]).second)
+                << "province " << provinces[start] + 1 << " is in more than one piece";
+
+            uint64_t reached = 0;
+            std::vector<uint32_t> to_visit{ start };
+            visited[start] = true;
+            while(!to_visit.empty()) {
+                auto i = to_visit.back();
+                to_visit.pop_back();
+                ++reached;
+
+                uint32_t x = i % WIDTH, y = i / WIDTH;
+                for(auto [nx, ny] : { std::pair{ x - 1, y }, std::pair{ x + 1, y },
+                                      std::pair{ x, y - 1 }, std::pair{ x, y + 1 } })
+                {
+                    if(nx >= WIDTH || ny >= HEIGHT) continue;
+
+                    auto n = HMDT::xyToIndex(WIDTH, nx, ny);
+                    if(!visited[n] && provinces[n] == provinces[start]) {
+                        visited[n] = true;
+                        to_visit.push_back(n);
+                    }
+                }
+            }
+
+            ASSERT_EQ(reached, sizes[provinces[start]]);
+        }
+    }
+
+    // The island and the lake are too small to share, so each is exactly one
+    //   province
+    {
+        auto island = provinces[HMDT::xyToIndex(WIDTH, 60, 30)];
+        auto lake = provinces[HMDT::xyToIndex(WIDTH, 4, 4)];
+        ASSERT_EQ(std::count(provinces.begin(), provinces.end(), island), 4);
+        ASSERT_EQ(std::count(provinces.begin(), provinces.end(), lake), 36);
+    }
+
+    // The same seed always gives the same map, and a different one does not
+    {
+        auto again = HMDT::generateProvinceMap(dimensions, mask.data(), nullptr, options);
+        ASSERT_SUCCEEDED(again);
+        ASSERT_EQ(again->image, generated->image);
+
+        options.seed = 2;
+        auto other = HMDT::generateProvinceMap(dimensions, mask.data(), nullptr, options);
+        ASSERT_SUCCEEDED(other);
+        ASSERT_NE(other->image, generated->image);
+        options.seed = 1;
+    }
+
+    // Bright parts of a density map get more provinces than dark parts
+    {
+        std::vector<uint8_t> all_land(WIDTH * HEIGHT * 3, 0);
+        std::vector<uint8_t> density(WIDTH * HEIGHT, 0);
+        for(uint32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+            all_land[i * 3] = 0xFF;
+            density[i] = (i % WIDTH < WIDTH / 2) ? 255 : 0;
+        }
+
+        auto dense = HMDT::generateProvinceMap(dimensions, all_land.data(),
+                                               density.data(), options);
+        ASSERT_SUCCEEDED(dense);
+
+        // Count the provinces on each half, by where most of their pixels are
+        std::map<uint32_t, int64_t> balance;
+        for(uint32_t y = 0; y < HEIGHT; ++y) {
+            for(uint32_t x = 0; x < WIDTH; ++x) {
+                auto i = HMDT::xyToIndex(WIDTH, x, y);
+                HMDT::Color color{ dense->image[i * 3],
+                                   dense->image[i * 3 + 1],
+                                   dense->image[i * 3 + 2] };
+                balance[HMDT::colorToRGB(color)] += (x < WIDTH / 2) ? 1 : -1;
+            }
+        }
+
+        auto bright = std::count_if(balance.begin(), balance.end(),
+                                    [](auto&& b) { return b.second > 0; });
+        auto dark = static_cast<decltype(bright)>(balance.size()) - bright;
+        ASSERT_GT(bright, dark * 2);
+    }
+
+    // An empty mask or a zero scale can't be generated from
+    ASSERT_STATUS(HMDT::generateProvinceMap(dimensions, nullptr, nullptr, options),
+                  HMDT::STATUS_INVALID_VALUE);
+
+    options.sea_province_scale = 0;
+    ASSERT_STATUS(HMDT::generateProvinceMap(dimensions, mask.data(), nullptr, options),
+                  HMDT::STATUS_INVALID_VALUE);
+}
+
+TEST(UtilTests, TerrainVoteTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // 7x2 map. Province A is the first two columns, B the next two, C (which
+    //   is sea) the two after that, and D the last one.
+    constexpr uint32_t WIDTH = 7;
+    constexpr uint32_t HEIGHT = 2;
+    const HMDT::Dimensions dimensions{ WIDTH, HEIGHT };
+
+    HMDT::ProvinceList provinces;
+    auto addProvince = [&provinces](HMDT::ProvinceType type) {
+        HMDT::Province province{};
+        province.type = type;
+        province.terrain = "plains";
+        provinces[province.id] = province;
+        return province.id;
+    };
+
+    auto a = addProvince(HMDT::ProvinceType::LAND);
+    auto b = addProvince(HMDT::ProvinceType::LAND);
+    auto c = addProvince(HMDT::ProvinceType::SEA);
+    auto d = addProvince(HMDT::ProvinceType::LAND);
+
+    const std::vector<HMDT::ProvinceID> matrix{
+        a, a, b, b, c, c, d,
+        a, a, b, b, c, c, d,
+    };
+
+    const std::vector<HMDT::TerrainID> index_terrains{
+        "unknown", "plains", "forest", "hills"
+    };
+
+    // A has 2 plains, 1 forest and 1 unknown. B is tied between forest and
+    //   hills. D is all unknown.
+    const std::vector<uint8_t> terrain_map{
+        1, 1, 2, 3, 1, 1, 0,
+        0, 2, 2, 3, 1, 1, 0,
+    };
+
+    auto vote = [&](const HMDT::TerrainVoteOptions& options) {
+        return HMDT::voteProvinceTerrains(dimensions, matrix.data(),
+                                          terrain_map.data(), provinces,
+                                          index_terrains, options);
+    };
+
+    // Water and provinces with no votes are left out
+    {
+        auto result = vote({});
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->size(), 2);
+        ASSERT_EQ(result->at(a), "plains");
+        ASSERT_EQ(result->at(b), "forest");
+    }
+
+    // Ties
+    {
+        HMDT::TerrainVoteOptions options;
+
+        options.tie_break = HMDT::TerrainTieBreak::LAST_LISTED;
+        auto result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(b), "hills");
+
+        // B's current terrain is not one of the tied ones
+        options.tie_break = HMDT::TerrainTieBreak::KEEP_CURRENT;
+        result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(b), "forest");
+
+        provinces[b].terrain = "hills";
+        result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(b), "hills");
+        provinces[b].terrain = "plains";
+    }
+
+    // Ignored pixels don't vote
+    {
+        HMDT::TerrainVoteOptions options;
+        options.ignored_indices = { 1 };
+
+        auto result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(a), "forest");
+
+        options.ignored_indices.clear();
+        options.ignored_terrains = { "forest" };
+
+        result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(a), "plains");
+        ASSERT_EQ(result->at(b), "hills");
+
+        options.ignored_terrains.clear();
+
+        result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->size(), 3);
+        ASSERT_EQ(result->at(d), "unknown");
+    }
+
+    // Water provinces can be voted on too
+    {
+        HMDT::TerrainVoteOptions options;
+        options.include_water = true;
+
+        auto result = vote(options);
+        ASSERT_SUCCEEDED(result);
+        ASSERT_EQ(result->at(c), "plains");
+    }
+
+    ASSERT_STATUS(HMDT::voteProvinceTerrains(dimensions, nullptr,
+                                             terrain_map.data(), provinces,
+                                             index_terrains, {}),
+                  HMDT::STATUS_PARAM_CANNOT_BE_NULL);
+}
+
+TEST(UtilTests, MapRendererTests) {
+    SET_PROGRAM_OPTION(quiet, true);
+
+    // 4x2 map. Provinces A and B are in state 1, and C is in state 2.
+    constexpr uint32_t WIDTH = 4;
+    constexpr uint32_t HEIGHT = 2;
+
+    HMDT::ProvinceID a, b, c;
+
+    const std::vector<HMDT::ProvinceID> matrix{
+        a, a, b, b,
+        a, a, c, c,
+    };
+    const std::vector<uint32_t> state_ids{
+        1, 1, 1, 1,
+        1, 1, 2, 2,
+    };
+    const std::vector<uint8_t> heightmap{
+        0, 10, 20, 30,
+        40, 50, 60, 70,
+    };
+
+    const HMDT::MapRenderLayers layers{
+        HMDT::Dimensions{ WIDTH, HEIGHT }, matrix.data(), state_ids.data(), nullptr
+    };
+
+    const HMDT::Color red{ 255, 0, 0 };
+    const HMDT::Color green{ 0, 255, 0 };
+    const HMDT::Color black{ 0, 0, 0 };
+    const HMDT::Color white{ 255, 255, 255 };
+
+    // C has no color
+    const std::unordered_map<HMDT::ProvinceID, HMDT::Color> colors{
+        { a, red }, { b, green }
+    };
+
+    auto pixel = [](const HMDT::RenderedMap& image, uint32_t x, uint32_t y) {
+        return HMDT::getColorAt(HMDT::Dimensions{ image.width, image.height },
+                                image.pixels.data(), x, y);
+    };
+
+    // Without borders, every pixel is the color of its province
+    {
+        auto image = HMDT::renderMap(layers, colors, {});
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, WIDTH);
+        ASSERT_EQ(image->height, HEIGHT);
+        ASSERT_EQ(image->pixels.size(), WIDTH * HEIGHT * 3);
+
+        ASSERT_EQ(pixel(*image, 0, 0), red);
+        ASSERT_EQ(pixel(*image, 1, 1), red);
+        ASSERT_EQ(pixel(*image, 3, 0), green);
+        ASSERT_EQ(pixel(*image, 3, 1), black);
+    }
+
+    // Borders are drawn on both sides of every edge
+    {
+        HMDT::MapRenderOptions options;
+        options.border_color = white;
+        options.draw_province_borders = true;
+
+        auto image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0), red);
+        ASSERT_EQ(pixel(*image, 1, 0), white);
+        ASSERT_EQ(pixel(*image, 2, 0), white);
+        ASSERT_EQ(pixel(*image, 0, 1), red);
+
+        options.draw_province_borders = false;
+        options.draw_state_borders = true;
+
+        image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 1, 0), red);
+        ASSERT_EQ(pixel(*image, 2, 0), white);
+        ASSERT_EQ(pixel(*image, 1, 1), white);
+        ASSERT_EQ(pixel(*image, 3, 0), white);
+    }
+
+    // Scaling samples the map pixel under the center of every image pixel
+    {
+        HMDT::MapRenderOptions options;
+        options.scale = 2;
+
+        auto image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, WIDTH * 2);
+        ASSERT_EQ(image->height, HEIGHT * 2);
+        ASSERT_EQ(pixel(*image, 3, 1), red);
+        ASSERT_EQ(pixel(*image, 4, 1), green);
+        ASSERT_EQ(pixel(*image, 4, 2), black);
+
+        options.scale = 0.5;
+
+        image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, 2);
+        ASSERT_EQ(image->height, 1);
+        ASSERT_EQ(pixel(*image, 0, 0), red);
+        ASSERT_EQ(pixel(*image, 1, 0), black);
+
+        // The image is never empty
+        options.scale = 0.01;
+
+        image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(image->width, 1);
+        ASSERT_EQ(image->height, 1);
+    }
+
+    // Selected provinces are tinted
+    {
+        HMDT::MapRenderOptions options;
+        options.selection = { b };
+        options.selection_color = white;
+
+        auto image = HMDT::renderMap(layers, colors, options);
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 0, 0), red);
+        ASSERT_EQ(pixel(*image, 2, 0), (HMDT::Color{ 127, 255, 127 }));
+    }
+
+    // The heightmap replaces the province colors
+    {
+        auto heightmap_layers = layers;
+        heightmap_layers.heightmap = heightmap.data();
+
+        auto image = HMDT::renderMap(heightmap_layers, colors, {});
+        ASSERT_SUCCEEDED(image);
+        ASSERT_EQ(pixel(*image, 1, 0), (HMDT::Color{ 10, 10, 10 }));
+        ASSERT_EQ(pixel(*image, 3, 1), (HMDT::Color{ 70, 70, 70 }));
+    }
+
+    {
+        auto null_layers = layers;
+        null_layers.provinces = nullptr;
+        ASSERT_STATUS(HMDT::renderMap(null_layers, colors, {}),
+                      HMDT::STATUS_PARAM_CANNOT_BE_NULL);
+
+        HMDT::MapRenderOptions options;
+        options.scale = 0;
+        ASSERT_STATUS(HMDT::renderMap(layers, colors, options),
+                      HMDT::STATUS_INVALID_VALUE);
+    }
+
+    ASSERT_EQ(HMDT::mapModeFromString("Terrain"), HMDT::MapMode::TERRAIN);
+    ASSERT_EQ(HMDT::mapModeFromString("heightmap"), HMDT::MapMode::HEIGHTMAP);
+    ASSERT_FALSE(HMDT::mapModeFromString("political").has_value());
+}
+
+TEST(UtilTests, BorderMaskTests) {
+    // 4x3 map. Provinces A and B are in state 1, and C is in state 2.
+    //   A A B B
+    //   A A B B
+    //   C C C C
+    constexpr uint32_t WIDTH = 4;
+    constexpr uint32_t HEIGHT = 3;
+    const HMDT::Dimensions dimensions{ WIDTH, HEIGHT };
+
+    HMDT::ProvinceID a, b, c;
+
+    std::vector<HMDT::ProvinceID> provinces{
+        a, a, b, b,
+        a, a, b, b,
+        c, c, c, c,
+    };
+    std::vector<uint32_t> state_ids{
+        1, 1, 1, 1,
+        1, 1, 1, 1,
+        2, 2, 2, 2,
+    };
+
+    auto flags_at = [&](const std::vector<uint8_t>& outlines, uint32_t x, uint32_t y) {
+        return outlines[HMDT::xyToIndex(WIDTH, x, y)];
+    };
+
+    std::vector<uint8_t> outlines(WIDTH * HEIGHT, 0xFF);
+    ASSERT_SUCCEEDED(HMDT::buildBorderMask(dimensions, provinces.data(),
+                                           state_ids.data(), outlines.data()));
+
+    ASSERT_EQ(flags_at(outlines, 0, 0), 0);
+    ASSERT_EQ(flags_at(outlines, 1, 0), HMDT::OUTLINE_EAST);
+    ASSERT_EQ(flags_at(outlines, 2, 0), HMDT::OUTLINE_WEST);
+
+    // Province borders which are also state borders get both sets of bits
+    ASSERT_EQ(flags_at(outlines, 0, 1), HMDT::OUTLINE_SOUTH | (HMDT::OUTLINE_SOUTH << HMDT::OUTLINE_STATE_SHIFT));
+    ASSERT_EQ(flags_at(outlines, 1, 1), HMDT::OUTLINE_EAST | HMDT::OUTLINE_SOUTH | (HMDT::OUTLINE_SOUTH << HMDT::OUTLINE_STATE_SHIFT));
+    ASSERT_EQ(flags_at(outlines, 3, 2), HMDT::OUTLINE_NORTH | (HMDT::OUTLINE_NORTH << HMDT::OUTLINE_STATE_SHIFT));
+
+    // Moving B into state 2 only changes the state bits
+    for(auto i : { 2, 3, 6, 7 }) {
+        state_ids[i] = 2;
+    }
+
+    auto area = HMDT::growBorderArea(dimensions, HMDT::Rectangle{ 2, 0, 2, 2 });
+    ASSERT_EQ(area.x, 1);
+    ASSERT_EQ(area.y, 0);
+    ASSERT_EQ(area.w, 3);
+    ASSERT_EQ(area.h, 3);
+
+    ASSERT_SUCCEEDED(HMDT::updateStateBorderMask(dimensions, state_ids.data(),
+                                                 outlines.data(), area));
+
+    ASSERT_EQ(flags_at(outlines, 1, 0), HMDT::OUTLINE_EAST | (HMDT::OUTLINE_EAST << HMDT::OUTLINE_STATE_SHIFT));
+    ASSERT_EQ(flags_at(outlines, 2, 1), HMDT::OUTLINE_WEST | HMDT::OUTLINE_SOUTH | (HMDT::OUTLINE_WEST << HMDT::OUTLINE_STATE_SHIFT));
+    ASSERT_EQ(flags_at(outlines, 3, 2), HMDT::OUTLINE_NORTH);
+
+    // Rebuilding only the grown area gives the same result as rebuilding
+    //   everything
+    std::vector<uint8_t> full(WIDTH * HEIGHT, 0);
+    ASSERT_SUCCEEDED(HMDT::buildBorderMask(dimensions, provinces.data(),
+                                           state_ids.data(), full.data()));
+    ASSERT_EQ(outlines, full);
+
+    // Painting the pixel at (2, 0) into A
+    provinces[2] = a;
+    state_ids[2] = 1;
+
+    area = HMDT::growBorderArea(dimensions, HMDT::Rectangle{ 2, 0, 1, 1 });
+    ASSERT_SUCCEEDED(HMDT::buildBorderMask(dimensions, provinces.data(),
+                                           state_ids.data(), outlines.data(),
+                                           area));
+    ASSERT_SUCCEEDED(HMDT::buildBorderMask(dimensions, provinces.data(),
+                                           state_ids.data(), full.data()));
+    ASSERT_EQ(outlines, full);
+
+    // Areas are clamped to the map
+    area = HMDT::growBorderArea(dimensions, HMDT::Rectangle{ 0, 0, WIDTH, HEIGHT });
+    ASSERT_EQ(area.x, 0);
+    ASSERT_EQ(area.y, 0);
+    ASSERT_EQ(area.w, WIDTH);
+    ASSERT_EQ(area.h, HEIGHT);
+
+    area = HMDT::growBorderArea(dimensions, HMDT::Rectangle{ 1, 1, 0, 0 });
+    ASSERT_EQ(area.w, 0);
+    ASSERT_EQ(area.h, 0);
+}
+
+TEST(UtilTests, TileHashTests) {
+    // 10x5 map with 4x4 tiles, so the right and bottom tiles are smaller
+    constexpr uint32_t WIDTH = 10;
+    constexpr uint32_t HEIGHT = 5;
+    constexpr uint32_t TILE_SIZE = 4;
+    const HMDT::Dimensions dimensions{ WIDTH, HEIGHT };
+
+    std::vector<uint8_t> old_data(WIDTH * HEIGHT);
+    for(uint32_t i = 0; i < old_data.size(); ++i) {
+        old_data[i] = static_cast<uint8_t>(i);
+    }
+
+    auto hashes = HMDT::hashTiles(dimensions, old_data.data(), 1, TILE_SIZE);
+    ASSERT_SUCCEEDED(hashes);
+    ASSERT_EQ(hashes->size(), 3 * 2);
+
+    // Nothing changed
+    auto changed = HMDT::findChangedTiles(dimensions, old_data.data(),
+                                          old_data.data(), 1, TILE_SIZE);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_TRUE(changed->empty());
+
+    // Change one pixel in the first tile, and one in the bottom right tile
+    auto new_data = old_data;
+    new_data[HMDT::xyToIndex(WIDTH, 1, 2)] += 1;
+    new_data[HMDT::xyToIndex(WIDTH, 9, 4)] += 1;
+
+    changed = HMDT::findChangedTiles(dimensions, old_data.data(),
+                                     new_data.data(), 1, TILE_SIZE);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_EQ(changed->size(), 2);
+
+    ASSERT_EQ((*changed)[0].x, 0);
+    ASSERT_EQ((*changed)[0].y, 0);
+    ASSERT_EQ((*changed)[0].w, TILE_SIZE);
+    ASSERT_EQ((*changed)[0].h, TILE_SIZE);
+
+    // Edge tiles are clamped to the map
+    ASSERT_EQ((*changed)[1].x, 8);
+    ASSERT_EQ((*changed)[1].y, 4);
+    ASSERT_EQ((*changed)[1].w, 2);
+    ASSERT_EQ((*changed)[1].h, 1);
+
+    // Every byte of a pixel counts when the depth is larger than 1
+    std::vector<uint8_t> old_rgb(WIDTH * HEIGHT * 3, 0);
+    auto new_rgb = old_rgb;
+    new_rgb[HMDT::xyToIndex(WIDTH, 5, 1) * 3 + 2] = 1;
+
+    changed = HMDT::findChangedTiles(dimensions, old_rgb.data(),
+                                     new_rgb.data(), 3, TILE_SIZE);
+    ASSERT_SUCCEEDED(changed);
+    ASSERT_EQ(changed->size(), 1);
+    ASSERT_EQ((*changed)[0].x, 4);
+    ASSERT_EQ((*changed)[0].y, 0);
+}
+
+TEST(UtilTests, FileWatcherTests) {
+    using namespace std::chrono_literals;
+
+    auto watch_path = HMDT::UnitTests::getTestProgramPath() / "tmp" / "file_watcher";
+    std::filesystem::remove_all(watch_path);
+    ASSERT_TRUE(std::filesystem::create_directories(watch_path));
+
+    auto watched_file = watch_path / "heightmap.bmp";
+    auto other_file = watch_path / "other.bmp";
+
+    auto touch = [](const std::filesystem::path& path, const std::string& contents) {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << contents;
+    };
+
+    // Keeps polling until something settles, or we give up
+    auto poll_until_changed = [](HMDT::FileWatcher& watcher) {
+        std::vector<std::filesystem::path> changed;
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        while(changed.empty() && std::chrono::steady_clock::now() < deadline) {
+            changed = watcher.poll(20ms);
+        }
+        return changed;
+    };
+
+    touch(watched_file, "0");
+
+    HMDT::FileWatcher watcher(50ms);
+    ASSERT_SUCCEEDED(watcher.watch(watched_file));
+    ASSERT_TRUE(watcher.isWatching(watched_file));
+    ASSERT_FALSE(watcher.isWatching(other_file));
+
+    // Nothing has changed yet
+    ASSERT_TRUE(watcher.poll(100ms).empty());
+
+    // Several writes in a row only get reported once
+    touch(watched_file, "1");
+    touch(watched_file, "12");
+    touch(watched_file, "123");
+
+    auto changed = poll_until_changed(watcher);
+    ASSERT_EQ(changed.size(), 1);
+    ASSERT_EQ(changed.front(), std::filesystem::absolute(watched_file).lexically_normal());
+    ASSERT_TRUE(watcher.poll(100ms).empty());
+
+    // Files next to the watched one are ignored
+    touch(other_file, "0");
+    ASSERT_TRUE(watcher.poll(200ms).empty());
+
+    // Editors which save by replacing the file are still noticed
+    auto temp_file = watch_path / "heightmap.bmp.tmp";
+    touch(temp_file, "1234");
+    std::filesystem::rename(temp_file, watched_file);
+
+    changed = poll_until_changed(watcher);
+    ASSERT_EQ(changed.size(), 1);
+
+    // Changes get reported from the background thread too
+    std::atomic<uint32_t> callback_count = 0;
+    ASSERT_SUCCEEDED(watcher.start([&callback_count](const std::filesystem::path&) {
+        ++callback_count;
+    }));
+    ASSERT_TRUE(watcher.isRunning());
+    ASSERT_STATUS(watcher.start([](const std::filesystem::path&) { }),
+                  HMDT::STATUS_KEY_EXISTS);
+
+    touch(watched_file, "12345");
+
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while(callback_count == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(10ms);
+    }
+    watcher.stop();
+    ASSERT_FALSE(watcher.isRunning());
+    ASSERT_EQ(callback_count, 1);
+
+    // Nothing gets reported after unwatching
+    ASSERT_SUCCEEDED(watcher.unwatch(watched_file));
+    ASSERT_STATUS(watcher.unwatch(watched_file), HMDT::STATUS_VALUE_NOT_FOUND);
+
+    touch(watched_file, "0");
+    ASSERT_TRUE(watcher.poll(200ms).empty());
+}
+
 TEST(UtilTests, TrimTests) {
     std::pair<std::string, std::string> ltrim_tests[] = {
         { "    ltrim   ", "ltrim   " },
@@ -559,3 +1745,147 @@ TEST(UtilTests, LargeParallelTransformTest) {
         ASSERT_EQ(output_data[i], expected_output_data[i]);
     }
 }
+
+TEST(UtilTests, TryParallelForEachRangeTest) {
+    std::atomic<uint64_t> total = 0;
+    auto result = HMDT::tryParallelForEachRange(100, [&](uint64_t begin, uint64_t end) {
+        for(auto i = begin; i < end; ++i) {
+            total += i;
+        }
+    });
+    ASSERT_SUCCEEDED(result);
+    ASSERT_EQ(total, 4950);
+
+    // Whatever gets thrown on any range becomes a status code
+    result = HMDT::tryParallelForEachRange(100, [](uint64_t begin, uint64_t) {
+        if(begin == 0) throw std::bad_alloc();
+    });
+    ASSERT_STATUS(result, HMDT::STATUS_BADALLOC);
+
+    result = HMDT::tryParallelForEachRange(100, [](uint64_t begin, uint64_t) {
+        if(begin == 0) throw std::runtime_error("Failed");
+    });
+    ASSERT_STATUS(result, HMDT::STATUS_UNEXPECTED);
+
+    result = HMDT::tryParallelForEachRange(100, [](uint64_t begin, uint64_t) {
+        if(begin == 0) throw 5;
+    });
+    ASSERT_STATUS(result, HMDT::STATUS_UNEXPECTED);
+}
+
+TEST(UtilTests, CalculateEdgeFlagsTest) {
+    // Two regions split down the middle, with a single pixel of a third region
+    //   in the bottom-left corner
+    const uint32_t matrix[] = {
+        1, 1, 2, 2,
+        1, 1, 2, 2,
+        3, 1, 2, 2,
+    };
+    HMDT::Dimensions dimensions{ 4, 3 };
+
+    // Interior pixels and pixels on the edge of the map have no flags
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 0, 0), 0);
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 3, 1), 0);
+
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 1, 0), HMDT::OUTLINE_EAST);
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 2, 0), HMDT::OUTLINE_WEST);
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 0, 1), HMDT::OUTLINE_SOUTH);
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 1, 2),
+              HMDT::OUTLINE_EAST | HMDT::OUTLINE_WEST);
+    ASSERT_EQ(HMDT::calculateEdgeFlags(dimensions, matrix, 0, 2),
+              HMDT::OUTLINE_NORTH | HMDT::OUTLINE_EAST);
+
+    // The state flags must never overlap the province flags
+    ASSERT_EQ(HMDT::OUTLINE_PROVINCE_MASK & HMDT::OUTLINE_STATE_MASK, 0);
+    ASSERT_EQ((HMDT::calculateEdgeFlags(dimensions, matrix, 0, 2) << HMDT::OUTLINE_STATE_SHIFT) & HMDT::OUTLINE_PROVINCE_MASK, 0);
+}
+
+TEST(UtilTests, ProvinceIndexTests) {
+    HMDT::ProvinceID a, b, unindexed;
+
+    const HMDT::ProvinceID matrix[] = {
+        a, a, b,
+        a, unindexed, b,
+    };
+    HMDT::Dimensions dimensions{ 3, 2 };
+
+    auto index_of = HMDT::indexProvinceIDs({ b, a });
+    ASSERT_EQ(HMDT::findProvinceIndex(index_of, b), 0);
+    ASSERT_EQ(HMDT::findProvinceIndex(index_of, a), 1);
+    ASSERT_EQ(HMDT::findProvinceIndex(index_of, unindexed), HMDT::NO_PROVINCE_INDEX);
+
+    uint32_t index_matrix[6];
+    HMDT::buildProvinceIndexMatrix(matrix, 6, index_of, index_matrix);
+
+    const uint32_t expected[] = {
+        1, 1, 0,
+        1, HMDT::NO_PROVINCE_INDEX, 0,
+    };
+    for(uint32_t i = 0; i < 6; ++i) {
+        ASSERT_EQ(index_matrix[i], expected[i]);
+    }
+
+    // Provinces which aren't indexed are skipped
+    auto stats = HMDT::gatherProvincePixelStats(dimensions, matrix, index_of);
+    ASSERT_EQ(stats.size(), 2);
+
+    ASSERT_EQ(stats[1].count, 3);
+    ASSERT_EQ(stats[1].sum_x, 0 + 1 + 0);
+    ASSERT_EQ(stats[1].sum_y, 0 + 0 + 1);
+    ASSERT_EQ(stats[1].min_x, 0);
+    ASSERT_EQ(stats[1].max_x, 1);
+    ASSERT_EQ(stats[1].max_y, 1);
+    ASSERT_EQ(stats[1].first, 0);
+
+    ASSERT_EQ(stats[0].count, 2);
+    ASSERT_EQ(stats[0].min_x, 2);
+    ASSERT_EQ(stats[0].first, 2);
+
+    // Merging keeps the widest bounds and the lowest height
+    HMDT::ProvincePixelStats merged;
+    merged.addPixel(5, 5, 55);
+    merged.addHeight(40);
+    merged.merge(stats[1]);
+    ASSERT_EQ(merged.count, 4);
+    ASSERT_EQ(merged.min_x, 0);
+    ASSERT_EQ(merged.max_x, 5);
+    ASSERT_EQ(merged.first, 0);
+    ASSERT_EQ(merged.height_sum, 40);
+    ASSERT_EQ(merged.min_height, 40);
+    ASSERT_EQ(merged.max_height, 40);
+}
+
+TEST(UtilTests, BrushShapeTests) {
+    HMDT::Dimensions dimensions{ 8, 8 };
+
+    // Radius 1 is a plus shape, and is clipped at the edge of the image
+    ASSERT_EQ(HMDT::getPixelsInCircle(dimensions, { 4, 4 }, 1).size(), 5);
+    ASSERT_EQ(HMDT::getPixelsInCircle(dimensions, { 0, 0 }, 1).size(), 3);
+    ASSERT_EQ(HMDT::getPixelsInCircle(dimensions, { 4, 4 }, 0).size(), 1);
+    ASSERT_TRUE(HMDT::getPixelsInCircle(dimensions, { 8, 0 }, 1).empty());
+
+    // A stroke fills in the gaps between points, and never repeats a pixel
+    auto stroke = HMDT::getPixelsAlongStroke(dimensions, { { 0, 2 }, { 7, 2 } }, 0);
+    ASSERT_EQ(stroke.size(), 8);
+    for(uint32_t x = 0; x < 8; ++x) {
+        ASSERT_EQ(stroke[x].x, x);
+        ASSERT_EQ(stroke[x].y, 2);
+    }
+    ASSERT_EQ(HMDT::getPixelsAlongStroke(dimensions, { { 3, 3 }, { 3, 3 } }, 1).size(), 5);
+
+    // A lasso around a 4x3 rectangle
+    auto lasso = HMDT::getPixelsInPolygon(dimensions, { { 1, 1 }, { 4, 1 }, { 4, 3 }, { 1, 3 } });
+    ASSERT_EQ(lasso.size(), 4 * 2);
+    ASSERT_TRUE(HMDT::getPixelsInPolygon(dimensions, { { 1, 1 }, { 4, 1 } }).empty());
+
+    // Flood filling only finds the connected region
+    const uint32_t matrix[] = {
+        1, 1, 2,
+        2, 1, 2,
+        1, 2, 2,
+    };
+    ASSERT_EQ(HMDT::getConnectedPixels<uint32_t>({ 3, 3 }, matrix, { 0, 0 }).size(), 3);
+    ASSERT_EQ(HMDT::getConnectedPixels<uint32_t>({ 3, 3 }, matrix, { 2, 0 }).size(), 4);
+    ASSERT_EQ(HMDT::getConnectedPixels<uint32_t>({ 3, 3 }, matrix, { 0, 2 }).size(), 1);
+}
+